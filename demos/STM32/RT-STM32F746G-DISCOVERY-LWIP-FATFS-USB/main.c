@@ -167,7 +167,7 @@ static void cmd_mem(BaseSequentialStream *chp, int argc, char *argv[]) {
     chprintf(chp, "Usage: mem\r\n");
     return;
   }
-  n = chHeapStatus(NULL, &size);
+  n = chHeapStatus(NULL, &size, NULL);
   chprintf(chp, "core free memory : %u bytes\r\n", chCoreGetStatusX());
   chprintf(chp, "heap fragments   : %u\r\n", n);
   chprintf(chp, "heap free total  : %u bytes\r\n", size);
@@ -79,6 +79,27 @@
 #if !defined(CAN_USE_SLEEP_MODE) || defined(__DOXYGEN__)
 #define CAN_USE_SLEEP_MODE          TRUE
 #endif
+
+/**
+ * @brief   Software receive queues inclusion switch.
+ * @details If enabled, the received frames can be moved by the low level
+ *          driver ISR into one or more software queues, see
+ *          @p canAddRxQueue().
+ */
+#if !defined(CAN_USE_RX_QUEUES) || defined(__DOXYGEN__)
+#define CAN_USE_RX_QUEUES           FALSE
+#endif
+
+/**
+ * @brief   Software transmit queue inclusion switch.
+ * @details If enabled, the frames transmitted on @p CAN_ANY_MAILBOX can
+ *          be buffered in a software queue ordered by identifier, the
+ *          low level driver ISR refills the mailboxes from the queue, see
+ *          @p canSetTxQueue().
+ */
+#if !defined(CAN_USE_TX_QUEUE) || defined(__DOXYGEN__)
+#define CAN_USE_TX_QUEUE            FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -100,8 +121,154 @@ typedef enum {
   CAN_SLEEP = 4                             /**< Sleep state.               */
 } canstate_t;
 
+/**
+ * @brief   Acceptance filter.
+ * @details A frame is accepted if the identifier bits selected by the mask
+ *          are equal to the ones of the filter identifier, the identifier
+ *          type must always match.
+ */
+typedef struct {
+  /**
+   * @brief   Identifier, standard or extended.
+   */
+  uint32_t                  id;
+  /**
+   * @brief   Identifier bits to be compared.
+   */
+  uint32_t                  mask;
+  /**
+   * @brief   Identifier type, zero if standard, one if extended.
+   */
+  uint8_t                   ide;
+} CANAcceptanceFilter;
+
+#if (CAN_USE_RX_QUEUES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of a CAN receive queue.
+ */
+typedef struct can_rx_queue CANRxQueue;
+#endif
+
+#if (CAN_USE_TX_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of a CAN transmit queue.
+ */
+typedef struct can_tx_queue CANTxQueue;
+#endif
+
 #include "can_lld.h"
 
+#if (CAN_USE_RX_QUEUES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Structure representing a CAN receive queue.
+ * @details Frames are written in the queue by the driver ISR, the queue
+ *          receives the frames accepted by the filters specified in its
+ *          routing mask or, if the mask is zero, all the frames not routed
+ *          to other queues.
+ */
+struct can_rx_queue {
+  /**
+   * @brief   Next queue attached to the driver.
+   */
+  CANRxQueue                *next;
+  /**
+   * @brief   Frames buffer.
+   */
+  CANRxFrame                *buffer;
+  /**
+   * @brief   Buffer size in frames.
+   */
+  size_t                    size;
+  /**
+   * @brief   Read index.
+   */
+  size_t                    rdidx;
+  /**
+   * @brief   Write index.
+   */
+  size_t                    wridx;
+  /**
+   * @brief   Frames in the queue.
+   */
+  size_t                    counter;
+  /**
+   * @brief   Mask of the filters routed to this queue.
+   * @note    The bit position is the filter index, as reported in the
+   *          @p FMI field of the received frames.
+   */
+  uint32_t                  filters;
+  /**
+   * @brief   Frames lost because the queue was full.
+   */
+  uint32_t                  overruns;
+  /**
+   * @brief   Threads waiting for frames.
+   */
+  threads_queue_t           waiting;
+};
+#endif /* CAN_USE_RX_QUEUES == TRUE */
+
+#if (CAN_USE_TX_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Transmit queue entry.
+ */
+typedef struct {
+  /**
+   * @brief   Arbitration key of the frame.
+   */
+  uint32_t                  key;
+  /**
+   * @brief   Insertion sequence number, it keeps frames with the same
+   *          identifier in order.
+   */
+  uint32_t                  seq;
+  /**
+   * @brief   The frame.
+   */
+  CANTxFrame                frame;
+} CANTxQueueEntry;
+
+/**
+ * @brief   Structure representing a CAN transmit queue.
+ * @details The queue is a binary heap, the frame that would win the bus
+ *          arbitration is always the next one moved into a mailbox.
+ */
+struct can_tx_queue {
+  /**
+   * @brief   Entries buffer.
+   */
+  CANTxQueueEntry           *buffer;
+  /**
+   * @brief   Buffer size in entries.
+   */
+  size_t                    size;
+  /**
+   * @brief   Frames in the queue.
+   */
+  size_t                    counter;
+  /**
+   * @brief   Next insertion sequence number.
+   */
+  uint32_t                  seq;
+  /**
+   * @brief   Mask of the mailboxes holding a frame moved from the queue.
+   */
+  uint32_t                  mbloaded;
+  /**
+   * @brief   Arbitration keys of the frames moved into the mailboxes.
+   */
+  uint32_t                  mbkeys[CAN_TX_MAILBOXES];
+  /**
+   * @brief   Maximum number of frames ever in the queue.
+   */
+  size_t                    maxdepth;
+  /**
+   * @brief   Frames refused because the queue was full.
+   */
+  uint32_t                  overflows;
+};
+#endif /* CAN_USE_TX_QUEUE == TRUE */
+
 /*===========================================================================*/
 /* Driver macros.                                                            */
 /*===========================================================================*/
@@ -114,6 +281,60 @@ typedef enum {
  * @brief   Converts a mailbox index to a bit mask.
  */
 #define CAN_MAILBOX_TO_MASK(mbx) (1U << ((mbx) - 1U))
+
+#if (CAN_USE_RX_QUEUES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the number of frames in a receive queue.
+ *
+ * @param[in] rqp       pointer to the @p CANRxQueue object
+ * @return              The number of frames.
+ *
+ * @iclass
+ */
+#define canRxQueueGetFullI(rqp) ((rqp)->counter)
+
+/**
+ * @brief   Returns the number of frames lost by a receive queue.
+ *
+ * @param[in] rqp       pointer to the @p CANRxQueue object
+ * @return              The number of lost frames.
+ *
+ * @xclass
+ */
+#define canRxQueueGetOverrunsX(rqp) ((rqp)->overruns)
+#endif
+
+#if (CAN_USE_TX_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the number of frames in a transmit queue.
+ *
+ * @param[in] tqp       pointer to the @p CANTxQueue object
+ * @return              The number of frames.
+ *
+ * @iclass
+ */
+#define canTxQueueGetFullI(tqp) ((tqp)->counter)
+
+/**
+ * @brief   Returns the maximum depth reached by a transmit queue.
+ *
+ * @param[in] tqp       pointer to the @p CANTxQueue object
+ * @return              The maximum number of frames.
+ *
+ * @xclass
+ */
+#define canTxQueueGetMaxDepthX(tqp) ((tqp)->maxdepth)
+
+/**
+ * @brief   Returns the number of frames refused by a transmit queue.
+ *
+ * @param[in] tqp       pointer to the @p CANTxQueue object
+ * @return              The number of refused frames.
+ *
+ * @xclass
+ */
+#define canTxQueueGetOverflowsX(tqp) ((tqp)->overflows)
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -141,6 +362,25 @@ extern "C" {
                    canmbx_t mailbox,
                    CANRxFrame *crfp,
                    systime_t timeout);
+  void canSetAcceptanceFilters(CANDriver *canp,
+                               const CANAcceptanceFilter *afp,
+                               uint32_t num);
+#if CAN_USE_RX_QUEUES == TRUE
+  void canRxQueueObjectInit(CANRxQueue *rqp, CANRxFrame *buffer,
+                            size_t size, uint32_t filters);
+  void canAddRxQueue(CANDriver *canp, CANRxQueue *rqp);
+  size_t canReceiveMany(CANDriver *canp, CANRxQueue *rqp,
+                        CANRxFrame *crfp, size_t n, systime_t timeout);
+  void _can_rx_enqueue_i(CANDriver *canp, const CANRxFrame *crfp);
+#endif
+#if CAN_USE_TX_QUEUE == TRUE
+  void canTxQueueObjectInit(CANTxQueue *tqp, CANTxQueueEntry *buffer,
+                            size_t size);
+  void canSetTxQueue(CANDriver *canp, CANTxQueue *tqp);
+  bool canTransmitI(CANDriver *canp, const CANTxFrame *ctfp);
+  void _can_tx_refill_i(CANDriver *canp);
+#endif
+  uint32_t _can_arbitration_key(const CANTxFrame *ctfp);
 #if CAN_USE_SLEEP_MODE
   void canSleep(CANDriver *canp);
   void canWakeup(CANDriver *canp);
@@ -78,7 +78,9 @@ typedef struct {
   /* Write operations synchronization.*/                                    \
   bool (*sync)(void *instance);                                             \
   /* Obtains info about the media.*/                                        \
-  bool (*get_info)(void *instance, BlockDeviceInfo *bdip);
+  bool (*get_info)(void *instance, BlockDeviceInfo *bdip);                  \
+  /* Erases a range of blocks, it is only an hint.*/                        \
+  bool (*erase)(void *instance, uint32_t startblk, uint32_t endblk);
 
 /**
  * @brief   @p BaseBlockDevice specific data.
@@ -258,6 +260,24 @@ typedef struct {
  */
 #define blkGetInfo(ip, bdip) ((ip)->vmt->get_info(ip, bdip))
 
+/**
+ * @brief   Erases a range of blocks.
+ * @details The content of the erased blocks is undefined after the
+ *          operation, devices without an erase command just ignore it.
+ *
+ * @param[in] ip        pointer to a @p BaseBlockDevice or derived class
+ * @param[in] startblk  first block to erase
+ * @param[in] endblk    last block to erase
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+#define blkErase(ip, startblk, endblk)                                      \
+  ((ip)->vmt->erase(ip, startblk, endblk))
+
 /** @} */
 
 #endif /* _HAL_IOBLOCK_H_ */
@@ -62,6 +62,19 @@
 #define I2C_USE_MUTUAL_EXCLUSION    TRUE
 #endif
 
+/**
+ * @brief   Transactions queue inclusion switch.
+ * @details If enabled, several clients can submit transactions to the
+ *          driver, the transactions are chained by the low level driver
+ *          ISR without waking up the clients in between, see
+ *          @p i2cSubmit().
+ * @note    The low level driver must support the queue, see
+ *          @p I2C_SUPPORTS_QUEUE.
+ */
+#if !defined(I2C_USE_QUEUE) || defined(__DOXYGEN__)
+#define I2C_USE_QUEUE               FALSE
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -82,36 +95,155 @@ typedef enum {
   I2C_LOCKED = 5                            /**> Bus or driver locked.      */
 } i2cstate_t;
 
+#if (I2C_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of an I2C transaction.
+ */
+typedef struct i2c_transaction I2CTransaction;
+#endif
+
 #include "i2c_lld.h"
 
+/**
+ * @brief   Queue support in the low level driver.
+ * @details Low level drivers able to start a transfer without waiting,
+ *          from within the completion ISR, export this macro as @p TRUE
+ *          and implement @p i2c_lld_start_transfer().
+ */
+#if !defined(I2C_SUPPORTS_QUEUE) || defined(__DOXYGEN__)
+#define I2C_SUPPORTS_QUEUE          FALSE
+#endif
+
+#if (I2C_USE_QUEUE == TRUE) && (I2C_SUPPORTS_QUEUE == FALSE)
+#error "I2C_USE_QUEUE not supported by the I2C low level driver"
+#endif
+
+#if (I2C_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Transaction completion callback type.
+ * @note    The callback is invoked from the low level driver ISR, the next
+ *          queued transaction is already started.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] itp       pointer to the completed @p I2CTransaction object
+ */
+typedef void (*i2cqcallback_t)(I2CDriver *i2cp, I2CTransaction *itp);
+
+/**
+ * @brief   Structure representing an I2C transaction.
+ * @details A transaction is a write, a read or a write followed by a read
+ *          with a repeated start, addressed to a single slave.
+ */
+struct i2c_transaction {
+  /**
+   * @brief   Next queued transaction.
+   */
+  I2CTransaction            *next;
+  /**
+   * @brief   Slave device address (7 bits) without R/W bit.
+   */
+  i2caddr_t                 addr;
+  /**
+   * @brief   Transmit buffer or @p NULL.
+   */
+  const uint8_t             *txbuf;
+  /**
+   * @brief   Number of bytes to be transmitted.
+   */
+  size_t                    txbytes;
+  /**
+   * @brief   Receive buffer or @p NULL.
+   */
+  uint8_t                   *rxbuf;
+  /**
+   * @brief   Number of bytes to be received.
+   */
+  size_t                    rxbytes;
+  /**
+   * @brief   Completion callback or @p NULL.
+   */
+  i2cqcallback_t            callback;
+  /**
+   * @brief   Result of the last execution.
+   * @details @p MSG_OK, @p MSG_RESET if errors occurred or @p MSG_TIMEOUT
+   *          if the transaction has been discarded.
+   */
+  msg_t                     result;
+  /**
+   * @brief   Error flags of the last execution.
+   */
+  i2cflags_t                errors;
+  /**
+   * @brief   The transaction is queued or being executed.
+   */
+  bool                      pending;
+  /**
+   * @brief   Thread waiting for the completion.
+   */
+  thread_reference_t        thread;
+  /**
+   * @brief   Register address for register burst reads.
+   */
+  uint8_t                   reg;
+};
+#endif /* I2C_USE_QUEUE == TRUE */
+
 /*===========================================================================*/
 /* Driver macros.                                                            */
 /*===========================================================================*/
 
+/**
+ * @brief   Returns @p true if the ISR belongs to a queued transaction.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ *
+ * @notapi
+ */
+#if (I2C_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+#define _i2c_queue_running(i2cp) ((i2cp)->qhead != NULL)
+#else
+#define _i2c_queue_running(i2cp) false
+#define _i2c_queue_isr(i2cp, msg)
+#endif
+
 /**
  * @brief   Wakes up the waiting thread notifying no errors.
+ * @details If a queued transaction is being executed then the next one
+ *          is started instead.
  *
  * @param[in] i2cp      pointer to the @p I2CDriver object
  *
  * @notapi
  */
 #define _i2c_wakeup_isr(i2cp) do {                                          \
-  osalSysLockFromISR();                                                     \
-  osalThreadResumeI(&(i2cp)->thread, MSG_OK);                               \
-  osalSysUnlockFromISR();                                                   \
+  if (_i2c_queue_running(i2cp)) {                                           \
+    _i2c_queue_isr(i2cp, MSG_OK);                                           \
+  }                                                                         \
+  else {                                                                    \
+    osalSysLockFromISR();                                                   \
+    osalThreadResumeI(&(i2cp)->thread, MSG_OK);                             \
+    osalSysUnlockFromISR();                                                 \
+  }                                                                         \
 } while(0)
 
 /**
  * @brief   Wakes up the waiting thread notifying errors.
+ * @details If a queued transaction is being executed then the next one
+ *          is started instead.
  *
  * @param[in] i2cp      pointer to the @p I2CDriver object
  *
  * @notapi
  */
 #define _i2c_wakeup_error_isr(i2cp) do {                                    \
-  osalSysLockFromISR();                                                     \
-  osalThreadResumeI(&(i2cp)->thread, MSG_RESET);                            \
-  osalSysUnlockFromISR();                                                   \
+  if (_i2c_queue_running(i2cp)) {                                           \
+    _i2c_queue_isr(i2cp, MSG_RESET);                                        \
+  }                                                                         \
+  else {                                                                    \
+    osalSysLockFromISR();                                                   \
+    osalThreadResumeI(&(i2cp)->thread, MSG_RESET);                          \
+    osalSysUnlockFromISR();                                                 \
+  }                                                                         \
 } while(0)
 
 /**
@@ -129,6 +261,18 @@ typedef enum {
 #define i2cMasterReceive(i2cp, addr, rxbuf, rxbytes)                        \
   (i2cMasterReceiveTimeout(i2cp, addr, rxbuf, rxbytes, TIME_INFINITE))
 
+#if (I2C_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns @p true if the transaction is queued or being executed.
+ *
+ * @param[in] itp       pointer to the @p I2CTransaction object
+ * @return              The transaction state.
+ *
+ * @xclass
+ */
+#define i2cIsTransactionPendingX(itp) ((itp)->pending)
+#endif
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -154,6 +298,20 @@ extern "C" {
   void i2cAcquireBus(I2CDriver *i2cp);
   void i2cReleaseBus(I2CDriver *i2cp);
 #endif
+#if I2C_USE_QUEUE == TRUE
+  void i2cTransactionObjectInit(I2CTransaction *itp, i2caddr_t addr,
+                                const uint8_t *txbuf, size_t txbytes,
+                                uint8_t *rxbuf, size_t rxbytes,
+                                i2cqcallback_t callback);
+  void i2cRegisterTransactionObjectInit(I2CTransaction *itp, i2caddr_t addr,
+                                        uint8_t reg,
+                                        uint8_t *rxbuf, size_t rxbytes,
+                                        i2cqcallback_t callback);
+  void i2cSubmitI(I2CDriver *i2cp, I2CTransaction *itp);
+  void i2cSubmit(I2CDriver *i2cp, I2CTransaction *itp);
+  msg_t i2cTransact(I2CDriver *i2cp, I2CTransaction *itp, systime_t timeout);
+  void _i2c_queue_isr(I2CDriver *i2cp, msg_t msg);
+#endif
 
 #ifdef __cplusplus
 }
@@ -75,6 +75,31 @@ typedef enum {
  */
 typedef struct MACDriver MACDriver;
 
+#if (MAC_USE_ZERO_COPY == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of a buffer attached to a transmit descriptor.
+ */
+typedef struct {
+  /**
+   * @brief   Pointer to the buffer data.
+   */
+  const uint8_t         *buf;
+  /**
+   * @brief   Size of the buffer data.
+   */
+  size_t                size;
+} macbuffer_t;
+
+/**
+ * @brief   Type of a transmit completion callback.
+ * @note    It is invoked from ISR context or from @p macStop() with the
+ *          system locked, only I-class functions can be used.
+ *
+ * @param[in] arg       the parameter specified when attaching the buffers
+ */
+typedef void (*mactxcb_t)(void *arg);
+#endif /* MAC_USE_ZERO_COPY */
+
 #include "mac_lld.h"
 
 /*===========================================================================*/
@@ -167,6 +192,36 @@ typedef struct MACDriver MACDriver;
  */
 #define macGetNextReceiveBuffer(rdp, sizep)                                 \
   mac_lld_get_next_receive_buffer(rdp, sizep)
+
+/**
+ * @brief   Attaches a list of buffers to a transmit descriptor.
+ * @details The buffers are transmitted in order as a single frame without
+ *          being copied, the frame is started by
+ *          @p macReleaseTransmitDescriptor() as usual. The buffers must not
+ *          be modified until the callback is invoked.
+ * @note    The descriptor must be empty, attached buffers and data written
+ *          into the descriptor cannot be mixed in the same frame.
+ * @note    The buffers must be located in memory reachable by the MAC DMA.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[in] tdp       pointer to a @p MACTransmitDescriptor structure
+ * @param[in] bp        pointer to an array of @p macbuffer_t structures,
+ *                      the array itself is no more used after returning
+ * @param[in] n         number of buffers
+ * @param[in] cb        callback invoked when the MAC is done with the
+ *                      buffers, it can be @p NULL
+ * @param[in] arg       parameter passed to the callback
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the buffers have been attached.
+ * @retval HAL_FAILED   the buffers cannot be attached because they are too
+ *                      many, the frame is too large or there are not enough
+ *                      free physical descriptors. The descriptor is left
+ *                      empty and the frame can be written into it.
+ *
+ * @api
+ */
+#define macAttachTransmitBuffers(macp, tdp, bp, n, cb, arg)                 \
+  mac_lld_attach_transmit_buffers(macp, tdp, bp, n, cb, arg)
 #endif /* MAC_USE_ZERO_COPY */
 /** @} */
 
@@ -55,6 +55,22 @@
 #if !defined(MMC_NICE_WAITING) || defined(__DOXYGEN__)
 #define MMC_NICE_WAITING            TRUE
 #endif
+
+/**
+ * @brief   Enables the asynchronous transfers API.
+ * @details Each driver embeds a requests queue, transfers started using
+ *          @p mmcStartRead() and @p mmcStartWrite() are executed by a
+ *          thread invoking @p mmcServe().
+ * @note    The transfers made through the block device interface are
+ *          queued too, the serving thread must be started before
+ *          accessing the card.
+ * @note    The block I/O module is required, os/hal/lib/blocks/blkio.c
+ *          must be added to the build and its directory to the include
+ *          paths.
+ */
+#if !defined(MMC_USE_ASYNC) || defined(__DOXYGEN__)
+#define MMC_USE_ASYNC               FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -65,6 +81,10 @@
 #error "MMC_SPI driver requires HAL_USE_SPI and SPI_USE_WAIT"
 #endif
 
+#if MMC_USE_ASYNC == TRUE
+#include "blkio.h"
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -121,6 +141,16 @@ typedef struct {
    * @brief Addresses use blocks instead of bytes.
    */
   bool                  block_addresses;
+  /**
+   * @brief The card accepts SD application specific commands.
+   */
+  bool                  sd_card;
+#if (MMC_USE_ASYNC == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief Asynchronous requests queue.
+   */
+  BlockIOQueue          queue;
+#endif
 } MMCDriver;
 
 /*===========================================================================*/
@@ -177,11 +207,21 @@ extern "C" {
   bool mmcSequentialRead(MMCDriver *mmcp, uint8_t *buffer);
   bool mmcStopSequentialRead(MMCDriver *mmcp);
   bool mmcStartSequentialWrite(MMCDriver *mmcp, uint32_t startblk);
+  bool mmcStartMultipleWrite(MMCDriver *mmcp, uint32_t startblk, uint32_t n);
   bool mmcSequentialWrite(MMCDriver *mmcp, const uint8_t *buffer);
   bool mmcStopSequentialWrite(MMCDriver *mmcp);
   bool mmcSync(MMCDriver *mmcp);
   bool mmcGetInfo(MMCDriver *mmcp, BlockDeviceInfo *bdip);
   bool mmcErase(MMCDriver *mmcp, uint32_t startblk, uint32_t endblk);
+#if MMC_USE_ASYNC == TRUE
+  void mmcStartRead(MMCDriver *mmcp, blkio_request_t *reqp,
+                    uint32_t startblk, uint8_t *buf, uint32_t n,
+                    blkiocb_t cb);
+  void mmcStartWrite(MMCDriver *mmcp, blkio_request_t *reqp,
+                     uint32_t startblk, const uint8_t *buf, uint32_t n,
+                     blkiocb_t cb);
+  void mmcServe(MMCDriver *mmcp);
+#endif
   bool mmc_lld_is_card_inserted(MMCDriver *mmcp);
   bool mmc_lld_is_write_protected(MMCDriver *mmcp);
 #ifdef __cplusplus
@@ -92,12 +92,44 @@
 #if !defined(SDC_NICE_WAITING) || defined(__DOXYGEN__)
 #define SDC_NICE_WAITING                    TRUE
 #endif
+
+/**
+ * @brief   Size, in blocks, of the bounce buffer for unaligned transfers.
+ * @details If different from zero, transfers using buffers not aligned as
+ *          required by the low level driver are performed through a
+ *          statically allocated bounce buffer, using a multi-block
+ *          operation for each chunk of this size.
+ * @note    The bounce buffer is shared among all SDC drivers, unaligned
+ *          transfers on different drivers are serialized by a mutex.
+ */
+#if !defined(SDC_UNALIGNED_BOUNCE_BLOCKS) || defined(__DOXYGEN__)
+#define SDC_UNALIGNED_BOUNCE_BLOCKS         0
+#endif
+
+/**
+ * @brief   Enables the asynchronous transfers API.
+ * @details Each driver embeds a requests queue, transfers started using
+ *          @p sdcStartRead() and @p sdcStartWrite() are executed by a
+ *          thread invoking @p sdcServe().
+ * @note    The blocking transfers are queued too, the serving thread must
+ *          be started before accessing the card.
+ * @note    The block I/O module is required, os/hal/lib/blocks/blkio.c
+ *          must be added to the build and its directory to the include
+ *          paths.
+ */
+#if !defined(SDC_USE_ASYNC) || defined(__DOXYGEN__)
+#define SDC_USE_ASYNC                       FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if SDC_UNALIGNED_BOUNCE_BLOCKS < 0
+#error "invalid SDC_UNALIGNED_BOUNCE_BLOCKS value"
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -119,6 +151,10 @@ typedef enum {
   SDC_CLK_50MHz
 } sdcbusclk_t;
 
+#if SDC_USE_ASYNC == TRUE
+#include "blkio.h"
+#endif
+
 #include "sdc_lld.h"
 
 /*===========================================================================*/
@@ -179,6 +215,15 @@ extern "C" {
                uint8_t *buf, uint32_t n);
   bool sdcWrite(SDCDriver *sdcp, uint32_t startblk,
                 const uint8_t *buf, uint32_t n);
+#if SDC_USE_ASYNC == TRUE
+  void sdcStartRead(SDCDriver *sdcp, blkio_request_t *reqp,
+                    uint32_t startblk, uint8_t *buf, uint32_t n,
+                    blkiocb_t cb);
+  void sdcStartWrite(SDCDriver *sdcp, blkio_request_t *reqp,
+                     uint32_t startblk, const uint8_t *buf, uint32_t n,
+                     blkiocb_t cb);
+  void sdcServe(SDCDriver *sdcp);
+#endif
   sdcflags_t sdcGetAndClearErrors(SDCDriver *sdcp);
   bool sdcSync(SDCDriver *sdcp);
   bool sdcGetInfo(SDCDriver *sdcp, BlockDeviceInfo *bdip);
@@ -54,6 +54,16 @@
 #if !defined(SPI_USE_MUTUAL_EXCLUSION) || defined(__DOXYGEN__)
 #define SPI_USE_MUTUAL_EXCLUSION    TRUE
 #endif
+
+/**
+ * @brief   Transactions queue inclusion switch.
+ * @details If enabled, several clients can submit transactions to the
+ *          driver, the transactions are executed back to back by the low
+ *          level driver ISR, see @p spiSubmit().
+ */
+#if !defined(SPI_USE_QUEUE) || defined(__DOXYGEN__)
+#define SPI_USE_QUEUE               FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -75,8 +85,90 @@ typedef enum {
   SPI_COMPLETE = 4                  /**< Asynchronous operation complete.   */
 } spistate_t;
 
+#if (SPI_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of an SPI transaction.
+ */
+typedef struct spi_transaction SPITransaction;
+
+/**
+ * @brief   Transfer descriptor.
+ * @details A transfer is an exchange if both buffers are specified, a send
+ *          or a receive if only one buffer is specified, idle words are
+ *          sent and the received data ignored if no buffers are specified.
+ * @note    The buffers are organized as uint8_t arrays for data sizes below
+ *          or equal to 8 bits else it is organized as uint16_t arrays.
+ */
+typedef struct {
+  /**
+   * @brief   Number of words to be transferred.
+   */
+  size_t                    n;
+  /**
+   * @brief   Transmit buffer or @p NULL.
+   */
+  const void                *txbuf;
+  /**
+   * @brief   Receive buffer or @p NULL.
+   */
+  void                      *rxbuf;
+} SPITransfer;
+#endif /* SPI_USE_QUEUE == TRUE */
+
 #include "spi_lld.h"
 
+#if (SPI_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Transaction completion callback type.
+ * @note    The callback is invoked from the low level driver ISR, the next
+ *          queued transaction is already started.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] stp       pointer to the completed @p SPITransaction object
+ */
+typedef void (*spiqcallback_t)(SPIDriver *spip, SPITransaction *stp);
+
+/**
+ * @brief   Structure representing an SPI transaction.
+ * @details A transaction is a list of transfers executed with the slave
+ *          selected, the driver is reconfigured before the transaction
+ *          only if its configuration requires a different peripheral
+ *          setup.
+ */
+struct spi_transaction {
+  /**
+   * @brief   Next queued transaction.
+   */
+  SPITransaction            *next;
+  /**
+   * @brief   Configuration of the slave, including its select line.
+   */
+  const SPIConfig           *config;
+  /**
+   * @brief   Transfers list.
+   */
+  const SPITransfer         *transfers;
+  /**
+   * @brief   Number of transfers.
+   */
+  size_t                    n;
+  /**
+   * @brief   Completion callback or @p NULL.
+   */
+  spiqcallback_t            callback;
+  /**
+   * @brief   The transaction is queued or being executed.
+   */
+  bool                      pending;
+#if (SPI_USE_WAIT == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Thread waiting for the completion.
+   */
+  thread_reference_t        thread;
+#endif
+};
+#endif /* SPI_USE_QUEUE == TRUE */
+
 /*===========================================================================*/
 /* Driver macros.                                                            */
 /*===========================================================================*/
@@ -202,8 +294,39 @@ typedef enum {
  * @return              The received data frame from the SPI bus.
  */
 #define spiPolledExchange(spip, frame) spi_lld_polled_exchange(spip, frame)
+
+#if (SPI_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns @p true if the transaction is queued or being executed.
+ *
+ * @param[in] stp       pointer to the @p SPITransaction object
+ * @return              The transaction state.
+ *
+ * @xclass
+ */
+#define spiIsTransactionPendingX(stp) ((stp)->pending)
+#endif
 /** @} */
 
+/**
+ * @brief   Compares the peripheral setup of two configurations.
+ * @details Low level drivers can redefine this macro so that slaves
+ *          sharing the same clock and frame settings do not require the
+ *          peripheral to be reprogrammed between queued transactions.
+ *
+ * @param[in] cfg1      pointer to the first @p SPIConfig object
+ * @param[in] cfg2      pointer to the second @p SPIConfig object
+ * @return              The comparison result.
+ * @retval false        the peripheral must be reprogrammed.
+ * @retval true         the configurations only differ in the select line
+ *                      or in the callback.
+ *
+ * @notapi
+ */
+#if !defined(spi_lld_same_setup) || defined(__DOXYGEN__)
+#define spi_lld_same_setup(cfg1, cfg2) false
+#endif
+
 /**
  * @name    Low level driver helper macros
  * @{
@@ -225,12 +348,27 @@ typedef enum {
 #define _spi_wakeup_isr(spip)
 #endif /* !SPI_USE_WAIT */
 
+/**
+ * @brief   Returns @p true if the ISR belongs to a queued transaction.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+#if (SPI_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+#define _spi_queue_running(spip) ((spip)->qhead != NULL)
+#else
+#define _spi_queue_running(spip) false
+#define _spi_queue_isr(spip)
+#endif
+
 /**
  * @brief   Common ISR code.
  * @details This code handles the portable part of the ISR code:
  *          - Callback invocation.
  *          - Waiting thread wakeup, if any.
  *          - Driver state transitions.
+ *          - Next queued transfer, if any.
  *          .
  * @note    This macro is meant to be used in the low level drivers
  *          implementation only.
@@ -240,7 +378,10 @@ typedef enum {
  * @notapi
  */
 #define _spi_isr_code(spip) {                                               \
-  if ((spip)->config->end_cb) {                                             \
+  if (_spi_queue_running(spip)) {                                           \
+    _spi_queue_isr(spip);                                                   \
+  }                                                                         \
+  else if ((spip)->config->end_cb) {                                        \
     (spip)->state = SPI_COMPLETE;                                           \
     (spip)->config->end_cb(spip);                                           \
     if ((spip)->state == SPI_COMPLETE)                                      \
@@ -280,6 +421,17 @@ extern "C" {
   void spiAcquireBus(SPIDriver *spip);
   void spiReleaseBus(SPIDriver *spip);
 #endif
+#if SPI_USE_QUEUE == TRUE
+  void spiTransactionObjectInit(SPITransaction *stp, const SPIConfig *config,
+                                const SPITransfer *transfers, size_t n,
+                                spiqcallback_t callback);
+  void spiSubmitI(SPIDriver *spip, SPITransaction *stp);
+  void spiSubmit(SPIDriver *spip, SPITransaction *stp);
+#if SPI_USE_WAIT == TRUE
+  void spiTransact(SPIDriver *spip, SPITransaction *stp);
+#endif
+  void _spi_queue_isr(SPIDriver *spip);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -43,6 +43,15 @@
 #define UART_BREAK_DETECTED     64  /**< @brief Break detected.             */
 /** @} */
 
+/**
+ * @name    UART frame boundary modes
+ * @{
+ */
+#define UART_FRAME_ON_IDLE      1U  /**< @brief Frame ends on idle line.    */
+#define UART_FRAME_ON_DELIMITER 2U  /**< @brief Frame ends on delimiter.    */
+#define UART_FRAME_ON_TIMEOUT   4U  /**< @brief Frame ends on wait timeout. */
+/** @} */
+
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -66,6 +75,15 @@
 #if !defined(UART_USE_MUTUAL_EXCLUSION) || defined(__DOXYGEN__)
 #define UART_USE_MUTUAL_EXCLUSION           FALSE
 #endif
+
+/**
+ * @brief   Enables the @p uartStartFrameReceive() and
+ *          @p uartGetFrameTimeout() APIs.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(UART_USE_FRAMES) || defined(__DOXYGEN__)
+#define UART_USE_FRAMES                     FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -100,19 +118,99 @@ typedef enum {
 typedef enum {
   UART_RX_IDLE = 0,                 /**< Not receiving.                     */
   UART_RX_ACTIVE = 1,               /**< Receiving.                         */
-  UART_RX_COMPLETE = 2              /**< Buffer complete.                   */
+  UART_RX_COMPLETE = 2,             /**< Buffer complete.                   */
+  UART_RX_FRAMED = 3                /**< Framed reception.                  */
 } uartrxstate_t;
 
+/**
+ * @brief   Type of a framed receive configuration.
+ */
+typedef struct uart_frame_config UARTFrameConfig;
+
 #include "uart_lld.h"
 
+/**
+ * @brief   Framed receive support by the low level driver.
+ */
+#if !defined(UART_SUPPORTS_FRAMES) || defined(__DOXYGEN__)
+#define UART_SUPPORTS_FRAMES                FALSE
+#endif
+
+#if (UART_USE_FRAMES == TRUE) && (UART_SUPPORTS_FRAMES == FALSE)
+#error "UART_USE_FRAMES not supported by the low level driver"
+#endif
+
+/**
+ * @brief   Framed receive configuration.
+ * @details The receiver runs continuously into a circular buffer, the
+ *          low level driver reports the half and full buffer marks and
+ *          the idle line condition, the received data is scanned for
+ *          frame boundaries on those events. Each frame is copied in a
+ *          buffer of the input buffers queue, frames longer than the queue
+ *          buffers or arriving when the queue is full are dropped as a
+ *          whole.
+ */
+struct uart_frame_config {
+  /**
+   * @brief   Circular receive buffer.
+   * @note    Data must arrive at a rate such that less than half buffer
+   *          is received during the worst case interrupt latency.
+   */
+  uint8_t                   *ring;
+  /**
+   * @brief   Circular receive buffer size.
+   */
+  size_t                    size;
+  /**
+   * @brief   Buffers queue receiving the frames.
+   */
+  input_buffers_queue_t     *ibqp;
+  /**
+   * @brief   Frame boundary modes mask.
+   */
+  uint32_t                  mode;
+  /**
+   * @brief   Frame delimiter, it is stored as last byte of the frame.
+   */
+  uint8_t                   delimiter;
+  /**
+   * @brief   Frames posted callback or @p NULL.
+   * @note    It is invoked from ISR context.
+   */
+  uartcb_t                  frame_cb;
+};
+
 /*===========================================================================*/
 /* Driver macros.                                                            */
 /*===========================================================================*/
 
+/**
+ * @brief   Releases the frame obtained by @p uartGetFrameTimeout().
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ *
+ * @api
+ */
+#define uartReleaseFrame(uartp) ibqReleaseEmptyBuffer((uartp)->frcfg->ibqp)
+
 /**
  * @name    Low level driver helper macros
  * @{
  */
+#if (UART_USE_FRAMES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Checks if the receiver is in framed mode.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ *
+ * @notapi
+ */
+#define _uart_rx_frame_running(uartp) ((uartp)->rxstate == UART_RX_FRAMED)
+#else /* !UART_USE_FRAMES */
+#define _uart_rx_frame_running(uartp) false
+#define _uart_rx_frame_isr(uartp, idle)
+#endif /* !UART_USE_FRAMES */
+
 #if (UART_USE_WAIT == TRUE) || defined(__DOXYGEN__)
 /**
  * @brief   Wakes up the waiting thread in case of early TX complete.
@@ -331,6 +429,12 @@ extern "C" {
   void uartAcquireBus(UARTDriver *uartp);
   void uartReleaseBus(UARTDriver *uartp);
 #endif
+#if UART_USE_FRAMES == TRUE
+  void uartStartFrameReceive(UARTDriver *uartp, const UARTFrameConfig *fcp);
+  void uartStopFrameReceive(UARTDriver *uartp);
+  msg_t uartGetFrameTimeout(UARTDriver *uartp, systime_t timeout);
+  void _uart_rx_frame_isr(UARTDriver *uartp, bool idle);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,453 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    adcstream.c
+ * @brief   ADC streaming code.
+ * @details Streams are continuous conversions using a circular ADC buffer,
+ *          each half buffer completed by the ADC is decimated by the ADC
+ *          callback into the next free block of a ring. A consumer thread
+ *          accesses the filled blocks in place, without further copies.
+ *          Pass-through streams have a single block pointing to the half
+ *          buffer itself, it must be released before the ADC completes
+ *          the other half.
+ *          If the ring is full when a half buffer is completed then the
+ *          half buffer is lost and counted, the next block reports the
+ *          number of half buffers lost before it.
+ *
+ * @addtogroup adc_stream
+ * @{
+ */
+
+#include <string.h>
+
+#include "hal.h"
+#include "adcstream.h"
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Active streams.
+ */
+static ADCStream *streams;
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Scales an accumulator by the decimator gain.
+ *
+ * @param[in] asp       pointer to the @p ADCStream object
+ * @param[in] acc       accumulator value
+ * @return              The scaled sample.
+ *
+ * @notapi
+ */
+static inline adcsample_t adcs_scale(const ADCStream *asp, uint32_t acc) {
+
+  if (asp->shift >= 0) {
+    return (adcsample_t)(acc >> asp->shift);
+  }
+  return (adcsample_t)(acc / asp->gain);
+}
+
+/**
+ * @brief   Boxcar decimator.
+ * @details Each output row is the average of @p ratio input rows.
+ *
+ * @param[in] asp       pointer to the @p ADCStream object
+ * @param[out] op       pointer to the output block
+ * @param[in] ip        pointer to the input half buffer
+ * @param[in] n         number of input rows
+ *
+ * @notapi
+ */
+static void adcs_boxcar(ADCStream *asp, adcsample_t *op,
+                        const adcsample_t *ip, size_t n) {
+  size_t ch = asp->config->grpp->num_channels;
+  uint32_t ratio = asp->config->ratio;
+  size_t o, c;
+  uint32_t r;
+
+#if ADCS_USE_SIMD
+  if (asp->simd && (sizeof (adcsample_t) == 2U)) {
+    const uint32_t *ip32 = (const uint32_t *)ip;
+    uint32_t *op32 = (uint32_t *)op;
+    size_t pairs = ch / 2U;
+
+    /* Two channels are accumulated at once in the two halves of a word,
+       the accumulators are known to not overflow 16 bits.*/
+    for (o = 0U; o < n / ratio; o++) {
+      uint32_t acc[ADCS_MAX_CHANNELS / 2];
+
+      for (c = 0U; c < pairs; c++) {
+        acc[c] = 0U;
+      }
+      for (r = 0U; r < ratio; r++) {
+        for (c = 0U; c < pairs; c++) {
+          acc[c] = __UADD16(acc[c], *ip32++);
+        }
+      }
+      for (c = 0U; c < pairs; c++) {
+        *op32++ = (uint32_t)adcs_scale(asp, acc[c] & 0xFFFFU) |
+                  ((uint32_t)adcs_scale(asp, acc[c] >> 16U) << 16U);
+      }
+    }
+    return;
+  }
+#endif /* ADCS_USE_SIMD */
+
+  for (o = 0U; o < n / ratio; o++) {
+    uint32_t acc[ADCS_MAX_CHANNELS];
+
+    for (c = 0U; c < ch; c++) {
+      acc[c] = 0U;
+    }
+    for (r = 0U; r < ratio; r++) {
+      for (c = 0U; c < ch; c++) {
+        acc[c] += (uint32_t)*ip++;
+      }
+    }
+    for (c = 0U; c < ch; c++) {
+      *op++ = adcs_scale(asp, acc[c]);
+    }
+  }
+}
+
+/**
+ * @brief   CIC decimator.
+ * @details The integrators run at the input rate, the combs at the output
+ *          rate. The arithmetic is modulo 2^32, the result is exact as long
+ *          as the decimator gain times the maximum sample fits in 32 bits.
+ *
+ * @param[in] asp       pointer to the @p ADCStream object
+ * @param[out] op       pointer to the output block
+ * @param[in] ip        pointer to the input half buffer
+ * @param[in] n         number of input rows
+ *
+ * @notapi
+ */
+static void adcs_cic(ADCStream *asp, adcsample_t *op,
+                     const adcsample_t *ip, size_t n) {
+  size_t ch = asp->config->grpp->num_channels;
+  uint32_t ratio = asp->config->ratio;
+  uint32_t order = asp->config->order;
+  size_t o, c;
+  uint32_t r, k;
+
+  for (o = 0U; o < n / ratio; o++) {
+    for (r = 0U; r < ratio; r++) {
+      for (c = 0U; c < ch; c++) {
+        uint32_t *integ = asp->integ[c];
+
+        integ[0] += (uint32_t)*ip++;
+        for (k = 1U; k < order; k++) {
+          integ[k] += integ[k - 1U];
+        }
+      }
+    }
+    for (c = 0U; c < ch; c++) {
+      uint32_t *comb = asp->comb[c];
+      uint32_t y = asp->integ[c][order - 1U];
+
+      for (k = 0U; k < order; k++) {
+        uint32_t t = y;
+
+        y -= comb[k];
+        comb[k] = t;
+      }
+      *op++ = adcs_scale(asp, y);
+    }
+  }
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes an @p ADCStream object.
+ *
+ * @param[out] asp      pointer to the @p ADCStream object
+ *
+ * @init
+ */
+void adcsObjectInit(ADCStream *asp) {
+
+  asp->next   = NULL;
+  asp->state  = ADCS_STOP;
+  asp->config = NULL;
+  osalThreadQueueObjectInit(&asp->waiting);
+}
+
+/**
+ * @brief   Starts a stream.
+ * @details The blocks ring is reset and the continuous conversion is
+ *          started.
+ *
+ * @param[in] asp       pointer to the @p ADCStream object
+ * @param[in] config    pointer to the @p ADCStreamConfig object
+ *
+ * @api
+ */
+void adcsStart(ADCStream *asp, const ADCStreamConfig *config) {
+  const ADCConversionGroup *grpp;
+  size_t i, ch;
+  uint32_t ratio;
+  uint64_t gain;
+
+  osalDbgCheck((asp != NULL) && (config != NULL) &&
+               (config->adcp != NULL) && (config->grpp != NULL) &&
+               (config->dmabuf != NULL) && (config->blocks != NULL) &&
+               ((config->ring != NULL) ||
+                (config->filter == ADCS_FILTER_NONE)) &&
+               (config->nblocks > 0U) &&
+               (config->depth >= 2U) && ((config->depth & 1U) == 0U));
+  osalDbgAssert((config->filter != ADCS_FILTER_NONE) ||
+                (config->nblocks == 1U), "invalid ring");
+
+  grpp = config->grpp;
+  ch   = grpp->num_channels;
+  osalDbgAssert(grpp->circular && (grpp->end_cb == adcsEndCallback),
+                "invalid conversion group");
+
+  /* Decimator setup.*/
+  ratio = config->filter == ADCS_FILTER_NONE ? 1U : config->ratio;
+  osalDbgAssert((ratio > 0U) && (((config->depth / 2U) % ratio) == 0U),
+                "invalid ratio");
+  osalDbgAssert((config->filter == ADCS_FILTER_NONE) ||
+                (ch <= ADCS_MAX_CHANNELS), "too many channels");
+  gain = ratio;
+  if (config->filter == ADCS_FILTER_CIC) {
+    osalDbgAssert((config->order > 0U) &&
+                  (config->order <= ADCS_CIC_MAX_ORDER), "invalid order");
+    for (i = 1U; i < config->order; i++) {
+      gain *= ratio;
+    }
+    memset(asp->integ, 0, sizeof asp->integ);
+    memset(asp->comb, 0, sizeof asp->comb);
+  }
+  osalDbgAssert((gain << ADCS_SAMPLE_BITS) <= 0x100000000ULL,
+                "decimator gain too large");
+  asp->gain  = (uint32_t)gain;
+  asp->shift = -1;
+  if ((asp->gain & (asp->gain - 1U)) == 0U) {
+    asp->shift = 0;
+    while ((1U << asp->shift) < asp->gain) {
+      asp->shift++;
+    }
+  }
+  asp->simd = (bool)(ADCS_USE_SIMD &&
+                     (sizeof (adcsample_t) == 2U) &&
+                     (config->filter == ADCS_FILTER_BOXCAR) &&
+                     ((ch & 1U) == 0U) &&
+                     ((gain << ADCS_SAMPLE_BITS) <= 0x10000U) &&
+                     (((size_t)config->dmabuf & 3U) == 0U) &&
+                     (((size_t)config->ring & 3U) == 0U));
+
+  /* Blocks ring setup.*/
+  asp->rows = (config->depth / 2U) / ratio;
+  for (i = 0U; i < config->nblocks; i++) {
+    config->blocks[i].samples = config->filter == ADCS_FILTER_NONE ? NULL :
+                                config->ring + (i * asp->rows * ch);
+    config->blocks[i].n       = asp->rows;
+    config->blocks[i].seq     = 0U;
+    config->blocks[i].lost    = 0U;
+  }
+
+  osalSysLock();
+  osalDbgAssert(asp->state == ADCS_STOP, "invalid state");
+  asp->config   = config;
+  asp->wridx    = 0U;
+  asp->rdidx    = 0U;
+  asp->full     = 0U;
+  asp->seq      = 0U;
+  asp->lost     = 0U;
+  asp->overruns = 0U;
+  asp->state    = ADCS_ACTIVE;
+  asp->next     = streams;
+  streams       = asp;
+  adcStartConversionI(config->adcp, grpp, config->dmabuf, config->depth);
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Stops a stream.
+ * @details The conversion is stopped and a thread waiting for a block is
+ *          released, the blocks not yet consumed are discarded.
+ *
+ * @param[in] asp       pointer to the @p ADCStream object
+ *
+ * @api
+ */
+void adcsStop(ADCStream *asp) {
+  ADCStream **aspp;
+
+  osalDbgCheck(asp != NULL);
+
+  osalSysLock();
+  osalDbgAssert(asp->state == ADCS_ACTIVE, "invalid state");
+  adcStopConversionI(asp->config->adcp);
+  aspp = &streams;
+  while (*aspp != asp) {
+    aspp = &(*aspp)->next;
+  }
+  *aspp = asp->next;
+  asp->state = ADCS_STOP;
+  osalThreadDequeueAllI(&asp->waiting, MSG_RESET);
+  osalOsRescheduleS();
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Returns the oldest filled block.
+ * @details The block is accessed in place and is not reused by the stream
+ *          until it is released using @p adcsReleaseBlock().
+ * @note    A single consumer thread is supported.
+ *
+ * @param[in] asp       pointer to the @p ADCStream object
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              A pointer to the block.
+ * @retval NULL         if the operation timed out or the stream has been
+ *                      stopped.
+ *
+ * @api
+ */
+ADCStreamBlock *adcsGetBlockTimeout(ADCStream *asp, systime_t timeout) {
+  ADCStreamBlock *bp;
+
+  osalDbgCheck(asp != NULL);
+
+  osalSysLock();
+  while (asp->full == 0U) {
+    if ((asp->state != ADCS_ACTIVE) ||
+        (osalThreadEnqueueTimeoutS(&asp->waiting, timeout) != MSG_OK)) {
+      osalSysUnlock();
+      return NULL;
+    }
+  }
+  bp = &asp->config->blocks[asp->rdidx];
+  osalSysUnlock();
+
+  return bp;
+}
+
+/**
+ * @brief   Releases the block obtained by @p adcsGetBlockTimeout().
+ * @note    A pass-through block released after the ADC completed the
+ *          other half buffer has been overwritten while in use, its half
+ *          buffer is counted as lost.
+ *
+ * @param[in] asp       pointer to the @p ADCStream object
+ *
+ * @api
+ */
+void adcsReleaseBlock(ADCStream *asp) {
+
+  osalDbgCheck(asp != NULL);
+
+  osalSysLock();
+  osalDbgAssert(asp->full > 0U, "no block");
+  if ((asp->config->filter == ADCS_FILTER_NONE) &&
+      ((asp->seq - asp->config->blocks[asp->rdidx].seq) > 1U)) {
+    asp->overruns++;
+  }
+  if (++asp->rdidx >= asp->config->nblocks) {
+    asp->rdidx = 0U;
+  }
+  asp->full--;
+  osalSysUnlock();
+}
+
+/**
+ * @brief   ADC end of conversion callback of the streams.
+ * @details This function must be specified as end callback of the
+ *          conversion groups used by streams.
+ * @note    The half buffer is processed outside the critical zone, the
+ *          block being filled is not visible to the consumer until
+ *          complete. Pass-through blocks just point to the half buffer.
+ * @note    Half buffers lost on overrun are not seen by the CIC decimator,
+ *          the output has a discontinuity.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ * @param[in] buffer    pointer to the completed half buffer
+ * @param[in] n         number of rows in the half buffer
+ *
+ * @special
+ */
+void adcsEndCallback(ADCDriver *adcp, adcsample_t *buffer, size_t n) {
+  ADCStream *asp;
+  ADCStreamBlock *bp;
+
+  osalSysLockFromISR();
+  asp = streams;
+  while ((asp != NULL) && (asp->config->adcp != adcp)) {
+    asp = asp->next;
+  }
+  if (asp == NULL) {
+    osalSysUnlockFromISR();
+    return;
+  }
+  if (asp->full >= asp->config->nblocks) {
+    asp->seq++;
+    asp->lost++;
+    asp->overruns++;
+    osalSysUnlockFromISR();
+    return;
+  }
+  bp = &asp->config->blocks[asp->wridx];
+  osalSysUnlockFromISR();
+
+  switch (asp->config->filter) {
+  case ADCS_FILTER_BOXCAR:
+    adcs_boxcar(asp, bp->samples, buffer, n);
+    break;
+  case ADCS_FILTER_CIC:
+    adcs_cic(asp, bp->samples, buffer, n);
+    break;
+  default:
+    bp->samples = buffer;
+    break;
+  }
+
+  osalSysLockFromISR();
+  bp->seq  = asp->seq++;
+  bp->lost = asp->lost;
+  asp->lost = 0U;
+  if (++asp->wridx >= asp->config->nblocks) {
+    asp->wridx = 0U;
+  }
+  asp->full++;
+  osalThreadDequeueNextI(&asp->waiting, MSG_OK);
+  osalSysUnlockFromISR();
+}
+
+/** @} */
@@ -0,0 +1,321 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    adcstream.h
+ * @brief   ADC streaming structures and macros.
+ *
+ * @addtogroup adc_stream
+ * @{
+ */
+
+#ifndef _ADCSTREAM_H_
+#define _ADCSTREAM_H_
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    ADC streaming configuration options
+ * @{
+ */
+/**
+ * @brief   Maximum number of channels of a decimated stream.
+ */
+#if !defined(ADCS_MAX_CHANNELS) || defined(__DOXYGEN__)
+#define ADCS_MAX_CHANNELS                   8
+#endif
+
+/**
+ * @brief   Maximum order of the CIC decimator.
+ */
+#if !defined(ADCS_CIC_MAX_ORDER) || defined(__DOXYGEN__)
+#define ADCS_CIC_MAX_ORDER                  4
+#endif
+
+/**
+ * @brief   Resolution of the converted samples.
+ * @details It is used to determine when the boxcar accumulators can be
+ *          16 bits wide.
+ */
+#if !defined(ADCS_SAMPLE_BITS) || defined(__DOXYGEN__)
+#define ADCS_SAMPLE_BITS                    12
+#endif
+
+/**
+ * @brief   Enables the use of the DSP instructions.
+ * @details If enabled, the boxcar decimator accumulates two channels at
+ *          once using the SIMD instructions of the Cortex-M4 and M7 cores.
+ * @note    The default is @p TRUE if the compiler reports the availability
+ *          of the DSP extension.
+ */
+#if !defined(ADCS_USE_SIMD) || defined(__DOXYGEN__)
+#if defined(__ARM_FEATURE_DSP) || defined(__DOXYGEN__)
+#define ADCS_USE_SIMD                       TRUE
+#else
+#define ADCS_USE_SIMD                       FALSE
+#endif
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if !HAL_USE_ADC
+#error "ADC streaming requires HAL_USE_ADC"
+#endif
+
+#if (ADCS_CIC_MAX_ORDER < 1) || (ADCS_CIC_MAX_ORDER > 8)
+#error "invalid ADCS_CIC_MAX_ORDER value"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a decimation stage.
+ */
+typedef enum {
+  ADCS_FILTER_NONE = 0,             /**< Samples passed in place.           */
+  ADCS_FILTER_BOXCAR = 1,           /**< Average of each group of samples.  */
+  ADCS_FILTER_CIC = 2               /**< Integer CIC decimator.             */
+} adcsfilter_t;
+
+/**
+ * @brief   Type of a stream state.
+ */
+typedef enum {
+  ADCS_STOP = 0,                    /**< Not streaming.                     */
+  ADCS_ACTIVE = 1                   /**< Streaming.                         */
+} adcsstate_t;
+
+/**
+ * @brief   Structure representing a block of samples.
+ */
+typedef struct {
+  /**
+   * @brief   Samples, organized as the ADC buffer.
+   */
+  adcsample_t               *samples;
+  /**
+   * @brief   Number of rows in the block.
+   */
+  size_t                    n;
+  /**
+   * @brief   Sequence number of the half buffer the block comes from.
+   */
+  uint32_t                  seq;
+  /**
+   * @brief   Half buffers lost just before this block.
+   */
+  uint32_t                  lost;
+} ADCStreamBlock;
+
+/**
+ * @brief   Stream configuration structure.
+ */
+typedef struct {
+  /**
+   * @brief   ADC driver, it must be already started.
+   */
+  ADCDriver                 *adcp;
+  /**
+   * @brief   Conversion group.
+   * @note    The group must be circular and its end callback must be
+   *          @p adcsEndCallback().
+   */
+  const ADCConversionGroup  *grpp;
+  /**
+   * @brief   Buffer used by the ADC.
+   */
+  adcsample_t               *dmabuf;
+  /**
+   * @brief   ADC buffer depth, it must be even.
+   */
+  size_t                    depth;
+  /**
+   * @brief   Blocks ring.
+   */
+  ADCStreamBlock            *blocks;
+  /**
+   * @brief   Samples storage of the blocks ring.
+   * @note    The size must be @p ADCS_RING_SIZE() samples.
+   * @note    It is not used by pass-through streams and can be @p NULL.
+   */
+  adcsample_t               *ring;
+  /**
+   * @brief   Number of blocks in the ring.
+   * @note    It must be one for pass-through streams, the block points
+   *          to the half buffer being read while the ADC fills the other
+   *          one.
+   */
+  size_t                    nblocks;
+  /**
+   * @brief   Decimation stage.
+   */
+  adcsfilter_t              filter;
+  /**
+   * @brief   Decimation ratio, it must divide the half buffer depth.
+   */
+  uint32_t                  ratio;
+  /**
+   * @brief   Order of the CIC decimator.
+   */
+  uint32_t                  order;
+} ADCStreamConfig;
+
+/**
+ * @brief   Type of a stream.
+ */
+typedef struct adc_stream ADCStream;
+
+/**
+ * @brief   Structure representing a stream.
+ * @details Half buffers completed by the ADC are decimated by the ADC
+ *          callback into the blocks ring or passed in place, the consumer
+ *          thread accesses the blocks in place.
+ */
+struct adc_stream {
+  /**
+   * @brief   Next active stream.
+   */
+  ADCStream                 *next;
+  /**
+   * @brief   Stream state.
+   */
+  adcsstate_t               state;
+  /**
+   * @brief   Current configuration.
+   */
+  const ADCStreamConfig     *config;
+  /**
+   * @brief   Rows in each block.
+   */
+  size_t                    rows;
+  /**
+   * @brief   Next block to be filled.
+   */
+  size_t                    wridx;
+  /**
+   * @brief   Next block to be consumed.
+   */
+  size_t                    rdidx;
+  /**
+   * @brief   Filled blocks.
+   */
+  size_t                    full;
+  /**
+   * @brief   Sequence number of the next half buffer.
+   */
+  uint32_t                  seq;
+  /**
+   * @brief   Half buffers lost since the last filled block.
+   */
+  uint32_t                  lost;
+  /**
+   * @brief   Total half buffers lost because the ring was full or
+   *          overwritten while in use.
+   */
+  uint32_t                  overruns;
+  /**
+   * @brief   Shift normalizing the decimator gain, if a power of two.
+   */
+  int                       shift;
+  /**
+   * @brief   Decimator gain.
+   */
+  uint32_t                  gain;
+  /**
+   * @brief   Packed accumulation is possible.
+   */
+  bool                      simd;
+  /**
+   * @brief   Consumer thread waiting for a block.
+   */
+  threads_queue_t           waiting;
+  /**
+   * @brief   CIC integrators.
+   */
+  uint32_t                  integ[ADCS_MAX_CHANNELS][ADCS_CIC_MAX_ORDER];
+  /**
+   * @brief   CIC comb delays.
+   */
+  uint32_t                  comb[ADCS_MAX_CHANNELS][ADCS_CIC_MAX_ORDER];
+};
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Size of the samples storage of a blocks ring.
+ *
+ * @param[in] nblocks   number of blocks in the ring
+ * @param[in] depth     ADC buffer depth
+ * @param[in] channels  number of channels in the conversion group
+ * @param[in] ratio     decimation ratio, one if no decimation
+ */
+#define ADCS_RING_SIZE(nblocks, depth, channels, ratio)                     \
+  ((nblocks) * (((depth) / 2U) / (ratio)) * (channels))
+
+/**
+ * @brief   Returns the number of filled blocks.
+ *
+ * @param[in] asp       pointer to the @p ADCStream object
+ * @return              The number of blocks.
+ *
+ * @iclass
+ */
+#define adcsGetFullI(asp) ((asp)->full)
+
+/**
+ * @brief   Returns the number of half buffers lost because the ring was
+ *          full or overwritten while in use.
+ *
+ * @param[in] asp       pointer to the @p ADCStream object
+ * @return              The number of lost half buffers.
+ *
+ * @xclass
+ */
+#define adcsGetOverrunsX(asp) ((asp)->overruns)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void adcsObjectInit(ADCStream *asp);
+  void adcsStart(ADCStream *asp, const ADCStreamConfig *config);
+  void adcsStop(ADCStream *asp);
+  ADCStreamBlock *adcsGetBlockTimeout(ADCStream *asp, systime_t timeout);
+  void adcsReleaseBlock(ADCStream *asp);
+  void adcsEndCallback(ADCDriver *adcp, adcsample_t *buffer, size_t n);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ADCSTREAM_H_ */
+
+/** @} */
@@ -0,0 +1,585 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    blkcache.c
+ * @brief   Block cache code.
+ *
+ * @addtogroup block_cache
+ * @{
+ */
+
+#include <string.h>
+
+#include "hal.h"
+#include "blkcache.h"
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the buffer associated to a cache line.
+ */
+#define line_buffer(bcp, i)                                                 \
+  ((bcp)->config->buffer + ((size_t)(i) * BLKCACHE_BLOCK_SIZE))
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+static bool bc_is_inserted(void *instance);
+static bool bc_is_protected(void *instance);
+static bool bc_connect(void *instance);
+static bool bc_disconnect(void *instance);
+static bool bc_read(void *instance, uint32_t startblk,
+                    uint8_t *buffer, uint32_t n);
+static bool bc_write(void *instance, uint32_t startblk,
+                     const uint8_t *buffer, uint32_t n);
+static bool bc_sync(void *instance);
+static bool bc_get_info(void *instance, BlockDeviceInfo *bdip);
+static bool bc_erase(void *instance, uint32_t startblk, uint32_t endblk);
+
+/**
+ * @brief   Virtual methods table.
+ */
+static const struct BlockCacheVMT bc_vmt = {
+  bc_is_inserted,
+  bc_is_protected,
+  bc_connect,
+  bc_disconnect,
+  bc_read,
+  bc_write,
+  bc_sync,
+  bc_get_info,
+  bc_erase
+};
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Searches a block in the cache.
+ *
+ * @return              The line index, @p n if the block is not cached.
+ */
+static uint32_t bc_find(BlockCache *bcp, uint32_t blk) {
+  const BlockCacheConfig *cfg = bcp->config;
+  uint32_t i;
+
+  for (i = 0U; i < cfg->n; i++) {
+    if (((cfg->lines[i].flags & BLKCACHE_LINE_VALID) != 0U) &&
+        (cfg->lines[i].blk == blk)) {
+      break;
+    }
+  }
+  return i;
+}
+
+/**
+ * @brief   Marks a line as most recently used.
+ */
+static void bc_touch(BlockCache *bcp, uint32_t i) {
+
+  bcp->stamp++;
+  bcp->config->lines[i].stamp = bcp->stamp;
+}
+
+/**
+ * @brief   Returns the least recently used clean line.
+ *
+ * @return              The line index, @p n if all lines are dirty.
+ */
+static uint32_t bc_lru(BlockCache *bcp) {
+  const BlockCacheConfig *cfg = bcp->config;
+  uint32_t i, lru = cfg->n;
+
+  for (i = 0U; i < cfg->n; i++) {
+    if ((cfg->lines[i].flags & BLKCACHE_LINE_DIRTY) == 0U) {
+      if ((lru == cfg->n) || (cfg->lines[i].stamp < cfg->lines[lru].stamp)) {
+        lru = i;
+      }
+    }
+  }
+  return lru;
+}
+
+/**
+ * @brief   Searches a window of consecutive clean lines.
+ * @details The window whose most recently used line is the oldest is
+ *          chosen, this way a multi-block read can be performed directly
+ *          into the cache without evicting recently used data.
+ *
+ * @return              The first line index, @p n if there is no window.
+ */
+static uint32_t bc_window(BlockCache *bcp, uint32_t size) {
+  const BlockCacheConfig *cfg = bcp->config;
+  uint32_t i, j, best = cfg->n, beststamp = 0U;
+
+  for (i = 0U; i + size <= cfg->n; i++) {
+    uint32_t newest = 0U;
+
+    for (j = i; j < i + size; j++) {
+      if ((cfg->lines[j].flags & BLKCACHE_LINE_DIRTY) != 0U) {
+        break;
+      }
+      if (cfg->lines[j].stamp > newest) {
+        newest = cfg->lines[j].stamp;
+      }
+    }
+    if ((j == i + size) && ((best == cfg->n) || (newest < beststamp))) {
+      best = i;
+      beststamp = newest;
+    }
+  }
+  return best;
+}
+
+/**
+ * @brief   Writes back all the dirty lines.
+ * @details Lines holding consecutive blocks in consecutive positions are
+ *          written using a single multi-block operation.
+ */
+static bool bc_flush(BlockCache *bcp) {
+  const BlockCacheConfig *cfg = bcp->config;
+  uint32_t i = 0U;
+
+  while (i < cfg->n) {
+    uint32_t k;
+
+    if ((cfg->lines[i].flags & BLKCACHE_LINE_DIRTY) == 0U) {
+      i++;
+      continue;
+    }
+
+    /* Extending the run over the following lines.*/
+    k = 1U;
+    while ((i + k < cfg->n) &&
+           ((cfg->lines[i + k].flags & BLKCACHE_LINE_DIRTY) != 0U) &&
+           (cfg->lines[i + k].blk == cfg->lines[i].blk + k)) {
+      k++;
+    }
+
+    if (blkWrite(cfg->bdp, cfg->lines[i].blk, line_buffer(bcp, i), k)) {
+      return HAL_FAILED;
+    }
+    bcp->stats.flushes++;
+    bcp->stats.coalesced += k - 1U;
+
+    while (k > 0U) {
+      cfg->lines[i].flags &= ~BLKCACHE_LINE_DIRTY;
+      i++;
+      k--;
+    }
+  }
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Allocates a line for writing a block.
+ * @details The line following the one holding the previous block is
+ *          preferred so that sequential writes can be coalesced.
+ *
+ * @return              The line index, @p n if the allocation failed.
+ */
+static uint32_t bc_alloc(BlockCache *bcp, uint32_t blk) {
+  const BlockCacheConfig *cfg = bcp->config;
+  uint32_t i;
+
+  if (blk > 0U) {
+    i = bc_find(bcp, blk - 1U) + 1U;
+    if ((i < cfg->n) && ((cfg->lines[i].flags & BLKCACHE_LINE_DIRTY) == 0U)) {
+      return i;
+    }
+  }
+
+  i = bc_lru(bcp);
+  if (i == cfg->n) {
+    /* All lines are dirty, the whole cache is written back.*/
+    if (bc_flush(bcp)) {
+      return cfg->n;
+    }
+    i = bc_lru(bcp);
+  }
+  return i;
+}
+
+static bool bc_is_inserted(void *instance) {
+  BlockCache *bcp = (BlockCache *)instance;
+
+  return blkIsInserted(bcp->config->bdp);
+}
+
+static bool bc_is_protected(void *instance) {
+  BlockCache *bcp = (BlockCache *)instance;
+
+  return blkIsWriteProtected(bcp->config->bdp);
+}
+
+static bool bc_connect(void *instance) {
+  BlockCache *bcp = (BlockCache *)instance;
+  BlockDeviceInfo bdi;
+
+  osalDbgAssert((bcp->state == BLK_ACTIVE) || (bcp->state == BLK_READY),
+                "invalid state");
+
+  /* Reconnecting, the dirty lines are written back before the cache
+     content is discarded.*/
+  if ((bcp->state == BLK_READY) && bc_flush(bcp)) {
+    return HAL_FAILED;
+  }
+
+  if (blkConnect(bcp->config->bdp)) {
+    return HAL_FAILED;
+  }
+  if (blkGetInfo(bcp->config->bdp, &bdi) ||
+      (bdi.blk_size != BLKCACHE_BLOCK_SIZE)) {
+    return HAL_FAILED;
+  }
+
+  bcInvalidate(bcp);
+  bcp->blknum = bdi.blk_num;
+  bcp->state  = BLK_READY;
+  return HAL_SUCCESS;
+}
+
+static bool bc_disconnect(void *instance) {
+  BlockCache *bcp = (BlockCache *)instance;
+  bool err;
+
+  osalDbgAssert((bcp->state == BLK_ACTIVE) || (bcp->state == BLK_READY),
+                "invalid state");
+
+  if (bcp->state == BLK_ACTIVE) {
+    return HAL_SUCCESS;
+  }
+
+  /* Dirty data is lost if the write back fails, the device is going
+     away anyway.*/
+  err = bc_flush(bcp);
+  bcInvalidate(bcp);
+  bcp->state = BLK_ACTIVE;
+  if (blkDisconnect(bcp->config->bdp)) {
+    return HAL_FAILED;
+  }
+  return err;
+}
+
+static bool bc_read(void *instance, uint32_t startblk,
+                    uint8_t *buffer, uint32_t n) {
+  BlockCache *bcp = (BlockCache *)instance;
+  const BlockCacheConfig *cfg = bcp->config;
+  bool sequential;
+  uint32_t i;
+
+  osalDbgAssert(bcp->state == BLK_READY, "invalid state");
+
+  sequential = (bool)(startblk == bcp->nextblk);
+  bcp->nextblk = startblk + n;
+
+  /* Large transfers are not cached, dirty lines are copied over the
+     data read from the device.*/
+  if (n >= BLKCACHE_BYPASS_THRESHOLD) {
+    if (blkRead(cfg->bdp, startblk, buffer, n)) {
+      return HAL_FAILED;
+    }
+    bcp->stats.misses += n;
+    for (i = 0U; i < cfg->n; i++) {
+      if (((cfg->lines[i].flags & BLKCACHE_LINE_DIRTY) != 0U) &&
+          (cfg->lines[i].blk >= startblk) &&
+          (cfg->lines[i].blk - startblk < n)) {
+        memcpy(buffer + ((size_t)(cfg->lines[i].blk - startblk) *
+                         BLKCACHE_BLOCK_SIZE),
+               line_buffer(bcp, i), BLKCACHE_BLOCK_SIZE);
+      }
+    }
+    return HAL_SUCCESS;
+  }
+
+  while (n > 0U) {
+    uint32_t m, ra, w;
+
+    i = bc_find(bcp, startblk);
+    if (i < cfg->n) {
+      memcpy(buffer, line_buffer(bcp, i), BLKCACHE_BLOCK_SIZE);
+      bc_touch(bcp, i);
+      bcp->stats.hits++;
+      buffer += BLKCACHE_BLOCK_SIZE;
+      startblk++;
+      n--;
+      continue;
+    }
+
+    /* Run of missing blocks.*/
+    m = 1U;
+    while ((m < n) && (bc_find(bcp, startblk + m) == cfg->n)) {
+      m++;
+    }
+
+    /* Blocks to be read in advance, only missing blocks within the
+       device boundary are considered.*/
+    ra = 0U;
+    if (sequential && (n == m)) {
+      while ((ra < cfg->readahead) && (m + ra < cfg->n) &&
+             (startblk + m + ra < bcp->blknum) &&
+             (bc_find(bcp, startblk + m + ra) == cfg->n)) {
+        ra++;
+      }
+    }
+
+    w = bc_window(bcp, m + ra);
+    if ((w == cfg->n) && (ra > 0U)) {
+      ra = 0U;
+      w = bc_window(bcp, m);
+    }
+
+    if (w == cfg->n) {
+      /* No room in the cache, reading directly into the buffer.*/
+      if (blkRead(cfg->bdp, startblk, buffer, m)) {
+        return HAL_FAILED;
+      }
+    }
+    else {
+      uint32_t k;
+
+      /* The window lines are clean so they can be discarded before the
+         read, a failed read leaves them invalid.*/
+      for (k = 0U; k < m + ra; k++) {
+        cfg->lines[w + k].flags = 0U;
+        cfg->lines[w + k].stamp = 0U;
+      }
+      if (blkRead(cfg->bdp, startblk, line_buffer(bcp, w), m + ra)) {
+        return HAL_FAILED;
+      }
+      for (k = 0U; k < m + ra; k++) {
+        cfg->lines[w + k].blk   = startblk + k;
+        cfg->lines[w + k].flags = BLKCACHE_LINE_VALID;
+        bc_touch(bcp, w + k);
+      }
+      memcpy(buffer, line_buffer(bcp, w), (size_t)m * BLKCACHE_BLOCK_SIZE);
+      bcp->stats.prefetched += ra;
+    }
+    bcp->stats.misses += m;
+    buffer += (size_t)m * BLKCACHE_BLOCK_SIZE;
+    startblk += m;
+    n -= m;
+  }
+  return HAL_SUCCESS;
+}
+
+static bool bc_write(void *instance, uint32_t startblk,
+                     const uint8_t *buffer, uint32_t n) {
+  BlockCache *bcp = (BlockCache *)instance;
+  const BlockCacheConfig *cfg = bcp->config;
+  uint32_t i;
+
+  osalDbgAssert(bcp->state == BLK_READY, "invalid state");
+
+  /* Large transfers are written through, cached copies are updated and
+     considered clean only after the write succeeded.*/
+  if (n >= BLKCACHE_BYPASS_THRESHOLD) {
+    if (blkWrite(cfg->bdp, startblk, buffer, n)) {
+      return HAL_FAILED;
+    }
+    bcp->stats.bypassed++;
+    for (i = 0U; i < cfg->n; i++) {
+      if (((cfg->lines[i].flags & BLKCACHE_LINE_VALID) != 0U) &&
+          (cfg->lines[i].blk >= startblk) &&
+          (cfg->lines[i].blk - startblk < n)) {
+        memcpy(line_buffer(bcp, i),
+               buffer + ((size_t)(cfg->lines[i].blk - startblk) *
+                         BLKCACHE_BLOCK_SIZE),
+               BLKCACHE_BLOCK_SIZE);
+        cfg->lines[i].flags = BLKCACHE_LINE_VALID;
+      }
+    }
+    return HAL_SUCCESS;
+  }
+
+  while (n > 0U) {
+    i = bc_find(bcp, startblk);
+    if (i == cfg->n) {
+      i = bc_alloc(bcp, startblk);
+      if (i == cfg->n) {
+        return HAL_FAILED;
+      }
+      cfg->lines[i].blk = startblk;
+    }
+    memcpy(line_buffer(bcp, i), buffer, BLKCACHE_BLOCK_SIZE);
+    cfg->lines[i].flags = BLKCACHE_LINE_VALID | BLKCACHE_LINE_DIRTY;
+    bc_touch(bcp, i);
+    bcp->stats.writes++;
+    buffer += BLKCACHE_BLOCK_SIZE;
+    startblk++;
+    n--;
+  }
+  return HAL_SUCCESS;
+}
+
+static bool bc_sync(void *instance) {
+  BlockCache *bcp = (BlockCache *)instance;
+
+  osalDbgAssert(bcp->state == BLK_READY, "invalid state");
+
+  if (bc_flush(bcp)) {
+    return HAL_FAILED;
+  }
+  return blkSync(bcp->config->bdp);
+}
+
+static bool bc_get_info(void *instance, BlockDeviceInfo *bdip) {
+  BlockCache *bcp = (BlockCache *)instance;
+
+  return blkGetInfo(bcp->config->bdp, bdip);
+}
+
+static bool bc_erase(void *instance, uint32_t startblk, uint32_t endblk) {
+  BlockCache *bcp = (BlockCache *)instance;
+  const BlockCacheConfig *cfg = bcp->config;
+  uint32_t i;
+
+  osalDbgAssert(bcp->state == BLK_READY, "invalid state");
+
+  /* Cached copies of the erased blocks are dropped, dirty ones included,
+     a later write-back would overwrite the erased area.*/
+  for (i = 0U; i < cfg->n; i++) {
+    if ((cfg->lines[i].blk >= startblk) && (cfg->lines[i].blk <= endblk)) {
+      cfg->lines[i].flags = 0U;
+    }
+  }
+  return blkErase(cfg->bdp, startblk, endblk);
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a block cache object.
+ *
+ * @param[out] bcp      pointer to the @p BlockCache object
+ *
+ * @init
+ */
+void bcObjectInit(BlockCache *bcp) {
+
+  bcp->vmt    = &bc_vmt;
+  bcp->state  = BLK_STOP;
+  bcp->config = NULL;
+}
+
+/**
+ * @brief   Configures and activates the block cache.
+ * @note    The underlying block device must be already started, it is
+ *          connected when the cache is connected.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ * @param[in] config    pointer to the @p BlockCacheConfig object
+ *
+ * @api
+ */
+void bcStart(BlockCache *bcp, const BlockCacheConfig *config) {
+
+  osalDbgCheck((bcp != NULL) && (config != NULL) &&
+               (config->bdp != NULL) && (config->lines != NULL) &&
+               (config->buffer != NULL) && (config->n > 0U));
+  osalDbgAssert((bcp->state == BLK_STOP) || (bcp->state == BLK_ACTIVE),
+                "invalid state");
+
+  bcp->config = config;
+  bcp->blknum = 0U;
+  bcInvalidate(bcp);
+  bcResetStats(bcp);
+  bcp->state  = BLK_ACTIVE;
+}
+
+/**
+ * @brief   Deactivates the block cache.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ *
+ * @api
+ */
+void bcStop(BlockCache *bcp) {
+
+  osalDbgCheck(bcp != NULL);
+  osalDbgAssert((bcp->state == BLK_STOP) || (bcp->state == BLK_ACTIVE),
+                "invalid state");
+
+  bcp->state = BLK_STOP;
+}
+
+/**
+ * @brief   Writes back all the dirty cache lines.
+ * @details Unlike @p blkSync() the underlying device is not synchronized.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool bcFlush(BlockCache *bcp) {
+
+  osalDbgCheck(bcp != NULL);
+  osalDbgAssert(bcp->state == BLK_READY, "invalid state");
+
+  return bc_flush(bcp);
+}
+
+/**
+ * @brief   Discards the whole cache content.
+ * @note    Dirty lines are discarded without being written back.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ *
+ * @api
+ */
+void bcInvalidate(BlockCache *bcp) {
+  uint32_t i;
+
+  osalDbgCheck(bcp != NULL);
+
+  for (i = 0U; i < bcp->config->n; i++) {
+    bcp->config->lines[i].flags = 0U;
+    bcp->config->lines[i].stamp = 0U;
+  }
+  bcp->stamp   = 0U;
+  bcp->nextblk = 0xFFFFFFFFU;
+}
+
+/**
+ * @brief   Resets the cache statistics.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ *
+ * @api
+ */
+void bcResetStats(BlockCache *bcp) {
+
+  osalDbgCheck(bcp != NULL);
+
+  memset(&bcp->stats, 0, sizeof (blkcache_stats_t));
+}
+
+/** @} */
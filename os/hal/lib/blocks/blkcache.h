@@ -0,0 +1,246 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    blkcache.h
+ * @brief   Block cache structures and macros.
+ *
+ * @addtogroup block_cache
+ * @{
+ */
+
+#ifndef _BLKCACHE_H_
+#define _BLKCACHE_H_
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Cache line flags
+ * @{
+ */
+#define BLKCACHE_LINE_VALID         1U  /**< @brief Line contains data.     */
+#define BLKCACHE_LINE_DIRTY         2U  /**< @brief Line not yet written.   */
+/** @} */
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Configuration options
+ * @{
+ */
+/**
+ * @brief   Size of a cached block in bytes.
+ * @details The underlying block device must report this same block size
+ *          otherwise the connection operation fails.
+ */
+#if !defined(BLKCACHE_BLOCK_SIZE) || defined(__DOXYGEN__)
+#define BLKCACHE_BLOCK_SIZE         512U
+#endif
+
+/**
+ * @brief   Minimum request size, in blocks, bypassing the cache.
+ * @details Transfers equal or larger than this value are not worth caching,
+ *          they are performed directly on the underlying device keeping
+ *          the cached copies coherent.
+ */
+#if !defined(BLKCACHE_BYPASS_THRESHOLD) || defined(__DOXYGEN__)
+#define BLKCACHE_BYPASS_THRESHOLD   8U
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if BLKCACHE_BLOCK_SIZE == 0U
+#error "invalid BLKCACHE_BLOCK_SIZE value"
+#endif
+
+#if BLKCACHE_BYPASS_THRESHOLD < 2U
+#error "invalid BLKCACHE_BYPASS_THRESHOLD value"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a cache line descriptor.
+ */
+typedef struct {
+  /**
+   * @brief   Cached block number.
+   */
+  uint32_t                  blk;
+  /**
+   * @brief   Last access stamp, used for LRU replacement.
+   */
+  uint32_t                  stamp;
+  /**
+   * @brief   Line flags.
+   */
+  uint32_t                  flags;
+} blkcache_line_t;
+
+/**
+ * @brief   Type of a block cache statistics structure.
+ */
+typedef struct {
+  /**
+   * @brief   Blocks read from the cache.
+   */
+  uint32_t                  hits;
+  /**
+   * @brief   Blocks read from the underlying device.
+   */
+  uint32_t                  misses;
+  /**
+   * @brief   Blocks fetched in advance on sequential accesses.
+   */
+  uint32_t                  prefetched;
+  /**
+   * @brief   Blocks written into the cache.
+   */
+  uint32_t                  writes;
+  /**
+   * @brief   Write operations issued to the underlying device in order to
+   *          flush dirty lines.
+   */
+  uint32_t                  flushes;
+  /**
+   * @brief   Write operations written through bypassing the cache.
+   */
+  uint32_t                  bypassed;
+  /**
+   * @brief   Blocks merged into a preceding write operation.
+   */
+  uint32_t                  coalesced;
+} blkcache_stats_t;
+
+/**
+ * @brief   Block cache configuration structure.
+ */
+typedef struct {
+  /**
+   * @brief   Underlying block device.
+   */
+  BaseBlockDevice           *bdp;
+  /**
+   * @brief   Cache lines descriptors array.
+   */
+  blkcache_line_t           *lines;
+  /**
+   * @brief   Cache data buffer.
+   * @note    The buffer must be @p n times @p BLKCACHE_BLOCK_SIZE bytes
+   *          large and must satisfy the alignment constraints of the
+   *          underlying device.
+   */
+  uint8_t                   *buffer;
+  /**
+   * @brief   Number of cache lines.
+   */
+  uint32_t                  n;
+  /**
+   * @brief   Number of blocks read in advance on sequential accesses.
+   * @note    Zero disables the read-ahead.
+   */
+  uint32_t                  readahead;
+} BlockCacheConfig;
+
+/**
+ * @brief   @p BlockCache specific methods.
+ */
+#define _block_cache_methods                                                \
+  _base_block_device_methods
+
+/**
+ * @brief   @p BlockCache specific data.
+ */
+#define _block_cache_data                                                   \
+  _base_block_device_data                                                   \
+  /* Current configuration data.*/                                          \
+  const BlockCacheConfig    *config;                                        \
+  /* Number of blocks of the underlying device.*/                           \
+  uint32_t                  blknum;                                         \
+  /* Access stamps counter.*/                                               \
+  uint32_t                  stamp;                                          \
+  /* Block following the last read operation.*/                             \
+  uint32_t                  nextblk;                                        \
+  /* Statistics.*/                                                          \
+  blkcache_stats_t          stats;
+
+/**
+ * @brief   @p BlockCache virtual methods table.
+ */
+struct BlockCacheVMT {
+  _block_cache_methods
+};
+
+/**
+ * @extends BaseBlockDevice
+ *
+ * @brief   Block cache object.
+ * @details A block cache is a block device layered over another block
+ *          device, reads are served from an LRU cache with read-ahead on
+ *          sequential accesses, writes are delayed and adjacent blocks
+ *          are merged into multi-block writes when the cache is flushed.
+ * @note    The object is not thread safe, like the underlying block
+ *          devices it must be protected by the caller.
+ */
+typedef struct {
+  /** @brief Virtual Methods Table.*/
+  const struct BlockCacheVMT *vmt;
+  _block_cache_data
+} BlockCache;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns a pointer to the cache statistics.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ * @return              Pointer to a @p blkcache_stats_t structure.
+ *
+ * @xclass
+ */
+#define bcGetStatsX(bcp) (&(bcp)->stats)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void bcObjectInit(BlockCache *bcp);
+  void bcStart(BlockCache *bcp, const BlockCacheConfig *config);
+  void bcStop(BlockCache *bcp);
+  bool bcFlush(BlockCache *bcp);
+  void bcInvalidate(BlockCache *bcp);
+  void bcResetStats(BlockCache *bcp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _BLKCACHE_H_ */
+
+/** @} */
@@ -0,0 +1,412 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    blkio.c
+ * @brief   Asynchronous block I/O code.
+ * @details The block device drivers perform transfers synchronously, this
+ *          module serializes requests coming from any number of threads or
+ *          ISRs into a queue served by a dedicated thread. The submitting
+ *          thread is free to prepare the next buffer while the previous
+ *          one is being transferred.
+ *
+ * @addtogroup block_io
+ * @{
+ */
+
+#include "hal.h"
+#include "blkio.h"
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Inserts a request in the queue.
+ *
+ * @notapi
+ */
+static void bio_submit_i(BlockIOQueue *bqp, blkio_request_t *reqp) {
+
+  /* An active request can only be submitted again by its own completion
+     callback.*/
+  osalDbgAssert(reqp->state != BLKIO_QUEUED, "already queued");
+
+  reqp->next   = NULL;
+  reqp->state  = BLKIO_QUEUED;
+  if (bqp->tail == NULL) {
+    bqp->head = reqp;
+  }
+  else {
+    bqp->tail->next = reqp;
+  }
+  bqp->tail = reqp;
+  bqp->depth++;
+  if (bqp->depth > bqp->maxdepth) {
+    bqp->maxdepth = bqp->depth;
+  }
+
+  /* Waking up the serving thread, if waiting.*/
+  osalThreadResumeI(&bqp->server, MSG_OK);
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a block I/O queue.
+ *
+ * @param[out] bqp      pointer to the @p BlockIOQueue object
+ * @param[in] bdp       pointer to the @p BaseBlockDevice to be served
+ *
+ * @init
+ */
+void bioObjectInit(BlockIOQueue *bqp, BaseBlockDevice *bdp) {
+
+  bqp->bdp      = bdp;
+  bqp->vmt      = bdp->vmt;
+  bqp->head     = NULL;
+  bqp->tail     = NULL;
+  bqp->server   = NULL;
+  bqp->depth    = 0U;
+  bqp->maxdepth = 0U;
+}
+
+/**
+ * @brief   Initializes a block I/O request.
+ *
+ * @param[out] reqp     pointer to the @p blkio_request_t object
+ * @param[in] arg       callback argument
+ *
+ * @init
+ */
+void bioRequestObjectInit(blkio_request_t *reqp, void *arg) {
+
+  reqp->next   = NULL;
+  reqp->state  = BLKIO_IDLE;
+  reqp->cb     = NULL;
+  reqp->arg    = arg;
+  reqp->result = HAL_SUCCESS;
+  reqp->thread = NULL;
+}
+
+/**
+ * @brief   Queues a read request.
+ * @note    The request object and the buffer must not be touched until
+ *          the request has been completed.
+ *
+ * @param[in] bqp       pointer to the @p BlockIOQueue object
+ * @param[in] reqp      pointer to the @p blkio_request_t object
+ * @param[in] startblk  first block to read
+ * @param[out] buf      pointer to the read buffer
+ * @param[in] n         number of blocks to read
+ * @param[in] cb        completion callback or @p NULL
+ *
+ * @iclass
+ */
+void bioStartReadI(BlockIOQueue *bqp, blkio_request_t *reqp,
+                   uint32_t startblk, uint8_t *buf, uint32_t n,
+                   blkiocb_t cb) {
+
+  osalDbgCheckClassI();
+  osalDbgCheck((bqp != NULL) && (reqp != NULL) &&
+               (buf != NULL) && (n > 0U));
+
+  reqp->op       = BLKIO_READ;
+  reqp->startblk = startblk;
+  reqp->buf      = buf;
+  reqp->n        = n;
+  reqp->cb       = cb;
+  bio_submit_i(bqp, reqp);
+}
+
+/**
+ * @brief   Queues a read request.
+ * @note    The request object and the buffer must not be touched until
+ *          the request has been completed.
+ *
+ * @param[in] bqp       pointer to the @p BlockIOQueue object
+ * @param[in] reqp      pointer to the @p blkio_request_t object
+ * @param[in] startblk  first block to read
+ * @param[out] buf      pointer to the read buffer
+ * @param[in] n         number of blocks to read
+ * @param[in] cb        completion callback or @p NULL
+ *
+ * @api
+ */
+void bioStartRead(BlockIOQueue *bqp, blkio_request_t *reqp,
+                  uint32_t startblk, uint8_t *buf, uint32_t n,
+                  blkiocb_t cb) {
+
+  osalSysLock();
+  bioStartReadI(bqp, reqp, startblk, buf, n, cb);
+  osalOsRescheduleS();
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Queues a write request.
+ * @note    The request object and the buffer must not be touched until
+ *          the request has been completed.
+ *
+ * @param[in] bqp       pointer to the @p BlockIOQueue object
+ * @param[in] reqp      pointer to the @p blkio_request_t object
+ * @param[in] startblk  first block to write
+ * @param[in] buf       pointer to the write buffer
+ * @param[in] n         number of blocks to write
+ * @param[in] cb        completion callback or @p NULL
+ *
+ * @iclass
+ */
+void bioStartWriteI(BlockIOQueue *bqp, blkio_request_t *reqp,
+                    uint32_t startblk, const uint8_t *buf, uint32_t n,
+                    blkiocb_t cb) {
+
+  osalDbgCheckClassI();
+  osalDbgCheck((bqp != NULL) && (reqp != NULL) &&
+               (buf != NULL) && (n > 0U));
+
+  reqp->op       = BLKIO_WRITE;
+  reqp->startblk = startblk;
+  reqp->buf      = (uint8_t *)buf;
+  reqp->n        = n;
+  reqp->cb       = cb;
+  bio_submit_i(bqp, reqp);
+}
+
+/**
+ * @brief   Queues a write request.
+ * @note    The request object and the buffer must not be touched until
+ *          the request has been completed.
+ *
+ * @param[in] bqp       pointer to the @p BlockIOQueue object
+ * @param[in] reqp      pointer to the @p blkio_request_t object
+ * @param[in] startblk  first block to write
+ * @param[in] buf       pointer to the write buffer
+ * @param[in] n         number of blocks to write
+ * @param[in] cb        completion callback or @p NULL
+ *
+ * @api
+ */
+void bioStartWrite(BlockIOQueue *bqp, blkio_request_t *reqp,
+                   uint32_t startblk, const uint8_t *buf, uint32_t n,
+                   blkiocb_t cb) {
+
+  osalSysLock();
+  bioStartWriteI(bqp, reqp, startblk, buf, n, cb);
+  osalOsRescheduleS();
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Queues a synchronization request.
+ * @details The request completes after all the previously queued requests
+ *          and after the device write operations have been finalized.
+ *
+ * @param[in] bqp       pointer to the @p BlockIOQueue object
+ * @param[in] reqp      pointer to the @p blkio_request_t object
+ * @param[in] cb        completion callback or @p NULL
+ *
+ * @api
+ */
+void bioStartSync(BlockIOQueue *bqp, blkio_request_t *reqp, blkiocb_t cb) {
+
+  osalDbgCheck((bqp != NULL) && (reqp != NULL));
+
+  osalSysLock();
+  reqp->op       = BLKIO_SYNC;
+  reqp->startblk = 0U;
+  reqp->buf      = NULL;
+  reqp->n        = 0U;
+  reqp->cb       = cb;
+  bio_submit_i(bqp, reqp);
+  osalOsRescheduleS();
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Waits for a request completion.
+ * @note    Only one thread can wait on a request.
+ *
+ * @param[in] reqp      pointer to the @p blkio_request_t object
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool bioWait(blkio_request_t *reqp) {
+
+  osalDbgCheck(reqp != NULL);
+
+  osalSysLock();
+  osalDbgAssert(reqp->state != BLKIO_IDLE, "not queued");
+  if (reqp->state != BLKIO_DONE) {
+    (void) osalThreadSuspendS(&reqp->thread);
+  }
+  osalSysUnlock();
+
+  return reqp->result;
+}
+
+/**
+ * @brief   Reads one or more blocks through the queue.
+ *
+ * @param[in] bqp       pointer to the @p BlockIOQueue object
+ * @param[in] startblk  first block to read
+ * @param[out] buf      pointer to the read buffer
+ * @param[in] n         number of blocks to read
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool bioRead(BlockIOQueue *bqp, uint32_t startblk,
+             uint8_t *buf, uint32_t n) {
+  blkio_request_t req;
+
+  bioRequestObjectInit(&req, NULL);
+  bioStartRead(bqp, &req, startblk, buf, n, NULL);
+  return bioWait(&req);
+}
+
+/**
+ * @brief   Writes one or more blocks through the queue.
+ *
+ * @param[in] bqp       pointer to the @p BlockIOQueue object
+ * @param[in] startblk  first block to write
+ * @param[in] buf       pointer to the write buffer
+ * @param[in] n         number of blocks to write
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool bioWrite(BlockIOQueue *bqp, uint32_t startblk,
+              const uint8_t *buf, uint32_t n) {
+  blkio_request_t req;
+
+  bioRequestObjectInit(&req, NULL);
+  bioStartWrite(bqp, &req, startblk, buf, n, NULL);
+  return bioWait(&req);
+}
+
+/**
+ * @brief   Waits for completion of all the queued requests.
+ *
+ * @param[in] bqp       pointer to the @p BlockIOQueue object
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool bioSync(BlockIOQueue *bqp) {
+  blkio_request_t req;
+
+  bioRequestObjectInit(&req, NULL);
+  bioStartSync(bqp, &req, NULL);
+  return bioWait(&req);
+}
+
+/**
+ * @brief   Serves the queued requests.
+ * @details This function never returns, it must be invoked from a thread
+ *          created by the application for this purpose, the priority of
+ *          the thread determines the priority of the I/O activity.
+ *          Requests are executed in order, the completion callback is
+ *          invoked from this thread, then the request is marked as
+ *          completed and the waiting thread, if any, is resumed.
+ *
+ * @param[in] bqp       pointer to the @p BlockIOQueue object
+ *
+ * @api
+ */
+void bioServe(BlockIOQueue *bqp) {
+
+  osalDbgCheck(bqp != NULL);
+
+  while (true) {
+    blkio_request_t *reqp;
+    blkiocb_t cb;
+    bool result;
+
+    osalSysLock();
+    while (bqp->head == NULL) {
+      (void) osalThreadSuspendS(&bqp->server);
+    }
+    reqp = bqp->head;
+    reqp->state = BLKIO_ACTIVE;
+    osalSysUnlock();
+
+    /* The device is accessed outside the critical zone, the requester can
+       run in parallel.*/
+    switch (reqp->op) {
+    case BLKIO_READ:
+      result = bqp->vmt->read(bqp->bdp, reqp->startblk, reqp->buf, reqp->n);
+      break;
+    case BLKIO_WRITE:
+      result = bqp->vmt->write(bqp->bdp, reqp->startblk, reqp->buf, reqp->n);
+      break;
+    default:
+      result = bqp->vmt->sync(bqp->bdp);
+      break;
+    }
+
+    osalSysLock();
+    bqp->head = reqp->next;
+    if (bqp->head == NULL) {
+      bqp->tail = NULL;
+    }
+    bqp->depth--;
+    reqp->result = result;
+    cb = reqp->cb;
+    osalSysUnlock();
+
+    /* The callback is invoked outside the critical zone so that it is
+       able to submit further requests. The request is still active, the
+       requester cannot release it before the callback returned.*/
+    if (cb != NULL) {
+      cb(reqp);
+    }
+
+    /* The request is not touched after being marked as completed, unless
+       the callback queued it again.*/
+    osalSysLock();
+    if (reqp->state == BLKIO_ACTIVE) {
+      reqp->state = BLKIO_DONE;
+      osalThreadResumeS(&reqp->thread, MSG_OK);
+    }
+    osalSysUnlock();
+  }
+}
+
+/** @} */
@@ -0,0 +1,226 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    blkio.h
+ * @brief   Asynchronous block I/O structures and macros.
+ *
+ * @addtogroup block_io
+ * @{
+ */
+
+#ifndef _BLKIO_H_
+#define _BLKIO_H_
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a block I/O operation.
+ */
+typedef enum {
+  BLKIO_READ = 0,                   /**< Blocks read.                       */
+  BLKIO_WRITE = 1,                  /**< Blocks write.                      */
+  BLKIO_SYNC = 2                    /**< Device synchronization.            */
+} blkioop_t;
+
+/**
+ * @brief   Type of a block I/O request state.
+ */
+typedef enum {
+  BLKIO_IDLE = 0,                   /**< Not queued.                        */
+  BLKIO_QUEUED = 1,                 /**< Waiting in the queue.              */
+  BLKIO_ACTIVE = 2,                 /**< Being executed.                    */
+  BLKIO_DONE = 3                    /**< Completed.                         */
+} blkiostate_t;
+
+/**
+ * @brief   Type of a block I/O request.
+ */
+typedef struct blkio_request blkio_request_t;
+
+/**
+ * @brief   Block I/O completion callback type.
+ * @note    Callbacks are invoked from the thread serving the queue, it is
+ *          allowed to submit new requests, including the completed one
+ *          on the same queue.
+ * @note    The request is marked as completed after the callback returned,
+ *          the callback must not release it.
+ *
+ * @param[in] reqp      pointer to the completed request
+ */
+typedef void (*blkiocb_t)(blkio_request_t *reqp);
+
+/**
+ * @brief   Structure representing a block I/O request.
+ * @note    Requests must be initialized using @p bioRequestObjectInit()
+ *          before being submitted the first time.
+ */
+struct blkio_request {
+  /**
+   * @brief   Next request in the queue.
+   */
+  blkio_request_t           *next;
+  /**
+   * @brief   Requested operation.
+   */
+  blkioop_t                 op;
+  /**
+   * @brief   Request state.
+   */
+  volatile blkiostate_t     state;
+  /**
+   * @brief   First block.
+   */
+  uint32_t                  startblk;
+  /**
+   * @brief   Data buffer.
+   */
+  uint8_t                   *buf;
+  /**
+   * @brief   Number of blocks.
+   */
+  uint32_t                  n;
+  /**
+   * @brief   Completion callback or @p NULL.
+   */
+  blkiocb_t                 cb;
+  /**
+   * @brief   Callback argument, free for application use.
+   */
+  void                      *arg;
+  /**
+   * @brief   Operation result.
+   */
+  bool                      result;
+  /**
+   * @brief   Thread waiting for the request completion.
+   */
+  thread_reference_t        thread;
+};
+
+/**
+ * @brief   Structure representing a block I/O queue.
+ */
+typedef struct {
+  /**
+   * @brief   Served block device.
+   */
+  BaseBlockDevice           *bdp;
+  /**
+   * @brief   Methods executing the requests.
+   * @note    It is the device VMT by default, drivers routing their own
+   *          blocking API through the queue replace it with methods
+   *          accessing the device directly.
+   */
+  const struct BaseBlockDeviceVMT *vmt;
+  /**
+   * @brief   First queued request.
+   */
+  blkio_request_t           *head;
+  /**
+   * @brief   Last queued request.
+   */
+  blkio_request_t           *tail;
+  /**
+   * @brief   Serving thread waiting for requests.
+   */
+  thread_reference_t        server;
+  /**
+   * @brief   Number of requests in the queue.
+   */
+  uint32_t                  depth;
+  /**
+   * @brief   Maximum number of requests ever found in the queue.
+   */
+  uint32_t                  maxdepth;
+} BlockIOQueue;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Determines if a request has been completed.
+ *
+ * @param[in] reqp      pointer to the @p blkio_request_t object
+ * @return              The request status.
+ *
+ * @iclass
+ */
+#define bioIsCompletedI(reqp) ((reqp)->state == BLKIO_DONE)
+
+/**
+ * @brief   Returns the result of a completed request.
+ *
+ * @param[in] reqp      pointer to the @p blkio_request_t object
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @xclass
+ */
+#define bioGetResultX(reqp) ((reqp)->result)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void bioObjectInit(BlockIOQueue *bqp, BaseBlockDevice *bdp);
+  void bioRequestObjectInit(blkio_request_t *reqp, void *arg);
+  void bioStartReadI(BlockIOQueue *bqp, blkio_request_t *reqp,
+                     uint32_t startblk, uint8_t *buf, uint32_t n,
+                     blkiocb_t cb);
+  void bioStartRead(BlockIOQueue *bqp, blkio_request_t *reqp,
+                    uint32_t startblk, uint8_t *buf, uint32_t n,
+                    blkiocb_t cb);
+  void bioStartWriteI(BlockIOQueue *bqp, blkio_request_t *reqp,
+                      uint32_t startblk, const uint8_t *buf, uint32_t n,
+                      blkiocb_t cb);
+  void bioStartWrite(BlockIOQueue *bqp, blkio_request_t *reqp,
+                     uint32_t startblk, const uint8_t *buf, uint32_t n,
+                     blkiocb_t cb);
+  void bioStartSync(BlockIOQueue *bqp, blkio_request_t *reqp, blkiocb_t cb);
+  bool bioWait(blkio_request_t *reqp);
+  bool bioRead(BlockIOQueue *bqp, uint32_t startblk,
+               uint8_t *buf, uint32_t n);
+  bool bioWrite(BlockIOQueue *bqp, uint32_t startblk,
+                const uint8_t *buf, uint32_t n);
+  bool bioSync(BlockIOQueue *bqp);
+  void bioServe(BlockIOQueue *bqp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _BLKIO_H_ */
+
+/** @} */
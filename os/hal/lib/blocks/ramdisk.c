@@ -0,0 +1,207 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    ramdisk.c
+ * @brief   RAM disk code.
+ *
+ * @addtogroup ram_disk
+ * @{
+ */
+
+#include <string.h>
+
+#include "hal.h"
+#include "ramdisk.h"
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+static bool rd_is_inserted(void *instance) {
+
+  (void)instance;
+
+  return true;
+}
+
+static bool rd_is_protected(void *instance) {
+  RamDisk *rdp = (RamDisk *)instance;
+
+  return rdp->readonly;
+}
+
+static bool rd_connect(void *instance) {
+  RamDisk *rdp = (RamDisk *)instance;
+
+  if (rdp->state == BLK_ACTIVE) {
+    rdp->state = BLK_READY;
+  }
+  return rdp->state == BLK_READY ? HAL_SUCCESS : HAL_FAILED;
+}
+
+static bool rd_disconnect(void *instance) {
+  RamDisk *rdp = (RamDisk *)instance;
+
+  if (rdp->state == BLK_READY) {
+    rdp->state = BLK_ACTIVE;
+  }
+  return HAL_SUCCESS;
+}
+
+static bool rd_read(void *instance, uint32_t startblk,
+                    uint8_t *buffer, uint32_t n) {
+  RamDisk *rdp = (RamDisk *)instance;
+
+  if ((rdp->state != BLK_READY) ||
+      (startblk >= rdp->blk_num) || (n > rdp->blk_num - startblk)) {
+    return HAL_FAILED;
+  }
+  memcpy(buffer, rdp->storage + ((size_t)startblk * rdp->blk_size),
+         (size_t)n * rdp->blk_size);
+  return HAL_SUCCESS;
+}
+
+static bool rd_write(void *instance, uint32_t startblk,
+                     const uint8_t *buffer, uint32_t n) {
+  RamDisk *rdp = (RamDisk *)instance;
+
+  if ((rdp->state != BLK_READY) || rdp->readonly ||
+      (startblk >= rdp->blk_num) || (n > rdp->blk_num - startblk)) {
+    return HAL_FAILED;
+  }
+  memcpy(rdp->storage + ((size_t)startblk * rdp->blk_size), buffer,
+         (size_t)n * rdp->blk_size);
+  return HAL_SUCCESS;
+}
+
+static bool rd_sync(void *instance) {
+
+  (void)instance;
+
+  return HAL_SUCCESS;
+}
+
+static bool rd_get_info(void *instance, BlockDeviceInfo *bdip) {
+  RamDisk *rdp = (RamDisk *)instance;
+
+  if (rdp->state != BLK_READY) {
+    return HAL_FAILED;
+  }
+  bdip->blk_size = rdp->blk_size;
+  bdip->blk_num  = rdp->blk_num;
+  return HAL_SUCCESS;
+}
+
+static bool rd_erase(void *instance, uint32_t startblk, uint32_t endblk) {
+  RamDisk *rdp = (RamDisk *)instance;
+
+  /* Nothing to erase in RAM, the range is just validated.*/
+  if ((rdp->state != BLK_READY) || rdp->readonly ||
+      (startblk > endblk) || (endblk >= rdp->blk_num)) {
+    return HAL_FAILED;
+  }
+  return HAL_SUCCESS;
+}
+
+static const struct RamDiskVMT vmt = {
+  rd_is_inserted,
+  rd_is_protected,
+  rd_connect,
+  rd_disconnect,
+  rd_read,
+  rd_write,
+  rd_sync,
+  rd_get_info,
+  rd_erase
+};
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   RAM disk object initialization.
+ *
+ * @param[out] rdp      pointer to the @p RamDisk object
+ *
+ * @init
+ */
+void rdObjectInit(RamDisk *rdp) {
+
+  rdp->vmt      = &vmt;
+  rdp->state    = BLK_STOP;
+  rdp->storage  = NULL;
+  rdp->blk_size = 0U;
+  rdp->blk_num  = 0U;
+  rdp->readonly = false;
+}
+
+/**
+ * @brief   Activates the RAM disk.
+ *
+ * @param[in] rdp       pointer to the @p RamDisk object
+ * @param[in] storage   pointer to the storage area, it must be
+ *                      @p blk_size times @p blk_num bytes large
+ * @param[in] blk_size  block size in bytes
+ * @param[in] blk_num   number of blocks
+ * @param[in] readonly  write protection
+ *
+ * @api
+ */
+void rdStart(RamDisk *rdp, uint8_t *storage, uint32_t blk_size,
+             uint32_t blk_num, bool readonly) {
+
+  osalDbgCheck((rdp != NULL) && (storage != NULL) && (blk_size > 0U));
+  osalDbgAssert((rdp->state == BLK_STOP) || (rdp->state == BLK_ACTIVE),
+                "invalid state");
+
+  rdp->storage  = storage;
+  rdp->blk_size = blk_size;
+  rdp->blk_num  = blk_num;
+  rdp->readonly = readonly;
+  rdp->state    = BLK_ACTIVE;
+}
+
+/**
+ * @brief   Deactivates the RAM disk.
+ *
+ * @param[in] rdp       pointer to the @p RamDisk object
+ *
+ * @api
+ */
+void rdStop(RamDisk *rdp) {
+
+  osalDbgCheck(rdp != NULL);
+  osalDbgAssert((rdp->state == BLK_STOP) || (rdp->state == BLK_ACTIVE),
+                "invalid state");
+
+  rdp->state = BLK_STOP;
+}
+
+/** @} */
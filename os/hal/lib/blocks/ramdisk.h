@@ -0,0 +1,106 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    ramdisk.h
+ * @brief   RAM disk structures and macros.
+ *
+ * @addtogroup ram_disk
+ * @{
+ */
+
+#ifndef _RAMDISK_H_
+#define _RAMDISK_H_
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   @p RamDisk specific methods.
+ */
+#define _ram_disk_methods                                                   \
+  _base_block_device_methods
+
+/**
+ * @brief   @p RamDisk specific data.
+ */
+#define _ram_disk_data                                                      \
+  _base_block_device_data                                                   \
+  /* Disk storage.*/                                                        \
+  uint8_t                   *storage;                                       \
+  /* Block size.*/                                                          \
+  uint32_t                  blk_size;                                       \
+  /* Number of blocks.*/                                                    \
+  uint32_t                  blk_num;                                        \
+  /* Write protection.*/                                                    \
+  bool                      readonly;
+
+/**
+ * @brief   @p RamDisk virtual methods table.
+ */
+struct RamDiskVMT {
+  _ram_disk_methods
+};
+
+/**
+ * @extends BaseBlockDevice
+ *
+ * @brief   RAM disk object.
+ * @details A block device backed by a memory area, it is useful as a
+ *          temporary file system or as a reference device for testing
+ *          upper layers.
+ */
+typedef struct {
+  /** @brief Virtual Methods Table.*/
+  const struct RamDiskVMT *vmt;
+  _ram_disk_data
+} RamDisk;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void rdObjectInit(RamDisk *rdp);
+  void rdStart(RamDisk *rdp, uint8_t *storage, uint32_t blk_size,
+               uint32_t blk_num, bool readonly);
+  void rdStop(RamDisk *rdp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RAMDISK_H_ */
+
+/** @} */
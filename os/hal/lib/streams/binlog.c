@@ -0,0 +1,228 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    binlog.c
+ * @brief   Deferred binary log code.
+ * @details The log records are written in a ring of words by the log
+ *          macros, the cost of a record is a short critical zone copying
+ *          a few words. The ring is emptied by a thread writing the raw
+ *          records on a stream, the formatting is done on the host using
+ *          the format strings in the ELF file.
+ *
+ * @addtogroup binary_log
+ * @{
+ */
+
+#include "hal.h"
+#include "binlog.h"
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+#define BINLOG_MASK                 (BINLOG_BUFFER_SIZE - 1U)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Log state.
+ */
+static struct {
+  /**
+   * @brief   Write index, free running.
+   */
+  uint32_t              wridx;
+  /**
+   * @brief   Read index, free running.
+   */
+  uint32_t              rdidx;
+  /**
+   * @brief   Sequence number of the next record.
+   */
+  uint32_t              seq;
+  /**
+   * @brief   Records lost because the buffer was full.
+   */
+  uint32_t              dropped;
+  /**
+   * @brief   Waiting drain thread.
+   */
+  thread_reference_t    thread;
+  /**
+   * @brief   Records buffer.
+   */
+  uint32_t              buffer[BINLOG_BUFFER_SIZE];
+} binlog;
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes the deferred log.
+ *
+ * @init
+ */
+void binlogInit(void) {
+
+  binlog.wridx   = 0U;
+  binlog.rdidx   = 0U;
+  binlog.seq     = 0U;
+  binlog.dropped = 0U;
+  binlog.thread  = NULL;
+}
+
+/**
+ * @brief   Writes a record in the log buffer.
+ * @note    If the buffer has not enough space the record is dropped, the
+ *          sequence number is incremented anyway so the host can detect
+ *          the loss.
+ *
+ * @param[in] fmt       the format string, it must be in the log section
+ * @param[in] args      the arguments words
+ * @param[in] n         the number of arguments
+ *
+ * @iclass
+ */
+void binlogWriteI(const char *fmt, const uint32_t *args, size_t n) {
+  uint32_t wr, seq;
+  size_t i;
+
+  osalDbgCheckClassI();
+  osalDbgCheck((fmt != NULL) && (n <= BINLOG_MAX_ARGS));
+
+  seq = binlog.seq++;
+  if ((BINLOG_BUFFER_SIZE - (binlog.wridx - binlog.rdidx)) <
+      (BINLOG_HEADER_SIZE + (uint32_t)n)) {
+    binlog.dropped++;
+    return;
+  }
+
+  wr = binlog.wridx;
+  binlog.buffer[wr++ & BINLOG_MASK] = BINLOG_MARKER | ((uint32_t)n << 16) |
+                                      (seq & 0xFFFFU);
+  binlog.buffer[wr++ & BINLOG_MASK] = BINLOG_GET_TIMESTAMP();
+  binlog.buffer[wr++ & BINLOG_MASK] = (uint32_t)fmt;
+  for (i = 0U; i < n; i++) {
+    binlog.buffer[wr++ & BINLOG_MASK] = args[i];
+  }
+  binlog.wridx = wr;
+
+  /* Waking up the drain thread, if waiting.*/
+  osalThreadResumeI(&binlog.thread, MSG_OK);
+}
+
+/**
+ * @brief   Writes the pending records on a stream.
+ * @details The records are written as they are in memory, using the
+ *          target byte order.
+ * @note    Only one thread can drain the log.
+ *
+ * @param[in] chp       pointer to a @p BaseSequentialStream implementing
+ *                      object
+ * @param[in] timeout   the number of ticks before the operation timeouts
+ *                      if the log is empty, the following special values
+ *                      are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of bytes written on the stream.
+ *
+ * @api
+ */
+size_t binlogFlush(BaseSequentialStream *chp, systime_t timeout) {
+  uint32_t rd, wr, n;
+  size_t total;
+
+  osalDbgCheck(chp != NULL);
+
+  osalSysLock();
+  if (binlog.wridx == binlog.rdidx) {
+    if (osalThreadSuspendTimeoutS(&binlog.thread, timeout) != MSG_OK) {
+      osalSysUnlock();
+      return 0U;
+    }
+  }
+  wr = binlog.wridx;
+  rd = binlog.rdidx;
+  osalSysUnlock();
+
+  /* The records between the indexes cannot be overwritten until the read
+     index is moved, the data is written in up to two runs.*/
+  total = 0U;
+  while (rd != wr) {
+    n = BINLOG_BUFFER_SIZE - (rd & BINLOG_MASK);
+    if (n > wr - rd) {
+      n = wr - rd;
+    }
+    total += streamWrite(chp,
+                         (const uint8_t *)&binlog.buffer[rd & BINLOG_MASK],
+                         (size_t)n * sizeof (uint32_t));
+    rd += n;
+
+    osalSysLock();
+    binlog.rdidx = rd;
+    osalSysUnlock();
+  }
+
+  return total;
+}
+
+/**
+ * @brief   Drain thread function.
+ * @details The function never returns, it can be used as the function of
+ *          a thread created by the application.
+ *
+ * @param[in] arg       pointer to a @p BaseSequentialStream implementing
+ *                      object
+ *
+ * @notapi
+ */
+void binlogDrainThread(void *arg) {
+
+  while (true) {
+    (void)binlogFlush((BaseSequentialStream *)arg, TIME_INFINITE);
+  }
+}
+
+/**
+ * @brief   Returns the number of records lost because the buffer was full.
+ *
+ * @return              The number of lost records.
+ *
+ * @xclass
+ */
+uint32_t binlogGetDroppedX(void) {
+
+  return binlog.dropped;
+}
+
+/** @} */
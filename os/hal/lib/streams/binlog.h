@@ -0,0 +1,198 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    binlog.h
+ * @brief   Deferred binary log macros and structures.
+ *
+ * @addtogroup binary_log
+ * @{
+ */
+
+#ifndef _BINLOG_H_
+#define _BINLOG_H_
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Marker in the most significant byte of a record header.
+ */
+#define BINLOG_MARKER               0xB1000000U
+
+/**
+ * @brief   Size of a record without arguments, in words.
+ * @details A record is composed of a header word, a timestamp word, the
+ *          format string identifier and the arguments words. The header
+ *          contains @p BINLOG_MARKER, the number of arguments in bits
+ *          16..23 and a sequence number in bits 0..15, the sequence number
+ *          is incremented also for the records lost because the buffer
+ *          was full.
+ */
+#define BINLOG_HEADER_SIZE          3U
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Deferred log enable switch.
+ * @details If set to @p FALSE the log macros expand to nothing.
+ */
+#if !defined(BINLOG_ENABLED) || defined(__DOXYGEN__)
+#define BINLOG_ENABLED              TRUE
+#endif
+
+/**
+ * @brief   Size of the log buffer in words.
+ * @note    Must be a power of two.
+ */
+#if !defined(BINLOG_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define BINLOG_BUFFER_SIZE          256U
+#endif
+
+/**
+ * @brief   Maximum number of arguments of a log record.
+ */
+#if !defined(BINLOG_MAX_ARGS) || defined(__DOXYGEN__)
+#define BINLOG_MAX_ARGS             8U
+#endif
+
+/**
+ * @brief   Timestamp source.
+ * @details The default is the kernel realtime counter.
+ */
+#if !defined(BINLOG_GET_TIMESTAMP) || defined(__DOXYGEN__)
+#define BINLOG_GET_TIMESTAMP()      ((uint32_t)chSysGetRealtimeCounterX())
+#endif
+
+/**
+ * @brief   Attribute placing the format strings in their own section.
+ * @details The section is not loaded on the target, the linker script
+ *          must mark it as @p INFO and reserve its first word so that no
+ *          string is at address zero, the host decoder reads the strings
+ *          from the ELF file.
+ */
+#if !defined(BINLOG_FORMAT_SECTION) || defined(__DOXYGEN__)
+#define BINLOG_FORMAT_SECTION       __attribute__((section(".binlog")))
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if (BINLOG_BUFFER_SIZE & (BINLOG_BUFFER_SIZE - 1U)) != 0U
+#error "BINLOG_BUFFER_SIZE must be a power of two"
+#endif
+
+#if (BINLOG_MAX_ARGS > 255U) ||                                             \
+    (BINLOG_HEADER_SIZE + BINLOG_MAX_ARGS > BINLOG_BUFFER_SIZE)
+#error "invalid BINLOG_MAX_ARGS value"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+#if BINLOG_ENABLED || defined(__DOXYGEN__)
+/**
+ * @brief   Logs a record.
+ * @details The format string is not formatted on the target, the record
+ *          contains its identifier and the arguments as raw words.
+ * @note    The format string must be a literal, the arguments must be
+ *          integers, pointers must be cast to @p uint32_t, floating
+ *          point values must be converted using @p binlogFloat().
+ * @note    A @p "%s" argument is decoded as a pointer to a string in the
+ *          read only data of the ELF file.
+ * @note    This macro can be invoked from any context.
+ *
+ * @param[in] fmt       the format string literal
+ * @param[in] ...       the arguments, up to @p BINLOG_MAX_ARGS
+ *
+ * @special
+ */
+#define BINLOG(fmt, ...) do {                                               \
+  syssts_t _binlog_sts = osalSysGetStatusAndLockX();                        \
+  BINLOG_I(fmt, __VA_ARGS__);                                               \
+  osalSysRestoreStatusX(_binlog_sts);                                       \
+} while (false)
+
+/**
+ * @brief   Logs a record.
+ * @note    This macro must be invoked from within a lock zone.
+ *
+ * @param[in] fmt       the format string literal
+ * @param[in] ...       the arguments, up to @p BINLOG_MAX_ARGS
+ *
+ * @iclass
+ */
+#define BINLOG_I(fmt, ...) do {                                             \
+  static const char _binlog_fmt[] BINLOG_FORMAT_SECTION = fmt;              \
+  const uint32_t _binlog_args[] = {0U, __VA_ARGS__};                        \
+  binlogWriteI(_binlog_fmt, &_binlog_args[1],                               \
+               (sizeof _binlog_args / sizeof _binlog_args[0]) - 1U);        \
+} while (false)
+#else /* !BINLOG_ENABLED */
+#define BINLOG(fmt, ...)
+#define BINLOG_I(fmt, ...)
+#endif /* !BINLOG_ENABLED */
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void binlogInit(void);
+  void binlogWriteI(const char *fmt, const uint32_t *args, size_t n);
+  size_t binlogFlush(BaseSequentialStream *chp, systime_t timeout);
+  void binlogDrainThread(void *arg);
+  uint32_t binlogGetDroppedX(void);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Converts a floating point argument in a log word.
+ *
+ * @param[in] f         the value to be logged
+ * @return              The value bits.
+ *
+ * @xclass
+ */
+static inline uint32_t binlogFloat(float f) {
+  union {
+    float       f;
+    uint32_t    w;
+  } u;
+
+  u.f = f;
+  return u.w;
+}
+
+#endif /* _BINLOG_H_ */
+
+/** @} */
@@ -0,0 +1,234 @@
+#!/usr/bin/env python3
+#
+#    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+#
+#    Licensed under the Apache License, Version 2.0 (the "License");
+#    you may not use this file except in compliance with the License.
+#    You may obtain a copy of the License at
+#
+#        http://www.apache.org/licenses/LICENSE-2.0
+#
+#    Unless required by applicable law or agreed to in writing, software
+#    distributed under the License is distributed on an "AS IS" BASIS,
+#    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#    See the License for the specific language governing permissions and
+#    limitations under the License.
+#
+
+"""Deferred binary log decoder.
+
+Reads the records written by binlogFlush() from a file, a serial device or
+the standard input and formats them using the format strings found in the
+.binlog section of the ELF file of the application.
+
+Example:
+
+    binlogdec.py --freq 168000000 build/ch.elf /dev/ttyACM0
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+BINLOG_MARKER = 0xB1
+BINLOG_HEADER_SIZE = 3
+
+SHT_NOBITS = 8
+SHF_ALLOC = 2
+
+# chprintf() conversion specification.
+SPEC = re.compile(r"%(-?)(0?)(\*|\d*)(?:\.(\*|\d*))?([lL]?)(.)")
+
+
+class Elf(object):
+    """Minimal ELF reader, only the section headers are parsed."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF":
+            raise ValueError("%s: not an ELF file" % path)
+        self.is64 = self.data[4] == 2
+        self.endian = "<" if self.data[5] == 1 else ">"
+        e = self.endian
+        if self.is64:
+            shoff, = struct.unpack_from(e + "Q", self.data, 0x28)
+            shentsize, shnum, shstrndx = struct.unpack_from(e + "HHH",
+                                                            self.data, 0x3A)
+            fmt = e + "IIQQQQIIQQ"
+        else:
+            shoff, = struct.unpack_from(e + "I", self.data, 0x20)
+            shentsize, shnum, shstrndx = struct.unpack_from(e + "HHH",
+                                                            self.data, 0x2E)
+            fmt = e + "IIIIIIIIII"
+        self.sections = []
+        for i in range(shnum):
+            (name, stype, flags, addr, offset,
+             size, _, _, _, _) = struct.unpack_from(fmt, self.data,
+                                                    shoff + i * shentsize)
+            self.sections.append([name, stype, flags, addr, offset, size])
+        strtab = self.sections[shstrndx]
+        for s in self.sections:
+            start = strtab[4] + s[0]
+            s[0] = self.data[start:self.data.index(b"\0", start)].decode()
+
+    def section(self, name):
+        for s in self.sections:
+            if s[0] == name:
+                return s
+        return None
+
+    def string_at(self, section, offset):
+        """Returns the string at an offset in a section."""
+        start = section[4] + offset
+        end = self.data.find(b"\0", start, section[4] + section[5])
+        if end < 0:
+            return None
+        return self.data[start:end].decode("latin-1")
+
+    def rodata_string(self, addr):
+        """Returns the string at a target address, if initialized."""
+        for s in self.sections:
+            if ((s[2] & SHF_ALLOC) and s[1] != SHT_NOBITS and
+                    s[3] <= addr < s[3] + s[5]):
+                return self.string_at(s, addr - s[3])
+        return None
+
+
+def to_signed(w):
+    return w - (1 << 32) if w & 0x80000000 else w
+
+
+def format_record(elf, fmt, args):
+    """Formats a record as chprintf() would do."""
+    args = list(args)
+    out = []
+    pos = 0
+
+    def next_arg():
+        return args.pop(0) if args else 0
+
+    for m in SPEC.finditer(fmt):
+        out.append(fmt[pos:m.start()])
+        pos = m.end()
+        left, zero, width, prec, _, conv = m.groups()
+        if width == "*":
+            width = str(to_signed(next_arg()))
+        if prec == "*":
+            prec = str(next_arg())
+        flags = left + zero + width
+        if conv == "c":
+            out.append(("%" + left + width + "s") % chr(next_arg() & 0xFF))
+        elif conv == "s":
+            s = elf.rodata_string(next_arg())
+            if s is None:
+                s = "(?)"
+            p = "." + prec if prec else ""
+            out.append(("%" + left + width + p + "s") % s)
+        elif conv in "dDiI":
+            out.append(("%" + flags + "d") % to_signed(next_arg()))
+        elif conv in "uU":
+            out.append(("%" + flags + "d") % next_arg())
+        elif conv in "xX":
+            out.append(("%" + flags + "X") % next_arg())
+        elif conv in "oO":
+            out.append(("%" + flags + "o") % next_arg())
+        elif conv == "f":
+            v, = struct.unpack("<f", struct.pack("<I", next_arg()))
+            p = "." + (prec if prec else "6")
+            out.append(("%" + flags + p + "f") % v)
+        else:
+            out.append(conv)
+    out.append(fmt[pos:])
+    return "".join(out)
+
+
+class Decoder(object):
+    """Splits the byte stream in records and formats them."""
+
+    def __init__(self, elf, freq):
+        self.elf = elf
+        self.freq = freq
+        self.fmtsec = elf.section(".binlog")
+        if self.fmtsec is None:
+            raise ValueError("no .binlog section in the ELF file")
+        # The linker script reserves the first word, a format string at
+        # the start of the section would have address zero on the target.
+        if (self.fmtsec[5] < 4 or
+                elf.data[self.fmtsec[4]:self.fmtsec[4] + 4] != b"\0" * 4):
+            raise ValueError("the .binlog section does not start with the "
+                             "reserved word, check the linker script")
+        self.buf = b""
+        self.seq = None
+        self.skipped = 0
+
+    def word(self, offset):
+        w, = struct.unpack_from(self.elf.endian + "I", self.buf, offset)
+        return w
+
+    def feed(self, data):
+        """Decodes the complete records, returns the output lines."""
+        self.buf += data
+        lines = []
+        while len(self.buf) >= 4 * BINLOG_HEADER_SIZE:
+            header = self.word(0)
+            n = (header >> 16) & 0xFF
+            fmtid = self.word(8) - self.fmtsec[3]
+            if (header >> 24) != BINLOG_MARKER or \
+               not 4 <= fmtid < self.fmtsec[5]:
+                # Not aligned to a record, skipping a byte.
+                self.buf = self.buf[1:]
+                self.skipped += 1
+                continue
+            size = 4 * (BINLOG_HEADER_SIZE + n)
+            if len(self.buf) < size:
+                break
+            if self.skipped:
+                lines.append("*** %d bytes skipped" % self.skipped)
+                self.skipped = 0
+            seq = header & 0xFFFF
+            if self.seq is not None and seq != self.seq:
+                lines.append("*** %d records lost" %
+                             ((seq - self.seq) & 0xFFFF))
+            self.seq = (seq + 1) & 0xFFFF
+            ts = self.word(4)
+            args = [self.word(4 * (BINLOG_HEADER_SIZE + i))
+                    for i in range(n)]
+            fmt = self.elf.string_at(self.fmtsec, fmtid)
+            text = format_record(self.elf, fmt, args)
+            if self.freq:
+                stamp = "%12.6f" % (float(ts) / self.freq)
+            else:
+                stamp = "%10u" % ts
+            lines.append("%s %s" % (stamp, text.rstrip("\r\n")))
+            self.buf = self.buf[size:]
+        return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf", help="ELF file of the application")
+    parser.add_argument("input", nargs="?", default="-",
+                        help="raw log file or device, default stdin")
+    parser.add_argument("--freq", type=int, default=0,
+                        help="timestamp counter frequency in Hz, if "
+                             "specified the time is printed in seconds")
+    opts = parser.parse_args()
+
+    decoder = Decoder(Elf(opts.elf), opts.freq)
+    if opts.input == "-":
+        stream = sys.stdin.buffer
+    else:
+        stream = open(opts.input, "rb", buffering=0)
+    while True:
+        data = stream.read(256)
+        if not data:
+            break
+        for line in decoder.feed(data):
+            print(line)
+            sys.stdout.flush()
+
+
+if __name__ == "__main__":
+    main()
@@ -27,12 +27,70 @@
  * @{
  */
 
+#include <string.h>
+
 #include "hal.h"
 #include "chprintf.h"
 #include "memstreams.h"
 
 #define MAX_FILLER 11
 #define FLOAT_PRECISION 9
+#define FLOAT_DIGITS 54
+#define FLOAT_BIG_WORDS 8
+
+/*
+ * Output buffer, the characters are collected here and written to the
+ * stream in runs.
+ */
+typedef struct {
+  BaseSequentialStream *chp;
+  size_t n;
+  uint8_t buf[CHPRINTF_BUFFER_SIZE];
+} outbuf_t;
+
+static void out_flush(outbuf_t *obp) {
+
+  if (obp->n > 0) {
+    (void)streamWrite(obp->chp, obp->buf, obp->n);
+    obp->n = 0;
+  }
+}
+
+static void out_put(outbuf_t *obp, char c) {
+
+  obp->buf[obp->n++] = (uint8_t)c;
+  if (obp->n >= CHPRINTF_BUFFER_SIZE)
+    out_flush(obp);
+}
+
+static void out_fill(outbuf_t *obp, char c, int n) {
+
+  while (n-- > 0)
+    out_put(obp, c);
+}
+
+static void out_write(outbuf_t *obp, const char *s, size_t n) {
+  size_t m;
+
+  /* Long runs bypass the buffer.*/
+  if (n >= CHPRINTF_BUFFER_SIZE) {
+    out_flush(obp);
+    (void)streamWrite(obp->chp, (const uint8_t *)s, n);
+    return;
+  }
+
+  while (n > 0) {
+    m = CHPRINTF_BUFFER_SIZE - obp->n;
+    if (m > n)
+      m = n;
+    memcpy(&obp->buf[obp->n], s, m);
+    obp->n += m;
+    s += m;
+    n -= m;
+    if (obp->n >= CHPRINTF_BUFFER_SIZE)
+      out_flush(obp);
+  }
+}
 
 static char *long_to_string_with_divisor(char *p,
                                          long num,
@@ -73,24 +131,384 @@ static char *ch_ltoa(char *p, long num, unsigned radix) {
 }
 
 #if CHPRINTF_USE_FLOAT
-static const long pow10[FLOAT_PRECISION] = {
-    10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+/*
+ * The float is split in an integer mantissa and a binary exponent, the
+ * value is scaled by a power of ten using integer arithmetic only and
+ * rounded to the nearest, ties to even, the output is the same of the C
+ * library for the same float.
+ */
+static const uint32_t pow10[FLOAT_PRECISION + 1] = {
+  1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
 };
 
-static char *ftoa(char *p, double num, unsigned long precision) {
-  long l;
+static bool float_split(float num, bool *negp, uint32_t *mp, int *e2p) {
+  union {
+    float       f;
+    uint32_t    w;
+  } u;
+  uint32_t e;
+
+  u.f = num;
+  *negp = (u.w & 0x80000000U) != 0U;
+  *mp = u.w & 0x007FFFFFU;
+  e = (u.w >> 23) & 0xFFU;
+  if (e == 0xFFU)
+    return false;
+  if (e == 0U)
+    *e2p = -149;
+  else {
+    *mp |= 0x00800000U;
+    *e2p = (int)e - 150;
+  }
+  return true;
+}
 
-  if ((precision == 0) || (precision > FLOAT_PRECISION))
-    precision = FLOAT_PRECISION;
-  precision = pow10[precision - 1];
+/*
+ * Writes up to 9 digits of a chunk backward, all 9 if full is true.
+ */
+static char *chunk_to_digits(char *q, uint32_t r, bool full) {
+  int i;
 
-  l = (long)num;
-  p = long_to_string_with_divisor(p, l, 10, 0);
-  *p++ = '.';
-  l = (long)((num - l) * precision);
-  return long_to_string_with_divisor(p, l, 10, precision / 10);
+  for (i = 0; i < 9; i++) {
+    *--q = (char)('0' + r % 10U);
+    r /= 10U;
+    if (!full && (r == 0U))
+      break;
+  }
+  return q;
 }
-#endif
+
+/*
+ * Writes the digits in fixed point format.
+ */
+static char *put_fixed(char *p, const char *d, int n, int decimals) {
+
+  if (n <= decimals) {
+    *p++ = '0';
+    *p++ = '.';
+    memset(p, '0', (size_t)(decimals - n));
+    p += decimals - n;
+  }
+  else {
+    memcpy(p, d, (size_t)(n - decimals));
+    p += n - decimals;
+    d += n - decimals;
+    n = decimals;
+    if (n > 0)
+      *p++ = '.';
+  }
+  memcpy(p, d, (size_t)n);
+  return p + n;
+}
+
+#if CHPRINTF_FLOAT_COMPACT
+/*
+ * Compact conversion, values up to 2^64 using 64 bits arithmetic.
+ */
+static char *ftoa(char *p, float num, int precision) {
+  char digits[20], *q;
+  uint64_t v, rem, half;
+  uint32_t m;
+  int e2, n, s;
+  bool neg;
+
+  if (!float_split(num, &neg, &m, &e2)) {
+    if (neg)
+      *p++ = '-';
+    memcpy(p, m == 0U ? "inf" : "nan", 3);
+    return p + 3;
+  }
+  if (neg)
+    *p++ = '-';
+  if (e2 > 40) {
+    memcpy(p, "ovf", 3);
+    return p + 3;
+  }
+
+  if (e2 >= 0) {
+    /* Integer value, the decimals are zeros.*/
+    v = (uint64_t)m << e2;
+  }
+  else {
+    v = (uint64_t)m * pow10[precision];
+    s = -e2;
+    if (s >= 64)
+      v = 0U;
+    else {
+      half = (uint64_t)1 << (s - 1);
+      rem = v & ((half << 1) - 1U);
+      v >>= s;
+      if ((rem > half) || ((rem == half) && ((v & 1U) != 0U)))
+        v++;
+    }
+  }
+
+  q = digits + sizeof digits;
+  while (v >= 1000000000U) {
+    q = chunk_to_digits(q, (uint32_t)(v % 1000000000U), true);
+    v /= 1000000000U;
+  }
+  q = chunk_to_digits(q, (uint32_t)v, false);
+  n = (int)(digits + sizeof digits - q);
+
+  if (e2 >= 0) {
+    p = put_fixed(p, q, n, 0);
+    if (precision > 0) {
+      *p++ = '.';
+      memset(p, '0', (size_t)precision);
+      p += precision;
+    }
+    return p;
+  }
+  return put_fixed(p, q, n, precision);
+}
+
+#else /* !CHPRINTF_FLOAT_COMPACT */
+/*
+ * Multiple words integer, enough for a float scaled by 10^54.
+ */
+typedef struct {
+  int n;
+  uint32_t w[FLOAT_BIG_WORDS];
+} bignum_t;
+
+static void big_mul(bignum_t *bp, uint32_t f) {
+  uint64_t carry = 0U;
+  int i;
+
+  for (i = 0; i < bp->n; i++) {
+    carry += (uint64_t)bp->w[i] * f;
+    bp->w[i] = (uint32_t)carry;
+    carry >>= 32;
+  }
+  if (carry != 0U)
+    bp->w[bp->n++] = (uint32_t)carry;
+}
+
+static uint32_t big_div(bignum_t *bp, uint32_t d) {
+  uint64_t r;
+  int i;
+
+  if (bp->n == 1) {
+    r = bp->w[0] % d;
+    bp->w[0] /= d;
+  }
+  else {
+    r = 0U;
+    for (i = bp->n - 1; i >= 0; i--) {
+      r = (r << 32) | bp->w[i];
+      bp->w[i] = (uint32_t)(r / d);
+      r %= d;
+    }
+  }
+  while ((bp->n > 0) && (bp->w[bp->n - 1] == 0U))
+    bp->n--;
+  return (uint32_t)r;
+}
+
+static void big_shl(bignum_t *bp, int s) {
+  uint32_t carry = 0U, w;
+  int i, ws = s / 32, bs = s % 32;
+
+  if (bs > 0) {
+    for (i = 0; i < bp->n; i++) {
+      w = bp->w[i];
+      bp->w[i] = (w << bs) | carry;
+      carry = w >> (32 - bs);
+    }
+    if (carry != 0U)
+      bp->w[bp->n++] = carry;
+  }
+  if (ws > 0) {
+    for (i = bp->n - 1; i >= 0; i--)
+      bp->w[i + ws] = bp->w[i];
+    for (i = 0; i < ws; i++)
+      bp->w[i] = 0U;
+    bp->n += ws;
+  }
+}
+
+/*
+ * Shifts right, returns true if any of the discarded bits was set.
+ */
+static bool big_shr(bignum_t *bp, int s) {
+  bool sticky = false;
+  int i, ws = s / 32, bs = s % 32;
+
+  if (ws >= bp->n) {
+    sticky = bp->n > 0;
+    bp->n = 0;
+    return sticky;
+  }
+  for (i = 0; i < ws; i++)
+    sticky = sticky || (bp->w[i] != 0U);
+  for (i = 0; i < bp->n - ws; i++)
+    bp->w[i] = bp->w[i + ws];
+  bp->n -= ws;
+  if (bs > 0) {
+    sticky = sticky || ((bp->w[0] & ((1U << bs) - 1U)) != 0U);
+    for (i = 0; i < bp->n - 1; i++)
+      bp->w[i] = (bp->w[i] >> bs) | (bp->w[i + 1] << (32 - bs));
+    bp->w[i] >>= bs;
+    if (bp->w[i] == 0U)
+      bp->n--;
+  }
+  return sticky;
+}
+
+/*
+ * Computes m * 2^e2 * 10^k rounded to the nearest integer, ties to even.
+ */
+static void big_scale(bignum_t *bp, uint32_t m, int e2, int k) {
+  uint32_t r;
+  int j, cmp = -1;
+  bool sticky = false;
+
+  bp->w[0] = m;
+  bp->n = 1;
+  for (; k > 0; k -= j) {
+    j = k > FLOAT_PRECISION ? FLOAT_PRECISION : k;
+    big_mul(bp, pow10[j]);
+  }
+  if (e2 > 0)
+    big_shl(bp, e2);
+
+  /* Exact divisions, only the last one is compared with half the divisor,
+     the previous ones just tell if the value was exact.*/
+  if (e2 < 0) {
+    for (; k < 0; k += j) {
+      j = -k > FLOAT_PRECISION ? FLOAT_PRECISION : -k;
+      sticky = (big_div(bp, pow10[j]) != 0U) || sticky;
+    }
+    if (e2 < -1)
+      sticky = big_shr(bp, -e2 - 1) || sticky;
+    if ((bp->n > 0) && ((bp->w[0] & 1U) != 0U))
+      cmp = sticky ? 1 : 0;
+    (void)big_shr(bp, 1);
+  }
+  else if (k < 0) {
+    for (; k < -1; k += j) {
+      j = -k - 1 > FLOAT_PRECISION ? FLOAT_PRECISION : -k - 1;
+      sticky = (big_div(bp, pow10[j]) != 0U) || sticky;
+    }
+    r = big_div(bp, 10U);
+    if ((r > 5U) || ((r == 5U) && sticky))
+      cmp = 1;
+    else if (r == 5U)
+      cmp = 0;
+  }
+
+  if ((cmp > 0) || ((cmp == 0) && (bp->n > 0) && ((bp->w[0] & 1U) != 0U))) {
+    for (j = 0; (j < bp->n) && (++bp->w[j] == 0U); j++)
+      ;
+    if (j == bp->n)
+      bp->w[bp->n++] = 1U;
+  }
+}
+
+/*
+ * Writes the decimal digits, returns their number.
+ */
+static int big_digits(char *d, bignum_t *bp) {
+  char tmp[FLOAT_DIGITS], *q;
+  uint32_t r;
+  int n;
+
+  q = tmp + sizeof tmp;
+  do {
+    r = bp->n > 0 ? big_div(bp, 1000000000U) : 0U;
+    q = chunk_to_digits(q, r, bp->n > 0);
+  } while (bp->n > 0);
+  n = (int)(tmp + sizeof tmp - q);
+  memcpy(d, q, (size_t)n);
+  return n;
+}
+
+/*
+ * Removes the trailing zeros of the decimals and the point if left alone.
+ */
+static char *strip_zeros(char *s, char *p) {
+
+  while ((p > s) && (*(p - 1) == '0'))
+    p--;
+  if ((p > s) && (*(p - 1) == '.'))
+    p--;
+  return p;
+}
+
+static char *ftoa(char *p, float num, int precision, char conv) {
+  bignum_t big;
+  char digits[FLOAT_DIGITS], *s;
+  uint32_t m;
+  int e2, x, n, t;
+  bool neg;
+
+  if (!float_split(num, &neg, &m, &e2)) {
+    if (neg)
+      *p++ = '-';
+    memcpy(p, m == 0U ? "inf" : "nan", 3);
+    return p + 3;
+  }
+  if (neg)
+    *p++ = '-';
+
+  if (conv == 'f') {
+    big_scale(&big, m, e2, precision);
+    n = big_digits(digits, &big);
+    return put_fixed(p, digits, n, precision);
+  }
+
+  /* For %g the precision is the number of significant digits, here it
+     becomes the number of decimals of the exponential format.*/
+  if (conv == 'g') {
+    if (precision > 0)
+      precision--;
+  }
+
+  if (m == 0U) {
+    x = 0;
+    n = precision + 1;
+    memset(digits, '0', (size_t)n);
+  }
+  else {
+    /* Decimal exponent estimate, floor(log2(value) * log10(2)), it can be
+       one less than the real one.*/
+    for (t = 0; (m >> t) > 1U; t++)
+      ;
+    t = (t + e2) * 78913;
+    x = t >= 0 ? t / 262144 : -((-t + 262143) / 262144);
+    big_scale(&big, m, e2, precision - x);
+    n = big_digits(digits, &big);
+    if (n != precision + 1) {
+      x += n - (precision + 1);
+      big_scale(&big, m, e2, precision - x);
+      n = big_digits(digits, &big);
+    }
+  }
+
+  if ((conv == 'g') && (x >= -4) && (x <= precision)) {
+    s = p;
+    p = put_fixed(p, digits, n, precision - x);
+    return precision > x ? strip_zeros(s, p) : p;
+  }
+
+  s = p;
+  p = put_fixed(p, digits, n, n - 1);
+  if (conv == 'g')
+    p = strip_zeros(s, p);
+  *p++ = 'e';
+  if (x < 0) {
+    *p++ = '-';
+    x = -x;
+  }
+  else
+    *p++ = '+';
+  if (x < 10)
+    *p++ = '0';
+  return ch_ltoa(p, x, 10);
+}
+#endif /* !CHPRINTF_FLOAT_COMPACT */
+#endif /* CHPRINTF_USE_FLOAT */
 
 /**
  * @brief   System formatted output function.
@@ -108,7 +526,17 @@ static char *ftoa(char *p, double num, unsigned long precision) {
  *          - <b>U</b> decimal unsigned long.
  *          - <b>c</b> character.
  *          - <b>s</b> string.
+ *          - <b>f</b> float, if @p CHPRINTF_USE_FLOAT is enabled.
+ *          - <b>e</b> float in exponential format, unless
+ *            @p CHPRINTF_FLOAT_COMPACT is enabled.
+ *          - <b>g</b> float in the shortest format, unless
+ *            @p CHPRINTF_FLOAT_COMPACT is enabled.
  *          .
+ * @note    The float precision is 9 digits when it is not specified or
+ *          zero, it is also the maximum.
+ * @note    The output is written using @p streamWrite() in runs of up to
+ *          @p CHPRINTF_BUFFER_SIZE characters, the whole output has been
+ *          written when the function returns.
  *
  * @param[in] chp       pointer to a @p BaseSequentialStream implementing object
  * @param[in] fmt       formatting string
@@ -119,25 +547,35 @@ static char *ftoa(char *p, double num, unsigned long precision) {
  * @api
  */
 int chvprintf(BaseSequentialStream *chp, const char *fmt, va_list ap) {
+  const char *run;
   char *p, *s, c, filler;
   int i, precision, width;
   int n = 0;
   bool is_long, left_align;
   long l;
+  outbuf_t ob;
 #if CHPRINTF_USE_FLOAT
   float f;
-  char tmpbuf[2*MAX_FILLER + 1];
+  char tmpbuf[FLOAT_DIGITS + 2];
 #else
   char tmpbuf[MAX_FILLER + 1];
 #endif
 
+  ob.chp = chp;
+  ob.n = 0;
   while (true) {
     c = *fmt++;
-    if (c == 0)
+    if (c == 0) {
+      out_flush(&ob);
       return n;
+    }
     if (c != '%') {
-      streamPut(chp, (uint8_t)c);
-      n++;
+      /* Literal characters up to the next directive.*/
+      run = fmt - 1;
+      while ((*fmt != 0) && (*fmt != '%'))
+        fmt++;
+      out_write(&ob, run, (size_t)(fmt - run));
+      n += (int)(fmt - run);
       continue;
     }
     p = tmpbuf;
@@ -163,8 +601,9 @@ int chvprintf(BaseSequentialStream *chp, const char *fmt, va_list ap) {
         break;
       width = width * 10 + c;
     }
-    precision = 0;
+    precision = -1;
     if (c == '.') {
+      precision = 0;
       while (TRUE) {
         c = *fmt++;
         if (c >= '0' && c <= '9')
@@ -196,7 +635,7 @@ int chvprintf(BaseSequentialStream *chp, const char *fmt, va_list ap) {
       filler = ' ';
       if ((s = va_arg(ap, char *)) == 0)
         s = "(null)";
-      if (precision == 0)
+      if (precision <= 0)
         precision = 32767;
       for (p = s; *p && (--precision >= 0); p++)
         ;
@@ -217,12 +656,21 @@ int chvprintf(BaseSequentialStream *chp, const char *fmt, va_list ap) {
       break;
 #if CHPRINTF_USE_FLOAT
     case 'f':
+#if !CHPRINTF_FLOAT_COMPACT
+    case 'e':
+    case 'g':
+#endif
       f = (float) va_arg(ap, double);
-      if (f < 0) {
-        *p++ = '-';
-        f = -f;
-      }
+      if ((precision <= 0) || (precision > FLOAT_PRECISION))
+        precision = FLOAT_PRECISION;
+#if CHPRINTF_FLOAT_COMPACT
       p = ftoa(p, f, precision);
+#else
+      p = ftoa(p, f, precision, c);
+#endif
+      /* The inf, nan and ovf strings are not zero padded.*/
+      if (*(p - 1) > '9')
+        filler = ' ';
       break;
 #endif
     case 'X':
@@ -254,25 +702,19 @@ unsigned_common:
       width = -width;
     if (width < 0) {
       if (*s == '-' && filler == '0') {
-        streamPut(chp, (uint8_t)*s++);
+        out_put(&ob, *s++);
         n++;
         i--;
       }
-      do {
-        streamPut(chp, (uint8_t)filler);
-        n++;
-      } while (++width != 0);
-    }
-    while (--i >= 0) {
-      streamPut(chp, (uint8_t)*s++);
-      n++;
+      out_fill(&ob, filler, -width);
+      n -= width;
+      width = 0;
     }
+    out_write(&ob, s, (size_t)i);
+    n += i;
 
-    while (width) {
-      streamPut(chp, (uint8_t)filler);
-      n++;
-      width--;
-    }
+    out_fill(&ob, filler, width);
+    n += width;
   }
 }
 
@@ -292,6 +734,11 @@ unsigned_common:
  *          - <b>U</b> decimal unsigned long.
  *          - <b>c</b> character.
  *          - <b>s</b> string.
+ *          - <b>f</b> float, if @p CHPRINTF_USE_FLOAT is enabled.
+ *          - <b>e</b> float in exponential format, unless
+ *            @p CHPRINTF_FLOAT_COMPACT is enabled.
+ *          - <b>g</b> float in the shortest format, unless
+ *            @p CHPRINTF_FLOAT_COMPACT is enabled.
  *          .
  *
  * @param[in] chp       pointer to a @p BaseSequentialStream implementing object
@@ -326,6 +773,11 @@ int chprintf(BaseSequentialStream *chp, const char *fmt, ...) {
  *          - <b>U</b> decimal unsigned long.
  *          - <b>c</b> character.
  *          - <b>s</b> string.
+ *          - <b>f</b> float, if @p CHPRINTF_USE_FLOAT is enabled.
+ *          - <b>e</b> float in exponential format, unless
+ *            @p CHPRINTF_FLOAT_COMPACT is enabled.
+ *          - <b>g</b> float in the shortest format, unless
+ *            @p CHPRINTF_FLOAT_COMPACT is enabled.
  *          .
  * @post    @p str is NUL-terminated, unless @p size is 0.
  *
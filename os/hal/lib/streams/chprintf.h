@@ -34,6 +34,30 @@
 #define CHPRINTF_USE_FLOAT          FALSE
 #endif
 
+/**
+ * @brief   Compact float support.
+ * @details If enabled only the @p %f conversion is supported, values above
+ *          2^64 are printed as @p ovf. This avoids the multiple words
+ *          arithmetic required by the full range and by @p %e and @p %g.
+ * @note    Both variants use integer arithmetic only.
+ */
+#if !defined(CHPRINTF_FLOAT_COMPACT) || defined(__DOXYGEN__)
+#define CHPRINTF_FLOAT_COMPACT      FALSE
+#endif
+
+/**
+ * @brief   Size of the output buffer allocated on the stack.
+ * @details The formatted output is written to the stream in runs of up to
+ *          this size, longer literal runs and strings are written directly.
+ */
+#if !defined(CHPRINTF_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define CHPRINTF_BUFFER_SIZE        32
+#endif
+
+#if CHPRINTF_BUFFER_SIZE < 1
+#error "invalid CHPRINTF_BUFFER_SIZE value"
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -138,6 +138,20 @@ struct SPIDriver {
    */
   mutex_t                   mutex;
 #endif /* SPI_USE_MUTUAL_EXCLUSION */
+#if SPI_USE_QUEUE || defined(__DOXYGEN__)
+  /**
+   * @brief Transaction being executed, head of the queue.
+   */
+  SPITransaction            *qhead;
+  /**
+   * @brief Last queued transaction.
+   */
+  SPITransaction            *qtail;
+  /**
+   * @brief Index of the transfer being executed.
+   */
+  size_t                    qstep;
+#endif /* SPI_USE_QUEUE */
 #if defined(SPI_DRIVER_EXT_FIELDS)
   SPI_DRIVER_EXT_FIELDS
 #endif
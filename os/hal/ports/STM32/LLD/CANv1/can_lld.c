@@ -57,6 +57,11 @@ CANDriver CAND2;
 /* Driver local variables and types.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Number of the first filter assigned to CAN2.
+ */
+static uint32_t can2_first_filter;
+
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
@@ -79,6 +84,12 @@ static void can_lld_set_filters(uint32_t can2sb,
   /* Temporarily enabling CAN1 clock.*/
   rccEnableCAN1(FALSE);
 
+  /* The filter match index is reported unchanged.*/
+  can2_first_filter = can2sb;
+#if STM32_CAN_USE_CAN2
+  CAND2.fmioffset = 0U;
+#endif
+
   /* Filters initialization.*/
   CAN1->FMR = (CAN1->FMR & 0xFFFF0000) | (can2sb << 8) | CAN_FMR_FINIT;
   if (num > 0) {
@@ -134,6 +145,88 @@ static void can_lld_set_filters(uint32_t can2sb,
   rccDisableCAN1(FALSE);
 }
 
+#if STM32_CAN_USE_CAN2 || defined(__DOXYGEN__)
+/**
+ * @brief   Filter match index of the first filter of a bank.
+ * @details The filter match index counts the filters assigned to FIFO 0 in
+ *          all the preceding banks, each bank contains from one to four
+ *          filters depending on its mode and scale.
+ * @pre     The CAN1 clock must be enabled.
+ *
+ * @param[in] bank      filter bank number
+ * @return              The filter match index.
+ *
+ * @notapi
+ */
+static uint32_t can_lld_get_fmi(uint32_t bank) {
+  uint32_t i, fmask, fmi = 0U;
+
+  for (i = 0U; i < bank; i++) {
+    fmask = 1U << i;
+    if ((CAN1->FFA1R & fmask) == 0U) {
+      if ((CAN1->FS1R & fmask) != 0U)
+        fmi += (CAN1->FM1R & fmask) != 0U ? 2U : 1U;
+      else
+        fmi += (CAN1->FM1R & fmask) != 0U ? 4U : 2U;
+    }
+  }
+  return fmi;
+}
+#endif /* STM32_CAN_USE_CAN2 */
+
+/**
+ * @brief   Encodes an identifier in the filter registers format.
+ *
+ * @param[in] id        identifier or mask
+ * @param[in] ide       identifier type
+ * @return              The filter register value.
+ *
+ * @notapi
+ */
+static uint32_t can_lld_filter_id(uint32_t id, uint8_t ide) {
+
+  if (ide != 0U)
+    return (id << 3) | CAN_RI0R_IDE;
+  return id << 21;
+}
+
+/**
+ * @brief   Fetches a frame from a receive FIFO.
+ * @pre     The FIFO must not be empty.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] fifo      receive FIFO index, zero or one
+ * @param[out] crfp     pointer to the buffer where the CAN frame is copied
+ *
+ * @notapi
+ */
+static void can_lld_fetch(CANDriver *canp, uint32_t fifo, CANRxFrame *crfp) {
+  uint32_t rir, rdtr;
+
+  /* Fetches the message.*/
+  rir  = canp->can->sFIFOMailBox[fifo].RIR;
+  rdtr = canp->can->sFIFOMailBox[fifo].RDTR;
+  crfp->data32[0] = canp->can->sFIFOMailBox[fifo].RDLR;
+  crfp->data32[1] = canp->can->sFIFOMailBox[fifo].RDHR;
+
+  /* Releases the mailbox.*/
+  if (fifo == 0U)
+    canp->can->RF0R = CAN_RF0R_RFOM0;
+  else
+    canp->can->RF1R = CAN_RF1R_RFOM1;
+
+  /* Decodes the various fields in the RX frame.*/
+  crfp->RTR = (rir & CAN_RI0R_RTR) >> 1;
+  crfp->IDE = (rir & CAN_RI0R_IDE) >> 2;
+  if (crfp->IDE)
+    crfp->EID = rir >> 3;
+  else
+    crfp->SID = rir >> 21;
+  crfp->DLC = rdtr & CAN_RDT0R_DLC;
+  crfp->FMI = (uint8_t)(rdtr >> 8) - canp->fmioffset;
+  crfp->TIME = (uint16_t)(rdtr >> 16);
+}
+
 /**
  * @brief   Common TX ISR handler.
  *
@@ -182,8 +275,12 @@ static void can_lld_tx_handler(CANDriver *canp) {
     }
   }
 
-  /* Signaling flags and waking up threads waiting for a transmission slot.*/
+  /* Signaling flags and waking up threads waiting for a transmission slot,
+     queued frames are moved into the free mailboxes first.*/
   osalSysLockFromISR();
+#if CAN_USE_TX_QUEUE
+  _can_tx_refill_i(canp);
+#endif
   osalThreadDequeueAllI(&canp->txqueue, MSG_OK);
   osalEventBroadcastFlagsI(&canp->txempty_event, flags);
   osalSysUnlockFromISR();
@@ -200,6 +297,24 @@ static void can_lld_rx0_handler(CANDriver *canp) {
   uint32_t rf0r;
 
   rf0r = canp->can->RF0R;
+#if CAN_USE_RX_QUEUES
+  if (canp->rxqueues != NULL) {
+    if ((rf0r & CAN_RF0R_FMP0) > 0) {
+      CANRxFrame crf;
+
+      /* The hardware FIFO is emptied, the frames are moved into the
+         software queues.*/
+      osalSysLockFromISR();
+      while ((canp->can->RF0R & CAN_RF0R_FMP0) > 0) {
+        can_lld_fetch(canp, 0U, &crf);
+        _can_rx_enqueue_i(canp, &crf);
+      }
+      osalEventBroadcastFlagsI(&canp->rxfull_event, CAN_MAILBOX_TO_MASK(1U));
+      osalSysUnlockFromISR();
+    }
+  }
+  else
+#endif /* CAN_USE_RX_QUEUES */
   if ((rf0r & CAN_RF0R_FMP0) > 0) {
     /* No more receive events until the queue 0 has been emptied.*/
     canp->can->IER &= ~CAN_IER_FMPIE0;
@@ -212,6 +327,9 @@ static void can_lld_rx0_handler(CANDriver *canp) {
     /* Overflow events handling.*/
     canp->can->RF0R = CAN_RF0R_FOVR0;
     osalSysLockFromISR();
+#if CAN_USE_RX_QUEUES
+    canp->rxoverruns++;
+#endif
     osalEventBroadcastFlagsI(&canp->error_event, CAN_OVERFLOW_ERROR);
     osalSysUnlockFromISR();
   }
@@ -228,6 +346,24 @@ static void can_lld_rx1_handler(CANDriver *canp) {
   uint32_t rf1r;
 
   rf1r = canp->can->RF1R;
+#if CAN_USE_RX_QUEUES
+  if (canp->rxqueues != NULL) {
+    if ((rf1r & CAN_RF1R_FMP1) > 0) {
+      CANRxFrame crf;
+
+      /* The hardware FIFO is emptied, the frames are moved into the
+         software queues.*/
+      osalSysLockFromISR();
+      while ((canp->can->RF1R & CAN_RF1R_FMP1) > 0) {
+        can_lld_fetch(canp, 1U, &crf);
+        _can_rx_enqueue_i(canp, &crf);
+      }
+      osalEventBroadcastFlagsI(&canp->rxfull_event, CAN_MAILBOX_TO_MASK(2U));
+      osalSysUnlockFromISR();
+    }
+  }
+  else
+#endif /* CAN_USE_RX_QUEUES */
   if ((rf1r & CAN_RF1R_FMP1) > 0) {
     /* No more receive events until the queue 0 has been emptied.*/
     canp->can->IER &= ~CAN_IER_FMPIE1;
@@ -240,6 +376,9 @@ static void can_lld_rx1_handler(CANDriver *canp) {
     /* Overflow events handling.*/
     canp->can->RF1R = CAN_RF1R_FOVR1;
     osalSysLockFromISR();
+#if CAN_USE_RX_QUEUES
+    canp->rxoverruns++;
+#endif
     osalEventBroadcastFlagsI(&canp->error_event, CAN_OVERFLOW_ERROR);
     osalSysUnlockFromISR();
   }
@@ -265,6 +404,9 @@ static void can_lld_sce_handler(CANDriver *canp) {
     canp->state = CAN_READY;
     canp->can->MCR &= ~CAN_MCR_SLEEP;
     osalSysLockFromISR();
+#if CAN_USE_TX_QUEUE
+    _can_tx_refill_i(canp);
+#endif
     osalEventBroadcastFlagsI(&canp->wakeup_event, 0);
     osalSysUnlockFromISR();
   }
@@ -729,7 +871,6 @@ bool can_lld_is_rx_nonempty(CANDriver *canp, canmbx_t mailbox) {
 void can_lld_receive(CANDriver *canp,
                      canmbx_t mailbox,
                      CANRxFrame *crfp) {
-  uint32_t rir, rdtr;
 
   if (mailbox == CAN_ANY_MAILBOX) {
     if ((canp->can->RF0R & CAN_RF0R_FMP0) != 0)
@@ -743,14 +884,8 @@ void can_lld_receive(CANDriver *canp,
   }
   switch (mailbox) {
   case 1:
-    /* Fetches the message.*/
-    rir  = canp->can->sFIFOMailBox[0].RIR;
-    rdtr = canp->can->sFIFOMailBox[0].RDTR;
-    crfp->data32[0] = canp->can->sFIFOMailBox[0].RDLR;
-    crfp->data32[1] = canp->can->sFIFOMailBox[0].RDHR;
-
-    /* Releases the mailbox.*/
-    canp->can->RF0R = CAN_RF0R_RFOM0;
+    /* Fetches the message and releases the mailbox.*/
+    can_lld_fetch(canp, 0U, crfp);
 
     /* If the queue is empty re-enables the interrupt in order to generate
        events again.*/
@@ -758,14 +893,8 @@ void can_lld_receive(CANDriver *canp,
       canp->can->IER |= CAN_IER_FMPIE0;
     break;
   case 2:
-    /* Fetches the message.*/
-    rir  = canp->can->sFIFOMailBox[1].RIR;
-    rdtr = canp->can->sFIFOMailBox[1].RDTR;
-    crfp->data32[0] = canp->can->sFIFOMailBox[1].RDLR;
-    crfp->data32[1] = canp->can->sFIFOMailBox[1].RDHR;
-
-    /* Releases the mailbox.*/
-    canp->can->RF1R = CAN_RF1R_RFOM1;
+    /* Fetches the message and releases the mailbox.*/
+    can_lld_fetch(canp, 1U, crfp);
 
     /* If the queue is empty re-enables the interrupt in order to generate
        events again.*/
@@ -776,17 +905,86 @@ void can_lld_receive(CANDriver *canp,
     /* Should not happen, do nothing.*/
     return;
   }
+}
 
-  /* Decodes the various fields in the RX frame.*/
-  crfp->RTR = (rir & CAN_RI0R_RTR) >> 1;
-  crfp->IDE = (rir & CAN_RI0R_IDE) >> 2;
-  if (crfp->IDE)
-    crfp->EID = rir >> 3;
-  else
-    crfp->SID = rir >> 21;
-  crfp->DLC = rdtr & CAN_RDT0R_DLC;
-  crfp->FMI = (uint8_t)(rdtr >> 8);
-  crfp->TIME = (uint16_t)(rdtr >> 16);
+/**
+ * @brief   Programs the acceptance filters.
+ * @details The filter banks assigned to the driver are reprogrammed as
+ *          32 bits mask filters on FIFO 0, one filter for each bank.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] afp       pointer to the filters array, can be @p NULL if
+ *                      (num == 0)
+ * @param[in] num       number of entries in the filters array, if zero then
+ *                      all frames are accepted
+ *
+ * @notapi
+ */
+void can_lld_set_acceptance_filters(CANDriver *canp,
+                                    const CANAcceptanceFilter *afp,
+                                    uint32_t num) {
+  uint32_t first, last, i, fmask;
+
+  /* Range of filter banks assigned to the driver.*/
+  first = 0U;
+#if STM32_HAS_CAN2
+  last  = can2_first_filter;
+#else
+  last  = STM32_CAN_MAX_FILTERS;
+#endif
+#if STM32_CAN_USE_CAN2
+  if (&CAND2 == canp) {
+    first = can2_first_filter;
+    last  = STM32_CAN_MAX_FILTERS;
+  }
+#endif
+  osalDbgAssert(num <= last - first, "too many filters");
+
+  /* The filters are accessed through CAN1, its clock could be already
+     running if CAN1 is active.*/
+  rccEnableCAN1(FALSE);
+  CAN1->FMR |= CAN_FMR_FINIT;
+
+  /* All the banks of the driver are disabled and set as 32 bits mask
+     filters assigned to FIFO 0.*/
+  for (i = first; i < last; i++) {
+    fmask = 1U << i;
+    CAN1->FA1R  &= ~fmask;
+    CAN1->FM1R  &= ~fmask;
+    CAN1->FFA1R &= ~fmask;
+    CAN1->FS1R  |= fmask;
+  }
+
+  if (num > 0U) {
+    for (i = 0U; i < num; i++) {
+      CAN1->sFilterRegister[first + i].FR1 = can_lld_filter_id(afp->id,
+                                                               afp->ide);
+      CAN1->sFilterRegister[first + i].FR2 = can_lld_filter_id(afp->mask,
+                                                               afp->ide) |
+                                             CAN_RI0R_IDE;
+      CAN1->FA1R |= 1U << (first + i);
+      afp++;
+    }
+  }
+  else {
+    /* Single filter accepting everything.*/
+    CAN1->sFilterRegister[first].FR1 = 0U;
+    CAN1->sFilterRegister[first].FR2 = 0U;
+    CAN1->FA1R |= 1U << first;
+  }
+  CAN1->FMR &= ~CAN_FMR_FINIT;
+
+#if STM32_CAN_USE_CAN2
+  /* The CAN2 filter match index depends on the CAN1 banks too, it is
+     updated if CAN2 is using the portable filters.*/
+  if ((&CAND2 == canp) || (CAND2.fmioffset != 0U))
+    CAND2.fmioffset = (uint8_t)can_lld_get_fmi(can2_first_filter);
+#endif
+
+  /* Clock disabled if CAN1 is not active, it will be enabled again in
+     can_lld_start().*/
+  if (CAND1.state == CAN_STOP)
+    rccDisableCAN1(FALSE);
 }
 
 #if CAN_USE_SLEEP_MODE || defined(__DOXYGEN__)
@@ -324,11 +324,38 @@ typedef struct {
    */
   event_source_t            wakeup_event;
 #endif /* CAN_USE_SLEEP_MODE */
+#if CAN_USE_RX_QUEUES || defined(__DOXYGEN__)
+  /**
+   * @brief   Attached receive queues.
+   */
+  CANRxQueue                *rxqueues;
+  /**
+   * @brief   Frames lost because the hardware receive FIFOs were full.
+   */
+  uint32_t                  rxoverruns;
+  /**
+   * @brief   Frames discarded because not routed to any queue.
+   */
+  uint32_t                  rxunrouted;
+#endif /* CAN_USE_RX_QUEUES */
+#if CAN_USE_TX_QUEUE || defined(__DOXYGEN__)
+  /**
+   * @brief   Associated transmit queue or @p NULL.
+   */
+  CANTxQueue                *txq;
+#endif /* CAN_USE_TX_QUEUE */
   /* End of the mandatory fields.*/
   /**
    * @brief   Pointer to the CAN registers.
    */
   CAN_TypeDef               *can;
+  /**
+   * @brief   Value subtracted from the hardware filter match index.
+   * @note    It is non-zero for CAN2 when the filters are programmed using
+   *          @p canSetAcceptanceFilters(), the @p FMI field of the received
+   *          frames is then the index in the filters array.
+   */
+  uint8_t                   fmioffset;
 } CANDriver;
 
 /*===========================================================================*/
@@ -361,6 +388,9 @@ extern "C" {
   void can_lld_receive(CANDriver *canp,
                        canmbx_t mailbox,
                        CANRxFrame *ctfp);
+  void can_lld_set_acceptance_filters(CANDriver *canp,
+                                      const CANAcceptanceFilter *afp,
+                                      uint32_t num);
 #if CAN_USE_SLEEP_MODE
   void can_lld_sleep(CANDriver *canp);
   void can_lld_wakeup(CANDriver *canp);
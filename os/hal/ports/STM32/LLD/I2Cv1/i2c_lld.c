@@ -235,6 +235,29 @@ static void i2c_lld_set_opmode(I2CDriver *i2cp) {
   dp->CR1 = regCR1;
 }
 
+/**
+ * @brief   Resets and reprograms the I2C peripheral.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ *
+ * @notapi
+ */
+static void i2c_lld_setup(I2CDriver *i2cp) {
+  I2C_TypeDef *dp = i2cp->i2c;
+
+  /* Reset i2c peripheral.*/
+  dp->CR1 = I2C_CR1_SWRST;
+  dp->CR1 = 0;
+  dp->CR2 = I2C_CR2_ITERREN | I2C_CR2_DMAEN;
+
+  /* Setup I2C parameters.*/
+  i2c_lld_set_clock(i2cp);
+  i2c_lld_set_opmode(i2cp);
+
+  /* Ready to go.*/
+  dp->CR1 |= I2C_CR1_PE;
+}
+
 /**
  * @brief   I2C shared ISR code.
  *
@@ -632,17 +655,7 @@ void i2c_lld_start(I2CDriver *i2cp) {
   dmaStreamSetPeripheral(i2cp->dmarx, &dp->DR);
   dmaStreamSetPeripheral(i2cp->dmatx, &dp->DR);
 
-  /* Reset i2c peripheral.*/
-  dp->CR1 = I2C_CR1_SWRST;
-  dp->CR1 = 0;
-  dp->CR2 = I2C_CR2_ITERREN | I2C_CR2_DMAEN;
-
-  /* Setup I2C parameters.*/
-  i2c_lld_set_clock(i2cp);
-  i2c_lld_set_opmode(i2cp);
-
-  /* Ready to go.*/
-  dp->CR1 |= I2C_CR1_PE;
+  i2c_lld_setup(i2cp);
 }
 
 /**
@@ -850,6 +863,80 @@ msg_t i2c_lld_master_transmit_timeout(I2CDriver *i2cp, i2caddr_t addr,
   return osalThreadSuspendTimeoutS(&i2cp->thread, timeout);
 }
 
+#if I2C_USE_QUEUE || defined(__DOXYGEN__)
+/**
+ * @brief   Starts a transfer via the I2C bus as master.
+ * @details The transfer is a write if @p rxbytes is zero, a read if
+ *          @p txbytes is zero, else a write followed by a read after a
+ *          repeated start. The function does not wait, the end of the
+ *          transfer is notified using @p _i2c_wakeup_isr() or
+ *          @p _i2c_wakeup_error_isr().
+ * @note    This function is invoked from within a critical zone, also
+ *          from the ISR completing the previous transfer.
+ * @note    A busy bus is not an error, the START condition is generated
+ *          by the peripheral as soon as the bus is released.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] addr      slave device address
+ * @param[in] txbuf     pointer to the transmit buffer
+ * @param[in] txbytes   number of bytes to be transmitted
+ * @param[out] rxbuf    pointer to the receive buffer
+ * @param[in] rxbytes   number of bytes to be received
+ *
+ * @notapi
+ */
+void i2c_lld_start_transfer(I2CDriver *i2cp, i2caddr_t addr,
+                            const uint8_t *txbuf, size_t txbytes,
+                            uint8_t *rxbuf, size_t rxbytes) {
+  I2C_TypeDef *dp = i2cp->i2c;
+  uint32_t n;
+
+#if defined(STM32F1XX_I2C)
+  osalDbgCheck((rxbytes == 0) || (rxbytes > 1));
+#endif
+
+  /* CR1 must not be written while the STOP condition of the previous
+     transfer is pending, it takes about a bit time. Each iteration lasts
+     at least one PCLK1 cycle, after two bit times the peripheral is
+     assumed stuck and it is reset.*/
+  n = (STM32_PCLK1 / i2cp->config->clock_speed) * 2U;
+  while ((dp->CR1 & I2C_CR1_STOP) != 0U) {
+    if (--n == 0U) {
+      i2c_lld_abort_operation(i2cp);
+      i2c_lld_setup(i2cp);
+      break;
+    }
+  }
+
+  /* Resetting error flags for this transfer.*/
+  i2cp->errors = I2C_NO_ERROR;
+
+  /* TX DMA setup.*/
+  if (txbytes > 0U) {
+    dmaStreamSetMode(i2cp->dmatx, i2cp->txdmamode);
+    dmaStreamSetMemory0(i2cp->dmatx, txbuf);
+    dmaStreamSetTransactionSize(i2cp->dmatx, txbytes);
+  }
+
+  /* RX DMA setup, a zero size marks a write-only transfer for the BTF
+     event handler.*/
+  dmaStreamSetMode(i2cp->dmarx, i2cp->rxdmamode);
+  dmaStreamSetMemory0(i2cp->dmarx, rxbuf);
+  dmaStreamSetTransactionSize(i2cp->dmarx, rxbytes);
+
+  /* Starts the operation, LSB = 0 -> transmit, LSB = 1 -> receive.*/
+  dp->CR2 |= I2C_CR2_ITEVTEN;
+  if (txbytes > 0U) {
+    i2cp->addr = (addr << 1);
+    dp->CR1 |= I2C_CR1_START;
+  }
+  else {
+    i2cp->addr = (addr << 1) | 0x01;
+    dp->CR1 |= I2C_CR1_START | I2C_CR1_ACK;
+  }
+}
+#endif /* I2C_USE_QUEUE */
+
 #endif /* HAL_USE_I2C */
 
 /** @} */
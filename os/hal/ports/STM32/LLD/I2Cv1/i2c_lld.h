@@ -40,6 +40,11 @@
  */
 #define I2C_CLK_FREQ  ((STM32_PCLK1) / 1000000)
 
+/**
+ * @brief   This implementation supports the transactions queue.
+ */
+#define I2C_SUPPORTS_QUEUE  TRUE
+
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -424,6 +429,16 @@ struct I2CDriver {
    */
   mutex_t                   mutex;
 #endif /* I2C_USE_MUTUAL_EXCLUSION */
+#if I2C_USE_QUEUE || defined(__DOXYGEN__)
+  /**
+   * @brief   Transaction being executed, head of the queue.
+   */
+  I2CTransaction            *qhead;
+  /**
+   * @brief   Last queued transaction.
+   */
+  I2CTransaction            *qtail;
+#endif /* I2C_USE_QUEUE */
 #if defined(I2C_DRIVER_EXT_FIELDS)
   I2C_DRIVER_EXT_FIELDS
 #endif
@@ -502,6 +517,11 @@ extern "C" {
   msg_t i2c_lld_master_receive_timeout(I2CDriver *i2cp, i2caddr_t addr,
                                        uint8_t *rxbuf, size_t rxbytes,
                                        systime_t timeout);
+#if I2C_USE_QUEUE
+  void i2c_lld_start_transfer(I2CDriver *i2cp, i2caddr_t addr,
+                              const uint8_t *txbuf, size_t txbytes,
+                              uint8_t *rxbuf, size_t rxbytes);
+#endif
 #ifdef __cplusplus
 }
 #endif
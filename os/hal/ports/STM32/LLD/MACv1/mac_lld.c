@@ -169,6 +169,34 @@ static void mac_lld_set_address(const uint8_t *p) {
   ETH->MACHTLR   = 0;
 }
 
+#if MAC_USE_ZERO_COPY || defined(__DOXYGEN__)
+/**
+ * @brief   Invokes the callbacks of the transmitted frames.
+ * @details A frame made of attached buffers is done when its last
+ *          descriptor has been given back by the DMA.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[in] all       invokes all the pending callbacks, used when
+ *                      stopping the DMA
+ *
+ * @notapi
+ */
+static void mac_lld_serve_tx_callbacks(MACDriver *macp, bool all) {
+  unsigned i;
+
+  for (i = 0; i < STM32_MAC_TRANSMIT_BUFFERS; i++) {
+    if ((macp->txcb[i] != NULL) &&
+        (all || !(__eth_td[i].tdes0 & (STM32_TDES0_OWN |
+                                       STM32_TDES0_LOCKED)))) {
+      mactxcb_t cb = macp->txcb[i];
+
+      macp->txcb[i] = NULL;
+      cb(macp->txarg[i]);
+    }
+  }
+}
+#endif /* MAC_USE_ZERO_COPY */
+
 /*===========================================================================*/
 /* Driver interrupt handlers.                                                */
 /*===========================================================================*/
@@ -194,6 +222,9 @@ OSAL_IRQ_HANDLER(STM32_ETH_HANDLER) {
   if (dmasr & ETH_DMASR_TS) {
     /* Data Transmitted.*/
     osalSysLockFromISR();
+#if MAC_USE_ZERO_COPY
+    mac_lld_serve_tx_callbacks(&ETHD1, false);
+#endif
     osalThreadDequeueAllI(&ETHD1.tdqueue, MSG_RESET);
     osalSysUnlockFromISR();
   }
@@ -295,8 +326,12 @@ void mac_lld_start(MACDriver *macp) {
   for (i = 0; i < STM32_MAC_RECEIVE_BUFFERS; i++)
     __eth_rd[i].rdes0 = STM32_RDES0_OWN;
   macp->rxptr = (stm32_eth_rx_descriptor_t *)__eth_rd;
-  for (i = 0; i < STM32_MAC_TRANSMIT_BUFFERS; i++)
+  for (i = 0; i < STM32_MAC_TRANSMIT_BUFFERS; i++) {
     __eth_td[i].tdes0 = STM32_TDES0_TCH;
+#if MAC_USE_ZERO_COPY
+    macp->txcb[i] = NULL;
+#endif
+  }
   macp->txptr = (stm32_eth_tx_descriptor_t *)__eth_td;
 
   /* MAC clocks activation and commanded reset procedure.*/
@@ -383,6 +418,11 @@ void mac_lld_stop(MACDriver *macp) {
 
     /* ISR vector disabled.*/
     nvicDisableVector(STM32_ETH_NUMBER);
+
+#if MAC_USE_ZERO_COPY
+    /* Attached buffers are no more used by the DMA.*/
+    mac_lld_serve_tx_callbacks(macp, true);
+#endif
   }
 }
 
@@ -426,6 +466,13 @@ msg_t mac_lld_get_transmit_descriptor(MACDriver *macp,
 
   osalSysUnlock();
 
+#if MAC_USE_ZERO_COPY
+  /* The descriptor could still point to buffers attached to a previous
+     frame.*/
+  tdes->tdes2   = (uint32_t)__eth_tb[tdes - __eth_td];
+  tdp->lastdesc = NULL;
+#endif
+
   /* Set the buffer size and configuration.*/
   tdp->offset   = 0;
   tdp->size     = STM32_MAC_BUFFERS_SIZE;
@@ -449,11 +496,40 @@ void mac_lld_release_transmit_descriptor(MACTransmitDescriptor *tdp) {
 
   osalSysLock();
 
-  /* Unlocks the descriptor and returns it to the DMA engine.*/
-  tdp->physdesc->tdes1 = tdp->offset;
-  tdp->physdesc->tdes0 = STM32_TDES0_CIC(STM32_MAC_IP_CHECKSUM_OFFLOAD) |
-                         STM32_TDES0_IC | STM32_TDES0_LS | STM32_TDES0_FS |
-                         STM32_TDES0_TCH | STM32_TDES0_OWN;
+#if MAC_USE_ZERO_COPY
+  if (tdp->lastdesc != NULL) {
+    stm32_eth_tx_descriptor_t *tdes = tdp->physdesc;
+
+    /* The following descriptors are given to the DMA first, the frame
+       cannot start before the first one is given. The buffer sizes have
+       been set when the buffers were attached.*/
+    while (tdes != tdp->lastdesc) {
+      tdes = (stm32_eth_tx_descriptor_t *)tdes->tdes3;
+      tdes->tdes0 = STM32_TDES0_CIC(STM32_MAC_IP_CHECKSUM_OFFLOAD) |
+                    STM32_TDES0_TCH | STM32_TDES0_OWN;
+    }
+    tdes->tdes0 |= STM32_TDES0_IC | STM32_TDES0_LS;
+    if (tdes != tdp->physdesc) {
+      tdp->physdesc->tdes0 = STM32_TDES0_CIC(STM32_MAC_IP_CHECKSUM_OFFLOAD) |
+                             STM32_TDES0_FS | STM32_TDES0_TCH |
+                             STM32_TDES0_OWN;
+    }
+    else {
+      tdp->physdesc->tdes0 = STM32_TDES0_CIC(STM32_MAC_IP_CHECKSUM_OFFLOAD) |
+                             STM32_TDES0_IC | STM32_TDES0_LS |
+                             STM32_TDES0_FS | STM32_TDES0_TCH |
+                             STM32_TDES0_OWN;
+    }
+  }
+  else
+#endif
+  {
+    /* Unlocks the descriptor and returns it to the DMA engine.*/
+    tdp->physdesc->tdes1 = tdp->offset;
+    tdp->physdesc->tdes0 = STM32_TDES0_CIC(STM32_MAC_IP_CHECKSUM_OFFLOAD) |
+                           STM32_TDES0_IC | STM32_TDES0_LS | STM32_TDES0_FS |
+                           STM32_TDES0_TCH | STM32_TDES0_OWN;
+  }
 
   /* If the DMA engine is stalled then a restart request is issued.*/
   if ((ETH->DMASR & ETH_DMASR_TPS) == ETH_DMASR_TPS_Suspended) {
@@ -487,6 +563,10 @@ msg_t mac_lld_get_receive_descriptor(MACDriver *macp,
   /* Iterates through received frames until a valid one is found, invalid
      frames are discarded.*/
   while (!(rdes->rdes0 & STM32_RDES0_OWN)) {
+    /* A descriptor still held by the upper layer stops the scan, the DMA
+       cannot have gone past it.*/
+    if (rdes->rdes1 & STM32_RDES1_LOCKED)
+      break;
     if (!(rdes->rdes0 & (STM32_RDES0_AFM | STM32_RDES0_ES))
 #if STM32_MAC_IP_CHECKSUM_OFFLOAD
         && (rdes->rdes0 & STM32_RDES0_FT)
@@ -499,6 +579,9 @@ msg_t mac_lld_get_receive_descriptor(MACDriver *macp,
       rdp->physdesc = rdes;
       macp->rxptr   = (stm32_eth_rx_descriptor_t *)rdes->rdes3;
 
+      /* Marked as in use until released.*/
+      rdes->rdes1 |= STM32_RDES1_LOCKED;
+
       osalSysUnlock();
       return MSG_OK;
     }
@@ -531,6 +614,7 @@ void mac_lld_release_receive_descriptor(MACReceiveDescriptor *rdp) {
   osalSysLock();
 
   /* Give buffer back to the Ethernet DMA.*/
+  rdp->physdesc->rdes1 &= ~STM32_RDES1_LOCKED;
   rdp->physdesc->rdes0 = STM32_RDES0_OWN;
 
   /* If the DMA engine is stalled then a restart request is issued.*/
@@ -733,6 +817,86 @@ const uint8_t *mac_lld_get_next_receive_buffer(MACReceiveDescriptor *rdp,
   *sizep = 0;
   return NULL;
 }
+
+/**
+ * @brief   Attaches a list of buffers to a transmit descriptor.
+ * @details Each buffer takes a physical descriptor, the descriptors
+ *          following the one already obtained are reserved in the chain.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[in] tdp       pointer to a @p MACTransmitDescriptor structure
+ * @param[in] bp        pointer to an array of @p macbuffer_t structures
+ * @param[in] n         number of buffers
+ * @param[in] cb        callback invoked when the MAC is done with the
+ *                      buffers, it can be @p NULL
+ * @param[in] arg       parameter passed to the callback
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the buffers have been attached.
+ * @retval HAL_FAILED   the buffers cannot be attached.
+ *
+ * @notapi
+ */
+bool mac_lld_attach_transmit_buffers(MACDriver *macp,
+                                     MACTransmitDescriptor *tdp,
+                                     const macbuffer_t *bp, unsigned n,
+                                     mactxcb_t cb, void *arg) {
+  stm32_eth_tx_descriptor_t *tdes;
+  size_t size;
+  unsigned i;
+
+  osalDbgAssert(tdp->offset == 0, "descriptor not empty");
+
+  if ((n == 0) || (n > STM32_MAC_TRANSMIT_BUFFERS))
+    return HAL_FAILED;
+  size = 0;
+  for (i = 0; i < n; i++)
+    size += bp[i].size;
+  if (size > tdp->size)
+    return HAL_FAILED;
+
+  osalSysLock();
+
+  /* The following descriptors must not have been obtained by another
+     frame and must be free.*/
+  tdes = tdp->physdesc;
+  if ((n > 1) && (macp->txptr != (stm32_eth_tx_descriptor_t *)tdes->tdes3)) {
+    osalSysUnlock();
+    return HAL_FAILED;
+  }
+  for (i = 1; i < n; i++) {
+    tdes = (stm32_eth_tx_descriptor_t *)tdes->tdes3;
+    if (tdes->tdes0 & (STM32_TDES0_OWN | STM32_TDES0_LOCKED)) {
+      osalSysUnlock();
+      return HAL_FAILED;
+    }
+  }
+
+  /* Reserving the descriptors.*/
+  tdes = tdp->physdesc;
+  for (i = 1; i < n; i++) {
+    tdes = (stm32_eth_tx_descriptor_t *)tdes->tdes3;
+    tdes->tdes0 = STM32_TDES0_TCH | STM32_TDES0_LOCKED;
+  }
+  macp->txptr = (stm32_eth_tx_descriptor_t *)tdes->tdes3;
+  macp->txcb[tdes - __eth_td]  = cb;
+  macp->txarg[tdes - __eth_td] = arg;
+  tdp->lastdesc = tdes;
+
+  osalSysUnlock();
+
+  /* Buffers linked to the descriptors.*/
+  tdes = tdp->physdesc;
+  for (i = 0; i < n; i++) {
+    tdes->tdes1 = (uint32_t)bp[i].size;
+    tdes->tdes2 = (uint32_t)bp[i].buf;
+    tdes = (stm32_eth_tx_descriptor_t *)tdes->tdes3;
+  }
+
+  /* Nothing more can be written into the frame.*/
+  tdp->offset = size;
+  tdp->size   = size;
+  return HAL_SUCCESS;
+}
 #endif /* MAC_USE_ZERO_COPY */
 
 #endif /* HAL_USE_MAC */
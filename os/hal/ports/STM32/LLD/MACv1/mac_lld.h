@@ -66,6 +66,7 @@
  * @{
  */
 #define STM32_RDES1_DIC             0x80000000
+#define STM32_RDES1_LOCKED          0x20000000 /* NOTE: Pseudo flag.        */
 #define STM32_RDES1_RBS2_MASK       0x1FFF0000
 #define STM32_RDES1_RER             0x00008000
 #define STM32_RDES1_RCH             0x00004000
@@ -272,6 +273,17 @@ struct MACDriver {
    * @brief Transmit next frame pointer.
    */
   stm32_eth_tx_descriptor_t *txptr;
+#if MAC_USE_ZERO_COPY || defined(__DOXYGEN__)
+  /**
+   * @brief Completion callbacks of the frames made of attached buffers,
+   *        indexed by the last physical descriptor of the frame.
+   */
+  mactxcb_t                 txcb[STM32_MAC_TRANSMIT_BUFFERS];
+  /**
+   * @brief Completion callbacks parameters.
+   */
+  void                      *txarg[STM32_MAC_TRANSMIT_BUFFERS];
+#endif
 };
 
 /**
@@ -291,6 +303,13 @@ typedef struct {
    * @brief Pointer to the physical descriptor.
    */
   stm32_eth_tx_descriptor_t *physdesc;
+#if MAC_USE_ZERO_COPY || defined(__DOXYGEN__)
+  /**
+   * @brief Last physical descriptor of a frame made of attached buffers,
+   *        @p NULL if the frame data is in the descriptor buffer.
+   */
+  stm32_eth_tx_descriptor_t *lastdesc;
+#endif
 } MACTransmitDescriptor;
 
 /**
@@ -351,6 +370,10 @@ extern "C" {
                                             size_t *sizep);
   const uint8_t *mac_lld_get_next_receive_buffer(MACReceiveDescriptor *rdp,
                                                  size_t *sizep);
+  bool mac_lld_attach_transmit_buffers(MACDriver *macp,
+                                       MACTransmitDescriptor *tdp,
+                                       const macbuffer_t *bp, unsigned n,
+                                       mactxcb_t cb, void *arg);
 #endif /* MAC_USE_ZERO_COPY */
 #ifdef __cplusplus
 }
@@ -51,10 +51,17 @@
 /**
  * @brief   Support for unaligned transfers.
  * @note    Unaligned transfers are much slower.
+ * @note    Not required when the high level driver performs unaligned
+ *          transfers through its own bounce buffer, see
+ *          @p SDC_UNALIGNED_BOUNCE_BLOCKS.
  */
 #if !defined(STM32_SDC_SDMMC_UNALIGNED_SUPPORT) || defined(__DOXYGEN__)
+#if SDC_UNALIGNED_BOUNCE_BLOCKS > 0
+#define STM32_SDC_SDMMC_UNALIGNED_SUPPORT   FALSE
+#else
 #define STM32_SDC_SDMMC_UNALIGNED_SUPPORT   TRUE
 #endif
+#endif
 
 /**
  * @brief   Write timeout in milliseconds.
@@ -206,6 +213,12 @@ struct SDCDriver {
    * @brief Card RCA.
    */
   uint32_t                  rca;
+#if (SDC_USE_ASYNC == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief Asynchronous requests queue.
+   */
+  BlockIOQueue              queue;
+#endif
   /* End of the mandatory fields.*/
   /**
    * @brief Thread waiting for I/O completion IRQ.
@@ -460,6 +460,20 @@ struct SPIDriver {
    */
   mutex_t                   mutex;
 #endif /* SPI_USE_MUTUAL_EXCLUSION */
+#if SPI_USE_QUEUE || defined(__DOXYGEN__)
+  /**
+   * @brief Transaction being executed, head of the queue.
+   */
+  SPITransaction            *qhead;
+  /**
+   * @brief Last queued transaction.
+   */
+  SPITransaction            *qtail;
+  /**
+   * @brief Index of the transfer being executed.
+   */
+  size_t                    qstep;
+#endif /* SPI_USE_QUEUE */
 #if defined(SPI_DRIVER_EXT_FIELDS)
   SPI_DRIVER_EXT_FIELDS
 #endif
@@ -490,6 +504,17 @@ struct SPIDriver {
 /* Driver macros.                                                            */
 /*===========================================================================*/
 
+/**
+ * @brief   Compares the peripheral setup of two configurations.
+ * @details The peripheral setup is entirely described by the @p cr1 field.
+ *
+ * @param[in] cfg1      pointer to the first @p SPIConfig object
+ * @param[in] cfg2      pointer to the second @p SPIConfig object
+ *
+ * @notapi
+ */
+#define spi_lld_same_setup(cfg1, cfg2) ((cfg1)->cr1 == (cfg2)->cr1)
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -249,7 +249,12 @@ static void uart_lld_serve_rx_end_irq(UARTDriver *uartp, uint32_t flags) {
   (void)flags;
 #endif
 
-  if (uartp->rxstate == UART_RX_IDLE) {
+  if (_uart_rx_frame_running(uartp)) {
+    /* Framed receive, the circular buffer is scanned at the half and full
+       marks, the DMA keeps running.*/
+    _uart_rx_frame_isr(uartp, false);
+  }
+  else if (uartp->rxstate == UART_RX_IDLE) {
     /* Receiver in idle state, a callback is generated, if enabled, for each
        received character and then the driver stays in the same state.*/
     _uart_rx_idle_code(uartp);
@@ -304,6 +309,12 @@ static void serve_usart_irq(UARTDriver *uartp) {
     _uart_rx_error_isr_code(uartp, translate_errors(sr));
   }
 
+  if ((sr & USART_SR_IDLE) && (cr1 & USART_CR1_IDLEIE)) {
+    /* Idle line after a reception, the flag has already been cleared by
+       the SR/DR read sequence.*/
+    _uart_rx_frame_isr(uartp, true);
+  }
+
   if ((sr & USART_SR_TC) && (cr1 & USART_CR1_TCIE)) {
     /* TC interrupt cleared and disabled.*/
     u->SR = ~USART_SR_TC;
@@ -806,6 +817,69 @@ size_t uart_lld_stop_receive(UARTDriver *uartp) {
   return n;
 }
 
+#if (UART_USE_FRAMES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Starts a continuous receive operation into a circular buffer.
+ * @note    The delimiter is searched by the high level driver, the USARTv1
+ *          peripheral has no character match capability.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @param[in] n         size of the circular buffer
+ * @param[out] ring     pointer to the circular buffer
+ *
+ * @notapi
+ */
+void uart_lld_start_ring(UARTDriver *uartp, size_t n, uint8_t *ring) {
+  USART_TypeDef *u = uartp->usart;
+
+  /* Stopping previous activity (idle state).*/
+  dmaStreamDisable(uartp->dmarx);
+
+  /* RX DMA channel preparation, circular with half and full interrupts.*/
+  dmaStreamSetMemory0(uartp->dmarx, ring);
+  dmaStreamSetTransactionSize(uartp->dmarx, n);
+  dmaStreamSetMode(uartp->dmarx, uartp->dmamode    | STM32_DMA_CR_DIR_P2M |
+                                 STM32_DMA_CR_MINC | STM32_DMA_CR_CIRC    |
+                                 STM32_DMA_CR_HTIE | STM32_DMA_CR_TCIE);
+
+  /* Clearing a stale idle condition then enabling its interrupt.*/
+  (void)u->SR;
+  (void)u->DR;
+  u->CR1 |= USART_CR1_IDLEIE;
+
+  /* Starting transfer.*/
+  dmaStreamEnable(uartp->dmarx);
+}
+
+/**
+ * @brief   Stops the continuous receive operation.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ *
+ * @notapi
+ */
+void uart_lld_stop_ring(UARTDriver *uartp) {
+
+  dmaStreamDisable(uartp->dmarx);
+  uartp->usart->CR1 &= ~USART_CR1_IDLEIE;
+  uart_enter_rx_idle_loop(uartp);
+}
+
+/**
+ * @brief   Returns the space left before the end of the circular buffer.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @return              The number of bytes to be received before the
+ *                      circular buffer wraps.
+ *
+ * @notapi
+ */
+size_t uart_lld_get_ring_remaining(UARTDriver *uartp) {
+
+  return dmaStreamGetTransactionSize(uartp->dmarx);
+}
+#endif /* UART_USE_FRAMES == TRUE */
+
 #endif /* HAL_USE_UART */
 
 /** @} */
@@ -0,0 +1,206 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    adc_lld.c
+ * @brief   Simulator low level ADC driver code.
+ * @details The simulated ADC converts one half of a circular buffer, or
+ *          a whole linear buffer, at each simulated interrupt. The samples
+ *          are produced by a signal source function specified in the
+ *          driver configuration.
+ *
+ * @addtogroup ADC
+ * @{
+ */
+
+#include "hal.h"
+
+#if HAL_USE_ADC || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Simulated ADC driver 1.
+ */
+#if USE_SIM_ADC1 || defined(__DOXYGEN__)
+ADCDriver ADCD1;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Default signal source, a ramp on each channel.
+ *
+ * @param[in] channel   channel index within the conversion group
+ * @param[in] n         index of the conversion since the start
+ * @return              The sample value.
+ */
+static adcsample_t adc_lld_ramp(adc_channels_num_t channel, uint32_t n) {
+
+  return (adcsample_t)((n + channel) & SIM_ADC_MAX_SAMPLE);
+}
+
+/**
+ * @brief   Converts a number of rows.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ * @param[out] buf      pointer to the first row
+ * @param[in] n         number of rows
+ */
+static void adc_lld_convert(ADCDriver *adcp, adcsample_t *buf, size_t n) {
+  adcsource_t source = adcp->config->source;
+  adc_channels_num_t ch;
+
+  if (source == NULL) {
+    source = adc_lld_ramp;
+  }
+  while (n > 0U) {
+    for (ch = 0U; ch < adcp->grpp->num_channels; ch++) {
+      *buf++ = source(ch, adcp->conversions);
+    }
+    adcp->conversions++;
+    n--;
+  }
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Simulated DMA interrupt.
+ * @details The next part of the buffer of an active conversion is filled
+ *          and the callbacks are invoked like the DMA interrupt of a real
+ *          ADC would do.
+ *
+ * @return              The interrupt status.
+ * @retval false        no conversions are active.
+ * @retval true         samples have been converted.
+ *
+ * @notapi
+ */
+bool adc_lld_interrupt_pending(void) {
+  ADCDriver *adcp = &ADCD1;
+  size_t half;
+
+  if (adcp->state != ADC_ACTIVE) {
+    return false;
+  }
+
+  OSAL_IRQ_PROLOGUE();
+
+  if (!adcp->grpp->circular || (adcp->depth < 2U)) {
+    adc_lld_convert(adcp, adcp->samples, adcp->depth);
+    _adc_isr_full_code(adcp);
+  }
+  else {
+    half = adcp->depth / 2U;
+    if (adcp->half == 0U) {
+      adc_lld_convert(adcp, adcp->samples, half);
+      adcp->half = 1U;
+      _adc_isr_half_code(adcp);
+    }
+    else {
+      adc_lld_convert(adcp,
+                      adcp->samples + (half * adcp->grpp->num_channels),
+                      half);
+      adcp->half = 0U;
+      _adc_isr_full_code(adcp);
+    }
+  }
+
+  OSAL_IRQ_EPILOGUE();
+
+  return true;
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level ADC driver initialization.
+ *
+ * @notapi
+ */
+void adc_lld_init(void) {
+
+  adcObjectInit(&ADCD1);
+}
+
+/**
+ * @brief   Configures and activates the ADC peripheral.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ *
+ * @notapi
+ */
+void adc_lld_start(ADCDriver *adcp) {
+
+  adcp->conversions = 0U;
+}
+
+/**
+ * @brief   Deactivates the ADC peripheral.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ *
+ * @notapi
+ */
+void adc_lld_stop(ADCDriver *adcp) {
+
+  (void)adcp;
+}
+
+/**
+ * @brief   Starts an ADC conversion.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ *
+ * @notapi
+ */
+void adc_lld_start_conversion(ADCDriver *adcp) {
+
+  adcp->half = 0U;
+}
+
+/**
+ * @brief   Stops an ongoing conversion.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ *
+ * @notapi
+ */
+void adc_lld_stop_conversion(ADCDriver *adcp) {
+
+  (void)adcp;
+}
+
+#endif /* HAL_USE_ADC */
+
+/** @} */
@@ -0,0 +1,447 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    can_lld.c
+ * @brief   Simulator low level CAN driver code.
+ * @details The simulated bus is an in-process connection between all the
+ *          started drivers, frames in the transmit mailboxes are put on
+ *          the bus by the simulated interrupt and delivered to the other
+ *          drivers and, in loopback mode, to the transmitting driver
+ *          itself. Pending frames are arbitrated by identifier like on a
+ *          real bus. Each driver has a small receive FIFO that loses frames
+ *          when full, like on a real controller.
+ *
+ * @addtogroup CAN
+ * @{
+ */
+
+#include "hal.h"
+
+#if HAL_USE_CAN || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Simulated CAN driver 1.
+ */
+#if USE_SIM_CAN1 || defined(__DOXYGEN__)
+CANDriver CAND1;
+#endif
+
+/**
+ * @brief   Simulated CAN driver 2.
+ */
+#if USE_SIM_CAN2 || defined(__DOXYGEN__)
+CANDriver CAND2;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Drivers connected to the simulated bus.
+ */
+static CANDriver * const bus[] = {
+#if USE_SIM_CAN1
+  &CAND1,
+#endif
+#if USE_SIM_CAN2
+  &CAND2,
+#endif
+};
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Applies the acceptance filters to a frame.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in,out] crfp  pointer to the frame, the @p FMI field is set
+ * @return              The filtering result.
+ * @retval false        if the frame has been accepted.
+ * @retval true         if the frame has been rejected.
+ *
+ * @notapi
+ */
+static bool can_lld_filter(CANDriver *canp, CANRxFrame *crfp) {
+  uint32_t i, id;
+
+  if (canp->nfilters == 0U) {
+    crfp->FMI = 0U;
+    return false;
+  }
+
+  id = crfp->IDE ? crfp->EID : crfp->SID;
+  for (i = 0U; i < canp->nfilters; i++) {
+    const CANAcceptanceFilter *afp = &canp->filters[i];
+
+    if ((afp->ide == crfp->IDE) && (((afp->id ^ id) & afp->mask) == 0U)) {
+      crfp->FMI = (uint8_t)i;
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief   Delivers a frame to a driver connected to the simulated bus.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] crfp      pointer to the frame
+ *
+ * @notapi
+ */
+static void can_lld_deliver_i(CANDriver *canp, CANRxFrame *crfp) {
+
+  if (can_lld_filter(canp, crfp)) {
+    return;
+  }
+  canp->rxframes++;
+
+  /* A sleeping controller is woken up by the bus activity.*/
+#if CAN_USE_SLEEP_MODE
+  if (canp->state == CAN_SLEEP) {
+    canp->state = CAN_READY;
+#if CAN_USE_TX_QUEUE
+    _can_tx_refill_i(canp);
+#endif
+    osalEventBroadcastFlagsI(&canp->wakeup_event, 0);
+  }
+#endif
+
+#if CAN_USE_RX_QUEUES
+  /* With queues attached the simulated ISR drains the FIFO immediately.*/
+  if (canp->rxqueues != NULL) {
+    _can_rx_enqueue_i(canp, crfp);
+    osalEventBroadcastFlagsI(&canp->rxfull_event, CAN_MAILBOX_TO_MASK(1U));
+    return;
+  }
+#endif
+
+  if (canp->rxcnt >= SIM_CAN_RX_FIFO_DEPTH) {
+#if CAN_USE_RX_QUEUES
+    canp->rxoverruns++;
+#endif
+    osalEventBroadcastFlagsI(&canp->error_event, CAN_OVERFLOW_ERROR);
+    return;
+  }
+  canp->rxfifo[(canp->rxrdidx + canp->rxcnt) % SIM_CAN_RX_FIFO_DEPTH] = *crfp;
+  canp->rxcnt++;
+
+  osalThreadDequeueAllI(&canp->rxqueue, MSG_OK);
+  osalEventBroadcastFlagsI(&canp->rxfull_event, CAN_MAILBOX_TO_MASK(1U));
+}
+
+/**
+ * @brief   Puts a frame from a transmit mailbox on the simulated bus.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] mailbox   mailbox number
+ *
+ * @notapi
+ */
+static void can_lld_bus_i(CANDriver *canp, canmbx_t mailbox) {
+  const CANTxFrame *ctfp = &canp->txmb[mailbox - 1U];
+  CANRxFrame rxf;
+  unsigned i;
+
+  rxf.TIME = 0U;
+  rxf.DLC  = ctfp->DLC;
+  rxf.RTR  = ctfp->RTR;
+  rxf.IDE  = ctfp->IDE;
+  if (ctfp->IDE) {
+    rxf.EID = ctfp->EID;
+  }
+  else {
+    rxf.SID = ctfp->SID;
+  }
+  rxf.data32[0] = ctfp->data32[0];
+  rxf.data32[1] = ctfp->data32[1];
+  canp->txpending &= ~CAN_MAILBOX_TO_MASK(mailbox);
+  canp->txframes++;
+
+  for (i = 0U; i < sizeof bus / sizeof bus[0]; i++) {
+    CANDriver *rxcanp = bus[i];
+
+    if (((rxcanp != canp) || canp->config->loopback) &&
+        ((rxcanp->state == CAN_READY) || (rxcanp->state == CAN_SLEEP))) {
+      can_lld_deliver_i(rxcanp, &rxf);
+    }
+  }
+
+  /* Simulated transmit interrupt.*/
+#if CAN_USE_TX_QUEUE
+  if (canp->state == CAN_READY) {
+    _can_tx_refill_i(canp);
+  }
+#endif
+  osalThreadDequeueAllI(&canp->txqueue, MSG_OK);
+  osalEventBroadcastFlagsI(&canp->txempty_event,
+                           CAN_MAILBOX_TO_MASK(mailbox));
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Simulated bus interrupt.
+ * @details All the frames pending in the transmit mailboxes are put on
+ *          the bus, one at time in arbitration order.
+ *
+ * @return              The interrupt status.
+ * @retval false        no frames were pending.
+ * @retval true         at least a frame has been transferred.
+ *
+ * @notapi
+ */
+bool can_lld_interrupt_pending(void) {
+  bool b = false;
+  unsigned i;
+  canmbx_t mailbox, winmbx;
+  CANDriver *wincanp;
+  uint32_t key, winkey;
+
+  OSAL_IRQ_PROLOGUE();
+
+  osalSysLockFromISR();
+  do {
+    /* Arbitration, the lowest key among all the pending frames wins.*/
+    wincanp = NULL;
+    winmbx  = 0U;
+    winkey  = 0U;
+    for (i = 0U; i < sizeof bus / sizeof bus[0]; i++) {
+      CANDriver *canp = bus[i];
+
+      for (mailbox = 1U; mailbox <= CAN_TX_MAILBOXES; mailbox++) {
+        if ((canp->txpending & CAN_MAILBOX_TO_MASK(mailbox)) != 0U) {
+          key = _can_arbitration_key(&canp->txmb[mailbox - 1U]);
+          if ((wincanp == NULL) || (key < winkey)) {
+            wincanp = canp;
+            winmbx  = mailbox;
+            winkey  = key;
+          }
+        }
+      }
+    }
+    if (wincanp != NULL) {
+      can_lld_bus_i(wincanp, winmbx);
+      b = true;
+    }
+  } while (wincanp != NULL);
+  osalSysUnlockFromISR();
+
+  OSAL_IRQ_EPILOGUE();
+
+  return b;
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level CAN driver initialization.
+ *
+ * @notapi
+ */
+void can_lld_init(void) {
+
+#if USE_SIM_CAN1
+  canObjectInit(&CAND1);
+  CAND1.nfilters = 0U;
+#endif
+#if USE_SIM_CAN2
+  canObjectInit(&CAND2);
+  CAND2.nfilters = 0U;
+#endif
+}
+
+/**
+ * @brief   Configures and activates the CAN peripheral.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ *
+ * @notapi
+ */
+void can_lld_start(CANDriver *canp) {
+
+  canp->txpending = 0U;
+  canp->rxrdidx   = 0U;
+  canp->rxcnt     = 0U;
+  canp->txframes  = 0U;
+  canp->rxframes  = 0U;
+}
+
+/**
+ * @brief   Deactivates the CAN peripheral.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ *
+ * @notapi
+ */
+void can_lld_stop(CANDriver *canp) {
+
+  /* Pending frames are lost.*/
+  canp->txpending = 0U;
+  canp->rxcnt     = 0U;
+}
+
+/**
+ * @brief   Determines whether a frame can be transmitted.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] mailbox   mailbox number, @p CAN_ANY_MAILBOX for any mailbox
+ *
+ * @return              The queue space availability.
+ * @retval false        no space in the transmit queue.
+ * @retval true         transmit slot available.
+ *
+ * @notapi
+ */
+bool can_lld_is_tx_empty(CANDriver *canp, canmbx_t mailbox) {
+  uint32_t all = CAN_MAILBOX_TO_MASK(CAN_TX_MAILBOXES + 1U) - 1U;
+
+  if (mailbox == CAN_ANY_MAILBOX) {
+    return (canp->txpending & all) != all;
+  }
+  return (canp->txpending & CAN_MAILBOX_TO_MASK(mailbox)) == 0U;
+}
+
+/**
+ * @brief   Inserts a frame into the transmit queue.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] ctfp      pointer to the CAN frame to be transmitted
+ * @param[in] mailbox   mailbox number,  @p CAN_ANY_MAILBOX for any mailbox
+ *
+ * @notapi
+ */
+void can_lld_transmit(CANDriver *canp,
+                      canmbx_t mailbox,
+                      const CANTxFrame *ctfp) {
+
+  if (mailbox == CAN_ANY_MAILBOX) {
+    mailbox = 1U;
+    while ((canp->txpending & CAN_MAILBOX_TO_MASK(mailbox)) != 0U) {
+      mailbox++;
+    }
+  }
+  canp->txmb[mailbox - 1U] = *ctfp;
+  canp->txpending |= CAN_MAILBOX_TO_MASK(mailbox);
+}
+
+/**
+ * @brief   Determines whether a frame has been received.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] mailbox   mailbox number, @p CAN_ANY_MAILBOX for any mailbox
+ *
+ * @return              The queue status.
+ * @retval false        the receive FIFO is empty.
+ * @retval true         a frame is available.
+ *
+ * @notapi
+ */
+bool can_lld_is_rx_nonempty(CANDriver *canp, canmbx_t mailbox) {
+
+  (void)mailbox;
+
+  return canp->rxcnt > 0U;
+}
+
+/**
+ * @brief   Receives a frame from the input queue.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] mailbox   mailbox number, @p CAN_ANY_MAILBOX for any mailbox
+ * @param[out] crfp     pointer to the buffer where the CAN frame is copied
+ *
+ * @notapi
+ */
+void can_lld_receive(CANDriver *canp,
+                     canmbx_t mailbox,
+                     CANRxFrame *crfp) {
+
+  (void)mailbox;
+
+  *crfp = canp->rxfifo[canp->rxrdidx];
+  canp->rxrdidx = (canp->rxrdidx + 1U) % SIM_CAN_RX_FIFO_DEPTH;
+  canp->rxcnt--;
+}
+
+/**
+ * @brief   Programs the acceptance filters.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] afp       pointer to the filters array
+ * @param[in] num       number of entries in the filters array, if zero then
+ *                      all frames are accepted
+ *
+ * @notapi
+ */
+void can_lld_set_acceptance_filters(CANDriver *canp,
+                                    const CANAcceptanceFilter *afp,
+                                    uint32_t num) {
+  uint32_t i;
+
+  osalDbgAssert(num <= SIM_CAN_MAX_FILTERS, "too many filters");
+
+  for (i = 0U; i < num; i++) {
+    canp->filters[i] = afp[i];
+  }
+  canp->nfilters = num;
+}
+
+#if CAN_USE_SLEEP_MODE || defined(__DOXYGEN__)
+/**
+ * @brief   Enters the sleep mode.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ *
+ * @notapi
+ */
+void can_lld_sleep(CANDriver *canp) {
+
+  (void)canp;
+}
+
+/**
+ * @brief   Enforces leaving the sleep mode.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ *
+ * @notapi
+ */
+void can_lld_wakeup(CANDriver *canp) {
+
+  (void)canp;
+}
+#endif /* CAN_USE_SLEEP_MODE */
+
+#endif /* HAL_USE_CAN */
+
+/** @} */
@@ -0,0 +1,324 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    can_lld.h
+ * @brief   Simulator low level CAN driver header.
+ *
+ * @addtogroup CAN
+ * @{
+ */
+
+#ifndef _CAN_LLD_H_
+#define _CAN_LLD_H_
+
+#if HAL_USE_CAN || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   This switch defines whether the driver implementation supports
+ *          a low power switch mode with automatic an wakeup feature.
+ */
+#define CAN_SUPPORTS_SLEEP          TRUE
+
+/**
+ * @brief   Number of transmit mailboxes.
+ */
+#define CAN_TX_MAILBOXES            3
+
+/**
+ * @brief   Number of receive mailboxes.
+ */
+#define CAN_RX_MAILBOXES            1
+
+/**
+ * @name    Frame fields values
+ * @{
+ */
+#define CAN_IDE_STD                 0           /**< @brief Standard id.    */
+#define CAN_IDE_EXT                 1           /**< @brief Extended id.    */
+
+#define CAN_RTR_DATA                0           /**< @brief Data frame.     */
+#define CAN_RTR_REMOTE              1           /**< @brief Remote frame.   */
+/** @} */
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Configuration options
+ * @{
+ */
+/**
+ * @brief   CAND1 driver enable switch.
+ * @details If set to @p TRUE the support for CAND1 is included.
+ * @note    The default is @p TRUE.
+ */
+#if !defined(USE_SIM_CAN1) || defined(__DOXYGEN__)
+#define USE_SIM_CAN1                        TRUE
+#endif
+
+/**
+ * @brief   CAND2 driver enable switch.
+ * @details If set to @p TRUE the support for CAND2 is included.
+ * @note    The default is @p TRUE.
+ */
+#if !defined(USE_SIM_CAN2) || defined(__DOXYGEN__)
+#define USE_SIM_CAN2                        TRUE
+#endif
+
+/**
+ * @brief   Depth of the simulated receive FIFO.
+ */
+#if !defined(SIM_CAN_RX_FIFO_DEPTH) || defined(__DOXYGEN__)
+#define SIM_CAN_RX_FIFO_DEPTH               3
+#endif
+
+/**
+ * @brief   Number of acceptance filters of each driver.
+ */
+#if !defined(SIM_CAN_MAX_FILTERS) || defined(__DOXYGEN__)
+#define SIM_CAN_MAX_FILTERS                 14
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if !USE_SIM_CAN1 && !USE_SIM_CAN2
+#error "CAN driver activated but no CAN peripheral assigned"
+#endif
+
+#if SIM_CAN_RX_FIFO_DEPTH < 1
+#error "invalid SIM_CAN_RX_FIFO_DEPTH value"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a transmission mailbox index.
+ */
+typedef uint32_t canmbx_t;
+
+/**
+ * @brief   CAN transmission frame.
+ * @note    Accessing the frame data as word16 or word32 is not portable because
+ *          machine data endianness, it can be still useful for a quick filling.
+ */
+typedef struct {
+  uint8_t                   DLC:4;          /**< @brief Data length.        */
+  uint8_t                   RTR:1;          /**< @brief Frame type.         */
+  uint8_t                   IDE:1;          /**< @brief Identifier type.    */
+  union {
+    uint32_t                SID:11;         /**< @brief Standard identifier.*/
+    uint32_t                EID:29;         /**< @brief Extended identifier.*/
+    uint32_t                _align1;
+  };
+  union {
+    uint8_t                 data8[8];       /**< @brief Frame data.         */
+    uint16_t                data16[4];      /**< @brief Frame data.         */
+    uint32_t                data32[2];      /**< @brief Frame data.         */
+  };
+} CANTxFrame;
+
+/**
+ * @brief   CAN received frame.
+ * @note    Accessing the frame data as word16 or word32 is not portable because
+ *          machine data endianness, it can be still useful for a quick filling.
+ */
+typedef struct {
+  uint8_t                   FMI;            /**< @brief Filter id.          */
+  uint16_t                  TIME;           /**< @brief Time stamp.         */
+  uint8_t                   DLC:4;          /**< @brief Data length.        */
+  uint8_t                   RTR:1;          /**< @brief Frame type.         */
+  uint8_t                   IDE:1;          /**< @brief Identifier type.    */
+  union {
+    uint32_t                SID:11;         /**< @brief Standard identifier.*/
+    uint32_t                EID:29;         /**< @brief Extended identifier.*/
+    uint32_t                _align1;
+  };
+  union {
+    uint8_t                 data8[8];       /**< @brief Frame data.         */
+    uint16_t                data16[4];      /**< @brief Frame data.         */
+    uint32_t                data32[2];      /**< @brief Frame data.         */
+  };
+} CANRxFrame;
+
+/**
+ * @brief   Driver configuration structure.
+ */
+typedef struct {
+  /**
+   * @brief   Frames transmitted by the driver are received back.
+   */
+  bool                      loopback;
+} CANConfig;
+
+/**
+ * @brief   Structure representing an CAN driver.
+ */
+typedef struct {
+  /**
+   * @brief   Driver state.
+   */
+  canstate_t                state;
+  /**
+   * @brief   Current configuration data.
+   */
+  const CANConfig           *config;
+  /**
+   * @brief   Transmission threads queue.
+   */
+  threads_queue_t           txqueue;
+  /**
+   * @brief   Receive threads queue.
+   */
+  threads_queue_t           rxqueue;
+  /**
+   * @brief   One or more frames become available.
+   */
+  event_source_t            rxfull_event;
+  /**
+   * @brief   One or more transmission mailbox become available.
+   */
+  event_source_t            txempty_event;
+  /**
+   * @brief   A CAN bus error happened.
+   */
+  event_source_t            error_event;
+#if CAN_USE_SLEEP_MODE || defined (__DOXYGEN__)
+  /**
+   * @brief   Entering sleep state event.
+   */
+  event_source_t            sleep_event;
+  /**
+   * @brief   Exiting sleep state event.
+   */
+  event_source_t            wakeup_event;
+#endif /* CAN_USE_SLEEP_MODE */
+#if CAN_USE_RX_QUEUES || defined(__DOXYGEN__)
+  /**
+   * @brief   Attached receive queues.
+   */
+  CANRxQueue                *rxqueues;
+  /**
+   * @brief   Frames lost because the simulated receive FIFO was full.
+   */
+  uint32_t                  rxoverruns;
+  /**
+   * @brief   Frames discarded because not routed to any queue.
+   */
+  uint32_t                  rxunrouted;
+#endif /* CAN_USE_RX_QUEUES */
+#if CAN_USE_TX_QUEUE || defined(__DOXYGEN__)
+  /**
+   * @brief   Associated transmit queue or @p NULL.
+   */
+  CANTxQueue                *txq;
+#endif /* CAN_USE_TX_QUEUE */
+  /* End of the mandatory fields.*/
+  /**
+   * @brief   Transmit mailboxes.
+   */
+  CANTxFrame                txmb[CAN_TX_MAILBOXES];
+  /**
+   * @brief   Mask of the mailboxes pending transmission.
+   */
+  uint32_t                  txpending;
+  /**
+   * @brief   Simulated receive FIFO.
+   */
+  CANRxFrame                rxfifo[SIM_CAN_RX_FIFO_DEPTH];
+  /**
+   * @brief   Read index of the receive FIFO.
+   */
+  unsigned                  rxrdidx;
+  /**
+   * @brief   Frames in the receive FIFO.
+   */
+  unsigned                  rxcnt;
+  /**
+   * @brief   Acceptance filters.
+   */
+  CANAcceptanceFilter       filters[SIM_CAN_MAX_FILTERS];
+  /**
+   * @brief   Number of acceptance filters, zero accepts all frames.
+   */
+  uint32_t                  nfilters;
+  /**
+   * @brief   Frames put on the simulated bus.
+   */
+  uint32_t                  txframes;
+  /**
+   * @brief   Frames accepted by the filters.
+   */
+  uint32_t                  rxframes;
+} CANDriver;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if USE_SIM_CAN1 && !defined(__DOXYGEN__)
+extern CANDriver CAND1;
+#endif
+
+#if USE_SIM_CAN2 && !defined(__DOXYGEN__)
+extern CANDriver CAND2;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void can_lld_init(void);
+  void can_lld_start(CANDriver *canp);
+  void can_lld_stop(CANDriver *canp);
+  bool can_lld_is_tx_empty(CANDriver *canp, canmbx_t mailbox);
+  void can_lld_transmit(CANDriver *canp,
+                        canmbx_t mailbox,
+                        const CANTxFrame *ctfp);
+  bool can_lld_is_rx_nonempty(CANDriver *canp, canmbx_t mailbox);
+  void can_lld_receive(CANDriver *canp,
+                       canmbx_t mailbox,
+                       CANRxFrame *crfp);
+  void can_lld_set_acceptance_filters(CANDriver *canp,
+                                      const CANAcceptanceFilter *afp,
+                                      uint32_t num);
+  bool can_lld_interrupt_pending(void);
+#if CAN_USE_SLEEP_MODE
+  void can_lld_sleep(CANDriver *canp);
+  void can_lld_wakeup(CANDriver *canp);
+#endif /* CAN_USE_SLEEP_MODE */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_CAN */
+
+#endif /* _CAN_LLD_H_ */
+
+/** @} */
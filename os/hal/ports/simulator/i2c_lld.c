@@ -0,0 +1,292 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    i2c_lld.c
+ * @brief   Simulator low level I2C driver code.
+ * @details The simulated bus has the slaves attached using
+ *          @p simI2cAttachDevice(), a transfer addressed to an absent slave
+ *          or to a slave refusing transfers is not acknowledged. A transfer
+ *          completes at the next simulated interrupt.
+ *
+ * @addtogroup I2C
+ * @{
+ */
+
+#include "hal.h"
+
+#if HAL_USE_I2C || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Simulated I2C driver 1.
+ */
+#if USE_SIM_I2C1 || defined(__DOXYGEN__)
+I2CDriver I2CD1;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Executes the transfer in progress on the simulated slaves.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @return              The error flags.
+ */
+static i2cflags_t i2c_lld_execute(I2CDriver *i2cp) {
+  SimI2CDevice *devp = i2cp->devices;
+  size_t i;
+
+  while ((devp != NULL) && (devp->addr != i2cp->addr)) {
+    devp = devp->next;
+  }
+  if ((devp == NULL) || devp->nak) {
+    return I2C_ACK_FAILURE;
+  }
+
+  /* Write phase, the first byte is the register pointer, bytes beyond
+     the last register are not acknowledged.*/
+  for (i = 0U; i < i2cp->txbytes; i++) {
+    if (i == 0U) {
+      devp->ptr = i2cp->txbuf[0];
+    }
+    else if (devp->ptr < devp->size) {
+      devp->regs[devp->ptr++] = i2cp->txbuf[i];
+    }
+    else {
+      return I2C_ACK_FAILURE;
+    }
+  }
+
+  /* Read phase after the repeated start, if any.*/
+  for (i = 0U; i < i2cp->rxbytes; i++) {
+    if (devp->ptr < devp->size) {
+      i2cp->rxbuf[i] = devp->regs[devp->ptr++];
+    }
+    else {
+      i2cp->rxbuf[i] = SIM_I2C_IDLE_BYTE;
+    }
+  }
+
+  return I2C_NO_ERROR;
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Simulated transfer complete interrupt.
+ *
+ * @return              The interrupt status.
+ * @retval false        no transfers were in progress.
+ * @retval true         a transfer has been completed.
+ *
+ * @notapi
+ */
+bool i2c_lld_interrupt_pending(void) {
+  I2CDriver *i2cp = &I2CD1;
+
+  if (!i2cp->busy) {
+    return false;
+  }
+
+  OSAL_IRQ_PROLOGUE();
+
+  i2cp->busy = false;
+  i2cp->transfers++;
+  i2cp->errors = i2c_lld_execute(i2cp);
+  if (i2cp->errors != I2C_NO_ERROR) {
+    i2cp->naks++;
+    _i2c_wakeup_error_isr(i2cp);
+  }
+  else {
+    _i2c_wakeup_isr(i2cp);
+  }
+
+  OSAL_IRQ_EPILOGUE();
+
+  return true;
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Attaches a simulated slave to the bus.
+ * @note    Slaves must be attached before starting the driver.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[out] devp     pointer to the @p SimI2CDevice object
+ * @param[in] addr      slave address
+ * @param[in] regs      pointer to the slave registers
+ * @param[in] size      number of registers
+ *
+ * @api
+ */
+void simI2cAttachDevice(I2CDriver *i2cp, SimI2CDevice *devp,
+                        i2caddr_t addr, uint8_t *regs, size_t size) {
+
+  osalDbgCheck((i2cp != NULL) && (devp != NULL) && (regs != NULL));
+
+  devp->addr    = addr;
+  devp->regs    = regs;
+  devp->size    = size;
+  devp->ptr     = 0U;
+  devp->nak     = false;
+  devp->next    = i2cp->devices;
+  i2cp->devices = devp;
+}
+
+/**
+ * @brief   Low level I2C driver initialization.
+ *
+ * @notapi
+ */
+void i2c_lld_init(void) {
+
+  i2cObjectInit(&I2CD1);
+  I2CD1.thread    = NULL;
+  I2CD1.devices   = NULL;
+  I2CD1.busy      = false;
+  I2CD1.transfers = 0U;
+  I2CD1.naks      = 0U;
+}
+
+/**
+ * @brief   Configures and activates the I2C peripheral.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ *
+ * @notapi
+ */
+void i2c_lld_start(I2CDriver *i2cp) {
+
+  i2cp->busy = false;
+}
+
+/**
+ * @brief   Deactivates the I2C peripheral.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ *
+ * @notapi
+ */
+void i2c_lld_stop(I2CDriver *i2cp) {
+
+  i2cp->busy = false;
+}
+
+/**
+ * @brief   Receives data via the I2C bus as master.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] addr      slave device address
+ * @param[out] rxbuf    pointer to the receive buffer
+ * @param[in] rxbytes   number of bytes to be received
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the function succeeded.
+ * @retval MSG_RESET    if one or more I2C errors occurred, the errors can
+ *                      be retrieved using @p i2cGetErrors().
+ * @retval MSG_TIMEOUT  if a timeout occurred before operation end.
+ *
+ * @notapi
+ */
+msg_t i2c_lld_master_receive_timeout(I2CDriver *i2cp, i2caddr_t addr,
+                                     uint8_t *rxbuf, size_t rxbytes,
+                                     systime_t timeout) {
+
+  i2c_lld_start_transfer(i2cp, addr, NULL, 0U, rxbuf, rxbytes);
+  return osalThreadSuspendTimeoutS(&i2cp->thread, timeout);
+}
+
+/**
+ * @brief   Transmits data via the I2C bus as master.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] addr      slave device address
+ * @param[in] txbuf     pointer to the transmit buffer
+ * @param[in] txbytes   number of bytes to be transmitted
+ * @param[out] rxbuf    pointer to the receive buffer
+ * @param[in] rxbytes   number of bytes to be received
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the function succeeded.
+ * @retval MSG_RESET    if one or more I2C errors occurred, the errors can
+ *                      be retrieved using @p i2cGetErrors().
+ * @retval MSG_TIMEOUT  if a timeout occurred before operation end.
+ *
+ * @notapi
+ */
+msg_t i2c_lld_master_transmit_timeout(I2CDriver *i2cp, i2caddr_t addr,
+                                      const uint8_t *txbuf, size_t txbytes,
+                                      uint8_t *rxbuf, size_t rxbytes,
+                                      systime_t timeout) {
+
+  i2c_lld_start_transfer(i2cp, addr, txbuf, txbytes, rxbuf, rxbytes);
+  return osalThreadSuspendTimeoutS(&i2cp->thread, timeout);
+}
+
+/**
+ * @brief   Starts a transfer via the I2C bus as master.
+ * @details The transfer completes at the next simulated interrupt.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] addr      slave device address
+ * @param[in] txbuf     pointer to the transmit buffer
+ * @param[in] txbytes   number of bytes to be transmitted
+ * @param[out] rxbuf    pointer to the receive buffer
+ * @param[in] rxbytes   number of bytes to be received
+ *
+ * @notapi
+ */
+void i2c_lld_start_transfer(I2CDriver *i2cp, i2caddr_t addr,
+                            const uint8_t *txbuf, size_t txbytes,
+                            uint8_t *rxbuf, size_t rxbytes) {
+
+  i2cp->errors  = I2C_NO_ERROR;
+  i2cp->addr    = addr;
+  i2cp->txbuf   = txbuf;
+  i2cp->txbytes = txbytes;
+  i2cp->rxbuf   = rxbuf;
+  i2cp->rxbytes = rxbytes;
+  i2cp->busy    = true;
+}
+
+#endif /* HAL_USE_I2C */
+
+/** @} */
@@ -0,0 +1,276 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    i2c_lld.h
+ * @brief   Simulator low level I2C driver header.
+ *
+ * @addtogroup I2C
+ * @{
+ */
+
+#ifndef _I2C_LLD_H_
+#define _I2C_LLD_H_
+
+#if HAL_USE_I2C || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   This implementation supports the transactions queue.
+ */
+#define I2C_SUPPORTS_QUEUE                  TRUE
+
+/**
+ * @brief   Byte read from the bus when the slave has no more data.
+ */
+#define SIM_I2C_IDLE_BYTE                   0xFFU
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Configuration options
+ * @{
+ */
+/**
+ * @brief   I2CD1 driver enable switch.
+ * @details If set to @p TRUE the support for I2CD1 is included.
+ * @note    The default is @p TRUE.
+ */
+#if !defined(USE_SIM_I2C1) || defined(__DOXYGEN__)
+#define USE_SIM_I2C1                        TRUE
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if !USE_SIM_I2C1
+#error "I2C driver activated but no I2C peripheral assigned"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type representing an I2C address.
+ */
+typedef uint16_t i2caddr_t;
+
+/**
+ * @brief   Type of I2C Driver condition flags.
+ */
+typedef uint32_t i2cflags_t;
+
+/**
+ * @brief   Type of a simulated I2C slave.
+ */
+typedef struct sim_i2c_device SimI2CDevice;
+
+/**
+ * @brief   Structure representing a simulated I2C slave.
+ * @details The slave is a register file, the first byte written after
+ *          the address is the register pointer, the following bytes are
+ *          written into the registers. Reads return the registers starting
+ *          from the register pointer, the pointer is incremented after each
+ *          byte.
+ */
+struct sim_i2c_device {
+  /**
+   * @brief Next slave on the bus.
+   */
+  SimI2CDevice              *next;
+  /**
+   * @brief Slave address.
+   */
+  i2caddr_t                 addr;
+  /**
+   * @brief Registers.
+   */
+  uint8_t                   *regs;
+  /**
+   * @brief Number of registers.
+   */
+  size_t                    size;
+  /**
+   * @brief Register pointer.
+   */
+  size_t                    ptr;
+  /**
+   * @brief The slave does not acknowledge its address.
+   */
+  bool                      nak;
+};
+
+/**
+ * @brief   Driver configuration structure.
+ */
+typedef struct {
+  /* End of the mandatory fields.*/
+  /**
+   * @brief Simulated bus clock, it is not used.
+   */
+  uint32_t                  clock_speed;
+} I2CConfig;
+
+/**
+ * @brief   Type of a structure representing an I2C driver.
+ */
+typedef struct I2CDriver I2CDriver;
+
+/**
+ * @brief   Structure representing an I2C driver.
+ */
+struct I2CDriver {
+  /**
+   * @brief Driver state.
+   */
+  i2cstate_t                state;
+  /**
+   * @brief Current configuration data.
+   */
+  const I2CConfig           *config;
+  /**
+   * @brief Error flags.
+   */
+  i2cflags_t                errors;
+#if I2C_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+  /**
+   * @brief Mutex protecting the bus.
+   */
+  mutex_t                   mutex;
+#endif /* I2C_USE_MUTUAL_EXCLUSION */
+#if I2C_USE_QUEUE || defined(__DOXYGEN__)
+  /**
+   * @brief Transaction being executed, head of the queue.
+   */
+  I2CTransaction            *qhead;
+  /**
+   * @brief Last queued transaction.
+   */
+  I2CTransaction            *qtail;
+#endif /* I2C_USE_QUEUE */
+#if defined(I2C_DRIVER_EXT_FIELDS)
+  I2C_DRIVER_EXT_FIELDS
+#endif
+  /* End of the mandatory fields.*/
+  /**
+   * @brief Thread waiting for I/O completion.
+   */
+  thread_reference_t        thread;
+  /**
+   * @brief Slaves on the bus.
+   */
+  SimI2CDevice              *devices;
+  /**
+   * @brief A transfer is in progress.
+   */
+  bool                      busy;
+  /**
+   * @brief Slave address of the transfer in progress.
+   */
+  i2caddr_t                 addr;
+  /**
+   * @brief Transmit buffer of the transfer in progress.
+   */
+  const uint8_t             *txbuf;
+  /**
+   * @brief Bytes to be transmitted by the transfer in progress.
+   */
+  size_t                    txbytes;
+  /**
+   * @brief Receive buffer of the transfer in progress.
+   */
+  uint8_t                   *rxbuf;
+  /**
+   * @brief Bytes to be received by the transfer in progress.
+   */
+  size_t                    rxbytes;
+  /**
+   * @brief Transfers executed.
+   */
+  uint32_t                  transfers;
+  /**
+   * @brief Transfers not acknowledged.
+   */
+  uint32_t                  naks;
+};
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Get errors from I2C driver.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ *
+ * @notapi
+ */
+#define i2c_lld_get_errors(i2cp) ((i2cp)->errors)
+
+/**
+ * @brief   Makes a simulated slave not acknowledge its address.
+ *
+ * @param[in] devp      pointer to the @p SimI2CDevice object
+ * @param[in] b         @p true in order to refuse the transfers
+ *
+ * @api
+ */
+#define simI2cSetNak(devp, b) ((devp)->nak = (b))
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if USE_SIM_I2C1 && !defined(__DOXYGEN__)
+extern I2CDriver I2CD1;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void simI2cAttachDevice(I2CDriver *i2cp, SimI2CDevice *devp,
+                          i2caddr_t addr, uint8_t *regs, size_t size);
+  bool i2c_lld_interrupt_pending(void);
+  void i2c_lld_init(void);
+  void i2c_lld_start(I2CDriver *i2cp);
+  void i2c_lld_stop(I2CDriver *i2cp);
+  msg_t i2c_lld_master_transmit_timeout(I2CDriver *i2cp, i2caddr_t addr,
+                                        const uint8_t *txbuf, size_t txbytes,
+                                        uint8_t *rxbuf, size_t rxbytes,
+                                        systime_t timeout);
+  msg_t i2c_lld_master_receive_timeout(I2CDriver *i2cp, i2caddr_t addr,
+                                       uint8_t *rxbuf, size_t rxbytes,
+                                       systime_t timeout);
+  void i2c_lld_start_transfer(I2CDriver *i2cp, i2caddr_t addr,
+                              const uint8_t *txbuf, size_t txbytes,
+                              uint8_t *rxbuf, size_t rxbytes);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_I2C */
+
+#endif /* _I2C_LLD_H_ */
+
+/** @} */
@@ -0,0 +1,486 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    mac_lld.c
+ * @brief   Simulator low level MAC driver code.
+ * @details The simulated wire is an in-process loopback, transmitted frames
+ *          are received back by the same driver. Frames are lost when no
+ *          receive buffers are available, like on a real MAC. Frames made
+ *          of attached buffers are gathered by the simulated DMA directly
+ *          into the receive buffer.
+ *
+ * @addtogroup MAC
+ * @{
+ */
+
+#include <string.h>
+
+#include "hal.h"
+
+#if HAL_USE_MAC || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Simulated Ethernet driver 1.
+ */
+#if USE_SIM_MAC1 || defined(__DOXYGEN__)
+MACDriver ETHD1;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Puts a frame on the simulated wire.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[in] txbp      pointer to the transmit buffer
+ * @param[in] size      frame size
+ *
+ * @notapi
+ */
+static void mac_lld_wire_i(MACDriver *macp, const sim_mac_buffer_t *txbp,
+                           size_t size) {
+  sim_mac_buffer_t *rxbp = &macp->rxbuf[macp->rxhead];
+
+  macp->txframes++;
+#if MAC_USE_ZERO_COPY
+  if (txbp->nsegs > 0U)
+    macp->txattached++;
+#endif
+
+  /* The receive ring stalls on the first buffer not owned by the simulated
+     DMA, exactly like the real thing.*/
+  if (rxbp->state != SIM_MAC_BUF_FREE) {
+    macp->rxdropped++;
+    return;
+  }
+
+#if MAC_USE_ZERO_COPY
+  if (txbp->nsegs > 0U) {
+    uint8_t *p = rxbp->data;
+    unsigned i;
+
+    /* Simulated gather DMA.*/
+    for (i = 0; i < txbp->nsegs; i++) {
+      memcpy(p, txbp->segs[i].buf, txbp->segs[i].size);
+      p += txbp->segs[i].size;
+    }
+  }
+  else
+#endif
+    memcpy(rxbp->data, txbp->data, size);
+  rxbp->size   = size;
+  rxbp->state  = SIM_MAC_BUF_FULL;
+  macp->rxhead = (macp->rxhead + 1U) % SIM_MAC_RECEIVE_BUFFERS;
+  macp->rxframes++;
+
+  /* Simulated receive interrupt.*/
+  osalThreadDequeueAllI(&macp->rdqueue, MSG_RESET);
+#if MAC_USE_EVENTS
+  osalEventBroadcastFlagsI(&macp->rdevent, 0);
+#endif
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level MAC initialization.
+ *
+ * @notapi
+ */
+void mac_lld_init(void) {
+
+#if USE_SIM_MAC1
+  macObjectInit(&ETHD1);
+  ETHD1.link_up = true;
+#endif
+}
+
+/**
+ * @brief   Configures and activates the MAC peripheral.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ *
+ * @notapi
+ */
+void mac_lld_start(MACDriver *macp) {
+  unsigned i;
+
+  /* Resets the state of all buffers.*/
+  for (i = 0; i < SIM_MAC_RECEIVE_BUFFERS; i++)
+    macp->rxbuf[i].state = SIM_MAC_BUF_FREE;
+  for (i = 0; i < SIM_MAC_TRANSMIT_BUFFERS; i++) {
+    macp->txbuf[i].state = SIM_MAC_BUF_FREE;
+#if MAC_USE_ZERO_COPY
+    macp->txbuf[i].nsegs = 0;
+#endif
+  }
+  macp->txptr      = 0;
+  macp->rxhead     = 0;
+  macp->rxptr      = 0;
+  macp->txframes   = 0;
+  macp->txattached = 0;
+  macp->rxframes   = 0;
+  macp->rxdropped  = 0;
+}
+
+/**
+ * @brief   Deactivates the MAC peripheral.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ *
+ * @notapi
+ */
+void mac_lld_stop(MACDriver *macp) {
+
+  (void)macp;
+}
+
+/**
+ * @brief   Returns a transmission descriptor.
+ * @details One of the available transmission descriptors is locked and
+ *          returned.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[out] tdp      pointer to a @p MACTransmitDescriptor structure
+ * @return              The operation status.
+ * @retval MSG_OK       the descriptor has been obtained.
+ * @retval MSG_TIMEOUT  descriptor not available.
+ *
+ * @notapi
+ */
+msg_t mac_lld_get_transmit_descriptor(MACDriver *macp,
+                                      MACTransmitDescriptor *tdp) {
+  sim_mac_buffer_t *txbp;
+
+  if (!macp->link_up)
+    return MSG_TIMEOUT;
+
+  osalSysLock();
+
+  /* Ensure that the buffer isn't locked by another thread.*/
+  txbp = &macp->txbuf[macp->txptr];
+  if (txbp->state != SIM_MAC_BUF_FREE) {
+    osalSysUnlock();
+    return MSG_TIMEOUT;
+  }
+  txbp->state = SIM_MAC_BUF_LOCKED;
+
+  /* Next TX buffer to use.*/
+  macp->txptr = (macp->txptr + 1U) % SIM_MAC_TRANSMIT_BUFFERS;
+
+  osalSysUnlock();
+
+  tdp->offset   = 0;
+  tdp->size     = SIM_MAC_BUFFERS_SIZE;
+  tdp->macp     = macp;
+  tdp->physdesc = txbp;
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Releases a transmit descriptor and starts the transmission of the
+ *          enqueued data as a single frame.
+ * @note    The simulated transmission is completed before returning.
+ *
+ * @param[in] tdp       the pointer to the @p MACTransmitDescriptor structure
+ *
+ * @notapi
+ */
+void mac_lld_release_transmit_descriptor(MACTransmitDescriptor *tdp) {
+
+  osalDbgAssert(tdp->physdesc->state == SIM_MAC_BUF_LOCKED,
+                "attempt to release descriptor not locked");
+
+  osalSysLock();
+
+  mac_lld_wire_i(tdp->macp, tdp->physdesc, tdp->offset);
+
+  /* Simulated transmit interrupt.*/
+#if MAC_USE_ZERO_COPY
+  if ((tdp->physdesc->nsegs > 0U) && (tdp->physdesc->cb != NULL))
+    tdp->physdesc->cb(tdp->physdesc->arg);
+  tdp->physdesc->nsegs = 0;
+#endif
+  tdp->physdesc->state = SIM_MAC_BUF_FREE;
+  osalThreadDequeueAllI(&tdp->macp->tdqueue, MSG_RESET);
+
+  osalOsRescheduleS();
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Returns a receive descriptor.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[out] rdp      pointer to a @p MACReceiveDescriptor structure
+ * @return              The operation status.
+ * @retval MSG_OK       the descriptor has been obtained.
+ * @retval MSG_TIMEOUT  descriptor not available.
+ *
+ * @notapi
+ */
+msg_t mac_lld_get_receive_descriptor(MACDriver *macp,
+                                     MACReceiveDescriptor *rdp) {
+  sim_mac_buffer_t *rxbp;
+
+  osalSysLock();
+
+  /* A buffer still held by the upper layer or owned by the simulated DMA
+     means that there are no more frames.*/
+  rxbp = &macp->rxbuf[macp->rxptr];
+  if (rxbp->state != SIM_MAC_BUF_FULL) {
+    osalSysUnlock();
+    return MSG_TIMEOUT;
+  }
+  rxbp->state = SIM_MAC_BUF_LOCKED;
+  macp->rxptr = (macp->rxptr + 1U) % SIM_MAC_RECEIVE_BUFFERS;
+
+  osalSysUnlock();
+
+  rdp->offset   = 0;
+  rdp->size     = rxbp->size;
+  rdp->physdesc = rxbp;
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Releases a receive descriptor.
+ * @details The descriptor and its buffer are made available for more incoming
+ *          frames.
+ *
+ * @param[in] rdp       the pointer to the @p MACReceiveDescriptor structure
+ *
+ * @notapi
+ */
+void mac_lld_release_receive_descriptor(MACReceiveDescriptor *rdp) {
+
+  osalDbgAssert(rdp->physdesc->state == SIM_MAC_BUF_LOCKED,
+                "attempt to release descriptor not locked");
+
+  osalSysLock();
+  rdp->physdesc->state = SIM_MAC_BUF_FREE;
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Updates and returns the link status.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @return              The link status.
+ * @retval true         if the link is active.
+ * @retval false        if the link is down.
+ *
+ * @notapi
+ */
+bool mac_lld_poll_link_status(MACDriver *macp) {
+
+  return macp->link_up;
+}
+
+/**
+ * @brief   Writes to a transmit descriptor's stream.
+ *
+ * @param[in] tdp       pointer to a @p MACTransmitDescriptor structure
+ * @param[in] buf       pointer to the buffer containing the data to be
+ *                      written
+ * @param[in] size      number of bytes to be written
+ * @return              The number of bytes written into the descriptor's
+ *                      stream, this value can be less than the amount
+ *                      specified in the parameter @p size if the maximum
+ *                      frame size is reached.
+ *
+ * @notapi
+ */
+size_t mac_lld_write_transmit_descriptor(MACTransmitDescriptor *tdp,
+                                         uint8_t *buf,
+                                         size_t size) {
+
+  if (size > tdp->size - tdp->offset)
+    size = tdp->size - tdp->offset;
+
+  if (size > 0) {
+    memcpy(tdp->physdesc->data + tdp->offset, buf, size);
+    tdp->offset += size;
+  }
+  return size;
+}
+
+/**
+ * @brief   Reads from a receive descriptor's stream.
+ *
+ * @param[in] rdp       pointer to a @p MACReceiveDescriptor structure
+ * @param[in] buf       pointer to the buffer that will receive the read data
+ * @param[in] size      number of bytes to be read
+ * @return              The number of bytes read from the descriptor's
+ *                      stream, this value can be less than the amount
+ *                      specified in the parameter @p size if there are
+ *                      no more bytes to read.
+ *
+ * @notapi
+ */
+size_t mac_lld_read_receive_descriptor(MACReceiveDescriptor *rdp,
+                                       uint8_t *buf,
+                                       size_t size) {
+
+  if (size > rdp->size - rdp->offset)
+    size = rdp->size - rdp->offset;
+
+  if (size > 0) {
+    memcpy(buf, rdp->physdesc->data + rdp->offset, size);
+    rdp->offset += size;
+  }
+  return size;
+}
+
+#if MAC_USE_ZERO_COPY || defined(__DOXYGEN__)
+/**
+ * @brief   Returns a pointer to the next transmit buffer in the descriptor
+ *          chain.
+ * @note    The API guarantees that enough buffers can be requested to fill
+ *          a whole frame.
+ *
+ * @param[in] tdp       pointer to a @p MACTransmitDescriptor structure
+ * @param[in] size      size of the requested buffer. Specify the frame size
+ *                      on the first call then scale the value down subtracting
+ *                      the amount of data already copied into the previous
+ *                      buffers.
+ * @param[out] sizep    pointer to variable receiving the buffer size, it is
+ *                      zero when the last buffer has already been returned.
+ *                      Note that a returned size lower than the amount
+ *                      requested means that more buffers must be requested
+ *                      in order to fill the frame data entirely.
+ * @return              Pointer to the returned buffer.
+ * @retval NULL         if the buffer chain has been entirely scanned.
+ *
+ * @notapi
+ */
+uint8_t *mac_lld_get_next_transmit_buffer(MACTransmitDescriptor *tdp,
+                                          size_t size,
+                                          size_t *sizep) {
+
+  if (tdp->offset == 0) {
+    *sizep      = tdp->size;
+    tdp->offset = size;
+    return tdp->physdesc->data;
+  }
+  *sizep = 0;
+  return NULL;
+}
+
+/**
+ * @brief   Returns a pointer to the next receive buffer in the descriptor
+ *          chain.
+ * @note    The API guarantees that the descriptor chain contains a whole
+ *          frame.
+ *
+ * @param[in] rdp       pointer to a @p MACReceiveDescriptor structure
+ * @param[out] sizep    pointer to variable receiving the buffer size, it is
+ *                      zero when the last buffer has already been returned.
+ * @return              Pointer to the returned buffer.
+ * @retval NULL         if the buffer chain has been entirely scanned.
+ *
+ * @notapi
+ */
+const uint8_t *mac_lld_get_next_receive_buffer(MACReceiveDescriptor *rdp,
+                                               size_t *sizep) {
+
+  if (rdp->size > 0) {
+    *sizep      = rdp->size;
+    rdp->offset = rdp->size;
+    rdp->size   = 0;
+    return rdp->physdesc->data;
+  }
+  *sizep = 0;
+  return NULL;
+}
+
+/**
+ * @brief   Attaches a list of buffers to a transmit descriptor.
+ * @details The buffers are gathered by the simulated DMA when the
+ *          descriptor is released.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[in] tdp       pointer to a @p MACTransmitDescriptor structure
+ * @param[in] bp        pointer to an array of @p macbuffer_t structures
+ * @param[in] n         number of buffers
+ * @param[in] cb        callback invoked when the MAC is done with the
+ *                      buffers, it can be @p NULL
+ * @param[in] arg       parameter passed to the callback
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the buffers have been attached.
+ * @retval HAL_FAILED   the buffers cannot be attached.
+ *
+ * @notapi
+ */
+bool mac_lld_attach_transmit_buffers(MACDriver *macp,
+                                     MACTransmitDescriptor *tdp,
+                                     const macbuffer_t *bp, unsigned n,
+                                     mactxcb_t cb, void *arg) {
+  sim_mac_buffer_t *txbp = tdp->physdesc;
+  size_t size;
+  unsigned i;
+
+  (void)macp;
+
+  osalDbgAssert(tdp->offset == 0, "descriptor not empty");
+
+  if ((n == 0) || (n > SIM_MAC_TRANSMIT_SEGMENTS))
+    return HAL_FAILED;
+  size = 0;
+  for (i = 0; i < n; i++)
+    size += bp[i].size;
+  if (size > tdp->size)
+    return HAL_FAILED;
+
+  for (i = 0; i < n; i++)
+    txbp->segs[i] = bp[i];
+  txbp->nsegs = n;
+  txbp->cb    = cb;
+  txbp->arg   = arg;
+
+  /* Nothing more can be written into the frame.*/
+  tdp->offset = size;
+  tdp->size   = size;
+  return HAL_SUCCESS;
+}
+#endif /* MAC_USE_ZERO_COPY */
+
+#endif /* HAL_USE_MAC */
+
+/** @} */
@@ -0,0 +1,330 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    mac_lld.h
+ * @brief   Simulator low level MAC driver header.
+ *
+ * @addtogroup MAC
+ * @{
+ */
+
+#ifndef _MAC_LLD_H_
+#define _MAC_LLD_H_
+
+#if HAL_USE_MAC || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   This implementation supports the zero-copy mode API.
+ */
+#define MAC_SUPPORTS_ZERO_COPY      TRUE
+
+/**
+ * @name    Simulated buffer states
+ * @{
+ */
+#define SIM_MAC_BUF_FREE            0U  /**< Owned by the simulated DMA.    */
+#define SIM_MAC_BUF_FULL            1U  /**< Contains a received frame.     */
+#define SIM_MAC_BUF_LOCKED          2U  /**< Owned by the upper layer.      */
+/** @} */
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Configuration options
+ * @{
+ */
+/**
+ * @brief   ETHD1 driver enable switch.
+ * @details If set to @p TRUE the support for ETHD1 is included.
+ * @note    The default is @p TRUE.
+ */
+#if !defined(USE_SIM_MAC1) || defined(__DOXYGEN__)
+#define USE_SIM_MAC1                        TRUE
+#endif
+
+/**
+ * @brief   Number of available transmit buffers.
+ */
+#if !defined(SIM_MAC_TRANSMIT_BUFFERS) || defined(__DOXYGEN__)
+#define SIM_MAC_TRANSMIT_BUFFERS            2
+#endif
+
+/**
+ * @brief   Number of available receive buffers.
+ */
+#if !defined(SIM_MAC_RECEIVE_BUFFERS) || defined(__DOXYGEN__)
+#define SIM_MAC_RECEIVE_BUFFERS             8
+#endif
+
+/**
+ * @brief   Maximum supported frame size.
+ */
+#if !defined(SIM_MAC_BUFFERS_SIZE) || defined(__DOXYGEN__)
+#define SIM_MAC_BUFFERS_SIZE                1522
+#endif
+
+/**
+ * @brief   Maximum number of buffers attached to a transmitted frame.
+ */
+#if !defined(SIM_MAC_TRANSMIT_SEGMENTS) || defined(__DOXYGEN__)
+#define SIM_MAC_TRANSMIT_SEGMENTS           4
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if (SIM_MAC_TRANSMIT_BUFFERS < 1) || (SIM_MAC_RECEIVE_BUFFERS < 1)
+#error "invalid number of simulated MAC buffers"
+#endif
+
+#if SIM_MAC_TRANSMIT_SEGMENTS < 1
+#error "invalid SIM_MAC_TRANSMIT_SEGMENTS value"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a simulated MAC buffer.
+ */
+typedef struct {
+  /**
+   * @brief Buffer state.
+   */
+  uint32_t              state;
+  /**
+   * @brief Frame size.
+   */
+  size_t                size;
+  /**
+   * @brief Frame data.
+   */
+  uint8_t               data[SIM_MAC_BUFFERS_SIZE];
+#if MAC_USE_ZERO_COPY || defined(__DOXYGEN__)
+  /**
+   * @brief Number of attached buffers, zero if the frame is in @p data.
+   * @note  Attached buffers are only used by transmit buffers.
+   */
+  unsigned              nsegs;
+  /**
+   * @brief Attached buffers.
+   */
+  macbuffer_t           segs[SIM_MAC_TRANSMIT_SEGMENTS];
+  /**
+   * @brief Transmit completion callback.
+   */
+  mactxcb_t             cb;
+  /**
+   * @brief Transmit completion callback parameter.
+   */
+  void                  *arg;
+#endif
+} sim_mac_buffer_t;
+
+/**
+ * @brief   Driver configuration structure.
+ */
+typedef struct {
+  /**
+   * @brief MAC address.
+   */
+  uint8_t               *mac_address;
+  /* End of the mandatory fields.*/
+} MACConfig;
+
+/**
+ * @brief   Structure representing a MAC driver.
+ */
+struct MACDriver {
+  /**
+   * @brief Driver state.
+   */
+  macstate_t            state;
+  /**
+   * @brief Current configuration data.
+   */
+  const MACConfig       *config;
+  /**
+   * @brief Transmit semaphore.
+   */
+  threads_queue_t       tdqueue;
+  /**
+   * @brief Receive semaphore.
+   */
+  threads_queue_t       rdqueue;
+#if MAC_USE_EVENTS || defined(__DOXYGEN__)
+  /**
+   * @brief Receive event.
+   */
+  event_source_t        rdevent;
+#endif
+  /* End of the mandatory fields.*/
+  /**
+   * @brief Link status flag.
+   */
+  bool                  link_up;
+  /**
+   * @brief Next transmit buffer.
+   */
+  unsigned              txptr;
+  /**
+   * @brief Next receive buffer to be filled by the simulated wire.
+   */
+  unsigned              rxhead;
+  /**
+   * @brief Next receive buffer to be returned to the upper layer.
+   */
+  unsigned              rxptr;
+  /**
+   * @brief Frames transmitted.
+   */
+  uint32_t              txframes;
+  /**
+   * @brief Frames transmitted from attached buffers.
+   */
+  uint32_t              txattached;
+  /**
+   * @brief Frames received.
+   */
+  uint32_t              rxframes;
+  /**
+   * @brief Frames lost because no receive buffers were available.
+   */
+  uint32_t              rxdropped;
+  /**
+   * @brief Transmit buffers.
+   */
+  sim_mac_buffer_t      txbuf[SIM_MAC_TRANSMIT_BUFFERS];
+  /**
+   * @brief Receive buffers.
+   */
+  sim_mac_buffer_t      rxbuf[SIM_MAC_RECEIVE_BUFFERS];
+};
+
+/**
+ * @brief   Structure representing a transmit descriptor.
+ */
+typedef struct {
+  /**
+   * @brief Current write offset.
+   */
+  size_t                offset;
+  /**
+   * @brief Available space size.
+   */
+  size_t                size;
+  /* End of the mandatory fields.*/
+  /**
+   * @brief Pointer to the associated driver.
+   */
+  MACDriver             *macp;
+  /**
+   * @brief Pointer to the simulated buffer.
+   */
+  sim_mac_buffer_t      *physdesc;
+} MACTransmitDescriptor;
+
+/**
+ * @brief   Structure representing a receive descriptor.
+ */
+typedef struct {
+  /**
+   * @brief Current read offset.
+   */
+  size_t                offset;
+  /**
+   * @brief Available data size.
+   */
+  size_t                size;
+  /* End of the mandatory fields.*/
+  /**
+   * @brief Pointer to the simulated buffer.
+   */
+  sim_mac_buffer_t      *physdesc;
+} MACReceiveDescriptor;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Changes the simulated link status.
+ * @note    The change is reported by the next @p macPollLinkStatus() call.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[in] up        the new link status
+ *
+ * @api
+ */
+#define simMacSetLinkStatus(macp, up) ((macp)->link_up = (up))
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if USE_SIM_MAC1 && !defined(__DOXYGEN__)
+extern MACDriver ETHD1;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void mac_lld_init(void);
+  void mac_lld_start(MACDriver *macp);
+  void mac_lld_stop(MACDriver *macp);
+  msg_t mac_lld_get_transmit_descriptor(MACDriver *macp,
+                                        MACTransmitDescriptor *tdp);
+  void mac_lld_release_transmit_descriptor(MACTransmitDescriptor *tdp);
+  msg_t mac_lld_get_receive_descriptor(MACDriver *macp,
+                                       MACReceiveDescriptor *rdp);
+  void mac_lld_release_receive_descriptor(MACReceiveDescriptor *rdp);
+  bool mac_lld_poll_link_status(MACDriver *macp);
+  size_t mac_lld_write_transmit_descriptor(MACTransmitDescriptor *tdp,
+                                           uint8_t *buf,
+                                           size_t size);
+  size_t mac_lld_read_receive_descriptor(MACReceiveDescriptor *rdp,
+                                         uint8_t *buf,
+                                         size_t size);
+#if MAC_USE_ZERO_COPY
+  uint8_t *mac_lld_get_next_transmit_buffer(MACTransmitDescriptor *tdp,
+                                            size_t size,
+                                            size_t *sizep);
+  const uint8_t *mac_lld_get_next_receive_buffer(MACReceiveDescriptor *rdp,
+                                                 size_t *sizep);
+  bool mac_lld_attach_transmit_buffers(MACDriver *macp,
+                                       MACTransmitDescriptor *tdp,
+                                       const macbuffer_t *bp, unsigned n,
+                                       mactxcb_t cb, void *arg);
+#endif /* MAC_USE_ZERO_COPY */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_MAC */
+
+#endif /* _MAC_LLD_H_ */
+
+/** @} */
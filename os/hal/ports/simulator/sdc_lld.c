@@ -0,0 +1,491 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    sdc_lld.c
+ * @brief   Simulator low level SDC driver code.
+ * @details The simulated card is an high capacity SD card backed by a RAM
+ *          array. Commands are answered immediately, data transfers
+ *          complete at the next simulated interrupt. Operations and
+ *          transferred blocks are counted, transfers on buffers not
+ *          aligned as declared by @p SDC_LLD_BUFFER_ALIGNMENT are counted
+ *          as errors.
+ *
+ * @addtogroup SDC
+ * @{
+ */
+
+#include <string.h>
+
+#include "hal.h"
+
+#if HAL_USE_SDC || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Relative address assigned to the simulated card.
+ */
+#define SIM_SDC_RCA                 0x00010000U
+
+/**
+ * @brief   R1 response of a card in transfer state without errors.
+ */
+#define SIM_SDC_R1                  ((uint32_t)MMCSD_STS_TRAN << 9U)
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Simulated SDC driver 1.
+ */
+#if USE_SIM_SDC1 || defined(__DOXYGEN__)
+SDCDriver SDCD1;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Simulated card content.
+ */
+static uint8_t card[SIM_SDC_CARD_BLOCKS * MMCSD_BLOCK_SIZE];
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Starts a data transfer and waits for its completion.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] startblk  first block of the transfer
+ * @param[out] rxbuf    pointer to the receive buffer or @p NULL
+ * @param[in] txbuf     pointer to the transmit buffer or @p NULL
+ * @param[in] n         number of blocks
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ */
+static bool sdc_lld_transfer(SDCDriver *sdcp, uint32_t startblk,
+                             uint8_t *rxbuf, const uint8_t *txbuf,
+                             uint32_t n) {
+  const void *buf = rxbuf != NULL ? (const void *)rxbuf : (const void *)txbuf;
+
+  if ((startblk >= (uint32_t)SIM_SDC_CARD_BLOCKS) ||
+      (n > (uint32_t)SIM_SDC_CARD_BLOCKS - startblk)) {
+    sdcp->errors |= SDC_OVERFLOW_ERROR;
+    return HAL_FAILED;
+  }
+  if (((size_t)buf & (SDC_LLD_BUFFER_ALIGNMENT - 1U)) != 0U) {
+    sdcp->unaligned++;
+  }
+
+  osalSysLock();
+  sdcp->startblk = startblk;
+  sdcp->rxbuf    = rxbuf;
+  sdcp->txbuf    = txbuf;
+  sdcp->n        = n;
+  (void) osalThreadSuspendS(&sdcp->thread);
+  osalSysUnlock();
+
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Answers a command with a short response.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] cmd       card command
+ * @param[in] arg       command argument
+ * @return              The response.
+ */
+static uint32_t sdc_lld_answer(SDCDriver *sdcp, uint8_t cmd, uint32_t arg) {
+
+  sdcp->commands++;
+  switch (cmd) {
+  case MMCSD_CMD_SEND_IF_COND:
+    return arg;
+  case MMCSD_CMD_APP_OP_COND:
+    /* Ready, high capacity.*/
+    return 0xC0FF8000U;
+  case MMCSD_CMD_SEND_RELATIVE_ADDR:
+    return SIM_SDC_RCA;
+  default:
+    return SIM_SDC_R1;
+  }
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Simulated transfer complete interrupt.
+ *
+ * @return              The interrupt status.
+ * @retval false        no transfers were in progress.
+ * @retval true         a transfer has been completed.
+ *
+ * @notapi
+ */
+bool sdc_lld_interrupt_pending(void) {
+  SDCDriver *sdcp = &SDCD1;
+  uint8_t *p;
+  size_t bytes;
+
+  if (sdcp->n == 0U) {
+    return false;
+  }
+
+  OSAL_IRQ_PROLOGUE();
+
+  p     = &card[(size_t)sdcp->startblk * MMCSD_BLOCK_SIZE];
+  bytes = (size_t)sdcp->n * MMCSD_BLOCK_SIZE;
+  if (sdcp->rxbuf != NULL) {
+    memcpy(sdcp->rxbuf, p, bytes);
+    sdcp->reads++;
+  }
+  else {
+    memcpy(p, sdcp->txbuf, bytes);
+    sdcp->writes++;
+  }
+  sdcp->blocks += sdcp->n;
+  sdcp->n = 0U;
+
+  osalSysLockFromISR();
+  osalThreadResumeI(&sdcp->thread, MSG_OK);
+  osalSysUnlockFromISR();
+
+  OSAL_IRQ_EPILOGUE();
+
+  return true;
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level SDC driver initialization.
+ *
+ * @notapi
+ */
+void sdc_lld_init(void) {
+
+  sdcObjectInit(&SDCD1);
+  SDCD1.thread    = NULL;
+  SDCD1.n         = 0U;
+  SDCD1.commands  = 0U;
+  SDCD1.reads     = 0U;
+  SDCD1.writes    = 0U;
+  SDCD1.blocks    = 0U;
+  SDCD1.unaligned = 0U;
+}
+
+/**
+ * @brief   Configures and activates the SDC peripheral.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ *
+ * @notapi
+ */
+void sdc_lld_start(SDCDriver *sdcp) {
+
+  (void)sdcp;
+}
+
+/**
+ * @brief   Deactivates the SDC peripheral.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ *
+ * @notapi
+ */
+void sdc_lld_stop(SDCDriver *sdcp) {
+
+  (void)sdcp;
+}
+
+/**
+ * @brief   Starts the SDIO clock and sets it to init mode (400kHz or less).
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ *
+ * @notapi
+ */
+void sdc_lld_start_clk(SDCDriver *sdcp) {
+
+  (void)sdcp;
+}
+
+/**
+ * @brief   Sets the SDIO clock to data mode (25MHz or less).
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] clk       the clock mode
+ *
+ * @notapi
+ */
+void sdc_lld_set_data_clk(SDCDriver *sdcp, sdcbusclk_t clk) {
+
+  (void)sdcp;
+  (void)clk;
+}
+
+/**
+ * @brief   Stops the SDIO clock.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ *
+ * @notapi
+ */
+void sdc_lld_stop_clk(SDCDriver *sdcp) {
+
+  (void)sdcp;
+}
+
+/**
+ * @brief   Switches the bus to 1, 4 or 8 bits mode.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] mode      bus mode
+ *
+ * @notapi
+ */
+void sdc_lld_set_bus_mode(SDCDriver *sdcp, sdcbusmode_t mode) {
+
+  (void)sdcp;
+  (void)mode;
+}
+
+/**
+ * @brief   Sends an SDIO command with no response expected.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] cmd       card command
+ * @param[in] arg       command argument
+ *
+ * @notapi
+ */
+void sdc_lld_send_cmd_none(SDCDriver *sdcp, uint8_t cmd, uint32_t arg) {
+
+  (void)sdc_lld_answer(sdcp, cmd, arg);
+}
+
+/**
+ * @brief   Sends an SDIO command with a short response expected.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] cmd       card command
+ * @param[in] arg       command argument
+ * @param[out] resp     pointer to the response buffer (one word)
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @notapi
+ */
+bool sdc_lld_send_cmd_short(SDCDriver *sdcp, uint8_t cmd, uint32_t arg,
+                            uint32_t *resp) {
+
+  *resp = sdc_lld_answer(sdcp, cmd, arg);
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Sends an SDIO command with a short response expected and CRC.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] cmd       card command
+ * @param[in] arg       command argument
+ * @param[out] resp     pointer to the response buffer (one word)
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @notapi
+ */
+bool sdc_lld_send_cmd_short_crc(SDCDriver *sdcp, uint8_t cmd, uint32_t arg,
+                                uint32_t *resp) {
+
+  *resp = sdc_lld_answer(sdcp, cmd, arg);
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Sends an SDIO command with a long response expected and CRC.
+ * @details The CID is all zeros, the CSD is a version 2.0 one describing
+ *          a card of @p SIM_SDC_CARD_BLOCKS blocks.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] cmd       card command
+ * @param[in] arg       command argument
+ * @param[out] resp     pointer to the response buffer (four words)
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @notapi
+ */
+bool sdc_lld_send_cmd_long_crc(SDCDriver *sdcp, uint8_t cmd, uint32_t arg,
+                               uint32_t *resp) {
+  uint32_t csize = ((uint32_t)SIM_SDC_CARD_BLOCKS / 1024U) - 1U;
+
+  (void)arg;
+
+  sdcp->commands++;
+  resp[0] = 0U;
+  resp[1] = 0U;
+  resp[2] = 0U;
+  resp[3] = 0U;
+  if (cmd == MMCSD_CMD_SEND_CSD) {
+    /* CSD structure 1, C_SIZE in bits 69..48.*/
+    resp[1] = (csize & 0xFFFFU) << 16U;
+    resp[2] = (csize >> 16U) & 0x3FU;
+    resp[3] = 0x40000000U;
+  }
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Reads special registers using data bus.
+ * @details The simulated card answers with all zeros.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[out] buf      pointer to the read buffer
+ * @param[in] bytes     number of bytes to read
+ * @param[in] cmd       card command
+ * @param[in] arg       argument for command
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @notapi
+ */
+bool sdc_lld_read_special(SDCDriver *sdcp, uint8_t *buf, size_t bytes,
+                          uint8_t cmd, uint32_t arg) {
+
+  (void)arg;
+  (void)cmd;
+
+  sdcp->commands++;
+  memset(buf, 0, bytes);
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Reads one or more blocks.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] startblk  first block to read
+ * @param[out] buf      pointer to the read buffer
+ * @param[in] n         number of blocks to read
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @notapi
+ */
+bool sdc_lld_read(SDCDriver *sdcp, uint32_t startblk,
+                  uint8_t *buf, uint32_t n) {
+
+  return sdc_lld_transfer(sdcp, startblk, buf, NULL, n);
+}
+
+/**
+ * @brief   Writes one or more blocks.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] startblk  first block to write
+ * @param[out] buf      pointer to the write buffer
+ * @param[in] n         number of blocks to write
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @notapi
+ */
+bool sdc_lld_write(SDCDriver *sdcp, uint32_t startblk,
+                   const uint8_t *buf, uint32_t n) {
+
+  return sdc_lld_transfer(sdcp, startblk, NULL, buf, n);
+}
+
+/**
+ * @brief   Waits for card idle condition.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation succeeded.
+ * @retval HAL_FAILED   the operation failed.
+ *
+ * @api
+ */
+bool sdc_lld_sync(SDCDriver *sdcp) {
+
+  (void)sdcp;
+
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Card presence check.
+ * @details The simulated card is always inserted.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @return              The card state.
+ *
+ * @notapi
+ */
+bool sdc_lld_is_card_inserted(SDCDriver *sdcp) {
+
+  (void)sdcp;
+
+  return true;
+}
+
+/**
+ * @brief   Write protection check.
+ * @details The simulated card is never write protected.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @return              The write protection state.
+ *
+ * @notapi
+ */
+bool sdc_lld_is_write_protected(SDCDriver *sdcp) {
+
+  (void)sdcp;
+
+  return false;
+}
+
+#endif /* HAL_USE_SDC */
+
+/** @} */
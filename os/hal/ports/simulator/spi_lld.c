@@ -0,0 +1,289 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    spi_lld.c
+ * @brief   Simulator low level SPI driver code.
+ * @details The simulated bus has up to 256 slaves, each slave answers the
+ *          words sent by the master as described by @p SIM_SPI_RESPONSE().
+ *          A transfer completes at the next simulated interrupt. The bus
+ *          events are recorded in a log and protocol violations are
+ *          counted, this allows to check the order of the operations.
+ *
+ * @addtogroup SPI
+ * @{
+ */
+
+#include "hal.h"
+
+#if HAL_USE_SPI || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Word sent when no transmit buffer is specified.
+ */
+#define SIM_SPI_IDLE_WORD           0xFFU
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Simulated SPI driver 1.
+ */
+#if USE_SIM_SPI1 || defined(__DOXYGEN__)
+SPIDriver SPID1;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Records a bus event.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] ev        the event type
+ * @param[in] n         number of words transferred
+ */
+static void spi_lld_log(SPIDriver *spip, uint32_t ev, size_t n) {
+
+  if (spip->logn < SIM_SPI_LOG_SIZE) {
+    spip->log[spip->logn++] = SIM_SPI_EVENT(ev, spip->config->cs, n);
+  }
+}
+
+/**
+ * @brief   Prepares a transfer.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to be transferred
+ * @param[in] txbuf     the pointer to the transmit buffer or @p NULL
+ * @param[out] rxbuf    the pointer to the receive buffer or @p NULL
+ */
+static void spi_lld_transfer(SPIDriver *spip, size_t n,
+                             const void *txbuf, void *rxbuf) {
+
+  if (spip->selected != (uint32_t)spip->config->cs + 1U) {
+    spip->errors++;
+  }
+  spip->n     = n;
+  spip->txbuf = txbuf;
+  spip->rxbuf = rxbuf;
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Simulated transfer complete interrupt.
+ *
+ * @return              The interrupt status.
+ * @retval false        no transfers were in progress.
+ * @retval true         a transfer has been completed.
+ *
+ * @notapi
+ */
+bool spi_lld_interrupt_pending(void) {
+  SPIDriver *spip = &SPID1;
+  size_t i;
+
+  if (spip->n == 0U) {
+    return false;
+  }
+
+  OSAL_IRQ_PROLOGUE();
+
+  for (i = 0U; i < spip->n; i++) {
+    uint8_t w = spip->txbuf != NULL ? spip->txbuf[i] : SIM_SPI_IDLE_WORD;
+
+    if (spip->rxbuf != NULL) {
+      spip->rxbuf[i] = SIM_SPI_RESPONSE(spip->config->cs, w);
+    }
+  }
+  spi_lld_log(spip, SIM_SPI_EV_TRANSFER, spip->n);
+  spip->transfers++;
+  spip->n = 0U;
+
+  /* Portable SPI ISR code defined in the high level driver, note, it is
+     a macro.*/
+  _spi_isr_code(spip);
+
+  OSAL_IRQ_EPILOGUE();
+
+  return true;
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level SPI driver initialization.
+ *
+ * @notapi
+ */
+void spi_lld_init(void) {
+
+  spiObjectInit(&SPID1);
+  SPID1.n         = 0U;
+  SPID1.selected  = 0U;
+  SPID1.transfers = 0U;
+  SPID1.setups    = 0U;
+  SPID1.errors    = 0U;
+  SPID1.logn      = 0U;
+}
+
+/**
+ * @brief   Configures and activates the SPI peripheral.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void spi_lld_start(SPIDriver *spip) {
+
+  spip->setups++;
+  spi_lld_log(spip, SIM_SPI_EV_SETUP, 0U);
+}
+
+/**
+ * @brief   Deactivates the SPI peripheral.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void spi_lld_stop(SPIDriver *spip) {
+
+  spip->selected = 0U;
+}
+
+/**
+ * @brief   Asserts the slave select signal and prepares for transfers.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void spi_lld_select(SPIDriver *spip) {
+
+  if (spip->selected != 0U) {
+    spip->errors++;
+  }
+  spip->selected = (uint32_t)spip->config->cs + 1U;
+  spi_lld_log(spip, SIM_SPI_EV_SELECT, 0U);
+}
+
+/**
+ * @brief   Deasserts the slave select signal.
+ * @details The previously selected peripheral is unselected.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void spi_lld_unselect(SPIDriver *spip) {
+
+  if (spip->selected != (uint32_t)spip->config->cs + 1U) {
+    spip->errors++;
+  }
+  spip->selected = 0U;
+  spi_lld_log(spip, SIM_SPI_EV_UNSELECT, 0U);
+}
+
+/**
+ * @brief   Ignores data on the SPI bus.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to be ignored
+ *
+ * @notapi
+ */
+void spi_lld_ignore(SPIDriver *spip, size_t n) {
+
+  spi_lld_transfer(spip, n, NULL, NULL);
+}
+
+/**
+ * @brief   Exchanges data on the SPI bus.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to be exchanged
+ * @param[in] txbuf     the pointer to the transmit buffer
+ * @param[out] rxbuf    the pointer to the receive buffer
+ *
+ * @notapi
+ */
+void spi_lld_exchange(SPIDriver *spip, size_t n,
+                      const void *txbuf, void *rxbuf) {
+
+  spi_lld_transfer(spip, n, txbuf, rxbuf);
+}
+
+/**
+ * @brief   Sends data over the SPI bus.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to send
+ * @param[in] txbuf     the pointer to the transmit buffer
+ *
+ * @notapi
+ */
+void spi_lld_send(SPIDriver *spip, size_t n, const void *txbuf) {
+
+  spi_lld_transfer(spip, n, txbuf, NULL);
+}
+
+/**
+ * @brief   Receives data from the SPI bus.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to receive
+ * @param[out] rxbuf    the pointer to the receive buffer
+ *
+ * @notapi
+ */
+void spi_lld_receive(SPIDriver *spip, size_t n, void *rxbuf) {
+
+  spi_lld_transfer(spip, n, NULL, rxbuf);
+}
+
+/**
+ * @brief   Exchanges one frame using a polled wait.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] frame     the data frame to send over the SPI bus
+ * @return              The received data frame from the SPI bus.
+ *
+ * @notapi
+ */
+uint16_t spi_lld_polled_exchange(SPIDriver *spip, uint16_t frame) {
+
+  return (uint16_t)SIM_SPI_RESPONSE(spip->config->cs, frame);
+}
+
+#endif /* HAL_USE_SPI */
+
+/** @} */
@@ -0,0 +1,268 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    spi_lld.h
+ * @brief   Simulator low level SPI driver header.
+ *
+ * @addtogroup SPI
+ * @{
+ */
+
+#ifndef _SPI_LLD_H_
+#define _SPI_LLD_H_
+
+#if HAL_USE_SPI || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Bus events
+ * @{
+ */
+#define SIM_SPI_EV_SETUP            1U  /**< Peripheral reprogrammed.       */
+#define SIM_SPI_EV_SELECT           2U  /**< Slave selected.                */
+#define SIM_SPI_EV_UNSELECT         3U  /**< Slave unselected.              */
+#define SIM_SPI_EV_TRANSFER         4U  /**< Transfer completed.            */
+/** @} */
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Configuration options
+ * @{
+ */
+/**
+ * @brief   SPID1 driver enable switch.
+ * @details If set to @p TRUE the support for SPID1 is included.
+ * @note    The default is @p TRUE.
+ */
+#if !defined(USE_SIM_SPI1) || defined(__DOXYGEN__)
+#define USE_SIM_SPI1                        TRUE
+#endif
+
+/**
+ * @brief   Size of the bus events log.
+ */
+#if !defined(SIM_SPI_LOG_SIZE) || defined(__DOXYGEN__)
+#define SIM_SPI_LOG_SIZE                    64
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if !USE_SIM_SPI1
+#error "SPI driver activated but no SPI peripheral assigned"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a structure representing an SPI driver.
+ */
+typedef struct SPIDriver SPIDriver;
+
+/**
+ * @brief   SPI notification callback type.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object triggering the
+ *                      callback
+ */
+typedef void (*spicallback_t)(SPIDriver *spip);
+
+/**
+ * @brief   Driver configuration structure.
+ */
+typedef struct {
+  /**
+   * @brief Operation complete callback or @p NULL.
+   */
+  spicallback_t             end_cb;
+  /* End of the mandatory fields.*/
+  /**
+   * @brief Simulated slave selected by this configuration.
+   */
+  uint8_t                   cs;
+  /**
+   * @brief Simulated peripheral setup, clock and frame settings.
+   */
+  uint32_t                  setup;
+} SPIConfig;
+
+/**
+ * @brief   Structure representing an SPI driver.
+ */
+struct SPIDriver {
+  /**
+   * @brief Driver state.
+   */
+  spistate_t                state;
+  /**
+   * @brief Current configuration data.
+   */
+  const SPIConfig           *config;
+#if SPI_USE_WAIT || defined(__DOXYGEN__)
+  /**
+   * @brief Waiting thread.
+   */
+  thread_reference_t        thread;
+#endif /* SPI_USE_WAIT */
+#if SPI_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+  /**
+   * @brief Mutex protecting the bus.
+   */
+  mutex_t                   mutex;
+#endif /* SPI_USE_MUTUAL_EXCLUSION */
+#if SPI_USE_QUEUE || defined(__DOXYGEN__)
+  /**
+   * @brief Transaction being executed, head of the queue.
+   */
+  SPITransaction            *qhead;
+  /**
+   * @brief Last queued transaction.
+   */
+  SPITransaction            *qtail;
+  /**
+   * @brief Index of the transfer being executed.
+   */
+  size_t                    qstep;
+#endif /* SPI_USE_QUEUE */
+#if defined(SPI_DRIVER_EXT_FIELDS)
+  SPI_DRIVER_EXT_FIELDS
+#endif
+  /* End of the mandatory fields.*/
+  /**
+   * @brief Words of the transfer in progress, zero if idle.
+   */
+  size_t                    n;
+  /**
+   * @brief Transmit buffer of the transfer in progress or @p NULL.
+   */
+  const uint8_t             *txbuf;
+  /**
+   * @brief Receive buffer of the transfer in progress or @p NULL.
+   */
+  uint8_t                   *rxbuf;
+  /**
+   * @brief Currently selected slave plus one, zero if none.
+   */
+  uint32_t                  selected;
+  /**
+   * @brief Transfers executed.
+   */
+  uint32_t                  transfers;
+  /**
+   * @brief Peripheral setups.
+   */
+  uint32_t                  setups;
+  /**
+   * @brief Protocol violations, transfers without a selected slave or
+   *        overlapping selections.
+   */
+  uint32_t                  errors;
+  /**
+   * @brief Bus events log.
+   */
+  uint32_t                  log[SIM_SPI_LOG_SIZE];
+  /**
+   * @brief Number of events in the log.
+   */
+  size_t                    logn;
+};
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Compares the peripheral setup of two configurations.
+ *
+ * @param[in] cfg1      pointer to the first @p SPIConfig object
+ * @param[in] cfg2      pointer to the second @p SPIConfig object
+ *
+ * @notapi
+ */
+#define spi_lld_same_setup(cfg1, cfg2) ((cfg1)->setup == (cfg2)->setup)
+
+/**
+ * @brief   Encodes a bus event.
+ *
+ * @param[in] ev        the event type
+ * @param[in] cs        the slave involved
+ * @param[in] n         number of words transferred
+ */
+#define SIM_SPI_EVENT(ev, cs, n)                                            \
+  (((uint32_t)(ev) << 24) | ((uint32_t)(cs) << 16) | ((uint32_t)(n) & 0xFFFFU))
+
+/**
+ * @brief   Word answered by a simulated slave.
+ * @details Each slave answers with the word received from the master
+ *          xored with a slave specific pattern.
+ *
+ * @param[in] cs        the slave
+ * @param[in] w         the word sent by the master
+ */
+#define SIM_SPI_RESPONSE(cs, w) ((uint8_t)((w) ^ (0xA0U | (uint32_t)(cs))))
+
+/**
+ * @brief   Clears the bus events log.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @api
+ */
+#define simSpiClearLog(spip) ((spip)->logn = 0U)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if USE_SIM_SPI1 && !defined(__DOXYGEN__)
+extern SPIDriver SPID1;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  bool spi_lld_interrupt_pending(void);
+  void spi_lld_init(void);
+  void spi_lld_start(SPIDriver *spip);
+  void spi_lld_stop(SPIDriver *spip);
+  void spi_lld_select(SPIDriver *spip);
+  void spi_lld_unselect(SPIDriver *spip);
+  void spi_lld_ignore(SPIDriver *spip, size_t n);
+  void spi_lld_exchange(SPIDriver *spip, size_t n,
+                        const void *txbuf, void *rxbuf);
+  void spi_lld_send(SPIDriver *spip, size_t n, const void *txbuf);
+  void spi_lld_receive(SPIDriver *spip, size_t n, void *rxbuf);
+  uint16_t spi_lld_polled_exchange(SPIDriver *spip, uint16_t frame);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_SPI */
+
+#endif /* _SPI_LLD_H_ */
+
+/** @} */
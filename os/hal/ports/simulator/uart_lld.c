@@ -0,0 +1,359 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    uart_lld.c
+ * @brief   Simulator low level UART driver code.
+ * @details The characters put on the simulated line using
+ *          @p simUartReceive() are received at the next simulated
+ *          interrupts, @p SIM_UART_BURST characters at time. Transmitted
+ *          characters are discarded, a transmission completes at the next
+ *          simulated interrupt.
+ *
+ * @addtogroup UART
+ * @{
+ */
+
+#include "hal.h"
+
+#if HAL_USE_UART || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Simulated UART driver 1.
+ */
+#if USE_SIM_UART1 || defined(__DOXYGEN__)
+UARTDriver UARTD1;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Puts the receiver in the UART_RX_IDLE state.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ */
+static void uart_enter_rx_idle_loop(UARTDriver *uartp) {
+
+  uartp->rxp = NULL;
+  uartp->rxn = 0U;
+}
+
+/**
+ * @brief   Receives a character from the simulated line.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @param[in] c         the character
+ */
+static void uart_lld_receive_char(UARTDriver *uartp, uint8_t c) {
+
+  uartp->rxcount++;
+
+  if (_uart_rx_frame_running(uartp)) {
+    /* Circular buffer, the half and full marks are reported as a DMA
+       would do.*/
+    uartp->ring[uartp->ringsize - uartp->ringrem] = c;
+    if (--uartp->ringrem == 0U) {
+      uartp->ringrem = uartp->ringsize;
+      _uart_rx_frame_isr(uartp, false);
+    }
+    else if (uartp->ringrem == uartp->ringsize - (uartp->ringsize / 2U)) {
+      _uart_rx_frame_isr(uartp, false);
+    }
+  }
+  else if (uartp->rxn > 0U) {
+    *uartp->rxp++ = c;
+    if (--uartp->rxn == 0U) {
+      _uart_rx_complete_isr_code(uartp);
+    }
+  }
+  else {
+    uartp->rxbuf = c;
+    _uart_rx_idle_code(uartp);
+  }
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Simulated UART interrupt.
+ *
+ * @return              The interrupt status.
+ * @retval false        nothing happened on the line.
+ * @retval true         characters have been received or transmitted.
+ *
+ * @notapi
+ */
+bool uart_lld_interrupt_pending(void) {
+  UARTDriver *uartp = &UARTD1;
+  size_t n;
+
+  if ((uartp->state != UART_READY) ||
+      ((uartp->wiren == 0U) && !uartp->idlepend && (uartp->txn == 0U))) {
+    return false;
+  }
+
+  OSAL_IRQ_PROLOGUE();
+
+  if (uartp->txn > 0U) {
+    uartp->txcount += uartp->txn;
+    uartp->txn = 0U;
+    _uart_tx1_isr_code(uartp);
+    _uart_tx2_isr_code(uartp);
+  }
+
+  n = uartp->wiren < SIM_UART_BURST ? uartp->wiren : SIM_UART_BURST;
+  while (n-- > 0U) {
+    uint8_t c = uartp->wire[uartp->wirerd];
+
+    if (++uartp->wirerd >= SIM_UART_WIRE_SIZE) {
+      uartp->wirerd = 0U;
+    }
+    uartp->wiren--;
+    uart_lld_receive_char(uartp, c);
+  }
+
+  if ((uartp->wiren == 0U) && uartp->idlepend) {
+    uartp->idlepend = false;
+    if (_uart_rx_frame_running(uartp)) {
+      _uart_rx_frame_isr(uartp, true);
+    }
+  }
+
+  OSAL_IRQ_EPILOGUE();
+
+  return true;
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Puts characters on the simulated line.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @param[in] bp        pointer to the characters
+ * @param[in] n         number of characters
+ * @param[in] idle      the line goes idle after the last character
+ * @return              The number of characters accepted, the idle
+ *                      condition is only raised if all the characters
+ *                      have been accepted.
+ *
+ * @api
+ */
+size_t simUartReceive(UARTDriver *uartp, const uint8_t *bp, size_t n,
+                      bool idle) {
+  size_t i;
+
+  osalDbgCheck((uartp != NULL) && (bp != NULL));
+
+  osalSysLock();
+  for (i = 0U; (i < n) && (uartp->wiren < SIM_UART_WIRE_SIZE); i++) {
+    size_t wr = uartp->wirerd + uartp->wiren;
+
+    if (wr >= SIM_UART_WIRE_SIZE) {
+      wr -= SIM_UART_WIRE_SIZE;
+    }
+    uartp->wire[wr] = bp[i];
+    uartp->wiren++;
+  }
+  if (idle && (i == n)) {
+    uartp->idlepend = true;
+  }
+  osalSysUnlock();
+
+  return i;
+}
+
+/**
+ * @brief   Low level UART driver initialization.
+ *
+ * @notapi
+ */
+void uart_lld_init(void) {
+
+  uartObjectInit(&UARTD1);
+  UARTD1.wirerd   = 0U;
+  UARTD1.wiren    = 0U;
+  UARTD1.idlepend = false;
+  UARTD1.txn      = 0U;
+  UARTD1.rxcount  = 0U;
+  UARTD1.txcount  = 0U;
+  uart_enter_rx_idle_loop(&UARTD1);
+}
+
+/**
+ * @brief   Configures and activates the UART peripheral.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ *
+ * @notapi
+ */
+void uart_lld_start(UARTDriver *uartp) {
+
+  uartp->txn = 0U;
+  uart_enter_rx_idle_loop(uartp);
+}
+
+/**
+ * @brief   Deactivates the UART peripheral.
+ * @note    The characters on the simulated line are lost.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ *
+ * @notapi
+ */
+void uart_lld_stop(UARTDriver *uartp) {
+
+  uartp->wiren    = 0U;
+  uartp->idlepend = false;
+  uartp->txn      = 0U;
+  uart_enter_rx_idle_loop(uartp);
+}
+
+/**
+ * @brief   Starts a transmission on the UART peripheral.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @param[in] n         number of data frames to send
+ * @param[in] txbuf     the pointer to the transmit buffer
+ *
+ * @notapi
+ */
+void uart_lld_start_send(UARTDriver *uartp, size_t n, const void *txbuf) {
+
+  (void)txbuf;
+
+  uartp->txn = n;
+}
+
+/**
+ * @brief   Stops any ongoing transmission.
+ * @note    Stopping a transmission also suppresses the transmission callbacks.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ *
+ * @return              The number of data frames not transmitted by the
+ *                      stopped transmit operation.
+ *
+ * @notapi
+ */
+size_t uart_lld_stop_send(UARTDriver *uartp) {
+  size_t n = uartp->txn;
+
+  uartp->txn = 0U;
+
+  return n;
+}
+
+/**
+ * @brief   Starts a receive operation on the UART peripheral.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @param[in] n         number of data frames to receive
+ * @param[out] rxbuf    the pointer to the receive buffer
+ *
+ * @notapi
+ */
+void uart_lld_start_receive(UARTDriver *uartp, size_t n, void *rxbuf) {
+
+  uartp->rxp = (uint8_t *)rxbuf;
+  uartp->rxn = n;
+}
+
+/**
+ * @brief   Stops any ongoing receive operation.
+ * @note    Stopping a receive operation also suppresses the receive callbacks.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ *
+ * @return              The number of data frames not received by the
+ *                      stopped receive operation.
+ *
+ * @notapi
+ */
+size_t uart_lld_stop_receive(UARTDriver *uartp) {
+  size_t n = uartp->rxn;
+
+  uart_enter_rx_idle_loop(uartp);
+
+  return n;
+}
+
+#if (UART_USE_FRAMES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Starts a continuous receive operation into a circular buffer.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @param[in] n         size of the circular buffer
+ * @param[out] ring     pointer to the circular buffer
+ *
+ * @notapi
+ */
+void uart_lld_start_ring(UARTDriver *uartp, size_t n, uint8_t *ring) {
+
+  uart_enter_rx_idle_loop(uartp);
+  uartp->ring     = ring;
+  uartp->ringsize = n;
+  uartp->ringrem  = n;
+}
+
+/**
+ * @brief   Stops the continuous receive operation.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ *
+ * @notapi
+ */
+void uart_lld_stop_ring(UARTDriver *uartp) {
+
+  uartp->ring = NULL;
+}
+
+/**
+ * @brief   Returns the space left before the end of the circular buffer.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @return              The number of bytes to be received before the
+ *                      circular buffer wraps.
+ *
+ * @notapi
+ */
+size_t uart_lld_get_ring_remaining(UARTDriver *uartp) {
+
+  return uartp->ringrem;
+}
+#endif /* UART_USE_FRAMES == TRUE */
+
+#endif /* HAL_USE_UART */
+
+/** @} */
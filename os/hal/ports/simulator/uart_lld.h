@@ -0,0 +1,306 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    uart_lld.h
+ * @brief   Simulator low level UART driver header.
+ *
+ * @addtogroup UART
+ * @{
+ */
+
+#ifndef _UART_LLD_H_
+#define _UART_LLD_H_
+
+#if HAL_USE_UART || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   This implementation supports the framed receive mode.
+ */
+#define UART_SUPPORTS_FRAMES                TRUE
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Configuration options
+ * @{
+ */
+/**
+ * @brief   UARTD1 driver enable switch.
+ * @details If set to @p TRUE the support for UARTD1 is included.
+ * @note    The default is @p TRUE.
+ */
+#if !defined(USE_SIM_UART1) || defined(__DOXYGEN__)
+#define USE_SIM_UART1                       TRUE
+#endif
+
+/**
+ * @brief   Size of the simulated line buffer.
+ */
+#if !defined(SIM_UART_WIRE_SIZE) || defined(__DOXYGEN__)
+#define SIM_UART_WIRE_SIZE                  256
+#endif
+
+/**
+ * @brief   Characters received on each simulated interrupt.
+ */
+#if !defined(SIM_UART_BURST) || defined(__DOXYGEN__)
+#define SIM_UART_BURST                      16
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if !USE_SIM_UART1
+#error "UART driver activated but no UART peripheral assigned"
+#endif
+
+#if (SIM_UART_WIRE_SIZE < 1) || (SIM_UART_BURST < 1)
+#error "invalid simulated UART settings"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   UART driver condition flags type.
+ */
+typedef uint32_t uartflags_t;
+
+/**
+ * @brief   Type of structure representing an UART driver.
+ */
+typedef struct UARTDriver UARTDriver;
+
+/**
+ * @brief   Generic UART notification callback type.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ */
+typedef void (*uartcb_t)(UARTDriver *uartp);
+
+/**
+ * @brief   Character received UART notification callback type.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @param[in] c         received character
+ */
+typedef void (*uartccb_t)(UARTDriver *uartp, uint16_t c);
+
+/**
+ * @brief   Receive error UART notification callback type.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @param[in] e         receive error mask
+ */
+typedef void (*uartecb_t)(UARTDriver *uartp, uartflags_t e);
+
+/**
+ * @brief   Driver configuration structure.
+ */
+typedef struct {
+  /**
+   * @brief End of transmission buffer callback.
+   */
+  uartcb_t                  txend1_cb;
+  /**
+   * @brief Physical end of transmission callback.
+   */
+  uartcb_t                  txend2_cb;
+  /**
+   * @brief Receive buffer filled callback.
+   */
+  uartcb_t                  rxend_cb;
+  /**
+   * @brief Character received while out if the @p UART_RECEIVE state.
+   */
+  uartccb_t                 rxchar_cb;
+  /**
+   * @brief Receive error callback.
+   */
+  uartecb_t                 rxerr_cb;
+  /* End of the mandatory fields.*/
+} UARTConfig;
+
+/**
+ * @brief   Structure representing an UART driver.
+ * @note    The simulated line carries 8 bits characters only.
+ */
+struct UARTDriver {
+  /**
+   * @brief Driver state.
+   */
+  uartstate_t               state;
+  /**
+   * @brief Transmitter state.
+   */
+  uarttxstate_t             txstate;
+  /**
+   * @brief Receiver state.
+   */
+  uartrxstate_t             rxstate;
+  /**
+   * @brief Current configuration data.
+   */
+  const UARTConfig          *config;
+#if (UART_USE_WAIT == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Synchronization flag for transmit operations.
+   */
+  bool                      early;
+  /**
+   * @brief   Waiting thread on RX.
+   */
+  thread_reference_t        threadrx;
+  /**
+   * @brief   Waiting thread on TX.
+   */
+  thread_reference_t        threadtx;
+#endif /* UART_USE_WAIT */
+#if (UART_USE_MUTUAL_EXCLUSION == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Mutex protecting the peripheral.
+   */
+  mutex_t                   mutex;
+#endif /* UART_USE_MUTUAL_EXCLUSION */
+#if (UART_USE_FRAMES == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Framed receive configuration.
+   */
+  const UARTFrameConfig     *frcfg;
+  /**
+   * @brief   Circular buffer read index.
+   */
+  size_t                    frrdidx;
+  /**
+   * @brief   Size of the frame being assembled.
+   */
+  size_t                    frn;
+  /**
+   * @brief   The frame being assembled is going to be dropped.
+   */
+  bool                      frdiscard;
+  /**
+   * @brief   Frames dropped because too long or because the queue was full.
+   */
+  uint32_t                  frdropped;
+#endif /* UART_USE_FRAMES */
+#if defined(UART_DRIVER_EXT_FIELDS)
+  UART_DRIVER_EXT_FIELDS
+#endif
+  /* End of the mandatory fields.*/
+  /**
+   * @brief Characters on the simulated line.
+   */
+  uint8_t                   wire[SIM_UART_WIRE_SIZE];
+  /**
+   * @brief Next character to be received from the line.
+   */
+  size_t                    wirerd;
+  /**
+   * @brief Number of characters on the line.
+   */
+  size_t                    wiren;
+  /**
+   * @brief The line goes idle after the last character.
+   */
+  bool                      idlepend;
+  /**
+   * @brief Default receive buffer while into @p UART_RX_IDLE state.
+   */
+  volatile uint16_t         rxbuf;
+  /**
+   * @brief Receive buffer pointer.
+   */
+  uint8_t                   *rxp;
+  /**
+   * @brief Characters still to be received in the receive buffer.
+   */
+  size_t                    rxn;
+  /**
+   * @brief Circular buffer pointer.
+   */
+  uint8_t                   *ring;
+  /**
+   * @brief Circular buffer size.
+   */
+  size_t                    ringsize;
+  /**
+   * @brief Characters still to be received before the circular buffer wraps.
+   */
+  size_t                    ringrem;
+  /**
+   * @brief Characters still to be transmitted.
+   */
+  size_t                    txn;
+  /**
+   * @brief Characters received.
+   */
+  uint32_t                  rxcount;
+  /**
+   * @brief Characters transmitted.
+   */
+  uint32_t                  txcount;
+};
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if USE_SIM_UART1 && !defined(__DOXYGEN__)
+extern UARTDriver UARTD1;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  bool uart_lld_interrupt_pending(void);
+  size_t simUartReceive(UARTDriver *uartp, const uint8_t *bp, size_t n,
+                        bool idle);
+  void uart_lld_init(void);
+  void uart_lld_start(UARTDriver *uartp);
+  void uart_lld_stop(UARTDriver *uartp);
+  void uart_lld_start_send(UARTDriver *uartp, size_t n, const void *txbuf);
+  size_t uart_lld_stop_send(UARTDriver *uartp);
+  void uart_lld_start_receive(UARTDriver *uartp, size_t n, void *rxbuf);
+  size_t uart_lld_stop_receive(UARTDriver *uartp);
+#if UART_USE_FRAMES == TRUE
+  void uart_lld_start_ring(UARTDriver *uartp, size_t n, uint8_t *ring);
+  void uart_lld_stop_ring(UARTDriver *uartp);
+  size_t uart_lld_get_ring_remaining(UARTDriver *uartp);
+#endif
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_UART */
+
+#endif /* _UART_LLD_H_ */
+
+/** @} */
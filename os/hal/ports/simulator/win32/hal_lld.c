@@ -32,9 +32,41 @@
 /* Driver local variables and types.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Type of a simulated interrupt source.
+ * @details The function serves the pending interrupt of a simulated
+ *          peripheral, if any, and returns @p true if it did.
+ */
+typedef bool (*sim_irq_source_t)(void);
+
 static LARGE_INTEGER nextcnt;
 static LARGE_INTEGER slice;
 
+/**
+ * @brief   Simulated peripherals interrupt sources.
+ */
+static const sim_irq_source_t sim_irq_sources[] = {
+#if HAL_USE_ADC
+  adc_lld_interrupt_pending,
+#endif
+#if HAL_USE_CAN
+  can_lld_interrupt_pending,
+#endif
+#if HAL_USE_I2C
+  i2c_lld_interrupt_pending,
+#endif
+#if HAL_USE_SDC
+  sdc_lld_interrupt_pending,
+#endif
+#if HAL_USE_SPI
+  spi_lld_interrupt_pending,
+#endif
+#if HAL_USE_UART
+  uart_lld_interrupt_pending,
+#endif
+  NULL
+};
+
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
@@ -75,6 +107,7 @@ void hal_lld_init(void) {
  * @brief   Interrupt simulation.
  */
 void _sim_check_for_interrupts(void) {
+  sim_irq_source_t const *isrp;
   LARGE_INTEGER n;
 
 #if HAL_USE_SERIAL
@@ -87,6 +120,17 @@ void _sim_check_for_interrupts(void) {
   }
 #endif
 
+  /* Simulated peripherals, all the pending sources are served, a busy
+     peripheral must not starve the others or the timer simulation.*/
+  for (isrp = sim_irq_sources; *isrp != NULL; isrp++) {
+    if ((*isrp)()) {
+      _dbg_check_lock();
+      if (chSchIsPreemptionRequired())
+        chSchDoReschedule();
+      _dbg_check_unlock();
+    }
+  }
+
   /* Interrupt Timer simulation (10ms interval).*/
   QueryPerformanceCounter(&n);
   if (n.QuadPart > nextcnt.QuadPart) {
@@ -1,9 +1,16 @@
 # List of all the Win32 platform files.
 PLATFORMSRC = ${CHIBIOS}/os/hal/ports/simulator/win32/hal_lld.c \
               ${CHIBIOS}/os/hal/ports/simulator/win32/serial_lld.c \
+              ${CHIBIOS}/os/hal/ports/simulator/adc_lld.c \
+              ${CHIBIOS}/os/hal/ports/simulator/can_lld.c \
               ${CHIBIOS}/os/hal/ports/simulator/console.c \
+              ${CHIBIOS}/os/hal/ports/simulator/i2c_lld.c \
+              ${CHIBIOS}/os/hal/ports/simulator/mac_lld.c \
               ${CHIBIOS}/os/hal/ports/simulator/pal_lld.c \
-              ${CHIBIOS}/os/hal/ports/simulator/st_lld.c
+              ${CHIBIOS}/os/hal/ports/simulator/sdc_lld.c \
+              ${CHIBIOS}/os/hal/ports/simulator/spi_lld.c \
+              ${CHIBIOS}/os/hal/ports/simulator/st_lld.c \
+              ${CHIBIOS}/os/hal/ports/simulator/uart_lld.c
 
 # Required include directories
 PLATFORMINC = ${CHIBIOS}/os/hal/ports/simulator/win32 \
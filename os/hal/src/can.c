@@ -42,6 +42,101 @@
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+#if (CAN_USE_TX_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Transmit queue ordering.
+ *
+ * @param[in] a         pointer to the first entry
+ * @param[in] b         pointer to the second entry
+ * @return              The ordering.
+ * @retval true         if the first entry must be transmitted first.
+ * @retval false        otherwise.
+ *
+ * @notapi
+ */
+static bool txq_before(const CANTxQueueEntry *a, const CANTxQueueEntry *b) {
+
+  if (a->key != b->key) {
+    return a->key < b->key;
+  }
+  return (int32_t)(a->seq - b->seq) < 0;
+}
+
+/**
+ * @brief   Inserts a frame in a transmit queue.
+ * @pre     The queue must not be full.
+ *
+ * @param[in] tqp       pointer to the @p CANTxQueue object
+ * @param[in] ctfp      pointer to the CAN frame
+ *
+ * @notapi
+ */
+static void txq_insert(CANTxQueue *tqp, const CANTxFrame *ctfp) {
+  CANTxQueueEntry *buf = tqp->buffer;
+  size_t i, parent;
+
+  /* The new entry bubbles up from the bottom of the heap.*/
+  i = tqp->counter;
+  buf[i].key   = _can_arbitration_key(ctfp);
+  buf[i].seq   = tqp->seq++;
+  buf[i].frame = *ctfp;
+  while (i > 0U) {
+    CANTxQueueEntry tmp;
+
+    parent = (i - 1U) / 2U;
+    if (!txq_before(&buf[i], &buf[parent])) {
+      break;
+    }
+    tmp         = buf[parent];
+    buf[parent] = buf[i];
+    buf[i]      = tmp;
+    i = parent;
+  }
+
+  tqp->counter++;
+  if (tqp->counter > tqp->maxdepth) {
+    tqp->maxdepth = tqp->counter;
+  }
+}
+
+/**
+ * @brief   Removes the first frame of a transmit queue.
+ * @pre     The queue must not be empty.
+ *
+ * @param[in] tqp       pointer to the @p CANTxQueue object
+ *
+ * @notapi
+ */
+static void txq_remove(CANTxQueue *tqp) {
+  CANTxQueueEntry *buf = tqp->buffer;
+  CANTxQueueEntry *last;
+  size_t i, child;
+
+  /* The last entry sinks down from the top of the heap.*/
+  tqp->counter--;
+  last = &buf[tqp->counter];
+  i = 0U;
+  while (true) {
+    child = (2U * i) + 1U;
+    if (child >= tqp->counter) {
+      break;
+    }
+    if (((child + 1U) < tqp->counter) &&
+        txq_before(&buf[child + 1U], &buf[child])) {
+      child++;
+    }
+    if (!txq_before(&buf[child], last)) {
+      break;
+    }
+    buf[i] = buf[child];
+    i = child;
+  }
+  if (i != tqp->counter) {
+    buf[i] = *last;
+  }
+}
+#endif /* CAN_USE_TX_QUEUE == TRUE */
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -78,6 +173,14 @@ void canObjectInit(CANDriver *canp) {
   osalEventObjectInit(&canp->sleep_event);
   osalEventObjectInit(&canp->wakeup_event);
 #endif
+#if CAN_USE_RX_QUEUES == TRUE
+  canp->rxqueues   = NULL;
+  canp->rxoverruns = 0U;
+  canp->rxunrouted = 0U;
+#endif
+#if CAN_USE_TX_QUEUE == TRUE
+  canp->txq        = NULL;
+#endif
 }
 
 /**
@@ -135,6 +238,22 @@ void canStop(CANDriver *canp) {
      stopped in order to not have stuck threads.*/
   osalThreadDequeueAllI(&canp->rxqueue, MSG_RESET);
   osalThreadDequeueAllI(&canp->txqueue, MSG_RESET);
+#if CAN_USE_RX_QUEUES == TRUE
+  {
+    CANRxQueue *rqp;
+
+    for (rqp = canp->rxqueues; rqp != NULL; rqp = rqp->next) {
+      osalThreadDequeueAllI(&rqp->waiting, MSG_RESET);
+    }
+  }
+#endif
+#if CAN_USE_TX_QUEUE == TRUE
+  /* Queued frames are discarded.*/
+  if (canp->txq != NULL) {
+    canp->txq->counter  = 0U;
+    canp->txq->mbloaded = 0U;
+  }
+#endif
   osalOsRescheduleS();
   osalSysUnlock();
 }
@@ -163,6 +282,13 @@ bool canTryTransmitI(CANDriver *canp,
   osalDbgAssert((canp->state == CAN_READY) || (canp->state == CAN_SLEEP),
                 "invalid state");
 
+#if CAN_USE_TX_QUEUE == TRUE
+  /* With a transmit queue the mailbox is chosen by the driver.*/
+  if ((mailbox == CAN_ANY_MAILBOX) && (canp->txq != NULL)) {
+    return canTransmitI(canp, ctfp);
+  }
+#endif
+
   /* If the RX mailbox is full then the function fails.*/
   if (!can_lld_is_tx_empty(canp, mailbox)) {
     return true;
@@ -241,6 +367,26 @@ msg_t canTransmit(CANDriver *canp,
   osalDbgAssert((canp->state == CAN_READY) || (canp->state == CAN_SLEEP),
                 "invalid state");
 
+#if CAN_USE_TX_QUEUE == TRUE
+  /* With a transmit queue the thread waits for queue space, not for
+     a mailbox.*/
+  if ((mailbox == CAN_ANY_MAILBOX) && (canp->txq != NULL)) {
+    while (canp->txq->counter >= canp->txq->size) {
+      msg_t msg = osalThreadEnqueueTimeoutS(&canp->txqueue, timeout);
+      if (msg != MSG_OK) {
+        osalSysUnlock();
+        return msg;
+      }
+    }
+    txq_insert(canp->txq, ctfp);
+    if (canp->state != CAN_SLEEP) {
+      _can_tx_refill_i(canp);
+    }
+    osalSysUnlock();
+    return MSG_OK;
+  }
+#endif
+
   /*lint -save -e9007 [13.5] Right side is supposed to be pure.*/
   while ((canp->state == CAN_SLEEP) || !can_lld_is_tx_empty(canp, mailbox)) {
   /*lint -restore*/
@@ -303,6 +449,360 @@ msg_t canReceive(CANDriver *canp,
   return MSG_OK;
 }
 
+/**
+ * @brief   Programs the acceptance filters.
+ * @details The index of each filter in the array is reported in the
+ *          @p FMI field of the frames it accepts.
+ * @note    The number of available filters depends on the implementation,
+ *          on some devices the filters are shared between more drivers.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] afp       pointer to the filters array, can be @p NULL if
+ *                      (num == 0)
+ * @param[in] num       number of entries in the filters array, if zero then
+ *                      all frames are accepted
+ *
+ * @api
+ */
+void canSetAcceptanceFilters(CANDriver *canp,
+                             const CANAcceptanceFilter *afp,
+                             uint32_t num) {
+
+  osalDbgCheck((canp != NULL) && ((afp != NULL) || (num == 0U)));
+
+  osalSysLock();
+  osalDbgAssert(canp->state == CAN_STOP, "invalid state");
+  can_lld_set_acceptance_filters(canp, afp, num);
+  osalSysUnlock();
+}
+
+#if (CAN_USE_RX_QUEUES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes a @p CANRxQueue object.
+ *
+ * @param[out] rqp      pointer to the @p CANRxQueue object
+ * @param[in] buffer    pointer to the frames buffer
+ * @param[in] size      buffer size in frames
+ * @param[in] filters   mask of the filters routed to this queue, zero for
+ *                      the frames not routed to other queues
+ *
+ * @init
+ */
+void canRxQueueObjectInit(CANRxQueue *rqp, CANRxFrame *buffer,
+                          size_t size, uint32_t filters) {
+
+  osalDbgCheck((rqp != NULL) && (buffer != NULL) && (size > 0U));
+
+  rqp->next     = NULL;
+  rqp->buffer   = buffer;
+  rqp->size     = size;
+  rqp->rdidx    = 0U;
+  rqp->wridx    = 0U;
+  rqp->counter  = 0U;
+  rqp->filters  = filters;
+  rqp->overruns = 0U;
+  osalThreadQueueObjectInit(&rqp->waiting);
+}
+
+/**
+ * @brief   Attaches a receive queue to a driver.
+ * @details After the first queue has been attached the received frames
+ *          are moved by the driver ISR into the queues, frames routed to
+ *          no queue are discarded and counted. Frames must then be fetched
+ *          using @p canReceiveMany(), @p canReceive() is no more usable.
+ * @note    Queues must be attached before starting the driver and cannot
+ *          be detached.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] rqp       pointer to the @p CANRxQueue object
+ *
+ * @api
+ */
+void canAddRxQueue(CANDriver *canp, CANRxQueue *rqp) {
+  CANRxQueue **rqpp;
+
+  osalDbgCheck((canp != NULL) && (rqp != NULL));
+
+  osalSysLock();
+  osalDbgAssert(canp->state == CAN_STOP, "invalid state");
+
+  /* Appended, the first catch-all queue in the list receives the frames
+     not routed elsewhere.*/
+  rqpp = &canp->rxqueues;
+  while (*rqpp != NULL) {
+    rqpp = &(*rqpp)->next;
+  }
+  rqp->next = NULL;
+  *rqpp = rqp;
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Receives multiple frames from a receive queue.
+ * @details The function waits until at least a frame is available then
+ *          fetches all the available frames, up to @p n.
+ * @note    Trying to receive while in sleep mode simply enqueues the thread.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] rqp       pointer to the @p CANRxQueue object
+ * @param[out] crfp     pointer to the buffer where the frames are copied
+ * @param[in] n         maximum number of frames to be fetched
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of frames fetched, zero if the operation
+ *                      timed out or the driver has been stopped.
+ *
+ * @api
+ */
+size_t canReceiveMany(CANDriver *canp, CANRxQueue *rqp,
+                      CANRxFrame *crfp, size_t n, systime_t timeout) {
+  size_t i;
+
+  osalDbgCheck((canp != NULL) && (rqp != NULL) && (crfp != NULL) &&
+               (n > 0U));
+
+  osalSysLock();
+  osalDbgAssert((canp->state == CAN_READY) || (canp->state == CAN_SLEEP),
+                "invalid state");
+
+  while (rqp->counter == 0U) {
+    msg_t msg = osalThreadEnqueueTimeoutS(&rqp->waiting, timeout);
+    if (msg != MSG_OK) {
+      osalSysUnlock();
+      return 0U;
+    }
+  }
+
+  /* Frames are copied one at time in order to not keep the critical zone
+     too long.*/
+  i = 0U;
+  while ((i < n) && (rqp->counter > 0U)) {
+    crfp[i] = rqp->buffer[rqp->rdidx];
+    if (++rqp->rdidx >= rqp->size) {
+      rqp->rdidx = 0U;
+    }
+    rqp->counter--;
+    i++;
+    osalSysUnlock();
+    osalSysLock();
+  }
+  osalSysUnlock();
+  return i;
+}
+
+/**
+ * @brief   Routes a received frame to a receive queue.
+ * @note    This function is meant to be called by the low level driver
+ *          ISR for each received frame when queues are attached.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] crfp      pointer to the received frame
+ *
+ * @notapi
+ */
+void _can_rx_enqueue_i(CANDriver *canp, const CANRxFrame *crfp) {
+  CANRxQueue *rqp, *anyqp = NULL;
+  uint32_t fmask;
+
+  osalDbgCheckClassI();
+
+  /* Searching the queue associated to the filter that accepted the frame,
+     the first catch-all queue is taken if there is none.*/
+  fmask = crfp->FMI < 32U ? 1U << crfp->FMI : 0U;
+  for (rqp = canp->rxqueues; rqp != NULL; rqp = rqp->next) {
+    if (rqp->filters == 0U) {
+      if (anyqp == NULL) {
+        anyqp = rqp;
+      }
+    }
+    else if ((rqp->filters & fmask) != 0U) {
+      break;
+    }
+  }
+  if (rqp == NULL) {
+    rqp = anyqp;
+    if (rqp == NULL) {
+      canp->rxunrouted++;
+      return;
+    }
+  }
+
+  if (rqp->counter >= rqp->size) {
+    rqp->overruns++;
+    return;
+  }
+  rqp->buffer[rqp->wridx] = *crfp;
+  if (++rqp->wridx >= rqp->size) {
+    rqp->wridx = 0U;
+  }
+  rqp->counter++;
+  osalThreadDequeueNextI(&rqp->waiting, MSG_OK);
+}
+#endif /* CAN_USE_RX_QUEUES == TRUE */
+
+#if (CAN_USE_TX_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes a @p CANTxQueue object.
+ *
+ * @param[out] tqp      pointer to the @p CANTxQueue object
+ * @param[in] buffer    pointer to the entries buffer
+ * @param[in] size      buffer size in entries
+ *
+ * @init
+ */
+void canTxQueueObjectInit(CANTxQueue *tqp, CANTxQueueEntry *buffer,
+                          size_t size) {
+
+  osalDbgCheck((tqp != NULL) && (buffer != NULL) && (size > 0U));
+
+  tqp->buffer    = buffer;
+  tqp->size      = size;
+  tqp->counter   = 0U;
+  tqp->seq       = 0U;
+  tqp->mbloaded  = 0U;
+  tqp->maxdepth  = 0U;
+  tqp->overflows = 0U;
+}
+
+/**
+ * @brief   Associates a transmit queue to a driver.
+ * @details After the queue has been associated the frames transmitted on
+ *          @p CAN_ANY_MAILBOX are queued, the driver moves them into the
+ *          mailboxes as these become available, the frame with the highest
+ *          arbitration priority first. Frames with the same identifier
+ *          keep their order. Transmissions on a specific mailbox bypass
+ *          the queue.
+ * @note    The queue must be associated before starting the driver.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] tqp       pointer to the @p CANTxQueue object
+ *
+ * @api
+ */
+void canSetTxQueue(CANDriver *canp, CANTxQueue *tqp) {
+
+  osalDbgCheck((canp != NULL) && (tqp != NULL));
+
+  osalSysLock();
+  osalDbgAssert(canp->state == CAN_STOP, "invalid state");
+  canp->txq = tqp;
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Queues a frame for transmission.
+ * @details The frame is inserted in the driver transmit queue, if a mailbox
+ *          is available then it is transmitted immediately.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] ctfp      pointer to the CAN frame to be transmitted
+ * @return              The operation result.
+ * @retval false        Frame queued.
+ * @retval true         Queue full, the frame is counted as refused.
+ *
+ * @iclass
+ */
+bool canTransmitI(CANDriver *canp, const CANTxFrame *ctfp) {
+  CANTxQueue *tqp;
+
+  osalDbgCheckClassI();
+  osalDbgCheck((canp != NULL) && (ctfp != NULL));
+  osalDbgAssert((canp->state == CAN_READY) || (canp->state == CAN_SLEEP),
+                "invalid state");
+  osalDbgAssert(canp->txq != NULL, "no transmit queue");
+
+  tqp = canp->txq;
+  if (tqp->counter >= tqp->size) {
+    tqp->overflows++;
+    return true;
+  }
+  txq_insert(tqp, ctfp);
+  if (canp->state != CAN_SLEEP) {
+    _can_tx_refill_i(canp);
+  }
+
+  return false;
+}
+
+/**
+ * @brief   Moves queued frames into the free mailboxes.
+ * @details A frame is not moved while a mailbox still holds a frame with
+ *          the same arbitration key, the controller would be free to send
+ *          the two frames in any order.
+ * @note    This function is meant to be called by the low level driver
+ *          transmit ISR, before waking up the waiting threads.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ *
+ * @notapi
+ */
+void _can_tx_refill_i(CANDriver *canp) {
+  CANTxQueue *tqp = canp->txq;
+  canmbx_t mailbox, freembx;
+  uint32_t mask;
+
+  osalDbgCheckClassI();
+
+  if (tqp == NULL) {
+    return;
+  }
+
+  while (tqp->counter > 0U) {
+    freembx = CAN_ANY_MAILBOX;
+    for (mailbox = 1U; mailbox <= (canmbx_t)CAN_TX_MAILBOXES; mailbox++) {
+      mask = CAN_MAILBOX_TO_MASK(mailbox);
+      if (can_lld_is_tx_empty(canp, mailbox)) {
+        tqp->mbloaded &= ~mask;
+        if (freembx == CAN_ANY_MAILBOX) {
+          freembx = mailbox;
+        }
+      }
+      else if (((tqp->mbloaded & mask) != 0U) &&
+               (tqp->mbkeys[mailbox - 1U] == tqp->buffer[0].key)) {
+        /* Same identifier still pending, it goes first.*/
+        return;
+      }
+      else {
+        /* Busy mailbox.*/
+      }
+    }
+    if (freembx == CAN_ANY_MAILBOX) {
+      return;
+    }
+    can_lld_transmit(canp, freembx, &tqp->buffer[0].frame);
+    tqp->mbkeys[freembx - 1U] = tqp->buffer[0].key;
+    tqp->mbloaded |= CAN_MAILBOX_TO_MASK(freembx);
+    txq_remove(tqp);
+  }
+}
+#endif /* CAN_USE_TX_QUEUE == TRUE */
+
+/**
+ * @brief   Returns the arbitration key of a frame.
+ * @details The key follows the order of the arbitration field bits on the
+ *          bus, a lower key wins the arbitration. A standard frame wins
+ *          over an extended frame with the same base identifier and a
+ *          data frame wins over a remote frame.
+ *
+ * @param[in] ctfp      pointer to the CAN frame
+ * @return              The arbitration key.
+ *
+ * @notapi
+ */
+uint32_t _can_arbitration_key(const CANTxFrame *ctfp) {
+
+  if (ctfp->IDE != 0U) {
+    /* Base identifier, recessive SRR and IDE, extension, RTR.*/
+    return (((uint32_t)ctfp->EID >> 18U) << 21U) | (3U << 19U) |
+           (((uint32_t)ctfp->EID & 0x3FFFFU) << 1U) | (uint32_t)ctfp->RTR;
+  }
+  /* Base identifier, RTR, dominant IDE.*/
+  return ((uint32_t)ctfp->SID << 21U) | ((uint32_t)ctfp->RTR << 20U);
+}
+
 #if (CAN_USE_SLEEP_MODE == TRUE) || defined(__DOXYGEN__)
 /**
  * @brief   Enters the sleep mode.
@@ -349,6 +849,9 @@ void canWakeup(CANDriver *canp) {
   if (canp->state == CAN_SLEEP) {
     can_lld_wakeup(canp);
     canp->state = CAN_READY;
+#if CAN_USE_TX_QUEUE == TRUE
+    _can_tx_refill_i(canp);
+#endif
     osalEventBroadcastFlagsI(&canp->wakeup_event, (eventflags_t)0);
     osalOsRescheduleS();
   }
@@ -45,6 +45,23 @@
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+#if (I2C_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Starts the transaction at the queue head.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ *
+ * @notapi
+ */
+static void i2c_queue_begin_i(I2CDriver *i2cp) {
+  I2CTransaction *itp = i2cp->qhead;
+
+  i2cp->state = itp->txbytes > 0U ? I2C_ACTIVE_TX : I2C_ACTIVE_RX;
+  i2c_lld_start_transfer(i2cp, itp->addr, itp->txbuf, itp->txbytes,
+                         itp->rxbuf, itp->rxbytes);
+}
+#endif /* I2C_USE_QUEUE == TRUE */
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -77,6 +94,11 @@ void i2cObjectInit(I2CDriver *i2cp) {
   osalMutexObjectInit(&i2cp->mutex);
 #endif
 
+#if I2C_USE_QUEUE == TRUE
+  i2cp->qhead = NULL;
+  i2cp->qtail = NULL;
+#endif
+
 #if defined(I2C_DRIVER_EXT_INIT_HOOK)
   I2C_DRIVER_EXT_INIT_HOOK(i2cp);
 #endif
@@ -278,6 +300,223 @@ void i2cReleaseBus(I2CDriver *i2cp) {
 }
 #endif /* I2C_USE_MUTUAL_EXCLUSION == TRUE */
 
+#if (I2C_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes an @p I2CTransaction object.
+ * @details The transaction is a write if @p rxbytes is zero, a read if
+ *          @p txbytes is zero, else a write followed by a read. A register
+ *          burst write is a write having the register address as first
+ *          byte.
+ *
+ * @param[out] itp      pointer to the @p I2CTransaction object
+ * @param[in] addr      slave device address (7 bits) without R/W bit
+ * @param[in] txbuf     pointer to the transmit buffer or @p NULL
+ * @param[in] txbytes   number of bytes to be transmitted
+ * @param[out] rxbuf    pointer to the receive buffer or @p NULL
+ * @param[in] rxbytes   number of bytes to be received
+ * @param[in] callback  completion callback or @p NULL
+ *
+ * @init
+ */
+void i2cTransactionObjectInit(I2CTransaction *itp, i2caddr_t addr,
+                              const uint8_t *txbuf, size_t txbytes,
+                              uint8_t *rxbuf, size_t rxbytes,
+                              i2cqcallback_t callback) {
+
+  osalDbgCheck((itp != NULL) && (addr != 0U) &&
+               ((txbytes > 0U) || (rxbytes > 0U)) &&
+               ((txbytes == 0U) || (txbuf != NULL)) &&
+               ((rxbytes == 0U) || (rxbuf != NULL)));
+
+  itp->next     = NULL;
+  itp->addr     = addr;
+  itp->txbuf    = txbuf;
+  itp->txbytes  = txbytes;
+  itp->rxbuf    = rxbuf;
+  itp->rxbytes  = rxbytes;
+  itp->callback = callback;
+  itp->result   = MSG_OK;
+  itp->errors   = I2C_NO_ERROR;
+  itp->pending  = false;
+  itp->thread   = NULL;
+  itp->reg      = 0U;
+}
+
+/**
+ * @brief   Initializes an @p I2CTransaction object as a register burst read.
+ * @details The transaction writes the register address then reads
+ *          @p rxbytes bytes, the address is stored in the transaction
+ *          object itself.
+ *
+ * @param[out] itp      pointer to the @p I2CTransaction object
+ * @param[in] addr      slave device address (7 bits) without R/W bit
+ * @param[in] reg       address of the first register
+ * @param[out] rxbuf    pointer to the receive buffer
+ * @param[in] rxbytes   number of registers to be read
+ * @param[in] callback  completion callback or @p NULL
+ *
+ * @init
+ */
+void i2cRegisterTransactionObjectInit(I2CTransaction *itp, i2caddr_t addr,
+                                      uint8_t reg,
+                                      uint8_t *rxbuf, size_t rxbytes,
+                                      i2cqcallback_t callback) {
+
+  i2cTransactionObjectInit(itp, addr, &itp->reg, 1U,
+                           rxbuf, rxbytes, callback);
+  itp->reg = reg;
+}
+
+/**
+ * @brief   Queues a transaction.
+ * @details If the driver is idle the transaction is started immediately
+ *          else it is started by the ISR after the previously queued ones,
+ *          several transactions can be submitted in a single critical zone.
+ * @pre     In order to use this function the option @p I2C_USE_QUEUE must be
+ *          enabled.
+ * @note    A transaction failing with an I2C error, for example a slave not
+ *          acknowledging, does not stop the queue, the error is reported
+ *          in the transaction object.
+ * @note    Queued transactions and the other operations cannot be mixed,
+ *          the queue must be empty before using the other APIs.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] itp       pointer to the @p I2CTransaction object
+ *
+ * @iclass
+ */
+void i2cSubmitI(I2CDriver *i2cp, I2CTransaction *itp) {
+
+  osalDbgCheckClassI();
+  osalDbgCheck((i2cp != NULL) && (itp != NULL));
+  osalDbgAssert((i2cp->state == I2C_READY) || (i2cp->qhead != NULL),
+                "not ready");
+  osalDbgAssert(!itp->pending, "already queued");
+
+  itp->next    = NULL;
+  itp->pending = true;
+  if (i2cp->qhead == NULL) {
+    i2cp->qhead = itp;
+    i2cp->qtail = itp;
+    i2c_queue_begin_i(i2cp);
+  }
+  else {
+    i2cp->qtail->next = itp;
+    i2cp->qtail = itp;
+  }
+}
+
+/**
+ * @brief   Queues a transaction.
+ * @details If the driver is idle the transaction is started immediately
+ *          else it is started by the ISR after the previously queued ones.
+ * @pre     In order to use this function the option @p I2C_USE_QUEUE must be
+ *          enabled.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] itp       pointer to the @p I2CTransaction object
+ *
+ * @api
+ */
+void i2cSubmit(I2CDriver *i2cp, I2CTransaction *itp) {
+
+  osalSysLock();
+  i2cSubmitI(i2cp, itp);
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Queues a transaction and waits for its completion.
+ * @pre     In order to use this function the option @p I2C_USE_QUEUE must be
+ *          enabled.
+ * @note    On timeout all the queued transactions are discarded with
+ *          result @p MSG_TIMEOUT without invoking their callbacks and the
+ *          driver goes in the @p I2C_LOCKED state.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] itp       pointer to the @p I2CTransaction object
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ *
+ * @return              The operation status.
+ * @retval MSG_OK       if the function succeeded.
+ * @retval MSG_RESET    if one or more I2C errors occurred, the errors can
+ *                      be retrieved from the transaction object.
+ * @retval MSG_TIMEOUT  if a timeout occurred before operation end. <b>After a
+ *                      timeout the driver must be stopped and restarted
+ *                      because the bus is in an uncertain state</b>.
+ *
+ * @api
+ */
+msg_t i2cTransact(I2CDriver *i2cp, I2CTransaction *itp, systime_t timeout) {
+  I2CTransaction *qp;
+  msg_t msg;
+
+  osalDbgCheck(timeout != TIME_IMMEDIATE);
+
+  osalSysLock();
+  i2cSubmitI(i2cp, itp);
+  msg = itp->result;
+  if (itp->pending) {
+    msg = osalThreadSuspendTimeoutS(&itp->thread, timeout);
+    if (msg == MSG_TIMEOUT) {
+      qp = i2cp->qhead;
+      i2cp->qhead = NULL;
+      i2cp->qtail = NULL;
+      i2cp->state = I2C_LOCKED;
+      while (qp != NULL) {
+        qp->pending = false;
+        qp->result  = MSG_TIMEOUT;
+        osalThreadResumeI(&qp->thread, MSG_TIMEOUT);
+        qp = qp->next;
+      }
+      osalOsRescheduleS();
+    }
+  }
+  osalSysUnlock();
+  return msg;
+}
+
+/**
+ * @brief   Queue ISR code.
+ * @details Completes the transaction at the queue head and starts the next
+ *          queued transaction, if any. The transaction callback is invoked
+ *          after starting the next one.
+ * @note    This function is invoked by @p _i2c_wakeup_isr() and
+ *          @p _i2c_wakeup_error_isr().
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] msg       the transaction result
+ *
+ * @notapi
+ */
+void _i2c_queue_isr(I2CDriver *i2cp, msg_t msg) {
+  I2CTransaction *itp;
+
+  osalSysLockFromISR();
+  itp = i2cp->qhead;
+  itp->result  = msg;
+  itp->errors  = i2c_lld_get_errors(i2cp);
+  itp->pending = false;
+  i2cp->qhead = itp->next;
+  if (i2cp->qhead != NULL) {
+    i2c_queue_begin_i(i2cp);
+  }
+  else {
+    i2cp->qtail = NULL;
+    i2cp->state = I2C_READY;
+  }
+  osalThreadResumeI(&itp->thread, msg);
+  osalSysUnlockFromISR();
+
+  if (itp->callback != NULL) {
+    itp->callback(i2cp, itp);
+  }
+}
+#endif /* I2C_USE_QUEUE == TRUE */
+
 #endif /* HAL_USE_I2C == TRUE */
 
 /** @} */
@@ -233,6 +233,9 @@ msg_t macWaitReceiveDescriptor(MACDriver *macp,
  * @brief   Releases a receive descriptor.
  * @details The descriptor and its buffer are made available for more incoming
  *          frames.
+ * @note    In zero-copy mode a descriptor can be kept while its buffer is
+ *          in use and released later, more frames can be obtained in the
+ *          meantime. Descriptors can be released in any order.
  *
  * @param[in] rdp       the pointer to the @p MACReceiveDescriptor structure
  *
@@ -48,20 +48,54 @@ static bool mmc_read(void *instance, uint32_t startblk,
                        uint8_t *buffer, uint32_t n);
 static bool mmc_write(void *instance, uint32_t startblk,
                         const uint8_t *buffer, uint32_t n);
+#if MMC_USE_ASYNC == TRUE
+static bool mmc_queued_read(void *instance, uint32_t startblk,
+                            uint8_t *buffer, uint32_t n);
+static bool mmc_queued_write(void *instance, uint32_t startblk,
+                             const uint8_t *buffer, uint32_t n);
+static bool mmc_queued_sync(void *instance);
+#endif
 
 /**
  * @brief   Virtual methods table.
+ * @note    When @p MMC_USE_ASYNC is @p TRUE the transfers are queued and
+ *          executed by the thread serving the driver.
  */
 static const struct MMCDriverVMT mmc_vmt = {
   (bool (*)(void *))mmc_lld_is_card_inserted,
   (bool (*)(void *))mmc_lld_is_write_protected,
   (bool (*)(void *))mmcConnect,
   (bool (*)(void *))mmcDisconnect,
+#if MMC_USE_ASYNC == TRUE
+  mmc_queued_read,
+  mmc_queued_write,
+  mmc_queued_sync,
+#else
+  mmc_read,
+  mmc_write,
+  (bool (*)(void *))mmcSync,
+#endif
+  (bool (*)(void *, BlockDeviceInfo *))mmcGetInfo,
+  (bool (*)(void *, uint32_t, uint32_t))mmcErase
+};
+
+#if (MMC_USE_ASYNC == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Virtual methods table used by the requests queue.
+ * @details The transfers are executed directly.
+ */
+static const struct MMCDriverVMT mmc_queue_vmt = {
+  (bool (*)(void *))mmc_lld_is_card_inserted,
+  (bool (*)(void *))mmc_lld_is_write_protected,
+  (bool (*)(void *))mmcConnect,
+  (bool (*)(void *))mmcDisconnect,
   mmc_read,
   mmc_write,
   (bool (*)(void *))mmcSync,
-  (bool (*)(void *, BlockDeviceInfo *))mmcGetInfo
+  (bool (*)(void *, BlockDeviceInfo *))mmcGetInfo,
+  (bool (*)(void *, uint32_t, uint32_t))mmcErase
 };
+#endif
 
 /**
  * @brief   Lookup table for CRC-7 ( based on polynomial x^7 + x^3 + 1).
@@ -119,7 +153,7 @@ static bool mmc_read(void *instance, uint32_t startblk,
 static bool mmc_write(void *instance, uint32_t startblk,
                  const uint8_t *buffer, uint32_t n) {
 
-  if (mmcStartSequentialWrite((MMCDriver *)instance, startblk)) {
+  if (mmcStartMultipleWrite((MMCDriver *)instance, startblk, n)) {
     return HAL_FAILED;
   }
 
@@ -137,6 +171,25 @@ static bool mmc_write(void *instance, uint32_t startblk,
   return HAL_SUCCESS;
 }
 
+#if (MMC_USE_ASYNC == TRUE) || defined(__DOXYGEN__)
+static bool mmc_queued_read(void *instance, uint32_t startblk,
+                            uint8_t *buffer, uint32_t n) {
+
+  return bioRead(&((MMCDriver *)instance)->queue, startblk, buffer, n);
+}
+
+static bool mmc_queued_write(void *instance, uint32_t startblk,
+                             const uint8_t *buffer, uint32_t n) {
+
+  return bioWrite(&((MMCDriver *)instance)->queue, startblk, buffer, n);
+}
+
+static bool mmc_queued_sync(void *instance) {
+
+  return bioSync(&((MMCDriver *)instance)->queue);
+}
+#endif
+
 /**
  * @brief Calculate the MMC standard CRC-7 based on a lookup table.
  *
@@ -396,6 +449,11 @@ void mmcObjectInit(MMCDriver *mmcp) {
   mmcp->state = BLK_STOP;
   mmcp->config = NULL;
   mmcp->block_addresses = false;
+  mmcp->sd_card = false;
+#if MMC_USE_ASYNC == TRUE
+  bioObjectInit(&mmcp->queue, (BaseBlockDevice *)mmcp);
+  mmcp->queue.vmt = (const struct BaseBlockDeviceVMT *)&mmc_queue_vmt;
+#endif
 }
 
 /**
@@ -462,6 +520,7 @@ bool mmcConnect(MMCDriver *mmcp) {
   /* Connection procedure in progress.*/
   mmcp->state = BLK_CONNECTING;
   mmcp->block_addresses = false;
+  mmcp->sd_card = false;
 
   /* Slow clock mode and 128 clock pulses.*/
   spiStart(mmcp->config->spip, mmcp->config->lscfg);
@@ -501,6 +560,7 @@ bool mmcConnect(MMCDriver *mmcp) {
       }
       osalThreadSleepMilliseconds(10);
     }
+    mmcp->sd_card = true;
 
     /* Execute dedicated read on OCR register */
     (void) send_command_R3(mmcp, MMCSD_CMD_READ_OCR, 0, r3);
@@ -575,6 +635,9 @@ failed:
 bool mmcDisconnect(MMCDriver *mmcp) {
 
   osalDbgCheck(mmcp != NULL);
+#if MMC_USE_ASYNC == TRUE
+  osalDbgAssert(mmcp->queue.depth == 0U, "requests pending");
+#endif
 
   osalSysLock();
   osalDbgAssert((mmcp->state == BLK_ACTIVE) || (mmcp->state == BLK_READY),
@@ -719,6 +782,30 @@ bool mmcStopSequentialRead(MMCDriver *mmcp) {
  */
 bool mmcStartSequentialWrite(MMCDriver *mmcp, uint32_t startblk) {
 
+  return mmcStartMultipleWrite(mmcp, startblk, 0U);
+}
+
+/**
+ * @brief   Starts a sequential write of a known number of blocks.
+ * @details On SD cards the number of blocks is notified to the card using
+ *          the ACMD23 pre-erase command, this allows the card to prepare
+ *          the whole area in advance speeding up the multi-block write.
+ * @note    The pre-erase is just a hint, writing a different number of
+ *          blocks is allowed but the content of the blocks pre-erased
+ *          and not written is undefined.
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ * @param[in] startblk  first block to write
+ * @param[in] n         number of blocks to be written, zero if unknown
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS   the operation succeeded.
+ * @retval HAL_FAILED    the operation failed.
+ *
+ * @api
+ */
+bool mmcStartMultipleWrite(MMCDriver *mmcp, uint32_t startblk, uint32_t n) {
+
   osalDbgCheck(mmcp != NULL);
   osalDbgAssert(mmcp->state == BLK_READY, "invalid state");
 
@@ -726,6 +813,13 @@ bool mmcStartSequentialWrite(MMCDriver *mmcp, uint32_t startblk) {
   mmcp->state = BLK_WRITING;
 
   spiStart(mmcp->config->spip, mmcp->config->hscfg);
+
+  /* Pre-erase hint, the response is not relevant.*/
+  if ((n > 1U) && mmcp->sd_card) {
+    (void) send_command_R1(mmcp, MMCSD_CMD_APP_CMD, 0);
+    (void) send_command_R1(mmcp, MMCSD_CMD_SET_WR_BLK_ERASE_COUNT, n);
+  }
+
   spiSelect(mmcp->config->spip);
   if (mmcp->block_addresses) {
     send_hdr(mmcp, MMCSD_CMD_WRITE_MULTIPLE_BLOCK, startblk);
@@ -881,6 +975,9 @@ bool mmcGetInfo(MMCDriver *mmcp, BlockDeviceInfo *bdip) {
 bool mmcErase(MMCDriver *mmcp, uint32_t startblk, uint32_t endblk) {
 
   osalDbgCheck((mmcp != NULL));
+#if MMC_USE_ASYNC == TRUE
+  osalDbgAssert(mmcp->queue.depth == 0U, "requests pending");
+#endif
 
   /* Erase operation in progress.*/
   mmcp->state = BLK_WRITING;
@@ -913,6 +1010,80 @@ failed:
   return HAL_FAILED;
 }
 
+#if (MMC_USE_ASYNC == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Starts reading one or more blocks.
+ * @details The request is queued and executed by the thread serving the
+ *          driver, see @p mmcServe().
+ * @note    The request object and the buffer must not be touched until
+ *          the request has been completed.
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ * @param[in] reqp      pointer to the @p blkio_request_t object
+ * @param[in] startblk  first block to read
+ * @param[out] buf      pointer to the read buffer
+ * @param[in] n         number of blocks to read
+ * @param[in] cb        completion callback or @p NULL
+ *
+ * @api
+ */
+void mmcStartRead(MMCDriver *mmcp, blkio_request_t *reqp,
+                  uint32_t startblk, uint8_t *buf, uint32_t n,
+                  blkiocb_t cb) {
+
+  osalDbgCheck(mmcp != NULL);
+
+  bioStartRead(&mmcp->queue, reqp, startblk, buf, n, cb);
+}
+
+/**
+ * @brief   Starts writing one or more blocks.
+ * @details The request is queued and executed by the thread serving the
+ *          driver, see @p mmcServe().
+ * @note    The request object and the buffer must not be touched until
+ *          the request has been completed.
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ * @param[in] reqp      pointer to the @p blkio_request_t object
+ * @param[in] startblk  first block to write
+ * @param[in] buf       pointer to the write buffer
+ * @param[in] n         number of blocks to write
+ * @param[in] cb        completion callback or @p NULL
+ *
+ * @api
+ */
+void mmcStartWrite(MMCDriver *mmcp, blkio_request_t *reqp,
+                   uint32_t startblk, const uint8_t *buf, uint32_t n,
+                   blkiocb_t cb) {
+
+  osalDbgCheck(mmcp != NULL);
+
+  bioStartWrite(&mmcp->queue, reqp, startblk, buf, n, cb);
+}
+
+/**
+ * @brief   Serves the asynchronous requests.
+ * @details This function never returns, it must be invoked from a thread
+ *          created by the application for this purpose. The transfers
+ *          made through the block device interface are executed by this
+ *          thread too, so they can be freely mixed with the asynchronous
+ *          requests.
+ * @note    The sequential access functions, @p mmcSync(), @p mmcErase()
+ *          and @p mmcDisconnect() access the card directly, they must not
+ *          be invoked while requests are pending.
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ *
+ * @api
+ */
+void mmcServe(MMCDriver *mmcp) {
+
+  osalDbgCheck(mmcp != NULL);
+
+  bioServe(&mmcp->queue);
+}
+#endif /* MMC_USE_ASYNC == TRUE */
+
 #endif /* HAL_USE_MMC_SPI == TRUE */
 
 /** @} */
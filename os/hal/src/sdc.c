@@ -60,6 +60,20 @@ typedef enum {
   SD_SWITCH_FUNCTION_CURRENT_LIMIT = 3
 } sd_switch_function_t;
 
+/**
+ * @brief   Buffers alignment required by the low level driver.
+ * @note    The low level driver can override this value.
+ */
+#if !defined(SDC_LLD_BUFFER_ALIGNMENT) || defined(__DOXYGEN__)
+#define SDC_LLD_BUFFER_ALIGNMENT            4U
+#endif
+
+/**
+ * @brief   Returns @p true if a buffer needs to be bounced.
+ */
+#define sdc_is_unaligned(buf)                                               \
+  (((size_t)(buf) & (SDC_LLD_BUFFER_ALIGNMENT - 1U)) != 0U)
+
 /*===========================================================================*/
 /* Driver exported variables.                                                */
 /*===========================================================================*/
@@ -68,6 +82,22 @@ typedef enum {
 /* Driver local variables and types.                                         */
 /*===========================================================================*/
 
+#if (SDC_UNALIGNED_BOUNCE_BLOCKS > 0) || defined(__DOXYGEN__)
+/**
+ * @brief   Bounce buffer for unaligned transfers.
+ */
+static union {
+  uint32_t  alignment;
+  uint8_t   buf[SDC_UNALIGNED_BOUNCE_BLOCKS * MMCSD_BLOCK_SIZE];
+} bounce;
+
+/**
+ * @brief   Mutex protecting the bounce buffer.
+ * @note    The buffer is shared among all the drivers.
+ */
+static mutex_t bounce_mutex;
+#endif
+
 /**
  * @brief   Virtual methods table.
  */
@@ -79,12 +109,244 @@ static const struct SDCDriverVMT sdc_vmt = {
   (bool (*)(void *, uint32_t, uint8_t *, uint32_t))sdcRead,
   (bool (*)(void *, uint32_t, const uint8_t *, uint32_t))sdcWrite,
   (bool (*)(void *))sdcSync,
-  (bool (*)(void *, BlockDeviceInfo *))sdcGetInfo
+  (bool (*)(void *, BlockDeviceInfo *))sdcGetInfo,
+  (bool (*)(void *, uint32_t, uint32_t))sdcErase
+};
+
+#if (SDC_USE_ASYNC == TRUE) || defined(__DOXYGEN__)
+/* Forward declarations required by sdc_queue_vmt.*/
+static bool sdc_read(SDCDriver *sdcp, uint32_t startblk,
+                     uint8_t *buf, uint32_t n);
+static bool sdc_write(SDCDriver *sdcp, uint32_t startblk,
+                      const uint8_t *buf, uint32_t n);
+static bool sdc_sync(SDCDriver *sdcp);
+
+/**
+ * @brief   Virtual methods table used by the requests queue.
+ * @details The transfers are executed directly, the blocking API is
+ *          routed through the queue instead.
+ */
+static const struct SDCDriverVMT sdc_queue_vmt = {
+  (bool (*)(void *))sdc_lld_is_card_inserted,
+  (bool (*)(void *))sdc_lld_is_write_protected,
+  (bool (*)(void *))sdcConnect,
+  (bool (*)(void *))sdcDisconnect,
+  (bool (*)(void *, uint32_t, uint8_t *, uint32_t))sdc_read,
+  (bool (*)(void *, uint32_t, const uint8_t *, uint32_t))sdc_write,
+  (bool (*)(void *))sdc_sync,
+  (bool (*)(void *, BlockDeviceInfo *))sdcGetInfo,
+  (bool (*)(void *, uint32_t, uint32_t))sdcErase
 };
+#endif
 
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
+
+#if (SDC_UNALIGNED_BOUNCE_BLOCKS > 0) || defined(__DOXYGEN__)
+/**
+ * @brief   Reads one or more blocks into an unaligned buffer.
+ * @details The transfer is split in chunks of the bounce buffer size, each
+ *          chunk is read using a single multi-block operation.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] startblk  first block to read
+ * @param[out] buf      pointer to the read buffer
+ * @param[in] n         number of blocks to read
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @notapi
+ */
+static bool sdc_read_bounce(SDCDriver *sdcp, uint32_t startblk,
+                            uint8_t *buf, uint32_t n) {
+  bool status = HAL_SUCCESS;
+
+  osalMutexLock(&bounce_mutex);
+  while (n > 0U) {
+    uint32_t chunk = n;
+
+    if (chunk > (uint32_t)SDC_UNALIGNED_BOUNCE_BLOCKS) {
+      chunk = (uint32_t)SDC_UNALIGNED_BOUNCE_BLOCKS;
+    }
+    if (sdc_lld_read(sdcp, startblk, bounce.buf, chunk)) {
+      status = HAL_FAILED;
+      break;
+    }
+    memcpy(buf, bounce.buf, (size_t)chunk * MMCSD_BLOCK_SIZE);
+    buf      += (size_t)chunk * MMCSD_BLOCK_SIZE;
+    startblk += chunk;
+    n        -= chunk;
+  }
+  osalMutexUnlock(&bounce_mutex);
+  return status;
+}
+
+/**
+ * @brief   Writes one or more blocks from an unaligned buffer.
+ * @details The transfer is split in chunks of the bounce buffer size, each
+ *          chunk is written using a single multi-block operation.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] startblk  first block to write
+ * @param[in] buf       pointer to the write buffer
+ * @param[in] n         number of blocks to write
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @notapi
+ */
+static bool sdc_write_bounce(SDCDriver *sdcp, uint32_t startblk,
+                             const uint8_t *buf, uint32_t n) {
+  bool status = HAL_SUCCESS;
+
+  osalMutexLock(&bounce_mutex);
+  while (n > 0U) {
+    uint32_t chunk = n;
+
+    if (chunk > (uint32_t)SDC_UNALIGNED_BOUNCE_BLOCKS) {
+      chunk = (uint32_t)SDC_UNALIGNED_BOUNCE_BLOCKS;
+    }
+    memcpy(bounce.buf, buf, (size_t)chunk * MMCSD_BLOCK_SIZE);
+    if (sdc_lld_write(sdcp, startblk, bounce.buf, chunk)) {
+      status = HAL_FAILED;
+      break;
+    }
+    buf      += (size_t)chunk * MMCSD_BLOCK_SIZE;
+    startblk += chunk;
+    n        -= chunk;
+  }
+  osalMutexUnlock(&bounce_mutex);
+  return status;
+}
+#endif /* SDC_UNALIGNED_BOUNCE_BLOCKS > 0 */
+
+/**
+ * @brief   Reads one or more blocks.
+ * @details The operation is executed directly, the queue of the
+ *          asynchronous API is not involved.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] startblk  first block to read
+ * @param[out] buf      pointer to the read buffer
+ * @param[in] n         number of blocks to read
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @notapi
+ */
+static bool sdc_read(SDCDriver *sdcp, uint32_t startblk,
+                     uint8_t *buf, uint32_t n) {
+  bool status;
+
+  osalDbgAssert(sdcp->state == BLK_READY, "invalid state");
+
+  if ((startblk + n - 1U) > sdcp->capacity){
+    sdcp->errors |= SDC_OVERFLOW_ERROR;
+    return HAL_FAILED;
+  }
+
+  /* Read operation in progress.*/
+  sdcp->state = BLK_READING;
+
+#if SDC_UNALIGNED_BOUNCE_BLOCKS > 0
+  if (sdc_is_unaligned(buf)) {
+    status = sdc_read_bounce(sdcp, startblk, buf, n);
+  }
+  else {
+    status = sdc_lld_read(sdcp, startblk, buf, n);
+  }
+#else
+  status = sdc_lld_read(sdcp, startblk, buf, n);
+#endif
+
+  /* Read operation finished.*/
+  sdcp->state = BLK_READY;
+  return status;
+}
+
+/**
+ * @brief   Writes one or more blocks.
+ * @details The operation is executed directly, the queue of the
+ *          asynchronous API is not involved.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] startblk  first block to write
+ * @param[in] buf       pointer to the write buffer
+ * @param[in] n         number of blocks to write
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @notapi
+ */
+static bool sdc_write(SDCDriver *sdcp, uint32_t startblk,
+                      const uint8_t *buf, uint32_t n) {
+  bool status;
+
+  osalDbgAssert(sdcp->state == BLK_READY, "invalid state");
+
+  if ((startblk + n - 1U) > sdcp->capacity){
+    sdcp->errors |= SDC_OVERFLOW_ERROR;
+    return HAL_FAILED;
+  }
+
+  /* Write operation in progress.*/
+  sdcp->state = BLK_WRITING;
+
+#if SDC_UNALIGNED_BOUNCE_BLOCKS > 0
+  if (sdc_is_unaligned(buf)) {
+    status = sdc_write_bounce(sdcp, startblk, buf, n);
+  }
+  else {
+    status = sdc_lld_write(sdcp, startblk, buf, n);
+  }
+#else
+  status = sdc_lld_write(sdcp, startblk, buf, n);
+#endif
+
+  /* Write operation finished.*/
+  sdcp->state = BLK_READY;
+  return status;
+}
+
+/**
+ * @brief   Waits for card idle condition.
+ * @details The operation is executed directly, the queue of the
+ *          asynchronous API is not involved.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @notapi
+ */
+static bool sdc_sync(SDCDriver *sdcp) {
+  bool result;
+
+  if (sdcp->state != BLK_READY) {
+    return HAL_FAILED;
+  }
+
+  /* Synchronization operation in progress.*/
+  sdcp->state = BLK_SYNCING;
+
+  result = sdc_lld_sync(sdcp);
+
+  /* Synchronization operation finished.*/
+  sdcp->state = BLK_READY;
+  return result;
+}
+
 /**
  * @brief   Detects card mode.
  *
@@ -540,6 +802,9 @@ bool _sdc_wait_for_transfer_state(SDCDriver *sdcp) {
  */
 void sdcInit(void) {
 
+#if SDC_UNALIGNED_BOUNCE_BLOCKS > 0
+  osalMutexObjectInit(&bounce_mutex);
+#endif
   sdc_lld_init();
 }
 
@@ -557,6 +822,10 @@ void sdcObjectInit(SDCDriver *sdcp) {
   sdcp->errors   = SDC_NO_ERROR;
   sdcp->config   = NULL;
   sdcp->capacity = 0;
+#if SDC_USE_ASYNC == TRUE
+  bioObjectInit(&sdcp->queue, (BaseBlockDevice *)sdcp);
+  sdcp->queue.vmt = (const struct BaseBlockDeviceVMT *)&sdc_queue_vmt;
+#endif
 }
 
 /**
@@ -757,6 +1026,9 @@ failed:
 bool sdcDisconnect(SDCDriver *sdcp) {
 
   osalDbgCheck(sdcp != NULL);
+#if SDC_USE_ASYNC == TRUE
+  osalDbgAssert(sdcp->queue.depth == 0U, "requests pending");
+#endif
 
   osalSysLock();
   osalDbgAssert((sdcp->state == BLK_ACTIVE) || (sdcp->state == BLK_READY),
@@ -785,6 +1057,9 @@ bool sdcDisconnect(SDCDriver *sdcp) {
  * @brief   Reads one or more blocks.
  * @pre     The driver must be in the @p BLK_READY state after a successful
  *          sdcConnect() invocation.
+ * @note    When @p SDC_USE_ASYNC is @p TRUE the operation is queued after
+ *          the pending asynchronous requests and executed by the thread
+ *          serving the driver, see @p sdcServe().
  *
  * @param[in] sdcp      pointer to the @p SDCDriver object
  * @param[in] startblk  first block to read
@@ -798,30 +1073,23 @@ bool sdcDisconnect(SDCDriver *sdcp) {
  * @api
  */
 bool sdcRead(SDCDriver *sdcp, uint32_t startblk, uint8_t *buf, uint32_t n) {
-  bool status;
 
   osalDbgCheck((sdcp != NULL) && (buf != NULL) && (n > 0U));
-  osalDbgAssert(sdcp->state == BLK_READY, "invalid state");
 
-  if ((startblk + n - 1U) > sdcp->capacity){
-    sdcp->errors |= SDC_OVERFLOW_ERROR;
-    return HAL_FAILED;
-  }
-
-  /* Read operation in progress.*/
-  sdcp->state = BLK_READING;
-
-  status = sdc_lld_read(sdcp, startblk, buf, n);
-
-  /* Read operation finished.*/
-  sdcp->state = BLK_READY;
-  return status;
+#if SDC_USE_ASYNC == TRUE
+  return bioRead(&sdcp->queue, startblk, buf, n);
+#else
+  return sdc_read(sdcp, startblk, buf, n);
+#endif
 }
 
 /**
  * @brief   Writes one or more blocks.
  * @pre     The driver must be in the @p BLK_READY state after a successful
  *          sdcConnect() invocation.
+ * @note    When @p SDC_USE_ASYNC is @p TRUE the operation is queued after
+ *          the pending asynchronous requests and executed by the thread
+ *          serving the driver, see @p sdcServe().
  *
  * @param[in] sdcp      pointer to the @p SDCDriver object
  * @param[in] startblk  first block to write
@@ -836,25 +1104,88 @@ bool sdcRead(SDCDriver *sdcp, uint32_t startblk, uint8_t *buf, uint32_t n) {
  */
 bool sdcWrite(SDCDriver *sdcp, uint32_t startblk,
               const uint8_t *buf, uint32_t n) {
-  bool status;
 
   osalDbgCheck((sdcp != NULL) && (buf != NULL) && (n > 0U));
-  osalDbgAssert(sdcp->state == BLK_READY, "invalid state");
 
-  if ((startblk + n - 1U) > sdcp->capacity){
-    sdcp->errors |= SDC_OVERFLOW_ERROR;
-    return HAL_FAILED;
-  }
+#if SDC_USE_ASYNC == TRUE
+  return bioWrite(&sdcp->queue, startblk, buf, n);
+#else
+  return sdc_write(sdcp, startblk, buf, n);
+#endif
+}
 
-  /* Write operation in progress.*/
-  sdcp->state = BLK_WRITING;
+#if (SDC_USE_ASYNC == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Starts reading one or more blocks.
+ * @details The request is queued and executed by the thread serving the
+ *          driver, see @p sdcServe().
+ * @note    The request object and the buffer must not be touched until
+ *          the request has been completed.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] reqp      pointer to the @p blkio_request_t object
+ * @param[in] startblk  first block to read
+ * @param[out] buf      pointer to the read buffer
+ * @param[in] n         number of blocks to read
+ * @param[in] cb        completion callback or @p NULL
+ *
+ * @api
+ */
+void sdcStartRead(SDCDriver *sdcp, blkio_request_t *reqp,
+                  uint32_t startblk, uint8_t *buf, uint32_t n,
+                  blkiocb_t cb) {
 
-  status = sdc_lld_write(sdcp, startblk, buf, n);
+  osalDbgCheck(sdcp != NULL);
 
-  /* Write operation finished.*/
-  sdcp->state = BLK_READY;
-  return status;
+  bioStartRead(&sdcp->queue, reqp, startblk, buf, n, cb);
+}
+
+/**
+ * @brief   Starts writing one or more blocks.
+ * @details The request is queued and executed by the thread serving the
+ *          driver, see @p sdcServe().
+ * @note    The request object and the buffer must not be touched until
+ *          the request has been completed.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] reqp      pointer to the @p blkio_request_t object
+ * @param[in] startblk  first block to write
+ * @param[in] buf       pointer to the write buffer
+ * @param[in] n         number of blocks to write
+ * @param[in] cb        completion callback or @p NULL
+ *
+ * @api
+ */
+void sdcStartWrite(SDCDriver *sdcp, blkio_request_t *reqp,
+                   uint32_t startblk, const uint8_t *buf, uint32_t n,
+                   blkiocb_t cb) {
+
+  osalDbgCheck(sdcp != NULL);
+
+  bioStartWrite(&sdcp->queue, reqp, startblk, buf, n, cb);
+}
+
+/**
+ * @brief   Serves the asynchronous requests.
+ * @details This function never returns, it must be invoked from a thread
+ *          created by the application for this purpose. The blocking
+ *          functions @p sdcRead(), @p sdcWrite() and @p sdcSync() are
+ *          executed by this thread too, so they can be freely mixed with
+ *          the asynchronous requests.
+ * @note    @p sdcDisconnect() and @p sdcErase() must not be invoked while
+ *          requests are pending.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ *
+ * @api
+ */
+void sdcServe(SDCDriver *sdcp) {
+
+  osalDbgCheck(sdcp != NULL);
+
+  bioServe(&sdcp->queue);
 }
+#endif /* SDC_USE_ASYNC == TRUE */
 
 /**
  * @brief   Returns the errors mask associated to the previous operation.
@@ -879,6 +1210,9 @@ sdcflags_t sdcGetAndClearErrors(SDCDriver *sdcp) {
 
 /**
  * @brief   Waits for card idle condition.
+ * @note    When @p SDC_USE_ASYNC is @p TRUE the operation is queued after
+ *          the pending asynchronous requests and executed by the thread
+ *          serving the driver, see @p sdcServe().
  *
  * @param[in] sdcp      pointer to the @p SDCDriver object
  *
@@ -889,22 +1223,14 @@ sdcflags_t sdcGetAndClearErrors(SDCDriver *sdcp) {
  * @api
  */
 bool sdcSync(SDCDriver *sdcp) {
-  bool result;
 
   osalDbgCheck(sdcp != NULL);
 
-  if (sdcp->state != BLK_READY) {
-    return HAL_FAILED;
-  }
-
-  /* Synchronization operation in progress.*/
-  sdcp->state = BLK_SYNCING;
-
-  result = sdc_lld_sync(sdcp);
-
-  /* Synchronization operation finished.*/
-  sdcp->state = BLK_READY;
-  return result;
+#if SDC_USE_ASYNC == TRUE
+  return bioSync(&sdcp->queue);
+#else
+  return sdc_sync(sdcp);
+#endif
 }
 
 /**
@@ -951,6 +1277,9 @@ bool sdcErase(SDCDriver *sdcp, uint32_t startblk, uint32_t endblk) {
 
   osalDbgCheck((sdcp != NULL));
   osalDbgAssert(sdcp->state == BLK_READY, "invalid state");
+#if SDC_USE_ASYNC == TRUE
+  osalDbgAssert(sdcp->queue.depth == 0U, "requests pending");
+#endif
 
   /* Erase operation in progress.*/
   sdcp->state = BLK_WRITING;
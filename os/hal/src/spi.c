@@ -42,6 +42,59 @@
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+#if (SPI_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Starts the current transfer of the transaction at the queue head.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+static void spi_queue_transfer_i(SPIDriver *spip) {
+  const SPITransfer *tp = &spip->qhead->transfers[spip->qstep];
+
+  if (tp->txbuf != NULL) {
+    if (tp->rxbuf != NULL) {
+      spiStartExchangeI(spip, tp->n, tp->txbuf, tp->rxbuf);
+    }
+    else {
+      spiStartSendI(spip, tp->n, tp->txbuf);
+    }
+  }
+  else if (tp->rxbuf != NULL) {
+    spiStartReceiveI(spip, tp->n, tp->rxbuf);
+  }
+  else {
+    spiStartIgnoreI(spip, tp->n);
+  }
+}
+
+/**
+ * @brief   Starts the transaction at the queue head.
+ * @details The peripheral is reprogrammed only if the configuration of
+ *          the transaction requires a different setup.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+static void spi_queue_begin_i(SPIDriver *spip) {
+  const SPIConfig *config = spip->qhead->config;
+
+  if (config != spip->config) {
+    bool same = spi_lld_same_setup(spip->config, config);
+
+    spip->config = config;
+    if (!same) {
+      spi_lld_start(spip);
+    }
+  }
+  spiSelectI(spip);
+  spip->qstep = 0U;
+  spi_queue_transfer_i(spip);
+}
+#endif /* SPI_USE_QUEUE == TRUE */
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -75,6 +128,11 @@ void spiObjectInit(SPIDriver *spip) {
 #if SPI_USE_MUTUAL_EXCLUSION == TRUE
   osalMutexObjectInit(&spip->mutex);
 #endif
+#if SPI_USE_QUEUE == TRUE
+  spip->qhead = NULL;
+  spip->qtail = NULL;
+  spip->qstep = 0U;
+#endif
 #if defined(SPI_DRIVER_EXT_INIT_HOOK)
   SPI_DRIVER_EXT_INIT_HOOK(spip);
 #endif
@@ -411,6 +469,161 @@ void spiReleaseBus(SPIDriver *spip) {
 }
 #endif /* SPI_USE_MUTUAL_EXCLUSION == TRUE */
 
+#if (SPI_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes an @p SPITransaction object.
+ *
+ * @param[out] stp      pointer to the @p SPITransaction object
+ * @param[in] config    configuration of the slave, including its select
+ *                      line
+ * @param[in] transfers pointer to the transfers list
+ * @param[in] n         number of transfers
+ * @param[in] callback  completion callback or @p NULL
+ *
+ * @init
+ */
+void spiTransactionObjectInit(SPITransaction *stp, const SPIConfig *config,
+                              const SPITransfer *transfers, size_t n,
+                              spiqcallback_t callback) {
+
+  osalDbgCheck((stp != NULL) && (config != NULL) &&
+               (transfers != NULL) && (n > 0U));
+
+  stp->next      = NULL;
+  stp->config    = config;
+  stp->transfers = transfers;
+  stp->n         = n;
+  stp->callback  = callback;
+  stp->pending   = false;
+#if SPI_USE_WAIT == TRUE
+  stp->thread    = NULL;
+#endif
+}
+
+/**
+ * @brief   Queues a transaction.
+ * @details If the driver is idle the transaction is started immediately
+ *          else it is started by the ISR after the previously queued ones.
+ * @pre     In order to use this function the option @p SPI_USE_QUEUE must be
+ *          enabled.
+ * @pre     The driver must have been started, any configuration can be
+ *          used.
+ * @note    Queued transactions do not invoke the @p end_cb callback of
+ *          the configuration, the transaction callback is invoked instead.
+ * @note    Queued transactions and the other operations cannot be mixed,
+ *          the queue must be empty before using the other APIs.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] stp       pointer to the @p SPITransaction object
+ *
+ * @iclass
+ */
+void spiSubmitI(SPIDriver *spip, SPITransaction *stp) {
+
+  osalDbgCheckClassI();
+  osalDbgCheck((spip != NULL) && (stp != NULL));
+  osalDbgAssert((spip->state == SPI_READY) || (spip->qhead != NULL),
+                "not ready");
+  osalDbgAssert(!stp->pending, "already queued");
+
+  stp->next    = NULL;
+  stp->pending = true;
+  if (spip->qhead == NULL) {
+    spip->qhead = stp;
+    spip->qtail = stp;
+    spi_queue_begin_i(spip);
+  }
+  else {
+    spip->qtail->next = stp;
+    spip->qtail = stp;
+  }
+}
+
+/**
+ * @brief   Queues a transaction.
+ * @details If the driver is idle the transaction is started immediately
+ *          else it is started by the ISR after the previously queued ones.
+ * @pre     In order to use this function the option @p SPI_USE_QUEUE must be
+ *          enabled.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] stp       pointer to the @p SPITransaction object
+ *
+ * @api
+ */
+void spiSubmit(SPIDriver *spip, SPITransaction *stp) {
+
+  osalSysLock();
+  spiSubmitI(spip, stp);
+  osalSysUnlock();
+}
+
+#if (SPI_USE_WAIT == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Queues a transaction and waits for its completion.
+ * @pre     In order to use this function the options @p SPI_USE_QUEUE and
+ *          @p SPI_USE_WAIT must be enabled.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] stp       pointer to the @p SPITransaction object
+ *
+ * @api
+ */
+void spiTransact(SPIDriver *spip, SPITransaction *stp) {
+
+  osalSysLock();
+  spiSubmitI(spip, stp);
+  if (stp->pending) {
+    (void) osalThreadSuspendS(&stp->thread);
+  }
+  osalSysUnlock();
+}
+#endif /* SPI_USE_WAIT == TRUE */
+
+/**
+ * @brief   Queue ISR code.
+ * @details Starts the next transfer of the current transaction or, if the
+ *          transaction is complete, the next queued transaction. The
+ *          transaction callback is invoked after starting the next one.
+ * @note    This function is invoked by @p _spi_isr_code().
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void _spi_queue_isr(SPIDriver *spip) {
+  SPITransaction *stp;
+
+  osalSysLockFromISR();
+  stp = spip->qhead;
+  if (++spip->qstep < stp->n) {
+    spi_queue_transfer_i(spip);
+    osalSysUnlockFromISR();
+    return;
+  }
+
+  /* Transaction complete, the next one follows immediately.*/
+  spiUnselectI(spip);
+  stp->pending = false;
+  spip->qhead = stp->next;
+  if (spip->qhead != NULL) {
+    spi_queue_begin_i(spip);
+  }
+  else {
+    spip->qtail = NULL;
+    spip->state = SPI_READY;
+  }
+#if SPI_USE_WAIT == TRUE
+  osalThreadResumeI(&stp->thread, MSG_OK);
+#endif
+  osalSysUnlockFromISR();
+
+  if (stp->callback != NULL) {
+    stp->callback(spip, stp);
+  }
+}
+#endif /* SPI_USE_QUEUE == TRUE */
+
 #endif /* HAL_USE_SPI == TRUE */
 
 /** @} */
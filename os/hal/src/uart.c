@@ -22,6 +22,8 @@
  * @{
  */
 
+#include <string.h>
+
 #include "hal.h"
 
 #if (HAL_USE_UART == TRUE) || defined(__DOXYGEN__)
@@ -42,6 +44,112 @@
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+#if (UART_USE_FRAMES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Appends received data to the frame being assembled.
+ * @details If the data does not fit in the current buffer, or there is no
+ *          free buffer, then the whole frame is discarded.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @param[in] bp        pointer to the data
+ * @param[in] n         number of bytes
+ */
+static void uart_frame_append_i(UARTDriver *uartp,
+                                const uint8_t *bp, size_t n) {
+  input_buffers_queue_t *ibqp = uartp->frcfg->ibqp;
+  uint8_t *buf;
+
+  if (uartp->frdiscard) {
+    return;
+  }
+
+  buf = ibqGetEmptyBufferI(ibqp);
+  if ((buf == NULL) ||
+      (n > ((ibqp->bsize - sizeof (size_t)) - uartp->frn))) {
+    uartp->frdiscard = true;
+    return;
+  }
+
+  memcpy(buf + uartp->frn, bp, n);
+  uartp->frn += n;
+}
+
+/**
+ * @brief   Closes the frame being assembled.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @return              The frame posting status.
+ * @retval false        if no frame has been posted.
+ * @retval true         if a frame has been posted.
+ */
+static bool uart_frame_close_i(UARTDriver *uartp) {
+  bool posted = false;
+
+  if (uartp->frdiscard) {
+    uartp->frdropped++;
+  }
+  else if (uartp->frn > 0U) {
+    ibqPostFullBufferI(uartp->frcfg->ibqp, uartp->frn);
+    posted = true;
+  }
+  uartp->frn       = 0U;
+  uartp->frdiscard = false;
+
+  return posted;
+}
+
+/**
+ * @brief   Moves the newly received data from the circular buffer to frames.
+ * @details The data is processed in contiguous runs, the delimiter, if
+ *          enabled, is searched using @p memchr().
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @param[in] close     closes the pending frame after the scan
+ * @return              The frame posting status.
+ * @retval false        if no frame has been posted.
+ * @retval true         if at least a frame has been posted.
+ */
+static bool uart_frame_scan_i(UARTDriver *uartp, bool close) {
+  const UARTFrameConfig *fcp = uartp->frcfg;
+  size_t wridx = fcp->size - uart_lld_get_ring_remaining(uartp);
+  bool posted = false;
+
+  if (wridx >= fcp->size) {
+    wridx = 0U;
+  }
+
+  while (uartp->frrdidx != wridx) {
+    const uint8_t *bp = &fcp->ring[uartp->frrdidx];
+    size_t n = (wridx > uartp->frrdidx ? wridx : fcp->size) - uartp->frrdidx;
+    bool boundary = false;
+
+    if ((fcp->mode & UART_FRAME_ON_DELIMITER) != 0U) {
+      const uint8_t *dp = memchr(bp, fcp->delimiter, n);
+      if (dp != NULL) {
+        n = (size_t)(dp - bp) + 1U;
+        boundary = true;
+      }
+    }
+
+    uart_frame_append_i(uartp, bp, n);
+    uartp->frrdidx += n;
+    if (uartp->frrdidx >= fcp->size) {
+      uartp->frrdidx = 0U;
+    }
+
+    if (boundary) {
+      posted |= uart_frame_close_i(uartp);
+    }
+  }
+
+  if (close) {
+    posted |= uart_frame_close_i(uartp);
+  }
+
+  return posted;
+}
+#endif /* UART_USE_FRAMES == TRUE */
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -79,6 +187,9 @@ void uartObjectInit(UARTDriver *uartp) {
 #if UART_USE_MUTUAL_EXCLUSION == TRUE
   osalMutexObjectInit(&uartp->mutex);
 #endif /* UART_USE_MUTUAL_EXCLUSION */
+#if UART_USE_FRAMES == TRUE
+  uartp->frcfg      = NULL;
+#endif /* UART_USE_FRAMES */
 
   /* Optional, user-defined initializer.*/
 #if defined(UART_DRIVER_EXT_INIT_HOOK)
@@ -254,6 +365,7 @@ void uartStartReceive(UARTDriver *uartp, size_t n, void *rxbuf) {
   osalSysLock();
   osalDbgAssert(uartp->state == UART_READY, "is active");
   osalDbgAssert(uartp->rxstate != UART_RX_ACTIVE, "rx active");
+  osalDbgAssert(uartp->rxstate != UART_RX_FRAMED, "rx framed");
 
   uart_lld_start_receive(uartp, n, rxbuf);
   uartp->rxstate = UART_RX_ACTIVE;
@@ -278,6 +390,7 @@ void uartStartReceiveI(UARTDriver *uartp, size_t n, void *rxbuf) {
   osalDbgCheck((uartp != NULL) && (n > 0U) && (rxbuf != NULL));
   osalDbgAssert(uartp->state == UART_READY, "is active");
   osalDbgAssert(uartp->rxstate != UART_RX_ACTIVE, "rx active");
+  osalDbgAssert(uartp->rxstate != UART_RX_FRAMED, "rx framed");
 
   uart_lld_start_receive(uartp, n, rxbuf);
   uartp->rxstate = UART_RX_ACTIVE;
@@ -458,6 +571,7 @@ msg_t uartReceiveTimeout(UARTDriver *uartp, size_t *np,
   osalSysLock();
   osalDbgAssert(uartp->state == UART_READY, "is active");
   osalDbgAssert(uartp->rxstate != UART_RX_ACTIVE, "rx active");
+  osalDbgAssert(uartp->rxstate != UART_RX_FRAMED, "rx framed");
 
   /* Receive start.*/
   uart_lld_start_receive(uartp, *np, rxbuf);
@@ -510,6 +624,135 @@ void uartReleaseBus(UARTDriver *uartp) {
 }
 #endif
 
+#if (UART_USE_FRAMES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Starts a framed receive operation.
+ * @details The receiver writes continuously into the circular buffer
+ *          and the received frames are posted in the buffers queue
+ *          specified in the configuration, without per-character
+ *          interrupts.
+ * @note    Restarting the driver terminates the framed receive operation.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @param[in] fcp       pointer to the @p UARTFrameConfig object
+ *
+ * @api
+ */
+void uartStartFrameReceive(UARTDriver *uartp, const UARTFrameConfig *fcp) {
+
+  osalDbgCheck((uartp != NULL) && (fcp != NULL) &&
+               (fcp->ring != NULL) && (fcp->size >= 2U) &&
+               (fcp->ibqp != NULL));
+
+  osalSysLock();
+  osalDbgAssert(uartp->state == UART_READY, "not active");
+  osalDbgAssert(uartp->rxstate == UART_RX_IDLE, "rx busy");
+
+  uartp->frcfg     = fcp;
+  uartp->frrdidx   = 0U;
+  uartp->frn       = 0U;
+  uartp->frdiscard = false;
+  uartp->frdropped = 0U;
+  uart_lld_start_ring(uartp, fcp->size, fcp->ring);
+  uartp->rxstate = UART_RX_FRAMED;
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Stops a framed receive operation.
+ * @note    The data already received is posted as a last frame.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ *
+ * @api
+ */
+void uartStopFrameReceive(UARTDriver *uartp) {
+
+  osalDbgCheck(uartp != NULL);
+
+  osalSysLock();
+  osalDbgAssert(uartp->state == UART_READY, "not active");
+
+  if (uartp->rxstate == UART_RX_FRAMED) {
+    (void) uart_frame_scan_i(uartp, true);
+    uart_lld_stop_ring(uartp);
+    uartp->rxstate = UART_RX_IDLE;
+    osalOsRescheduleS();
+  }
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Waits for a received frame.
+ * @details If the @p UART_FRAME_ON_TIMEOUT mode is enabled then, on timeout,
+ *          the data received so far, if any, is closed as a frame and
+ *          returned, this implements the inter-frame timeout for protocols
+ *          without idle line or delimiter framing.
+ * @post    On success the frame is accessible between the @p ptr and
+ *          @p top fields of the buffers queue, it must be released
+ *          using @p uartReleaseFrame().
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a frame has been acquired.
+ * @retval MSG_TIMEOUT  if no data arrived within the specified time.
+ * @retval MSG_RESET    if the queue has been reset.
+ *
+ * @api
+ */
+msg_t uartGetFrameTimeout(UARTDriver *uartp, systime_t timeout) {
+  input_buffers_queue_t *ibqp;
+  msg_t msg;
+
+  osalDbgCheck(uartp != NULL);
+
+  osalSysLock();
+  osalDbgAssert(uartp->rxstate == UART_RX_FRAMED, "not framed");
+
+  ibqp = uartp->frcfg->ibqp;
+  msg = ibqGetFullBufferTimeoutS(ibqp, timeout);
+  if ((msg == MSG_TIMEOUT) && (uartp->rxstate == UART_RX_FRAMED) &&
+      ((uartp->frcfg->mode & UART_FRAME_ON_TIMEOUT) != 0U)) {
+    if (uart_frame_scan_i(uartp, true)) {
+      msg = ibqGetFullBufferTimeoutS(ibqp, TIME_IMMEDIATE);
+    }
+  }
+  osalSysUnlock();
+
+  return msg;
+}
+
+/**
+ * @brief   Framed receive ISR code.
+ * @details Invoked by the low level driver on the half and full marks of
+ *          the circular buffer and on idle line.
+ * @note    The frame callback is invoked outside the critical zone.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @param[in] idle      the line is idle
+ *
+ * @notapi
+ */
+void _uart_rx_frame_isr(UARTDriver *uartp, bool idle) {
+  const UARTFrameConfig *fcp = uartp->frcfg;
+  bool posted;
+
+  osalSysLockFromISR();
+  posted = uart_frame_scan_i(uartp, idle &&
+                             ((fcp->mode & UART_FRAME_ON_IDLE) != 0U));
+  osalSysUnlockFromISR();
+
+  if (posted && (fcp->frame_cb != NULL)) {
+    fcp->frame_cb(uartp);
+  }
+}
+#endif /* UART_USE_FRAMES == TRUE */
+
 #endif /* HAL_USE_UART == TRUE */
 
 /** @} */
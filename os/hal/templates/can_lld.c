@@ -209,6 +209,27 @@ void can_lld_receive(CANDriver *canp,
 
 }
 
+/**
+ * @brief   Programs the acceptance filters.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] afp       pointer to the filters array, can be @p NULL if
+ *                      (num == 0)
+ * @param[in] num       number of entries in the filters array, if zero then
+ *                      all frames are accepted
+ *
+ * @notapi
+ */
+void can_lld_set_acceptance_filters(CANDriver *canp,
+                                    const CANAcceptanceFilter *afp,
+                                    uint32_t num) {
+
+  (void)canp;
+  (void)afp;
+  (void)num;
+
+}
+
 #if (CAN_USE_SLEEP_MODE == TRUE) || defined(__DOXYGEN__)
 /**
  * @brief   Enters the sleep mode.
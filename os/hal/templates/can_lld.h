@@ -183,6 +183,26 @@ typedef struct {
    * @brief   Exiting sleep state event.
    */
   event_source_t            wakeup_event;
+#endif
+#if (CAN_USE_RX_QUEUES == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Attached receive queues.
+   */
+  CANRxQueue                *rxqueues;
+  /**
+   * @brief   Frames lost because the hardware receive mailboxes were full.
+   */
+  uint32_t                  rxoverruns;
+  /**
+   * @brief   Frames discarded because not routed to any queue.
+   */
+  uint32_t                  rxunrouted;
+#endif
+#if (CAN_USE_TX_QUEUE == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Associated transmit queue or @p NULL.
+   */
+  CANTxQueue                *txq;
 #endif
   /* End of the mandatory fields.*/
 } CANDriver;
@@ -213,6 +233,9 @@ extern "C" {
   void can_lld_receive(CANDriver *canp,
                        canmbx_t mailbox,
                        CANRxFrame *crfp);
+  void can_lld_set_acceptance_filters(CANDriver *canp,
+                                      const CANAcceptanceFilter *afp,
+                                      uint32_t num);
 #if CAN_USE_SLEEP_MODE == TRUE
   void can_lld_sleep(CANDriver *canp);
   void can_lld_wakeup(CANDriver *canp);
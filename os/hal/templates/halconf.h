@@ -211,6 +211,20 @@
 #if !defined(CAN_USE_SLEEP_MODE) || defined(__DOXYGEN__)
 #define CAN_USE_SLEEP_MODE          TRUE
 #endif
+
+/**
+ * @brief   Software receive queues inclusion switch.
+ */
+#if !defined(CAN_USE_RX_QUEUES) || defined(__DOXYGEN__)
+#define CAN_USE_RX_QUEUES           FALSE
+#endif
+
+/**
+ * @brief   Software transmit queue inclusion switch.
+ */
+#if !defined(CAN_USE_TX_QUEUE) || defined(__DOXYGEN__)
+#define CAN_USE_TX_QUEUE            FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -226,6 +240,14 @@
 #if !defined(I2C_USE_MUTUAL_EXCLUSION) || defined(__DOXYGEN__)
 #define I2C_USE_MUTUAL_EXCLUSION    TRUE
 #endif
+
+/**
+ * @brief   Enables the @p i2cSubmit() and @p i2cTransact() APIs.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(I2C_USE_QUEUE) || defined(__DOXYGEN__)
+#define I2C_USE_QUEUE               FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -268,6 +290,14 @@
 #if !defined(MMC_NICE_WAITING) || defined(__DOXYGEN__)
 #define MMC_NICE_WAITING            TRUE
 #endif
+
+/**
+ * @brief   Enables the asynchronous transfers API.
+ * @note    Requires the block I/O module in os/hal/lib/blocks.
+ */
+#if !defined(MMC_USE_ASYNC) || defined(__DOXYGEN__)
+#define MMC_USE_ASYNC               FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -303,6 +333,23 @@
 #if !defined(SDC_NICE_WAITING) || defined(__DOXYGEN__)
 #define SDC_NICE_WAITING            TRUE
 #endif
+
+/**
+ * @brief   Size, in blocks, of the bounce buffer for unaligned transfers.
+ * @note    Zero disables the bounce buffer, unaligned transfers are then
+ *          handled by the low level driver, if supported.
+ */
+#if !defined(SDC_UNALIGNED_BOUNCE_BLOCKS) || defined(__DOXYGEN__)
+#define SDC_UNALIGNED_BOUNCE_BLOCKS 0
+#endif
+
+/**
+ * @brief   Enables the asynchronous transfers API.
+ * @note    Requires the block I/O module in os/hal/lib/blocks.
+ */
+#if !defined(SDC_USE_ASYNC) || defined(__DOXYGEN__)
+#define SDC_USE_ASYNC               FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -382,6 +429,14 @@
 #if !defined(SPI_USE_MUTUAL_EXCLUSION) || defined(__DOXYGEN__)
 #define SPI_USE_MUTUAL_EXCLUSION    TRUE
 #endif
+
+/**
+ * @brief   Enables the @p spiSubmit() and @p spiTransact() APIs.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(SPI_USE_QUEUE) || defined(__DOXYGEN__)
+#define SPI_USE_QUEUE               FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -406,6 +461,15 @@
 #if !defined(UART_USE_MUTUAL_EXCLUSION) || defined(__DOXYGEN__)
 #define UART_USE_MUTUAL_EXCLUSION   TRUE
 #endif
+
+/**
+ * @brief   Enables the @p uartStartFrameReceive() and
+ *          @p uartGetFrameTimeout() APIs.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(UART_USE_FRAMES) || defined(__DOXYGEN__)
+#define UART_USE_FRAMES             FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -182,6 +182,39 @@ msg_t i2c_lld_master_transmit_timeout(I2CDriver *i2cp, i2caddr_t addr,
   return MSG_OK;
 }
 
+#if (I2C_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Starts a transfer via the I2C bus as master.
+ * @details The transfer is a write if @p rxbytes is zero, a read if
+ *          @p txbytes is zero, else a write followed by a read after a
+ *          repeated start. The function does not wait, the end of the
+ *          transfer is notified using @p _i2c_wakeup_isr() or
+ *          @p _i2c_wakeup_error_isr().
+ * @note    This function is invoked from within a critical zone, also
+ *          from the ISR completing the previous transfer.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] addr      slave device address
+ * @param[in] txbuf     pointer to the transmit buffer
+ * @param[in] txbytes   number of bytes to be transmitted
+ * @param[out] rxbuf    pointer to the receive buffer
+ * @param[in] rxbytes   number of bytes to be received
+ *
+ * @notapi
+ */
+void i2c_lld_start_transfer(I2CDriver *i2cp, i2caddr_t addr,
+                            const uint8_t *txbuf, size_t txbytes,
+                            uint8_t *rxbuf, size_t rxbytes) {
+
+  (void)i2cp;
+  (void)addr;
+  (void)txbuf;
+  (void)txbytes;
+  (void)rxbuf;
+  (void)rxbytes;
+}
+#endif /* I2C_USE_QUEUE == TRUE */
+
 #endif /* HAL_USE_I2C == TRUE */
 
 /** @} */
@@ -31,6 +31,11 @@
 /* Driver constants.                                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   This implementation supports the transactions queue.
+ */
+#define I2C_SUPPORTS_QUEUE                  TRUE
+
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -101,6 +106,16 @@ struct I2CDriver {
 #if (I2C_USE_MUTUAL_EXCLUSION == TRUE) || defined(__DOXYGEN__)
   mutex_t                   mutex;
 #endif
+#if (I2C_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Transaction being executed, head of the queue.
+   */
+  I2CTransaction            *qhead;
+  /**
+   * @brief   Last queued transaction.
+   */
+  I2CTransaction            *qtail;
+#endif
 #if defined(I2C_DRIVER_EXT_FIELDS)
   I2C_DRIVER_EXT_FIELDS
 #endif
@@ -141,6 +156,11 @@ extern "C" {
   msg_t i2c_lld_master_receive_timeout(I2CDriver *i2cp, i2caddr_t addr,
                                        uint8_t *rxbuf, size_t rxbytes,
                                        systime_t timeout);
+#if I2C_USE_QUEUE == TRUE
+  void i2c_lld_start_transfer(I2CDriver *i2cp, i2caddr_t addr,
+                              const uint8_t *txbuf, size_t txbytes,
+                              uint8_t *rxbuf, size_t rxbytes);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -306,6 +306,37 @@ const uint8_t *mac_lld_get_next_receive_buffer(MACReceiveDescriptor *rdp,
 
   return NULL;
 }
+
+/**
+ * @brief   Attaches a list of buffers to a transmit descriptor.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[in] tdp       pointer to a @p MACTransmitDescriptor structure
+ * @param[in] bp        pointer to an array of @p macbuffer_t structures
+ * @param[in] n         number of buffers
+ * @param[in] cb        callback invoked when the MAC is done with the
+ *                      buffers, it can be @p NULL
+ * @param[in] arg       parameter passed to the callback
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the buffers have been attached.
+ * @retval HAL_FAILED   the buffers cannot be attached.
+ *
+ * @notapi
+ */
+bool mac_lld_attach_transmit_buffers(MACDriver *macp,
+                                     MACTransmitDescriptor *tdp,
+                                     const macbuffer_t *bp, unsigned n,
+                                     mactxcb_t cb, void *arg) {
+
+  (void)macp;
+  (void)tdp;
+  (void)bp;
+  (void)n;
+  (void)cb;
+  (void)arg;
+
+  return HAL_FAILED;
+}
 #endif /* MAC_USE_ZERO_COPY == TRUE */
 
 #endif /* HAL_USE_MAC == TRUE */
@@ -169,6 +169,10 @@ extern "C" {
                                             size_t *sizep);
   const uint8_t *mac_lld_get_next_receive_buffer(MACReceiveDescriptor *rdp,
                                                  size_t *sizep);
+  bool mac_lld_attach_transmit_buffers(MACDriver *macp,
+                                       MACTransmitDescriptor *tdp,
+                                       const macbuffer_t *bp, unsigned n,
+                                       mactxcb_t cb, void *arg);
 #endif
 #ifdef __cplusplus
 }
@@ -132,6 +132,12 @@ struct SDCDriver {
    * @brief Card RCA.
    */
   uint32_t                  rca;
+#if (SDC_USE_ASYNC == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief Asynchronous requests queue.
+   */
+  BlockIOQueue              queue;
+#endif
   /* End of the mandatory fields.*/
 };
 
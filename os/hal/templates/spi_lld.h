@@ -109,6 +109,20 @@ struct SPIDriver {
    */
   mutex_t                   mutex;
 #endif
+#if (SPI_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Transaction being executed, head of the queue.
+   */
+  SPITransaction            *qhead;
+  /**
+   * @brief   Last queued transaction.
+   */
+  SPITransaction            *qtail;
+  /**
+   * @brief   Index of the transfer being executed.
+   */
+  size_t                    qstep;
+#endif
 #if defined(SPI_DRIVER_EXT_FIELDS)
   SPI_DRIVER_EXT_FIELDS
 #endif
@@ -186,6 +186,54 @@ size_t uart_lld_stop_receive(UARTDriver *uartp) {
   return 0;
 }
 
+#if (UART_USE_FRAMES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Starts a continuous receive operation into a circular buffer.
+ * @note    The driver must invoke @p _uart_rx_frame_isr() when the half and
+ *          the end of the buffer are reached and when the line goes idle.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @param[in] n         size of the circular buffer
+ * @param[out] ring     pointer to the circular buffer
+ *
+ * @notapi
+ */
+void uart_lld_start_ring(UARTDriver *uartp, size_t n, uint8_t *ring) {
+
+  (void)uartp;
+  (void)n;
+  (void)ring;
+
+}
+
+/**
+ * @brief   Stops the continuous receive operation.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ *
+ * @notapi
+ */
+void uart_lld_stop_ring(UARTDriver *uartp) {
+
+  (void)uartp;
+
+}
+
+/**
+ * @brief   Returns the space left before the end of the circular buffer.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @return              The number of bytes to be received before the
+ *                      circular buffer wraps.
+ *
+ * @notapi
+ */
+size_t uart_lld_get_ring_remaining(UARTDriver *uartp) {
+
+  return uartp->frcfg->size;
+}
+#endif /* UART_USE_FRAMES == TRUE */
+
 #endif /* HAL_USE_UART == TRUE */
 
 /** @} */
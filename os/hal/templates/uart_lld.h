@@ -31,6 +31,11 @@
 /* Driver constants.                                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   This implementation supports the framed receive mode.
+ */
+#define UART_SUPPORTS_FRAMES                TRUE
+
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -163,6 +168,28 @@ struct UARTDriver {
    */
   mutex_t                   mutex;
 #endif /* UART_USE_MUTUAL_EXCLUSION */
+#if (UART_USE_FRAMES == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Framed receive configuration.
+   */
+  const UARTFrameConfig     *frcfg;
+  /**
+   * @brief   Circular buffer read index.
+   */
+  size_t                    frrdidx;
+  /**
+   * @brief   Size of the frame being assembled.
+   */
+  size_t                    frn;
+  /**
+   * @brief   The frame being assembled is going to be dropped.
+   */
+  bool                      frdiscard;
+  /**
+   * @brief   Frames dropped because too long or because the queue was full.
+   */
+  uint32_t                  frdropped;
+#endif /* UART_USE_FRAMES */
 #if defined(UART_DRIVER_EXT_FIELDS)
   UART_DRIVER_EXT_FIELDS
 #endif
@@ -191,6 +218,11 @@ extern "C" {
   size_t uart_lld_stop_send(UARTDriver *uartp);
   void uart_lld_start_receive(UARTDriver *uartp, size_t n, void *rxbuf);
   size_t uart_lld_stop_receive(UARTDriver *uartp);
+#if UART_USE_FRAMES == TRUE
+  void uart_lld_start_ring(UARTDriver *uartp, size_t n, uint8_t *ring);
+  void uart_lld_stop_ring(UARTDriver *uartp);
+  size_t uart_lld_get_ring_remaining(UARTDriver *uartp);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -126,6 +126,16 @@ typedef struct nil_thread thread_t;
 #define NIL_THD_IS_WTOREVT(tr)  ((tr)->state == NIL_STATE_WTOREVT)
 /** @} */
 
+/**
+ * @name    Timeouts list related macros
+ * @{
+ */
+#define NIL_TMLIST_END          ((uint8_t)NIL_CFG_NUM_THREADS) /**< @brief
+                                                 End of the list marker.    */
+#define NIL_TMLIST_NONE         ((uint8_t)0xFF) /**< @brief Thread not in
+                                                 the timeouts list.         */
+/** @} */
+
 /**
  * @name    Events related macros
  * @{
@@ -184,6 +194,23 @@ typedef struct nil_thread thread_t;
 #define NIL_CFG_ST_TIMEDELTA                0
 #endif
 
+/**
+ * @brief   Sorted timeouts list.
+ * @details If enabled then the threads waiting with a timeout are kept in
+ *          a delta list ordered by expiration time, the timer handler only
+ *          processes the threads at the head of the list instead of
+ *          scanning the whole threads array.
+ * @note    When enabled the @p timeout field of the threads in the list
+ *          holds the delta from the previous thread in the list.
+ * @note    The list links are 8 bits thread indexes stored in the
+ *          @p thread_t padding, the RAM cost is a single byte in the
+ *          system structure.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(NIL_CFG_USE_TIMEOUT_LIST) || defined(__DOXYGEN__)
+#define NIL_CFG_USE_TIMEOUT_LIST            FALSE
+#endif
+
 /**
  * @brief   Events Flags APIs.
  * @details If enabled then the event flags APIs are included in the kernel.
@@ -194,6 +221,27 @@ typedef struct nil_thread thread_t;
 #define NIL_CFG_USE_EVENTS                  TRUE
 #endif
 
+/**
+ * @brief   Mailboxes APIs.
+ * @details If enabled then the mailboxes APIs are included in the kernel.
+ *
+ * @note    The default is @p TRUE.
+ */
+#if !defined(NIL_CFG_USE_MAILBOXES) || defined(__DOXYGEN__)
+#define NIL_CFG_USE_MAILBOXES               TRUE
+#endif
+
+/**
+ * @brief   Memory pools APIs.
+ * @details If enabled then the fixed size memory pools APIs are included
+ *          in the kernel.
+ *
+ * @note    The default is @p TRUE.
+ */
+#if !defined(NIL_CFG_USE_MEMPOOLS) || defined(__DOXYGEN__)
+#define NIL_CFG_USE_MEMPOOLS                TRUE
+#endif
+
 /**
  * @brief   System assertions.
  */
@@ -322,6 +370,66 @@ struct nil_semaphore {
   volatile cnt_t    cnt;        /**< @brief Semaphore counter.              */
 };
 
+/**
+ * @brief   Type of a structure representing a binary semaphore.
+ */
+typedef struct nil_binary_semaphore binary_semaphore_t;
+
+/**
+ * @brief   Structure representing a binary semaphore.
+ * @note    The counter of the underlying semaphore is one when the
+ *          semaphore is not taken, zero or negative when taken.
+ */
+struct nil_binary_semaphore {
+  semaphore_t       sem;        /**< @brief Underlying semaphore.           */
+};
+
+#if (NIL_CFG_USE_MAILBOXES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of a structure representing a mailbox.
+ */
+typedef struct nil_mailbox mailbox_t;
+
+/**
+ * @brief   Structure representing a mailbox.
+ */
+struct nil_mailbox {
+  msg_t             *buffer;    /**< @brief Pointer to the mailbox buffer.  */
+  msg_t             *top;       /**< @brief Pointer to the location after
+                                            the buffer.                     */
+  msg_t             *wrptr;     /**< @brief Write pointer.                  */
+  msg_t             *rdptr;     /**< @brief Read pointer.                   */
+  semaphore_t       fullsem;    /**< @brief Full counter semaphore.         */
+  semaphore_t       emptysem;   /**< @brief Empty counter semaphore.        */
+};
+#endif
+
+#if (NIL_CFG_USE_MEMPOOLS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Memory pool free object header.
+ */
+struct pool_header {
+  struct pool_header *next;     /**< @brief Pointer to the next pool
+                                            header in the list.             */
+};
+
+/**
+ * @brief   Type of a structure representing a memory pool.
+ */
+typedef struct nil_memory_pool memory_pool_t;
+
+/**
+ * @brief   Structure representing a memory pool.
+ * @note    Unlike the RT pools there is no memory provider, the objects
+ *          are only taken from the memory loaded into the pool.
+ */
+struct nil_memory_pool {
+  struct pool_header *next;     /**< @brief Pointer to the first free
+                                            object.                         */
+  size_t            object_size;/**< @brief Memory pool objects size.       */
+};
+#endif
+
 /**
  * @brief Thread function.
  */
@@ -354,6 +462,10 @@ typedef thread_t * thread_reference_t;
 struct nil_thread {
   intctx_t              *ctxp;  /**< @brief Pointer to internal context.    */
   tstate_t              state;  /**< @brief Thread state.                   */
+#if (NIL_CFG_USE_TIMEOUT_LIST == TRUE) || defined(__DOXYGEN__)
+  uint8_t               tmnext; /**< @brief Index of the next thread in the
+                                            timeouts list.                  */
+#endif
   /* Note, the following union contains a pointer while the thread is in a
      sleeping state (!NIL_THD_IS_READY()) else contains the wake-up message.*/
   union {
@@ -413,6 +525,13 @@ struct nil_system {
    * @brief   Time of the next scheduled tick event.
    */
   systime_t             nexttime;
+#endif
+#if (NIL_CFG_USE_TIMEOUT_LIST == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Index of the first thread in the timeouts list.
+   * @note    The value @p NIL_TMLIST_END means that the list is empty.
+   */
+  uint8_t               tmhead;
 #endif
   /**
    * @brief   Thread structures for all the defined threads.
@@ -459,6 +578,96 @@ struct nil_system {
 };
 /** @} */
 
+/**
+ * @name    Static objects initializers
+ * @{
+ */
+/**
+ * @brief   Data part of a static semaphore initializer.
+ *
+ * @param[in] name      the name of the semaphore variable
+ * @param[in] n         the counter initial value, this value must be
+ *                      non-negative
+ */
+#define _SEMAPHORE_DATA(name, n) {n}
+
+/**
+ * @brief   Static semaphore initializer.
+ *
+ * @param[in] name      the name of the semaphore variable
+ * @param[in] n         the counter initial value, this value must be
+ *                      non-negative
+ */
+#define SEMAPHORE_DECL(name, n) semaphore_t name = _SEMAPHORE_DATA(name, n)
+
+/**
+ * @brief   Data part of a static binary semaphore initializer.
+ *
+ * @param[in] name      the name of the binary semaphore variable
+ * @param[in] taken     the semaphore initial state
+ */
+#define _BSEMAPHORE_DATA(name, taken)                                       \
+  {_SEMAPHORE_DATA(name.sem, ((taken) ? 0 : 1))}
+
+/**
+ * @brief   Static binary semaphore initializer.
+ *
+ * @param[in] name      the name of the binary semaphore variable
+ * @param[in] taken     the semaphore initial state
+ */
+#define BSEMAPHORE_DECL(name, taken)                                        \
+  binary_semaphore_t name = _BSEMAPHORE_DATA(name, taken)
+
+#if (NIL_CFG_USE_MAILBOXES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Data part of a static mailbox initializer.
+ *
+ * @param[in] name      the name of the mailbox variable
+ * @param[in] buffer    pointer to the mailbox buffer area
+ * @param[in] size      size of the mailbox buffer area
+ */
+#define _MAILBOX_DATA(name, buffer, size) {                                 \
+  (msg_t *)(buffer),                                                        \
+  (msg_t *)(buffer) + (size),                                               \
+  (msg_t *)(buffer),                                                        \
+  (msg_t *)(buffer),                                                        \
+  _SEMAPHORE_DATA(name.fullsem, 0),                                         \
+  _SEMAPHORE_DATA(name.emptysem, size),                                     \
+}
+
+/**
+ * @brief   Static mailbox initializer.
+ *
+ * @param[in] name      the name of the mailbox variable
+ * @param[in] buffer    pointer to the mailbox buffer area
+ * @param[in] size      size of the mailbox buffer area
+ */
+#define MAILBOX_DECL(name, buffer, size)                                    \
+  mailbox_t name = _MAILBOX_DATA(name, buffer, size)
+#endif
+
+#if (NIL_CFG_USE_MEMPOOLS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Data part of a static memory pool initializer.
+ *
+ * @param[in] name      the name of the memory pool variable
+ * @param[in] size      size of the memory pool contained objects
+ */
+#define _MEMORYPOOL_DATA(name, size) {NULL, size}
+
+/**
+ * @brief   Static memory pool initializer.
+ * @details Statically initialized memory pools require no explicit
+ *          initialization using @p chPoolObjectInit().
+ *
+ * @param[in] name      the name of the memory pool variable
+ * @param[in] size      size of the memory pool contained objects
+ */
+#define MEMORYPOOL_DECL(name, size)                                         \
+  memory_pool_t name = _MEMORYPOOL_DATA(name, size)
+#endif
+/** @} */
+
 /**
  * @name    Working Areas and Alignment
  */
@@ -880,6 +1089,194 @@ struct nil_system {
  */
 #define chSemGetCounterI(sp) ((sp)->cnt)
 
+/**
+ * @brief   Initializes a binary semaphore.
+ *
+ * @param[out] bsp      pointer to a @p binary_semaphore_t structure
+ * @param[in] taken     initial state of the binary semaphore:
+ *                      - @a false, the initial state is not taken.
+ *                      - @a true, the initial state is taken.
+ *                      .
+ *
+ * @init
+ */
+#define chBSemObjectInit(bsp, taken)                                        \
+  chSemObjectInit(&(bsp)->sem, (taken) ? (cnt_t)0 : (cnt_t)1)
+
+/**
+ * @brief   Wait operation on the binary semaphore.
+ *
+ * @param[in] bsp       pointer to a @p binary_semaphore_t structure
+ * @return              A message specifying how the invoking thread has been
+ *                      released from the semaphore.
+ *
+ * @api
+ */
+#define chBSemWait(bsp) chSemWait(&(bsp)->sem)
+
+/**
+ * @brief   Wait operation on the binary semaphore.
+ *
+ * @param[in] bsp       pointer to a @p binary_semaphore_t structure
+ * @return              A message specifying how the invoking thread has been
+ *                      released from the semaphore.
+ *
+ * @sclass
+ */
+#define chBSemWaitS(bsp) chSemWaitS(&(bsp)->sem)
+
+/**
+ * @brief   Wait operation on the binary semaphore with timeout.
+ *
+ * @param[in] bsp       pointer to a @p binary_semaphore_t structure
+ * @param[in] timeout   the number of ticks before the operation timeouts
+ * @return              A message specifying how the invoking thread has been
+ *                      released from the semaphore.
+ *
+ * @api
+ */
+#define chBSemWaitTimeout(bsp, timeout)                                     \
+  chSemWaitTimeout(&(bsp)->sem, timeout)
+
+/**
+ * @brief   Wait operation on the binary semaphore with timeout.
+ *
+ * @param[in] bsp       pointer to a @p binary_semaphore_t structure
+ * @param[in] timeout   the number of ticks before the operation timeouts
+ * @return              A message specifying how the invoking thread has been
+ *                      released from the semaphore.
+ *
+ * @sclass
+ */
+#define chBSemWaitTimeoutS(bsp, timeout)                                    \
+  chSemWaitTimeoutS(&(bsp)->sem, timeout)
+
+/**
+ * @brief   Reset operation on the binary semaphore.
+ * @note    The released threads can recognize they were waked up by a reset
+ *          rather than a signal because the @p chBSemWait() will return
+ *          @p MSG_RESET instead of @p MSG_OK.
+ *
+ * @param[in] bsp       pointer to a @p binary_semaphore_t structure
+ * @param[in] taken     new state of the binary semaphore
+ *
+ * @api
+ */
+#define chBSemReset(bsp, taken)                                             \
+  chSemReset(&(bsp)->sem, (taken) ? (cnt_t)0 : (cnt_t)1)
+
+/**
+ * @brief   Reset operation on the binary semaphore.
+ *
+ * @param[in] bsp       pointer to a @p binary_semaphore_t structure
+ * @param[in] taken     new state of the binary semaphore
+ *
+ * @iclass
+ */
+#define chBSemResetI(bsp, taken)                                            \
+  chSemResetI(&(bsp)->sem, (taken) ? (cnt_t)0 : (cnt_t)1)
+
+/**
+ * @brief   Returns the binary semaphore current state.
+ *
+ * @param[in] bsp       pointer to a @p binary_semaphore_t structure
+ * @return              The binary semaphore current state.
+ * @retval false        if the binary semaphore is not taken.
+ * @retval true         if the binary semaphore is taken.
+ *
+ * @iclass
+ */
+#define chBSemGetStateI(bsp) ((bool)((bsp)->sem.cnt <= (cnt_t)0))
+
+#if (NIL_CFG_USE_EVENTS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Waits for any of the specified events.
+ *
+ * @param[in] mask      mask of the event flags that the function should wait
+ *                      for, @p ALL_EVENTS enables all the events
+ * @return              The mask of the served and cleared events.
+ *
+ * @api
+ */
+#define chEvtWaitAny(mask) chEvtWaitAnyTimeout(mask, TIME_INFINITE)
+#endif
+
+#if (NIL_CFG_USE_MAILBOXES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the mailbox buffer size.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @return              The size of the mailbox.
+ *
+ * @iclass
+ */
+#define chMBGetSizeI(mbp) ((size_t)((mbp)->top - (mbp)->buffer))
+
+/**
+ * @brief   Returns the number of free message slots into a mailbox.
+ * @note    Can be invoked in any system state but if invoked out of a
+ *          locked state then the returned value may change after reading.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @return              The number of empty message slots.
+ *
+ * @iclass
+ */
+#define chMBGetFreeCountI(mbp) chSemGetCounterI(&(mbp)->emptysem)
+
+/**
+ * @brief   Returns the number of used message slots into a mailbox.
+ * @note    Can be invoked in any system state but if invoked out of a
+ *          locked state then the returned value may change after reading.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @return              The number of queued messages.
+ *
+ * @iclass
+ */
+#define chMBGetUsedCountI(mbp) chSemGetCounterI(&(mbp)->fullsem)
+
+/**
+ * @brief   Returns the next message in the queue without removing it.
+ * @pre     A message must be waiting in the queue for this function to work
+ *          or it would return garbage. The correct way to use this macro is
+ *          to use @p chMBGetUsedCountI() and then use this macro, all within
+ *          a lock state.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @return              The next message in queue.
+ *
+ * @iclass
+ */
+#define chMBPeekI(mbp) (*(mbp)->rdptr)
+#endif
+
+#if (NIL_CFG_USE_MEMPOOLS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Adds an object to a memory pool.
+ * @note    This function is just an alias for @p chPoolFree() and has been
+ *          added for clarity.
+ *
+ * @param[in] mp        pointer to a @p memory_pool_t structure
+ * @param[in] objp      the pointer to the object to be added
+ *
+ * @api
+ */
+#define chPoolAdd(mp, objp) chPoolFree(mp, objp)
+
+/**
+ * @brief   Adds an object to a memory pool.
+ * @note    This function is just an alias for @p chPoolFreeI() and has been
+ *          added for clarity.
+ *
+ * @param[in] mp        pointer to a @p memory_pool_t structure
+ * @param[in] objp      the pointer to the object to be added
+ *
+ * @iclass
+ */
+#define chPoolAddI(mp, objp) chPoolFreeI(mp, objp)
+#endif
+
 /**
  * @brief   Current system time.
  * @details Returns the number of system ticks since the @p chSysInit()
@@ -988,10 +1385,36 @@ extern "C" {
   void chSemSignalI(semaphore_t *sp);
   void chSemReset(semaphore_t *sp, cnt_t n);
   void chSemResetI(semaphore_t *sp, cnt_t n);
+  void chBSemSignal(binary_semaphore_t *bsp);
+  void chBSemSignalI(binary_semaphore_t *bsp);
+#if NIL_CFG_USE_EVENTS == TRUE
   void chEvtSignal(thread_t *tp, eventmask_t mask);
   void chEvtSignalI(thread_t *tp, eventmask_t mask);
   eventmask_t chEvtWaitAnyTimeout(eventmask_t mask, systime_t timeout);
   eventmask_t chEvtWaitAnyTimeoutS(eventmask_t mask, systime_t timeout);
+#endif
+#if NIL_CFG_USE_MAILBOXES == TRUE
+  void chMBObjectInit(mailbox_t *mbp, msg_t *buf, cnt_t n);
+  void chMBReset(mailbox_t *mbp);
+  void chMBResetI(mailbox_t *mbp);
+  msg_t chMBPost(mailbox_t *mbp, msg_t msg, systime_t timeout);
+  msg_t chMBPostS(mailbox_t *mbp, msg_t msg, systime_t timeout);
+  msg_t chMBPostI(mailbox_t *mbp, msg_t msg);
+  msg_t chMBPostAhead(mailbox_t *mbp, msg_t msg, systime_t timeout);
+  msg_t chMBPostAheadS(mailbox_t *mbp, msg_t msg, systime_t timeout);
+  msg_t chMBPostAheadI(mailbox_t *mbp, msg_t msg);
+  msg_t chMBFetch(mailbox_t *mbp, msg_t *msgp, systime_t timeout);
+  msg_t chMBFetchS(mailbox_t *mbp, msg_t *msgp, systime_t timeout);
+  msg_t chMBFetchI(mailbox_t *mbp, msg_t *msgp);
+#endif
+#if NIL_CFG_USE_MEMPOOLS == TRUE
+  void chPoolObjectInit(memory_pool_t *mp, size_t size);
+  void chPoolLoadArray(memory_pool_t *mp, void *p, size_t n);
+  void *chPoolAllocI(memory_pool_t *mp);
+  void *chPoolAlloc(memory_pool_t *mp);
+  void chPoolFreeI(memory_pool_t *mp, void *objp);
+  void chPoolFree(memory_pool_t *mp, void *objp);
+#endif
 #ifdef __cplusplus
 }
 #endif
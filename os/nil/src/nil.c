@@ -48,6 +48,92 @@ nil_system_t nil;
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+#if (NIL_CFG_USE_TIMEOUT_LIST == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Inserts a thread in the timeouts list.
+ * @details The thread is inserted after all the threads with the same or
+ *          an earlier expiration time.
+ *
+ * @param[in] tp        pointer to the @p thread_t object
+ * @param[in] delta     expiration time relative to the list origin
+ *
+ * @notapi
+ */
+static void tmlist_insert(thread_t *tp, systime_t delta) {
+  uint8_t *lp = &nil.tmhead;
+
+  while ((*lp != NIL_TMLIST_END) && (nil.threads[*lp].timeout <= delta)) {
+    delta -= nil.threads[*lp].timeout;
+    lp = &nil.threads[*lp].tmnext;
+  }
+  if (*lp != NIL_TMLIST_END) {
+    nil.threads[*lp].timeout -= delta;
+  }
+  tp->timeout = delta;
+  tp->tmnext  = *lp;
+  *lp = (uint8_t)(tp - nil.threads);
+}
+
+/**
+ * @brief   Removes a thread from the timeouts list.
+ * @details The remaining time of the thread is transferred to the next
+ *          thread in the list so the following expirations are unchanged.
+ *
+ * @param[in] tp        pointer to the @p thread_t object
+ *
+ * @notapi
+ */
+static void tmlist_remove(thread_t *tp) {
+  uint8_t *lp = &nil.tmhead;
+
+  while (&nil.threads[*lp] != tp) {
+    chDbgAssert(*lp != NIL_TMLIST_END, "not in list");
+
+    lp = &nil.threads[*lp].tmnext;
+  }
+  *lp = tp->tmnext;
+  if (tp->tmnext != NIL_TMLIST_END) {
+    nil.threads[tp->tmnext].timeout += tp->timeout;
+  }
+  tp->tmnext = NIL_TMLIST_NONE;
+}
+
+/**
+ * @brief   Wakes up the expired threads at the head of the timeouts list.
+ *
+ * @notapi
+ */
+static void tmlist_expire(void) {
+
+  while (nil.tmhead != NIL_TMLIST_END) {
+    thread_t *tp = &nil.threads[nil.tmhead];
+
+    if (tp->timeout > (systime_t)0) {
+      break;
+    }
+
+    chDbgAssert(!NIL_THD_IS_READY(tp), "is ready");
+
+    /* Timeout on semaphores requires a special handling because the
+       semaphore counter must be incremented.*/
+    /*lint -save -e9013 [15.7] There is no else because it is not needed.*/
+    if (NIL_THD_IS_WTSEM(tp)) {
+      tp->u1.semp->cnt++;
+    }
+    else if (NIL_THD_IS_SUSP(tp)) {
+      *tp->u1.trp = NULL;
+    }
+    /*lint -restore*/
+    (void) chSchReadyI(tp, MSG_TIMEOUT);
+
+    /* Lock released in order to give a preemption chance on those
+       architectures supporting IRQ preemption.*/
+    chSysUnlockFromISR();
+    chSysLockFromISR();
+  }
+}
+#endif /* NIL_CFG_USE_TIMEOUT_LIST == TRUE */
+
 /*===========================================================================*/
 /* Module interrupt handlers.                                                */
 /*===========================================================================*/
@@ -77,6 +163,10 @@ void chSysInit(void) {
   /* System initialization hook.*/
   NIL_CFG_SYSTEM_INIT_HOOK();
 
+#if NIL_CFG_USE_TIMEOUT_LIST == TRUE
+  nil.tmhead = NIL_TMLIST_END;
+#endif
+
   /* Iterates through the list of defined threads.*/
   tp = &nil.threads[0];
   tcp = nil_thd_configs;
@@ -84,6 +174,9 @@ void chSysInit(void) {
 #if NIL_CFG_ENABLE_STACK_CHECK
     tp->stklim  = (stkalign_t *)tcp->wbase;
 #endif
+#if NIL_CFG_USE_TIMEOUT_LIST == TRUE
+    tp->tmnext  = NIL_TMLIST_NONE;
+#endif
 
     /* Port dependent thread initialization.*/
     PORT_SETUP_CONTEXT(tp, tcp->wend, tcp->funcp, tcp->arg);
@@ -148,7 +241,42 @@ void chSysHalt(const char *reason) {
  */
 void chSysTimerHandlerI(void) {
 
+#if NIL_CFG_USE_TIMEOUT_LIST == TRUE
 #if NIL_CFG_ST_TIMEDELTA == 0
+  nil.systime++;
+  if (nil.tmhead != NIL_TMLIST_END) {
+    /* Only the head of the list is decremented, the following threads
+       have their timeouts expressed as deltas.*/
+    chDbgAssert(nil.threads[nil.tmhead].timeout > (systime_t)0,
+                "zero delta");
+
+    nil.threads[nil.tmhead].timeout--;
+    tmlist_expire();
+  }
+#else
+  chDbgAssert(nil.nexttime == port_timer_get_alarm(), "time mismatch");
+
+  if (nil.tmhead != NIL_TMLIST_END) {
+    thread_t *tp = &nil.threads[nil.tmhead];
+
+    chDbgAssert(tp->timeout >= (nil.nexttime - nil.lasttime), "skipped one");
+
+    /* The head timeout is relative to the last tick event, the following
+       threads have their timeouts expressed as deltas.*/
+    tp->timeout -= nil.nexttime - nil.lasttime;
+  }
+  nil.lasttime = nil.nexttime;
+  tmlist_expire();
+  if (nil.tmhead != NIL_TMLIST_END) {
+    nil.nexttime += nil.threads[nil.tmhead].timeout;
+    port_timer_set_alarm(nil.nexttime);
+  }
+  else {
+    /* No tick event needed.*/
+    port_timer_stop_alarm();
+  }
+#endif
+#elif NIL_CFG_ST_TIMEDELTA == 0
   thread_t *tp = &nil.threads[0];
   nil.systime++;
   do {
@@ -366,6 +494,11 @@ thread_t *chSchReadyI(thread_t *tp, msg_t msg) {
   chDbgAssert(!NIL_THD_IS_READY(tp), "already ready");
   chDbgAssert(nil.next <= nil.current, "priority ordering");
 
+#if NIL_CFG_USE_TIMEOUT_LIST == TRUE
+  if (tp->tmnext != NIL_TMLIST_NONE) {
+    tmlist_remove(tp);
+  }
+#endif
   tp->u1.msg = msg;
   tp->state = NIL_STATE_READY;
   tp->timeout = (systime_t)0;
@@ -447,12 +580,22 @@ msg_t chSchGoSleepTimeoutS(tstate_t newstate, systime_t timeout) {
     }
 
     /* Timeout settings.*/
+#if NIL_CFG_USE_TIMEOUT_LIST == TRUE
+    tmlist_insert(otp, abstime - nil.lasttime);
+#else
     otp->timeout = abstime - nil.lasttime;
+#endif
   }
 #else
 
   /* Timeout settings.*/
+#if NIL_CFG_USE_TIMEOUT_LIST == TRUE
+  if (timeout != TIME_INFINITE) {
+    tmlist_insert(otp, timeout);
+  }
+#else
   otp->timeout = timeout;
+#endif
 #endif
 
   /* Scanning the whole threads array.*/
@@ -729,6 +872,43 @@ void chSemResetI(semaphore_t *sp, cnt_t n) {
   }
 }
 
+/**
+ * @brief   Performs a signal operation on a binary semaphore.
+ * @note    Signaling a binary semaphore which is not taken has no effect.
+ *
+ * @param[in] bsp       pointer to a @p binary_semaphore_t structure
+ *
+ * @api
+ */
+void chBSemSignal(binary_semaphore_t *bsp) {
+
+  chSysLock();
+  chBSemSignalI(bsp);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Performs a signal operation on a binary semaphore.
+ * @note    Signaling a binary semaphore which is not taken has no effect.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel. Note that
+ *          interrupt handlers always reschedule on exit so an explicit
+ *          reschedule must not be performed in ISRs.
+ *
+ * @param[in] bsp       pointer to a @p binary_semaphore_t structure
+ *
+ * @iclass
+ */
+void chBSemSignalI(binary_semaphore_t *bsp) {
+
+  if (bsp->sem.cnt < (cnt_t)1) {
+    chSemSignalI(&bsp->sem);
+  }
+}
+
+#if (NIL_CFG_USE_EVENTS == TRUE) || defined(__DOXYGEN__)
+
 /**
  * @brief   Adds a set of event flags directly to the specified @p thread_t.
  *
@@ -818,14 +998,10 @@ eventmask_t chEvtWaitAnyTimeoutS(eventmask_t mask, systime_t timeout) {
 
   if ((m = (ctp->epmask & mask)) == (eventmask_t)0) {
     if (TIME_IMMEDIATE == timeout) {
-      chSysUnlock();
-
       return (eventmask_t)0;
     }
     ctp->u1.ewmask = mask;
     if (chSchGoSleepTimeoutS(NIL_STATE_WTOREVT, timeout) < MSG_OK) {
-      chSysUnlock();
-
       return (eventmask_t)0;
     }
     m = ctp->epmask & mask;
@@ -834,5 +1010,478 @@ eventmask_t chEvtWaitAnyTimeoutS(eventmask_t mask, systime_t timeout) {
 
   return m;
 }
+#endif /* NIL_CFG_USE_EVENTS == TRUE */
+
+#if (NIL_CFG_USE_MAILBOXES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes a @p mailbox_t object.
+ *
+ * @param[out] mbp      the pointer to the @p mailbox_t structure to be
+ *                      initialized
+ * @param[in] buf       pointer to the messages buffer as an array of @p msg_t
+ * @param[in] n         number of elements in the buffer array
+ *
+ * @init
+ */
+void chMBObjectInit(mailbox_t *mbp, msg_t *buf, cnt_t n) {
+
+  chDbgAssert((mbp != NULL) && (buf != NULL) && (n > (cnt_t)0),
+              "invalid parameters");
+
+  mbp->buffer = buf;
+  mbp->rdptr  = buf;
+  mbp->wrptr  = buf;
+  mbp->top    = &buf[n];
+  chSemObjectInit(&mbp->emptysem, n);
+  chSemObjectInit(&mbp->fullsem, (cnt_t)0);
+}
+
+/**
+ * @brief   Resets a @p mailbox_t object.
+ * @details All the waiting threads are resumed with status @p MSG_RESET and
+ *          the queued messages are lost.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ *
+ * @api
+ */
+void chMBReset(mailbox_t *mbp) {
+
+  chSysLock();
+  chMBResetI(mbp);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Resets a @p mailbox_t object.
+ * @details All the waiting threads are resumed with status @p MSG_RESET and
+ *          the queued messages are lost.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel. Note that
+ *          interrupt handlers always reschedule on exit so an explicit
+ *          reschedule must not be performed in ISRs.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ *
+ * @iclass
+ */
+void chMBResetI(mailbox_t *mbp) {
+
+  mbp->wrptr = mbp->buffer;
+  mbp->rdptr = mbp->buffer;
+  chSemResetI(&mbp->emptysem, (cnt_t)(mbp->top - mbp->buffer));
+  chSemResetI(&mbp->fullsem, (cnt_t)0);
+}
+
+/**
+ * @brief   Posts a message into a mailbox.
+ * @details The invoking thread waits until a empty slot in the mailbox becomes
+ *          available or the specified time runs out.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] msg       the message to be posted on the mailbox
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly posted.
+ * @retval MSG_RESET    if the mailbox has been reset while waiting.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+msg_t chMBPost(mailbox_t *mbp, msg_t msg, systime_t timeout) {
+  msg_t rdymsg;
+
+  chSysLock();
+  rdymsg = chMBPostS(mbp, msg, timeout);
+  chSysUnlock();
+
+  return rdymsg;
+}
+
+/**
+ * @brief   Posts a message into a mailbox.
+ * @details The invoking thread waits until a empty slot in the mailbox becomes
+ *          available or the specified time runs out.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] msg       the message to be posted on the mailbox
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly posted.
+ * @retval MSG_RESET    if the mailbox has been reset while waiting.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @sclass
+ */
+msg_t chMBPostS(mailbox_t *mbp, msg_t msg, systime_t timeout) {
+  msg_t rdymsg;
+
+  rdymsg = chSemWaitTimeoutS(&mbp->emptysem, timeout);
+  if (rdymsg == MSG_OK) {
+    *mbp->wrptr++ = msg;
+    if (mbp->wrptr >= mbp->top) {
+      mbp->wrptr = mbp->buffer;
+    }
+    chSemSignalI(&mbp->fullsem);
+    chSchRescheduleS();
+  }
+
+  return rdymsg;
+}
+
+/**
+ * @brief   Posts a message into a mailbox.
+ * @details This variant is non-blocking, the function returns a timeout
+ *          condition if the queue is full.
+ * @note    The operation is constant time and never waits, it is meant to
+ *          be used by producers running in ISR context.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] msg       the message to be posted on the mailbox
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly posted.
+ * @retval MSG_TIMEOUT  if the mailbox is full and the message cannot be
+ *                      posted.
+ *
+ * @iclass
+ */
+msg_t chMBPostI(mailbox_t *mbp, msg_t msg) {
+
+  if (mbp->emptysem.cnt <= (cnt_t)0) {
+    return MSG_TIMEOUT;
+  }
+  mbp->emptysem.cnt--;
+  *mbp->wrptr++ = msg;
+  if (mbp->wrptr >= mbp->top) {
+    mbp->wrptr = mbp->buffer;
+  }
+  chSemSignalI(&mbp->fullsem);
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Posts an high priority message into a mailbox.
+ * @details The invoking thread waits until a empty slot in the mailbox becomes
+ *          available or the specified time runs out.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] msg       the message to be posted on the mailbox
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly posted.
+ * @retval MSG_RESET    if the mailbox has been reset while waiting.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+msg_t chMBPostAhead(mailbox_t *mbp, msg_t msg, systime_t timeout) {
+  msg_t rdymsg;
+
+  chSysLock();
+  rdymsg = chMBPostAheadS(mbp, msg, timeout);
+  chSysUnlock();
+
+  return rdymsg;
+}
+
+/**
+ * @brief   Posts an high priority message into a mailbox.
+ * @details The invoking thread waits until a empty slot in the mailbox becomes
+ *          available or the specified time runs out.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] msg       the message to be posted on the mailbox
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly posted.
+ * @retval MSG_RESET    if the mailbox has been reset while waiting.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @sclass
+ */
+msg_t chMBPostAheadS(mailbox_t *mbp, msg_t msg, systime_t timeout) {
+  msg_t rdymsg;
+
+  rdymsg = chSemWaitTimeoutS(&mbp->emptysem, timeout);
+  if (rdymsg == MSG_OK) {
+    if (--mbp->rdptr < mbp->buffer) {
+      mbp->rdptr = mbp->top - 1;
+    }
+    *mbp->rdptr = msg;
+    chSemSignalI(&mbp->fullsem);
+    chSchRescheduleS();
+  }
+
+  return rdymsg;
+}
+
+/**
+ * @brief   Posts an high priority message into a mailbox.
+ * @details This variant is non-blocking, the function returns a timeout
+ *          condition if the queue is full.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] msg       the message to be posted on the mailbox
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly posted.
+ * @retval MSG_TIMEOUT  if the mailbox is full and the message cannot be
+ *                      posted.
+ *
+ * @iclass
+ */
+msg_t chMBPostAheadI(mailbox_t *mbp, msg_t msg) {
+
+  if (mbp->emptysem.cnt <= (cnt_t)0) {
+    return MSG_TIMEOUT;
+  }
+  mbp->emptysem.cnt--;
+  if (--mbp->rdptr < mbp->buffer) {
+    mbp->rdptr = mbp->top - 1;
+  }
+  *mbp->rdptr = msg;
+  chSemSignalI(&mbp->fullsem);
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Retrieves a message from a mailbox.
+ * @details The invoking thread waits until a message is posted in the mailbox
+ *          or the specified time runs out.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[out] msgp     pointer to a message variable for the received message
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly fetched.
+ * @retval MSG_RESET    if the mailbox has been reset while waiting.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+msg_t chMBFetch(mailbox_t *mbp, msg_t *msgp, systime_t timeout) {
+  msg_t rdymsg;
+
+  chSysLock();
+  rdymsg = chMBFetchS(mbp, msgp, timeout);
+  chSysUnlock();
+
+  return rdymsg;
+}
+
+/**
+ * @brief   Retrieves a message from a mailbox.
+ * @details The invoking thread waits until a message is posted in the mailbox
+ *          or the specified time runs out.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[out] msgp     pointer to a message variable for the received message
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly fetched.
+ * @retval MSG_RESET    if the mailbox has been reset while waiting.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @sclass
+ */
+msg_t chMBFetchS(mailbox_t *mbp, msg_t *msgp, systime_t timeout) {
+  msg_t rdymsg;
+
+  rdymsg = chSemWaitTimeoutS(&mbp->fullsem, timeout);
+  if (rdymsg == MSG_OK) {
+    *msgp = *mbp->rdptr++;
+    if (mbp->rdptr >= mbp->top) {
+      mbp->rdptr = mbp->buffer;
+    }
+    chSemSignalI(&mbp->emptysem);
+    chSchRescheduleS();
+  }
+
+  return rdymsg;
+}
+
+/**
+ * @brief   Retrieves a message from a mailbox.
+ * @details This variant is non-blocking, the function returns a timeout
+ *          condition if the queue is empty.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[out] msgp     pointer to a message variable for the received message
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly fetched.
+ * @retval MSG_TIMEOUT  if the mailbox is empty and a message cannot be
+ *                      fetched.
+ *
+ * @iclass
+ */
+msg_t chMBFetchI(mailbox_t *mbp, msg_t *msgp) {
+
+  if (mbp->fullsem.cnt <= (cnt_t)0) {
+    return MSG_TIMEOUT;
+  }
+  mbp->fullsem.cnt--;
+  *msgp = *mbp->rdptr++;
+  if (mbp->rdptr >= mbp->top) {
+    mbp->rdptr = mbp->buffer;
+  }
+  chSemSignalI(&mbp->emptysem);
+
+  return MSG_OK;
+}
+#endif /* NIL_CFG_USE_MAILBOXES == TRUE */
+
+#if (NIL_CFG_USE_MEMPOOLS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes an empty memory pool.
+ *
+ * @param[out] mp       pointer to a @p memory_pool_t structure
+ * @param[in] size      the size of the objects contained in this memory pool,
+ *                      the minimum accepted size is the size of a pointer
+ *
+ * @init
+ */
+void chPoolObjectInit(memory_pool_t *mp, size_t size) {
+
+  chDbgAssert((mp != NULL) && (size >= sizeof(void *)),
+              "invalid parameters");
+
+  mp->next = NULL;
+  mp->object_size = size;
+}
+
+/**
+ * @brief   Loads a memory pool with an array of static objects.
+ * @pre     The memory pool must be already been initialized.
+ * @pre     The array elements must be of the right size for the specified
+ *          memory pool.
+ * @pre     The array elements must be aligned to the size of a pointer.
+ * @post    The memory pool contains the elements of the input array.
+ *
+ * @param[in] mp        pointer to a @p memory_pool_t structure
+ * @param[in] p         pointer to the array first element
+ * @param[in] n         number of elements in the array
+ *
+ * @api
+ */
+void chPoolLoadArray(memory_pool_t *mp, void *p, size_t n) {
+
+  chDbgAssert((mp != NULL) && (n != 0U), "invalid parameters");
+
+  while (n != 0U) {
+    chPoolAdd(mp, p);
+    /*lint -save -e9087 [11.3] Safe cast.*/
+    p = (void *)(((uint8_t *)p) + mp->object_size);
+    /*lint -restore*/
+    n--;
+  }
+}
+
+/**
+ * @brief   Allocates an object from a memory pool.
+ * @pre     The memory pool must be already been initialized.
+ *
+ * @param[in] mp        pointer to a @p memory_pool_t structure
+ * @return              The pointer to the allocated object.
+ * @retval NULL         if pool is empty.
+ *
+ * @iclass
+ */
+void *chPoolAllocI(memory_pool_t *mp) {
+  struct pool_header *objp;
+
+  objp = mp->next;
+  if (objp != NULL) {
+    mp->next = objp->next;
+  }
+
+  return objp;
+}
+
+/**
+ * @brief   Allocates an object from a memory pool.
+ * @pre     The memory pool must be already been initialized.
+ *
+ * @param[in] mp        pointer to a @p memory_pool_t structure
+ * @return              The pointer to the allocated object.
+ * @retval NULL         if pool is empty.
+ *
+ * @api
+ */
+void *chPoolAlloc(memory_pool_t *mp) {
+  void *objp;
+
+  chSysLock();
+  objp = chPoolAllocI(mp);
+  chSysUnlock();
+
+  return objp;
+}
+
+/**
+ * @brief   Releases an object into a memory pool.
+ * @pre     The memory pool must be already been initialized.
+ * @pre     The freed object must be of the right size for the specified
+ *          memory pool.
+ * @pre     The object must be aligned to the size of a pointer.
+ *
+ * @param[in] mp        pointer to a @p memory_pool_t structure
+ * @param[in] objp      the pointer to the object to be released
+ *
+ * @iclass
+ */
+void chPoolFreeI(memory_pool_t *mp, void *objp) {
+  struct pool_header *php = objp;
+
+  chDbgAssert(objp != NULL, "invalid object");
+
+  php->next = mp->next;
+  mp->next = php;
+}
+
+/**
+ * @brief   Releases an object into a memory pool.
+ * @pre     The memory pool must be already been initialized.
+ * @pre     The freed object must be of the right size for the specified
+ *          memory pool.
+ * @pre     The object must be aligned to the size of a pointer.
+ *
+ * @param[in] mp        pointer to a @p memory_pool_t structure
+ * @param[in] objp      the pointer to the object to be released
+ *
+ * @api
+ */
+void chPoolFree(memory_pool_t *mp, void *objp) {
+
+  chSysLock();
+  chPoolFreeI(mp, objp);
+  chSysUnlock();
+}
+#endif /* NIL_CFG_USE_MEMPOOLS == TRUE */
 
 /** @} */
@@ -75,6 +75,14 @@
  */
 #define NIL_CFG_ST_TIMEDELTA                2
 
+/**
+ * @brief   Sorted timeouts list.
+ * @details If enabled then the threads waiting with a timeout are kept in
+ *          a list ordered by expiration time, the timer handler only
+ *          processes the expiring threads instead of scanning all threads.
+ */
+#define NIL_CFG_USE_TIMEOUT_LIST            FALSE
+
 /** @} */
 
 /*===========================================================================*/
@@ -92,6 +100,23 @@
  */
 #define NIL_CFG_USE_EVENTS                  TRUE
 
+/**
+ * @brief   Mailboxes APIs.
+ * @details If enabled then the mailboxes APIs are included in the kernel.
+ *
+ * @note    The default is @p TRUE.
+ */
+#define NIL_CFG_USE_MAILBOXES               TRUE
+
+/**
+ * @brief   Memory pools APIs.
+ * @details If enabled then the fixed size memory pools APIs are included
+ *          in the kernel.
+ *
+ * @note    The default is @p TRUE.
+ */
+#define NIL_CFG_USE_MEMPOOLS                TRUE
+
 /** @} */
 
 /*===========================================================================*/
@@ -102,7 +102,7 @@ extern "C" {
   void chHeapObjectInit(memory_heap_t *heapp, void *buf, size_t size);
   void *chHeapAlloc(memory_heap_t *heapp, size_t size);
   void chHeapFree(void *p);
-  size_t chHeapStatus(memory_heap_t *heapp, size_t *sizep);
+  size_t chHeapStatus(memory_heap_t *heapp, size_t *totalp, size_t *largestp);
 #ifdef __cplusplus
 }
 #endif
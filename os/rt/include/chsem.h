@@ -38,6 +38,18 @@
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Semaphores notification callback.
+ * @details If enabled a callback can be attached to a semaphore, it is
+ *          invoked when the counter is incremented above zero. It allows
+ *          entities other than threads, like the stackless tasks
+ *          executor, to wait on semaphores and mailboxes.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_USE_SEMAPHORES_NOTIFY) || defined(__DOXYGEN__)
+#define CH_CFG_USE_SEMAPHORES_NOTIFY        FALSE
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -46,14 +58,33 @@
 /* Module data structures and types.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Type of a semaphore structure.
+ */
+typedef struct ch_semaphore semaphore_t;
+
+#if (CH_CFG_USE_SEMAPHORES_NOTIFY == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Semaphore notification callback type.
+ * @note    The callback is invoked from within the kernel lock zone, only
+ *          I-class functions can be used.
+ */
+typedef void (*semnotify_t)(semaphore_t *sp, void *arg);
+#endif
+
 /**
  * @brief   Semaphore structure.
  */
-typedef struct ch_semaphore {
+struct ch_semaphore {
   threads_queue_t       s_queue;    /**< @brief Queue of the threads sleeping
                                                 on this semaphore.          */
   cnt_t                 s_cnt;      /**< @brief The semaphore counter.      */
-} semaphore_t;
+#if (CH_CFG_USE_SEMAPHORES_NOTIFY == TRUE) || defined(__DOXYGEN__)
+  semnotify_t           s_notify;   /**< @brief Notification callback or
+                                                @p NULL.                    */
+  void                  *s_arg;     /**< @brief Callback argument.          */
+#endif
+};
 
 /*===========================================================================*/
 /* Module macros.                                                            */
@@ -68,7 +99,12 @@ typedef struct ch_semaphore {
  * @param[in] n         the counter initial value, this value must be
  *                      non-negative
  */
+#if (CH_CFG_USE_SEMAPHORES_NOTIFY == TRUE) || defined(__DOXYGEN__)
+#define _SEMAPHORE_DATA(name, n) {_THREADS_QUEUE_DATA(name.s_queue), n,     \
+                                  NULL, NULL}
+#else
 #define _SEMAPHORE_DATA(name, n) {_THREADS_QUEUE_DATA(name.s_queue), n}
+#endif
 
 /**
  * @brief   Static semaphore initializer.
@@ -153,6 +189,29 @@ static inline cnt_t chSemGetCounterI(semaphore_t *sp) {
   return sp->s_cnt;
 }
 
+#if (CH_CFG_USE_SEMAPHORES_NOTIFY == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Sets the notification callback of a semaphore.
+ * @details The callback is invoked when a signal, reset or counter
+ *          addition leaves the counter above zero, the threads waiting on
+ *          the semaphore are served first.
+ *
+ * @param[in] sp        pointer to a @p semaphore_t structure
+ * @param[in] notify    the callback or @p NULL
+ * @param[in] arg       the callback argument
+ *
+ * @iclass
+ */
+static inline void chSemSetNotifyI(semaphore_t *sp, semnotify_t notify,
+                                   void *arg) {
+
+  chDbgCheckClassI();
+
+  sp->s_notify = notify;
+  sp->s_arg    = arg;
+}
+#endif
+
 #endif /* CH_CFG_USE_SEMAPHORES == TRUE */
 
 #endif /* _CHSEM_H_ */
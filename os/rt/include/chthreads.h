@@ -233,6 +233,37 @@ static inline bool chThdShouldTerminateX(void) {
   return (bool)((chThdGetSelfX()->p_flags & CH_FLAG_TERMINATE) != (tmode_t)0);
 }
 
+/**
+ * @brief   Requests a thread termination.
+ * @details This is the I-class variant of @p chThdTerminate().
+ *
+ * @param[in] tp        pointer to the thread
+ *
+ * @iclass
+ */
+static inline void chThdTerminateI(thread_t *tp) {
+
+  chDbgCheckClassI();
+
+  tp->p_flags |= CH_FLAG_TERMINATE;
+}
+
+/**
+ * @brief   Clears a pending termination request.
+ * @details Threads executing a sequence of jobs can clear a request
+ *          that arrived after the end of the previous job.
+ *
+ * @param[in] tp        pointer to the thread
+ *
+ * @iclass
+ */
+static inline void chThdClearTerminateI(thread_t *tp) {
+
+  chDbgCheckClassI();
+
+  tp->p_flags &= (tmode_t)~CH_FLAG_TERMINATE;
+}
+
 /**
  * @brief   Resumes a thread created with @p chThdCreateI().
  *
@@ -258,15 +258,17 @@ void chHeapFree(void *p) {
  *
  * @param[in] heapp     pointer to a heap descriptor or @p NULL in order to
  *                      access the default heap.
- * @param[in] sizep     pointer to a variable that will receive the total
- *                      fragmented free space
+ * @param[in] totalp    pointer to a variable that will receive the total
+ *                      fragmented free space or @p NULL
+ * @param[in] largestp  pointer to a variable that will receive the size of
+ *                      the largest free block or @p NULL
  * @return              The number of fragments in the heap.
  *
  * @api
  */
-size_t chHeapStatus(memory_heap_t *heapp, size_t *sizep) {
+size_t chHeapStatus(memory_heap_t *heapp, size_t *totalp, size_t *largestp) {
   union heap_header *qp;
-  size_t n, sz;
+  size_t n, sz, lsz;
 
   if (heapp == NULL) {
     heapp = &default_heap;
@@ -274,15 +276,22 @@ size_t chHeapStatus(memory_heap_t *heapp, size_t *sizep) {
 
   H_LOCK(heapp);
   sz = 0;
+  lsz = 0;
   n = 0;
   qp = &heapp->h_free;
   while (qp->h.u.next != NULL) {
     sz += qp->h.u.next->h.size;
+    if (qp->h.u.next->h.size > lsz) {
+      lsz = qp->h.u.next->h.size;
+    }
     n++;
     qp = qp->h.u.next;
   }
-  if (sizep != NULL) {
-    *sizep = sz;
+  if (totalp != NULL) {
+    *totalp = sz;
+  }
+  if (largestp != NULL) {
+    *largestp = lsz;
   }
   H_UNLOCK(heapp);
 
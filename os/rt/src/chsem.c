@@ -81,6 +81,20 @@
 #define sem_insert(tp, qp) queue_insert(tp, qp)
 #endif
 
+#if (CH_CFG_USE_SEMAPHORES_NOTIFY == TRUE) || defined(__DOXYGEN__)
+/*
+ * Invokes the notification callback if the counter is positive.
+ */
+static void sem_notify(semaphore_t *sp) {
+
+  if ((sp->s_notify != NULL) && (sp->s_cnt > (cnt_t)0)) {
+    sp->s_notify(sp, sp->s_arg);
+  }
+}
+#else
+#define sem_notify(sp)
+#endif
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -100,6 +114,10 @@ void chSemObjectInit(semaphore_t *sp, cnt_t n) {
 
   queue_init(&sp->s_queue);
   sp->s_cnt = n;
+#if CH_CFG_USE_SEMAPHORES_NOTIFY == TRUE
+  sp->s_notify = NULL;
+  sp->s_arg    = NULL;
+#endif
 }
 
 /**
@@ -158,6 +176,7 @@ void chSemResetI(semaphore_t *sp, cnt_t n) {
   while (++cnt <= (cnt_t)0) {
     chSchReadyI(queue_lifo_remove(&sp->s_queue))->p_u.rdymsg = MSG_RESET;
   }
+  sem_notify(sp);
 }
 
 /**
@@ -302,6 +321,12 @@ void chSemSignal(semaphore_t *sp) {
   if (++sp->s_cnt <= (cnt_t)0) {
     chSchWakeupS(queue_fifo_remove(&sp->s_queue), MSG_OK);
   }
+#if CH_CFG_USE_SEMAPHORES_NOTIFY == TRUE
+  else {
+    sem_notify(sp);
+    chSchRescheduleS();
+  }
+#endif
   chSysUnlock();
 }
 
@@ -331,6 +356,11 @@ void chSemSignalI(semaphore_t *sp) {
     tp->p_u.rdymsg = MSG_OK;
     (void) chSchReadyI(tp);
   }
+#if CH_CFG_USE_SEMAPHORES_NOTIFY == TRUE
+  else {
+    sem_notify(sp);
+  }
+#endif
 }
 
 /**
@@ -360,6 +390,7 @@ void chSemAddCounterI(semaphore_t *sp, cnt_t n) {
     }
     n--;
   }
+  sem_notify(sp);
 }
 
 /**
@@ -390,6 +421,7 @@ msg_t chSemSignalWait(semaphore_t *sps, semaphore_t *spw) {
   if (++sps->s_cnt <= (cnt_t)0) {
     chSchReadyI(queue_fifo_remove(&sps->s_queue))->p_u.rdymsg = MSG_OK;
   }
+  sem_notify(sps);
   if (--spw->s_cnt < (cnt_t)0) {
     thread_t *ctp = currp;
     sem_insert(ctp, &spw->s_queue);
@@ -176,6 +176,16 @@
  */
 #define CH_CFG_USE_SEMAPHORES_PRIORITY      FALSE
 
+/**
+ * @brief   Semaphores notification callback.
+ * @details If enabled then a callback can be attached to semaphores, it
+ *          is invoked when the counter is incremented above zero.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_SEMAPHORES.
+ */
+#define CH_CFG_USE_SEMAPHORES_NOTIFY        FALSE
+
 /**
  * @brief   Mutexes APIs.
  * @details If enabled then the mutexes APIs are included in the kernel.
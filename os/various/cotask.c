@@ -0,0 +1,636 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    cotask.c
+ * @brief   Stackless tasks code.
+ *
+ * @addtogroup cotask
+ * @{
+ */
+
+#include "ch.h"
+#include "cotask.h"
+
+/*
+ * Wait types.
+ */
+#define CO_WAIT_NONE                0U
+#define CO_WAIT_SLEEP               1U
+#define CO_WAIT_EVENTS              2U
+#define CO_WAIT_SEM                 3U
+#define CO_WAIT_MBFETCH             4U
+#define CO_WAIT_MBPOST              5U
+
+/*
+ * Appends a task to the ready FIFO.
+ */
+static void co_ready_i(co_executor_t *exp, co_task_t *ctp) {
+
+  ctp->next = NULL;
+  if (exp->ready == NULL)
+    exp->ready = ctp;
+  else
+    exp->readytail->next = ctp;
+  exp->readytail = ctp;
+}
+
+/*
+ * Time before the wait timeout of a task, zero if already expired.
+ */
+static systime_t co_remaining(co_task_t *ctp, systime_t now) {
+  systime_t elapsed = (systime_t)(now - ctp->wstart);
+
+  if (elapsed >= ctp->wtime)
+    return (systime_t)0;
+  return (systime_t)(ctp->wtime - elapsed);
+}
+
+/*
+ * Tries to complete the wait operation of a task, the received events are
+ * not consumed here because they are delivered to all the waiting tasks.
+ */
+static bool co_try_s(co_task_t *ctp) {
+
+  switch (ctp->wkind) {
+  case CO_WAIT_EVENTS:
+    if ((ctp->executor->events & ctp->wdata.events) != (eventmask_t)0) {
+      ctp->wdata.events &= ctp->executor->events;
+      return true;
+    }
+    return false;
+#if CH_CFG_USE_SEMAPHORES_NOTIFY
+  case CO_WAIT_SEM:
+    if (chSemGetCounterI((semaphore_t *)ctp->wobj) > (cnt_t)0) {
+      chSemFastWaitI((semaphore_t *)ctp->wobj);
+      return true;
+    }
+    return false;
+#endif
+#if CH_CFG_USE_MAILBOXES && CH_CFG_USE_SEMAPHORES_NOTIFY
+  case CO_WAIT_MBFETCH:
+    return chMBFetchI((mailbox_t *)ctp->wobj, ctp->wdata.msgp) == MSG_OK;
+  case CO_WAIT_MBPOST:
+    return chMBPostI((mailbox_t *)ctp->wobj, ctp->wdata.msg) == MSG_OK;
+#endif
+  default:
+    return false;
+  }
+}
+
+#if CH_CFG_USE_SEMAPHORES_NOTIFY
+/*
+ * Semaphore notification callback, the executor checks its waiting tasks
+ * on the next pass.
+ */
+static void co_notify(semaphore_t *sp, void *arg) {
+  co_executor_t *exp = (co_executor_t *)arg;
+
+  (void)sp;
+
+  exp->notified = true;
+  if ((exp->thread != NULL) && !exp->running)
+    chEvtSignalI(exp->thread, CO_WAKEUP_EVENT);
+}
+#endif
+
+/*
+ * Attaches the executor to the semaphore guarding the waited object, the
+ * mailboxes are waited on their internal counters.
+ */
+static void co_bind_s(co_task_t *ctp) {
+#if CH_CFG_USE_SEMAPHORES_NOTIFY
+  semaphore_t *sp;
+
+  switch (ctp->wkind) {
+  case CO_WAIT_SEM:
+    sp = (semaphore_t *)ctp->wobj;
+    break;
+#if CH_CFG_USE_MAILBOXES
+  case CO_WAIT_MBFETCH:
+    sp = &((mailbox_t *)ctp->wobj)->mb_fullsem;
+    break;
+  case CO_WAIT_MBPOST:
+    sp = &((mailbox_t *)ctp->wobj)->mb_emptysem;
+    break;
+#endif
+  default:
+    return;
+  }
+  chSemSetNotifyI(sp, co_notify, ctp->executor);
+#else
+  (void)ctp;
+#endif
+}
+
+/*
+ * Common wait code, the operation is attempted immediately and, if it
+ * cannot complete, the task is put in the waiting list.
+ */
+static bool co_wait(co_task_t *ctp, uint8_t wkind, void *wobj,
+                    systime_t time) {
+  co_executor_t *exp = ctp->executor;
+  bool done;
+
+  ctp->wkind = wkind;
+  ctp->wobj  = wobj;
+
+  chSysLock();
+  done = co_try_s(ctp);
+  if (!done && (time != TIME_IMMEDIATE))
+    co_bind_s(ctp);
+  chSchRescheduleS();
+  chSysUnlock();
+
+  if (done) {
+    if (wkind == CO_WAIT_EVENTS)
+      exp->events &= ~ctp->wdata.events;
+    ctp->result = MSG_OK;
+    return true;
+  }
+  if (time == TIME_IMMEDIATE) {
+    if (wkind == CO_WAIT_EVENTS)
+      ctp->wdata.events = (eventmask_t)0;
+    ctp->result = MSG_TIMEOUT;
+    return true;
+  }
+  ctp->wstart  = chVTGetSystemTimeX();
+  ctp->wtime   = time;
+  ctp->next    = exp->waiting;
+  exp->waiting = ctp;
+  if (time != TIME_INFINITE) {
+    systime_t deadline = (systime_t)(ctp->wstart - exp->wlast) + time;
+
+    if (deadline < exp->wnext)
+      exp->wnext = deadline;
+  }
+  return false;
+}
+
+/*
+ * Moves the tasks whose wait is over in the ready FIFO, returns the time
+ * before the next timeout.
+ */
+static systime_t co_dispatch(co_executor_t *exp, bool check) {
+  co_task_t *ctp, **ctpp;
+  eventmask_t delivered = (eventmask_t)0;
+  systime_t now = chVTGetSystemTimeX();
+  systime_t next = TIME_INFINITE;
+  systime_t elapsed;
+
+  /* The sleeping tasks are ordered by deadline, only the expired ones are
+     touched.*/
+  while (((ctp = exp->delayed) != NULL) &&
+         (co_remaining(ctp, now) == (systime_t)0)) {
+    exp->delayed = ctp->next;
+    ctp->result = MSG_TIMEOUT;
+    chSysLock();
+    co_ready_i(exp, ctp);
+    chSysUnlock();
+  }
+  if (ctp != NULL)
+    next = co_remaining(ctp, now);
+
+  /* The tasks waiting on objects or events are only checked after an
+     object notification, new events or the nearest timeout.*/
+  chSysLock();
+  check = check || exp->notified;
+  exp->notified = false;
+  exp->running  = false;
+  chSysUnlock();
+  elapsed = (systime_t)(now - exp->wlast);
+  if (!check && ((exp->wnext == TIME_INFINITE) || (elapsed < exp->wnext))) {
+    if ((exp->wnext != TIME_INFINITE) && (exp->wnext - elapsed < next))
+      next = (systime_t)(exp->wnext - elapsed);
+    return next;
+  }
+  exp->wlast = now;
+  exp->wnext = TIME_INFINITE;
+
+  /* The tasks are checked one at time in order to keep the critical zones
+     short, a completed object wait can ready a thread.*/
+  ctpp = &exp->waiting;
+  while ((ctp = *ctpp) != NULL) {
+    bool done, expired;
+
+    chSysLock();
+    done = co_try_s(ctp);
+    expired = !done && (ctp->wtime != TIME_INFINITE) &&
+              (co_remaining(ctp, now) == (systime_t)0);
+    if (done || expired) {
+      *ctpp = ctp->next;
+      co_ready_i(exp, ctp);
+      if (done && (ctp->wkind != CO_WAIT_EVENTS))
+        chSchRescheduleS();
+    }
+    chSysUnlock();
+
+    if (done) {
+      if (ctp->wkind == CO_WAIT_EVENTS)
+        delivered |= ctp->wdata.events;
+      ctp->result = MSG_OK;
+    }
+    else if (expired) {
+      if (ctp->wkind == CO_WAIT_EVENTS)
+        ctp->wdata.events = (eventmask_t)0;
+      ctp->result = MSG_TIMEOUT;
+    }
+    else {
+      if (ctp->wtime != TIME_INFINITE) {
+        systime_t remaining = co_remaining(ctp, now);
+
+        if (remaining < exp->wnext)
+          exp->wnext = remaining;
+      }
+      ctpp = &ctp->next;
+    }
+  }
+  exp->events &= ~delivered;
+
+  if (exp->wnext < next)
+    next = exp->wnext;
+  return next;
+}
+
+/*
+ * Runs once the tasks in the ready FIFO, the tasks yielding are queued
+ * again for the next pass.
+ */
+static void co_run(co_executor_t *exp) {
+  co_task_t *ctp;
+
+  chSysLock();
+  ctp = exp->ready;
+  exp->ready   = NULL;
+  exp->running = true;
+  chSysUnlock();
+
+  while (ctp != NULL) {
+    co_task_t *next = ctp->next;
+    costate_t state;
+
+    /* Note, the task structure cannot be accessed after termination.*/
+    state = ctp->func(ctp);
+    if (state == CO_STATE_READY) {
+      chSysLock();
+      co_ready_i(exp, ctp);
+      chSysUnlock();
+    }
+    else if (state == CO_STATE_DONE) {
+      chSysLock();
+      exp->tasks--;
+      chSysUnlock();
+    }
+    ctp = next;
+  }
+}
+
+static THD_FUNCTION(co_executor_thread, p) {
+
+  chRegSetThreadName("executor");
+  coExecutorRun(p);
+}
+
+/**
+ * @brief   Initializes an executor.
+ *
+ * @param[out] exp      pointer to the @p co_executor_t structure
+ *
+ * @init
+ */
+void coExecutorObjectInit(co_executor_t *exp) {
+
+  chDbgCheck(exp != NULL);
+
+  exp->ready     = NULL;
+  exp->readytail = NULL;
+  exp->delayed   = NULL;
+  exp->waiting   = NULL;
+  exp->thread    = NULL;
+  exp->events    = (eventmask_t)0;
+  exp->wlast     = (systime_t)0;
+  exp->wnext     = TIME_INFINITE;
+  exp->tasks     = (cnt_t)0;
+  exp->notified  = false;
+  exp->running   = false;
+}
+
+/**
+ * @brief   Runs the executor tasks in the calling thread.
+ * @details The thread sleeps when no task is ready, it is awakened by the
+ *          task timeouts, by the events signaled to the thread, by the
+ *          objects waited by the tasks and by @p coExecutorWakeupI().
+ * @note    The function returns when the thread termination is requested,
+ *          the executor must be awakened after @p chThdTerminate().
+ *
+ * @param[in] exp       pointer to the @p co_executor_t structure
+ *
+ * @api
+ */
+void coExecutorRun(co_executor_t *exp) {
+  eventmask_t events = (eventmask_t)0;
+
+  chDbgCheck(exp != NULL);
+
+  chSysLock();
+  exp->thread = chThdGetSelfX();
+  chSysUnlock();
+
+  while (!chThdShouldTerminateX()) {
+    systime_t timeout;
+
+    events &= ~CO_WAKEUP_EVENT;
+    exp->events |= events;
+    timeout = co_dispatch(exp, events != (eventmask_t)0);
+    if (exp->ready != NULL) {
+      co_run(exp);
+      events = chEvtGetAndClearEvents(ALL_EVENTS);
+    }
+    else
+      events = chEvtWaitAnyTimeout(ALL_EVENTS, timeout);
+  }
+
+  chSysLock();
+  exp->thread = NULL;
+  chSysUnlock();
+}
+
+/**
+ * @brief   Creates a thread running the executor tasks.
+ *
+ * @param[in] exp       pointer to the @p co_executor_t structure
+ * @param[out] wsp      pointer to a working area dedicated to the thread
+ * @param[in] size      size of the working area
+ * @param[in] prio      the priority level for the executor thread
+ * @return              The pointer to the @p thread_t structure.
+ *
+ * @api
+ */
+thread_t *coExecutorStart(co_executor_t *exp, void *wsp, size_t size,
+                          tprio_t prio) {
+
+  return chThdCreateStatic(wsp, size, prio, co_executor_thread, exp);
+}
+
+/**
+ * @brief   Wakes up the executor.
+ * @details The waiting tasks are checked on the next executor pass. The
+ *          semaphores and mailboxes waited by the tasks wake up the
+ *          executor by themselves, the function is meant for conditions
+ *          checked by the tasks themselves.
+ *
+ * @param[in] exp       pointer to the @p co_executor_t structure
+ *
+ * @iclass
+ */
+void coExecutorWakeupI(co_executor_t *exp) {
+
+  chDbgCheckClassI();
+  chDbgCheck(exp != NULL);
+
+  exp->notified = true;
+  if ((exp->thread != NULL) && !exp->running)
+    chEvtSignalI(exp->thread, CO_WAKEUP_EVENT);
+}
+
+/**
+ * @brief   Wakes up the executor.
+ * @details The waiting tasks are checked on the next executor pass. The
+ *          semaphores and mailboxes waited by the tasks wake up the
+ *          executor by themselves, the function is meant for conditions
+ *          checked by the tasks themselves.
+ *
+ * @param[in] exp       pointer to the @p co_executor_t structure
+ *
+ * @api
+ */
+void coExecutorWakeup(co_executor_t *exp) {
+
+  chSysLock();
+  coExecutorWakeupI(exp);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Starts a task.
+ * @details The task is queued as ready, its function is invoked by the
+ *          executor starting from @p CO_BEGIN().
+ *
+ * @param[in] exp       pointer to the @p co_executor_t structure
+ * @param[out] ctp      pointer to the @p co_task_t structure
+ * @param[in] func      the task function
+ * @param[in] arg       an argument passed to the task
+ *
+ * @iclass
+ */
+void coTaskStartI(co_executor_t *exp, co_task_t *ctp,
+                  cotaskfunc_t func, void *arg) {
+
+  chDbgCheckClassI();
+  chDbgCheck((exp != NULL) && (ctp != NULL) && (func != NULL));
+
+  ctp->executor = exp;
+  ctp->func     = func;
+  ctp->arg      = arg;
+  ctp->wkind    = CO_WAIT_NONE;
+  ctp->result   = MSG_OK;
+  ctp->lc       = 0U;
+  exp->tasks++;
+  co_ready_i(exp, ctp);
+  coExecutorWakeupI(exp);
+}
+
+/**
+ * @brief   Starts a task.
+ * @details The task is queued as ready, its function is invoked by the
+ *          executor starting from @p CO_BEGIN().
+ *
+ * @param[in] exp       pointer to the @p co_executor_t structure
+ * @param[out] ctp      pointer to the @p co_task_t structure
+ * @param[in] func      the task function
+ * @param[in] arg       an argument passed to the task
+ *
+ * @api
+ */
+void coTaskStart(co_executor_t *exp, co_task_t *ctp,
+                 cotaskfunc_t func, void *arg) {
+
+  chSysLock();
+  coTaskStartI(exp, ctp, func, arg);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Suspends a task for the specified time.
+ * @note    Only the expired sleeping tasks are touched by the executor,
+ *          the cost is paid on insertion.
+ *
+ * @param[in] ctp       pointer to the @p co_task_t structure
+ * @param[in] time      the delay in system ticks, the special values are
+ *                      handled as follow:
+ *                      - @a TIME_INFINITE is not allowed.
+ *                      - @a TIME_IMMEDIATE the function returns @p true
+ *                        without waiting.
+ *                      .
+ * @return              The wait completion.
+ * @retval false        if the task has been suspended.
+ *
+ * @special
+ */
+bool coTaskSleep(co_task_t *ctp, systime_t time) {
+  co_task_t **ctpp;
+  systime_t now;
+
+  chDbgCheck((ctp != NULL) && (time != TIME_INFINITE));
+
+  ctp->result = MSG_TIMEOUT;
+  if (time == TIME_IMMEDIATE)
+    return true;
+
+  now = chVTGetSystemTimeX();
+  ctp->wkind  = CO_WAIT_SLEEP;
+  ctp->wstart = now;
+  ctp->wtime  = time;
+  ctpp = &ctp->executor->delayed;
+  while ((*ctpp != NULL) && (co_remaining(*ctpp, now) <= time))
+    ctpp = &(*ctpp)->next;
+  ctp->next = *ctpp;
+  *ctpp = ctp;
+  return false;
+}
+
+/**
+ * @brief   Waits for any of the specified events.
+ * @details The events are signaled to the executor thread, pending events
+ *          are kept until a task waits for them and are delivered to all
+ *          the tasks waiting for them.
+ *
+ * @param[in] ctp       pointer to the @p co_task_t structure
+ * @param[in] mask      mask of the events to wait for
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The wait completion.
+ * @retval false        if the task has been suspended.
+ *
+ * @special
+ */
+bool coTaskEvtWait(co_task_t *ctp, eventmask_t mask, systime_t time) {
+
+  chDbgCheck((ctp != NULL) && ((mask & ~CO_WAKEUP_EVENT) != (eventmask_t)0));
+
+  ctp->wdata.events = mask & ~CO_WAKEUP_EVENT;
+  return co_wait(ctp, CO_WAIT_EVENTS, NULL, time);
+}
+
+#if CH_CFG_USE_SEMAPHORES_NOTIFY || defined(__DOXYGEN__)
+/**
+ * @brief   Waits on a semaphore.
+ * @details The notification callback of the semaphore is set to the task
+ *          executor, the semaphore wakes it up when signaled.
+ * @note    A reset of the semaphore is not seen by the waiting tasks.
+ * @note    The semaphore can be waited by threads and by the tasks of a
+ *          single executor.
+ *
+ * @param[in] ctp       pointer to the @p co_task_t structure
+ * @param[in] sp        pointer to a @p semaphore_t structure
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The wait completion.
+ * @retval false        if the task has been suspended.
+ *
+ * @special
+ */
+bool coTaskSemWait(co_task_t *ctp, semaphore_t *sp, systime_t time) {
+
+  chDbgCheck((ctp != NULL) && (sp != NULL));
+
+  return co_wait(ctp, CO_WAIT_SEM, sp, time);
+}
+#endif /* CH_CFG_USE_SEMAPHORES_NOTIFY */
+
+#if (CH_CFG_USE_MAILBOXES && CH_CFG_USE_SEMAPHORES_NOTIFY) ||               \
+    defined(__DOXYGEN__)
+/**
+ * @brief   Fetches a message from a mailbox.
+ * @details The notification callbacks of the mailbox counters are set to
+ *          the task executor, the mailbox wakes it up when a message is
+ *          posted.
+ * @note    The mailbox can be used by threads and by the tasks of a single
+ *          executor.
+ *
+ * @param[in] ctp       pointer to the @p co_task_t structure
+ * @param[in] mbp       pointer to a @p mailbox_t structure
+ * @param[out] msgp     pointer to the message destination, it must stay
+ *                      valid until the wait is over
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The wait completion.
+ * @retval false        if the task has been suspended.
+ *
+ * @special
+ */
+bool coTaskMBFetch(co_task_t *ctp, mailbox_t *mbp, msg_t *msgp,
+                   systime_t time) {
+
+  chDbgCheck((ctp != NULL) && (mbp != NULL) && (msgp != NULL));
+
+  ctp->wdata.msgp = msgp;
+  return co_wait(ctp, CO_WAIT_MBFETCH, mbp, time);
+}
+
+/**
+ * @brief   Posts a message into a mailbox.
+ * @details The notification callbacks of the mailbox counters are set to
+ *          the task executor, the mailbox wakes it up when a message is
+ *          fetched.
+ * @note    The mailbox can be used by threads and by the tasks of a single
+ *          executor.
+ *
+ * @param[in] ctp       pointer to the @p co_task_t structure
+ * @param[in] mbp       pointer to a @p mailbox_t structure
+ * @param[in] msg       the message to be posted
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The wait completion.
+ * @retval false        if the task has been suspended.
+ *
+ * @special
+ */
+bool coTaskMBPost(co_task_t *ctp, mailbox_t *mbp, msg_t msg,
+                  systime_t time) {
+
+  chDbgCheck((ctp != NULL) && (mbp != NULL));
+
+  ctp->wdata.msg = msg;
+  return co_wait(ctp, CO_WAIT_MBPOST, mbp, time);
+}
+#endif /* CH_CFG_USE_MAILBOXES && CH_CFG_USE_SEMAPHORES_NOTIFY */
+
+/** @} */
@@ -0,0 +1,349 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    cotask.h
+ * @brief   Stackless tasks header.
+ *
+ * @addtogroup cotask
+ * @{
+ */
+
+#ifndef _COTASK_H_
+#define _COTASK_H_
+
+/**
+ * @brief   Event used to wake up the executor thread.
+ * @note    The event is reserved, it is never delivered to the tasks.
+ */
+#if !defined(CO_WAKEUP_EVENT) || defined(__DOXYGEN__)
+#define CO_WAKEUP_EVENT             EVENT_MASK(31)
+#endif
+
+#if !CH_CFG_USE_EVENTS
+#error "stackless tasks require CH_CFG_USE_EVENTS"
+#endif
+
+/**
+ * @name    Task states
+ * @brief   Values returned by the task functions.
+ * @{
+ */
+#define CO_STATE_READY              0U  /**< @brief Yielded, still ready.   */
+#define CO_STATE_WAITING            1U  /**< @brief Waiting for an object
+                                             or a timeout.                  */
+#define CO_STATE_DONE               2U  /**< @brief Terminated.             */
+/** @} */
+
+/**
+ * @brief   Type of a task state.
+ */
+typedef uint8_t costate_t;
+
+/**
+ * @brief   Type of a stackless task structure.
+ */
+typedef struct co_task co_task_t;
+
+/**
+ * @brief   Type of an executor structure.
+ */
+typedef struct co_executor co_executor_t;
+
+/**
+ * @brief   Type of a task function.
+ * @details The function is invoked each time the task is resumed, the
+ *          body is enclosed between @p CO_BEGIN() and @p CO_END().
+ */
+typedef costate_t (*cotaskfunc_t)(co_task_t *ctp);
+
+/**
+ * @brief   Structure representing a stackless task.
+ * @note    The local variables of the task function are not preserved
+ *          across the waiting points, the task state must be kept in a
+ *          structure containing the @p co_task_t as first field or
+ *          pointed by the task argument.
+ */
+struct co_task {
+  co_task_t             *next;              /**< @brief Next task in the
+                                                 executor lists.            */
+  co_executor_t         *executor;          /**< @brief Owner executor.     */
+  cotaskfunc_t          func;               /**< @brief Task function.      */
+  void                  *arg;               /**< @brief Task argument.      */
+  void                  *wobj;              /**< @brief Waited object.      */
+  union {
+    eventmask_t         events;             /**< @brief Waited events.      */
+    msg_t               msg;                /**< @brief Message to be
+                                                 posted.                    */
+    msg_t               *msgp;              /**< @brief Fetched message
+                                                 destination.               */
+  }                     wdata;
+  systime_t             wstart;             /**< @brief Wait start time.    */
+  systime_t             wtime;              /**< @brief Wait timeout.       */
+  msg_t                 result;             /**< @brief Last wait result.   */
+  uint16_t              lc;                 /**< @brief Local continuation,
+                                                 the resume point.          */
+  uint8_t               wkind;              /**< @brief Wait type.          */
+};
+
+/**
+ * @brief   Structure representing an executor.
+ * @details An executor runs any number of stackless tasks inside a single
+ *          thread.
+ */
+struct co_executor {
+  co_task_t             *ready;             /**< @brief Ready tasks FIFO
+                                                 head.                      */
+  co_task_t             *readytail;         /**< @brief Ready tasks FIFO
+                                                 tail.                      */
+  co_task_t             *delayed;           /**< @brief Sleeping tasks,
+                                                 ordered by deadline.       */
+  co_task_t             *waiting;           /**< @brief Tasks waiting on
+                                                 objects or events.         */
+  thread_t              *thread;            /**< @brief Executor thread.    */
+  eventmask_t           events;             /**< @brief Pending events not
+                                                 yet delivered.             */
+  systime_t             wlast;              /**< @brief Time of the last
+                                                 waiting tasks check.       */
+  systime_t             wnext;              /**< @brief Nearest timeout of
+                                                 the waiting tasks, from
+                                                 @p wlast.                  */
+  cnt_t                 tasks;              /**< @brief Running tasks.      */
+  bool                  notified;           /**< @brief A waited object has
+                                                 been signaled.             */
+  bool                  running;            /**< @brief Running the ready
+                                                 tasks, the waiting tasks
+                                                 are checked next without
+                                                 a wakeup.                  */
+};
+
+/**
+ * @name    Task body macros
+ * @brief   Protothread-style macros, the waiting points are implemented
+ *          by returning from the task function and jumping back to the
+ *          resume point on the next invocation.
+ * @note    The macros expand to @p case labels, a task function cannot
+ *          contain @p switch statements enclosing waiting points and
+ *          only one waiting point is allowed for each source line.
+ * @{
+ */
+/**
+ * @brief   Task body start.
+ *
+ * @param[in] ctp       pointer to the @p co_task_t structure
+ */
+#define CO_BEGIN(ctp)                                                       \
+  switch ((ctp)->lc) {                                                      \
+  case 0U:
+
+/**
+ * @brief   Task body end, the task terminates.
+ *
+ * @param[in] ctp       pointer to the @p co_task_t structure
+ */
+#define CO_END(ctp)                                                         \
+  }                                                                         \
+  (ctp)->lc = 0U;                                                           \
+  return CO_STATE_DONE
+
+/**
+ * @brief   Terminates the task.
+ *
+ * @param[in] ctp       pointer to the @p co_task_t structure
+ */
+#define CO_EXIT(ctp)                                                        \
+  do {                                                                      \
+    (ctp)->lc = 0U;                                                         \
+    return CO_STATE_DONE;                                                   \
+  } while (false)
+
+/**
+ * @brief   Gives the executor to the next ready task.
+ *
+ * @param[in] ctp       pointer to the @p co_task_t structure
+ */
+#define CO_YIELD(ctp)                                                       \
+  do {                                                                      \
+    (ctp)->lc = (uint16_t)__LINE__;                                         \
+    return CO_STATE_READY;                                                  \
+  case __LINE__:;                                                           \
+  } while (false)
+
+/**
+ * @brief   Waits for the completion of a wait operation.
+ * @details The expression is one of the @p coTaskXXX() wait functions,
+ *          if it returns @p false the task has been queued and the
+ *          function is resumed after the waiting point once the wait is
+ *          over. The result is retrieved using @p coTaskGetResult().
+ *
+ * @param[in] ctp       pointer to the @p co_task_t structure
+ * @param[in] expr      wait function invocation
+ */
+#define CO_AWAIT(ctp, expr)                                                 \
+  do {                                                                      \
+    if (!(expr)) {                                                          \
+      (ctp)->lc = (uint16_t)__LINE__;                                       \
+      return CO_STATE_WAITING;                                              \
+  case __LINE__:;                                                           \
+    }                                                                       \
+  } while (false)
+
+/**
+ * @brief   Suspends the task for the specified time.
+ *
+ * @param[in] ctp       pointer to the @p co_task_t structure
+ * @param[in] time      the delay in system ticks
+ */
+#define CO_SLEEP(ctp, time) CO_AWAIT(ctp, coTaskSleep(ctp, time))
+
+/**
+ * @brief   Waits on a semaphore.
+ * @details The result is @p MSG_OK or @p MSG_TIMEOUT.
+ * @note    Requires @p CH_CFG_USE_SEMAPHORES_NOTIFY.
+ *
+ * @param[in] ctp       pointer to the @p co_task_t structure
+ * @param[in] sp        pointer to a @p semaphore_t structure
+ * @param[in] time      the number of ticks before the operation timeouts
+ */
+#define CO_SEM_WAIT(ctp, sp, time) CO_AWAIT(ctp, coTaskSemWait(ctp, sp, time))
+
+/**
+ * @brief   Waits for any of the specified events.
+ * @details The received events are retrieved using @p coTaskGetEvents(),
+ *          the result is @p MSG_OK or @p MSG_TIMEOUT.
+ *
+ * @param[in] ctp       pointer to the @p co_task_t structure
+ * @param[in] mask      mask of the events to wait for
+ * @param[in] time      the number of ticks before the operation timeouts
+ */
+#define CO_EVT_WAIT(ctp, mask, time)                                        \
+  CO_AWAIT(ctp, coTaskEvtWait(ctp, mask, time))
+
+/**
+ * @brief   Fetches a message from a mailbox.
+ * @details The result is @p MSG_OK or @p MSG_TIMEOUT.
+ * @note    The message destination must not be a local variable.
+ * @note    Requires @p CH_CFG_USE_SEMAPHORES_NOTIFY.
+ *
+ * @param[in] ctp       pointer to the @p co_task_t structure
+ * @param[in] mbp       pointer to a @p mailbox_t structure
+ * @param[out] msgp     pointer to the message destination
+ * @param[in] time      the number of ticks before the operation timeouts
+ */
+#define CO_MB_FETCH(ctp, mbp, msgp, time)                                   \
+  CO_AWAIT(ctp, coTaskMBFetch(ctp, mbp, msgp, time))
+
+/**
+ * @brief   Posts a message into a mailbox.
+ * @details The result is @p MSG_OK or @p MSG_TIMEOUT.
+ * @note    Requires @p CH_CFG_USE_SEMAPHORES_NOTIFY.
+ *
+ * @param[in] ctp       pointer to the @p co_task_t structure
+ * @param[in] mbp       pointer to a @p mailbox_t structure
+ * @param[in] msg       the message to be posted
+ * @param[in] time      the number of ticks before the operation timeouts
+ */
+#define CO_MB_POST(ctp, mbp, msg, time)                                     \
+  CO_AWAIT(ctp, coTaskMBPost(ctp, mbp, msg, time))
+/** @} */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void coExecutorObjectInit(co_executor_t *exp);
+  void coExecutorRun(co_executor_t *exp);
+  thread_t *coExecutorStart(co_executor_t *exp, void *wsp, size_t size,
+                            tprio_t prio);
+  void coExecutorWakeupI(co_executor_t *exp);
+  void coExecutorWakeup(co_executor_t *exp);
+  void coTaskStartI(co_executor_t *exp, co_task_t *ctp,
+                    cotaskfunc_t func, void *arg);
+  void coTaskStart(co_executor_t *exp, co_task_t *ctp,
+                   cotaskfunc_t func, void *arg);
+  bool coTaskSleep(co_task_t *ctp, systime_t time);
+  bool coTaskEvtWait(co_task_t *ctp, eventmask_t mask, systime_t time);
+#if CH_CFG_USE_SEMAPHORES_NOTIFY || defined(__DOXYGEN__)
+  bool coTaskSemWait(co_task_t *ctp, semaphore_t *sp, systime_t time);
+#endif
+#if (CH_CFG_USE_MAILBOXES && CH_CFG_USE_SEMAPHORES_NOTIFY) ||               \
+    defined(__DOXYGEN__)
+  bool coTaskMBFetch(co_task_t *ctp, mailbox_t *mbp, msg_t *msgp,
+                     systime_t time);
+  bool coTaskMBPost(co_task_t *ctp, mailbox_t *mbp, msg_t msg,
+                    systime_t time);
+#endif
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @brief   Returns the argument of a task.
+ *
+ * @param[in] ctp       pointer to the @p co_task_t structure
+ * @return              The task argument.
+ *
+ * @xclass
+ */
+static inline void *coTaskGetArgX(co_task_t *ctp) {
+
+  return ctp->arg;
+}
+
+/**
+ * @brief   Returns the result of the last wait operation.
+ *
+ * @param[in] ctp       pointer to the @p co_task_t structure
+ * @return              The wait result.
+ *
+ * @xclass
+ */
+static inline msg_t coTaskGetResultX(co_task_t *ctp) {
+
+  return ctp->result;
+}
+
+/**
+ * @brief   Returns the events received by the last events wait.
+ *
+ * @param[in] ctp       pointer to the @p co_task_t structure
+ * @return              The received events, zero on timeout.
+ *
+ * @xclass
+ */
+static inline eventmask_t coTaskGetEventsX(co_task_t *ctp) {
+
+  return ctp->wdata.events;
+}
+
+/**
+ * @brief   Returns the thread running an executor.
+ * @details The events of the tasks are signaled to this thread, the
+ *          event sources are registered by calling @p chEvtRegisterMask()
+ *          from inside a task.
+ *
+ * @param[in] exp       pointer to the @p co_executor_t structure
+ * @return              The executor thread, @p NULL if not started.
+ *
+ * @xclass
+ */
+static inline thread_t *coExecutorGetThreadX(co_executor_t *exp) {
+
+  return exp->thread;
+}
+
+#endif /* _COTASK_H_ */
+
+/** @} */
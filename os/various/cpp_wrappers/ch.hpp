@@ -27,6 +27,42 @@
 #ifndef _CH_HPP_
 #define _CH_HPP_
 
+/**
+ * @brief   C++11 features switch.
+ * @details Enables the move-aware classes and the compile time checks, the
+ *          default depends on the language standard used by the compiler.
+ */
+#if !defined(CH_CPP_USE_CXX11) || defined(__DOXYGEN__)
+#if __cplusplus >= 201103L
+#define CH_CPP_USE_CXX11            TRUE
+#else
+#define CH_CPP_USE_CXX11            FALSE
+#endif
+#endif
+
+#if CH_CPP_USE_CXX11 && (__cplusplus < 201103L)
+#error "CH_CPP_USE_CXX11 requires a C++11 compiler"
+#endif
+
+#if CH_CPP_USE_CXX11 && CH_CFG_USE_MEMPOOLS
+#include <new>
+#endif
+
+/**
+ * @brief   Makes a class not copyable.
+ * @details The kernel objects are linked by address in the kernel lists so
+ *          the classes embedding them can be neither copied nor moved.
+ */
+#if CH_CPP_USE_CXX11 || defined(__DOXYGEN__)
+#define CH_CPP_NOCOPY(name)                                                 \
+  name(const name &) = delete;                                              \
+  name &operator=(const name &) = delete
+#else
+#define CH_CPP_NOCOPY(name)                                                 \
+  name(const name &);                                                       \
+  name &operator=(const name &)
+#endif
+
 /**
  * @brief   ChibiOS-RT kernel-related classes and interfaces.
  */
@@ -206,6 +242,116 @@ namespace chibios_rt {
     }
   };
 
+  /*------------------------------------------------------------------------*
+   * chibios_rt::SysLocker                                                  *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Scoped kernel lock.
+   * @details The kernel is locked by the constructor and unlocked when the
+   *          object goes out of scope, it compiles to the same code of a
+   *          @p chSysLock() / @p chSysUnlock() pair.
+   * @note    This class can only be used from thread context.
+   */
+  class SysLocker {
+  private:
+    CH_CPP_NOCOPY(SysLocker);
+
+  public:
+    /**
+     * @brief   Enters the kernel lock mode.
+     *
+     * @special
+     */
+    SysLocker(void) {
+
+      chSysLock();
+    }
+
+    /**
+     * @brief   Leaves the kernel lock mode.
+     *
+     * @special
+     */
+    ~SysLocker(void) {
+
+      chSysUnlock();
+    }
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::SysLockerFromIsr                                           *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Scoped kernel lock from within an interrupt handler.
+   * @note    This class must be used exclusively from interrupt handlers.
+   */
+  class SysLockerFromIsr {
+  private:
+    CH_CPP_NOCOPY(SysLockerFromIsr);
+
+  public:
+    /**
+     * @brief   Enters the kernel lock mode from within an interrupt handler.
+     *
+     * @special
+     */
+    SysLockerFromIsr(void) {
+
+      chSysLockFromISR();
+    }
+
+    /**
+     * @brief   Leaves the kernel lock mode from within an interrupt handler.
+     *
+     * @special
+     */
+    ~SysLockerFromIsr(void) {
+
+      chSysUnlockFromISR();
+    }
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::CriticalSectionLocker                                      *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Scoped critical section usable from any context.
+   * @details The current status is saved by the constructor and restored
+   *          when the object goes out of scope, critical sections can be
+   *          nested.
+   */
+  class CriticalSectionLocker {
+  private:
+    CH_CPP_NOCOPY(CriticalSectionLocker);
+
+    /**
+     * @brief   Saved status.
+     */
+    syssts_t sts;
+
+  public:
+    /**
+     * @brief   Enters a critical section.
+     *
+     * @xclass
+     */
+    CriticalSectionLocker(void) : sts(chSysGetStatusAndLockX()) {
+
+    }
+
+    /**
+     * @brief   Leaves the critical section.
+     * @note    A reschedule is performed if required and if the section was
+     *          entered from thread context with the kernel unlocked.
+     *
+     * @xclass
+     */
+    ~CriticalSectionLocker(void) {
+
+      chSysRestoreStatusX(sts);
+    }
+  };
+
 #if CH_CFG_USE_MEMCORE || defined(__DOXYGEN__)
   /*------------------------------------------------------------------------*
    * chibios_rt::Core                                                       *
@@ -867,6 +1013,21 @@ namespace chibios_rt {
 #endif /* CH_CFG_USE_MUTEXES */
   };
 
+#if CH_CPP_USE_CXX11 || defined(__DOXYGEN__)
+  /**
+   * @brief   Calculates the size of a thread working area.
+   * @details Compile time equivalent of @p THD_WORKING_AREA_SIZE(), the
+   *          result can be used in constant expressions.
+   *
+   * @param[in] n           the stack size to be assigned to the thread
+   * @return                The working area size in bytes.
+   */
+  constexpr size_t workingAreaSize(size_t n) {
+
+    return THD_WORKING_AREA_SIZE(n);
+  }
+#endif /* CH_CPP_USE_CXX11 */
+
   /*------------------------------------------------------------------------*
    * chibios_rt::BaseStaticThread                                           *
    *------------------------------------------------------------------------*/
@@ -876,12 +1037,28 @@ namespace chibios_rt {
    *
    * @param N               the working area size for the thread class
    */
-  template <int N>
+  template <size_t N>
   class BaseStaticThread : public BaseThread {
+#if CH_CPP_USE_CXX11
+    static_assert(N > 0, "invalid thread stack size");
+#endif
+
   protected:
     THD_WORKING_AREA(wa, N);
 
   public:
+#if CH_CPP_USE_CXX11 || defined(__DOXYGEN__)
+    /**
+     * @brief   Size of the working area of this thread class.
+     *
+     * @return              The working area size in bytes.
+     */
+    static constexpr size_t getWorkingAreaSize(void) {
+
+      return workingAreaSize(N);
+    }
+#endif
+
     /**
      * @brief   Thread constructor.
      * @details The thread object is initialized but the thread is not
@@ -918,6 +1095,9 @@ namespace chibios_rt {
    * @brief   Class encapsulating a semaphore.
    */
   class CounterSemaphore {
+  private:
+    CH_CPP_NOCOPY(CounterSemaphore);
+
   public:
     /**
      * @brief   Embedded @p ::Semaphore structure.
@@ -1108,6 +1288,9 @@ namespace chibios_rt {
    * @brief   Class encapsulating a binary semaphore.
    */
   class BinarySemaphore {
+  private:
+    CH_CPP_NOCOPY(BinarySemaphore);
+
   public:
     /**
      * @brief   Embedded @p ::Semaphore structure.
@@ -1264,6 +1447,9 @@ namespace chibios_rt {
    * @brief   Class encapsulating a mutex.
    */
   class Mutex {
+  private:
+    CH_CPP_NOCOPY(Mutex);
+
   public:
     /**
      * @brief   Embedded @p ::Mutex structure.
@@ -1357,6 +1543,50 @@ namespace chibios_rt {
     void unlockS(void);
   };
 
+  /*------------------------------------------------------------------------*
+   * chibios_rt::MutexLocker                                                *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Scoped mutex lock.
+   * @details The mutex is locked by the constructor and unlocked when the
+   *          object goes out of scope, it compiles to the same code of a
+   *          @p chMtxLock() / @p chMtxUnlock() pair.
+   * @note    Scoped locks must be nested, the mutexes are released in
+   *          reverse lock order.
+   */
+  class MutexLocker {
+  private:
+    CH_CPP_NOCOPY(MutexLocker);
+
+    /**
+     * @brief   Locked mutex.
+     */
+    ::mutex_t *mp;
+
+  public:
+    /**
+     * @brief   Locks the specified mutex.
+     *
+     * @param[in] mutex     the @p Mutex object to be locked
+     *
+     * @api
+     */
+    MutexLocker(Mutex &mutex) : mp(&mutex.mutex) {
+
+      chMtxLock(mp);
+    }
+
+    /**
+     * @brief   Unlocks the mutex.
+     *
+     * @api
+     */
+    ~MutexLocker(void) {
+
+      chMtxUnlock(mp);
+    }
+  };
+
 #if CH_CFG_USE_CONDVARS || defined(__DOXYGEN__)
   /*------------------------------------------------------------------------*
    * chibios_rt::CondVar                                                    *
@@ -1365,6 +1595,9 @@ namespace chibios_rt {
    * @brief   Class encapsulating a conditional variable.
    */
   class CondVar {
+  private:
+    CH_CPP_NOCOPY(CondVar);
+
   public:
     /**
      * @brief   Embedded @p ::CondVar structure.
@@ -1516,6 +1749,9 @@ namespace chibios_rt {
    * @brief   Class encapsulating an event source.
    */
   class EvtSource {
+  private:
+    CH_CPP_NOCOPY(EvtSource);
+
   public:
     /**
      * @brief   Embedded @p ::EventSource structure.
@@ -1599,6 +1835,8 @@ namespace chibios_rt {
    */
   class InQueue {
   private:
+    CH_CPP_NOCOPY(InQueue);
+
     /**
      * @brief   Embedded @p ::InputQueue structure.
      */
@@ -1780,6 +2018,8 @@ namespace chibios_rt {
    */
   class OutQueue {
   private:
+    CH_CPP_NOCOPY(OutQueue);
+
     /**
      * @brief   Embedded @p ::OutputQueue structure.
      */
@@ -1967,8 +2207,10 @@ namespace chibios_rt {
    */
   template <typename T>
   class MailboxBase {
-  public:
+  private:
+    CH_CPP_NOCOPY(MailboxBase);
 
+  public:
     /**
      * @brief   Embedded @p ::Mailbox structure.
      */
@@ -2235,8 +2477,14 @@ namespace chibios_rt {
    *
    * @param N               length of the mailbox buffer
    */
-  template <typename T, int N>
+  template <typename T, size_t N>
   class Mailbox : public MailboxBase<T> {
+#if CH_CPP_USE_CXX11
+    static_assert(N > 0, "invalid mailbox size");
+    static_assert(sizeof (T) <= sizeof (msg_t),
+                  "mailbox type does not fit in a message");
+#endif
+
   private:
     msg_t   mb_buf[N];
 
@@ -2257,9 +2505,12 @@ namespace chibios_rt {
    * chibios_rt::MemoryPool                                                 *
    *------------------------------------------------------------------------*/
   /**
-   * @brief   Class encapsulating a mailbox.
+   * @brief   Class encapsulating a memory pool.
    */
   class MemoryPool {
+  private:
+    CH_CPP_NOCOPY(MemoryPool);
+
   public:
     /**
      * @brief   Embedded @p ::MemoryPool structure.
@@ -2363,22 +2614,214 @@ namespace chibios_rt {
     void freeI(void *objp);
   };
 
+#if CH_CPP_USE_CXX11 || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::PoolObject                                                 *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Owning handle of an object allocated from a memory pool.
+   * @details The handle can be moved but not copied, the object is
+   *          destroyed and returned to its pool when the owning handle is
+   *          destroyed or reset.
+   *
+   * @param T               type of the object
+   */
+  template <typename T>
+  class PoolObject {
+  private:
+    CH_CPP_NOCOPY(PoolObject);
+
+    /**
+     * @brief   Owned object or @p nullptr.
+     */
+    T *objp;
+
+    /**
+     * @brief   Pool the object belongs to.
+     */
+    ::memory_pool_t *mpp;
+
+  public:
+    /**
+     * @brief   Empty handle constructor.
+     *
+     * @init
+     */
+    constexpr PoolObject(void) : objp(nullptr), mpp(nullptr) {
+
+    }
+
+    /**
+     * @brief   Handle constructor.
+     * @details The ownership of an object allocated from the specified pool
+     *          is taken.
+     *
+     * @param[in] p         pointer to the object or @p nullptr
+     * @param[in] mp        the pool the object belongs to
+     *
+     * @init
+     */
+    PoolObject(T *p, MemoryPool &mp) : objp(p), mpp(&mp.pool) {
+
+    }
+
+    /**
+     * @brief   Move constructor.
+     * @details The ownership of the object is transferred, the other handle
+     *          becomes empty.
+     *
+     * @init
+     */
+    PoolObject(PoolObject &&other) : objp(other.objp), mpp(other.mpp) {
+
+      other.objp = nullptr;
+    }
+
+    /**
+     * @brief   Move assignment.
+     * @details The currently owned object, if any, is returned to its pool
+     *          and the ownership of the other object is transferred.
+     *
+     * @api
+     */
+    PoolObject &operator=(PoolObject &&other) {
+
+      if (this != &other)
+        reset(other.release(), other.mpp);
+      return *this;
+    }
+
+    /**
+     * @brief   Handle destructor.
+     * @details The owned object, if any, is returned to its pool.
+     *
+     * @api
+     */
+    ~PoolObject(void) {
+
+      reset();
+    }
+
+    /**
+     * @brief   Returns the owned object.
+     *
+     * @return              Pointer to the object or @p nullptr.
+     *
+     * @xclass
+     */
+    T *get(void) const {
+
+      return objp;
+    }
+
+    /**
+     * @brief   Object member access.
+     *
+     * @xclass
+     */
+    T *operator->(void) const {
+
+      return objp;
+    }
+
+    /**
+     * @brief   Object access.
+     *
+     * @xclass
+     */
+    T &operator*(void) const {
+
+      return *objp;
+    }
+
+    /**
+     * @brief   Checks if the handle owns an object.
+     *
+     * @xclass
+     */
+    explicit operator bool(void) const {
+
+      return objp != nullptr;
+    }
+
+    /**
+     * @brief   Releases the ownership of the object.
+     * @details The object is not destroyed, the handle becomes empty.
+     *
+     * @return              Pointer to the object or @p nullptr.
+     *
+     * @xclass
+     */
+    T *release(void) {
+      T *p = objp;
+
+      objp = nullptr;
+      return p;
+    }
+
+    /**
+     * @brief   Destroys the owned object and returns it to its pool.
+     *
+     * @api
+     */
+    void reset(void) {
+
+      if (objp != nullptr) {
+        objp->~T();
+        chPoolFree(mpp, objp);
+        objp = nullptr;
+      }
+    }
+
+    /**
+     * @brief   Replaces the owned object.
+     * @details The currently owned object, if any, is destroyed and returned
+     *          to its pool, then the ownership of the new object is taken.
+     *
+     * @param[in] p         pointer to the new object or @p nullptr
+     * @param[in] mp        the pool the new object belongs to
+     *
+     * @api
+     */
+    void reset(T *p, MemoryPool &mp) {
+
+      reset(p, &mp.pool);
+    }
+
+  private:
+    void reset(T *p, ::memory_pool_t *pool) {
+
+      reset();
+      objp = p;
+      mpp  = pool;
+    }
+  };
+#endif /* CH_CPP_USE_CXX11 */
+
   /*------------------------------------------------------------------------*
    * chibios_rt::ObjectsPool                                                *
    *------------------------------------------------------------------------*/
   /**
    * @brief   Template class encapsulating a memory pool and its elements.
+   *
+   * @param T               type of the objects
+   * @param N               number of objects in the pool
    */
   template<class T, size_t N>
   class ObjectsPool : public MemoryPool {
+#if CH_CPP_USE_CXX11
+    static_assert(N > 0, "invalid number of objects");
+#endif
+
   private:
     /* The buffer is declared as an array of pointers to void for two
        reasons:
        1) The objects must be properly aligned to hold a pointer as
-          first field.
+          first field, the objects size is rounded up accordingly.
        2) There is no need to invoke constructors for object that are
           into the pool.*/
-    void *pool_buf[(N * sizeof (T)) / sizeof (void *)];
+    void *pool_buf[N * ((sizeof (T) + sizeof (void *) - 1U) /
+                        sizeof (void *))];
 
   public:
     /**
@@ -2386,11 +2829,181 @@ namespace chibios_rt {
      *
      * @init
      */
-    ObjectsPool(void) : MemoryPool(sizeof (T), NULL) {
+    ObjectsPool(void) : MemoryPool(sizeof pool_buf / N, NULL) {
 
       loadArray(pool_buf, N);
     }
+
+#if CH_CPP_USE_CXX11 || defined(__DOXYGEN__)
+    /**
+     * @brief   Allocates and constructs an object.
+     * @details The object is constructed in place with the specified
+     *          arguments.
+     *
+     * @param[in] args      the object constructor arguments
+     * @return              The owning handle, empty if the pool is
+     *                      exhausted.
+     *
+     * @api
+     */
+    template <typename... Args>
+    PoolObject<T> make(Args&&... args) {
+      void *p = chPoolAlloc(&pool);
+
+      if (p == nullptr)
+        return PoolObject<T>();
+      return PoolObject<T>(new (p) T(static_cast<Args&&>(args)...), *this);
+    }
+#endif /* CH_CPP_USE_CXX11 */
+  };
+
+#if (CH_CPP_USE_CXX11 && CH_CFG_USE_MAILBOXES) || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::ObjectsMailbox                                             *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Mailbox of objects allocated from a memory pool.
+   * @details The ownership of the objects is transferred through the
+   *          mailbox, a posted object belongs to the mailbox until it is
+   *          fetched. Only pointers are exchanged, there is no overhead
+   *          compared to a mailbox of pointers.
+   * @note    The objects still in the mailbox when it is reset are not
+   *          returned to the pool.
+   *
+   * @param T               type of the objects
+   * @param N               length of the mailbox buffer
+   */
+  template <typename T, size_t N>
+  class ObjectsMailbox : private MailboxBase<T *> {
+    static_assert(N > 0, "invalid mailbox size");
+
+  private:
+    msg_t       mb_buf[N];
+    MemoryPool  &mp;
+
+  public:
+    using MailboxBase<T *>::mb;
+    using MailboxBase<T *>::reset;
+    using MailboxBase<T *>::getFreeCountI;
+    using MailboxBase<T *>::getUsedCountI;
+
+    /**
+     * @brief   ObjectsMailbox constructor.
+     *
+     * @param[in] pool      the pool of the exchanged objects
+     *
+     * @init
+     */
+    ObjectsMailbox(MemoryPool &pool) :
+      MailboxBase<T *>(mb_buf, (cnt_t)N), mp(pool) {
+    }
+
+    /**
+     * @brief   Posts an object into the mailbox.
+     * @details On success the ownership is transferred to the mailbox and
+     *          the handle becomes empty, on failure the handle is not
+     *          modified.
+     *
+     * @param[in] obj       handle of the object to be posted
+     * @param[in] time      the number of ticks before the operation timeouts,
+     *                      the following special values are allowed:
+     *                      - @a TIME_IMMEDIATE immediate timeout.
+     *                      - @a TIME_INFINITE no timeout.
+     *                      .
+     * @return              The operation status.
+     * @retval MSG_OK       if the object has been correctly posted.
+     * @retval MSG_RESET    if the mailbox has been reset while waiting.
+     * @retval MSG_TIMEOUT  if the operation has timed out.
+     *
+     * @api
+     */
+    msg_t post(PoolObject<T> &&obj, systime_t time) {
+      msg_t msg;
+
+      msg = chMBPost(&mb, reinterpret_cast<msg_t>(obj.get()), time);
+      if (msg == MSG_OK)
+        (void)obj.release();
+      return msg;
+    }
+
+    /**
+     * @brief   Posts an object into the mailbox.
+     * @details This variant is non-blocking, on success the ownership is
+     *          transferred to the mailbox and the handle becomes empty.
+     *
+     * @param[in] obj       handle of the object to be posted
+     * @return              The operation status.
+     * @retval MSG_OK       if the object has been correctly posted.
+     * @retval MSG_TIMEOUT  if the mailbox is full.
+     *
+     * @iclass
+     */
+    msg_t postI(PoolObject<T> &&obj) {
+      msg_t msg;
+
+      msg = chMBPostI(&mb, reinterpret_cast<msg_t>(obj.get()));
+      if (msg == MSG_OK)
+        (void)obj.release();
+      return msg;
+    }
+
+    /**
+     * @brief   Posts an high priority object into the mailbox.
+     * @details On success the ownership is transferred to the mailbox and
+     *          the handle becomes empty, on failure the handle is not
+     *          modified.
+     *
+     * @param[in] obj       handle of the object to be posted
+     * @param[in] time      the number of ticks before the operation timeouts,
+     *                      the following special values are allowed:
+     *                      - @a TIME_IMMEDIATE immediate timeout.
+     *                      - @a TIME_INFINITE no timeout.
+     *                      .
+     * @return              The operation status.
+     * @retval MSG_OK       if the object has been correctly posted.
+     * @retval MSG_RESET    if the mailbox has been reset while waiting.
+     * @retval MSG_TIMEOUT  if the operation has timed out.
+     *
+     * @api
+     */
+    msg_t postAhead(PoolObject<T> &&obj, systime_t time) {
+      msg_t msg;
+
+      msg = chMBPostAhead(&mb, reinterpret_cast<msg_t>(obj.get()), time);
+      if (msg == MSG_OK)
+        (void)obj.release();
+      return msg;
+    }
+
+    /**
+     * @brief   Retrieves an object from the mailbox.
+     * @details On success the handle takes the ownership of the object, the
+     *          object previously owned by the handle, if any, is returned
+     *          to its pool.
+     *
+     * @param[out] obj      handle receiving the object
+     * @param[in] time      the number of ticks before the operation timeouts,
+     *                      the following special values are allowed:
+     *                      - @a TIME_IMMEDIATE immediate timeout.
+     *                      - @a TIME_INFINITE no timeout.
+     *                      .
+     * @return              The operation status.
+     * @retval MSG_OK       if an object has been correctly fetched.
+     * @retval MSG_RESET    if the mailbox has been reset while waiting.
+     * @retval MSG_TIMEOUT  if the operation has timed out.
+     *
+     * @api
+     */
+    msg_t fetch(PoolObject<T> &obj, systime_t time) {
+      msg_t msg, p;
+
+      msg = chMBFetch(&mb, &p, time);
+      if (msg == MSG_OK)
+        obj.reset(reinterpret_cast<T *>(p), mp);
+      return msg;
+    }
   };
+#endif /* CH_CPP_USE_CXX11 && CH_CFG_USE_MAILBOXES */
 #endif /* CH_CFG_USE_MEMPOOLS */
 
   /*------------------------------------------------------------------------*
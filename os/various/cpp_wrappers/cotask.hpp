@@ -0,0 +1,435 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    cotask.hpp
+ * @brief   C++20 coroutines over the stackless tasks executor.
+ * @details The coroutine frames are allocated from the default heap, each
+ *          frame embeds the @p co_task_t structure scheduled by the
+ *          executor, the awaitables use the same wait functions of the
+ *          C tasks.
+ *
+ * @addtogroup cpp_library
+ * @{
+ */
+
+#ifndef _COTASK_HPP_
+#define _COTASK_HPP_
+
+#include <coroutine>
+
+#include "ch.hpp"
+#include "cotask.h"
+
+#if !defined(__cpp_impl_coroutine)
+#error "coroutine tasks require a C++20 compiler"
+#endif
+
+#if !CH_CFG_USE_HEAP
+#error "coroutine tasks require CH_CFG_USE_HEAP"
+#endif
+
+namespace chibios_rt {
+
+  class CoExecutor;
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::CoTask                                                     *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Coroutine task.
+   * @details Return type of the coroutines run by a @p CoExecutor, the
+   *          coroutine is created suspended and the frame is destroyed by
+   *          the executor when the coroutine returns.
+   */
+  class CoTask {
+    friend class CoExecutor;
+
+  public:
+    /**
+     * @brief   Coroutine promise.
+     */
+    class promise_type {
+      friend class CoTask;
+
+    public:
+      /**
+       * @brief   Embedded @p ::co_task_t structure.
+       */
+      ::co_task_t task;
+      /**
+       * @brief   State reported to the executor on suspension.
+       */
+      costate_t state;
+
+      CoTask get_return_object(void) noexcept {
+
+        return CoTask(std::coroutine_handle<promise_type>::from_promise(*this));
+      }
+
+      static CoTask get_return_object_on_allocation_failure(void) noexcept {
+
+        return CoTask(std::coroutine_handle<promise_type>());
+      }
+
+      std::suspend_always initial_suspend(void) const noexcept {
+
+        return std::suspend_always();
+      }
+
+      std::suspend_always final_suspend(void) const noexcept {
+
+        return std::suspend_always();
+      }
+
+      void return_void(void) const noexcept {
+      }
+
+      void unhandled_exception(void) const noexcept {
+
+        chSysHalt("coroutine exception");
+      }
+
+      static void *operator new(size_t size) noexcept {
+
+        return chHeapAlloc(NULL, size);
+      }
+
+      static void operator delete(void *p) noexcept {
+
+        chHeapFree(p);
+      }
+    };
+
+    /**
+     * @brief   Type of the coroutine handle.
+     */
+    typedef std::coroutine_handle<promise_type> handle_t;
+
+  private:
+    CH_CPP_NOCOPY(CoTask);
+
+    handle_t handle;
+
+    explicit CoTask(handle_t h) : handle(h) {
+    }
+
+    /*
+     * Task function invoked by the executor.
+     */
+    static costate_t resume(::co_task_t *ctp) {
+      promise_type *pp = static_cast<promise_type *>(ctp->arg);
+      handle_t h = handle_t::from_promise(*pp);
+
+      pp->state = CO_STATE_WAITING;
+      h.resume();
+      if (h.done()) {
+        h.destroy();
+        return CO_STATE_DONE;
+      }
+      return pp->state;
+    }
+
+  public:
+    /**
+     * @brief   Move constructor.
+     *
+     * @param[in] other     the task to be moved, it becomes empty
+     */
+    CoTask(CoTask &&other) noexcept : handle(other.handle) {
+
+      other.handle = handle_t();
+    }
+
+    /**
+     * @brief   Destroys the coroutine if it has not been started.
+     */
+    ~CoTask(void) {
+
+      if (handle)
+        handle.destroy();
+    }
+
+    /**
+     * @brief   Returns @p false if the coroutine frame allocation failed.
+     */
+    explicit operator bool(void) const noexcept {
+
+      return static_cast<bool>(handle);
+    }
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::CoExecutor                                                 *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Class encapsulating an executor.
+   */
+  class CoExecutor {
+  private:
+    CH_CPP_NOCOPY(CoExecutor);
+
+  public:
+    /**
+     * @brief   Embedded @p ::co_executor_t structure.
+     */
+    ::co_executor_t exec;
+
+    /**
+     * @brief   CoExecutor constructor.
+     *
+     * @init
+     */
+    CoExecutor(void) {
+
+      coExecutorObjectInit(&exec);
+    }
+
+    /**
+     * @brief   Runs the executor in the calling thread.
+     * @see     coExecutorRun()
+     *
+     * @api
+     */
+    void run(void) {
+
+      coExecutorRun(&exec);
+    }
+
+    /**
+     * @brief   Creates a thread running the executor.
+     *
+     * @param[out] wsp      pointer to a working area dedicated to the thread
+     * @param[in] size      size of the working area
+     * @param[in] prio      the priority level for the executor thread
+     * @return              A reference to the executor thread.
+     *
+     * @api
+     */
+    ThreadReference start(void *wsp, size_t size, tprio_t prio) {
+
+      return ThreadReference(coExecutorStart(&exec, wsp, size, prio));
+    }
+
+    /**
+     * @brief   Wakes up the executor.
+     *
+     * @iclass
+     */
+    void wakeupI(void) {
+
+      coExecutorWakeupI(&exec);
+    }
+
+    /**
+     * @brief   Wakes up the executor.
+     *
+     * @api
+     */
+    void wakeup(void) {
+
+      coExecutorWakeup(&exec);
+    }
+
+    /**
+     * @brief   Starts a coroutine task.
+     * @details The ownership of the coroutine frame is transferred to the
+     *          executor.
+     *
+     * @param[in] task      the coroutine task
+     * @return              The operation status.
+     * @retval false        if the coroutine frame allocation failed.
+     *
+     * @api
+     */
+    bool spawn(CoTask &&task) {
+
+      if (!task)
+        return false;
+
+      CoTask::promise_type &promise = task.handle.promise();
+      task.handle = CoTask::handle_t();
+      coTaskStart(&exec, &promise.task, CoTask::resume, &promise);
+      return true;
+    }
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::CoAwaitable                                                *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Base class of the awaitables over the task wait functions.
+   * @details The wait result, @p MSG_OK or @p MSG_TIMEOUT, is the value of
+   *          the @p co_await expression.
+   */
+  class CoAwaitable {
+  protected:
+    ::co_task_t *ctp;
+
+  public:
+    bool await_ready(void) const noexcept {
+
+      return false;
+    }
+
+    msg_t await_resume(void) const noexcept {
+
+      return coTaskGetResultX(ctp);
+    }
+  };
+
+  /**
+   * @brief   Gives the executor to the next ready task.
+   */
+  class CoYield {
+  public:
+    bool await_ready(void) const noexcept {
+
+      return false;
+    }
+
+    void await_suspend(CoTask::handle_t h) const noexcept {
+
+      h.promise().state = CO_STATE_READY;
+    }
+
+    void await_resume(void) const noexcept {
+    }
+  };
+
+  /**
+   * @brief   Suspends the task for the specified time.
+   * @see     coTaskSleep()
+   */
+  class CoSleep : public CoAwaitable {
+  private:
+    systime_t time;
+
+  public:
+    explicit CoSleep(systime_t time) : time(time) {
+    }
+
+    bool await_suspend(CoTask::handle_t h) noexcept {
+
+      ctp = &h.promise().task;
+      return !coTaskSleep(ctp, time);
+    }
+  };
+
+  /**
+   * @brief   Waits for any of the specified events.
+   * @details The value of the @p co_await expression is the mask of the
+   *          received events, zero on timeout.
+   * @see     coTaskEvtWait()
+   */
+  class CoEvtWait : public CoAwaitable {
+  private:
+    eventmask_t mask;
+    systime_t time;
+
+  public:
+    CoEvtWait(eventmask_t mask, systime_t time) : mask(mask), time(time) {
+    }
+
+    bool await_suspend(CoTask::handle_t h) noexcept {
+
+      ctp = &h.promise().task;
+      return !coTaskEvtWait(ctp, mask, time);
+    }
+
+    eventmask_t await_resume(void) const noexcept {
+
+      return coTaskGetEventsX(ctp);
+    }
+  };
+
+#if CH_CFG_USE_SEMAPHORES_NOTIFY || defined(__DOXYGEN__)
+  /**
+   * @brief   Waits on a semaphore.
+   * @see     coTaskSemWait()
+   */
+  class CoSemWait : public CoAwaitable {
+  private:
+    ::semaphore_t *sp;
+    systime_t time;
+
+  public:
+    CoSemWait(CounterSemaphore &sem, systime_t time) :
+      sp(&sem.sem), time(time) {
+    }
+
+    bool await_suspend(CoTask::handle_t h) noexcept {
+
+      ctp = &h.promise().task;
+      return !coTaskSemWait(ctp, sp, time);
+    }
+  };
+#endif /* CH_CFG_USE_SEMAPHORES_NOTIFY */
+
+#if (CH_CFG_USE_MAILBOXES && CH_CFG_USE_SEMAPHORES_NOTIFY) ||               \
+    defined(__DOXYGEN__)
+  /**
+   * @brief   Fetches a message from a mailbox.
+   * @note    The destination can be a local variable of the coroutine.
+   * @see     coTaskMBFetch()
+   */
+  template <typename T>
+  class CoMBFetch : public CoAwaitable {
+  private:
+    ::mailbox_t *mbp;
+    T *msgp;
+    systime_t time;
+
+  public:
+    CoMBFetch(MailboxBase<T> &mb, T *msgp, systime_t time) :
+      mbp(&mb.mb), msgp(msgp), time(time) {
+    }
+
+    bool await_suspend(CoTask::handle_t h) noexcept {
+
+      ctp = &h.promise().task;
+      return !coTaskMBFetch(ctp, mbp, reinterpret_cast<msg_t *>(msgp), time);
+    }
+  };
+
+  /**
+   * @brief   Posts a message into a mailbox.
+   * @see     coTaskMBPost()
+   */
+  template <typename T>
+  class CoMBPost : public CoAwaitable {
+  private:
+    ::mailbox_t *mbp;
+    T msg;
+    systime_t time;
+
+  public:
+    CoMBPost(MailboxBase<T> &mb, T msg, systime_t time) :
+      mbp(&mb.mb), msg(msg), time(time) {
+    }
+
+    bool await_suspend(CoTask::handle_t h) noexcept {
+
+      ctp = &h.promise().task;
+      return !coTaskMBPost(ctp, mbp, reinterpret_cast<msg_t>(msg), time);
+    }
+  };
+#endif /* CH_CFG_USE_MAILBOXES && CH_CFG_USE_SEMAPHORES_NOTIFY */
+}
+
+#endif /* _COTASK_HPP_ */
+
+/** @} */
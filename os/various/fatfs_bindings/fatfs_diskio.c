@@ -9,6 +9,34 @@
 #include "ffconf.h"
 #include "diskio.h"
 
+#if HAL_USE_RTC
+extern RTCDriver RTCD1;
+#endif
+
+/*
+ * If enabled, read and write operations go through a block cache layered
+ * over the card driver, the application is responsible for starting it.
+ */
+#if !defined(FATFS_USE_BLKCACHE)
+#define FATFS_USE_BLKCACHE FALSE
+#endif
+
+#if FATFS_USE_BLKCACHE
+#include "blkcache.h"
+extern BlockCache BCD1;
+#endif
+
+/*-----------------------------------------------------------------------*/
+/* Correspondence between physical drive number and physical drive.      */
+/*                                                                       */
+/* The table can be redefined in ffconf.h as an initializer of pointers  */
+/* to BaseBlockDevice objects, one for each physical drive, for example: */
+/* #define FATFS_DRIVES {(BaseBlockDevice *)&SDCD1,                      */
+/*                       (BaseBlockDevice *)&RD1}                        */
+/* Erase requests are forwarded to the drive through blkErase().         */
+
+#if !defined(FATFS_DRIVES)
+
 #if HAL_USE_MMC_SPI && HAL_USE_SDC
 #error "cannot specify both MMC_SPI and SDC drivers"
 #endif
@@ -21,15 +49,26 @@ extern SDCDriver SDCD1;
 #error "MMC_SPI or SDC driver must be specified"
 #endif
 
-#if HAL_USE_RTC
-extern RTCDriver RTCD1;
+#if FATFS_USE_BLKCACHE
+#define FATFS_DRIVES    {(BaseBlockDevice *)&BCD1}
+#elif HAL_USE_MMC_SPI
+#define FATFS_DRIVES    {(BaseBlockDevice *)&MMCD1}
+#else
+#define FATFS_DRIVES    {(BaseBlockDevice *)&SDCD1}
 #endif
 
-/*-----------------------------------------------------------------------*/
-/* Correspondence between physical drive number and physical drive.      */
+#endif /* !defined(FATFS_DRIVES) */
+
+static BaseBlockDevice * const drives[] = FATFS_DRIVES;
+
+#define NUM_DRIVES      (sizeof drives / sizeof drives[0])
+
+static BaseBlockDevice *get_drive(BYTE pdrv) {
 
-#define MMC     0
-#define SDC     0
+  if (pdrv >= NUM_DRIVES)
+    return NULL;
+  return drives[pdrv];
+}
 
 
 
@@ -40,30 +79,19 @@ DSTATUS disk_initialize (
     BYTE pdrv                /* Physical drive nmuber (0..) */
 )
 {
+  BaseBlockDevice *bdp = get_drive(pdrv);
   DSTATUS stat;
 
-  switch (pdrv) {
-#if HAL_USE_MMC_SPI
-  case MMC:
-    stat = 0;
-    /* It is initialized externally, just reads the status.*/
-    if (blkGetDriverState(&MMCD1) != BLK_READY)
-      stat |= STA_NOINIT;
-    if (mmcIsWriteProtected(&MMCD1))
-      stat |=  STA_PROTECT;
-    return stat;
-#else
-  case SDC:
-    stat = 0;
-    /* It is initialized externally, just reads the status.*/
-    if (blkGetDriverState(&SDCD1) != BLK_READY)
-      stat |= STA_NOINIT;
-    if (sdcIsWriteProtected(&SDCD1))
-      stat |=  STA_PROTECT;
-    return stat;
-#endif
-  }
-  return STA_NOINIT;
+  if (bdp == NULL)
+    return STA_NOINIT;
+
+  stat = 0;
+  /* It is initialized externally, just reads the status.*/
+  if (blkGetDriverState(bdp) != BLK_READY)
+    stat |= STA_NOINIT;
+  if (blkIsWriteProtected(bdp))
+    stat |=  STA_PROTECT;
+  return stat;
 }
 
 
@@ -75,30 +103,19 @@ DSTATUS disk_status (
     BYTE pdrv        /* Physical drive nmuber (0..) */
 )
 {
+  BaseBlockDevice *bdp = get_drive(pdrv);
   DSTATUS stat;
 
-  switch (pdrv) {
-#if HAL_USE_MMC_SPI
-  case MMC:
-    stat = 0;
-    /* It is initialized externally, just reads the status.*/
-    if (blkGetDriverState(&MMCD1) != BLK_READY)
-      stat |= STA_NOINIT;
-    if (mmcIsWriteProtected(&MMCD1))
-      stat |= STA_PROTECT;
-    return stat;
-#else
-  case SDC:
-    stat = 0;
-    /* It is initialized externally, just reads the status.*/
-    if (blkGetDriverState(&SDCD1) != BLK_READY)
-      stat |= STA_NOINIT;
-    if (sdcIsWriteProtected(&SDCD1))
-      stat |= STA_PROTECT;
-    return stat;
-#endif
-  }
-  return STA_NOINIT;
+  if (bdp == NULL)
+    return STA_NOINIT;
+
+  stat = 0;
+  /* It is initialized externally, just reads the status.*/
+  if (blkGetDriverState(bdp) != BLK_READY)
+    stat |= STA_NOINIT;
+  if (blkIsWriteProtected(bdp))
+    stat |= STA_PROTECT;
+  return stat;
 }
 
 
@@ -113,32 +130,16 @@ DRESULT disk_read (
     UINT count        /* Number of sectors to read (1..255) */
 )
 {
-  switch (pdrv) {
-#if HAL_USE_MMC_SPI
-  case MMC:
-    if (blkGetDriverState(&MMCD1) != BLK_READY)
-      return RES_NOTRDY;
-    if (mmcStartSequentialRead(&MMCD1, sector))
-      return RES_ERROR;
-    while (count > 0) {
-      if (mmcSequentialRead(&MMCD1, buff))
-        return RES_ERROR;
-      buff += MMCSD_BLOCK_SIZE;
-      count--;
-    }
-    if (mmcStopSequentialRead(&MMCD1))
-        return RES_ERROR;
-    return RES_OK;
-#else
-  case SDC:
-    if (blkGetDriverState(&SDCD1) != BLK_READY)
-      return RES_NOTRDY;
-    if (sdcRead(&SDCD1, sector, buff, count))
-      return RES_ERROR;
-    return RES_OK;
-#endif
-  }
-  return RES_PARERR;
+  BaseBlockDevice *bdp = get_drive(pdrv);
+
+  if (bdp == NULL)
+    return RES_PARERR;
+  if (blkGetDriverState(bdp) != BLK_READY)
+    return RES_NOTRDY;
+  /* All the sectors are transferred using a single multi-block operation.*/
+  if (blkRead(bdp, sector, buff, count))
+    return RES_ERROR;
+  return RES_OK;
 }
 
 
@@ -154,34 +155,19 @@ DRESULT disk_write (
     UINT count            /* Number of sectors to write (1..255) */
 )
 {
-  switch (pdrv) {
-#if HAL_USE_MMC_SPI
-  case MMC:
-    if (blkGetDriverState(&MMCD1) != BLK_READY)
-        return RES_NOTRDY;
-    if (mmcIsWriteProtected(&MMCD1))
-        return RES_WRPRT;
-    if (mmcStartSequentialWrite(&MMCD1, sector))
-        return RES_ERROR;
-    while (count > 0) {
-        if (mmcSequentialWrite(&MMCD1, buff))
-            return RES_ERROR;
-        buff += MMCSD_BLOCK_SIZE;
-        count--;
-    }
-    if (mmcStopSequentialWrite(&MMCD1))
-        return RES_ERROR;
-    return RES_OK;
-#else
-  case SDC:
-    if (blkGetDriverState(&SDCD1) != BLK_READY)
-      return RES_NOTRDY;
-    if (sdcWrite(&SDCD1, sector, buff, count))
-      return RES_ERROR;
-    return RES_OK;
-#endif
-  }
-  return RES_PARERR;
+  BaseBlockDevice *bdp = get_drive(pdrv);
+
+  if (bdp == NULL)
+    return RES_PARERR;
+  if (blkGetDriverState(bdp) != BLK_READY)
+    return RES_NOTRDY;
+  if (blkIsWriteProtected(bdp))
+    return RES_WRPRT;
+  /* All the sectors are transferred using a single multi-block operation,
+     the card drivers pre-erase the whole area when supported.*/
+  if (blkWrite(bdp, sector, buff, count))
+    return RES_ERROR;
+  return RES_OK;
 }
 #endif /* _USE_WRITE */
 
@@ -197,48 +183,41 @@ DRESULT disk_ioctl (
     void *buff        /* Buffer to send/receive control data */
 )
 {
-  switch (pdrv) {
-#if HAL_USE_MMC_SPI
-  case MMC:
-    switch (cmd) {
-    case CTRL_SYNC:
-        return RES_OK;
-    case GET_SECTOR_SIZE:
-        *((WORD *)buff) = MMCSD_BLOCK_SIZE;
-        return RES_OK;
-#if _USE_ERASE
-    case CTRL_ERASE_SECTOR:
-        mmcErase(&MMCD1, *((DWORD *)buff), *((DWORD *)buff + 1));
-        return RES_OK;
-#endif
-    default:
-        return RES_PARERR;
-    }
-#else
-  case SDC:
-    switch (cmd) {
-    case CTRL_SYNC:
-        return RES_OK;
-    case GET_SECTOR_COUNT:
-        *((DWORD *)buff) = mmcsdGetCardCapacity(&SDCD1);
-        return RES_OK;
-    case GET_SECTOR_SIZE:
-        *((WORD *)buff) = MMCSD_BLOCK_SIZE;
-        return RES_OK;
-    case GET_BLOCK_SIZE:
-        *((DWORD *)buff) = 256; /* 512b blocks in one erase block */
-        return RES_OK;
+  BaseBlockDevice *bdp = get_drive(pdrv);
+  BlockDeviceInfo bdi;
+
+  if (bdp == NULL)
+    return RES_PARERR;
+  if (blkGetDriverState(bdp) != BLK_READY)
+    return RES_NOTRDY;
+
+  switch (cmd) {
+  case CTRL_SYNC:
+    if (blkSync(bdp))
+      return RES_ERROR;
+    return RES_OK;
+  case GET_SECTOR_COUNT:
+    if (blkGetInfo(bdp, &bdi))
+      return RES_ERROR;
+    *((DWORD *)buff) = bdi.blk_num;
+    return RES_OK;
+  case GET_SECTOR_SIZE:
+    if (blkGetInfo(bdp, &bdi))
+      return RES_ERROR;
+    *((WORD *)buff) = (WORD)bdi.blk_size;
+    return RES_OK;
+  case GET_BLOCK_SIZE:
+    *((DWORD *)buff) = 256; /* 512b blocks in one erase block */
+    return RES_OK;
 #if _USE_ERASE
-    case CTRL_ERASE_SECTOR:
-        sdcErase(&SDCD1, *((DWORD *)buff), *((DWORD *)buff + 1));
-        return RES_OK;
-#endif
-    default:
-        return RES_PARERR;
-    }
+  case CTRL_ERASE_SECTOR:
+    if (blkErase(bdp, *((DWORD *)buff), *((DWORD *)buff + 1)))
+      return RES_ERROR;
+    return RES_OK;
 #endif
+  default:
+    return RES_PARERR;
   }
-  return RES_PARERR;
 }
 #endif /* _USE_IOCTL */
 
@@ -0,0 +1,145 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Serial I/O layer for the lwIP SLIP and PPP interfaces, the device number
+ * passed to sio_open() selects a channel in the LWIP_SIO_CHANNELS table.
+ * The table must be defined in lwipopts.h as an initializer of pointers
+ * to BaseAsynchronousChannel objects, for example:
+ * #define LWIP_SIO_CHANNELS {(BaseAsynchronousChannel *)&SD2}
+ * The channel events are used for waiting data, so a blocking sio_read()
+ * can be aborted using sio_read_abort().
+ */
+
+#include "hal.h"
+
+#include "lwip/opt.h"
+#include "lwip/sio.h"
+
+#if !defined(LWIP_SIO_CHANNELS)
+#error "LWIP_SIO_CHANNELS not defined in lwipopts.h"
+#endif
+
+/*
+ * Events used by the thread blocked in sio_read(), the upper ones are
+ * used so that they do not collide with the events of the caller.
+ */
+#define SIO_INPUT_EVENT     EVENT_MASK(sizeof (eventmask_t) * 8U - 1U)
+#define SIO_ABORT_EVENT     EVENT_MASK(sizeof (eventmask_t) * 8U - 2U)
+
+/*
+ * State of an opened channel.
+ */
+typedef struct {
+  BaseAsynchronousChannel   *chp;
+  thread_t                  *reader;
+  bool                      aborted;
+} sio_channel_t;
+
+static BaseAsynchronousChannel * const channels[] = LWIP_SIO_CHANNELS;
+
+#define NUM_CHANNELS    (sizeof channels / sizeof channels[0])
+
+static sio_channel_t sio_channels[NUM_CHANNELS];
+
+sio_fd_t sio_open(u8_t devnum) {
+  sio_channel_t *scp;
+
+  if (devnum >= NUM_CHANNELS)
+    return NULL;
+  scp = &sio_channels[devnum];
+  scp->chp     = channels[devnum];
+  scp->reader  = NULL;
+  scp->aborted = false;
+  return (sio_fd_t)scp;
+}
+
+void sio_send(u8_t c, sio_fd_t fd) {
+  sio_channel_t *scp = fd;
+
+  (void)chnPutTimeout(scp->chp, c, TIME_INFINITE);
+}
+
+u8_t sio_recv(sio_fd_t fd) {
+  sio_channel_t *scp = fd;
+
+  return (u8_t)chnGetTimeout(scp->chp, TIME_INFINITE);
+}
+
+u32_t sio_read(sio_fd_t fd, u8_t *data, u32_t len) {
+  sio_channel_t *scp = fd;
+  event_listener_t el;
+  size_t n;
+
+  if (len == 0)
+    return 0;
+
+  chEvtRegisterMaskWithFlags(chnGetEventSource(scp->chp), &el,
+                             SIO_INPUT_EVENT, CHN_INPUT_AVAILABLE);
+  chSysLock();
+  scp->reader = chThdGetSelfX();
+  chSysUnlock();
+
+  /* Waits for data then takes whatever is available, the registration
+     comes before the first read so data arriving in between is not
+     missed.*/
+  while (true) {
+    n = chnReadTimeout(scp->chp, data, (size_t)len, TIME_IMMEDIATE);
+    if (n > 0)
+      break;
+    chSysLock();
+    if (scp->aborted) {
+      scp->aborted = false;
+      chSysUnlock();
+      break;
+    }
+    chSysUnlock();
+    chEvtWaitAny(SIO_INPUT_EVENT | SIO_ABORT_EVENT);
+  }
+
+  chSysLock();
+  scp->reader = NULL;
+  chSysUnlock();
+  chEvtUnregister(chnGetEventSource(scp->chp), &el);
+  chEvtGetAndClearEvents(SIO_INPUT_EVENT | SIO_ABORT_EVENT);
+
+  return (u32_t)n;
+}
+
+u32_t sio_tryread(sio_fd_t fd, u8_t *data, u32_t len) {
+  sio_channel_t *scp = fd;
+
+  return (u32_t)chnReadTimeout(scp->chp, data, (size_t)len, TIME_IMMEDIATE);
+}
+
+u32_t sio_write(sio_fd_t fd, u8_t *data, u32_t len) {
+  sio_channel_t *scp = fd;
+
+  return (u32_t)chnWriteTimeout(scp->chp, data, (size_t)len, TIME_INFINITE);
+}
+
+void sio_read_abort(sio_fd_t fd) {
+  sio_channel_t *scp = fd;
+
+  /* If no thread is blocked then the next sio_read() returns zero.*/
+  chSysLock();
+  scp->aborted = true;
+  if (scp->reader != NULL) {
+    chEvtSignalI(scp->reader, SIO_ABORT_EVENT);
+    chSchRescheduleS();
+  }
+  chSysUnlock();
+}
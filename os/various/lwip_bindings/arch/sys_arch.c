@@ -60,13 +60,109 @@
 #include "arch/cc.h"
 #include "arch/sys_arch.h"
 
+/*
+ * Larger of two constants.
+ */
+#define SYS_MAX(a, b)               ((a) > (b) ? (a) : (b))
+
+/*
+ * Number of semaphores taken from a static pool, if zero the semaphores
+ * are allocated from the heap. Mutexes are semaphores too.
+ */
+#if !defined(LWIP_SYS_SEMAPHORES)
+#define LWIP_SYS_SEMAPHORES         (MEMP_NUM_NETCONN + 4)
+#endif
+
+/*
+ * Number of mailboxes taken from a static pool, if zero the mailboxes are
+ * allocated from the heap.
+ */
+#if !defined(LWIP_SYS_MAILBOXES)
+#define LWIP_SYS_MAILBOXES          (MEMP_NUM_NETCONN * 2)
+#endif
+
+/*
+ * Size of the pool mailboxes, larger mailboxes are allocated from the
+ * heap. The default fits the connection mailboxes, the large tcpip thread
+ * mailbox is allocated once at startup.
+ */
+#if !defined(LWIP_SYS_MAILBOX_SIZE)
+#define LWIP_SYS_MAILBOX_SIZE       SYS_MAX(SYS_MAX(DEFAULT_TCP_RECVMBOX_SIZE, \
+                                                    DEFAULT_UDP_RECVMBOX_SIZE),\
+                                            SYS_MAX(DEFAULT_RAW_RECVMBOX_SIZE, \
+                                                    DEFAULT_ACCEPTMBOX_SIZE))
+#endif
+
+/*
+ * Number of threads with working areas taken from a static pool, if zero
+ * the working areas are allocated from the core allocator and never
+ * freed.
+ */
+#if !defined(LWIP_SYS_THREADS)
+#define LWIP_SYS_THREADS            0
+#endif
+
+/*
+ * Stack size of the pool threads, threads requiring larger stacks are
+ * allocated from the core allocator.
+ */
+#if !defined(LWIP_SYS_THREAD_STACK_SIZE)
+#define LWIP_SYS_THREAD_STACK_SIZE  SYS_MAX(TCPIP_THREAD_STACKSIZE,        \
+                                            DEFAULT_THREAD_STACKSIZE)
+#endif
+
+#if (LWIP_SYS_SEMAPHORES > 0) || (LWIP_SYS_MAILBOXES > 0) ||               \
+    (LWIP_SYS_THREADS > 0)
+#if CH_CFG_USE_MEMPOOLS == FALSE
+#error "the lwIP pools require CH_CFG_USE_MEMPOOLS"
+#endif
+#endif
+
+#if (LWIP_SYS_THREADS > 0) && (CH_CFG_USE_DYNAMIC == FALSE)
+#error "LWIP_SYS_THREADS requires CH_CFG_USE_DYNAMIC"
+#endif
+
+#if LWIP_SYS_SEMAPHORES > 0
+static semaphore_t sems[LWIP_SYS_SEMAPHORES];
+static MEMORYPOOL_DECL(sem_pool, sizeof (semaphore_t), NULL);
+#endif
+
+#if LWIP_SYS_MAILBOXES > 0
+typedef struct {
+  mailbox_t             mb;
+  msg_t                 buf[LWIP_SYS_MAILBOX_SIZE];
+} sys_mbox_obj_t;
+
+static sys_mbox_obj_t mboxes[LWIP_SYS_MAILBOXES];
+static MEMORYPOOL_DECL(mbox_pool, sizeof (sys_mbox_obj_t), NULL);
+#endif
+
+#if LWIP_SYS_THREADS > 0
+static THD_WORKING_AREA(threads[LWIP_SYS_THREADS],
+                        LWIP_SYS_THREAD_STACK_SIZE);
+static MEMORYPOOL_DECL(thread_pool, sizeof (threads[0]), NULL);
+#endif
+
 void sys_init(void) {
 
+#if LWIP_SYS_SEMAPHORES > 0
+  chPoolLoadArray(&sem_pool, sems, LWIP_SYS_SEMAPHORES);
+#endif
+#if LWIP_SYS_MAILBOXES > 0
+  chPoolLoadArray(&mbox_pool, mboxes, LWIP_SYS_MAILBOXES);
+#endif
+#if LWIP_SYS_THREADS > 0
+  chPoolLoadArray(&thread_pool, threads, LWIP_SYS_THREADS);
+#endif
 }
 
 err_t sys_sem_new(sys_sem_t *sem, u8_t count) {
 
+#if LWIP_SYS_SEMAPHORES > 0
+  *sem = chPoolAlloc(&sem_pool);
+#else
   *sem = chHeapAlloc(NULL, sizeof(semaphore_t));
+#endif
   if (*sem == 0) {
     SYS_STATS_INC(sem.err);
     return ERR_MEM;
@@ -80,7 +176,11 @@ err_t sys_sem_new(sys_sem_t *sem, u8_t count) {
 
 void sys_sem_free(sys_sem_t *sem) {
 
+#if LWIP_SYS_SEMAPHORES > 0
+  chPoolFree(&sem_pool, *sem);
+#else
   chHeapFree(*sem);
+#endif
   *sem = SYS_SEM_NULL;
   SYS_STATS_DEC(sem.used);
 }
@@ -96,14 +196,14 @@ void sys_sem_signal_S(sys_sem_t *sem) {
 
   chSemSignalI(*sem);
   chSchRescheduleS();
-}
-
-u32_t sys_arch_sem_wait(sys_sem_t *sem, u32_t timeout) {
-  systime_t tmo;
-  u32_t time;
-
-  osalSysLock();
-  tmo = timeout > 0 ? (systime_t)timeout : TIME_INFINITE;
+}
+
+u32_t sys_arch_sem_wait(sys_sem_t *sem, u32_t timeout) {
+  systime_t tmo;
+  u32_t time;
+
+  osalSysLock();
+  tmo = timeout > 0 ? (systime_t)timeout : TIME_INFINITE;
   time = (u32_t)osalOsGetSystemTimeX();
   if (chSemWaitTimeoutS(*sem, tmo) != MSG_OK)
     time = SYS_ARCH_TIMEOUT;
@@ -124,7 +224,23 @@ void sys_sem_set_invalid(sys_sem_t *sem) {
 }
 
 err_t sys_mbox_new(sys_mbox_t *mbox, int size) {
-  
+
+#if LWIP_SYS_MAILBOXES > 0
+  if (size <= LWIP_SYS_MAILBOX_SIZE) {
+    sys_mbox_obj_t *mop = chPoolAlloc(&mbox_pool);
+
+    if (mop == NULL) {
+      *mbox = SYS_MBOX_NULL;
+      SYS_STATS_INC(mbox.err);
+      return ERR_MEM;
+    }
+    chMBObjectInit(&mop->mb, mop->buf, size);
+    *mbox = &mop->mb;
+    SYS_STATS_INC_USED(mbox);
+    return ERR_OK;
+  }
+#endif
+
   *mbox = chHeapAlloc(NULL, sizeof(mailbox_t) + sizeof(msg_t) * size);
   if (*mbox == 0) {
     SYS_STATS_INC(mbox.err);
@@ -132,7 +248,7 @@ err_t sys_mbox_new(sys_mbox_t *mbox, int size) {
   }
   else {
     chMBObjectInit(*mbox, (void *)(((uint8_t *)*mbox) + sizeof(mailbox_t)), size);
-    SYS_STATS_INC(mbox.used);
+    SYS_STATS_INC_USED(mbox);
     return ERR_OK;
   }
 }
@@ -151,7 +267,16 @@ void sys_mbox_free(sys_mbox_t *mbox) {
     SYS_STATS_INC(mbox.err);
     chMBReset(*mbox);
   }
+#if LWIP_SYS_MAILBOXES > 0
+  /* Mailboxes outside the pool array come from the heap.*/
+  if (((uint8_t *)*mbox >= (uint8_t *)&mboxes[0]) &&
+      ((uint8_t *)*mbox < (uint8_t *)&mboxes[LWIP_SYS_MAILBOXES]))
+    chPoolFree(&mbox_pool, *mbox);
+  else
+    chHeapFree(*mbox);
+#else
   chHeapFree(*mbox);
+#endif
   *mbox = SYS_MBOX_NULL;
   SYS_STATS_DEC(mbox.used);
 }
@@ -168,14 +293,14 @@ err_t sys_mbox_trypost(sys_mbox_t *mbox, void *msg) {
     return ERR_MEM;
   }
   return ERR_OK;
-}
-
-u32_t sys_arch_mbox_fetch(sys_mbox_t *mbox, void **msg, u32_t timeout) {
-  u32_t time;
-  systime_t tmo;
-
-  osalSysLock();
-  tmo = timeout > 0 ? (systime_t)timeout : TIME_INFINITE;
+}
+
+u32_t sys_arch_mbox_fetch(sys_mbox_t *mbox, void **msg, u32_t timeout) {
+  u32_t time;
+  systime_t tmo;
+
+  osalSysLock();
+  tmo = timeout > 0 ? (systime_t)timeout : TIME_INFINITE;
   time = (u32_t)osalOsGetSystemTimeX();
   if (chMBFetchS(*mbox, (msg_t *)msg, tmo) != MSG_OK)
     time = SYS_ARCH_TIMEOUT;
@@ -209,7 +334,21 @@ sys_thread_t sys_thread_new(const char *name, lwip_thread_fn thread,
   syssts_t sts;
   thread_t *tp;
 
-  (void)name;
+#if LWIP_SYS_THREADS > 0
+  if (stacksize <= LWIP_SYS_THREAD_STACK_SIZE) {
+    tp = chThdCreateFromMemoryPool(&thread_pool, prio, (tfunc_t)thread, arg);
+    if (tp == NULL)
+      return NULL;
+
+    /* The reference is released after naming the thread, nobody waits for
+       lwIP threads so the working area goes back to the pool when the
+       thread terminates.*/
+    chRegSetThreadNameX(tp, name);
+    chThdRelease(tp);
+    return (sys_thread_t)tp;
+  }
+#endif
+
   wsz = THD_WORKING_AREA_SIZE(stacksize);
   wsp = chCoreAlloc(wsz);
   if (wsp == NULL)
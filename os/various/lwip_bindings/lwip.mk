@@ -8,6 +8,12 @@ LWBINDSRC = \
 LWNETIFSRC = \
         ${LWIP}/src/netif/etharp.c
 
+# Optional SLIP support, add $(LWSLIPSRC) to the sources and define
+# LWIP_SIO_CHANNELS in lwipopts.h.
+LWSLIPSRC = \
+        ${CHIBIOS}/os/various/lwip_bindings/arch/sio.c \
+        ${LWIP}/src/netif/slipif.c
+
 LWCORESRC = \
         ${LWIP}/src/core/dhcp.c \
         ${LWIP}/src/core/dns.c \
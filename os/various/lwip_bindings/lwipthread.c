@@ -78,6 +78,57 @@
 
 #define PERIODIC_TIMER_ID       1
 #define FRAME_RECEIVED_ID       2
+#define LINK_CHANGED_ID         4
+#define INTERFACE_ADDED_ID      8
+#define TX_DONE_ID              16
+
+/*
+ * Event flags from this one upward are assigned to the interfaces served
+ * by the lwIP thread.
+ */
+#define FIRST_INTERFACE_EVENT   5
+
+#if LWIP_USE_ZERO_COPY
+#if !MAC_USE_ZERO_COPY
+#error "LWIP_USE_ZERO_COPY requires MAC_USE_ZERO_COPY"
+#endif
+#if !LWIP_SUPPORT_CUSTOM_PBUF
+#error "LWIP_USE_ZERO_COPY requires LWIP_SUPPORT_CUSTOM_PBUF"
+#endif
+#if ETH_PAD_SIZE
+#error "LWIP_USE_ZERO_COPY requires ETH_PAD_SIZE == 0"
+#endif
+
+/*
+ * Custom pbuf referring to a MAC receive buffer, the descriptor is kept
+ * until the pbuf is freed.
+ */
+typedef struct {
+  struct pbuf_custom    pc;
+  MACReceiveDescriptor  rd;
+} rx_pbuf_t;
+
+static rx_pbuf_t rx_pbufs[LWIP_ZERO_COPY_FRAMES];
+static MEMORYPOOL_DECL(rx_pool, sizeof (rx_pbuf_t), NULL);
+
+/*
+ * Maximum number of pbufs in a frame transmitted without copying.
+ */
+#define TX_SEGMENTS             4
+
+/*
+ * Transmitted frames no more used by the MAC, they are freed in the
+ * LWIP-MAC thread.
+ */
+static msg_t tx_done_buffer[LWIP_ZERO_COPY_TX_FRAMES];
+static MAILBOX_DECL(tx_done, tx_done_buffer, LWIP_ZERO_COPY_TX_FRAMES);
+
+/*
+ * Frames attached to the MAC and not yet freed, it is updated by both the
+ * tcpip and the LWIP-MAC threads under lock.
+ */
+static unsigned tx_inflight;
+#endif /* LWIP_USE_ZERO_COPY */
 
 /*
  * Suspension point for initialization procedure.
@@ -89,6 +140,31 @@ thread_reference_t lwip_trp = NULL;
  */
 static THD_WORKING_AREA(wa_lwip_thread, LWIP_THREAD_STACK_SIZE);
 
+/*
+ * The LWIP-MAC thread.
+ */
+static thread_t *lwip_tp;
+
+/*
+ * Registered interfaces and interfaces waiting to be registered by the
+ * LWIP-MAC thread.
+ */
+static lwipif_t *interfaces;
+static lwipif_t *pending;
+
+/*
+ * Next event flag to be assigned.
+ */
+static unsigned next_event = FIRST_INTERFACE_EVENT;
+
+#if LWIP_DEFAULT_INTERFACE
+/*
+ * Interface bound to ETHD1.
+ */
+static lwipif_t default_if;
+static lwipif_config_t default_config;
+#endif
+
 /*
  * Initialization.
  */
@@ -106,24 +182,98 @@ static void low_level_init(struct netif *netif) {
   /* Do whatever else is needed to initialize interface. */
 }
 
+#if LWIP_USE_ZERO_COPY
+/*
+ * Transmit completion callback, the frame is queued for freeing and the
+ * LWIP-MAC thread is notified.
+ */
+static void tx_done_cb(void *arg) {
+
+  chMBPostI(&tx_done, (msg_t)arg);
+  chEvtSignalI(lwip_tp, TX_DONE_ID);
+}
+
+/*
+ * Frees the transmitted frames, it runs in the LWIP-MAC thread.
+ */
+static void tx_reclaim(void) {
+  msg_t msg;
+
+  while (chMBFetch(&tx_done, &msg, TIME_IMMEDIATE) == MSG_OK) {
+    pbuf_free((struct pbuf *)msg);
+    chSysLock();
+    tx_inflight--;
+    chSysUnlock();
+  }
+}
+
+/*
+ * Attaches the pbufs of a frame to a transmit descriptor, the frame is
+ * referenced until the MAC is done with it.
+ */
+static bool tx_attach(MACDriver *macp, MACTransmitDescriptor *tdp,
+                      struct pbuf *p) {
+  macbuffer_t bufs[TX_SEGMENTS];
+  struct pbuf *q;
+  unsigned n;
+
+  if (tx_inflight >= LWIP_ZERO_COPY_TX_FRAMES)
+    return false;
+
+  /* Only the pbufs owned by lwIP can be kept after returning, the data of
+     the other ones could be changed by the caller.*/
+  n = 0;
+  for (q = p; q != NULL; q = q->next) {
+    if ((q->type != PBUF_RAM) && (q->type != PBUF_POOL))
+      return false;
+    if (q->len == 0)
+      continue;
+    if (n >= TX_SEGMENTS)
+      return false;
+    bufs[n].buf  = q->payload;
+    bufs[n].size = q->len;
+    n++;
+  }
+
+  if (macAttachTransmitBuffers(macp, tdp, bufs, n,
+                               tx_done_cb, p) != HAL_SUCCESS)
+    return false;
+  pbuf_ref(p);
+  chSysLock();
+  tx_inflight++;
+  chSysUnlock();
+  return true;
+}
+#endif /* LWIP_USE_ZERO_COPY */
+
 /*
  * Transmits a frame.
  */
 static err_t low_level_output(struct netif *netif, struct pbuf *p) {
+  lwipif_t *ifp = netif->state;
   struct pbuf *q;
   MACTransmitDescriptor td;
 
-  (void)netif;
-  if (macWaitTransmitDescriptor(&ETHD1, &td, MS2ST(LWIP_SEND_TIMEOUT)) != MSG_OK)
+  if (macWaitTransmitDescriptor(ifp->config->macp, &td,
+                                MS2ST(LWIP_SEND_TIMEOUT)) != MSG_OK) {
+    ifp->stats.txerrors++;
     return ERR_TIMEOUT;
+  }
 
 #if ETH_PAD_SIZE
   pbuf_header(p, -ETH_PAD_SIZE);        /* drop the padding word */
 #endif
 
-  /* Iterates through the pbuf chain. */
-  for(q = p; q != NULL; q = q->next)
-    macWriteTransmitDescriptor(&td, (uint8_t *)q->payload, (size_t)q->len);
+#if LWIP_USE_ZERO_COPY
+  if (tx_attach(ifp->config->macp, &td, p))
+    ifp->stats.txattached++;
+  else
+#endif
+  {
+    /* Iterates through the pbuf chain. */
+    for(q = p; q != NULL; q = q->next)
+      macWriteTransmitDescriptor(&td, (uint8_t *)q->payload, (size_t)q->len);
+  }
   macReleaseTransmitDescriptor(&td);
 
 #if ETH_PAD_SIZE
@@ -131,20 +281,80 @@ static err_t low_level_output(struct netif *netif, struct pbuf *p) {
 #endif
 
   LINK_STATS_INC(link.xmit);
+  ifp->stats.txframes++;
 
   return ERR_OK;
 }
 
+#if LWIP_USE_ZERO_COPY
+/*
+ * Frees a zero-copy pbuf, the MAC buffer is given back to the driver.
+ */
+static void rx_pbuf_free(struct pbuf *p) {
+  rx_pbuf_t *rxp = (rx_pbuf_t *)p;
+
+  macReleaseReceiveDescriptor(&rxp->rd);
+  chPoolFree(&rx_pool, rxp);
+}
+
+/*
+ * Wraps the received frame in a custom pbuf, returns NULL if the frame has
+ * been dropped.
+ */
+static struct pbuf *rx_pbuf_wrap(lwipif_t *ifp, rx_pbuf_t *rxp) {
+  const uint8_t *buf;
+  size_t size, len;
+  struct pbuf *p;
+
+  len = rxp->rd.size;
+  buf = macGetNextReceiveBuffer(&rxp->rd, &size);
+
+  /* Frames spanning more buffers cannot be referenced as a single pbuf,
+     the MAC buffers should be large enough for a whole frame.*/
+  if ((buf == NULL) || (size < len)) {
+    macReleaseReceiveDescriptor(&rxp->rd);
+    chPoolFree(&rx_pool, rxp);
+    LINK_STATS_INC(link.lenerr);
+    LINK_STATS_INC(link.drop);
+    ifp->stats.rxerrors++;
+    return NULL;
+  }
+
+  rxp->pc.custom_free_function = rx_pbuf_free;
+  p = pbuf_alloced_custom(PBUF_RAW, (u16_t)len, PBUF_REF, &rxp->pc,
+                          (void *)buf, (u16_t)size);
+  LINK_STATS_INC(link.recv);
+  ifp->stats.rxframes++;
+  return p;
+}
+#endif /* LWIP_USE_ZERO_COPY */
+
 /*
  * Receives a frame.
  */
 static struct pbuf *low_level_input(struct netif *netif) {
+  lwipif_t *ifp = netif->state;
   MACReceiveDescriptor rd;
   struct pbuf *p, *q;
   u16_t len;
 
-  (void)netif;
-  if (macWaitReceiveDescriptor(&ETHD1, &rd, TIME_IMMEDIATE) == MSG_OK) {
+#if LWIP_USE_ZERO_COPY
+  {
+    rx_pbuf_t *rxp = chPoolAlloc(&rx_pool);
+
+    /* If there are no free wrappers the frame is copied as usual.*/
+    if (rxp != NULL) {
+      if (macWaitReceiveDescriptor(ifp->config->macp, &rxp->rd,
+                                   TIME_IMMEDIATE) == MSG_OK)
+        return rx_pbuf_wrap(ifp, rxp);
+      chPoolFree(&rx_pool, rxp);
+      return NULL;
+    }
+  }
+#endif /* LWIP_USE_ZERO_COPY */
+
+  if (macWaitReceiveDescriptor(ifp->config->macp, &rd,
+                               TIME_IMMEDIATE) == MSG_OK) {
     len = (u16_t)rd.size;
 
 #if ETH_PAD_SIZE
@@ -170,17 +380,125 @@ static struct pbuf *low_level_input(struct netif *netif) {
 #endif
 
       LINK_STATS_INC(link.recv);
+      ifp->stats.rxframes++;
     }
     else {
       macReleaseReceiveDescriptor(&rd);
       LINK_STATS_INC(link.memerr);
       LINK_STATS_INC(link.drop);
+      ifp->stats.rxerrors++;
     }
     return p;
   }
   return NULL;
 }
 
+#if LWIP_TCPIP_RX
+/*
+ * Drains the received frames, it runs in the tcpip thread.
+ */
+static void ethernetif_rx(void *ctx) {
+  lwipif_t *ifp = ctx;
+  struct pbuf *p;
+
+  /* Frames arriving from now on require another callback.*/
+  chSysLock();
+  ifp->rx_pending = false;
+  chSysUnlock();
+
+  while ((p = low_level_input(&ifp->netif)) != NULL) {
+    /* Frames of unknown types are freed by ethernet_input().*/
+    (void)ethernet_input(p, &ifp->netif);
+  }
+}
+
+/*
+ * Drops the received frames, the MAC buffers are returned immediately.
+ */
+static void ethernetif_drop(lwipif_t *ifp) {
+  MACReceiveDescriptor rd;
+
+  while (macWaitReceiveDescriptor(ifp->config->macp, &rd,
+                                  TIME_IMMEDIATE) == MSG_OK) {
+    macReleaseReceiveDescriptor(&rd);
+    LINK_STATS_INC(link.drop);
+    ifp->stats.rxdropped++;
+  }
+}
+#endif /* LWIP_TCPIP_RX */
+
+/*
+ * Handles a receive event.
+ */
+static void ethernetif_input(lwipif_t *ifp) {
+#if LWIP_TCPIP_RX
+  bool post;
+
+  /* One callback drains all the frames, if one is already pending then it
+     will find the new frames too. The flag is cleared by the tcpip thread.*/
+  chSysLock();
+  post = !ifp->rx_pending;
+  ifp->rx_pending = true;
+  chSysUnlock();
+  if (post && (tcpip_trycallback(ifp->rx_msg) != ERR_OK)) {
+    /* The tcpip thread is not keeping up, waiting for it would stall the
+       other interfaces so the frames are dropped instead.*/
+    chSysLock();
+    ifp->rx_pending = false;
+    chSysUnlock();
+    ethernetif_drop(ifp);
+  }
+#else /* !LWIP_TCPIP_RX */
+  struct pbuf *p;
+
+  while ((p = low_level_input(&ifp->netif)) != NULL) {
+    struct eth_hdr *ethhdr = p->payload;
+    switch (htons(ethhdr->type)) {
+    /* IP or ARP packet? */
+    case ETHTYPE_IP:
+    case ETHTYPE_ARP:
+#if PPPOE_SUPPORT
+    /* PPPoE packet? */
+    case ETHTYPE_PPPOEDISC:
+    case ETHTYPE_PPPOE:
+#endif /* PPPOE_SUPPORT */
+      /* full packet send to tcpip_thread to process */
+      if (ifp->netif.input(p, &ifp->netif) == ERR_OK)
+        break;
+      LWIP_DEBUGF(NETIF_DEBUG, ("ethernetif_input: IP input error\n"));
+      ifp->stats.rxerrors++;
+    default:
+      pbuf_free(p);
+    }
+  }
+#endif /* !LWIP_TCPIP_RX */
+}
+
+/*
+ * Updates the link status of an interface.
+ */
+static void ethernetif_link(lwipif_t *ifp) {
+  bool current_link_status = macPollLinkStatus(ifp->config->macp);
+
+  if (current_link_status != netif_is_link_up(&ifp->netif)) {
+    ifp->stats.linkchanges++;
+    if (current_link_status) {
+      tcpip_callback_with_block((tcpip_callback_fn) netif_set_link_up,
+                                 &ifp->netif, 0);
+#if LWIP_DHCP
+      dhcp_start(&ifp->netif);
+#endif
+    }
+    else {
+      tcpip_callback_with_block((tcpip_callback_fn) netif_set_link_down,
+                                 &ifp->netif, 0);
+#if LWIP_DHCP
+      dhcp_stop(&ifp->netif);
+#endif
+    }
+  }
+}
+
 /*
  * Initialization.
  */
@@ -197,7 +515,7 @@ static err_t ethernetif_init(struct netif *netif) {
    */
   NETIF_INIT_SNMP(netif, snmp_ifType_ethernet_csmacd, LWIP_LINK_SPEED);
 
-  netif->state = NULL;
+  /* The state field points to the owner lwipif_t structure.*/
   netif->name[0] = LWIP_IFNAME0;
   netif->name[1] = LWIP_IFNAME1;
   /* We directly use etharp_output() here to save a function call.
@@ -213,6 +531,97 @@ static err_t ethernetif_init(struct netif *netif) {
   return ERR_OK;
 }
 
+/**
+ * @brief   Receive thread of an interface with a dedicated thread.
+ *
+ * @param[in] p pointer to the @p lwipif_t structure
+ * @return The function does not return.
+ */
+static THD_FUNCTION(ethernetif_thread, p) {
+  lwipif_t *ifp = p;
+  event_listener_t el;
+
+  chRegSetThreadName("lwiprx");
+
+  chEvtRegisterMask(macGetReceiveEventSource(ifp->config->macp), &el,
+                    FRAME_RECEIVED_ID);
+  chEvtAddEvents(FRAME_RECEIVED_ID);
+
+  while (true) {
+    chEvtWaitAny(FRAME_RECEIVED_ID);
+    ethernetif_input(ifp);
+  }
+}
+
+/*
+ * Brings up an interface, it runs in the LWIP-MAC thread.
+ */
+static void ethernetif_register(lwipif_t *ifp) {
+  const lwipif_config_t *config = ifp->config;
+  struct ip_addr ip, gateway, netmask;
+  unsigned i;
+
+  if (config->macaddress != NULL) {
+    for (i = 0; i < 6; i++)
+      ifp->netif.hwaddr[i] = config->macaddress[i];
+  }
+  else {
+    ifp->netif.hwaddr[0] = LWIP_ETHADDR_0;
+    ifp->netif.hwaddr[1] = LWIP_ETHADDR_1;
+    ifp->netif.hwaddr[2] = LWIP_ETHADDR_2;
+    ifp->netif.hwaddr[3] = LWIP_ETHADDR_3;
+    ifp->netif.hwaddr[4] = LWIP_ETHADDR_4;
+    ifp->netif.hwaddr[5] = LWIP_ETHADDR_5;
+  }
+  ip.addr = config->address;
+  gateway.addr = config->gateway;
+  netmask.addr = config->netmask;
+
+  ifp->stats.txframes = 0;
+  ifp->stats.txattached = 0;
+  ifp->stats.txerrors = 0;
+  ifp->stats.rxframes = 0;
+  ifp->stats.rxerrors = 0;
+  ifp->stats.rxdropped = 0;
+  ifp->stats.linkchanges = 0;
+  ifp->link_event = false;
+#if LWIP_TCPIP_RX
+  ifp->rx_pending = false;
+  ifp->rx_msg = tcpip_callbackmsg_new(ethernetif_rx, ifp);
+  chDbgAssert(ifp->rx_msg != NULL, "no memory for the receive callback");
+#endif
+
+  ifp->mac_config.mac_address = ifp->netif.hwaddr;
+  macStart(config->macp, &ifp->mac_config);
+  netif_add(&ifp->netif, &ip, &netmask, &gateway, ifp, ethernetif_init,
+            tcpip_input);
+
+  /* The first interface is the default one.*/
+  if (netif_default == NULL)
+    netif_set_default(&ifp->netif);
+  netif_set_up(&ifp->netif);
+
+  /* Received frames handled by a dedicated thread or by this thread.*/
+  if (config->wsp != NULL) {
+    ifp->events = 0;
+    chThdCreateStatic(config->wsp, config->wssize, config->prio,
+                      ethernetif_thread, ifp);
+  }
+  else {
+    chDbgAssert(next_event < sizeof (eventmask_t) * 8U, "too many interfaces");
+    ifp->events = EVENT_MASK(next_event++);
+    chEvtRegisterMask(macGetReceiveEventSource(config->macp), &ifp->el,
+                      ifp->events);
+    chEvtAddEvents(ifp->events);
+  }
+
+  ifp->next = interfaces;
+  interfaces = ifp;
+
+  /* Initial link status.*/
+  ethernetif_link(ifp);
+}
+
 /**
  * @brief LWIP handling thread.
  *
@@ -221,50 +630,50 @@ static err_t ethernetif_init(struct netif *netif) {
  */
 static THD_FUNCTION(lwip_thread, p) {
   event_timer_t evt;
-  event_listener_t el0, el1;
-  struct ip_addr ip, gateway, netmask;
-  static struct netif thisif;
-  static const MACConfig mac_config = {thisif.hwaddr};
+  event_listener_t el0;
 
   chRegSetThreadName("lwipthread");
 
+#if LWIP_USE_ZERO_COPY
+  chPoolLoadArray(&rx_pool, rx_pbufs, LWIP_ZERO_COPY_FRAMES);
+#endif
+
   /* Initializes the thing.*/
   tcpip_init(NULL, NULL);
 
+#if LWIP_DEFAULT_INTERFACE
   /* TCP/IP parameters, runtime or compile time.*/
+  default_config.macp = &ETHD1;
   if (p) {
     struct lwipthread_opts *opts = p;
-    unsigned i;
 
-    for (i = 0; i < 6; i++)
-      thisif.hwaddr[i] = opts->macaddress[i];
-    ip.addr = opts->address;
-    gateway.addr = opts->gateway;
-    netmask.addr = opts->netmask;
+    default_config.macaddress = opts->macaddress;
+    default_config.address = opts->address;
+    default_config.gateway = opts->gateway;
+    default_config.netmask = opts->netmask;
   }
   else {
-    thisif.hwaddr[0] = LWIP_ETHADDR_0;
-    thisif.hwaddr[1] = LWIP_ETHADDR_1;
-    thisif.hwaddr[2] = LWIP_ETHADDR_2;
-    thisif.hwaddr[3] = LWIP_ETHADDR_3;
-    thisif.hwaddr[4] = LWIP_ETHADDR_4;
-    thisif.hwaddr[5] = LWIP_ETHADDR_5;
+    struct ip_addr ip, gateway, netmask;
+
     LWIP_IPADDR(&ip);
     LWIP_GATEWAY(&gateway);
     LWIP_NETMASK(&netmask);
+    default_config.macaddress = NULL;
+    default_config.address = ip.addr;
+    default_config.gateway = gateway.addr;
+    default_config.netmask = netmask.addr;
   }
-  macStart(&ETHD1, &mac_config);
-  netif_add(&thisif, &ip, &netmask, &gateway, NULL, ethernetif_init, tcpip_input);
-
-  netif_set_default(&thisif);
-  netif_set_up(&thisif);
+  default_if.config = &default_config;
+  ethernetif_register(&default_if);
+#else
+  (void)p;
+#endif
 
   /* Setup event sources.*/
   evtObjectInit(&evt, LWIP_LINK_POLL_INTERVAL);
   evtStart(&evt);
   chEvtRegisterMask(&evt.et_es, &el0, PERIODIC_TIMER_ID);
-  chEvtRegisterMask(macGetReceiveEventSource(&ETHD1), &el1, FRAME_RECEIVED_ID);
-  chEvtAddEvents(PERIODIC_TIMER_ID | FRAME_RECEIVED_ID);
+  chEvtAddEvents(PERIODIC_TIMER_ID);
 
   /* Resumes the caller and goes to the final priority.*/
   chThdResume(&lwip_trp, MSG_OK);
@@ -272,46 +681,42 @@ static THD_FUNCTION(lwip_thread, p) {
 
   while (true) {
     eventmask_t mask = chEvtWaitAny(ALL_EVENTS);
-    if (mask & PERIODIC_TIMER_ID) {
-      bool current_link_status = macPollLinkStatus(&ETHD1);
-      if (current_link_status != netif_is_link_up(&thisif)) {
-        if (current_link_status) {
-          tcpip_callback_with_block((tcpip_callback_fn) netif_set_link_up,
-                                     &thisif, 0);
-#if LWIP_DHCP
-          dhcp_start(&thisif);
-#endif
-        }
-        else {
-          tcpip_callback_with_block((tcpip_callback_fn) netif_set_link_down,
-                                     &thisif, 0);
-#if LWIP_DHCP
-          dhcp_stop(&thisif);
+    lwipif_t *ifp;
+
+#if LWIP_USE_ZERO_COPY
+    if (mask & TX_DONE_ID)
+      tx_reclaim();
 #endif
-        }
+    if (mask & INTERFACE_ADDED_ID) {
+      lwipif_t *next;
+
+      chSysLock();
+      ifp = pending;
+      pending = NULL;
+      chSysUnlock();
+      while (ifp != NULL) {
+        next = ifp->next;
+        ethernetif_register(ifp);
+        chThdResume(&ifp->trp, MSG_OK);
+        ifp = next;
       }
     }
-    if (mask & FRAME_RECEIVED_ID) {
-      struct pbuf *p;
-      while ((p = low_level_input(&thisif)) != NULL) {
-        struct eth_hdr *ethhdr = p->payload;
-        switch (htons(ethhdr->type)) {
-        /* IP or ARP packet? */
-        case ETHTYPE_IP:
-        case ETHTYPE_ARP:
-#if PPPOE_SUPPORT
-        /* PPPoE packet? */
-        case ETHTYPE_PPPOEDISC:
-        case ETHTYPE_PPPOE:
-#endif /* PPPOE_SUPPORT */
-          /* full packet send to tcpip_thread to process */
-          if (thisif.input(p, &thisif) == ERR_OK)
-            break;
-          LWIP_DEBUGF(NETIF_DEBUG, ("ethernetif_input: IP input error\n"));
-        default:
-          pbuf_free(p);
-        }
-      }
+    for (ifp = interfaces; ifp != NULL; ifp = ifp->next) {
+      bool link_event;
+
+      /* The flag is set from ISR context, it is tested and cleared
+         atomically so that an event arriving meanwhile is not lost.*/
+      chSysLock();
+      link_event = ifp->link_event;
+      ifp->link_event = false;
+      chSysUnlock();
+
+      /* Interfaces with link interrupt are checked only when signaled.*/
+      if (link_event ||
+          ((mask & PERIODIC_TIMER_ID) && !ifp->config->link_irq))
+        ethernetif_link(ifp);
+      if (mask & ifp->events)
+        ethernetif_input(ifp);
     }
   }
 }
@@ -321,13 +726,15 @@ static THD_FUNCTION(lwip_thread, p) {
  * @note    The function exits after the initialization is finished.
  *
  * @param[in] opts      pointer to the configuration structure, if @p NULL
- *                      then the static configuration is used.
+ *                      then the static configuration is used. It is not
+ *                      used if @p LWIP_DEFAULT_INTERFACE is @p FALSE.
  */
 void lwipInit(const lwipthread_opts_t *opts) {
 
   /* Creating the lwIP thread (it changes priority internally).*/
-  chThdCreateStatic(wa_lwip_thread, sizeof (wa_lwip_thread),
-                    chThdGetPriorityX() - 1, lwip_thread, (void *)opts);
+  lwip_tp = chThdCreateStatic(wa_lwip_thread, sizeof (wa_lwip_thread),
+                              chThdGetPriorityX() - 1, lwip_thread,
+                              (void *)opts);
 
   /* Waiting for the lwIP thread complete initialization. Note,
      this thread reaches the thread reference object first because
@@ -337,4 +744,57 @@ void lwipInit(const lwipthread_opts_t *opts) {
   chSysUnlock();
 }
 
+/**
+ * @brief   Adds an Ethernet interface.
+ * @details The MAC driver is started and the interface is brought up, the
+ *          first interface added becomes the default one.
+ * @pre     The lwIP subsystem must have been initialized.
+ * @note    The function exits after the interface has been registered.
+ *
+ * @param[out] ifp      pointer to the @p lwipif_t structure
+ * @param[in] config    pointer to the interface configuration, it must
+ *                      stay valid while the interface is in use
+ */
+void lwipAddInterface(lwipif_t *ifp, const lwipif_config_t *config) {
+  lwipif_t **ifpp;
+
+  chDbgCheck((ifp != NULL) && (config != NULL) && (config->macp != NULL));
+  chDbgAssert(lwip_tp != NULL, "not initialized");
+
+  ifp->config = config;
+  ifp->trp = NULL;
+
+  /* Appended so that the interfaces are registered in the same order they
+     are added.*/
+  ifp->next = NULL;
+  chSysLock();
+  ifpp = &pending;
+  while (*ifpp != NULL)
+    ifpp = &(*ifpp)->next;
+  *ifpp = ifp;
+  chEvtSignalI(lwip_tp, INTERFACE_ADDED_ID);
+  chThdSuspendS(&ifp->trp);
+  chSysUnlock();
+}
+
+/**
+ * @brief   Signals a link status change.
+ * @details This function is meant to be called from the PHY interrupt
+ *          handler, the link status is then updated by the lwIP thread.
+ *          Interfaces with the @p link_irq setting rely on this function
+ *          and are not polled.
+ *
+ * @param[in] ifp       pointer to the @p lwipif_t structure
+ *
+ * @iclass
+ */
+void lwipLinkChangedI(lwipif_t *ifp) {
+
+  chDbgCheckClassI();
+  chDbgCheck(ifp != NULL);
+
+  ifp->link_event = true;
+  chEvtSignalI(lwip_tp, LINK_CHANGED_ID);
+}
+
 /** @} */
@@ -25,6 +25,8 @@
 #define _LWIPTHREAD_H_
 
 #include <lwip/opt.h>
+#include <lwip/netif.h>
+#include <lwip/tcpip.h>
 
 /**
  * @brief   lwIP thread priority.
@@ -75,6 +77,70 @@
 #define LWIP_SEND_TIMEOUT                   50
 #endif
 
+/**
+ * @brief   Zero-copy receive mode.
+ * @details If enabled, received frames are passed to lwIP as custom pbufs
+ *          pointing into the MAC buffers, the MAC descriptor is released
+ *          when the pbuf is freed.
+ * @note    Requires @p MAC_USE_ZERO_COPY in halconf.h and
+ *          @p LWIP_SUPPORT_CUSTOM_PBUF in lwipopts.h, @p ETH_PAD_SIZE must
+ *          be zero.
+ */
+#if !defined(LWIP_USE_ZERO_COPY) || defined(__DOXYGEN__)
+#define LWIP_USE_ZERO_COPY                  FALSE
+#endif
+
+/**
+ * @brief   Number of frames that can be held by lwIP in zero-copy mode.
+ * @details When all of them are in use further frames are copied into
+ *          pool pbufs as usual.
+ * @note    It must be less than the number of MAC receive buffers or the
+ *          MAC could run out of buffers.
+ */
+#if !defined(LWIP_ZERO_COPY_FRAMES) || defined(__DOXYGEN__)
+#define LWIP_ZERO_COPY_FRAMES               2
+#endif
+
+/**
+ * @brief   Number of transmitted frames in flight in zero-copy mode.
+ * @details In zero-copy mode the pbufs of a transmitted frame are attached
+ *          to the MAC descriptors and referenced until the MAC is done with
+ *          them, when all the slots are in use, or when the pbufs cannot
+ *          be attached, the frame is copied as usual.
+ * @note    Completed frames are freed on the next transmission, up to this
+ *          number of frames can be held meanwhile.
+ * @note    The lwIP heap and pools must be reachable by the MAC DMA.
+ */
+#if !defined(LWIP_ZERO_COPY_TX_FRAMES) || defined(__DOXYGEN__)
+#define LWIP_ZERO_COPY_TX_FRAMES            4
+#endif
+
+/**
+ * @brief   Frames reception in the tcpip thread.
+ * @details If enabled, the lwIP thread does not touch received frames, on
+ *          each receive event it schedules a single callback in the tcpip
+ *          thread that drains all the pending frames and feeds them to
+ *          @p ethernet_input() directly. This saves a mailbox exchange and
+ *          a context switch per frame.
+ * @note    If the callback cannot be posted because the tcpip thread
+ *          mailbox is full then the pending frames are dropped and counted
+ *          in the interface statistics.
+ */
+#if !defined(LWIP_TCPIP_RX) || defined(__DOXYGEN__)
+#define LWIP_TCPIP_RX                       FALSE
+#endif
+
+/**
+ * @brief   Default interface.
+ * @details If enabled, @p lwipInit() registers an interface on @p ETHD1
+ *          using the @p lwipthread_opts_t settings or the static ones.
+ *          Disable it when all the interfaces are added explicitly using
+ *          @p lwipAddInterface().
+ */
+#if !defined(LWIP_DEFAULT_INTERFACE) || defined(__DOXYGEN__)
+#define LWIP_DEFAULT_INTERFACE              TRUE
+#endif
+
 /**
  * @brief   Link speed.
  */
@@ -148,10 +214,145 @@ typedef struct lwipthread_opts {
   uint32_t      gateway;
 } lwipthread_opts_t;
 
+/**
+ * @brief   Interface configuration.
+ */
+typedef struct {
+  /**
+   * @brief Pointer to the MAC driver.
+   */
+  MACDriver     *macp;
+  /**
+   * @brief MAC address, if @p NULL the static one is used.
+   */
+  const uint8_t *macaddress;
+  uint32_t      address;
+  uint32_t      netmask;
+  uint32_t      gateway;
+  /**
+   * @brief Link changes are signaled using @p lwipLinkChangedI().
+   * @details If @p false the link status is polled every
+   *          @p LWIP_LINK_POLL_INTERVAL.
+   */
+  bool          link_irq;
+  /**
+   * @brief Working area of the receive thread.
+   * @details If @p NULL the received frames are handled by the lwIP
+   *          thread together with the other interfaces.
+   */
+  void          *wsp;
+  /**
+   * @brief Size of the receive thread working area.
+   */
+  size_t        wssize;
+  /**
+   * @brief Priority of the receive thread.
+   */
+  tprio_t       prio;
+} lwipif_config_t;
+
+/**
+ * @brief   Interface counters.
+ */
+typedef struct {
+  /**
+   * @brief Frames transmitted.
+   */
+  uint32_t      txframes;
+  /**
+   * @brief Frames transmitted without copying the pbufs.
+   */
+  uint32_t      txattached;
+  /**
+   * @brief Frames not transmitted because a timeout.
+   */
+  uint32_t      txerrors;
+  /**
+   * @brief Frames received.
+   */
+  uint32_t      rxframes;
+  /**
+   * @brief Frames lost or rejected by the stack.
+   */
+  uint32_t      rxerrors;
+  /**
+   * @brief Frames dropped because the tcpip thread mailbox was full.
+   */
+  uint32_t      rxdropped;
+  /**
+   * @brief Link status changes.
+   */
+  uint32_t      linkchanges;
+} lwipif_stats_t;
+
+/**
+ * @brief   Ethernet interface.
+ */
+typedef struct lwipif {
+  /**
+   * @brief lwIP interface.
+   */
+  struct netif                  netif;
+  /**
+   * @brief Current configuration data.
+   */
+  const lwipif_config_t         *config;
+  /**
+   * @brief MAC driver configuration.
+   */
+  MACConfig                     mac_config;
+  /**
+   * @brief Interface counters.
+   */
+  lwipif_stats_t                stats;
+  /**
+   * @brief Next interface in the list.
+   */
+  struct lwipif                 *next;
+  /**
+   * @brief Receive events served by the lwIP thread.
+   */
+  eventmask_t                   events;
+  /**
+   * @brief Listener of the MAC receive event.
+   */
+  event_listener_t              el;
+  /**
+   * @brief Suspension point for the registration.
+   */
+  thread_reference_t            trp;
+  /**
+   * @brief Link change signaled.
+   * @note  Set from ISR context by @p lwipLinkChangedI(), read and cleared
+   *        by the lwIP thread under lock.
+   */
+  volatile bool                 link_event;
+#if LWIP_TCPIP_RX || defined(__DOXYGEN__)
+  /**
+   * @brief Receive callback message.
+   */
+  struct tcpip_callback_msg     *rx_msg;
+  /**
+   * @brief Receive callback already scheduled.
+   */
+  volatile bool                 rx_pending;
+#endif
+} lwipif_t;
+
+/**
+ * @brief   Returns the counters of an interface.
+ *
+ * @param[in] ifp       pointer to the @p lwipif_t structure
+ * @return              Pointer to the @p lwipif_stats_t structure.
+ */
+#define lwipGetInterfaceStats(ifp) (&(ifp)->stats)
+
 #ifdef __cplusplus
 extern "C" {
 #endif
   void lwipInit(const lwipthread_opts_t *opts);
+  void lwipAddInterface(lwipif_t *ifp, const lwipif_config_t *config);
+  void lwipLinkChangedI(lwipif_t *ifp);
 #ifdef __cplusplus
 }
 #endif
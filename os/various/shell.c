@@ -34,6 +34,68 @@
  */
 event_source_t shell_terminated;
 
+/**
+ * @brief   Shell line editing state.
+ * @note    When the workers are enabled the state is shared with the worker
+ *          threads executing the commands of the shell, their output is
+ *          written above the line being edited.
+ */
+typedef struct {
+  BaseSequentialStream  *chp;
+  const char            *prompt;
+  char                  *line;
+  unsigned              size;
+  unsigned              len;
+  unsigned              pos;
+  bool                  editing;
+#if SHELL_USE_HISTORY
+  char                  *histbuf;
+  unsigned              histsize;
+  unsigned              histused;
+  int                   histidx;
+#endif
+#if SHELL_USE_WORKERS
+  mutex_t               mtx;
+  bool                  exit;
+  unsigned              aheadn;
+  char                  ahead[SHELL_MAX_LINE_LENGTH];
+#endif
+} shell_state_t;
+
+#if SHELL_USE_WORKERS
+/**
+ * @brief   Shell worker.
+ * @details The worker implements the @p BaseChannel interface passed to
+ *          the commands. The output is written on the shell channel, the
+ *          input is owned by the shell thread so the commands only see
+ *          timeouts or, after CTRL-C, a channel reset.
+ */
+typedef struct {
+  const struct BaseChannelVMT *vmt;
+  thread_t              *thread;
+  semaphore_t           sem;
+  shell_state_t         *ssp;
+  shellcmd_t            fn;
+  char                  *name;
+  int                   argc;
+  char                  *argv[SHELL_MAX_ARGUMENTS + 1];
+  char                  line[SHELL_MAX_LINE_LENGTH];
+  bool                  background;
+  volatile bool         busy;
+  unsigned              outn;
+  char                  out[SHELL_OUTPUT_BUFFER_SIZE];
+} shell_worker_t;
+
+static shell_worker_t workers[SHELL_WORKERS];
+static THD_WORKING_AREA(workers_wa[SHELL_WORKERS], SHELL_WORKERS_STACK_SIZE);
+
+/**
+ * @brief   Protects the link between the workers and the shells, a shell
+ *          detaches the workers that did not terminate before exiting.
+ */
+static mutex_t workers_mtx;
+#endif
+
 static char *_strtok(char *str, const char *delim, char **saveptr) {
   char *token;
   if (str)
@@ -115,17 +177,649 @@ static ShellCommand local_commands[] = {
   {NULL, NULL}
 };
 
-static bool cmdexec(const ShellCommand *scp, BaseSequentialStream *chp,
-                      char *name, int argc, char *argv[]) {
+#if SHELL_USE_WORKERS
+#define state_lock(ssp)     chMtxLock(&(ssp)->mtx)
+#define state_unlock(ssp)   chMtxUnlock(&(ssp)->mtx)
+#else
+#define state_lock(ssp)     (void)(ssp)
+#define state_unlock(ssp)   (void)(ssp)
+#endif
 
-  while (scp->sc_name != NULL) {
-    if (strcmp(scp->sc_name, name) == 0) {
-      scp->sc_function(chp, argc, argv);
-      return false;
+static void state_init(shell_state_t *ssp, BaseSequentialStream *chp) {
+
+  ssp->chp     = chp;
+  ssp->prompt  = NULL;
+  ssp->editing = false;
+#if SHELL_USE_HISTORY
+  ssp->histbuf  = NULL;
+  ssp->histsize = 0;
+  ssp->histused = 0;
+#endif
+#if SHELL_USE_WORKERS
+  chMtxObjectInit(&ssp->mtx);
+  ssp->exit   = false;
+  ssp->aheadn = 0;
+#endif
+}
+
+static void put_backspaces(BaseSequentialStream *chp, unsigned n) {
+
+  while (n-- > 0)
+    streamPut(chp, 8);
+}
+
+/*
+ * Writes the line from the cursor position to the end, the cursor is
+ * moved back to its position, the extra characters erase the leftover of
+ * a longer line.
+ */
+static void put_tail(shell_state_t *ssp, unsigned extra) {
+  unsigned i;
+
+  streamWrite(ssp->chp, (const uint8_t *)&ssp->line[ssp->pos],
+              ssp->len - ssp->pos);
+  for (i = 0; i < extra; i++)
+    streamPut(ssp->chp, 0x20);
+  put_backspaces(ssp->chp, ssp->len - ssp->pos + extra);
+}
+
+#if SHELL_USE_HISTORY || SHELL_USE_WORKERS
+/*
+ * Writes again the prompt and the whole line.
+ */
+static void redraw(shell_state_t *ssp) {
+
+  streamPut(ssp->chp, '\r');
+  if (ssp->prompt != NULL)
+    chprintf(ssp->chp, "%s", ssp->prompt);
+  streamWrite(ssp->chp, (const uint8_t *)ssp->line, ssp->len);
+  chprintf(ssp->chp, "\033[K");
+  put_backspaces(ssp->chp, ssp->len - ssp->pos);
+}
+#endif
+
+#if SHELL_USE_HISTORY
+/*
+ * Returns a line from the history, zero is the most recent one.
+ */
+static const char *hist_get(shell_state_t *ssp, int idx) {
+  const char *p = ssp->histbuf + ssp->histused;
+
+  while (idx-- >= 0) {
+    if (p == ssp->histbuf)
+      return NULL;
+    p--;
+    while ((p > ssp->histbuf) && (*(p - 1) != '\0'))
+      p--;
+  }
+  return p;
+}
+
+/*
+ * Appends a line to the history, the oldest lines are dropped if there
+ * is not enough space.
+ */
+static void hist_add(shell_state_t *ssp) {
+  const char *last;
+  unsigned n;
+
+  if ((ssp->histbuf == NULL) || (ssp->len == 0) ||
+      (ssp->len + 1 > ssp->histsize))
+    return;
+  last = hist_get(ssp, 0);
+  if ((last != NULL) && (strcmp(last, ssp->line) == 0))
+    return;
+
+  while (ssp->histused + ssp->len + 1 > ssp->histsize) {
+    n = strlen(ssp->histbuf) + 1;
+    memmove(ssp->histbuf, ssp->histbuf + n, ssp->histused - n);
+    ssp->histused -= n;
+  }
+  memcpy(ssp->histbuf + ssp->histused, ssp->line, ssp->len + 1);
+  ssp->histused += ssp->len + 1;
+}
+
+/*
+ * Replaces the line with a line from the history, -1 is an empty line.
+ */
+static void hist_recall(shell_state_t *ssp, int idx) {
+  const char *s = "";
+
+  if (idx >= 0) {
+    s = hist_get(ssp, idx);
+    if (s == NULL)
+      return;
+  }
+  ssp->histidx = idx;
+  ssp->len = strlen(s);
+  if (ssp->len > ssp->size - 1)
+    ssp->len = ssp->size - 1;
+  memcpy(ssp->line, s, ssp->len);
+  ssp->pos = ssp->len;
+  redraw(ssp);
+}
+#endif /* SHELL_USE_HISTORY */
+
+#if SHELL_USE_ESC_SEQ
+static void cursor_home(shell_state_t *ssp) {
+
+  put_backspaces(ssp->chp, ssp->pos);
+  ssp->pos = 0;
+}
+
+static void cursor_end(shell_state_t *ssp) {
+
+  streamWrite(ssp->chp, (const uint8_t *)&ssp->line[ssp->pos],
+              ssp->len - ssp->pos);
+  ssp->pos = ssp->len;
+}
+
+static void delete_char(shell_state_t *ssp) {
+
+  if (ssp->pos < ssp->len) {
+    memmove(&ssp->line[ssp->pos], &ssp->line[ssp->pos + 1],
+            ssp->len - ssp->pos - 1);
+    ssp->len--;
+    put_tail(ssp, 1);
+  }
+}
+#endif /* SHELL_USE_ESC_SEQ */
+
+#if SHELL_USE_ESC_SEQ || SHELL_USE_HISTORY
+/*
+ * Decodes the VT100 escape sequences, returns the new sequence state.
+ */
+static int escape_seq(shell_state_t *ssp, int esc, char c) {
+
+  if (esc == 1)
+    return (c == '[') || (c == 'O') ? 2 : 0;
+#if SHELL_USE_ESC_SEQ
+  if (esc == 3) {
+    if (c == '~')
+      delete_char(ssp);
+    return 0;
+  }
+#endif
+  switch (c) {
+#if SHELL_USE_HISTORY
+  case 'A':
+    hist_recall(ssp, ssp->histidx + 1);
+    break;
+  case 'B':
+    if (ssp->histidx >= 0)
+      hist_recall(ssp, ssp->histidx - 1);
+    break;
+#endif
+#if SHELL_USE_ESC_SEQ
+  case 'C':
+    if (ssp->pos < ssp->len)
+      streamPut(ssp->chp, ssp->line[ssp->pos++]);
+    break;
+  case 'D':
+    if (ssp->pos > 0) {
+      streamPut(ssp->chp, 8);
+      ssp->pos--;
     }
+    break;
+  case 'H':
+    cursor_home(ssp);
+    break;
+  case 'F':
+    cursor_end(ssp);
+    break;
+  case '3':
+    return 3;
+#endif
+  default:
+    break;
+  }
+  return 0;
+}
+#endif /* SHELL_USE_ESC_SEQ || SHELL_USE_HISTORY */
+
+/*
+ * Reads a character, the characters typed while a foreground command was
+ * running are returned first.
+ */
+static bool get_char(shell_state_t *ssp, char *cp) {
+
+#if SHELL_USE_WORKERS
+  if (ssp->aheadn > 0) {
+    *cp = ssp->ahead[0];
+    ssp->aheadn--;
+    memmove(&ssp->ahead[0], &ssp->ahead[1], ssp->aheadn);
+    return true;
+  }
+#endif
+  return streamRead(ssp->chp, (uint8_t *)cp, 1) != 0;
+}
+
+/*
+ * Reads and edits a line, the prompt is written under the state lock so
+ * the output of the background commands cannot be mixed with it.
+ */
+static bool get_line(shell_state_t *ssp, const char *prompt,
+                     char *line, unsigned size) {
+  BaseSequentialStream *chp = ssp->chp;
+  bool reset = false;
+  int esc = 0;
+  char c;
+
+  state_lock(ssp);
+  ssp->prompt  = prompt;
+  ssp->line    = line;
+  ssp->size    = size;
+  ssp->len     = 0;
+  ssp->pos     = 0;
+  ssp->editing = true;
+#if SHELL_USE_HISTORY
+  ssp->histidx = -1;
+#endif
+  if (prompt != NULL)
+    chprintf(chp, "%s", prompt);
+  state_unlock(ssp);
+
+  while (true) {
+    if (!get_char(ssp, &c)) {
+      state_lock(ssp);
+      reset = true;
+      break;
+    }
+    state_lock(ssp);
+#if SHELL_USE_ESC_SEQ || SHELL_USE_HISTORY
+    if (esc > 0) {
+      esc = escape_seq(ssp, esc, c);
+      state_unlock(ssp);
+      continue;
+    }
+    if (c == 27) {
+      esc = 1;
+      state_unlock(ssp);
+      continue;
+    }
+#else
+    (void)esc;
+#endif
+#if SHELL_USE_ESC_SEQ
+    if (c == 1) {
+      cursor_home(ssp);
+      state_unlock(ssp);
+      continue;
+    }
+    if (c == 5) {
+      cursor_end(ssp);
+      state_unlock(ssp);
+      continue;
+    }
+#endif
+    if (c == 4) {
+      chprintf(chp, "^D");
+      reset = true;
+      break;
+    }
+    if (c == 3) {
+      /* CTRL-C discards the line.*/
+      chprintf(chp, "^C\r\n");
+      ssp->len = 0;
+      break;
+    }
+    if ((c == 8) || (c == 127)) {
+      if (ssp->pos == ssp->len) {
+        if (ssp->pos > 0) {
+          streamPut(chp, c);
+          streamPut(chp, 0x20);
+          streamPut(chp, c);
+          ssp->pos--;
+          ssp->len--;
+        }
+      }
+      else if (ssp->pos > 0) {
+        streamPut(chp, 8);
+        ssp->pos--;
+        memmove(&line[ssp->pos], &line[ssp->pos + 1], ssp->len - ssp->pos - 1);
+        ssp->len--;
+        put_tail(ssp, 1);
+      }
+      state_unlock(ssp);
+      continue;
+    }
+    if (c == '\r') {
+      chprintf(chp, "\r\n");
+      break;
+    }
+    if ((c >= 0x20) && (ssp->len < size - 1)) {
+      memmove(&line[ssp->pos + 1], &line[ssp->pos], ssp->len - ssp->pos);
+      line[ssp->pos++] = c;
+      ssp->len++;
+      streamPut(chp, c);
+      if (ssp->pos < ssp->len)
+        put_tail(ssp, 0);
+    }
+    state_unlock(ssp);
+  }
+
+  /* The state is locked here.*/
+  line[ssp->len] = '\0';
+  ssp->editing = false;
+#if SHELL_USE_HISTORY
+  if (!reset)
+    hist_add(ssp);
+#endif
+  state_unlock(ssp);
+  return reset;
+}
+
+#if SHELL_USE_WORKERS
+/*
+ * Locks the state of the shell owning a worker, returns NULL if the worker
+ * has been detached from its shell.
+ */
+static shell_state_t *worker_lock(shell_worker_t *wp) {
+
+  chMtxLock(&workers_mtx);
+  if (wp->ssp == NULL) {
+    chMtxUnlock(&workers_mtx);
+    return NULL;
+  }
+  state_lock(wp->ssp);
+  return wp->ssp;
+}
+
+static void worker_unlock(shell_state_t *ssp) {
+
+  state_unlock(ssp);
+  chMtxUnlock(&workers_mtx);
+}
+
+/*
+ * Writes the buffered output of a background command above the line being
+ * edited.
+ */
+static void worker_flush(shell_worker_t *wp) {
+  shell_state_t *ssp;
+
+  if (wp->outn == 0)
+    return;
+  ssp = worker_lock(wp);
+  if (ssp == NULL) {
+    wp->outn = 0;
+    return;
+  }
+  if (ssp->editing)
+    chprintf(ssp->chp, "\r\033[K");
+  streamWrite(ssp->chp, (const uint8_t *)wp->out, wp->outn);
+  if (ssp->editing) {
+    if (wp->out[wp->outn - 1] != '\n')
+      chprintf(ssp->chp, "\r\n");
+    redraw(ssp);
+  }
+  wp->outn = 0;
+  worker_unlock(ssp);
+}
+
+static size_t worker_write(void *ip, const uint8_t *bp, size_t n) {
+  shell_worker_t *wp = ip;
+  shell_state_t *ssp;
+  size_t i;
+
+  /* Foreground commands own the console.*/
+  if (!wp->background) {
+    ssp = worker_lock(wp);
+    if (ssp != NULL) {
+      n = streamWrite(ssp->chp, bp, n);
+      worker_unlock(ssp);
+    }
+    return n;
+  }
+
+  /* Background commands output is written by lines.*/
+  for (i = 0; i < n; i++) {
+    wp->out[wp->outn++] = (char)bp[i];
+    if ((bp[i] == '\n') || (wp->outn >= SHELL_OUTPUT_BUFFER_SIZE))
+      worker_flush(wp);
+  }
+  return n;
+}
+
+/*
+ * No input is ever available to the commands, the wait ends with a reset
+ * when the termination of the command is requested.
+ */
+static msg_t worker_gett(void *ip, systime_t time) {
+  systime_t interval;
+
+  (void)ip;
+
+  while (!chThdShouldTerminateX()) {
+    if (time == TIME_IMMEDIATE)
+      return Q_TIMEOUT;
+    interval = SHELL_POLL_INTERVAL;
+    if ((time != TIME_INFINITE) && (time < interval))
+      interval = time;
+    chThdSleep(interval);
+    if (time != TIME_INFINITE)
+      time -= interval;
+  }
+  return Q_RESET;
+}
+
+static msg_t worker_get(void *ip) {
+
+  return worker_gett(ip, TIME_INFINITE);
+}
+
+static size_t worker_readt(void *ip, uint8_t *bp, size_t n, systime_t time) {
+
+  (void)bp;
+  (void)n;
+
+  (void)worker_gett(ip, time);
+  return 0;
+}
+
+static size_t worker_read(void *ip, uint8_t *bp, size_t n) {
+
+  return worker_readt(ip, bp, n, TIME_INFINITE);
+}
+
+static msg_t worker_put(void *ip, uint8_t b) {
+
+  (void)worker_write(ip, &b, 1);
+  return MSG_OK;
+}
+
+static msg_t worker_putt(void *ip, uint8_t b, systime_t time) {
+
+  (void)time;
+
+  return worker_put(ip, b);
+}
+
+static size_t worker_writet(void *ip, const uint8_t *bp, size_t n,
+                            systime_t time) {
+
+  (void)time;
+
+  return worker_write(ip, bp, n);
+}
+
+static const struct BaseChannelVMT worker_vmt = {
+  worker_write, worker_read, worker_put, worker_get,
+  worker_putt, worker_gett, worker_writet, worker_readt
+};
+
+/**
+ * @brief   Worker thread function.
+ *
+ * @param[in] p         pointer to a @p shell_worker_t object
+ */
+static THD_FUNCTION(shell_worker, p) {
+  shell_worker_t *wp = p;
+
+  chRegSetThreadName("shell worker");
+  while (true) {
+    (void)chSemWait(&wp->sem);
+    wp->fn((BaseSequentialStream *)wp, wp->argc, wp->argv);
+    if (wp->background)
+      chprintf((BaseSequentialStream *)wp, "[%d] Done %s\r\n",
+               (int)(wp - workers) + 1, wp->name);
+    worker_flush(wp);
+
+    chSysLock();
+    wp->busy = false;
+    chSysUnlock();
+  }
+}
+
+/*
+ * Requests the termination of the command executed by a worker, an idle
+ * worker is left alone.
+ */
+static void worker_terminate(shell_worker_t *wp) {
+
+  chSysLock();
+  if (wp->busy)
+    chThdTerminateI(wp->thread);
+  chSysUnlock();
+}
+
+/*
+ * Starts a command on a free worker, the line is copied in the worker.
+ */
+static shell_worker_t *dispatch(shell_state_t *ssp, shellcmd_t fn,
+                                char *name, int argc, char *argv[],
+                                bool background) {
+  shell_worker_t *wp;
+  int i;
+
+  /* The termination requests are only sent to busy workers, a request
+     that arrived after the end of the previous command is cleared here
+     under the same lock.*/
+  chSysLock();
+  for (wp = &workers[0]; wp < &workers[SHELL_WORKERS]; wp++) {
+    if (!wp->busy) {
+      chThdClearTerminateI(wp->thread);
+      wp->busy = true;
+      break;
+    }
+  }
+  chSysUnlock();
+  if (wp == &workers[SHELL_WORKERS])
+    return NULL;
+
+  memcpy(wp->line, ssp->line, SHELL_MAX_LINE_LENGTH);
+  wp->name = wp->line + (name - ssp->line);
+  for (i = 0; i < argc; i++)
+    wp->argv[i] = wp->line + (argv[i] - ssp->line);
+  wp->argv[argc] = NULL;
+  wp->argc       = argc;
+  wp->fn         = fn;
+  wp->ssp        = ssp;
+  wp->background = background;
+  wp->outn       = 0;
+  chSemSignal(&wp->sem);
+  return wp;
+}
+
+/*
+ * Waits for a foreground command, CTRL-C requests its termination. The
+ * other characters are kept for the next line. On channel reset the
+ * function returns immediately, the command is stopped on logout.
+ */
+static bool wait_command(shell_state_t *ssp, shell_worker_t *wp) {
+  msg_t c;
+
+  while (wp->busy) {
+    c = chnGetTimeout((BaseChannel *)ssp->chp, SHELL_POLL_INTERVAL);
+    if (c == 3) {
+      state_lock(ssp);
+      chprintf(ssp->chp, "^C\r\n");
+      state_unlock(ssp);
+      worker_terminate(wp);
+    }
+    else if (c == Q_RESET)
+      return true;
+    else if ((c >= 0) && (ssp->aheadn < sizeof ssp->ahead))
+      ssp->ahead[ssp->aheadn++] = (char)c;
+  }
+  return false;
+}
+
+/*
+ * Terminates the commands started by a shell and waits for them. The
+ * commands still running after @p SHELL_STOP_TIMEOUT are reported and
+ * detached from the shell, their output is discarded.
+ */
+static void stop_commands(shell_state_t *ssp) {
+  systime_t start = chVTGetSystemTimeX();
+  bool busy = true;
+  unsigned i;
+
+  while (busy) {
+    busy = false;
+    for (i = 0; i < SHELL_WORKERS; i++) {
+      if (workers[i].busy && (workers[i].ssp == ssp)) {
+        worker_terminate(&workers[i]);
+        busy = true;
+      }
+    }
+    if (!busy ||
+        !chVTIsSystemTimeWithinX(start, start + SHELL_STOP_TIMEOUT))
+      break;
+    chThdSleep(SHELL_POLL_INTERVAL);
+  }
+
+  for (i = 0; i < SHELL_WORKERS; i++) {
+    if (workers[i].busy && (workers[i].ssp == ssp)) {
+      chprintf(ssp->chp, "\r\n[%d] %s not terminated", i + 1,
+               workers[i].name);
+      chMtxLock(&workers_mtx);
+      workers[i].ssp = NULL;
+      chMtxUnlock(&workers_mtx);
+    }
+  }
+}
+
+static void cmd_jobs(shell_state_t *ssp, int argc, char *argv[]) {
+  unsigned i;
+
+  (void)argv;
+  if (argc > 0) {
+    usage(ssp->chp, "jobs");
+    return;
+  }
+  for (i = 0; i < SHELL_WORKERS; i++) {
+    if (workers[i].busy && (workers[i].ssp == ssp))
+      chprintf(ssp->chp, "[%d] %s%s\r\n", i + 1, workers[i].name,
+               workers[i].background ? " &" : "");
+  }
+}
+
+static void cmd_kill(shell_state_t *ssp, int argc, char *argv[]) {
+  unsigned i;
+
+  if ((argc != 1) || (argv[0][0] < '1') || (argv[0][0] > '9') ||
+      (argv[0][1] != '\0')) {
+    usage(ssp->chp, "kill <job>");
+    return;
+  }
+  i = (unsigned)(argv[0][0] - '1');
+  if ((i >= SHELL_WORKERS) || !workers[i].busy || (workers[i].ssp != ssp)) {
+    chprintf(ssp->chp, "no such job\r\n");
+    return;
+  }
+  worker_terminate(&workers[i]);
+}
+#endif /* SHELL_USE_WORKERS */
+
+static shellcmd_t find_command(const ShellCommand *scp, char *name) {
+
+  while (scp->sc_name != NULL) {
+    if (strcmp(scp->sc_name, name) == 0)
+      return scp->sc_function;
     scp++;
   }
-  return true;
+  return NULL;
 }
 
 /**
@@ -139,15 +833,36 @@ static THD_FUNCTION(shell_thread, p) {
   const ShellCommand *scp = ((ShellConfig *)p)->sc_commands;
   char *lp, *cmd, *tokp, line[SHELL_MAX_LINE_LENGTH];
   char *args[SHELL_MAX_ARGUMENTS + 1];
+  shell_state_t state;
+  shellcmd_t fn;
+#if SHELL_USE_WORKERS
+  shell_worker_t *wp;
+  bool background;
+#endif
 
   chRegSetThreadName("shell");
+  state_init(&state, chp);
+#if SHELL_USE_HISTORY
+  state.histbuf  = ((ShellConfig *)p)->sc_histbuf;
+  state.histsize = ((ShellConfig *)p)->sc_histsize;
+#endif
   chprintf(chp, "\r\nChibiOS/RT Shell\r\n");
   while (true) {
-    chprintf(chp, "ch> ");
-    if (shellGetLine(chp, line, sizeof(line))) {
+    if (get_line(&state, "ch> ", line, sizeof(line))) {
       chprintf(chp, "\r\nlogout");
       break;
     }
+#if SHELL_USE_WORKERS
+    /* A trailing & starts the command in background.*/
+    background = false;
+    n = (int)strlen(line);
+    while ((n > 0) && ((line[n - 1] == ' ') || (line[n - 1] == '\t')))
+      n--;
+    if ((n > 0) && (line[n - 1] == '&')) {
+      line[n - 1] = '\0';
+      background = true;
+    }
+#endif
     lp = _strtok(line, " \t", &tokp);
     cmd = lp;
     n = 0;
@@ -174,41 +889,102 @@ static THD_FUNCTION(shell_thread, p) {
           continue;
         }
         chprintf(chp, "Commands: help exit ");
+#if SHELL_USE_WORKERS
+        chprintf(chp, "jobs kill ");
+#endif
         list_commands(chp, local_commands);
         if (scp != NULL)
           list_commands(chp, scp);
         chprintf(chp, "\r\n");
       }
-      else if (cmdexec(local_commands, chp, cmd, n, args) &&
-          ((scp == NULL) || cmdexec(scp, chp, cmd, n, args))) {
+#if SHELL_USE_WORKERS
+      else if (strcmp(cmd, "jobs") == 0)
+        cmd_jobs(&state, n, args);
+      else if (strcmp(cmd, "kill") == 0)
+        cmd_kill(&state, n, args);
+#endif
+      else if (((fn = find_command(local_commands, cmd)) == NULL) &&
+               ((scp == NULL) || ((fn = find_command(scp, cmd)) == NULL))) {
         chprintf(chp, "%s", cmd);
         chprintf(chp, " ?\r\n");
       }
+      else {
+#if SHELL_USE_WORKERS
+        wp = dispatch(&state, fn, cmd, n, args, background);
+        if (wp == NULL)
+          chprintf(chp, "no free workers\r\n");
+        else if (background)
+          chprintf(chp, "[%d] %s\r\n", (int)(wp - workers) + 1, cmd);
+        else if (wait_command(&state, wp)) {
+          chprintf(chp, "\r\nlogout");
+          break;
+        }
+#else
+        fn(chp, n, args);
+#endif
+      }
     }
+#if SHELL_USE_WORKERS
+    if (state.exit)
+      break;
+#endif
   }
+#if SHELL_USE_WORKERS
+  stop_commands(&state);
+#endif
   shellExit(MSG_OK);
 }
 
 /**
  * @brief   Shell manager initialization.
+ * @note    If the workers are enabled the worker threads are created here.
  *
  * @api
  */
 void shellInit(void) {
+#if SHELL_USE_WORKERS
+  unsigned i;
+#endif
 
   chEvtObjectInit(&shell_terminated);
+#if SHELL_USE_WORKERS
+  chMtxObjectInit(&workers_mtx);
+  for (i = 0; i < SHELL_WORKERS; i++) {
+    workers[i].vmt  = &worker_vmt;
+    workers[i].busy = false;
+    chSemObjectInit(&workers[i].sem, 0);
+    workers[i].thread = chThdCreateStatic(workers_wa[i], sizeof workers_wa[i],
+                                          SHELL_WORKERS_PRIORITY,
+                                          shell_worker, &workers[i]);
+  }
+#endif
 }
 
 /**
  * @brief   Terminates the shell.
  * @note    Must be invoked from the command handlers.
- * @note    Does not return.
+ * @note    Does not return, except when invoked by a command executed by a
+ *          worker, in that case the shell terminates after the command
+ *          returns.
  *
  * @param[in] msg       shell exit code
  *
  * @api
  */
 void shellExit(msg_t msg) {
+#if SHELL_USE_WORKERS
+  unsigned i;
+
+  for (i = 0; i < SHELL_WORKERS; i++) {
+    if (workers[i].thread == chThdGetSelfX()) {
+      chMtxLock(&workers_mtx);
+      if (workers[i].ssp != NULL)
+        workers[i].ssp->exit = true;
+      chMtxUnlock(&workers_mtx);
+      return;
+    }
+  }
+#endif
 
   /* Atomically broadcasting the event source and terminating the thread,
      there is not a chSysUnlock() because the thread terminates upon return.*/
@@ -255,6 +1031,8 @@ thread_t *shellCreateStatic(const ShellConfig *scp, void *wsp,
 
 /**
  * @brief   Reads a whole line from the input channel.
+ * @note    The line can be edited if @p SHELL_USE_ESC_SEQ is enabled,
+ *          CTRL-C discards the line.
  *
  * @param[in] chp       pointer to a @p BaseSequentialStream object
  * @param[in] line      pointer to the line buffer
@@ -266,38 +1044,10 @@ thread_t *shellCreateStatic(const ShellConfig *scp, void *wsp,
  * @api
  */
 bool shellGetLine(BaseSequentialStream *chp, char *line, unsigned size) {
-  char *p = line;
+  shell_state_t state;
 
-  while (true) {
-    char c;
-
-    if (chSequentialStreamRead(chp, (uint8_t *)&c, 1) == 0)
-      return true;
-    if (c == 4) {
-      chprintf(chp, "^D");
-      return true;
-    }
-    if ((c == 8) || (c == 127)) {
-      if (p != line) {
-        chSequentialStreamPut(chp, c);
-        chSequentialStreamPut(chp, 0x20);
-        chSequentialStreamPut(chp, c);
-        p--;
-      }
-      continue;
-    }
-    if (c == '\r') {
-      chprintf(chp, "\r\n");
-      *p = 0;
-      return false;
-    }
-    if (c < 0x20)
-      continue;
-    if (p < line + size - 1) {
-      chSequentialStreamPut(chp, c);
-      *p++ = (char)c;
-    }
-  }
+  state_init(&state, chp);
+  return get_line(&state, NULL, line, size);
 }
 
 /** @} */
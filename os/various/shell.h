@@ -39,6 +39,89 @@
 #define SHELL_MAX_ARGUMENTS         4
 #endif
 
+/**
+ * @brief   Command history enable switch.
+ * @details The history buffer is specified in the shell configuration, the
+ *          up and down arrow keys recall the previous lines.
+ */
+#if !defined(SHELL_USE_HISTORY) || defined(__DOXYGEN__)
+#define SHELL_USE_HISTORY           FALSE
+#endif
+
+/**
+ * @brief   Line editing enable switch.
+ * @details The left and right arrow, home, end and delete keys are decoded,
+ *          CTRL-A and CTRL-E move the cursor at the begin and at the end of
+ *          the line.
+ */
+#if !defined(SHELL_USE_ESC_SEQ) || defined(__DOXYGEN__)
+#define SHELL_USE_ESC_SEQ           FALSE
+#endif
+
+/**
+ * @brief   Worker threads enable switch.
+ * @details The commands are executed by a pool of worker threads shared by
+ *          all the shells, a command followed by @p & is executed in
+ *          background. CTRL-C requests the termination of the foreground
+ *          command, long running commands should check
+ *          @p chThdShouldTerminateX(). The commands receive a
+ *          @p BaseChannel, reading from it times out or returns
+ *          @p Q_RESET after CTRL-C because the input is owned by the
+ *          shell.
+ * @note    The shell channel must implement the @p BaseChannel interface.
+ */
+#if !defined(SHELL_USE_WORKERS) || defined(__DOXYGEN__)
+#define SHELL_USE_WORKERS           FALSE
+#endif
+
+/**
+ * @brief   Number of worker threads.
+ */
+#if !defined(SHELL_WORKERS) || defined(__DOXYGEN__)
+#define SHELL_WORKERS               2
+#endif
+
+/**
+ * @brief   Stack size of the worker threads.
+ */
+#if !defined(SHELL_WORKERS_STACK_SIZE) || defined(__DOXYGEN__)
+#define SHELL_WORKERS_STACK_SIZE    1024
+#endif
+
+/**
+ * @brief   Priority of the worker threads.
+ */
+#if !defined(SHELL_WORKERS_PRIORITY) || defined(__DOXYGEN__)
+#define SHELL_WORKERS_PRIORITY      NORMALPRIO
+#endif
+
+/**
+ * @brief   Input polling interval while a foreground command is running.
+ */
+#if !defined(SHELL_POLL_INTERVAL) || defined(__DOXYGEN__)
+#define SHELL_POLL_INTERVAL         MS2ST(20)
+#endif
+
+/**
+ * @brief   Time allowed to the running commands to terminate on logout.
+ * @details The commands still running after this time are reported and
+ *          detached from the shell, their further output is discarded.
+ */
+#if !defined(SHELL_STOP_TIMEOUT) || defined(__DOXYGEN__)
+#define SHELL_STOP_TIMEOUT          MS2ST(1000)
+#endif
+
+/**
+ * @brief   Output line buffer of the background commands.
+ */
+#if !defined(SHELL_OUTPUT_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define SHELL_OUTPUT_BUFFER_SIZE    80
+#endif
+
+#if SHELL_USE_WORKERS && ((SHELL_WORKERS < 1) || (SHELL_WORKERS > 9))
+#error "SHELL_WORKERS must be between 1 and 9"
+#endif
+
 /**
  * @brief   Command handler function type.
  */
@@ -60,6 +143,12 @@ typedef struct {
                                                  to the shell.              */
   const ShellCommand    *sc_commands;       /**< @brief Shell extra commands
                                                  table.                     */
+#if SHELL_USE_HISTORY || defined(__DOXYGEN__)
+  char                  *sc_histbuf;        /**< @brief History buffer or
+                                                 @p NULL.                   */
+  unsigned              sc_histsize;        /**< @brief History buffer
+                                                 size.                      */
+#endif
 } ShellConfig;
 
 #if !defined(__DOXYGEN__)
@@ -0,0 +1,368 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+/**
+ * @file    shell_cmd.c
+ * @brief   Shell built-in commands code.
+ *
+ * @addtogroup SHELL_CMD
+ * @{
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "shell.h"
+#include "shell_cmd.h"
+#include "chprintf.h"
+
+#if SHELL_CMD_BENCH_ENABLED
+#include "test.h"
+#include "testbmk.h"
+#endif
+
+/**
+ * @brief   Table of the enabled built-in commands.
+ * @note    It can be used directly as the @p sc_commands field of a shell
+ *          configuration, see @p SHELL_CMD_ENTRIES in order to mix them
+ *          with application commands.
+ */
+const ShellCommand shell_cmd_commands[] = {
+  SHELL_CMD_ENTRIES
+  {NULL, NULL}
+};
+
+static void usage(BaseSequentialStream *chp, char *p) {
+
+  chprintf(chp, "Usage: %s\r\n", p);
+}
+
+#if SHELL_CMD_MEM_ENABLED || defined(__DOXYGEN__)
+#if CH_CFG_USE_MEMPOOLS || defined(__DOXYGEN__)
+static shell_cmd_pool_t *pools;
+
+static size_t pool_free_objects(memory_pool_t *mp) {
+  struct pool_header *php;
+  size_t n = 0;
+
+  chSysLock();
+  php = mp->mp_next;
+  while (php != NULL) {
+    n++;
+    php = php->ph_next;
+  }
+  chSysUnlock();
+
+  return n;
+}
+
+/**
+ * @brief   Registers a memory pool.
+ * @details The pool is reported by the @p mem command.
+ *
+ * @param[out] spp      pointer to a @p shell_cmd_pool_t structure
+ * @param[in] name      name of the pool
+ * @param[in] mp        pointer to the @p memory_pool_t object
+ *
+ * @api
+ */
+void shellCmdRegisterPool(shell_cmd_pool_t *spp, const char *name,
+                          memory_pool_t *mp) {
+
+  chDbgCheck((spp != NULL) && (mp != NULL));
+
+  spp->name = name;
+  spp->mp   = mp;
+  chSysLock();
+  spp->next = pools;
+  pools     = spp;
+  chSysUnlock();
+}
+#endif /* CH_CFG_USE_MEMPOOLS */
+
+/**
+ * @brief   The @p mem command.
+ * @details Reports the free core memory, the free heap memory with its
+ *          fragmentation and the free objects in the registered pools.
+ *
+ * @param[in] chp       pointer to a @p BaseSequentialStream object
+ * @param[in] argc      number of arguments
+ * @param[in] argv      arguments
+ *
+ * @api
+ */
+void shellCmdMem(BaseSequentialStream *chp, int argc, char *argv[]) {
+#if CH_CFG_USE_HEAP
+  size_t n, size, largest;
+#endif
+#if CH_CFG_USE_MEMPOOLS
+  shell_cmd_pool_t *spp;
+#endif
+
+  (void)argv;
+  if (argc > 0) {
+    usage(chp, "mem");
+    return;
+  }
+
+  chprintf(chp, "core free memory : %u bytes\r\n", chCoreGetStatusX());
+#if CH_CFG_USE_HEAP
+  n = chHeapStatus(NULL, &size, &largest);
+  chprintf(chp, "heap fragments   : %u\r\n", n);
+  chprintf(chp, "heap free total  : %u bytes\r\n", size);
+  chprintf(chp, "heap free largest: %u bytes\r\n", largest);
+#endif
+#if CH_CFG_USE_MEMPOOLS
+  for (spp = pools; spp != NULL; spp = spp->next)
+    chprintf(chp, "pool %-12s: %u free objects of %u bytes\r\n",
+             spp->name, pool_free_objects(spp->mp), spp->mp->mp_object_size);
+#endif
+}
+#endif /* SHELL_CMD_MEM_ENABLED */
+
+#if SHELL_CMD_THREADS_ENABLED || defined(__DOXYGEN__)
+/**
+ * @brief   The @p threads command.
+ *
+ * @param[in] chp       pointer to a @p BaseSequentialStream object
+ * @param[in] argc      number of arguments
+ * @param[in] argv      arguments
+ *
+ * @api
+ */
+void shellCmdThreads(BaseSequentialStream *chp, int argc, char *argv[]) {
+  static const char *states[] = {CH_STATE_NAMES};
+  thread_t *tp;
+
+  (void)argv;
+  if (argc > 0) {
+    usage(chp, "threads");
+    return;
+  }
+
+  chprintf(chp, "    addr prio ");
+#if CH_CFG_USE_DYNAMIC
+  chprintf(chp, "refs ");
+#endif
+  chprintf(chp, "    state ");
+#if CH_DBG_THREADS_PROFILING
+  chprintf(chp, "      time ");
+#endif
+  chprintf(chp, "name\r\n");
+  tp = chRegFirstThread();
+  do {
+    chprintf(chp, "%08lx %4lu ", (uint32_t)tp, (uint32_t)tp->p_prio);
+#if CH_CFG_USE_DYNAMIC
+    chprintf(chp, "%4lu ", (uint32_t)(tp->p_refs - 1));
+#endif
+    chprintf(chp, "%9s ", states[tp->p_state]);
+#if CH_DBG_THREADS_PROFILING
+    chprintf(chp, "%10lu ", (uint32_t)tp->p_time);
+#endif
+    chprintf(chp, "%s\r\n", tp->p_name != NULL ? tp->p_name : "");
+    tp = chRegNextThread(tp);
+  } while (tp != NULL);
+}
+#endif /* SHELL_CMD_THREADS_ENABLED */
+
+#if SHELL_CMD_TIMERS_ENABLED || defined(__DOXYGEN__)
+/**
+ * @brief   The @p timers command.
+ * @details Lists the armed virtual timers in expiration order with their
+ *          remaining time, callback and parameter.
+ *
+ * @param[in] chp       pointer to a @p BaseSequentialStream object
+ * @param[in] argc      number of arguments
+ * @param[in] argv      arguments
+ *
+ * @api
+ */
+void shellCmdTimers(BaseSequentialStream *chp, int argc, char *argv[]) {
+  struct {
+    systime_t   time;
+    vtfunc_t    func;
+    void        *par;
+  } list[SHELL_CMD_TIMERS_MAX];
+  virtual_timer_t *vtp;
+  systime_t time;
+  unsigned i, n, more;
+
+  (void)argv;
+  if (argc > 0) {
+    usage(chp, "timers");
+    return;
+  }
+
+  /* The list is copied in a single critical zone, the deltas are
+     accumulated in order to obtain the time from now.*/
+  n = more = 0;
+  chSysLock();
+  vtp = ch.vtlist.vt_next;
+#if CH_CFG_ST_TIMEDELTA == 0
+  time = 0;
+#else
+  /* In tick-less mode the first delta is relative to the last timers
+     processing time.*/
+  time = chVTGetSystemTimeX() - ch.vtlist.vt_lasttime;
+  if ((vtp != (virtual_timer_t *)&ch.vtlist) && (time > vtp->vt_delta))
+    time = vtp->vt_delta;
+  time = (systime_t)0 - time;
+#endif
+  while (vtp != (virtual_timer_t *)&ch.vtlist) {
+    time += vtp->vt_delta;
+    if (n < SHELL_CMD_TIMERS_MAX) {
+      list[n].time = time;
+      list[n].func = vtp->vt_func;
+      list[n].par  = vtp->vt_par;
+      n++;
+    }
+    else
+      more++;
+    vtp = vtp->vt_next;
+  }
+  chSysUnlock();
+
+  chprintf(chp, "      ticks         ms     func      par\r\n");
+  for (i = 0; i < n; i++)
+    chprintf(chp, "%11lu %10lu %08lx %08lx\r\n",
+             (uint32_t)list[i].time, (uint32_t)ST2MS(list[i].time),
+             (uint32_t)list[i].func, (uint32_t)list[i].par);
+  if (more > 0)
+    chprintf(chp, "... %u more\r\n", more);
+}
+#endif /* SHELL_CMD_TIMERS_ENABLED */
+
+#if SHELL_CMD_IRQSTAT_ENABLED || defined(__DOXYGEN__)
+/**
+ * @brief   The @p irqstat command.
+ * @details Reports the number of IRQs and context switches and the
+ *          duration, in realtime counter cycles, of the critical zones.
+ *
+ * @param[in] chp       pointer to a @p BaseSequentialStream object
+ * @param[in] argc      number of arguments
+ * @param[in] argv      arguments
+ *
+ * @api
+ */
+void shellCmdIrqstat(BaseSequentialStream *chp, int argc, char *argv[]) {
+  kernel_stats_t ks;
+
+  (void)argv;
+  if (argc > 0) {
+    usage(chp, "irqstat");
+    return;
+  }
+
+  chSysLock();
+  ks = ch.kernel_stats;
+  chSysUnlock();
+
+  chprintf(chp, "IRQs             : %lu\r\n", (uint32_t)ks.n_irq);
+  chprintf(chp, "context switches : %lu\r\n", (uint32_t)ks.n_ctxswc);
+  chprintf(chp, "                        best      worst       last\r\n");
+  chprintf(chp, "thread critical  : %10lu %10lu %10lu cycles\r\n",
+           (uint32_t)ks.m_crit_thd.best, (uint32_t)ks.m_crit_thd.worst,
+           (uint32_t)ks.m_crit_thd.last);
+  chprintf(chp, "ISR critical     : %10lu %10lu %10lu cycles\r\n",
+           (uint32_t)ks.m_crit_isr.best, (uint32_t)ks.m_crit_isr.worst,
+           (uint32_t)ks.m_crit_isr.last);
+}
+#endif /* SHELL_CMD_IRQSTAT_ENABLED */
+
+#if SHELL_CMD_BENCH_ENABLED || defined(__DOXYGEN__)
+/*
+ * The benchmarks are executed by the kernel test suite code, a single
+ * instance of the command can run because the test suite state is global.
+ */
+static bool bench_busy;
+
+static unsigned bench_count(void) {
+  unsigned n = 0;
+
+  while (patternbmk[n] != NULL)
+    n++;
+  return n;
+}
+
+static bool bench_selected(unsigned i, int argc, char *argv[]) {
+  int j;
+
+  if (argc == 0)
+    return true;
+  for (j = 0; j < argc; j++) {
+    if ((unsigned)atoi(argv[j]) == i + 1U)
+      return true;
+  }
+  return false;
+}
+
+/**
+ * @brief   The @p bench command.
+ * @details Runs all the benchmarks of the kernel test suite or the ones
+ *          specified by number as arguments, the scores are comparable
+ *          with the ones of the test suite but are affected by the load
+ *          of the system.
+ * @note    The benchmarks run at the priority of the calling thread,
+ *          higher priority threads and interrupts reduce the scores.
+ * @note    A termination request is checked between the benchmarks.
+ *
+ * @param[in] chp       pointer to a @p BaseSequentialStream object
+ * @param[in] argc      number of arguments
+ * @param[in] argv      arguments
+ *
+ * @api
+ */
+void shellCmdBench(BaseSequentialStream *chp, int argc, char *argv[]) {
+  unsigned i, n = bench_count();
+  int j;
+
+  for (j = 0; j < argc; j++) {
+    i = (unsigned)atoi(argv[j]);
+    if ((i < 1U) || (i > n)) {
+      chprintf(chp, "Usage: bench [1..%u]...\r\n", n);
+      for (i = 0; i < n; i++)
+        chprintf(chp, "%2u: %s\r\n", i + 1U, patternbmk[i]->name);
+      return;
+    }
+  }
+
+  chSysLock();
+  if (bench_busy) {
+    chSysUnlock();
+    chprintf(chp, "bench: busy\r\n");
+    return;
+  }
+  bench_busy = true;
+  chSysUnlock();
+
+  for (i = 0; i < n; i++) {
+    if (!bench_selected(i, argc, argv))
+      continue;
+    chprintf(chp, "--- %u. %s\r\n", i + 1U, patternbmk[i]->name);
+    if (test_execute_case(chp, patternbmk[i]))
+      chprintf(chp, "--- Failed\r\n");
+    if (chThdShouldTerminateX())
+      break;
+  }
+
+  bench_busy = false;
+}
+#endif /* SHELL_CMD_BENCH_ENABLED */
+
+/** @} */
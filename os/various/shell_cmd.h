@@ -0,0 +1,200 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+/**
+ * @file    shell_cmd.h
+ * @brief   Shell built-in commands header.
+ *
+ * @addtogroup SHELL_CMD
+ * @{
+ */
+
+#ifndef _SHELL_CMD_H_
+#define _SHELL_CMD_H_
+
+/**
+ * @brief   Enables the @p mem command.
+ * @details Reports the core memory, the heap and the registered memory
+ *          pools status.
+ */
+#if !defined(SHELL_CMD_MEM_ENABLED) || defined(__DOXYGEN__)
+#define SHELL_CMD_MEM_ENABLED       CH_CFG_USE_MEMCORE
+#endif
+
+/**
+ * @brief   Enables the @p threads command.
+ */
+#if !defined(SHELL_CMD_THREADS_ENABLED) || defined(__DOXYGEN__)
+#define SHELL_CMD_THREADS_ENABLED   CH_CFG_USE_REGISTRY
+#endif
+
+/**
+ * @brief   Enables the @p timers command.
+ * @details Lists the armed virtual timers with their remaining time.
+ */
+#if !defined(SHELL_CMD_TIMERS_ENABLED) || defined(__DOXYGEN__)
+#define SHELL_CMD_TIMERS_ENABLED    TRUE
+#endif
+
+/**
+ * @brief   Maximum number of timers listed by the @p timers command.
+ * @note    The list is copied on the stack of the shell thread.
+ */
+#if !defined(SHELL_CMD_TIMERS_MAX) || defined(__DOXYGEN__)
+#define SHELL_CMD_TIMERS_MAX        8
+#endif
+
+/**
+ * @brief   Enables the @p irqstat command.
+ * @details Reports the kernel statistics collected when
+ *          @p CH_DBG_STATISTICS is enabled.
+ */
+#if !defined(SHELL_CMD_IRQSTAT_ENABLED) || defined(__DOXYGEN__)
+#define SHELL_CMD_IRQSTAT_ENABLED   CH_DBG_STATISTICS
+#endif
+
+/**
+ * @brief   Enables the @p bench command.
+ * @details Runs the benchmarks of the kernel test suite on the live
+ *          system, each benchmark lasts about one second.
+ * @note    The kernel test suite code (test/rt/test.mk) must be included
+ *          in the build.
+ */
+#if !defined(SHELL_CMD_BENCH_ENABLED) || defined(__DOXYGEN__)
+#define SHELL_CMD_BENCH_ENABLED     FALSE
+#endif
+
+#if SHELL_CMD_MEM_ENABLED && !CH_CFG_USE_MEMCORE
+#error "the mem command requires CH_CFG_USE_MEMCORE"
+#endif
+
+#if SHELL_CMD_THREADS_ENABLED && !CH_CFG_USE_REGISTRY
+#error "the threads command requires CH_CFG_USE_REGISTRY"
+#endif
+
+#if SHELL_CMD_IRQSTAT_ENABLED && !CH_DBG_STATISTICS
+#error "the irqstat command requires CH_DBG_STATISTICS"
+#endif
+
+#if SHELL_CMD_BENCH_ENABLED && !CH_CFG_USE_WAITEXIT
+#error "the bench command requires CH_CFG_USE_WAITEXIT"
+#endif
+
+#if SHELL_CMD_TIMERS_MAX < 1
+#error "invalid SHELL_CMD_TIMERS_MAX value"
+#endif
+
+#if (SHELL_CMD_MEM_ENABLED && CH_CFG_USE_MEMPOOLS) || defined(__DOXYGEN__)
+/**
+ * @brief   Memory pool reported by the @p mem command.
+ */
+typedef struct shell_cmd_pool {
+  struct shell_cmd_pool *next;              /**< @brief Next registered
+                                                 pool.                      */
+  const char            *name;              /**< @brief Pool name.          */
+  memory_pool_t         *mp;                /**< @brief Pool object.        */
+} shell_cmd_pool_t;
+#endif
+
+/**
+ * @name    Command table entries
+ * @brief   Entries to be included in a @p ShellCommand table, only the
+ *          enabled commands are expanded.
+ * @{
+ */
+#if SHELL_CMD_MEM_ENABLED || defined(__DOXYGEN__)
+#define SHELL_CMD_MEM_ENTRY         {"mem", shellCmdMem},
+#else
+#define SHELL_CMD_MEM_ENTRY
+#endif
+
+#if SHELL_CMD_THREADS_ENABLED || defined(__DOXYGEN__)
+#define SHELL_CMD_THREADS_ENTRY     {"threads", shellCmdThreads},
+#else
+#define SHELL_CMD_THREADS_ENTRY
+#endif
+
+#if SHELL_CMD_TIMERS_ENABLED || defined(__DOXYGEN__)
+#define SHELL_CMD_TIMERS_ENTRY      {"timers", shellCmdTimers},
+#else
+#define SHELL_CMD_TIMERS_ENTRY
+#endif
+
+#if SHELL_CMD_IRQSTAT_ENABLED || defined(__DOXYGEN__)
+#define SHELL_CMD_IRQSTAT_ENTRY     {"irqstat", shellCmdIrqstat},
+#else
+#define SHELL_CMD_IRQSTAT_ENTRY
+#endif
+
+#if SHELL_CMD_BENCH_ENABLED || defined(__DOXYGEN__)
+#define SHELL_CMD_BENCH_ENTRY       {"bench", shellCmdBench},
+#else
+#define SHELL_CMD_BENCH_ENTRY
+#endif
+
+/**
+ * @brief   All the enabled built-in commands.
+ * @details Example:
+ * @code
+ *  static const ShellCommand commands[] = {
+ *    {"test", cmd_test},
+ *    SHELL_CMD_ENTRIES
+ *    {NULL, NULL}
+ *  };
+ * @endcode
+ */
+#define SHELL_CMD_ENTRIES                                                   \
+  SHELL_CMD_MEM_ENTRY                                                       \
+  SHELL_CMD_THREADS_ENTRY                                                   \
+  SHELL_CMD_TIMERS_ENTRY                                                    \
+  SHELL_CMD_IRQSTAT_ENTRY                                                   \
+  SHELL_CMD_BENCH_ENTRY
+/** @} */
+
+#if !defined(__DOXYGEN__)
+extern const ShellCommand shell_cmd_commands[];
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#if SHELL_CMD_MEM_ENABLED
+  void shellCmdMem(BaseSequentialStream *chp, int argc, char *argv[]);
+#if CH_CFG_USE_MEMPOOLS
+  void shellCmdRegisterPool(shell_cmd_pool_t *spp, const char *name,
+                            memory_pool_t *mp);
+#endif
+#endif
+#if SHELL_CMD_THREADS_ENABLED
+  void shellCmdThreads(BaseSequentialStream *chp, int argc, char *argv[]);
+#endif
+#if SHELL_CMD_TIMERS_ENABLED
+  void shellCmdTimers(BaseSequentialStream *chp, int argc, char *argv[]);
+#endif
+#if SHELL_CMD_IRQSTAT_ENABLED
+  void shellCmdIrqstat(BaseSequentialStream *chp, int argc, char *argv[]);
+#endif
+#if SHELL_CMD_BENCH_ENABLED
+  void shellCmdBench(BaseSequentialStream *chp, int argc, char *argv[]);
+#endif
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SHELL_CMD_H_ */
+
+/** @} */
@@ -0,0 +1,13 @@
+# List of all the ADC streaming test files.
+TESTSRC = ${CHIBIOS}/test/lib/ch_test.c \
+          ${CHIBIOS}/test/adc/test_root.c \
+          ${CHIBIOS}/test/adc/test_sequence_001.c \
+          ${CHIBIOS}/os/hal/lib/adcstream/adcstream.c
+
+# Required include directories
+TESTINC = ${CHIBIOS}/test/lib \
+          ${CHIBIOS}/test/adc \
+          ${CHIBIOS}/os/hal/lib/adcstream
+
+# Required settings
+TESTDEFS = -DHAL_USE_ADC=TRUE
@@ -0,0 +1,82 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    test_root.h
+ * @brief   Test Suite root structures header.
+ *
+ * @addtogroup CH_TEST_ROOT
+ * @{
+ */
+
+#ifndef _TEST_ROOT_H_
+#define _TEST_ROOT_H_
+
+#include "ch.h"
+#include "hal.h"
+#include "adcstream.h"
+
+#include "test_sequence_001.h"
+
+/*===========================================================================*/
+/* Default definitions.                                                      */
+/*===========================================================================*/
+
+/* Global test suite name, it is printed on top of the test
+   report header.*/
+#define TEST_SUITE_NAME                     "ADC Streaming Test Suite"
+
+/**
+ * @brief   Depth of the ADC buffer.
+ */
+#if !defined(ADCTEST_DEPTH) || defined(__DOXYGEN__)
+#define ADCTEST_DEPTH                       64U
+#endif
+
+/**
+ * @brief   Number of blocks in the ring.
+ */
+#if !defined(ADCTEST_BLOCKS) || defined(__DOXYGEN__)
+#define ADCTEST_BLOCKS                      4U
+#endif
+
+/**
+ * @brief   Number of blocks checked by each test.
+ */
+#if !defined(ADCTEST_CHECK_BLOCKS) || defined(__DOXYGEN__)
+#define ADCTEST_CHECK_BLOCKS                256U
+#endif
+
+/**
+ * @brief   Number of blocks consumed by the throughput test.
+ */
+#if !defined(ADCTEST_RATE_BLOCKS) || defined(__DOXYGEN__)
+#define ADCTEST_RATE_BLOCKS                 20000U
+#endif
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+extern const testcase_t * const *test_suite[];
+
+/*===========================================================================*/
+/* Shared definitions.                                                       */
+/*===========================================================================*/
+
+#endif /* _TEST_ROOT_H_ */
+
+/** @} */
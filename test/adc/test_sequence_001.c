@@ -0,0 +1,639 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+/**
+ * @page test_sequence_001 ADC Streaming
+ *
+ * File: @ref test_sequence_001.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the ADC streams using the simulator ADC driver. The
+ * driver converts one half of the circular buffer at each simulated
+ * interrupt, the signal source of the driver is selected by each test so
+ * that the content of every block can be predicted from its sequence
+ * number.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_001_001
+ * - @subpage test_001_002
+ * - @subpage test_001_003
+ * - @subpage test_001_004
+ * - @subpage test_001_005
+ * - @subpage test_001_006
+ * - @subpage test_001_007
+ * - @subpage test_001_008
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define CHANNELS            2U
+#define HALF                (ADCTEST_DEPTH / 2U)
+#define BOXCAR_RATIO        4U
+#define CIC_RATIO           8U
+#define CIC_ORDER           3U
+#define SQUARE_HIGH         4000U
+#define CONST_CH0           1000U
+#define CONST_CH1           3000U
+
+typedef bool (*checker_t)(const ADCStreamBlock *bp);
+
+static const ADCConversionGroup adcgrp = {
+  true,
+  CHANNELS,
+  adcsEndCallback,
+  NULL
+};
+
+static adcsample_t dmabuf[ADCTEST_DEPTH * CHANNELS];
+static adcsample_t ring[ADCS_RING_SIZE(ADCTEST_BLOCKS, ADCTEST_DEPTH,
+                                       CHANNELS, BOXCAR_RATIO)];
+static ADCStreamBlock blocks[ADCTEST_BLOCKS];
+static ADCStream as;
+
+/*
+ * Ramp on both channels, shifted on the second one.
+ */
+static adcsample_t src_ramp(adc_channels_num_t channel, uint32_t n) {
+
+  return (adcsample_t)((n + (channel * 100U)) & SIM_ADC_MAX_SAMPLE);
+}
+
+/*
+ * Ramp on the first channel, square wave with a period of four
+ * conversions on the second.
+ */
+static adcsample_t src_mixed(adc_channels_num_t channel, uint32_t n) {
+
+  if (channel == 0U)
+    return (adcsample_t)(n & SIM_ADC_MAX_SAMPLE);
+  return (adcsample_t)(((n / 2U) & 1U) != 0U ? SQUARE_HIGH : 0U);
+}
+
+/*
+ * Constant value on each channel.
+ */
+static adcsample_t src_const(adc_channels_num_t channel, uint32_t n) {
+
+  (void)n;
+  return (adcsample_t)(channel == 0U ? CONST_CH0 : CONST_CH1);
+}
+
+static const ADCConfig cfg_ramp = {src_ramp};
+static const ADCConfig cfg_mixed = {src_mixed};
+static const ADCConfig cfg_const = {src_const};
+
+static const ADCStreamConfig scfg_copy = {
+  &ADCD1, &adcgrp, dmabuf, ADCTEST_DEPTH, blocks, NULL, 1U,
+  ADCS_FILTER_NONE, 1U, 0U
+};
+
+static const ADCStreamConfig scfg_boxcar = {
+  &ADCD1, &adcgrp, dmabuf, ADCTEST_DEPTH, blocks, ring, ADCTEST_BLOCKS,
+  ADCS_FILTER_BOXCAR, BOXCAR_RATIO, 0U
+};
+
+static const ADCStreamConfig scfg_cic = {
+  &ADCD1, &adcgrp, dmabuf, ADCTEST_DEPTH, blocks, ring, ADCTEST_BLOCKS,
+  ADCS_FILTER_CIC, CIC_RATIO, CIC_ORDER
+};
+
+/*
+ * Samples passed as they are.
+ */
+static bool check_copy(const ADCStreamBlock *bp) {
+  uint32_t r, c;
+
+  for (r = 0; r < bp->n; r++) {
+    for (c = 0; c < CHANNELS; c++) {
+      if (bp->samples[(r * CHANNELS) + c] !=
+          src_ramp((adc_channels_num_t)c, (bp->seq * HALF) + r))
+        return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Average of four samples, the ramp never wraps inside a group and the
+ * square wave averages to half its amplitude.
+ */
+static bool check_boxcar(const ADCStreamBlock *bp) {
+  uint32_t o, base;
+
+  if (bp->n != HALF / BOXCAR_RATIO)
+    return false;
+  for (o = 0; o < bp->n; o++) {
+    base = ((bp->seq * HALF) + (o * BOXCAR_RATIO)) & SIM_ADC_MAX_SAMPLE;
+    if ((bp->samples[o * CHANNELS] != base + 1U) ||
+        (bp->samples[(o * CHANNELS) + 1U] != SQUARE_HIGH / 2U))
+      return false;
+  }
+  return true;
+}
+
+/*
+ * Unity gain at DC, the first block contains the filter transient.
+ */
+static bool check_cic(const ADCStreamBlock *bp) {
+  uint32_t o;
+
+  if (bp->n != HALF / CIC_RATIO)
+    return false;
+  if (bp->seq == 0U)
+    return true;
+  for (o = 0; o < bp->n; o++) {
+    if ((bp->samples[o * CHANNELS] != CONST_CH0) ||
+        (bp->samples[(o * CHANNELS) + 1U] != CONST_CH1))
+      return false;
+  }
+  return true;
+}
+
+/*
+ * Starts the ADC and the stream.
+ */
+static void start(const ADCConfig *cfg, const ADCStreamConfig *scfg) {
+
+  adcStart(&ADCD1, cfg);
+  adcsStart(&as, scfg);
+}
+
+/*
+ * Stops the stream and the ADC, it is the teardown of all the test cases.
+ */
+static void stop(void) {
+
+  adcsStop(&as);
+  adcStop(&ADCD1);
+}
+
+/*
+ * Runs the simulated ADC for a number of half buffers.
+ */
+static void run_halves(uint32_t n) {
+
+#if defined(SIMULATOR)
+  while (n-- > 0U)
+    _sim_check_for_interrupts();
+#else
+  chThdSleepMilliseconds(n * 10U);
+#endif
+}
+
+/*
+ * Converts an amount in a rate per second.
+ */
+static uint32_t per_second(uint32_t n, systime_t elapsed) {
+
+  if (elapsed == (systime_t)0)
+    elapsed = (systime_t)1;
+  return (uint32_t)(((uint64_t)n * CH_CFG_ST_FREQUENCY) / elapsed);
+}
+
+/*
+ * Consumes ADCTEST_CHECK_BLOCKS blocks checking sequence and content, no
+ * blocks must be lost. Returns the failure message or NULL.
+ */
+static const char *consume(checker_t check) {
+  ADCStreamBlock *bp;
+  uint32_t i;
+
+  for (i = 0; i < ADCTEST_CHECK_BLOCKS; i++) {
+    bp = adcsGetBlockTimeout(&as, MS2ST(100));
+    if (bp == NULL)
+      return "timeout";
+    if ((bp->seq != i) || (bp->lost != 0U))
+      return "block out of sequence";
+    if (!check(bp))
+      return "wrong samples";
+    adcsReleaseBlock(&as);
+  }
+  return NULL;
+}
+
+/*
+ * Consumes ADCTEST_RATE_BLOCKS blocks as fast as the ADC produces them,
+ * the score is the number of input samples per second.
+ */
+static void rate(void) {
+  ADCStreamBlock *bp;
+  systime_t start_time, elapsed;
+  uint32_t i, overruns;
+
+  start_time = chVTGetSystemTimeX();
+  for (i = 0; i < ADCTEST_RATE_BLOCKS; i++) {
+    bp = adcsGetBlockTimeout(&as, MS2ST(100));
+    test_assert(bp != NULL, "timeout");
+    adcsReleaseBlock(&as);
+  }
+  elapsed = chVTTimeElapsedSinceX(start_time);
+  overruns = adcsGetOverrunsX(&as);
+
+  test_print("--- Score : ");
+  test_printn(per_second(i * HALF * CHANNELS, elapsed));
+  test_print(" samples/S, ");
+  test_printn(overruns);
+  test_println(" half buffers lost");
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page test_001_001 Pass-through stream
+ *
+ * <h2>Description</h2>
+ * The samples of a ramp are passed to the consumer as they are.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - @p ADCTEST_CHECK_BLOCKS blocks are consumed and verified.
+ * .
+ */
+
+static void test_001_001_setup(void) {
+
+  adcsObjectInit(&as);
+  start(&cfg_ramp, &scfg_copy);
+}
+
+static void test_001_001_execute(void) {
+
+  /* ADCTEST_CHECK_BLOCKS blocks are consumed and verified.*/
+  test_set_step(1);
+  {
+    const char *err = consume(check_copy);
+
+    test_assert(err == NULL, err);
+  }
+}
+
+static const testcase_t test_001_001 = {
+  "Pass-through stream",
+  test_001_001_setup,
+  stop,
+  test_001_001_execute
+};
+
+/**
+ * @page test_001_002 Boxcar decimation
+ *
+ * <h2>Description</h2>
+ * A ramp and a square wave are averaged over groups of four samples.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - @p ADCTEST_CHECK_BLOCKS blocks are consumed and verified.
+ * .
+ */
+
+static void test_001_002_setup(void) {
+
+  start(&cfg_mixed, &scfg_boxcar);
+}
+
+static void test_001_002_execute(void) {
+
+  /* ADCTEST_CHECK_BLOCKS blocks are consumed and verified.*/
+  test_set_step(1);
+  {
+    const char *err = consume(check_boxcar);
+
+    test_assert(err == NULL, err);
+  }
+}
+
+static const testcase_t test_001_002 = {
+  "Boxcar decimation",
+  test_001_002_setup,
+  stop,
+  test_001_002_execute
+};
+
+/**
+ * @page test_001_003 CIC decimation
+ *
+ * <h2>Description</h2>
+ * Constant values are filtered by a CIC decimator, the gain must be unity
+ * after the transient of the first block.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - @p ADCTEST_CHECK_BLOCKS blocks are consumed and verified.
+ * .
+ */
+
+static void test_001_003_setup(void) {
+
+  start(&cfg_const, &scfg_cic);
+}
+
+static void test_001_003_execute(void) {
+
+  /* ADCTEST_CHECK_BLOCKS blocks are consumed and verified.*/
+  test_set_step(1);
+  {
+    const char *err = consume(check_cic);
+
+    test_assert(err == NULL, err);
+  }
+}
+
+static const testcase_t test_001_003 = {
+  "CIC decimation",
+  test_001_003_setup,
+  stop,
+  test_001_003_execute
+};
+
+/**
+ * @page test_001_004 Overrun
+ *
+ * <h2>Description</h2>
+ * The ADC runs while the consumer is not reading, the half buffers
+ * exceeding the ring must be counted and reported by the first block
+ * produced after the ring is drained.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The ADC runs for @p ADCTEST_BLOCKS plus eight half buffers, the
+ *   overruns must have been counted.
+ * - The blocks in the ring are consumed, they must be intact.
+ * - The next block must report the overruns.
+ * .
+ */
+
+static void test_001_004_setup(void) {
+
+  start(&cfg_mixed, &scfg_boxcar);
+}
+
+static void test_001_004_execute(void) {
+  ADCStreamBlock *bp;
+  uint32_t i, overruns;
+
+  /* The ADC runs for ADCTEST_BLOCKS plus eight half buffers, the overruns
+     must have been counted.*/
+  test_set_step(1);
+  {
+    run_halves(ADCTEST_BLOCKS + 8U);
+    chSysLock();
+    overruns = adcsGetOverrunsX(&as);
+    chSysUnlock();
+    test_assert(overruns > 0U, "overruns not counted");
+  }
+
+  /* The blocks in the ring are consumed, they must be intact.*/
+  test_set_step(2);
+  {
+    for (i = 0; i < ADCTEST_BLOCKS; i++) {
+      bp = adcsGetBlockTimeout(&as, TIME_IMMEDIATE);
+      test_assert((bp != NULL) && (bp->seq == i) && (bp->lost == 0U) &&
+                  check_boxcar(bp),
+                  "block not available");
+      adcsReleaseBlock(&as);
+    }
+  }
+
+  /* The next block must report the overruns.*/
+  test_set_step(3);
+  {
+    bp = adcsGetBlockTimeout(&as, MS2ST(100));
+    test_assert((bp != NULL) && (bp->lost == overruns) &&
+                (bp->seq == ADCTEST_BLOCKS + overruns) && check_boxcar(bp),
+                "overruns not reported");
+    test_print("--- Lost  : ");
+    test_printn(overruns);
+    test_println(" half buffers");
+  }
+}
+
+static const testcase_t test_001_004 = {
+  "Overrun",
+  test_001_004_setup,
+  stop,
+  test_001_004_execute
+};
+
+/**
+ * @page test_001_005 Late release of a pass-through block
+ *
+ * <h2>Description</h2>
+ * A pass-through block points into the ADC buffer, the ADC completes more
+ * half buffers while the block is in use. The block is overwritten and
+ * the half buffers completed meanwhile are lost because the block was not
+ * released, all of them must be counted and the next block must be
+ * intact.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The first block is fetched and verified.
+ * - The ADC runs for two half buffers before the block is released.
+ * - The next block must report the lost half buffers and be intact.
+ * .
+ */
+
+static void test_001_005_setup(void) {
+
+  start(&cfg_ramp, &scfg_copy);
+}
+
+static void test_001_005_execute(void) {
+  ADCStreamBlock *bp;
+  uint32_t overruns;
+
+  /* The first block is fetched and verified.*/
+  test_set_step(1);
+  {
+    bp = adcsGetBlockTimeout(&as, MS2ST(100));
+    test_assert((bp != NULL) && (bp->seq == 0U) && check_copy(bp),
+                "first block not available");
+  }
+
+  /* The ADC runs for two half buffers before the block is released.*/
+  test_set_step(2);
+  {
+    run_halves(2U);
+    adcsReleaseBlock(&as);
+  }
+
+  /* The next block must report the lost half buffers and be intact.*/
+  test_set_step(3);
+  {
+    chSysLock();
+    overruns = adcsGetOverrunsX(&as);
+    chSysUnlock();
+    bp = adcsGetBlockTimeout(&as, MS2ST(100));
+    test_assert((bp != NULL) && (bp->lost != 0U), "no overruns");
+    test_assert((overruns == bp->lost + 1U) && (bp->seq == bp->lost + 1U),
+                "wrong overruns count");
+    test_assert(check_copy(bp), "wrong samples");
+  }
+}
+
+static const testcase_t test_001_005 = {
+  "Late release of a pass-through block",
+  test_001_005_setup,
+  stop,
+  test_001_005_execute
+};
+
+/**
+ * @page test_001_006 Throughput, pass-through
+ *
+ * <h2>Description</h2>
+ * @p ADCTEST_RATE_BLOCKS blocks are consumed from a pass-through stream,
+ * the simulated ADC runs as fast as the consumer releases the blocks.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The blocks are consumed and the score is printed.
+ * .
+ */
+
+static void test_001_006_setup(void) {
+
+  start(&cfg_const, &scfg_copy);
+}
+
+static void test_001_006_execute(void) {
+
+  /* The blocks are consumed and the score is printed.*/
+  test_set_step(1);
+  {
+    rate();
+  }
+}
+
+static const testcase_t test_001_006 = {
+  "Throughput, pass-through",
+  test_001_006_setup,
+  stop,
+  test_001_006_execute
+};
+
+/**
+ * @page test_001_007 Throughput, boxcar
+ *
+ * <h2>Description</h2>
+ * @p ADCTEST_RATE_BLOCKS blocks are consumed from a boxcar decimation
+ * stream, the simulated ADC runs as fast as the consumer releases the
+ * blocks.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The blocks are consumed and the score is printed.
+ * .
+ */
+
+static void test_001_007_setup(void) {
+
+  start(&cfg_const, &scfg_boxcar);
+}
+
+static void test_001_007_execute(void) {
+
+  /* The blocks are consumed and the score is printed.*/
+  test_set_step(1);
+  {
+    rate();
+  }
+}
+
+static const testcase_t test_001_007 = {
+  "Throughput, boxcar",
+  test_001_007_setup,
+  stop,
+  test_001_007_execute
+};
+
+/**
+ * @page test_001_008 Throughput, CIC
+ *
+ * <h2>Description</h2>
+ * @p ADCTEST_RATE_BLOCKS blocks are consumed from a CIC decimation
+ * stream, the simulated ADC runs as fast as the consumer releases the
+ * blocks.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The blocks are consumed and the score is printed.
+ * .
+ */
+
+static void test_001_008_setup(void) {
+
+  start(&cfg_const, &scfg_cic);
+}
+
+static void test_001_008_execute(void) {
+
+  /* The blocks are consumed and the score is printed.*/
+  test_set_step(1);
+  {
+    rate();
+  }
+}
+
+static const testcase_t test_001_008 = {
+  "Throughput, CIC",
+  test_001_008_setup,
+  stop,
+  test_001_008_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   ADC Streaming.
+ */
+const testcase_t * const test_sequence_001[] = {
+  &test_001_001,
+  &test_001_002,
+  &test_001_003,
+  &test_001_004,
+  &test_001_005,
+  &test_001_006,
+  &test_001_007,
+  &test_001_008,
+  NULL
+};
@@ -0,0 +1,15 @@
+# List of all the block devices test files.
+TESTSRC = ${CHIBIOS}/test/lib/ch_test.c \
+          ${CHIBIOS}/test/blocks/test_root.c \
+          ${CHIBIOS}/test/blocks/test_sequence_001.c \
+          ${CHIBIOS}/test/blocks/test_sequence_002.c \
+          ${CHIBIOS}/os/hal/lib/blocks/ramdisk.c \
+          ${CHIBIOS}/os/hal/lib/blocks/blkcache.c
+
+# Required include directories
+TESTINC = ${CHIBIOS}/test/lib \
+          ${CHIBIOS}/test/blocks \
+          ${CHIBIOS}/os/hal/lib/blocks
+
+# Required settings
+TESTDEFS =
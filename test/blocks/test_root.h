@@ -0,0 +1,95 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    test_root.h
+ * @brief   Test Suite root structures header.
+ *
+ * @addtogroup CH_TEST_ROOT
+ * @{
+ */
+
+#ifndef _TEST_ROOT_H_
+#define _TEST_ROOT_H_
+
+#include "ch.h"
+#include "hal.h"
+#include "ramdisk.h"
+#include "blkcache.h"
+
+#include "test_sequence_001.h"
+#include "test_sequence_002.h"
+
+/*===========================================================================*/
+/* Default definitions.                                                      */
+/*===========================================================================*/
+
+/* Global test suite name, it is printed on top of the test
+   report header.*/
+#define TEST_SUITE_NAME                     "Block Devices Test Suite"
+
+/**
+ * @brief   Size of the RAM disk in blocks.
+ */
+#if !defined(BLKTEST_DISK_BLOCKS) || defined(__DOXYGEN__)
+#define BLKTEST_DISK_BLOCKS                 256U
+#endif
+
+/**
+ * @brief   Number of lines of the block cache.
+ */
+#if !defined(BLKTEST_CACHE_LINES) || defined(__DOXYGEN__)
+#define BLKTEST_CACHE_LINES                 16U
+#endif
+
+/**
+ * @brief   Duration of each throughput measurement in milliseconds.
+ */
+#if !defined(BLKTEST_DURATION) || defined(__DOXYGEN__)
+#define BLKTEST_DURATION                    1000U
+#endif
+
+#if BLKTEST_DISK_BLOCKS < (2U * BLKCACHE_BYPASS_THRESHOLD)
+#error "BLKTEST_DISK_BLOCKS too small"
+#endif
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+extern const testcase_t * const *test_suite[];
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  extern RamDisk rd;
+  extern BlockCache bc;
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Shared definitions.                                                       */
+/*===========================================================================*/
+
+/**
+ * @brief   Block size of the devices under test.
+ */
+#define BLOCK_SIZE                          BLKCACHE_BLOCK_SIZE
+
+#endif /* _TEST_ROOT_H_ */
+
+/** @} */
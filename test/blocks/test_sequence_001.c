@@ -0,0 +1,192 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string.h>
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+/**
+ * @page test_sequence_001 Block Devices
+ *
+ * File: @ref test_sequence_001.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the block devices layer using a RAM disk, alone or
+ * under a block cache.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_001_001
+ * - @subpage test_001_002
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+static blkcache_line_t lines[BLKTEST_CACHE_LINES];
+
+static union {
+  uint32_t  alignment;
+  uint8_t   buf[BLKTEST_DISK_BLOCKS * BLOCK_SIZE];
+} disk;
+
+static union {
+  uint32_t  alignment;
+  uint8_t   buf[BLKTEST_CACHE_LINES * BLOCK_SIZE];
+} cachebuf;
+
+static union {
+  uint32_t  alignment;
+  uint8_t   buf[BLOCK_SIZE];
+} wrbuf;
+
+static const BlockCacheConfig bccfg = {
+  (BaseBlockDevice *)&rd,
+  lines,
+  cachebuf.buf,
+  BLKTEST_CACHE_LINES,
+  0U
+};
+
+/*
+ * Returns true if a block of the RAM disk is filled with a value.
+ */
+static bool block_is(uint32_t blk, uint8_t value) {
+  const uint8_t *p = &disk.buf[blk * BLOCK_SIZE];
+  size_t i;
+
+  for (i = 0; i < BLOCK_SIZE; i++) {
+    if (p[i] != value)
+      return false;
+  }
+  return true;
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page test_001_001 Devices connection
+ *
+ * <h2>Description</h2>
+ * The RAM disk and the block cache over it are started and connected.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The RAM disk is started over a cleared memory area.
+ * - The block cache is started over the RAM disk and connected.
+ * .
+ */
+
+static void test_001_001_execute(void) {
+
+  /* The RAM disk is started over a cleared memory area.*/
+  test_set_step(1);
+  {
+    memset(disk.buf, 0, sizeof disk.buf);
+    rdObjectInit(&rd);
+    rdStart(&rd, disk.buf, BLOCK_SIZE, BLKTEST_DISK_BLOCKS, false);
+  }
+
+  /* The block cache is started over the RAM disk and connected.*/
+  test_set_step(2);
+  {
+    bcObjectInit(&bc);
+    bcStart(&bc, &bccfg);
+    test_assert(!blkConnect(&bc), "connection error");
+  }
+}
+
+static const testcase_t test_001_001 = {
+  "Devices connection",
+  NULL,
+  NULL,
+  test_001_001_execute
+};
+
+/**
+ * @page test_001_002 Erase requests
+ *
+ * <h2>Description</h2>
+ * The erase requests go through the virtual methods table of the device,
+ * the cache drops the erased blocks so that delayed writes do not
+ * overwrite the erased area.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Four blocks are written through the cache.
+ * - The two middle blocks are erased and the cache is synchronized, the
+ *   erased blocks must not be written back.
+ * - An out of range erase must be rejected.
+ * .
+ */
+
+static void test_001_002_execute(void) {
+  uint32_t blk;
+
+  /* Four blocks are written through the cache.*/
+  test_set_step(1);
+  {
+    memset(wrbuf.buf, 0x5A, BLOCK_SIZE);
+    for (blk = 0U; blk < 4U; blk++)
+      test_assert(!blkWrite(&bc, blk, wrbuf.buf, 1U), "write error");
+  }
+
+  /* The two middle blocks are erased and the cache is synchronized, the
+     erased blocks must not be written back.*/
+  test_set_step(2);
+  {
+    test_assert(!blkErase(&bc, 1U, 2U) && !blkSync(&bc), "erase error");
+    test_assert(block_is(0U, 0x5AU) && block_is(1U, 0U) &&
+                block_is(2U, 0U) && block_is(3U, 0x5AU),
+                "erased blocks written back");
+  }
+
+  /* An out of range erase must be rejected.*/
+  test_set_step(3);
+  {
+    test_assert(blkErase(&rd, 0U, BLKTEST_DISK_BLOCKS),
+                "out of range erase accepted");
+  }
+}
+
+static const testcase_t test_001_002 = {
+  "Erase requests",
+  NULL,
+  NULL,
+  test_001_002_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Block Devices.
+ */
+const testcase_t * const test_sequence_001[] = {
+  &test_001_001,
+  &test_001_002,
+  NULL
+};
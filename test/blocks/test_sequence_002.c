@@ -0,0 +1,289 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string.h>
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+/**
+ * @page test_sequence_002 Benchmarks
+ *
+ * File: @ref test_sequence_002.c
+ *
+ * <h2>Description</h2>
+ * This sequence measures the sustained sequential write throughput of the
+ * block devices layer, writing for @p BLKTEST_DURATION milliseconds using
+ * single block writes and writes of @p BLKCACHE_BYPASS_THRESHOLD blocks,
+ * the latter bypass the cache. The RAM disk has no transfer time of its
+ * own.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_002_001
+ * - @subpage test_002_002
+ * - @subpage test_002_003
+ * - @subpage test_002_004
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+static union {
+  uint32_t  alignment;
+  uint8_t   buf[BLKCACHE_BYPASS_THRESHOLD * BLOCK_SIZE];
+} wrbuf;
+
+static virtual_timer_t vt;
+static volatile bool done;
+
+/*
+ * End of the measurement window.
+ */
+static void tmr(void *p) {
+
+  (void)p;
+  done = true;
+}
+
+/*
+ * Writes sequentially n blocks for each operation until the end of the
+ * measurement window, returns the failure message or NULL.
+ */
+static const char *write_loop(BaseBlockDevice *bdp, uint32_t n,
+                              uint32_t *blocksp) {
+  uint32_t blk, blocks;
+
+  memset(wrbuf.buf, 0xA5, n * BLOCK_SIZE);
+  blk = 0U;
+  blocks = 0U;
+  done = false;
+  chThdSleep(1);
+  chVTSet(&vt, MS2ST(BLKTEST_DURATION), tmr, NULL);
+  do {
+    if (blkWrite(bdp, blk, wrbuf.buf, n)) {
+      chVTReset(&vt);
+      return "write error";
+    }
+    blocks += n;
+    blk += n;
+    if (blk + n > BLKTEST_DISK_BLOCKS)
+      blk = 0U;
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  } while (!done);
+  if (blkSync(bdp))
+    return "sync error";
+  *blocksp = blocks;
+  return NULL;
+}
+
+/*
+ * Prints the throughput score.
+ */
+static void print_score(uint32_t blocks) {
+
+  test_print("--- Score : ");
+  test_printn((uint32_t)(((uint64_t)blocks * BLOCK_SIZE * 1000U) /
+                         (1024U * BLKTEST_DURATION)));
+  test_println(" KB/S");
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page test_002_001 RAM disk, single block writes
+ *
+ * <h2>Description</h2>
+ * Single block writes are performed on the RAM disk.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Blocks are written for the measurement window.
+ * - The score is printed.
+ * .
+ */
+
+static void test_002_001_execute(void) {
+  uint32_t blocks;
+
+  /* Blocks are written for the measurement window.*/
+  test_set_step(1);
+  {
+    const char *err = write_loop((BaseBlockDevice *)&rd, 1U, &blocks);
+
+    test_assert(err == NULL, err);
+  }
+
+  /* The score is printed.*/
+  test_set_step(2);
+  {
+    print_score(blocks);
+  }
+}
+
+static const testcase_t test_002_001 = {
+  "RAM disk, single block writes",
+  NULL,
+  NULL,
+  test_002_001_execute
+};
+
+/**
+ * @page test_002_002 RAM disk, multiple blocks writes
+ *
+ * <h2>Description</h2>
+ * Writes of @p BLKCACHE_BYPASS_THRESHOLD blocks are performed on the RAM
+ * disk.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Blocks are written for the measurement window.
+ * - The score is printed.
+ * .
+ */
+
+static void test_002_002_execute(void) {
+  uint32_t blocks;
+
+  /* Blocks are written for the measurement window.*/
+  test_set_step(1);
+  {
+    const char *err = write_loop((BaseBlockDevice *)&rd,
+                                 BLKCACHE_BYPASS_THRESHOLD, &blocks);
+
+    test_assert(err == NULL, err);
+  }
+
+  /* The score is printed.*/
+  test_set_step(2);
+  {
+    print_score(blocks);
+  }
+}
+
+static const testcase_t test_002_002 = {
+  "RAM disk, multiple blocks writes",
+  NULL,
+  NULL,
+  test_002_002_execute
+};
+
+/**
+ * @page test_002_003 Cache, single block writes
+ *
+ * <h2>Description</h2>
+ * Single block writes are performed through the block cache.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Blocks are written for the measurement window.
+ * - The score is printed.
+ * .
+ */
+
+static void test_002_003_execute(void) {
+  uint32_t blocks;
+
+  /* Blocks are written for the measurement window.*/
+  test_set_step(1);
+  {
+    const char *err = write_loop((BaseBlockDevice *)&bc, 1U, &blocks);
+
+    test_assert(err == NULL, err);
+  }
+
+  /* The score is printed.*/
+  test_set_step(2);
+  {
+    print_score(blocks);
+  }
+}
+
+static const testcase_t test_002_003 = {
+  "Cache, single block writes",
+  NULL,
+  NULL,
+  test_002_003_execute
+};
+
+/**
+ * @page test_002_004 Cache, multiple blocks writes
+ *
+ * <h2>Description</h2>
+ * Writes of @p BLKCACHE_BYPASS_THRESHOLD blocks are performed through the
+ * block cache, they bypass the cache lines.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Blocks are written for the measurement window.
+ * - The score is printed.
+ * .
+ */
+
+static void test_002_004_execute(void) {
+  uint32_t blocks;
+
+  /* Blocks are written for the measurement window.*/
+  test_set_step(1);
+  {
+    const char *err = write_loop((BaseBlockDevice *)&bc,
+                                 BLKCACHE_BYPASS_THRESHOLD, &blocks);
+
+    test_assert(err == NULL, err);
+  }
+
+  /* The score is printed.*/
+  test_set_step(2);
+  {
+    print_score(blocks);
+  }
+}
+
+static const testcase_t test_002_004 = {
+  "Cache, multiple blocks writes",
+  NULL,
+  NULL,
+  test_002_004_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Benchmarks.
+ */
+const testcase_t * const test_sequence_002[] = {
+  &test_002_001,
+  &test_002_002,
+  &test_002_003,
+  &test_002_004,
+  NULL
+};
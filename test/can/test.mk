@@ -0,0 +1,11 @@
+# List of all the CAN queues test files.
+TESTSRC = ${CHIBIOS}/test/lib/ch_test.c \
+          ${CHIBIOS}/test/can/test_root.c \
+          ${CHIBIOS}/test/can/test_sequence_001.c
+
+# Required include directories
+TESTINC = ${CHIBIOS}/test/lib \
+          ${CHIBIOS}/test/can
+
+# Required settings
+TESTDEFS = -DHAL_USE_CAN=TRUE -DCAN_USE_RX_QUEUES=TRUE -DCAN_USE_TX_QUEUE=TRUE
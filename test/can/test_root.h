@@ -0,0 +1,111 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    test_root.h
+ * @brief   Test Suite root structures header.
+ *
+ * @addtogroup CH_TEST_ROOT
+ * @{
+ */
+
+#ifndef _TEST_ROOT_H_
+#define _TEST_ROOT_H_
+
+#include "ch.h"
+#include "hal.h"
+
+#include "test_sequence_001.h"
+
+/*===========================================================================*/
+/* Default definitions.                                                      */
+/*===========================================================================*/
+
+/* Global test suite name, it is printed on top of the test
+   report header.*/
+#define TEST_SUITE_NAME                     "CAN Queues Test Suite"
+
+/**
+ * @brief   Number of frames sent back to back by the burst test.
+ * @note    It must exceed the depth of the receive FIFO of the controller.
+ */
+#if !defined(CANTEST_BURST_FRAMES) || defined(__DOXYGEN__)
+#define CANTEST_BURST_FRAMES                48U
+#endif
+
+/**
+ * @brief   Size of the catch-all receive queue.
+ */
+#if !defined(CANTEST_QUEUE_SIZE) || defined(__DOXYGEN__)
+#define CANTEST_QUEUE_SIZE                  64U
+#endif
+
+/**
+ * @brief   Size of the routed receive queues.
+ */
+#if !defined(CANTEST_ROUTED_SIZE) || defined(__DOXYGEN__)
+#define CANTEST_ROUTED_SIZE                 8U
+#endif
+
+/**
+ * @brief   Size of the transmit queue.
+ */
+#if !defined(CANTEST_TXQ_SIZE) || defined(__DOXYGEN__)
+#define CANTEST_TXQ_SIZE                    32U
+#endif
+
+/**
+ * @brief   Number of frames exchanged by the throughput test.
+ */
+#if !defined(CANTEST_RATE_FRAMES) || defined(__DOXYGEN__)
+#define CANTEST_RATE_FRAMES                 10000U
+#endif
+
+/**
+ * @brief   Maximum number of frames fetched by each receive call.
+ */
+#if !defined(CANTEST_BATCH) || defined(__DOXYGEN__)
+#define CANTEST_BATCH                       16U
+#endif
+
+/**
+ * @brief   Stack size of the receiver thread.
+ */
+#if !defined(CANTEST_STACK_SIZE) || defined(__DOXYGEN__)
+#if defined(CH_ARCHITECTURE_SIMIA32)
+#define CANTEST_STACK_SIZE                  2048
+#else
+#define CANTEST_STACK_SIZE                  512
+#endif
+#endif
+
+#if !CAN_USE_RX_QUEUES || !CAN_USE_TX_QUEUE
+#error "the CAN test requires CAN_USE_RX_QUEUES and CAN_USE_TX_QUEUE"
+#endif
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+extern const testcase_t * const *test_suite[];
+
+/*===========================================================================*/
+/* Shared definitions.                                                       */
+/*===========================================================================*/
+
+#endif /* _TEST_ROOT_H_ */
+
+/** @} */
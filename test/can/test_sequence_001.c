@@ -0,0 +1,646 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+/**
+ * @page test_sequence_001 CAN Queues
+ *
+ * File: @ref test_sequence_001.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the CAN receive and transmit queues. Frames are
+ * sent by @p CAND1 and received by @p CAND2 on the same bus, with the
+ * simulator the two drivers are connected by the virtual bus. The
+ * transmitting driver uses a transmit queue. The receiving driver uses
+ * three queues, two of them are fed by specific acceptance filters and
+ * the third one receives all the other extended frames.
+ * @note    Queues cannot be detached, the sequence can only be executed
+ *          once.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_001_001
+ * - @subpage test_001_002
+ * - @subpage test_001_003
+ * - @subpage test_001_004
+ * - @subpage test_001_005
+ * - @subpage test_001_006
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define ROUTED_A_ID         0x100U
+#define ROUTED_B_ID         0x200U
+#define REJECTED_ID         0x300U
+#define ARBITRATION_ID      0x2000U
+
+/* Frames queued by the arbitration test, all the mailboxes are filled and
+   the transmit queue is filled too.*/
+#define ARBITRATION_FRAMES  (CANTEST_TXQ_SIZE + CAN_TX_MAILBOXES)
+
+#if (ARBITRATION_FRAMES > CANTEST_BURST_FRAMES) ||                          \
+    (ARBITRATION_FRAMES > CANTEST_QUEUE_SIZE)
+#error "CANTEST_TXQ_SIZE too large"
+#endif
+
+static const CANConfig cancfg = {
+  false
+};
+
+/*
+ * Filter 0 routes the standard identifiers 0x100..0x10F to queue A, filter 1
+ * routes 0x200..0x20F to queue B, filter 2 accepts all the extended
+ * identifiers which go to the catch-all queue.
+ */
+static const CANAcceptanceFilter filters[] = {
+  {ROUTED_A_ID, 0x7F0U, CAN_IDE_STD},
+  {ROUTED_B_ID, 0x7F0U, CAN_IDE_STD},
+  {0U,          0U,     CAN_IDE_EXT}
+};
+
+static CANRxFrame buf_a[CANTEST_ROUTED_SIZE];
+static CANRxFrame buf_b[CANTEST_ROUTED_SIZE];
+static CANRxFrame buf_any[CANTEST_QUEUE_SIZE];
+static CANRxQueue queue_a, queue_b, queue_any;
+static CANTxQueueEntry buf_tx[CANTEST_TXQ_SIZE];
+static CANTxQueue txqueue;
+static CANRxFrame frames[CANTEST_BURST_FRAMES];
+static THD_WORKING_AREA(wa_receiver, CANTEST_STACK_SIZE);
+static uint32_t batches;
+
+/*
+ * Prepares a frame, the payload is the frame sequence number.
+ */
+static void prepare(CANTxFrame *ctfp, uint8_t ide, uint32_t id, uint32_t seq) {
+
+  ctfp->IDE = ide;
+  ctfp->RTR = CAN_RTR_DATA;
+  ctfp->DLC = 4U;
+  if (ide == CAN_IDE_EXT)
+    ctfp->EID = id;
+  else
+    ctfp->SID = id;
+  ctfp->data8[0] = (uint8_t)seq;
+  ctfp->data8[1] = (uint8_t)(seq >> 8);
+  ctfp->data8[2] = (uint8_t)(seq >> 16);
+  ctfp->data8[3] = (uint8_t)(seq >> 24);
+}
+
+/*
+ * Sends a frame through the transmit queue of CAND1.
+ */
+static bool send(uint8_t ide, uint32_t id, uint32_t seq) {
+  CANTxFrame txf;
+
+  prepare(&txf, ide, id, seq);
+  return canTransmit(&CAND1, CAN_ANY_MAILBOX, &txf, MS2ST(100)) != MSG_OK;
+}
+
+/*
+ * Returns the sequence number of a received frame.
+ */
+static uint32_t sequence(const CANRxFrame *crfp) {
+
+  return (uint32_t)crfp->data8[0] | ((uint32_t)crfp->data8[1] << 8) |
+         ((uint32_t)crfp->data8[2] << 16) | ((uint32_t)crfp->data8[3] << 24);
+}
+
+/*
+ * Fetches up to n frames from a queue of CAND2, stops when no more frames
+ * arrive.
+ */
+static uint32_t drain(CANRxQueue *rqp, CANRxFrame *crfp, size_t n) {
+  size_t got = 0U, i;
+
+  while (got < n) {
+    i = canReceiveMany(&CAND2, rqp, &crfp[got], n - got, MS2ST(50));
+    if (i == 0U)
+      break;
+    got += i;
+  }
+  return (uint32_t)got;
+}
+
+/*
+ * Counts the frames received by the catch-all queue, returns the number
+ * of frames received.
+ */
+static THD_FUNCTION(receiver, p) {
+  static CANRxFrame batch[CANTEST_BATCH];
+  uint32_t n = 0;
+  size_t i;
+
+  (void)p;
+  chRegSetThreadName("canrx");
+
+  while (n < CANTEST_RATE_FRAMES) {
+    i = canReceiveMany(&CAND2, &queue_any, batch, CANTEST_BATCH, MS2ST(500));
+    if (i == 0U)
+      break;
+    n += (uint32_t)i;
+    batches++;
+  }
+  chThdExit((msg_t)n);
+}
+
+/*
+ * Converts an amount in a rate per second.
+ */
+static uint32_t per_second(uint32_t n, systime_t elapsed) {
+
+  if (elapsed == (systime_t)0)
+    elapsed = (systime_t)1;
+  return (uint32_t)(((uint64_t)n * CH_CFG_ST_FREQUENCY) / elapsed);
+}
+
+/*
+ * Queues a frame from a critical zone, returns true if the frame has been
+ * moved directly into a mailbox.
+ */
+static bool queue_direct(uint32_t id, uint32_t seq) {
+  CANTxFrame txf;
+  size_t full;
+
+  prepare(&txf, CAN_IDE_EXT, id, seq);
+  full = canTxQueueGetFullI(&txqueue);
+  (void)canTransmitI(&CAND1, &txf);
+  return canTxQueueGetFullI(&txqueue) == full;
+}
+
+/*
+ * Checks the arbitration order of the received frames. Frames with the same
+ * identifier must always be received in sequence order, the others in
+ * increasing identifier order except those moved into the mailboxes when
+ * queued, these can win the arbitration before lower identifiers are
+ * moved into a mailbox. Returns the failure message or NULL.
+ */
+static const char *check_order(uint32_t n, const bool *direct) {
+  uint32_t i, j, prev_id;
+
+  prev_id = 0U;
+  for (i = 0; i < n; i++) {
+    uint32_t seq = sequence(&frames[i]);
+
+    for (j = 0; j < i; j++) {
+      if ((frames[j].EID == frames[i].EID) && (sequence(&frames[j]) > seq))
+        return "frame overtaken";
+    }
+    if (direct[seq])
+      continue;
+    if (frames[i].EID < prev_id)
+      return "frame out of order";
+    prev_id = frames[i].EID;
+  }
+  return NULL;
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page test_001_001 Queues setup
+ *
+ * <h2>Description</h2>
+ * The queues are attached to the drivers and the drivers are started.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The receive queues and the acceptance filters are attached to
+ *   @p CAND2.
+ * - The transmit queue is attached to @p CAND1.
+ * - Both drivers are started.
+ * .
+ */
+
+static void test_001_001_execute(void) {
+
+  /* The receive queues and the acceptance filters are attached to
+     CAND2.*/
+  test_set_step(1);
+  {
+    canRxQueueObjectInit(&queue_a, buf_a, CANTEST_ROUTED_SIZE, 1U << 0);
+    canRxQueueObjectInit(&queue_b, buf_b, CANTEST_ROUTED_SIZE, 1U << 1);
+    canRxQueueObjectInit(&queue_any, buf_any, CANTEST_QUEUE_SIZE, 0U);
+    canAddRxQueue(&CAND2, &queue_a);
+    canAddRxQueue(&CAND2, &queue_b);
+    canAddRxQueue(&CAND2, &queue_any);
+    canSetAcceptanceFilters(&CAND2, filters,
+                            sizeof filters / sizeof filters[0]);
+  }
+
+  /* The transmit queue is attached to CAND1.*/
+  test_set_step(2);
+  {
+    canTxQueueObjectInit(&txqueue, buf_tx, CANTEST_TXQ_SIZE);
+    canSetTxQueue(&CAND1, &txqueue);
+  }
+
+  /* Both drivers are started.*/
+  test_set_step(3);
+  {
+    canStart(&CAND2, &cancfg);
+    canStart(&CAND1, &cancfg);
+  }
+}
+
+static const testcase_t test_001_001 = {
+  "Queues setup",
+  NULL,
+  NULL,
+  test_001_001_execute
+};
+
+/**
+ * @page test_001_002 Burst reception
+ *
+ * <h2>Description</h2>
+ * More frames than the controller FIFO can hold are sent back to back
+ * and must all be received, in order.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - @p CANTEST_BURST_FRAMES extended frames are sent.
+ * - The frames are received from the catch-all queue and verified.
+ * - No frames must have been lost.
+ * .
+ */
+
+static void test_001_002_execute(void) {
+  uint32_t i, n;
+
+  /* CANTEST_BURST_FRAMES extended frames are sent.*/
+  test_set_step(1);
+  {
+    for (i = 0; i < CANTEST_BURST_FRAMES; i++)
+      test_assert(!send(CAN_IDE_EXT, 0x1000U + i, i), "transmit timeout");
+  }
+
+  /* The frames are received from the catch-all queue and verified.*/
+  test_set_step(2);
+  {
+    n = drain(&queue_any, frames, CANTEST_BURST_FRAMES);
+    test_assert(n == CANTEST_BURST_FRAMES, "frames not received");
+    for (i = 0; i < n; i++) {
+      test_assert((frames[i].IDE == CAN_IDE_EXT) &&
+                  (frames[i].EID == 0x1000U + i) &&
+                  (sequence(&frames[i]) == i) &&
+                  (frames[i].FMI == 2U),
+                  "frame out of order");
+    }
+  }
+
+  /* No frames must have been lost.*/
+  test_set_step(3);
+  {
+    test_assert((canRxQueueGetOverrunsX(&queue_any) == 0U) &&
+                (CAND2.rxoverruns == 0U),
+                "frames lost");
+  }
+}
+
+static const testcase_t test_001_002 = {
+  "Burst reception",
+  NULL,
+  NULL,
+  test_001_002_execute
+};
+
+/**
+ * @page test_001_003 Routing by acceptance filter
+ *
+ * <h2>Description</h2>
+ * Frames are sent to both the routed queues and to the catch-all queue,
+ * frames not accepted by any filter must not be received.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Four frames are sent for each routed queue, for the catch-all queue
+ *   and with an identifier not accepted by any filter.
+ * - The frames in queue A are verified.
+ * - The frames in queue B are verified.
+ * - The frames in the catch-all queue are verified.
+ * .
+ */
+
+static void test_001_003_execute(void) {
+  uint32_t i, n;
+
+  /* Four frames are sent for each routed queue, for the catch-all queue
+     and with an identifier not accepted by any filter.*/
+  test_set_step(1);
+  {
+    for (i = 0; i < 4U; i++) {
+      test_assert(!send(CAN_IDE_STD, ROUTED_A_ID + i, i) &&
+                  !send(CAN_IDE_STD, ROUTED_B_ID + i, i) &&
+                  !send(CAN_IDE_STD, REJECTED_ID + i, i) &&
+                  !send(CAN_IDE_EXT, ROUTED_A_ID + i, i),
+                  "transmit timeout");
+    }
+  }
+
+  /* The frames in queue A are verified.*/
+  test_set_step(2);
+  {
+    n = drain(&queue_a, frames, CANTEST_BURST_FRAMES);
+    for (i = 0; i < n; i++) {
+      test_assert((frames[i].IDE == CAN_IDE_STD) && (frames[i].FMI == 0U) &&
+                  (frames[i].SID == ROUTED_A_ID + i),
+                  "wrong frame in queue A");
+    }
+    test_assert(n == 4U, "wrong number of frames in queue A");
+  }
+
+  /* The frames in queue B are verified.*/
+  test_set_step(3);
+  {
+    n = drain(&queue_b, frames, CANTEST_BURST_FRAMES);
+    for (i = 0; i < n; i++) {
+      test_assert((frames[i].IDE == CAN_IDE_STD) && (frames[i].FMI == 1U) &&
+                  (frames[i].SID == ROUTED_B_ID + i),
+                  "wrong frame in queue B");
+    }
+    test_assert(n == 4U, "wrong number of frames in queue B");
+  }
+
+  /* The frames in the catch-all queue are verified.*/
+  test_set_step(4);
+  {
+    n = drain(&queue_any, frames, CANTEST_BURST_FRAMES);
+    for (i = 0; i < n; i++) {
+      test_assert((frames[i].IDE == CAN_IDE_EXT) && (frames[i].FMI == 2U) &&
+                  (frames[i].EID == ROUTED_A_ID + i),
+                  "wrong frame in catch-all queue");
+    }
+    test_assert(n == 4U, "wrong number of frames in catch-all queue");
+  }
+}
+
+static const testcase_t test_001_003 = {
+  "Routing by acceptance filter",
+  NULL,
+  NULL,
+  test_001_003_execute
+};
+
+/**
+ * @page test_001_004 Queue overrun
+ *
+ * <h2>Description</h2>
+ * A routed queue is filled beyond its size while nobody is reading, the
+ * excess frames must be counted.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - @p CANTEST_ROUTED_SIZE plus four frames are sent to queue A.
+ * - The frames received and the frames lost are verified.
+ * .
+ */
+
+static void test_001_004_execute(void) {
+  uint32_t i, n;
+
+  /* CANTEST_ROUTED_SIZE plus four frames are sent to queue A.*/
+  test_set_step(1);
+  {
+    for (i = 0; i < CANTEST_ROUTED_SIZE + 4U; i++)
+      test_assert(!send(CAN_IDE_STD, ROUTED_A_ID, i), "transmit timeout");
+
+    /* Leaving time to the last frames to reach the queue.*/
+    chThdSleepMilliseconds(10);
+  }
+
+  /* The frames received and the frames lost are verified.*/
+  test_set_step(2);
+  {
+    n = drain(&queue_a, frames, CANTEST_BURST_FRAMES);
+    test_assert(n == CANTEST_ROUTED_SIZE, "wrong number of frames received");
+    test_assert(canRxQueueGetOverrunsX(&queue_a) == 4U,
+                "wrong number of frames lost");
+    for (i = 0; i < n; i++)
+      test_assert(sequence(&frames[i]) == i, "frame out of order");
+  }
+}
+
+static const testcase_t test_001_004 = {
+  "Queue overrun",
+  NULL,
+  NULL,
+  test_001_004_execute
+};
+
+/**
+ * @page test_001_005 Arbitration order
+ *
+ * <h2>Description</h2>
+ * Frames with decreasing identifiers are queued at once from a critical
+ * zone and must be transmitted in increasing identifier order. The
+ * identifiers are used in pairs, frames with the same identifier must
+ * keep their order. In the second part the mailboxes are filled with
+ * increasing identifiers, then a frame with the same identifier of the
+ * middle mailbox is queued, it must not overtake it when the first
+ * mailbox becomes free.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The mailboxes and the transmit queue are filled, the next frame must
+ *   be refused and counted as an overflow.
+ * - The frames are received and their order is verified.
+ * - The mailboxes are filled with increasing identifiers and a frame
+ *   with the identifier of the middle mailbox is queued.
+ * - The frames are received and their order is verified.
+ * - The maximum depth of the transmit queue is printed.
+ * .
+ */
+
+static void test_001_005_execute(void) {
+  CANTxFrame txf;
+  uint32_t i, n, depth;
+  bool direct[ARBITRATION_FRAMES];
+  bool refused;
+
+  /* The mailboxes and the transmit queue are filled, the next frame must
+     be refused and counted as an overflow.*/
+  test_set_step(1);
+  {
+    chSysLock();
+    for (i = 0; i < ARBITRATION_FRAMES; i++) {
+      if (canTxQueueGetFullI(&txqueue) >= CANTEST_TXQ_SIZE)
+        break;
+      direct[i] = queue_direct(ARBITRATION_ID +
+                               ((ARBITRATION_FRAMES - 1U - i) / 2U), i);
+    }
+    prepare(&txf, CAN_IDE_EXT, ARBITRATION_ID, i);
+    refused = canTransmitI(&CAND1, &txf);
+    depth = (uint32_t)canTxQueueGetMaxDepthX(&txqueue);
+    chSysUnlock();
+
+    test_assert(i == ARBITRATION_FRAMES, "queue full too early");
+    test_assert(refused, "frame accepted by a full queue");
+    test_assert(canTxQueueGetOverflowsX(&txqueue) == 1U,
+                "overflow not counted");
+  }
+
+  /* The frames are received and their order is verified.*/
+  test_set_step(2);
+  {
+    const char *err;
+
+    n = drain(&queue_any, frames, ARBITRATION_FRAMES);
+    test_assert(n == ARBITRATION_FRAMES, "wrong number of frames received");
+    err = check_order(n, direct);
+    test_assert(err == NULL, err);
+  }
+
+  /* The mailboxes are filled with increasing identifiers and a frame
+     with the identifier of the middle mailbox is queued.*/
+  test_set_step(3);
+  {
+    chSysLock();
+    for (i = 0; i < CAN_TX_MAILBOXES; i++)
+      direct[i] = queue_direct(ARBITRATION_ID + i, i);
+    direct[i] = queue_direct(ARBITRATION_ID + (CAN_TX_MAILBOXES / 2U), i);
+    chSysUnlock();
+  }
+
+  /* The frames are received and their order is verified.*/
+  test_set_step(4);
+  {
+    const char *err;
+
+    n = drain(&queue_any, frames, CAN_TX_MAILBOXES + 1U);
+    test_assert(n == CAN_TX_MAILBOXES + 1U,
+                "wrong number of frames received");
+    err = check_order(n, direct);
+    test_assert(err == NULL, err);
+  }
+
+  /* The maximum depth of the transmit queue is printed.*/
+  test_set_step(5);
+  {
+    test_print("--- Depth : ");
+    test_printn(depth);
+    test_println(" frames max");
+  }
+}
+
+static const testcase_t test_001_005 = {
+  "Arbitration order",
+  NULL,
+  NULL,
+  test_001_005_execute
+};
+
+/**
+ * @page test_001_006 Throughput
+ *
+ * <h2>Description</h2>
+ * @p CANTEST_RATE_FRAMES frames are sent back to back and received in
+ * batches of up to @p CANTEST_BATCH frames by a thread.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The receiver thread is started and the frames are sent.
+ * - The frames received are verified.
+ * - The score and the maximum depth of the transmit queue are printed.
+ * .
+ */
+
+static void test_001_006_execute(void) {
+  thread_t *tp;
+  systime_t start, elapsed;
+  uint32_t n, sent = 0;
+
+  /* The receiver thread is started and the frames are sent.*/
+  test_set_step(1);
+  {
+    batches = 0;
+    tp = chThdCreateStatic(wa_receiver, sizeof wa_receiver,
+                           chThdGetPriorityX() + 1, receiver, NULL);
+    start = chVTGetSystemTimeX();
+    while (sent < CANTEST_RATE_FRAMES) {
+      if (send(CAN_IDE_EXT, sent & 0x1FFFFFFFU, sent))
+        break;
+      sent++;
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    }
+    n = (uint32_t)chThdWait(tp);
+    elapsed = chVTTimeElapsedSinceX(start);
+  }
+
+  /* The frames received are verified.*/
+  test_set_step(2);
+  {
+    test_assert(sent == CANTEST_RATE_FRAMES, "transmit timeout");
+    test_assert(n == CANTEST_RATE_FRAMES, "frames not received");
+  }
+
+  /* The score and the maximum depth of the transmit queue are printed.*/
+  test_set_step(3);
+  {
+    test_print("--- Score : ");
+    test_printn(per_second(n, elapsed));
+    test_print(" frames/S, ");
+    test_printn(n / (batches > 0U ? batches : 1U));
+    test_println(" frames per batch");
+    test_print("--- Depth : ");
+    test_printn((uint32_t)canTxQueueGetMaxDepthX(&txqueue));
+    test_println(" frames max");
+  }
+}
+
+static const testcase_t test_001_006 = {
+  "Throughput",
+  NULL,
+  NULL,
+  test_001_006_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   CAN Queues.
+ */
+const testcase_t * const test_sequence_001[] = {
+  &test_001_001,
+  &test_001_002,
+  &test_001_003,
+  &test_001_004,
+  &test_001_005,
+  &test_001_006,
+  NULL
+};
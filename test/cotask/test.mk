@@ -0,0 +1,21 @@
+# C++ wrappers.
+include ${CHIBIOS}/os/various/cpp_wrappers/chcpp.mk
+
+# List of all the stackless tasks test files.
+TESTSRC = ${CHIBIOS}/test/lib/ch_test.c \
+          ${CHIBIOS}/test/cotask/test_root.c \
+          ${CHIBIOS}/test/cotask/test_sequence_001.c \
+          ${CHIBIOS}/os/various/cotask.c
+
+TESTCPPSRC = ${CHIBIOS}/os/various/cpp_wrappers/ch.cpp \
+             ${CHIBIOS}/test/cotask/test_sequence_002.cpp
+
+# Required include directories
+TESTINC = ${CHIBIOS}/test/lib \
+          ${CHIBIOS}/test/cotask \
+          ${CHCPPINC}
+
+# Required settings, the C++20 coroutines require a g++ version 10 or
+# later.
+TESTDEFS = -DCH_DBG_SYSTEM_STATE_CHECK=TRUE -DCH_CFG_USE_SEMAPHORES_NOTIFY=TRUE
+TESTCPPOPT = -std=gnu++20
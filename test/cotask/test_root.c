@@ -0,0 +1,100 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    test_root.c
+ * @brief   Test Suite root structures code.
+ *
+ * @addtogroup CH_TEST_ROOT
+ * @{
+ */
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Array of all the test sequences.
+ */
+const testcase_t * const *test_suite[] = {
+  test_sequence_001,
+  test_sequence_002,
+  NULL
+};
+
+/*===========================================================================*/
+/* Shared code.                                                              */
+/*===========================================================================*/
+
+/*
+ * Benchmarks state, each benchmark lasts one second and counts the
+ * operations performed by its tasks, coroutines or threads.
+ */
+volatile bool cotask_bench_done;
+uint32_t cotask_bench_count;
+
+static virtual_timer_t bench_timer;
+static semaphore_t bench_sem;
+
+static void bench_cb(void *p) {
+
+  (void)p;
+  chSysLockFromISR();
+  cotask_bench_done = true;
+  chSemSignalI(&bench_sem);
+  chSysUnlockFromISR();
+}
+
+/*
+ * Starts a one second benchmark.
+ */
+void cotask_bench_start(void) {
+
+  chSemObjectInit(&bench_sem, 0);
+  cotask_bench_count = 0U;
+  cotask_bench_done = false;
+  chThdSleep(1);
+  chVTSet(&bench_timer, MS2ST(1000), bench_cb, NULL);
+}
+
+/*
+ * Waits for the end of a benchmark and, if specified, of the tasks of
+ * the executor running it.
+ */
+void cotask_bench_wait(co_executor_t *exp) {
+
+  chSemWait(&bench_sem);
+  if (exp != NULL) {
+    while (exp->tasks > (cnt_t)0)
+      chThdSleepMilliseconds(1);
+  }
+}
+
+/*
+ * Prints the score of a benchmark.
+ */
+void cotask_print_score(const char *what) {
+
+  test_print("--- Score : ");
+  test_printn(cotask_bench_count);
+  test_println(what);
+}
+
+/** @} */
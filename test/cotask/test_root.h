@@ -0,0 +1,85 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    test_root.h
+ * @brief   Test Suite root structures header.
+ *
+ * @addtogroup CH_TEST_ROOT
+ * @{
+ */
+
+#ifndef _TEST_ROOT_H_
+#define _TEST_ROOT_H_
+
+#include "ch.h"
+#include "hal.h"
+#include "cotask.h"
+
+#include "test_sequence_001.h"
+#include "test_sequence_002.h"
+
+/*===========================================================================*/
+/* Default definitions.                                                      */
+/*===========================================================================*/
+
+/* Global test suite name, it is printed on top of the test
+   report header.*/
+#define TEST_SUITE_NAME                     "Stackless Tasks Test Suite"
+
+/**
+ * @brief   Number of tasks, threads or coroutines in the yield benchmarks.
+ */
+#if !defined(COTASKTEST_TASKS) || defined(__DOXYGEN__)
+#define COTASKTEST_TASKS                    4U
+#endif
+
+/**
+ * @brief   Stack size of the executors and of the benchmark threads.
+ */
+#if !defined(COTASKTEST_STACK_SIZE) || defined(__DOXYGEN__)
+#define COTASKTEST_STACK_SIZE               256
+#endif
+
+#if !CH_CFG_USE_SEMAPHORES_NOTIFY || !CH_CFG_USE_MAILBOXES
+#error "the stackless tasks test requires semaphores notification and mailboxes"
+#endif
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+extern const testcase_t * const *test_suite[];
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  extern volatile bool cotask_bench_done;
+  extern uint32_t cotask_bench_count;
+  void cotask_bench_start(void);
+  void cotask_bench_wait(co_executor_t *exp);
+  void cotask_print_score(const char *what);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Shared definitions.                                                       */
+/*===========================================================================*/
+
+#endif /* _TEST_ROOT_H_ */
+
+/** @} */
@@ -0,0 +1,681 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+/**
+ * @page test_sequence_001 Stackless Tasks
+ *
+ * File: @ref test_sequence_001.c
+ *
+ * <h2>Description</h2>
+ * This sequence checks the services of the stackless tasks executor,
+ * then the memory used by each task and the switch rates are compared
+ * with the equivalent threads. The functional tests run on an executor
+ * thread started by the first test case, the benchmarks last one second
+ * each.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_001_001
+ * - @subpage test_001_002
+ * - @subpage test_001_003
+ * - @subpage test_001_004
+ * - @subpage test_001_005
+ * - @subpage test_001_006
+ * - @subpage test_001_007
+ * - @subpage test_001_008
+ * - @subpage test_001_009
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define TASKS               COTASKTEST_TASKS
+#define MB_SIZE             2U
+#define MB_MESSAGES         6U
+
+/*
+ * Task structure with the state preserved across the waiting points.
+ */
+typedef struct {
+  co_task_t             task;
+  unsigned              id;
+  systime_t             delay;
+  unsigned              i;
+  msg_t                 msg;
+} test_task_t;
+
+static THD_WORKING_AREA(wa_executor, COTASKTEST_STACK_SIZE);
+static THD_WORKING_AREA(wa_threads[TASKS], COTASKTEST_STACK_SIZE);
+static co_executor_t executor;
+static test_task_t tasks[TASKS];
+static thread_t *threads[TASKS];
+static semaphore_t sem1, sem2;
+static mailbox_t mb;
+static msg_t mb_buffer[MB_SIZE];
+static unsigned norder;
+static unsigned order[TASKS];
+static msg_t received[MB_MESSAGES];
+static systime_t elapsed[TASKS];
+static systime_t start;
+
+/*
+ * Waits for the termination of all the tasks of the executor.
+ */
+static void wait_tasks(void) {
+
+  while (executor.tasks > (cnt_t)0)
+    chThdSleepMilliseconds(1);
+}
+
+static costate_t sleeper(co_task_t *ctp) {
+  test_task_t *ttp = (test_task_t *)ctp;
+
+  CO_BEGIN(ctp);
+  CO_SLEEP(ctp, ttp->delay);
+  elapsed[norder] = chVTTimeElapsedSinceX(start);
+  order[norder++] = ttp->id;
+  CO_END(ctp);
+}
+
+static costate_t sem_waiter(co_task_t *ctp) {
+
+  CO_BEGIN(ctp);
+  CO_SEM_WAIT(ctp, &sem1, MS2ST(5));
+  elapsed[0] = chVTTimeElapsedSinceX(start);
+  received[0] = coTaskGetResultX(ctp);
+  CO_SEM_WAIT(ctp, &sem1, MS2ST(100));
+  elapsed[1] = chVTTimeElapsedSinceX(start);
+  received[1] = coTaskGetResultX(ctp);
+  CO_END(ctp);
+}
+
+static costate_t evt_waiter(co_task_t *ctp) {
+  test_task_t *ttp = (test_task_t *)ctp;
+
+  CO_BEGIN(ctp);
+  CO_EVT_WAIT(ctp, EVENT_MASK(0) | EVENT_MASK(1), ttp->delay);
+  order[ttp->id] = (unsigned)coTaskGetEventsX(ctp);
+  CO_END(ctp);
+}
+
+static costate_t producer(co_task_t *ctp) {
+  test_task_t *ttp = (test_task_t *)ctp;
+
+  CO_BEGIN(ctp);
+  for (ttp->i = 0U; ttp->i < MB_MESSAGES; ttp->i++) {
+    CO_MB_POST(ctp, &mb, (msg_t)ttp->i, TIME_INFINITE);
+  }
+  CO_END(ctp);
+}
+
+static costate_t consumer(co_task_t *ctp) {
+  test_task_t *ttp = (test_task_t *)ctp;
+
+  CO_BEGIN(ctp);
+  while (norder < MB_MESSAGES) {
+    CO_MB_FETCH(ctp, &mb, &ttp->msg, TIME_INFINITE);
+    received[norder++] = ttp->msg;
+    if (norder == MB_SIZE)
+      CO_SLEEP(ctp, MS2ST(2));
+  }
+  CO_END(ctp);
+}
+
+static costate_t yield_task(co_task_t *ctp) {
+
+  CO_BEGIN(ctp);
+  while (!cotask_bench_done) {
+    cotask_bench_count++;
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+    CO_YIELD(ctp);
+  }
+  CO_END(ctp);
+}
+
+static THD_FUNCTION(yield_thread, p) {
+
+  (void)p;
+  while (!cotask_bench_done) {
+    cotask_bench_count++;
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+    chThdYield();
+  }
+}
+
+static costate_t ping_task(co_task_t *ctp) {
+
+  CO_BEGIN(ctp);
+  while (true) {
+    CO_SEM_WAIT(ctp, &sem1, TIME_INFINITE);
+    if (cotask_bench_done)
+      CO_EXIT(ctp);
+    chSemSignal(&sem2);
+  }
+  CO_END(ctp);
+}
+
+static costate_t pong_task(co_task_t *ctp) {
+
+  CO_BEGIN(ctp);
+  while (!cotask_bench_done) {
+    chSemSignal(&sem1);
+    CO_SEM_WAIT(ctp, &sem2, TIME_INFINITE);
+    cotask_bench_count++;
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  }
+  chSemSignal(&sem1);
+  CO_END(ctp);
+}
+
+static THD_FUNCTION(ping_thread, p) {
+
+  (void)p;
+  while (true) {
+    chSemWait(&sem1);
+    if (cotask_bench_done)
+      break;
+    chSemSignal(&sem2);
+  }
+}
+
+static THD_FUNCTION(pong_thread, p) {
+
+  (void)p;
+  while (!cotask_bench_done) {
+    chSemSignal(&sem1);
+    chSemWait(&sem2);
+    cotask_bench_count++;
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  }
+  chSemSignal(&sem1);
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page test_001_001 Sleep ordering
+ *
+ * <h2>Description</h2>
+ * Four tasks sleep with different delays, they must be resumed in
+ * deadline order and not before their delay.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The tasks are started and their termination is waited for.
+ * - The wakeup order and times are verified.
+ * .
+ */
+
+static void test_001_001_setup(void) {
+
+  coExecutorObjectInit(&executor);
+  coExecutorStart(&executor, wa_executor, sizeof wa_executor,
+                  chThdGetPriorityX() - 1);
+}
+
+static void test_001_001_execute(void) {
+  static const systime_t delays[4] = {MS2ST(30), MS2ST(10),
+                                      MS2ST(20), MS2ST(10)};
+  static const unsigned expected[4] = {1U, 3U, 2U, 0U};
+  unsigned i;
+
+  /* The tasks are started and their termination is waited for.*/
+  test_set_step(1);
+  {
+    norder = 0U;
+    start = chVTGetSystemTime();
+    for (i = 0U; i < 4U; i++) {
+      tasks[i].id    = i;
+      tasks[i].delay = delays[i];
+      coTaskStart(&executor, &tasks[i].task, sleeper, NULL);
+    }
+    wait_tasks();
+  }
+
+  /* The wakeup order and times are verified.*/
+  test_set_step(2);
+  {
+    for (i = 0U; i < 4U; i++) {
+      test_assert(order[i] == expected[i], "wrong wakeup order");
+      test_assert(elapsed[i] >= delays[expected[i]], "early wakeup");
+    }
+  }
+}
+
+static const testcase_t test_001_001 = {
+  "Sleep ordering",
+  test_001_001_setup,
+  NULL,
+  test_001_001_execute
+};
+
+/**
+ * @page test_001_002 Semaphore wait
+ *
+ * <h2>Description</h2>
+ * A semaphore wait must timeout and then be satisfied by a signal from a
+ * thread, the signal alone must wake up the executor.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The task is started, the semaphore is signaled after its first
+ *   wait timed out.
+ * - The first wait must have timed out after its timeout.
+ * - The second wait must have been satisfied by the signal, the signal
+ *   must have been consumed.
+ * .
+ */
+
+static void test_001_002_setup(void) {
+
+  chSemObjectInit(&sem1, 0);
+}
+
+static void test_001_002_execute(void) {
+
+  /* The task is started, the semaphore is signaled after its first wait
+     timed out.*/
+  test_set_step(1);
+  {
+    start = chVTGetSystemTime();
+    coTaskStart(&executor, &tasks[0].task, sem_waiter, NULL);
+    chThdSleepMilliseconds(20);
+    chSemSignal(&sem1);
+    wait_tasks();
+  }
+
+  /* The first wait must have timed out after its timeout.*/
+  test_set_step(2);
+  {
+    test_assert((received[0] == MSG_TIMEOUT) && (elapsed[0] >= MS2ST(5)),
+                "wrong timeout");
+  }
+
+  /* The second wait must have been satisfied by the signal, the signal
+     must have been consumed.*/
+  test_set_step(3);
+  {
+    test_assert((received[1] == MSG_OK) && (elapsed[1] >= MS2ST(10)) &&
+                (elapsed[1] <= MS2ST(30)), "signal not received");
+    test_assert(chSemWaitTimeout(&sem1, TIME_IMMEDIATE) == MSG_TIMEOUT,
+                "signal not consumed");
+  }
+}
+
+static const testcase_t test_001_002 = {
+  "Semaphore wait",
+  test_001_002_setup,
+  NULL,
+  test_001_002_execute
+};
+
+/**
+ * @page test_001_003 Events
+ *
+ * <h2>Description</h2>
+ * The events signaled to the executor thread must be delivered to all
+ * the waiting tasks, a task waiting with a timeout must timeout.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Three tasks are started, an event is signaled to the executor
+ *   thread after the timeout of the third task.
+ * - The events received by the tasks are verified.
+ * .
+ */
+
+static void test_001_003_execute(void) {
+  unsigned i;
+
+  /* Three tasks are started, an event is signaled to the executor thread
+     after the timeout of the third task.*/
+  test_set_step(1);
+  {
+    for (i = 0U; i < 3U; i++) {
+      tasks[i].id    = i;
+      tasks[i].delay = i < 2U ? TIME_INFINITE : MS2ST(5);
+      coTaskStart(&executor, &tasks[i].task, evt_waiter, NULL);
+    }
+    chThdSleepMilliseconds(10);
+    chEvtSignal(coExecutorGetThreadX(&executor), EVENT_MASK(1));
+    wait_tasks();
+  }
+
+  /* The events received by the tasks are verified.*/
+  test_set_step(2);
+  {
+    test_assert((order[0] == EVENT_MASK(1)) && (order[1] == EVENT_MASK(1)),
+                "event not delivered");
+    test_assert(order[2] == 0U, "no timeout");
+  }
+}
+
+static const testcase_t test_001_003 = {
+  "Events",
+  NULL,
+  NULL,
+  test_001_003_execute
+};
+
+/**
+ * @page test_001_004 Mailbox
+ *
+ * <h2>Description</h2>
+ * The messages posted into a mailbox smaller than the number of messages
+ * must be fetched in order.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The producer and consumer tasks are started and their termination
+ *   is waited for.
+ * - The messages order is verified.
+ * .
+ */
+
+static void test_001_004_setup(void) {
+
+  chMBObjectInit(&mb, mb_buffer, MB_SIZE);
+}
+
+static void test_001_004_execute(void) {
+  unsigned i;
+
+  /* The producer and consumer tasks are started and their termination
+     is waited for.*/
+  test_set_step(1);
+  {
+    norder = 0U;
+    coTaskStart(&executor, &tasks[0].task, producer, NULL);
+    coTaskStart(&executor, &tasks[1].task, consumer, NULL);
+    wait_tasks();
+  }
+
+  /* The messages order is verified.*/
+  test_set_step(2);
+  {
+    for (i = 0U; i < MB_MESSAGES; i++)
+      test_assert(received[i] == (msg_t)i, "wrong message");
+  }
+}
+
+static const testcase_t test_001_004 = {
+  "Mailbox",
+  test_001_004_setup,
+  NULL,
+  test_001_004_execute
+};
+
+/**
+ * @page test_001_005 Memory usage
+ *
+ * <h2>Description</h2>
+ * The size of a @p co_task_t structure is compared with the size of the
+ * working area of the benchmark threads, see @p COTASKTEST_STACK_SIZE.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The sizes are printed.
+ * .
+ */
+
+static void test_001_005_execute(void) {
+
+  /* The sizes are printed.*/
+  test_set_step(1);
+  {
+    test_print("--- Memory : ");
+    test_printn(sizeof (co_task_t));
+    test_print(" bytes per task, ");
+    test_printn(sizeof wa_threads[0]);
+    test_println(" bytes per thread");
+  }
+}
+
+static const testcase_t test_001_005 = {
+  "Memory usage",
+  NULL,
+  NULL,
+  test_001_005_execute
+};
+
+/**
+ * @page test_001_006 Yields, tasks
+ *
+ * <h2>Description</h2>
+ * A ring of @p COTASKTEST_TASKS tasks yields for one second.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The tasks are started and the benchmark is waited for.
+ * - The score is printed.
+ * .
+ */
+
+static void test_001_006_execute(void) {
+  unsigned i;
+
+  /* The tasks are started and the benchmark is waited for.*/
+  test_set_step(1);
+  {
+    cotask_bench_start();
+    for (i = 0U; i < TASKS; i++)
+      coTaskStart(&executor, &tasks[i].task, yield_task, NULL);
+    cotask_bench_wait(&executor);
+  }
+
+  /* The score is printed.*/
+  test_set_step(2);
+  {
+    cotask_print_score(" yields/S");
+  }
+}
+
+static const testcase_t test_001_006 = {
+  "Yields, tasks",
+  NULL,
+  NULL,
+  test_001_006_execute
+};
+
+/**
+ * @page test_001_007 Yields, threads
+ *
+ * <h2>Description</h2>
+ * A ring of @p COTASKTEST_TASKS threads yields for one second.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The threads are started and the benchmark is waited for.
+ * - The score is printed.
+ * .
+ */
+
+static void test_001_007_execute(void) {
+  unsigned i;
+
+  /* The threads are started and the benchmark is waited for.*/
+  test_set_step(1);
+  {
+    cotask_bench_start();
+    for (i = 0U; i < TASKS; i++)
+      threads[i] = chThdCreateStatic(wa_threads[i], sizeof wa_threads[i],
+                                     chThdGetPriorityX() - 1,
+                                     yield_thread, NULL);
+    cotask_bench_wait(NULL);
+    for (i = 0U; i < TASKS; i++)
+      chThdWait(threads[i]);
+  }
+
+  /* The score is printed.*/
+  test_set_step(2);
+  {
+    cotask_print_score(" yields/S");
+  }
+}
+
+static const testcase_t test_001_007 = {
+  "Yields, threads",
+  NULL,
+  NULL,
+  test_001_007_execute
+};
+
+/**
+ * @page test_001_008 Ping-pong, tasks
+ *
+ * <h2>Description</h2>
+ * Two tasks exchange two semaphores for one second.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The tasks are started and the benchmark is waited for.
+ * - The score is printed.
+ * .
+ */
+
+static void test_001_008_setup(void) {
+
+  chSemObjectInit(&sem1, 0);
+  chSemObjectInit(&sem2, 0);
+}
+
+static void test_001_008_execute(void) {
+
+  /* The tasks are started and the benchmark is waited for.*/
+  test_set_step(1);
+  {
+    cotask_bench_start();
+    coTaskStart(&executor, &tasks[0].task, ping_task, NULL);
+    coTaskStart(&executor, &tasks[1].task, pong_task, NULL);
+    cotask_bench_wait(&executor);
+  }
+
+  /* The score is printed.*/
+  test_set_step(2);
+  {
+    cotask_print_score(" ping-pong/S");
+  }
+}
+
+static const testcase_t test_001_008 = {
+  "Ping-pong, tasks",
+  test_001_008_setup,
+  NULL,
+  test_001_008_execute
+};
+
+/**
+ * @page test_001_009 Ping-pong, threads
+ *
+ * <h2>Description</h2>
+ * Two threads exchange two semaphores for one second.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The threads are started and the benchmark is waited for.
+ * - The score is printed.
+ * .
+ */
+
+static void test_001_009_setup(void) {
+
+  chSemObjectInit(&sem1, 0);
+  chSemObjectInit(&sem2, 0);
+}
+
+static void test_001_009_execute(void) {
+
+  /* The threads are started and the benchmark is waited for.*/
+  test_set_step(1);
+  {
+    cotask_bench_start();
+    threads[0] = chThdCreateStatic(wa_threads[0], sizeof wa_threads[0],
+                                   chThdGetPriorityX() - 1,
+                                   ping_thread, NULL);
+    threads[1] = chThdCreateStatic(wa_threads[1], sizeof wa_threads[1],
+                                   chThdGetPriorityX() - 1,
+                                   pong_thread, NULL);
+    cotask_bench_wait(NULL);
+    chThdWait(threads[0]);
+    chThdWait(threads[1]);
+  }
+
+  /* The score is printed.*/
+  test_set_step(2);
+  {
+    cotask_print_score(" ping-pong/S");
+  }
+}
+
+static const testcase_t test_001_009 = {
+  "Ping-pong, threads",
+  test_001_009_setup,
+  NULL,
+  test_001_009_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Stackless Tasks.
+ */
+const testcase_t * const test_sequence_001[] = {
+  &test_001_001,
+  &test_001_002,
+  &test_001_003,
+  &test_001_004,
+  &test_001_005,
+  &test_001_006,
+  &test_001_007,
+  &test_001_008,
+  &test_001_009,
+  NULL
+};
@@ -0,0 +1,314 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "cotask.hpp"
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+using namespace chibios_rt;
+
+/**
+ * @page test_sequence_002 C++20 Coroutines
+ *
+ * File: @ref test_sequence_002.cpp
+ *
+ * <h2>Description</h2>
+ * This sequence repeats the semaphores, mailbox and events checks using
+ * the awaitables in cotask.hpp, then the coroutines are compared with the
+ * stackless tasks. The coroutines run on a second executor thread
+ * started by the first test case, the frames are allocated from the
+ * heap.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_002_001
+ * - @subpage test_002_002
+ * - @subpage test_002_003
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define PINGPONGS           100U
+#define ITEMS               6U
+#define FRAMES_SIZE         1024U
+
+static THD_WORKING_AREA(wa_executor, COTASKTEST_STACK_SIZE);
+static CoExecutor executor;
+static CounterSemaphore sem1(0), sem2(0);
+static uint32_t items[ITEMS];
+static Mailbox<uint32_t *, 2> mbox;
+static unsigned pingpongs, received;
+static size_t before;
+static bool failed;
+
+/*
+ * Free memory in the heap and in the core allocator, the frames allocated
+ * from the core are returned to the heap.
+ */
+static size_t free_memory(void) {
+  size_t size;
+
+  (void)chHeapStatus(NULL, &size, NULL);
+  return size + chCoreGetStatusX();
+}
+
+/*
+ * Waits for the termination of all the executor coroutines.
+ */
+static void wait_tasks(void) {
+
+  while (executor.exec.tasks > (cnt_t)0)
+    chThdSleepMilliseconds(1);
+}
+
+static CoTask ping(unsigned n) {
+
+  for (unsigned i = 0U; i < n; i++) {
+    if (co_await CoSemWait(sem1, MS2ST(100)) != MSG_OK)
+      failed = true;
+    pingpongs++;
+    sem2.signal();
+  }
+}
+
+static CoTask pong(unsigned n) {
+
+  for (unsigned i = 0U; i < n; i++) {
+    sem1.signal();
+    if (co_await CoSemWait(sem2, MS2ST(100)) != MSG_OK)
+      failed = true;
+    pingpongs++;
+  }
+}
+
+static CoTask producer(void) {
+
+  for (unsigned i = 0U; i < ITEMS; i++) {
+    items[i] = i;
+    if (co_await CoMBPost<uint32_t *>(mbox, &items[i], TIME_INFINITE) != MSG_OK)
+      failed = true;
+  }
+}
+
+static CoTask consumer(void) {
+  uint32_t *itemp;
+
+  while (received < ITEMS) {
+    if ((co_await CoMBFetch<uint32_t *>(mbox, &itemp,
+                                        TIME_INFINITE) != MSG_OK) ||
+        (*itemp != received))
+      failed = true;
+    received++;
+    if (received == 2U)
+      co_await CoSleep(MS2ST(2));
+  }
+}
+
+static CoTask waiter(void) {
+  systime_t start = chVTGetSystemTime();
+
+  if ((co_await CoEvtWait(EVENT_MASK(0), MS2ST(5)) != (eventmask_t)0) ||
+      (chVTTimeElapsedSinceX(start) < MS2ST(5)))
+    failed = true;
+  if (co_await CoEvtWait(EVENT_MASK(0), TIME_INFINITE) != EVENT_MASK(0))
+    failed = true;
+}
+
+static CoTask yielder(void) {
+
+  while (!cotask_bench_done) {
+    cotask_bench_count++;
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+    co_await CoYield();
+  }
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page test_002_001 Semaphores, mailbox and events
+ *
+ * <h2>Description</h2>
+ * Two coroutines exchange two semaphores, a producer and a consumer
+ * exchange messages through a mailbox smaller than the number of
+ * messages and a coroutine waits for an event first with a timeout and
+ * then without. The memory used by the coroutine frames must be returned
+ * to the heap.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The coroutines are spawned, the event is signaled to the executor
+ *   thread after the timeout of the first wait, the termination of the
+ *   coroutines is waited for.
+ * - The ping-pongs, the messages and the waits are verified.
+ * - The memory used by the frames must have been returned.
+ * .
+ */
+
+static void test_002_001_setup(void) {
+  void *p;
+
+  executor.start(wa_executor, sizeof wa_executor, chThdGetPriorityX() - 1);
+
+  /* The heap is grown before the measurement, a block taken from the core
+     allocator loses its header when it is returned to the heap.*/
+  p = chHeapAlloc(NULL, FRAMES_SIZE);
+  if (p != NULL)
+    chHeapFree(p);
+  before = free_memory();
+}
+
+static void test_002_001_execute(void) {
+
+  /* The coroutines are spawned, the event is signaled to the executor
+     thread after the timeout of the first wait, the termination of the
+     coroutines is waited for.*/
+  test_set_step(1);
+  {
+    failed = !executor.spawn(ping(PINGPONGS)) ||
+             !executor.spawn(pong(PINGPONGS)) ||
+             !executor.spawn(producer()) ||
+             !executor.spawn(consumer()) ||
+             !executor.spawn(waiter());
+    test_assert(!failed, "spawn failed");
+    chThdSleepMilliseconds(10);
+    chEvtSignal(coExecutorGetThreadX(&executor.exec), EVENT_MASK(0));
+    wait_tasks();
+  }
+
+  /* The ping-pongs, the messages and the waits are verified.*/
+  test_set_step(2);
+  {
+    test_assert(!failed, "wait failed");
+    test_assert(pingpongs == 2U * PINGPONGS, "wrong ping-pongs");
+    test_assert(received == ITEMS, "wrong messages");
+  }
+
+  /* The memory used by the frames must have been returned.*/
+  test_set_step(3);
+  {
+    test_assert(free_memory() == before, "frames not freed");
+  }
+}
+
+static const testcase_t test_002_001 = {
+  "Semaphores, mailbox and events",
+  test_002_001_setup,
+  NULL,
+  test_002_001_execute
+};
+
+/**
+ * @page test_002_002 Memory usage
+ *
+ * <h2>Description</h2>
+ * The size of the frame of the benchmark coroutine is measured, the heap
+ * block header is included.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The coroutine is created without running it and the size is
+ *   printed.
+ * .
+ */
+
+static void test_002_002_execute(void) {
+
+  /* The coroutine is created without running it and the size is
+     printed.*/
+  test_set_step(1);
+  {
+    size_t size = free_memory();
+    CoTask task = yielder();
+
+    size -= free_memory();
+    test_print("--- Memory : ");
+    test_printn(size);
+    test_println(" bytes per coroutine");
+  }
+}
+
+static const testcase_t test_002_002 = {
+  "Memory usage",
+  NULL,
+  NULL,
+  test_002_002_execute
+};
+
+/**
+ * @page test_002_003 Yields, coroutines
+ *
+ * <h2>Description</h2>
+ * A ring of @p COTASKTEST_TASKS coroutines yields for one second.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The coroutines are spawned and the benchmark is waited for.
+ * - The score is printed.
+ * .
+ */
+
+static void test_002_003_execute(void) {
+
+  /* The coroutines are spawned and the benchmark is waited for.*/
+  test_set_step(1);
+  {
+    cotask_bench_start();
+    for (unsigned i = 0U; i < COTASKTEST_TASKS; i++)
+      (void)executor.spawn(yielder());
+    cotask_bench_wait(&executor.exec);
+  }
+
+  /* The score is printed.*/
+  test_set_step(2);
+  {
+    cotask_print_score(" yields/S");
+  }
+}
+
+static const testcase_t test_002_003 = {
+  "Yields, coroutines",
+  NULL,
+  NULL,
+  test_002_003_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   C++20 Coroutines.
+ */
+const testcase_t * const test_sequence_002[] = {
+  &test_002_001,
+  &test_002_002,
+  &test_002_003,
+  NULL
+};
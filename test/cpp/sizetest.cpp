@@ -0,0 +1,171 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+/**
+ * @file    sizetest.cpp
+ * @brief   C++ wrapper zero overhead test.
+ * @details Each @p c_ function is implemented using the C API, the
+ *          matching @p cpp_ function implements the same sequence using
+ *          the C++ wrapper classes. The two functions are expected to
+ *          compile to code of the same size.
+ *
+ * @addtogroup cpp_test
+ * @{
+ */
+
+#include <utility>
+
+#include "ch.hpp"
+
+using namespace chibios_rt;
+
+/*
+ * Pool object with a non trivial constructor.
+ */
+struct Item {
+  uint32_t a, b;
+
+  Item(uint32_t v) : a(v), b(~v) {
+  }
+};
+
+/*
+ * C equivalent of an objects mailbox, the mailbox is associated to the
+ * pool of the exchanged objects.
+ */
+struct c_objects_mailbox {
+  mailbox_t     mb;
+  msg_t         buf[4];
+  memory_pool_t *pool;
+};
+
+/*
+ * Opaque function, it prevents the compiler from removing the code under
+ * test.
+ */
+extern void use(void *p);
+
+extern "C" {
+
+void c_syslock(void) {
+
+  chSysLock();
+  use(NULL);
+  chSysUnlock();
+}
+
+void cpp_syslock(void) {
+  SysLocker lock;
+
+  use(NULL);
+}
+
+void c_critical(void) {
+  syssts_t sts = chSysGetStatusAndLockX();
+
+  use(NULL);
+  chSysRestoreStatusX(sts);
+}
+
+void cpp_critical(void) {
+  CriticalSectionLocker lock;
+
+  use(NULL);
+}
+
+void c_mutex(Mutex &m) {
+
+  chMtxLock(&m.mutex);
+  use(NULL);
+  chMtxUnlock(&m.mutex);
+}
+
+void cpp_mutex(Mutex &m) {
+  MutexLocker lock(m);
+
+  use(NULL);
+}
+
+void c_pool(ObjectsPool<Item, 4> &pool, uint32_t v) {
+  void *p = chPoolAlloc(&pool.pool);
+
+  if (p != NULL) {
+    Item *ip = new (p) Item(v);
+
+    use(ip);
+    ip->~Item();
+    chPoolFree(&pool.pool, ip);
+  }
+}
+
+void cpp_pool(ObjectsPool<Item, 4> &pool, uint32_t v) {
+  PoolObject<Item> obj = pool.make(v);
+
+  if (obj)
+    use(obj.get());
+}
+
+msg_t c_post(ObjectsPool<Item, 4> &pool, c_objects_mailbox &mbox,
+             uint32_t v) {
+  void *p = chPoolAlloc(&pool.pool);
+  msg_t msg = MSG_TIMEOUT;
+
+  if (p != NULL) {
+    Item *ip = new (p) Item(v);
+
+    msg = chMBPost(&mbox.mb, reinterpret_cast<msg_t>(ip), TIME_INFINITE);
+    if (msg != MSG_OK) {
+      ip->~Item();
+      chPoolFree(&pool.pool, ip);
+    }
+  }
+  return msg;
+}
+
+msg_t cpp_post(ObjectsPool<Item, 4> &pool, ObjectsMailbox<Item, 4> &mbox,
+               uint32_t v) {
+  PoolObject<Item> obj = pool.make(v);
+
+  if (!obj)
+    return MSG_TIMEOUT;
+  return mbox.post(std::move(obj), TIME_INFINITE);
+}
+
+void c_fetch(c_objects_mailbox &mbox) {
+  msg_t msg;
+
+  if (chMBFetch(&mbox.mb, &msg, TIME_INFINITE) == MSG_OK) {
+    Item *ip = reinterpret_cast<Item *>(msg);
+
+    use(ip);
+    if (ip != NULL) {
+      ip->~Item();
+      chPoolFree(mbox.pool, ip);
+    }
+  }
+}
+
+void cpp_fetch(ObjectsMailbox<Item, 4> &mbox) {
+  PoolObject<Item> obj;
+
+  if (mbox.fetch(obj, TIME_INFINITE) == MSG_OK)
+    use(obj.get());
+}
+
+}
+
+/** @} */
@@ -0,0 +1,17 @@
+# C++ wrappers.
+include ${CHIBIOS}/os/various/cpp_wrappers/chcpp.mk
+
+# List of all the C++ wrappers test files.
+TESTSRC = ${CHIBIOS}/test/lib/ch_test.c \
+          ${CHIBIOS}/test/cpp/test_root.c
+
+TESTCPPSRC = ${CHIBIOS}/os/various/cpp_wrappers/ch.cpp \
+             ${CHIBIOS}/test/cpp/test_sequence_001.cpp
+
+# Required include directories
+TESTINC = ${CHIBIOS}/test/lib \
+          ${CHIBIOS}/test/cpp \
+          ${CHCPPINC}
+
+# Required settings
+TESTDEFS = -DCH_DBG_SYSTEM_STATE_CHECK=TRUE
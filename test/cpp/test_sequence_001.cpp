@@ -0,0 +1,550 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <utility>
+
+#include "ch.hpp"
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+using namespace chibios_rt;
+
+#if !CH_CPP_USE_CXX11
+#error "the C++ wrapper test requires CH_CPP_USE_CXX11"
+#endif
+
+#if !CH_CFG_USE_MUTEXES || !CH_CFG_USE_MEMPOOLS || !CH_CFG_USE_MAILBOXES
+#error "the C++ wrapper test requires mutexes, memory pools and mailboxes"
+#endif
+
+/**
+ * @page test_sequence_001 C++ Wrappers
+ *
+ * File: @ref test_sequence_001.cpp
+ *
+ * <h2>Description</h2>
+ * This sequence checks the scoped locks, the pool object handles and the
+ * objects mailbox of the C++ wrapper, then their cost is compared with
+ * the equivalent C API sequences. The best time of each sequence is
+ * measured in realtime counter cycles, the C and C++ values are expected
+ * to be the same within the measurement noise.<br>
+ * The code size of the wrapper is checked by the separate build in
+ * test/cpp/sizebuild, it compiles the functions in sizetest.cpp for a
+ * Cortex-M4 using the options of the demos.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_001_001
+ * - @subpage test_001_002
+ * - @subpage test_001_003
+ * - @subpage test_001_004
+ * - @subpage test_001_005
+ * - @subpage test_001_006
+ * - @subpage test_001_007
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define ITEMS               4U
+#define MBOX_SIZE           (ITEMS - 1U)
+
+/*
+ * Pool object counting the constructions and destructions.
+ */
+class Item {
+public:
+  static unsigned alive;
+  uint32_t value;
+
+  Item(uint32_t v) : value(v) {
+
+    alive++;
+  }
+
+  ~Item(void) {
+
+    alive--;
+  }
+};
+
+unsigned Item::alive;
+
+static ObjectsPool<Item, ITEMS> items;
+static ObjectsMailbox<Item, MBOX_SIZE> mbox(items);
+static Mutex mtx;
+
+/*
+ * Counts the free objects in the pool, the objects are allocated and
+ * released back.
+ */
+static unsigned free_items(void) {
+  void *objs[ITEMS + 1U];
+  unsigned n = 0U;
+
+  while ((n < ITEMS + 1U) && ((objs[n] = chPoolAlloc(&items.pool)) != NULL))
+    n++;
+  for (unsigned i = 0U; i < n; i++)
+    chPoolFree(&items.pool, objs[i]);
+  return n;
+}
+
+/*
+ * Runs a benchmark and returns the best time in realtime counter cycles.
+ */
+template <typename F>
+static uint32_t measure(F fn) {
+  time_measurement_t tm;
+
+  chTMObjectInit(&tm);
+  for (uint32_t i = 0U; i < CPPTEST_ITERATIONS; i++) {
+    chTMStartMeasurementX(&tm);
+    fn(i);
+    chTMStopMeasurementX(&tm);
+  }
+  return (uint32_t)tm.best;
+}
+
+/*
+ * Prints the score of a benchmark.
+ */
+static void print_score(uint32_t c, uint32_t cpp) {
+
+  test_print("--- Score : ");
+  test_printn(c);
+  test_print(" cycles C, ");
+  test_printn(cpp);
+  test_println(" cycles C++");
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page test_001_001 Scoped locks
+ *
+ * <h2>Description</h2>
+ * The mutex must be owned only inside the scope of a @p MutexLocker, the
+ * kernel must be locked inside the scope of @p SysLocker and of nested
+ * @p CriticalSectionLocker objects.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The mutex is owned inside the scope of a @p MutexLocker only.
+ * - The kernel is locked inside nested @p CriticalSectionLocker scopes.
+ * - The kernel is locked inside the scope of a @p SysLocker.
+ * .
+ */
+
+static void test_001_001_execute(void) {
+
+  /* The mutex is owned inside the scope of a MutexLocker only.*/
+  test_set_step(1);
+  {
+    bool owned;
+
+    {
+      MutexLocker lock(mtx);
+
+      owned = mtx.mutex.m_owner == chThdGetSelfX();
+    }
+    test_assert(owned, "mutex not owned in the scope");
+    test_assert(mtx.mutex.m_owner == NULL, "mutex owned after the scope");
+  }
+
+  /* The kernel is locked inside nested CriticalSectionLocker scopes.*/
+  test_set_step(2);
+  {
+    CriticalSectionLocker outer;
+    {
+      CriticalSectionLocker inner;
+    }
+    chDbgCheckClassS();
+  }
+
+  /* The kernel is locked inside the scope of a SysLocker.*/
+  test_set_step(3);
+  {
+    SysLocker lock;
+
+    chDbgCheckClassS();
+  }
+}
+
+static const testcase_t test_001_001 = {
+  "Scoped locks",
+  NULL,
+  NULL,
+  test_001_001_execute
+};
+
+/**
+ * @page test_001_002 Pool object handles
+ *
+ * <h2>Description</h2>
+ * The objects must be constructed by @p ObjectsPool::make(), the
+ * ownership must be transferred by the move operations and the objects
+ * must be destroyed and returned to the pool when the owning handle is
+ * destroyed, reset or moved over.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Two objects are made, moved and moved over.
+ * - The objects must have been returned when the handles are destroyed.
+ * - The pool is exhausted and an object is reset.
+ * - The objects must have been returned when the handles are destroyed.
+ * .
+ */
+
+static void test_001_002_execute(void) {
+
+  /* Two objects are made, moved and moved over.*/
+  test_set_step(1);
+  {
+    PoolObject<Item> a = items.make(1U);
+    PoolObject<Item> b = items.make(2U);
+    PoolObject<Item> c;
+
+    test_assert(a && b && !c && (a->value == 1U) && ((*b).value == 2U) &&
+                (Item::alive == 2U) && (free_items() == ITEMS - 2U),
+                "make failed");
+    c = std::move(a);
+    test_assert(!a && c && (c->value == 1U) && (Item::alive == 2U),
+                "move failed");
+    c = std::move(b);
+    test_assert(!b && (c->value == 2U) && (Item::alive == 1U) &&
+                (free_items() == ITEMS - 1U), "move assignment failed");
+  }
+
+  /* The objects must have been returned when the handles are
+     destroyed.*/
+  test_set_step(2);
+  {
+    test_assert((Item::alive == 0U) && (free_items() == ITEMS),
+                "objects not destroyed");
+  }
+
+  /* The pool is exhausted and an object is reset.*/
+  test_set_step(3);
+  {
+    PoolObject<Item> objs[ITEMS + 1U];
+
+    for (unsigned i = 0U; i <= ITEMS; i++)
+      objs[i] = items.make(i);
+    test_assert(objs[ITEMS - 1U] && !objs[ITEMS], "exhaustion failed");
+    objs[0].reset();
+    test_assert((Item::alive == ITEMS - 1U) && (free_items() == 1U),
+                "reset failed");
+  }
+
+  /* The objects must have been returned when the handles are
+     destroyed.*/
+  test_set_step(4);
+  {
+    test_assert((Item::alive == 0U) && (free_items() == ITEMS),
+                "objects not destroyed");
+  }
+}
+
+static const testcase_t test_001_002 = {
+  "Pool object handles",
+  NULL,
+  NULL,
+  test_001_002_execute
+};
+
+/**
+ * @page test_001_003 Objects mailbox
+ *
+ * <h2>Description</h2>
+ * The ownership of the objects must be transferred to the mailbox only
+ * when the post operation succeeds and back to a handle by the fetch
+ * operation, the order of post and postAhead is verified.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The mailbox is filled using post and postAhead.
+ * - A post to the full mailbox must fail leaving the object to the
+ *   handle.
+ * - The objects are fetched in the expected order.
+ * - A fetch from the empty mailbox must fail.
+ * - The objects must have been returned when the handles are destroyed.
+ * .
+ */
+
+static void test_001_003_execute(void) {
+  static const uint32_t order[MBOX_SIZE] = {1U, 0U, 2U};
+
+  {
+    PoolObject<Item> obj;
+
+    /* The mailbox is filled using post and postAhead.*/
+    test_set_step(1);
+    {
+      for (unsigned i = 0U; i < MBOX_SIZE; i++) {
+        msg_t msg;
+
+        obj = items.make(i);
+        if ((i & 1U) == 0U)
+          msg = mbox.post(std::move(obj), TIME_IMMEDIATE);
+        else
+          msg = mbox.postAhead(std::move(obj), TIME_IMMEDIATE);
+        test_assert((msg == MSG_OK) && !obj, "post failed");
+      }
+    }
+
+    /* A post to the full mailbox must fail leaving the object to the
+       handle.*/
+    test_set_step(2);
+    {
+      obj = items.make(MBOX_SIZE);
+      test_assert((mbox.post(std::move(obj), TIME_IMMEDIATE) == MSG_TIMEOUT) &&
+                  obj && (obj->value == MBOX_SIZE), "full mailbox");
+      test_assert((Item::alive == ITEMS) && (free_items() == 0U),
+                  "wrong ownership");
+    }
+
+    /* The objects are fetched in the expected order.*/
+    test_set_step(3);
+    {
+      for (unsigned i = 0U; i < MBOX_SIZE; i++) {
+        test_assert((mbox.fetch(obj, TIME_IMMEDIATE) == MSG_OK) &&
+                    (obj->value == order[i]) &&
+                    (Item::alive == MBOX_SIZE - i), "fetch failed");
+      }
+    }
+
+    /* A fetch from the empty mailbox must fail.*/
+    test_set_step(4);
+    {
+      test_assert(mbox.fetch(obj, TIME_IMMEDIATE) == MSG_TIMEOUT,
+                  "empty mailbox");
+    }
+  }
+
+  /* The objects must have been returned when the handles are
+     destroyed.*/
+  test_set_step(5);
+  {
+    test_assert((Item::alive == 0U) && (free_items() == ITEMS),
+                "objects not destroyed");
+  }
+}
+
+static const testcase_t test_001_003 = {
+  "Objects mailbox",
+  NULL,
+  NULL,
+  test_001_003_execute
+};
+
+/**
+ * @page test_001_004 Kernel lock cost
+ *
+ * <h2>Description</h2>
+ * A kernel lock and unlock using the C API is compared with a
+ * @p SysLocker scope.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Both sequences are measured and the score is printed.
+ * .
+ */
+
+static void test_001_004_execute(void) {
+
+  /* Both sequences are measured and the score is printed.*/
+  test_set_step(1);
+  {
+    uint32_t c, cpp;
+
+    c = measure([](uint32_t) {
+      chSysLock();
+      chSysUnlock();
+    });
+    cpp = measure([](uint32_t) {
+      SysLocker lock;
+    });
+    print_score(c, cpp);
+  }
+}
+
+static const testcase_t test_001_004 = {
+  "Kernel lock cost",
+  NULL,
+  NULL,
+  test_001_004_execute
+};
+
+/**
+ * @page test_001_005 Mutex lock cost
+ *
+ * <h2>Description</h2>
+ * A mutex lock and unlock using the C API is compared with a
+ * @p MutexLocker scope.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Both sequences are measured and the score is printed.
+ * .
+ */
+
+static void test_001_005_execute(void) {
+
+  /* Both sequences are measured and the score is printed.*/
+  test_set_step(1);
+  {
+    uint32_t c, cpp;
+
+    c = measure([](uint32_t) {
+      chMtxLock(&mtx.mutex);
+      chMtxUnlock(&mtx.mutex);
+    });
+    cpp = measure([](uint32_t) {
+      MutexLocker lock(mtx);
+    });
+    print_score(c, cpp);
+  }
+}
+
+static const testcase_t test_001_005 = {
+  "Mutex lock cost",
+  NULL,
+  NULL,
+  test_001_005_execute
+};
+
+/**
+ * @page test_001_006 Pool object cost
+ *
+ * <h2>Description</h2>
+ * An object allocated from the pool, constructed, destroyed and freed
+ * using the C API is compared with a @p PoolObject handle scope.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Both sequences are measured and the score is printed.
+ * .
+ */
+
+static void test_001_006_execute(void) {
+
+  /* Both sequences are measured and the score is printed.*/
+  test_set_step(1);
+  {
+    uint32_t c, cpp;
+
+    c = measure([](uint32_t i) {
+      Item *ip = new (chPoolAlloc(&items.pool)) Item(i);
+
+      ip->~Item();
+      chPoolFree(&items.pool, ip);
+    });
+    cpp = measure([](uint32_t i) {
+      PoolObject<Item> obj = items.make(i);
+    });
+    print_score(c, cpp);
+  }
+}
+
+static const testcase_t test_001_006 = {
+  "Pool object cost",
+  NULL,
+  NULL,
+  test_001_006_execute
+};
+
+/**
+ * @page test_001_007 Objects mailbox cost
+ *
+ * <h2>Description</h2>
+ * An object allocated from the pool, posted, fetched and freed using the
+ * C API is compared with the same sequence using the objects mailbox.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Both sequences are measured and the score is printed.
+ * .
+ */
+
+static void test_001_007_execute(void) {
+
+  /* Both sequences are measured and the score is printed.*/
+  test_set_step(1);
+  {
+    uint32_t c, cpp;
+
+    c = measure([](uint32_t i) {
+      Item *ip = new (chPoolAlloc(&items.pool)) Item(i);
+      msg_t msg;
+
+      (void)chMBPost(&mbox.mb, reinterpret_cast<msg_t>(ip), TIME_IMMEDIATE);
+      (void)chMBFetch(&mbox.mb, &msg, TIME_IMMEDIATE);
+      ip = reinterpret_cast<Item *>(msg);
+      ip->~Item();
+      chPoolFree(&items.pool, ip);
+    });
+    cpp = measure([](uint32_t i) {
+      PoolObject<Item> obj = items.make(i);
+
+      (void)mbox.post(std::move(obj), TIME_IMMEDIATE);
+      (void)mbox.fetch(obj, TIME_IMMEDIATE);
+    });
+    print_score(c, cpp);
+  }
+}
+
+static const testcase_t test_001_007 = {
+  "Objects mailbox cost",
+  NULL,
+  NULL,
+  test_001_007_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   C++ Wrappers.
+ */
+const testcase_t * const test_sequence_001[] = {
+  &test_001_001,
+  &test_001_002,
+  &test_001_003,
+  &test_001_004,
+  &test_001_005,
+  &test_001_006,
+  &test_001_007,
+  NULL
+};
@@ -0,0 +1,11 @@
+# List of all the I2C transactions queue test files.
+TESTSRC = ${CHIBIOS}/test/lib/ch_test.c \
+          ${CHIBIOS}/test/i2c/test_root.c \
+          ${CHIBIOS}/test/i2c/test_sequence_001.c
+
+# Required include directories
+TESTINC = ${CHIBIOS}/test/lib \
+          ${CHIBIOS}/test/i2c
+
+# Required settings
+TESTDEFS = -DHAL_USE_I2C=TRUE -DI2C_USE_QUEUE=TRUE
@@ -0,0 +1,75 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    test_root.h
+ * @brief   Test Suite root structures header.
+ *
+ * @addtogroup CH_TEST_ROOT
+ * @{
+ */
+
+#ifndef _TEST_ROOT_H_
+#define _TEST_ROOT_H_
+
+#include "ch.h"
+#include "hal.h"
+
+#include "test_sequence_001.h"
+
+/*===========================================================================*/
+/* Default definitions.                                                      */
+/*===========================================================================*/
+
+/* Global test suite name, it is printed on top of the test
+   report header.*/
+#define TEST_SUITE_NAME                     "I2C Transactions Test Suite"
+
+/**
+ * @brief   Number of simulated sensors polled by the throughput test.
+ */
+#if !defined(I2CTEST_SENSORS) || defined(__DOXYGEN__)
+#define I2CTEST_SENSORS                     10U
+#endif
+
+/**
+ * @brief   Polling cycles executed by the throughput test.
+ */
+#if !defined(I2CTEST_RATE_CYCLES) || defined(__DOXYGEN__)
+#define I2CTEST_RATE_CYCLES                 2000U
+#endif
+
+#if I2CTEST_SENSORS < 4U
+#error "the I2C test requires at least four sensors"
+#endif
+
+#if !I2C_USE_QUEUE || !I2C_USE_MUTUAL_EXCLUSION
+#error "the I2C test requires I2C_USE_QUEUE and I2C_USE_MUTUAL_EXCLUSION"
+#endif
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+extern const testcase_t * const *test_suite[];
+
+/*===========================================================================*/
+/* Shared definitions.                                                       */
+/*===========================================================================*/
+
+#endif /* _TEST_ROOT_H_ */
+
+/** @} */
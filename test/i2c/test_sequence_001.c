@@ -0,0 +1,431 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string.h>
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+/**
+ * @page test_sequence_001 I2C Transactions
+ *
+ * File: @ref test_sequence_001.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the I2C transactions queue using the simulator I2C
+ * driver. The driver completes one transfer at each simulated interrupt.
+ * The simulated slaves are register files attached by the test, the
+ * first byte written is the register pointer and the following bytes are
+ * written into the registers, reads return the registers starting from
+ * the pointer. Transfers to absent slaves, to slaves refusing transfers
+ * and writes beyond the register file are not acknowledged.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_001_001
+ * - @subpage test_001_002
+ * - @subpage test_001_003
+ * - @subpage test_001_004
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define SENSOR_ADDR         0x20U
+#define ABSENT_ADDR         0x50U
+#define SENSOR_REGS         16U
+#define SAMPLE_REG          4U
+#define SAMPLE_SIZE         6U
+
+static const I2CConfig i2ccfg = {100000U};
+
+static SimI2CDevice sensors[I2CTEST_SENSORS];
+static uint8_t regs[I2CTEST_SENSORS][SENSOR_REGS];
+static uint8_t samples[I2CTEST_SENSORS][SAMPLE_SIZE];
+static I2CTransaction polls[I2CTEST_SENSORS];
+static uint32_t callbacks;
+
+/*
+ * Counts the completed transactions.
+ */
+static void count(I2CDriver *i2cp, I2CTransaction *itp) {
+
+  (void)i2cp;
+  (void)itp;
+
+  chSysLockFromISR();
+  callbacks++;
+  chSysUnlockFromISR();
+}
+
+/*
+ * Converts an amount in a rate per second.
+ */
+static uint32_t per_second(uint32_t n, systime_t elapsed) {
+
+  if (elapsed == (systime_t)0)
+    elapsed = (systime_t)1;
+  return (uint32_t)(((uint64_t)n * CH_CFG_ST_FREQUENCY) / elapsed);
+}
+
+/*
+ * Checks the samples read from the sensors.
+ */
+static bool check_samples(void) {
+  uint32_t i, j;
+
+  for (i = 0; i < I2CTEST_SENSORS; i++) {
+    for (j = 0; j < SAMPLE_SIZE; j++) {
+      if (samples[i][j] != regs[i][SAMPLE_REG + j])
+        return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Prints a throughput score.
+ */
+static void print_score(systime_t elapsed, const char *mode) {
+
+  test_print("--- Score : ");
+  test_printn(per_second(I2CTEST_RATE_CYCLES, elapsed));
+  test_print(" cycles/S ");
+  test_println(mode);
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page test_001_001 Transaction kinds
+ *
+ * <h2>Description</h2>
+ * A register burst write, a register burst read, a write-only and a
+ * read-only transaction continuing from the register pointer are queued
+ * at once.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The whole batch is queued at once, the last transaction is waited
+ *   for.
+ * - All the transactions must be completed successfully.
+ * - The registers written and read are verified.
+ * - The data read using the register pointer is verified.
+ * .
+ */
+
+static void test_001_001_setup(void) {
+  uint32_t i, j;
+
+  for (i = 0; i < I2CTEST_SENSORS; i++) {
+    for (j = 0; j < SENSOR_REGS; j++)
+      regs[i][j] = (uint8_t)((i << 4) | j);
+    simI2cAttachDevice(&I2CD1, &sensors[i], SENSOR_ADDR + i,
+                       regs[i], SENSOR_REGS);
+  }
+  i2cStart(&I2CD1, &i2ccfg);
+}
+
+static void test_001_001_execute(void) {
+  static const uint8_t burst[5] = {2U, 0xA1U, 0xA2U, 0xA3U, 0xA4U};
+  static const uint8_t setptr[1] = {3U};
+  uint8_t rx[4], rx2[2];
+  I2CTransaction tw, tr, tp, to;
+  uint32_t i;
+
+  /* The whole batch is queued at once, the last transaction is waited
+     for.*/
+  test_set_step(1);
+  {
+    i2cTransactionObjectInit(&tw, SENSOR_ADDR, burst, sizeof burst,
+                             NULL, 0U, count);
+    i2cRegisterTransactionObjectInit(&tr, SENSOR_ADDR, 2U, rx, sizeof rx,
+                                     count);
+    i2cTransactionObjectInit(&tp, SENSOR_ADDR, setptr, sizeof setptr,
+                             NULL, 0U, count);
+    i2cTransactionObjectInit(&to, SENSOR_ADDR, NULL, 0U,
+                             rx2, sizeof rx2, count);
+    callbacks = 0;
+
+    chSysLock();
+    i2cSubmitI(&I2CD1, &tw);
+    i2cSubmitI(&I2CD1, &tr);
+    i2cSubmitI(&I2CD1, &tp);
+    chSysUnlock();
+    test_assert(i2cTransact(&I2CD1, &to, TIME_INFINITE) == MSG_OK,
+                "transaction failed");
+  }
+
+  /* All the transactions must be completed successfully.*/
+  test_set_step(2);
+  {
+    test_assert(!i2cIsTransactionPendingX(&tw) &&
+                !i2cIsTransactionPendingX(&tr) &&
+                !i2cIsTransactionPendingX(&tp) && (callbacks == 4U),
+                "transactions not completed");
+    test_assert((tw.result == MSG_OK) && (tr.result == MSG_OK) &&
+                (tp.result == MSG_OK), "transactions failed");
+  }
+
+  /* The registers written and read are verified.*/
+  test_set_step(3);
+  {
+    for (i = 0; i < 4U; i++) {
+      test_assert((regs[0][2U + i] == burst[1U + i]) &&
+                  (rx[i] == burst[1U + i]), "wrong register data");
+    }
+  }
+
+  /* The data read using the register pointer is verified.*/
+  test_set_step(4);
+  {
+    test_assert((rx2[0] == burst[2]) && (rx2[1] == burst[3]),
+                "wrong register pointer");
+  }
+}
+
+static const testcase_t test_001_001 = {
+  "Transaction kinds",
+  test_001_001_setup,
+  NULL,
+  test_001_001_execute
+};
+
+/**
+ * @page test_001_002 Slaves not acknowledging
+ *
+ * <h2>Description</h2>
+ * Transactions to an absent slave, to a slave refusing transfers and
+ * beyond the register file must fail without stopping the queue.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The failing transactions are queued at once followed by a valid
+ *   transaction which is waited for.
+ * - The failing transactions must report the NAK.
+ * - The transactions after a NAK must be executed.
+ * .
+ */
+
+static void test_001_002_teardown(void) {
+
+  simI2cSetNak(&sensors[2], false);
+}
+
+static void test_001_002_execute(void) {
+  static const uint8_t overflow[3] = {SENSOR_REGS - 1U, 0x11U, 0x22U};
+  uint8_t rx[2], rx2[2];
+  I2CTransaction ta, tb, tc, td;
+  msg_t msg;
+
+  /* The failing transactions are queued at once followed by a valid
+     transaction which is waited for.*/
+  test_set_step(1);
+  {
+    regs[1][0] = 0x5AU;
+    regs[1][1] = 0xA5U;
+    simI2cSetNak(&sensors[2], true);
+    i2cRegisterTransactionObjectInit(&ta, ABSENT_ADDR, 0U, rx, sizeof rx,
+                                     NULL);
+    i2cRegisterTransactionObjectInit(&tb, SENSOR_ADDR + 2U, 0U,
+                                     rx, sizeof rx, NULL);
+    i2cTransactionObjectInit(&tc, SENSOR_ADDR + 3U,
+                             overflow, sizeof overflow, NULL, 0U, NULL);
+    i2cRegisterTransactionObjectInit(&td, SENSOR_ADDR + 1U, 0U,
+                                     rx2, sizeof rx2, NULL);
+
+    chSysLock();
+    i2cSubmitI(&I2CD1, &ta);
+    i2cSubmitI(&I2CD1, &tb);
+    i2cSubmitI(&I2CD1, &tc);
+    chSysUnlock();
+    msg = i2cTransact(&I2CD1, &td, TIME_INFINITE);
+  }
+
+  /* The failing transactions must report the NAK.*/
+  test_set_step(2);
+  {
+    test_assert((ta.result == MSG_RESET) && (ta.errors == I2C_ACK_FAILURE) &&
+                (tb.result == MSG_RESET) && (tb.errors == I2C_ACK_FAILURE) &&
+                (tc.result == MSG_RESET) && (tc.errors == I2C_ACK_FAILURE),
+                "NAK not reported");
+  }
+
+  /* The transactions after a NAK must be executed.*/
+  test_set_step(3);
+  {
+    test_assert((msg == MSG_OK) && (rx2[0] == 0x5AU) && (rx2[1] == 0xA5U) &&
+                (regs[3][SENSOR_REGS - 1U] == 0x11U),
+                "queue stopped after a NAK");
+  }
+}
+
+static const testcase_t test_001_002 = {
+  "Slaves not acknowledging",
+  NULL,
+  test_001_002_teardown,
+  test_001_002_execute
+};
+
+/**
+ * @page test_001_003 Throughput, blocking API
+ *
+ * <h2>Description</h2>
+ * All the sensors are polled @p I2CTEST_RATE_CYCLES times using the
+ * blocking API, the bus is acquired for each sensor.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The sensors are polled.
+ * - The score is printed.
+ * - The samples are verified.
+ * .
+ */
+
+static void test_001_003_execute(void) {
+  static const uint8_t reg[1] = {SAMPLE_REG};
+  systime_t start, elapsed;
+  uint32_t i, cycle;
+
+  /* The sensors are polled.*/
+  test_set_step(1);
+  {
+    memset(samples, 0, sizeof samples);
+    start = chVTGetSystemTimeX();
+    for (cycle = 0; cycle < I2CTEST_RATE_CYCLES; cycle++) {
+      for (i = 0; i < I2CTEST_SENSORS; i++) {
+        i2cAcquireBus(&I2CD1);
+        (void)i2cMasterTransmitTimeout(&I2CD1, SENSOR_ADDR + i,
+                                       reg, sizeof reg,
+                                       samples[i], SAMPLE_SIZE,
+                                       TIME_INFINITE);
+        i2cReleaseBus(&I2CD1);
+      }
+    }
+    elapsed = chVTTimeElapsedSinceX(start);
+  }
+
+  /* The score is printed.*/
+  test_set_step(2);
+  {
+    print_score(elapsed, "blocking");
+  }
+
+  /* The samples are verified.*/
+  test_set_step(3);
+  {
+    test_assert(check_samples(), "wrong samples");
+  }
+}
+
+static const testcase_t test_001_003 = {
+  "Throughput, blocking API",
+  NULL,
+  NULL,
+  test_001_003_execute
+};
+
+/**
+ * @page test_001_004 Throughput, queue
+ *
+ * <h2>Description</h2>
+ * All the sensors are polled @p I2CTEST_RATE_CYCLES times using the
+ * queue, a batch is queued for each cycle and only the last transaction
+ * is waited for, the thread is woken up once for each cycle.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The sensors are polled.
+ * - The score is printed.
+ * - The samples are verified.
+ * .
+ */
+
+static void test_001_004_setup(void) {
+  uint32_t i;
+
+  for (i = 0; i < I2CTEST_SENSORS; i++)
+    i2cRegisterTransactionObjectInit(&polls[i], SENSOR_ADDR + i, SAMPLE_REG,
+                                     samples[i], SAMPLE_SIZE, NULL);
+  memset(samples, 0, sizeof samples);
+}
+
+static void test_001_004_execute(void) {
+  systime_t start, elapsed;
+  uint32_t i, cycle;
+
+  /* The sensors are polled.*/
+  test_set_step(1);
+  {
+    start = chVTGetSystemTimeX();
+    for (cycle = 0; cycle < I2CTEST_RATE_CYCLES; cycle++) {
+      chSysLock();
+      for (i = 0; i < I2CTEST_SENSORS - 1U; i++)
+        i2cSubmitI(&I2CD1, &polls[i]);
+      chSysUnlock();
+      test_assert(i2cTransact(&I2CD1, &polls[I2CTEST_SENSORS - 1U],
+                              TIME_INFINITE) == MSG_OK,
+                  "transaction failed");
+    }
+    elapsed = chVTTimeElapsedSinceX(start);
+  }
+
+  /* The score is printed.*/
+  test_set_step(2);
+  {
+    print_score(elapsed, "queued");
+  }
+
+  /* The samples are verified.*/
+  test_set_step(3);
+  {
+    test_assert(check_samples(), "wrong samples");
+  }
+}
+
+static const testcase_t test_001_004 = {
+  "Throughput, queue",
+  test_001_004_setup,
+  NULL,
+  test_001_004_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   I2C Transactions.
+ */
+const testcase_t * const test_sequence_001[] = {
+  &test_001_001,
+  &test_001_002,
+  &test_001_003,
+  &test_001_004,
+  NULL
+};
@@ -0,0 +1,61 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * lwIP options for the benchmarks, everything else is left to the lwIP
+ * defaults in opt.h.
+ */
+
+#ifndef __LWIPOPT_H__
+#define __LWIPOPT_H__
+
+#define MEM_ALIGNMENT                   4
+#define MEM_SIZE                        (64 * 1024)
+#define MEMP_NUM_PBUF                   32
+#define MEMP_NUM_TCP_SEG                64
+#define PBUF_POOL_SIZE                  32
+
+#define TCP_MSS                         1460
+#define TCP_WND                         (8 * TCP_MSS)
+#define TCP_SND_BUF                     (8 * TCP_MSS)
+#define TCP_SND_QUEUELEN                (4 * TCP_SND_BUF / TCP_MSS)
+
+/* Traffic toward the local address must go through the MAC driver.*/
+#define LWIP_NETIF_LOOPBACK             0
+
+/* The zero-copy mode of the bindings requires the custom pbufs, they
+   are enabled by the default IP_FRAG settings.*/
+#define IP_FRAG                         1
+#define IP_FRAG_USES_STATIC_BUF         0
+
+#define LWIP_SO_RCVTIMEO                1
+#define LWIP_STATS                      1
+
+#define TCPIP_THREAD_STACKSIZE          4096
+#define TCPIP_THREAD_PRIO               (LOWPRIO + 1)
+#define TCPIP_MBOX_SIZE                 MEMP_NUM_PBUF
+#define DEFAULT_THREAD_STACKSIZE        4096
+#define DEFAULT_THREAD_PRIO             (LOWPRIO + 1)
+#define DEFAULT_RAW_RECVMBOX_SIZE       4
+#define DEFAULT_UDP_RECVMBOX_SIZE       4
+#define DEFAULT_TCP_RECVMBOX_SIZE       40
+#define DEFAULT_ACCEPTMBOX_SIZE         4
+
+/* Bindings settings, the receive path options can be overridden from
+   XDEFS in order to compare them.*/
+#define LWIP_THREAD_STACK_SIZE          4096
+
+#endif /* __LWIPOPT_H__ */
@@ -0,0 +1,17 @@
+# The lwIP sources must have been extracted under $(CHIBIOS)/ext.
+include ${CHIBIOS}/os/various/lwip_bindings/lwip.mk
+
+# List of all the lwIP benchmarks files.
+TESTSRC = ${CHIBIOS}/test/lib/ch_test.c \
+          ${CHIBIOS}/test/lwip/test_root.c \
+          ${CHIBIOS}/test/lwip/test_sequence_001.c \
+          ${CHIBIOS}/os/various/evtimer.c \
+          $(LWSRC)
+
+# Required include directories
+TESTINC = ${CHIBIOS}/test/lib \
+          ${CHIBIOS}/test/lwip \
+          $(LWINC)
+
+# Required settings
+TESTDEFS = -DHAL_USE_MAC=TRUE
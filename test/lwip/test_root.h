@@ -0,0 +1,124 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    test_root.h
+ * @brief   Test Suite root structures header.
+ *
+ * @addtogroup CH_TEST_ROOT
+ * @{
+ */
+
+#ifndef _TEST_ROOT_H_
+#define _TEST_ROOT_H_
+
+#include "ch.h"
+#include "hal.h"
+
+#include "test_sequence_001.h"
+
+/*===========================================================================*/
+/* Default definitions.                                                      */
+/*===========================================================================*/
+
+/* Global test suite name, it is printed on top of the test
+   report header.*/
+#define TEST_SUITE_NAME                     "lwIP Benchmarks Suite"
+
+/**
+ * @brief   TCP port used by the throughput benchmark.
+ */
+#if !defined(LWIPBENCH_TCP_PORT) || defined(__DOXYGEN__)
+#define LWIPBENCH_TCP_PORT                  5001
+#endif
+
+/**
+ * @brief   UDP port used by the round trip benchmark.
+ */
+#if !defined(LWIPBENCH_UDP_PORT) || defined(__DOXYGEN__)
+#define LWIPBENCH_UDP_PORT                  5002
+#endif
+
+/**
+ * @brief   Amount of data transferred by the throughput benchmark.
+ */
+#if !defined(LWIPBENCH_TCP_BYTES) || defined(__DOXYGEN__)
+#define LWIPBENCH_TCP_BYTES                 (4U * 1024U * 1024U)
+#endif
+
+/**
+ * @brief   Size of each write in the throughput benchmark.
+ */
+#if !defined(LWIPBENCH_TCP_CHUNK) || defined(__DOXYGEN__)
+#define LWIPBENCH_TCP_CHUNK                 1024U
+#endif
+
+/**
+ * @brief   Number of datagrams exchanged by the round trip benchmark.
+ */
+#if !defined(LWIPBENCH_UDP_ROUNDS) || defined(__DOXYGEN__)
+#define LWIPBENCH_UDP_ROUNDS                1000U
+#endif
+
+/**
+ * @brief   Datagram size in the round trip benchmark.
+ */
+#if !defined(LWIPBENCH_UDP_SIZE) || defined(__DOXYGEN__)
+#define LWIPBENCH_UDP_SIZE                  64U
+#endif
+
+/**
+ * @brief   Datagrams in flight in the packet rate benchmark.
+ * @details The sender waits for the receiver when this number of datagrams
+ *          has been sent and not yet received, without a window the
+ *          datagrams would be dropped by the stack faster than they are
+ *          delivered.
+ */
+#if !defined(LWIPBENCH_UDP_WINDOW) || defined(__DOXYGEN__)
+#define LWIPBENCH_UDP_WINDOW                4U
+#endif
+
+/**
+ * @brief   Number of connections opened by the churn benchmark.
+ */
+#if !defined(LWIPBENCH_CHURN_ROUNDS) || defined(__DOXYGEN__)
+#define LWIPBENCH_CHURN_ROUNDS              200U
+#endif
+
+/**
+ * @brief   Stack size of the server threads.
+ */
+#if !defined(LWIPBENCH_STACK_SIZE) || defined(__DOXYGEN__)
+#if defined(CH_ARCHITECTURE_SIMIA32)
+#define LWIPBENCH_STACK_SIZE                2048
+#else
+#define LWIPBENCH_STACK_SIZE                512
+#endif
+#endif
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+extern const testcase_t * const *test_suite[];
+
+/*===========================================================================*/
+/* Shared definitions.                                                       */
+/*===========================================================================*/
+
+#endif /* _TEST_ROOT_H_ */
+
+/** @} */
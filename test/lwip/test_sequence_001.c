@@ -0,0 +1,659 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+#include "lwip/api.h"
+#include "lwip/netif.h"
+#include "lwip/stats.h"
+#include "lwipthread.h"
+
+/**
+ * @page test_sequence_001 lwIP Benchmarks
+ *
+ * File: @ref test_sequence_001.c
+ *
+ * <h2>Description</h2>
+ * This sequence measures the lwIP stack and bindings over the MAC driver.
+ * The benchmarks open connections toward the address of the default
+ * interface, with the loopback MAC of the simulator the traffic crosses
+ * the whole stack and the MAC driver twice. The lwIP loopback interface
+ * must be disabled (@p LWIP_NETIF_LOOPBACK) or the MAC would be bypassed.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_001_001
+ * - @subpage test_001_002
+ * - @subpage test_001_003
+ * - @subpage test_001_004
+ * - @subpage test_001_005
+ * - @subpage test_001_006
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+static THD_WORKING_AREA(wa_server, LWIPBENCH_STACK_SIZE);
+static semaphore_t server_ready;
+static uint8_t data[LWIPBENCH_TCP_CHUNK];
+#if LWIP_SO_RCVTIMEO
+static systime_t sink_last;
+static semaphore_t sink_window;
+#endif
+
+/*
+ * Receives a TCP stream and returns the number of bytes received.
+ */
+static THD_FUNCTION(tcp_server, p) {
+  struct netconn *listener, *conn;
+  struct netbuf *nb;
+  uint32_t n = 0;
+
+  (void)p;
+  chRegSetThreadName("tcpsink");
+
+  listener = netconn_new(NETCONN_TCP);
+  if ((listener != NULL) &&
+      (netconn_bind(listener, NULL, LWIPBENCH_TCP_PORT) == ERR_OK) &&
+      (netconn_listen(listener) == ERR_OK)) {
+    chSemSignal(&server_ready);
+    if (netconn_accept(listener, &conn) == ERR_OK) {
+      while (netconn_recv(conn, &nb) == ERR_OK) {
+        n += netbuf_len(nb);
+        netbuf_delete(nb);
+      }
+      netconn_close(conn);
+      netconn_delete(conn);
+    }
+  }
+  else
+    chSemSignal(&server_ready);
+  if (listener != NULL)
+    netconn_delete(listener);
+  chThdExit((msg_t)n);
+}
+
+/*
+ * Echoes datagrams and returns the number of datagrams echoed.
+ */
+static THD_FUNCTION(udp_server, p) {
+  struct netconn *conn;
+  struct netbuf *nb;
+  uint32_t n = 0;
+
+  (void)p;
+  chRegSetThreadName("udpecho");
+
+  conn = netconn_new(NETCONN_UDP);
+  if ((conn != NULL) &&
+      (netconn_bind(conn, NULL, LWIPBENCH_UDP_PORT) == ERR_OK)) {
+#if LWIP_SO_RCVTIMEO
+    netconn_set_recvtimeout(conn, 1000);
+#endif
+    chSemSignal(&server_ready);
+    while ((n < LWIPBENCH_UDP_ROUNDS) && (netconn_recv(conn, &nb) == ERR_OK)) {
+      netconn_sendto(conn, nb, netbuf_fromaddr(nb), netbuf_fromport(nb));
+      netbuf_delete(nb);
+      n++;
+    }
+  }
+  else
+    chSemSignal(&server_ready);
+  if (conn != NULL)
+    netconn_delete(conn);
+  chThdExit((msg_t)n);
+}
+
+/*
+ * Accepts connections until the listener is closed, each connection is
+ * drained and closed. Returns the number of connections served.
+ */
+static THD_FUNCTION(churn_server, p) {
+  struct netconn *listener, *conn;
+  struct netbuf *nb;
+  uint32_t n = 0;
+
+  (void)p;
+  chRegSetThreadName("churn");
+
+  listener = netconn_new(NETCONN_TCP);
+  if ((listener != NULL) &&
+      (netconn_bind(listener, NULL, LWIPBENCH_TCP_PORT) == ERR_OK) &&
+      (netconn_listen(listener) == ERR_OK)) {
+    chSemSignal(&server_ready);
+    while ((n < LWIPBENCH_CHURN_ROUNDS) &&
+           (netconn_accept(listener, &conn) == ERR_OK)) {
+      while (netconn_recv(conn, &nb) == ERR_OK)
+        netbuf_delete(nb);
+      netconn_close(conn);
+      netconn_delete(conn);
+      n++;
+    }
+  }
+  else
+    chSemSignal(&server_ready);
+  if (listener != NULL)
+    netconn_delete(listener);
+  chThdExit((msg_t)n);
+}
+
+#if LWIP_SO_RCVTIMEO
+/*
+ * Counts datagrams until the stream stops, the arrival time of the last
+ * one is recorded. Each datagram received opens the sender window by one.
+ */
+static THD_FUNCTION(udp_sink, p) {
+  struct netconn *conn;
+  struct netbuf *nb;
+  uint32_t n = 0;
+
+  (void)p;
+  chRegSetThreadName("udpsink");
+
+  conn = netconn_new(NETCONN_UDP);
+  if ((conn != NULL) &&
+      (netconn_bind(conn, NULL, LWIPBENCH_UDP_PORT) == ERR_OK)) {
+    netconn_set_recvtimeout(conn, 500);
+    chSemSignal(&server_ready);
+    while (netconn_recv(conn, &nb) == ERR_OK) {
+      sink_last = chVTGetSystemTimeX();
+      netbuf_delete(nb);
+      n++;
+      chSemSignal(&sink_window);
+    }
+  }
+  else
+    chSemSignal(&server_ready);
+  if (conn != NULL)
+    netconn_delete(conn);
+  chThdExit((msg_t)n);
+}
+#endif /* LWIP_SO_RCVTIMEO */
+
+/*
+ * Starts a server thread and waits for it to be ready.
+ */
+static thread_t *start_server(tfunc_t server) {
+  thread_t *tp;
+
+  chSemObjectInit(&server_ready, 0);
+  tp = chThdCreateStatic(wa_server, sizeof wa_server,
+                         chThdGetPriorityX() + 1, server, NULL);
+  chSemWait(&server_ready);
+  return tp;
+}
+
+/*
+ * Converts an amount in a rate per second.
+ */
+static uint32_t per_second(uint32_t n, systime_t elapsed) {
+
+  if (elapsed == (systime_t)0)
+    elapsed = (systime_t)1;
+  return (uint32_t)(((uint64_t)n * CH_CFG_ST_FREQUENCY) / elapsed);
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page test_001_001 Stack initialization
+ *
+ * <h2>Description</h2>
+ * The lwIP stack is started over the MAC driver with the default
+ * settings.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The stack is started, the default interface must be registered.
+ * - The interface address is printed.
+ * .
+ */
+
+static void test_001_001_execute(void) {
+
+  /* The stack is started, the default interface must be registered.*/
+  test_set_step(1);
+  {
+    lwipInit(NULL);
+    test_assert(netif_default != NULL, "no default interface");
+  }
+
+  /* The interface address is printed.*/
+  test_set_step(2);
+  {
+    test_print("--- Address : ");
+    test_printn(ip4_addr1(&netif_default->ip_addr));
+    test_print(".");
+    test_printn(ip4_addr2(&netif_default->ip_addr));
+    test_print(".");
+    test_printn(ip4_addr3(&netif_default->ip_addr));
+    test_print(".");
+    test_printn(ip4_addr4(&netif_default->ip_addr));
+    test_println("");
+  }
+}
+
+static const testcase_t test_001_001 = {
+  "Stack initialization",
+  NULL,
+  NULL,
+  test_001_001_execute
+};
+
+/**
+ * @page test_001_002 TCP throughput
+ *
+ * <h2>Description</h2>
+ * A stream of @p LWIPBENCH_TCP_BYTES bytes is written to a TCP sink.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The sink is started and the stream is written.
+ * - The bytes received by the sink are verified.
+ * - The score is printed.
+ * .
+ */
+
+static void test_001_002_execute(void) {
+  struct netconn *conn;
+  thread_t *tp;
+  systime_t start, elapsed;
+  uint32_t n, sent = 0;
+
+  /* The sink is started and the stream is written.*/
+  test_set_step(1);
+  {
+    tp = start_server(tcp_server);
+    start = chVTGetSystemTimeX();
+    conn = netconn_new(NETCONN_TCP);
+    if ((conn != NULL) &&
+        (netconn_connect(conn, &netif_default->ip_addr,
+                         LWIPBENCH_TCP_PORT) == ERR_OK)) {
+      while (sent < LWIPBENCH_TCP_BYTES) {
+        if (netconn_write(conn, data, sizeof data, NETCONN_NOCOPY) != ERR_OK)
+          break;
+        sent += sizeof data;
+#if defined(SIMULATOR)
+        _sim_check_for_interrupts();
+#endif
+      }
+      netconn_close(conn);
+    }
+    if (conn != NULL)
+      netconn_delete(conn);
+    n = (uint32_t)chThdWait(tp);
+    elapsed = chVTTimeElapsedSinceX(start);
+  }
+
+  /* The bytes received by the sink are verified.*/
+  test_set_step(2);
+  {
+    test_assert(n == LWIPBENCH_TCP_BYTES, "wrong number of bytes received");
+  }
+
+  /* The score is printed.*/
+  test_set_step(3);
+  {
+    test_print("--- Score : ");
+    test_printn(per_second(n, elapsed));
+    test_println(" bytes/S");
+  }
+}
+
+static const testcase_t test_001_002 = {
+  "TCP throughput",
+  NULL,
+  NULL,
+  test_001_002_execute
+};
+
+/**
+ * @page test_001_003 UDP round trip
+ *
+ * <h2>Description</h2>
+ * @p LWIPBENCH_UDP_ROUNDS datagrams are bounced on an echo server one at
+ * time.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The echo server is started and the datagrams are exchanged.
+ * - The number of round trips is verified.
+ * - The score is printed.
+ * .
+ */
+
+static void test_001_003_execute(void) {
+  struct netconn *conn;
+  struct netbuf *nb;
+  thread_t *tp;
+  systime_t start, elapsed;
+  uint32_t n = 0;
+
+  /* The echo server is started and the datagrams are exchanged.*/
+  test_set_step(1);
+  {
+    tp = start_server(udp_server);
+    start = chVTGetSystemTimeX();
+    conn = netconn_new(NETCONN_UDP);
+    if ((conn != NULL) &&
+        (netconn_connect(conn, &netif_default->ip_addr,
+                         LWIPBENCH_UDP_PORT) == ERR_OK)) {
+#if LWIP_SO_RCVTIMEO
+      netconn_set_recvtimeout(conn, 1000);
+#endif
+      while (n < LWIPBENCH_UDP_ROUNDS) {
+        nb = netbuf_new();
+        if (nb == NULL)
+          break;
+        netbuf_ref(nb, data, LWIPBENCH_UDP_SIZE);
+        if (netconn_send(conn, nb) != ERR_OK) {
+          netbuf_delete(nb);
+          break;
+        }
+        netbuf_delete(nb);
+        if (netconn_recv(conn, &nb) != ERR_OK)
+          break;
+        netbuf_delete(nb);
+        n++;
+#if defined(SIMULATOR)
+        _sim_check_for_interrupts();
+#endif
+      }
+    }
+    if (conn != NULL)
+      netconn_delete(conn);
+    elapsed = chVTTimeElapsedSinceX(start);
+    chThdWait(tp);
+  }
+
+  /* The number of round trips is verified.*/
+  test_set_step(2);
+  {
+    test_assert(n == LWIPBENCH_UDP_ROUNDS, "round trips not completed");
+  }
+
+  /* The score is printed.*/
+  test_set_step(3);
+  {
+    test_print("--- Score : ");
+    test_printn(per_second(n, elapsed));
+    test_print(" round trips/S, ");
+    test_printn((uint32_t)(((uint64_t)elapsed * 1000000U) /
+                           ((uint64_t)CH_CFG_ST_FREQUENCY * n)));
+    test_println(" uS average");
+  }
+}
+
+static const testcase_t test_001_003 = {
+  "UDP round trip",
+  NULL,
+  NULL,
+  test_001_003_execute
+};
+
+#if LWIP_SO_RCVTIMEO || defined(__DOXYGEN__)
+/**
+ * @page test_001_004 UDP packet rate
+ *
+ * <h2>Description</h2>
+ * @p LWIPBENCH_UDP_ROUNDS datagrams are sent with up to
+ * @p LWIPBENCH_UDP_WINDOW of them in flight and counted by the receiver.
+ * The score is the rate of the delivered datagrams, the datagrams lost
+ * anyway are reported.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - LWIP_SO_RCVTIMEO
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - The receiver is started and the datagrams are sent.
+ * - The datagrams received are verified.
+ * - The score is printed.
+ * .
+ */
+
+static void test_001_004_execute(void) {
+  struct netconn *conn;
+  struct netbuf *nb;
+  thread_t *tp;
+  systime_t start;
+  uint32_t n, sent = 0;
+
+  /* The receiver is started and the datagrams are sent.*/
+  test_set_step(1);
+  {
+    chSemObjectInit(&sink_window, (cnt_t)LWIPBENCH_UDP_WINDOW);
+    tp = start_server(udp_sink);
+    start = chVTGetSystemTimeX();
+    sink_last = start;
+    conn = netconn_new(NETCONN_UDP);
+    if ((conn != NULL) &&
+        (netconn_connect(conn, &netif_default->ip_addr,
+                         LWIPBENCH_UDP_PORT) == ERR_OK)) {
+      while (sent < LWIPBENCH_UDP_ROUNDS) {
+        /* A lost datagram never opens the window, the slot is recovered
+           after a timeout.*/
+        (void)chSemWaitTimeout(&sink_window, MS2ST(100));
+        nb = netbuf_new();
+        if (nb == NULL)
+          break;
+        netbuf_ref(nb, data, LWIPBENCH_UDP_SIZE);
+        if (netconn_send(conn, nb) == ERR_OK)
+          sent++;
+        else
+          chSemSignal(&sink_window);
+        netbuf_delete(nb);
+#if defined(SIMULATOR)
+        _sim_check_for_interrupts();
+#endif
+      }
+    }
+    if (conn != NULL)
+      netconn_delete(conn);
+    n = (uint32_t)chThdWait(tp);
+  }
+
+  /* The datagrams received are verified.*/
+  test_set_step(2);
+  {
+    test_assert(n > 0U, "no datagrams received");
+  }
+
+  /* The score is printed.*/
+  test_set_step(3);
+  {
+    test_print("--- Score : ");
+    test_printn(per_second(n, sink_last - start));
+    test_print(" packets/S delivered, ");
+    test_printn(sent - n);
+    test_println(" lost");
+  }
+}
+
+static const testcase_t test_001_004 = {
+  "UDP packet rate",
+  NULL,
+  NULL,
+  test_001_004_execute
+};
+#endif /* LWIP_SO_RCVTIMEO */
+
+/**
+ * @page test_001_005 TCP connection churn
+ *
+ * <h2>Description</h2>
+ * @p LWIPBENCH_CHURN_ROUNDS short connections are opened and closed one
+ * after the other, the allocation of the mailboxes and semaphores of the
+ * connections is stressed.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The server is started and the connections are opened.
+ * - The connections opened and served are verified.
+ * - The score and the lwIP system objects statistics are printed.
+ * .
+ */
+
+static void test_001_005_execute(void) {
+  struct netconn *conn;
+  thread_t *tp;
+  systime_t start, elapsed;
+  uint32_t n, opened = 0;
+
+  /* The server is started and the connections are opened.*/
+  test_set_step(1);
+  {
+    tp = start_server(churn_server);
+    start = chVTGetSystemTimeX();
+    while (opened < LWIPBENCH_CHURN_ROUNDS) {
+      conn = netconn_new(NETCONN_TCP);
+      if (conn == NULL)
+        break;
+      if (netconn_connect(conn, &netif_default->ip_addr,
+                          LWIPBENCH_TCP_PORT) != ERR_OK) {
+        netconn_delete(conn);
+        break;
+      }
+      (void)netconn_write(conn, data, LWIPBENCH_UDP_SIZE, NETCONN_NOCOPY);
+      netconn_close(conn);
+      netconn_delete(conn);
+      opened++;
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    }
+    n = (uint32_t)chThdWait(tp);
+    elapsed = chVTTimeElapsedSinceX(start);
+  }
+
+  /* The connections opened and served are verified.*/
+  test_set_step(2);
+  {
+    test_assert(opened == LWIPBENCH_CHURN_ROUNDS, "connection error");
+    test_assert(n == opened, "connections not served");
+  }
+
+  /* The score and the lwIP system objects statistics are printed.*/
+  test_set_step(3);
+  {
+    test_print("--- Score : ");
+    test_printn(per_second(n, elapsed));
+    test_println(" connections/S");
+#if SYS_STATS
+    test_print("--- Sems  : ");
+    test_printn(lwip_stats.sys.sem.max);
+    test_print(" max, ");
+    test_printn(lwip_stats.sys.sem.err);
+    test_println(" errors");
+    test_print("--- Mboxes: ");
+    test_printn(lwip_stats.sys.mbox.max);
+    test_print(" max, ");
+    test_printn(lwip_stats.sys.mbox.err);
+    test_println(" errors");
+#endif
+  }
+}
+
+static const testcase_t test_001_005 = {
+  "TCP connection churn",
+  NULL,
+  NULL,
+  test_001_005_execute
+};
+
+/**
+ * @page test_001_006 Interface statistics
+ *
+ * <h2>Description</h2>
+ * The frames counters of the interface are printed, they cover all the
+ * previous benchmarks.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The transmitted frames and the frames transmitted without copy are
+ *   printed.
+ * - The received frames and the frames dropped on receive are printed.
+ * .
+ */
+
+static void test_001_006_execute(void) {
+  const lwipif_stats_t *sp =
+                  lwipGetInterfaceStats((lwipif_t *)netif_default->state);
+
+  /* The transmitted frames and the frames transmitted without copy are
+     printed.*/
+  test_set_step(1);
+  {
+    test_print("--- Frames: ");
+    test_printn(sp->txframes);
+    test_print(" transmitted, ");
+    test_printn(sp->txattached);
+    test_println(" without copy");
+  }
+
+  /* The received frames and the frames dropped on receive are printed.*/
+  test_set_step(2);
+  {
+    test_print("--- Frames: ");
+    test_printn(sp->rxframes);
+    test_print(" received, ");
+    test_printn(sp->rxdropped);
+    test_println(" dropped");
+  }
+}
+
+static const testcase_t test_001_006 = {
+  "Interface statistics",
+  NULL,
+  NULL,
+  test_001_006_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   lwIP Benchmarks.
+ */
+const testcase_t * const test_sequence_001[] = {
+  &test_001_001,
+  &test_001_002,
+  &test_001_003,
+#if LWIP_SO_RCVTIMEO || defined(__DOXYGEN__)
+  &test_001_004,
+#endif
+  &test_001_005,
+  &test_001_006,
+  NULL
+};
@@ -2,7 +2,9 @@
 TESTSRC = ${CHIBIOS}/test/lib/ch_test.c \
           ${CHIBIOS}/test/nil/test_root.c \
           ${CHIBIOS}/test/nil/test_sequence_001.c \
-          ${CHIBIOS}/test/nil/test_sequence_002.c
+          ${CHIBIOS}/test/nil/test_sequence_002.c \
+          ${CHIBIOS}/test/nil/test_sequence_003.c \
+          ${CHIBIOS}/test/nil/test_sequence_004.c
 
 # Required include directories
 TESTINC = ${CHIBIOS}/test/lib \
@@ -36,6 +36,8 @@
 const testcase_t * const *test_suite[] = {
   test_sequence_001,
   test_sequence_002,
+  test_sequence_003,
+  test_sequence_004,
   NULL
 };
 
@@ -44,7 +46,8 @@ const testcase_t * const *test_suite[] = {
 /*===========================================================================*/
 
 semaphore_t gsem1, gsem2;
-thread_reference_t gtr1;
+thread_reference_t gtr1, gtr2;
+void (*gfunc)(void);
 
 /*
  * Support thread.
@@ -59,6 +62,8 @@ THD_FUNCTION(test_support, arg) {
 
   /* Waiting for button push and activation of the test suite.*/
   while (true) {
+    msg_t msg;
+
     chSysLock();
     if (chSemGetCounterI(&gsem1) < 0)
       chSemSignalI(&gsem1);
@@ -66,9 +71,19 @@ THD_FUNCTION(test_support, arg) {
     chThdResumeI(&gtr1, MSG_OK);
     chEvtSignalI(tp, 0x55);
     chSchRescheduleS();
-    chSysUnlock();
 
-    chThdSleepMilliseconds(250);
+    /* Waiting for the next period, the tester can resume this thread
+       through gtr2 in order to have gfunc executed at the priority of
+       the support thread.*/
+    do {
+      msg = chThdSuspendTimeoutS(&gtr2, MS2ST(250));
+      if ((msg == MSG_OK) && (gfunc != NULL)) {
+        chSysUnlock();
+        gfunc();
+        chSysLock();
+      }
+    } while (msg == MSG_OK);
+    chSysUnlock();
   }
 }
 
@@ -29,6 +29,8 @@
 
 #include "test_sequence_001.h"
 #include "test_sequence_002.h"
+#include "test_sequence_003.h"
+#include "test_sequence_004.h"
 
 /*===========================================================================*/
 /* Default definitions.                                                      */
@@ -48,7 +50,8 @@ extern const testcase_t * const *test_suite[];
 extern "C" {
 #endif
   extern semaphore_t gsem1, gsem2;
-  extern thread_reference_t gtr1;
+  extern thread_reference_t gtr1, gtr2;
+  extern void (*gfunc)(void);
   extern THD_WORKING_AREA(wa_test_support, 128);
   THD_FUNCTION(test_support, arg);
 #ifdef __cplusplus
@@ -29,6 +29,8 @@
  * <h2>Test Cases</h2>
  * - @subpage test_001_001
  * - @subpage test_001_002
+ * - @subpage test_001_003
+ * - @subpage test_001_004
  * .
  */
 
@@ -36,6 +38,22 @@
  * Shared code.
  ****************************************************************************/
 
+#if ((NIL_CFG_ST_TIMEDELTA == 0) && (PORT_SUPPORTS_RT == TRUE)) || \
+    defined(__DOXYGEN__)
+static semaphore_t tmsem;
+static msg_t tmmsg;
+
+/*
+ * Timed waiter, executed by the support thread, it waits until tmsem is
+ * signaled restarting the wait on each timeout.
+ */
+static void tm_waiter(void) {
+
+  do {
+    tmmsg = chSemWaitTimeout(&tmsem, (systime_t)-2);
+  } while (tmmsg == MSG_TIMEOUT);
+}
+#endif
 
 /****************************************************************************
  * Test cases.
@@ -165,6 +183,193 @@ static const testcase_t test_001_002 = {
 };
 #endif /* TRUE */
 
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_001_003 Timeouts ordering
+ *
+ * <h2>Description</h2>
+ * Timeouts accuracy is tested while the support thread is periodically
+ * sleeping, the timeouts of the two threads are interleaved so the
+ * expirations must happen in the right order regardless of the order
+ * of insertion.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - A series of short sleeps is performed, each one expiring before the
+ *   support thread timeout, on exit the system time is verified.
+ * - A series of increasing sleeps is performed, the longer ones expiring
+ *   after the support thread timeout, on exit the system time is
+ *   verified.
+ * - A semaphore wait with a long timeout is performed, the thread is
+ *   awakened by the support thread before the timeout then a sleep is
+ *   performed and on exit the system time is verified.
+ * .
+ */
+
+static void test_001_003_execute(void) {
+  systime_t time;
+  unsigned i;
+
+  /* A series of short sleeps is performed, each one expiring before the
+     support thread timeout, on exit the system time is verified.*/
+  test_set_step(1);
+  {
+    for (i = 1U; i <= 10U; i++) {
+      time = chVTGetSystemTimeX();
+      chThdSleepMilliseconds(i);
+      test_assert_time_window(time + MS2ST(i),
+                              time + MS2ST(i) + 1,
+                              "out of time window");
+    }
+  }
+
+  /* A series of increasing sleeps is performed, the longer ones expiring
+     after the support thread timeout, on exit the system time is
+     verified.*/
+  test_set_step(2);
+  {
+    for (i = 100U; i <= 500U; i += 100U) {
+      time = chVTGetSystemTimeX();
+      chThdSleepMilliseconds(i);
+      test_assert_time_window(time + MS2ST(i),
+                              time + MS2ST(i) + 1,
+                              "out of time window");
+    }
+  }
+
+  /* A semaphore wait with a long timeout is performed, the thread is
+     awakened by the support thread before the timeout then a sleep is
+     performed and on exit the system time is verified.*/
+  test_set_step(3);
+  {
+    msg_t msg;
+
+    time = chVTGetSystemTimeX();
+    msg = chSemWaitTimeout(&gsem1, MS2ST(1000));
+    test_assert(MSG_OK == msg, "wrong returned message");
+    test_assert_time_window(time,
+                            time + MS2ST(250) + 1,
+                            "out of time window");
+
+    time = chVTGetSystemTimeX();
+    chThdSleepMilliseconds(100);
+    test_assert_time_window(time + MS2ST(100),
+                            time + MS2ST(100) + 1,
+                            "out of time window");
+  }
+}
+
+static const testcase_t test_001_003 = {
+  "Timeouts ordering",
+  NULL,
+  NULL,
+  test_001_003_execute
+};
+#endif /* TRUE */
+
+#if ((NIL_CFG_ST_TIMEDELTA == 0) && (PORT_SUPPORTS_RT == TRUE)) || \
+    defined(__DOXYGEN__)
+/**
+ * @page test_001_004 System tick cost
+ *
+ * <h2>Description</h2>
+ * The cost of the real system tick is measured while the support thread
+ * is waiting with a timeout and the other threads are idle. The tester
+ * reads the realtime counter in a tight loop, the largest gap between two
+ * reads in a tick period includes the tick interrupt. The smallest of
+ * those gaps over several periods, minus the loop time, is the score. It
+ * can be compared between builds with @p NIL_CFG_USE_TIMEOUT_LIST enabled
+ * and disabled.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - (NIL_CFG_ST_TIMEDELTA == 0) && (PORT_SUPPORTS_RT == TRUE)
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - The support thread is made wait on a semaphore with a long timeout.
+ * - The realtime counter is sampled for 16 tick periods, the score is
+ *   printed.
+ * - The support thread is released, the wait must not have timed out.
+ * .
+ */
+
+static void test_001_004_setup(void) {
+  chSemObjectInit(&tmsem, 0);
+}
+
+static void test_001_004_execute(void) {
+  rtcnt_t prev, now, delta, loop, period, cost;
+  systime_t tick;
+  unsigned i;
+
+  /* The support thread is made wait on a semaphore with a long
+     timeout.*/
+  test_set_step(1);
+  {
+    gfunc = tm_waiter;
+    chSysLock();
+    chThdResumeI(&gtr2, MSG_OK);
+    chSchRescheduleS();
+    chSysUnlock();
+  }
+
+  /* The realtime counter is sampled for 16 tick periods, the score is
+     printed.*/
+  test_set_step(2);
+  {
+    loop = (rtcnt_t)-1;
+    cost = (rtcnt_t)-1;
+    chThdSleep(1);
+    tick = chVTGetSystemTimeX();
+    prev = chSysGetRealtimeCounterX();
+    for (i = 0; i <= 16U; i++) {
+      period = 0;
+      while (chVTGetSystemTimeX() == tick) {
+        now = chSysGetRealtimeCounterX();
+        delta = now - prev;
+        prev = now;
+        if (delta < loop) {
+          loop = delta;
+        }
+        if (delta > period) {
+          period = delta;
+        }
+      }
+      tick = chVTGetSystemTimeX();
+
+      /* The first period is partial, the gap containing the tick that
+         started it has not been sampled.*/
+      if ((i > 0U) && (period < cost)) {
+        cost = period;
+      }
+    }
+    test_print("--- Score : ");
+    test_printn((uint32_t)(cost - loop));
+    test_println(" RT counter cycles per tick");
+  }
+
+  /* The support thread is released, the wait must not have timed
+     out.*/
+  test_set_step(3);
+  {
+    chSemSignal(&tmsem);
+    gfunc = NULL;
+    test_assert(tmmsg == MSG_OK, "wrong returned message");
+  }
+}
+
+static const testcase_t test_001_004 = {
+  "Timer handler performance",
+  test_001_004_setup,
+  NULL,
+  test_001_004_execute
+};
+#endif /* (NIL_CFG_ST_TIMEDELTA == 0) && (PORT_SUPPORTS_RT == TRUE) */
+
  /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -178,6 +383,13 @@ const testcase_t * const test_sequence_001[] = {
 #endif
 #if TRUE || defined(__DOXYGEN__)
   &test_001_002,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_001_003,
+#endif
+#if ((NIL_CFG_ST_TIMEDELTA == 0) && (PORT_SUPPORTS_RT == TRUE)) || \
+    defined(__DOXYGEN__)
+  &test_001_004,
 #endif
   NULL
 };
@@ -30,6 +30,10 @@
  * <h2>Test Cases</h2>
  * - @subpage test_002_001
  * - @subpage test_002_002
+ * - @subpage test_002_003
+ * - @subpage test_002_004
+ * - @subpage test_002_005
+ * - @subpage test_002_006
  * .
  */
 
@@ -38,6 +42,7 @@
  ****************************************************************************/
 
 static semaphore_t sem1;
+static binary_semaphore_t bsem1;
 static thread_reference_t tr1;
 
 /****************************************************************************
@@ -406,6 +411,114 @@ static const testcase_t test_002_005 = {
   NULL,
   test_002_005_execute
 };
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_002_006 Binary Semaphores functionality
+ *
+ * <h2>Description</h2>
+ * Binary semaphores functionality is tested.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The function chBSemWaitTimeout() is invoked on a taken semaphore with
+ *   an immediate timeout, after return the state and the returned message
+ *   are tested.
+ * - The function chBSemSignal() is invoked twice, after return the state
+ *   and the counter are tested, the counter must not exceed one.
+ * - The function chBSemWait() is invoked, after return the state and the
+ *   returned message are tested.
+ * - The function chBSemWaitTimeout() is invoked on a taken semaphore, after
+ *   return the system time, the state and the returned message are tested.
+ * - The function chBSemReset() is invoked, after return the state is
+ *   tested.
+ * .
+ */
+
+static void test_002_006_setup(void) {
+
+  chBSemObjectInit(&bsem1, true);
+}
+
+static void test_002_006_teardown(void) {
+
+  chBSemReset(&bsem1, true);
+}
+
+static void test_002_006_execute(void) {
+  systime_t time;
+  msg_t msg;
+
+  /* The function chBSemWaitTimeout() is invoked on a taken semaphore with
+     an immediate timeout, after return the state and the returned message
+     are tested.*/
+  test_set_step(1);
+  {
+    msg = chBSemWaitTimeout(&bsem1, TIME_IMMEDIATE);
+    test_assert_lock(chBSemGetStateI(&bsem1) == true,
+                     "not taken");
+    test_assert(MSG_TIMEOUT == msg,
+                "wrong returned message");
+  }
+
+  /* The function chBSemSignal() is invoked twice, after return the state
+     and the counter are tested, the counter must not exceed one.*/
+  test_set_step(2);
+  {
+    chBSemSignal(&bsem1);
+    chBSemSignal(&bsem1);
+    test_assert_lock(chBSemGetStateI(&bsem1) == false,
+                     "still taken");
+    test_assert_lock(chSemGetCounterI(&bsem1.sem) == 1,
+                     "wrong counter value");
+  }
+
+  /* The function chBSemWait() is invoked, after return the state and the
+     returned message are tested.*/
+  test_set_step(3);
+  {
+    msg = chBSemWait(&bsem1);
+    test_assert_lock(chBSemGetStateI(&bsem1) == true,
+                     "not taken");
+    test_assert(MSG_OK == msg,
+                "wrong returned message");
+  }
+
+  /* The function chBSemWaitTimeout() is invoked on a taken semaphore, after
+     return the system time, the state and the returned message are
+     tested.*/
+  test_set_step(4);
+  {
+    time = chVTGetSystemTimeX();
+    msg = chBSemWaitTimeout(&bsem1, MS2ST(100));
+    test_assert_time_window(time + MS2ST(100),
+                            time + MS2ST(100) + 1,
+                            "out of time window");
+    test_assert_lock(chBSemGetStateI(&bsem1) == true,
+                     "not taken");
+    test_assert(MSG_TIMEOUT == msg,
+                "wrong returned message");
+  }
+
+  /* The function chBSemReset() is invoked, after return the state is
+     tested.*/
+  test_set_step(5);
+  {
+    chBSemReset(&bsem1, false);
+    test_assert_lock(chBSemGetStateI(&bsem1) == false,
+                     "still taken");
+  }
+}
+
+static const testcase_t test_002_006 = {
+  "binary semaphores functionality",
+  test_002_006_setup,
+  test_002_006_teardown,
+  test_002_006_execute
+};
 #endif /* TRUE */
 
  /****************************************************************************
@@ -430,6 +543,9 @@ const testcase_t * const test_sequence_002[] = {
 #endif
 #if TRUE || defined(__DOXYGEN__)
   &test_002_005,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_002_006,
 #endif
   NULL
 };
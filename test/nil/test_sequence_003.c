@@ -0,0 +1,412 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+/**
+ * @page test_sequence_003 Mailboxes and Memory Pools
+ *
+ * File: @ref test_sequence_003.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the ChibiOS/NIL functionalities related to
+ * mailboxes and memory pools.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_003_001
+ * - @subpage test_003_002
+ * - @subpage test_003_003
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#if NIL_CFG_USE_MAILBOXES == TRUE
+#define MB_SIZE 4
+
+static msg_t mb_buffer[MB_SIZE];
+static MAILBOX_DECL(mb1, mb_buffer, MB_SIZE);
+#endif
+
+#if NIL_CFG_USE_MEMPOOLS == TRUE
+#define MP_SIZE 4
+
+static uint32_t mp_objects[MP_SIZE][4];
+static MEMORYPOOL_DECL(mp1, sizeof (mp_objects[0]));
+#endif
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+#if (NIL_CFG_USE_MAILBOXES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page test_003_001 Mailbox queuing and timeouts
+ *
+ * <h2>Description</h2>
+ * Messages are posted and fetched from a mailbox in sequences designed to
+ * stimulate all the code paths inside the mailbox, the mailbox status is
+ * verified after each operation.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - NIL_CFG_USE_MAILBOXES == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - The mailbox is filled using chMBPost() and chMBPostAhead(), the
+ *   mailbox counters are tested.
+ * - Posting into the full mailbox is attempted using all the post
+ *   functions, a timeout is expected.
+ * - The mailbox is emptied using chMBFetch(), the order of the messages
+ *   is tested.
+ * - Fetching from the empty mailbox is attempted, a timeout is expected
+ *   after the specified time.
+ * - The mailbox is reset while containing messages, the counters and the
+ *   pointers are tested.
+ * .
+ */
+
+static void test_003_001_setup(void) {
+
+  chMBObjectInit(&mb1, mb_buffer, MB_SIZE);
+}
+
+static void test_003_001_teardown(void) {
+
+  chMBReset(&mb1);
+}
+
+static void test_003_001_execute(void) {
+  systime_t time;
+  msg_t msg1, msg2;
+  unsigned i;
+
+  /* The mailbox is filled using chMBPost() and chMBPostAhead(), the
+     mailbox counters are tested.*/
+  test_set_step(1);
+  {
+    test_assert_lock(chMBGetFreeCountI(&mb1) == MB_SIZE,
+                     "wrong size");
+    for (i = 0U; i < MB_SIZE - 1U; i++) {
+      msg1 = chMBPost(&mb1, (msg_t)('B' + i), TIME_INFINITE);
+      test_assert(MSG_OK == msg1,
+                  "wrong returned message");
+    }
+    msg1 = chMBPostAhead(&mb1, 'A', TIME_INFINITE);
+    test_assert(MSG_OK == msg1,
+                "wrong returned message");
+    test_assert_lock(chMBGetFreeCountI(&mb1) == 0,
+                     "still empty");
+    test_assert_lock(chMBGetUsedCountI(&mb1) == MB_SIZE,
+                     "not full");
+    test_assert_lock(mb1.rdptr == mb1.wrptr,
+                     "pointers not aligned");
+  }
+
+  /* Posting into the full mailbox is attempted using all the post
+     functions, a timeout is expected.*/
+  test_set_step(2);
+  {
+    msg1 = chMBPost(&mb1, 'X', TIME_IMMEDIATE);
+    test_assert(MSG_TIMEOUT == msg1,
+                "wrong returned message");
+    msg1 = chMBPostAhead(&mb1, 'X', TIME_IMMEDIATE);
+    test_assert(MSG_TIMEOUT == msg1,
+                "wrong returned message");
+    chSysLock();
+    msg1 = chMBPostI(&mb1, 'X');
+    msg2 = chMBPostAheadI(&mb1, 'X');
+    chSysUnlock();
+    test_assert(MSG_TIMEOUT == msg1,
+                "wrong returned message");
+    test_assert(MSG_TIMEOUT == msg2,
+                "wrong returned message");
+  }
+
+  /* The mailbox is emptied using chMBFetch(), the order of the messages
+     is tested.*/
+  test_set_step(3);
+  {
+    for (i = 0U; i < MB_SIZE; i++) {
+      msg1 = chMBFetch(&mb1, &msg2, TIME_INFINITE);
+      test_assert(MSG_OK == msg1,
+                  "wrong returned message");
+      test_emit_token((char)msg2);
+    }
+    test_assert_sequence("ABCD",
+                         "wrong messages order");
+    test_assert_lock(chMBGetFreeCountI(&mb1) == MB_SIZE,
+                     "not empty");
+  }
+
+  /* Fetching from the empty mailbox is attempted, a timeout is expected
+     after the specified time.*/
+  test_set_step(4);
+  {
+    chSysLock();
+    msg1 = chMBFetchI(&mb1, &msg2);
+    chSysUnlock();
+    test_assert(MSG_TIMEOUT == msg1,
+                "wrong returned message");
+
+    time = chVTGetSystemTimeX();
+    msg1 = chMBFetch(&mb1, &msg2, MS2ST(100));
+    test_assert_time_window(time + MS2ST(100),
+                            time + MS2ST(100) + 1,
+                            "out of time window");
+    test_assert(MSG_TIMEOUT == msg1,
+                "wrong returned message");
+    test_assert_lock(chMBGetUsedCountI(&mb1) == 0,
+                     "wrong counter value");
+  }
+
+  /* The mailbox is reset while containing messages, the counters and the
+     pointers are tested.*/
+  test_set_step(5);
+  {
+    msg1 = chMBPost(&mb1, 'A', TIME_INFINITE);
+    test_assert(MSG_OK == msg1,
+                "wrong returned message");
+    chMBReset(&mb1);
+    test_assert_lock(chMBGetFreeCountI(&mb1) == MB_SIZE,
+                     "not empty");
+    test_assert_lock(chMBGetUsedCountI(&mb1) == 0,
+                     "still full");
+    test_assert_lock((mb1.buffer == mb1.rdptr) && (mb1.buffer == mb1.wrptr),
+                     "pointers not aligned to base");
+  }
+}
+
+static const testcase_t test_003_001 = {
+  "mailbox queuing and timeouts",
+  test_003_001_setup,
+  test_003_001_teardown,
+  test_003_001_execute
+};
+#endif /* NIL_CFG_USE_MAILBOXES == TRUE */
+
+#if (NIL_CFG_USE_MAILBOXES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page test_003_002 Mailbox I-Class functions
+ *
+ * <h2>Description</h2>
+ * The non-blocking functions used by producers and consumers running in
+ * ISR context are tested, the buffer circularity is verified.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - NIL_CFG_USE_MAILBOXES == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - The mailbox is filled using chMBPostI() then emptied using
+ *   chMBFetchI(), the order of the messages is tested.
+ * - The mailbox is filled using chMBPostAheadI() then emptied using
+ *   chMBFetchI(), the order of the messages is tested.
+ * .
+ */
+
+static void test_003_002_setup(void) {
+
+  chMBObjectInit(&mb1, mb_buffer, MB_SIZE);
+}
+
+static void test_003_002_teardown(void) {
+
+  chMBReset(&mb1);
+}
+
+static void test_003_002_execute(void) {
+  msg_t msg1, msg2;
+  unsigned i;
+
+  /* The mailbox is filled using chMBPostI() then emptied using
+     chMBFetchI(), the order of the messages is tested.*/
+  test_set_step(1);
+  {
+    for (i = 0U; i < MB_SIZE; i++) {
+      chSysLock();
+      msg1 = chMBPostI(&mb1, (msg_t)('A' + i));
+      chSysUnlock();
+      test_assert(MSG_OK == msg1,
+                  "wrong returned message");
+    }
+    for (i = 0U; i < MB_SIZE; i++) {
+      chSysLock();
+      msg1 = chMBFetchI(&mb1, &msg2);
+      chSysUnlock();
+      test_assert(MSG_OK == msg1,
+                  "wrong returned message");
+      test_emit_token((char)msg2);
+    }
+    test_assert_sequence("ABCD",
+                         "wrong messages order");
+    test_assert_lock(mb1.rdptr == mb1.wrptr,
+                     "pointers not aligned");
+  }
+
+  /* The mailbox is filled using chMBPostAheadI() then emptied using
+     chMBFetchI(), the order of the messages is tested.*/
+  test_set_step(2);
+  {
+    for (i = 0U; i < MB_SIZE; i++) {
+      chSysLock();
+      msg1 = chMBPostAheadI(&mb1, (msg_t)('D' - i));
+      chSysUnlock();
+      test_assert(MSG_OK == msg1,
+                  "wrong returned message");
+    }
+    for (i = 0U; i < MB_SIZE; i++) {
+      chSysLock();
+      msg1 = chMBFetchI(&mb1, &msg2);
+      chSysUnlock();
+      test_assert(MSG_OK == msg1,
+                  "wrong returned message");
+      test_emit_token((char)msg2);
+    }
+    test_assert_sequence("ABCD",
+                         "wrong messages order");
+    test_assert_lock(chMBGetFreeCountI(&mb1) == MB_SIZE,
+                     "not empty");
+  }
+}
+
+static const testcase_t test_003_002 = {
+  "mailbox I-Class functions",
+  test_003_002_setup,
+  test_003_002_teardown,
+  test_003_002_execute
+};
+#endif /* NIL_CFG_USE_MAILBOXES == TRUE */
+
+#if (NIL_CFG_USE_MEMPOOLS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page test_003_003 Memory Pools functionality
+ *
+ * <h2>Description</h2>
+ * The memory pool is loaded with an array of objects, the objects are
+ * allocated and released and the pool state is verified.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - NIL_CFG_USE_MEMPOOLS == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - The pool is loaded with an array of objects then all the objects are
+ *   allocated, a further allocation must fail.
+ * - The objects are released and allocated again, the last released
+ *   object must be the first allocated.
+ * - The objects are released using the I-Class function, the pool must
+ *   contain all the objects again.
+ * .
+ */
+
+static void test_003_003_setup(void) {
+
+  chPoolObjectInit(&mp1, sizeof (mp_objects[0]));
+}
+
+static void test_003_003_execute(void) {
+  void *objp;
+  unsigned i;
+
+  /* The pool is loaded with an array of objects then all the objects are
+     allocated, a further allocation must fail.*/
+  test_set_step(1);
+  {
+    chPoolLoadArray(&mp1, mp_objects, MP_SIZE);
+    for (i = 0U; i < MP_SIZE; i++) {
+      test_assert(chPoolAlloc(&mp1) != NULL,
+                  "list empty");
+    }
+    test_assert(chPoolAlloc(&mp1) == NULL,
+                "list not empty");
+  }
+
+  /* The objects are released and allocated again, the last released
+     object must be the first allocated.*/
+  test_set_step(2);
+  {
+    for (i = 0U; i < MP_SIZE; i++) {
+      chPoolFree(&mp1, mp_objects[i]);
+    }
+    objp = chPoolAlloc(&mp1);
+    test_assert(objp == (void *)mp_objects[MP_SIZE - 1U],
+                "wrong object");
+    chPoolFree(&mp1, objp);
+  }
+
+  /* The objects are released using the I-Class function, the pool must
+     contain all the objects again.*/
+  test_set_step(3);
+  {
+    for (i = 0U; i < MP_SIZE; i++) {
+      chSysLock();
+      objp = chPoolAllocI(&mp1);
+      chSysUnlock();
+      test_assert(objp != NULL,
+                  "list empty");
+    }
+    for (i = 0U; i < MP_SIZE; i++) {
+      chSysLock();
+      chPoolFreeI(&mp1, mp_objects[i]);
+      chSysUnlock();
+    }
+    for (i = 0U; i < MP_SIZE; i++) {
+      test_assert(chPoolAlloc(&mp1) != NULL,
+                  "list empty");
+    }
+    test_assert(chPoolAlloc(&mp1) == NULL,
+                "list not empty");
+  }
+}
+
+static const testcase_t test_003_003 = {
+  "memory pools functionality",
+  test_003_003_setup,
+  NULL,
+  test_003_003_execute
+};
+#endif /* NIL_CFG_USE_MEMPOOLS == TRUE */
+
+ /****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Sequence brief description.
+ */
+const testcase_t * const test_sequence_003[] = {
+#if (NIL_CFG_USE_MAILBOXES == TRUE) || defined(__DOXYGEN__)
+  &test_003_001,
+#endif
+#if (NIL_CFG_USE_MAILBOXES == TRUE) || defined(__DOXYGEN__)
+  &test_003_002,
+#endif
+#if (NIL_CFG_USE_MEMPOOLS == TRUE) || defined(__DOXYGEN__)
+  &test_003_003,
+#endif
+  NULL
+};
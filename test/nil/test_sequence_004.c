@@ -0,0 +1,476 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+/**
+ * @page test_sequence_004 Benchmarks
+ *
+ * File: @ref test_sequence_004.c
+ *
+ * <h2>Description</h2>
+ * This module implements a series of system benchmarks. The benchmarks are
+ * useful as a stress test and as a reference when comparing ChibiOS/NIL
+ * with ChibiOS/RT, the test names and the score lines are the same used
+ * by the RT benchmarks module for the equivalent measurements.<br>
+ * The higher priority thread required by some benchmarks is the support
+ * thread, it is resumed through @p gtr2 and executes @p gfunc.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_004_001
+ * - @subpage test_004_002
+ * - @subpage test_004_003
+ * - @subpage test_004_004
+ * - @subpage test_004_005
+ * - @subpage test_004_006
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+static semaphore_t sem1, sem2;
+
+/*
+ * Waits for the next system tick and returns its time.
+ */
+static systime_t bmk_wait_tick(void) {
+
+  chThdSleep(1);
+  return chVTGetSystemTimeX();
+}
+
+/*
+ * Returns true until one second has elapsed since the specified time.
+ */
+static bool bmk_running(systime_t start) {
+
+  return chVTIsTimeWithinX(chVTGetSystemTimeX(), start,
+                           start + MS2ST(1000));
+}
+
+/*
+ * Resumes the support thread making it execute gfunc.
+ */
+static void bmk_resume_support(void) {
+
+  chSysLock();
+  chThdResumeI(&gtr2, MSG_OK);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/*
+ * Semaphores ping-pong server, it runs until sem1 is reset.
+ */
+static void bmk_sem_server(void) {
+
+  while (chSemWait(&sem1) == MSG_OK) {
+    chSemSignal(&sem2);
+  }
+}
+
+#if NIL_CFG_USE_EVENTS == TRUE
+static thread_t *tp_server;
+
+/*
+ * Events server, it runs until EVENT_MASK(1) is received.
+ */
+static void bmk_evt_server(void) {
+
+  tp_server = chThdGetSelfX();
+  while ((chEvtWaitAny(ALL_EVENTS) & EVENT_MASK(1)) == 0) {
+  }
+}
+#endif
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page test_004_001 Context Switch performance
+ *
+ * <h2>Description</h2>
+ * The support thread is resumed and immediately suspends itself again
+ * on @p gtr2, a context switch back to the tester follows each wakeup.
+ * The performance is calculated by measuring the number of iterations
+ * after a second of continuous operations.
+ *
+ * <h2>Test Steps</h2>
+ * - The support thread is woken up four times per iteration using
+ *   chThdResumeI(), the score is printed.
+ * .
+ */
+
+static void test_004_001_execute(void) {
+  systime_t start;
+  uint32_t n;
+
+  /* The support thread is woken up four times per iteration using
+     chThdResumeI(), the score is printed.*/
+  test_set_step(1);
+  {
+    gfunc = NULL;
+    n = 0;
+    start = bmk_wait_tick();
+    do {
+      chSysLock();
+      chThdResumeI(&gtr2, MSG_OK);
+      chSchRescheduleS();
+      chThdResumeI(&gtr2, MSG_OK);
+      chSchRescheduleS();
+      chThdResumeI(&gtr2, MSG_OK);
+      chSchRescheduleS();
+      chThdResumeI(&gtr2, MSG_OK);
+      chSchRescheduleS();
+      chSysUnlock();
+      n += 4;
+    } while (bmk_running(start));
+    test_print("--- Score : ");
+    test_printn(n * 2);
+    test_println(" ctxswc/S");
+  }
+}
+
+static const testcase_t test_004_001 = {
+  "Benchmark, context switch",
+  NULL,
+  NULL,
+  test_004_001_execute
+};
+
+/**
+ * @page test_004_002 Semaphores ping-pong performance
+ *
+ * <h2>Description</h2>
+ * The tester signals a semaphore and waits on a second one, the higher
+ * priority support thread answers each request signaling back. Each
+ * round trip is the NIL equivalent of the synchronous message exchange
+ * measured by the RT "messages #2" benchmark.
+ * The performance is calculated by measuring the number of iterations
+ * after a second of continuous operations.
+ *
+ * <h2>Test Steps</h2>
+ * - The support thread is started as semaphores server.
+ * - Requests are sent to the server and the answers are awaited, the
+ *   score is printed.
+ * - The server is stopped by resetting its semaphore.
+ * .
+ */
+
+static void test_004_002_setup(void) {
+
+  chSemObjectInit(&sem1, 0);
+  chSemObjectInit(&sem2, 0);
+}
+
+static void test_004_002_teardown(void) {
+
+  gfunc = NULL;
+}
+
+static void test_004_002_execute(void) {
+  systime_t start;
+  uint32_t n;
+
+  /* The support thread is started as semaphores server.*/
+  test_set_step(1);
+  {
+    gfunc = bmk_sem_server;
+    bmk_resume_support();
+  }
+
+  /* Requests are sent to the server and the answers are awaited, the
+     score is printed.*/
+  test_set_step(2);
+  {
+    n = 0;
+    start = bmk_wait_tick();
+    do {
+      chSemSignal(&sem1);
+      chSemWait(&sem2);
+      n++;
+    } while (bmk_running(start));
+    test_print("--- Score : ");
+    test_printn(n);
+    test_print(" msgs/S, ");
+    test_printn(n << 1);
+    test_println(" ctxswc/S");
+  }
+
+  /* The server is stopped by resetting its semaphore.*/
+  test_set_step(3);
+  {
+    chSemReset(&sem1, 0);
+    test_assert_lock(chSemGetCounterI(&sem2) == 0,
+                     "counter not zero");
+  }
+}
+
+static const testcase_t test_004_002 = {
+  "Benchmark, semaphores ping-pong",
+  test_004_002_setup,
+  test_004_002_teardown,
+  test_004_002_execute
+};
+
+#if (NIL_CFG_USE_EVENTS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page test_004_003 ISR to thread wakeup performance
+ *
+ * <h2>Description</h2>
+ * The support thread waits for events, the tester signals it using the
+ * I-class API from within a critical zone and then reschedules, this is
+ * the path followed by an ISR waking up a thread, the IRQ entry and exit
+ * overhead is not included. The RT benchmark with the same name follows
+ * the same path.
+ * The performance is calculated by measuring the number of iterations
+ * after a second of continuous operations.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - NIL_CFG_USE_EVENTS == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - The support thread is started as events server.
+ * - The server is woken up using chEvtSignalI(), the score is printed.
+ * - The server is stopped by signaling its exit event.
+ * .
+ */
+
+static void test_004_003_teardown(void) {
+
+  gfunc = NULL;
+}
+
+static void test_004_003_execute(void) {
+  systime_t start;
+  uint32_t n;
+
+  /* The support thread is started as events server.*/
+  test_set_step(1);
+  {
+    gfunc = bmk_evt_server;
+    bmk_resume_support();
+  }
+
+  /* The server is woken up using chEvtSignalI(), the score is printed.*/
+  test_set_step(2);
+  {
+    n = 0;
+    start = bmk_wait_tick();
+    do {
+      chSysLock();
+      chEvtSignalI(tp_server, EVENT_MASK(0));
+      chSchRescheduleS();
+      chSysUnlock();
+      n++;
+    } while (bmk_running(start));
+    test_print("--- Score : ");
+    test_printn(n);
+    test_print(" wakeups/S, ");
+    test_printn(n << 1);
+    test_println(" ctxswc/S");
+  }
+
+  /* The server is stopped by signaling its exit event.*/
+  test_set_step(3);
+  {
+    chEvtSignal(tp_server, EVENT_MASK(1));
+  }
+}
+
+static const testcase_t test_004_003 = {
+  "Benchmark, ISR to thread wakeup",
+  NULL,
+  test_004_003_teardown,
+  test_004_003_execute
+};
+#endif /* NIL_CFG_USE_EVENTS == TRUE */
+
+/**
+ * @page test_004_004 Semaphores wait/signal performance
+ *
+ * <h2>Description</h2>
+ * A counting semaphore is taken/released into a continuous loop, no
+ * Context Switch happens because the counter is always non negative.
+ * The performance is calculated by measuring the number of iterations
+ * after a second of continuous operations.
+ *
+ * <h2>Test Steps</h2>
+ * - The semaphore is taken and released four times per iteration, the
+ *   score is printed.
+ * .
+ */
+
+static void test_004_004_setup(void) {
+
+  chSemObjectInit(&sem1, 1);
+}
+
+static void test_004_004_execute(void) {
+  systime_t start;
+  uint32_t n;
+
+  /* The semaphore is taken and released four times per iteration, the
+     score is printed.*/
+  test_set_step(1);
+  {
+    n = 0;
+    start = bmk_wait_tick();
+    do {
+      chSemWait(&sem1);
+      chSemSignal(&sem1);
+      chSemWait(&sem1);
+      chSemSignal(&sem1);
+      chSemWait(&sem1);
+      chSemSignal(&sem1);
+      chSemWait(&sem1);
+      chSemSignal(&sem1);
+      n++;
+    } while (bmk_running(start));
+    test_print("--- Score : ");
+    test_printn(n * 4);
+    test_println(" wait+signal/S");
+  }
+}
+
+static const testcase_t test_004_004 = {
+  "Benchmark, semaphores wait/signal",
+  test_004_004_setup,
+  NULL,
+  test_004_004_execute
+};
+
+/**
+ * @page test_004_005 Sleep accuracy
+ *
+ * <h2>Description</h2>
+ * The tester sleeps for 10mS intervals for one second, after each wakeup
+ * the delay from the expected wakeup time is measured. The score is the
+ * maximum delay, it is expected to be zero ticks when the system is not
+ * loaded.
+ *
+ * <h2>Test Steps</h2>
+ * - A series of 10mS sleeps is performed, the maximum delay is printed.
+ * .
+ */
+
+static void test_004_005_execute(void) {
+  systime_t start, time, late, max;
+
+  /* A series of 10mS sleeps is performed, the maximum delay is printed.*/
+  test_set_step(1);
+  {
+    max = 0;
+    start = bmk_wait_tick();
+    do {
+      chSysLock();
+      time = chVTGetSystemTimeX();
+      chThdSleepS(MS2ST(10));
+      chSysUnlock();
+      late = chVTTimeElapsedSinceX(time) - MS2ST(10);
+      if (late > max)
+        max = late;
+    } while (bmk_running(start));
+    test_print("--- Score : ");
+    test_printn(max);
+    test_println(" ticks max delay");
+  }
+}
+
+static const testcase_t test_004_005 = {
+  "Benchmark, sleep accuracy",
+  NULL,
+  NULL,
+  test_004_005_execute
+};
+
+/**
+ * @page test_004_006 RAM Footprint
+ *
+ * <h2>Description</h2>
+ * The memory size of the various kernel objects is printed.
+ *
+ * <h2>Test Steps</h2>
+ * - The size of the system area is printed.
+ * - The size of the kernel objects is printed.
+ * .
+ */
+
+static void test_004_006_execute(void) {
+
+  /* The size of the system area is printed.*/
+  test_set_step(1);
+  {
+    test_print("--- System: ");
+    test_printn(sizeof (nil_system_t));
+    test_println(" bytes");
+  }
+
+  /* The size of the kernel objects is printed.*/
+  test_set_step(2);
+  {
+    test_print("--- Thread: ");
+    test_printn(sizeof (thread_t));
+    test_println(" bytes");
+    test_print("--- Semaph: ");
+    test_printn(sizeof (semaphore_t));
+    test_println(" bytes");
+#if NIL_CFG_USE_MAILBOXES == TRUE
+    test_print("--- MailB.: ");
+    test_printn(sizeof (mailbox_t));
+    test_println(" bytes");
+#endif
+#if NIL_CFG_USE_MEMPOOLS == TRUE
+    test_print("--- MemPl.: ");
+    test_printn(sizeof (memory_pool_t));
+    test_println(" bytes");
+#endif
+  }
+}
+
+static const testcase_t test_004_006 = {
+  "Benchmark, RAM footprint",
+  NULL,
+  NULL,
+  test_004_006_execute
+};
+
+ /****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Sequence brief description.
+ */
+const testcase_t * const test_sequence_004[] = {
+  &test_004_001,
+  &test_004_002,
+#if (NIL_CFG_USE_EVENTS == TRUE) || defined(__DOXYGEN__)
+  &test_004_003,
+#endif
+  &test_004_004,
+  &test_004_005,
+  &test_004_006,
+  NULL
+};
@@ -0,0 +1,12 @@
+# List of all the formatted output test files.
+TESTSRC = ${CHIBIOS}/test/lib/ch_test.c \
+          ${CHIBIOS}/test/printf/test_root.c \
+          ${CHIBIOS}/test/printf/test_sequence_001.c
+
+# Required include directories
+TESTINC = ${CHIBIOS}/test/lib \
+          ${CHIBIOS}/test/printf
+
+# Required settings, the MinGW ANSI stdio is selected because the C99
+# conformant output is required by the float comparison.
+TESTDEFS = -DCHPRINTF_USE_FLOAT=TRUE -D__USE_MINGW_ANSI_STDIO=1
@@ -0,0 +1,73 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    test_root.h
+ * @brief   Test Suite root structures header.
+ *
+ * @addtogroup CH_TEST_ROOT
+ * @{
+ */
+
+#ifndef _TEST_ROOT_H_
+#define _TEST_ROOT_H_
+
+#include "ch.h"
+#include "hal.h"
+
+#include "test_sequence_001.h"
+
+/*===========================================================================*/
+/* Default definitions.                                                      */
+/*===========================================================================*/
+
+/* Global test suite name, it is printed on top of the test
+   report header.*/
+#define TEST_SUITE_NAME                     "Formatted Output Test Suite"
+
+/**
+ * @brief   Lines formatted by each throughput test.
+ */
+#if !defined(PRINTFTEST_RATE_LINES) || defined(__DOXYGEN__)
+#define PRINTFTEST_RATE_LINES               10000U
+#endif
+
+/**
+ * @brief   Random values used by the float tests.
+ * @note    The float tests are performed if @p CHPRINTF_USE_FLOAT is
+ *          enabled, the output is compared with the C library.
+ */
+#if !defined(PRINTFTEST_FLOAT_VALUES) || defined(__DOXYGEN__)
+#define PRINTFTEST_FLOAT_VALUES             10000U
+#endif
+
+#if !CH_CFG_USE_TM
+#error "the formatted output test requires CH_CFG_USE_TM"
+#endif
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+extern const testcase_t * const *test_suite[];
+
+/*===========================================================================*/
+/* Shared definitions.                                                       */
+/*===========================================================================*/
+
+#endif /* _TEST_ROOT_H_ */
+
+/** @} */
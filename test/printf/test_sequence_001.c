@@ -0,0 +1,564 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hal.h"
+#include "chprintf.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+/**
+ * @page test_sequence_001 Formatted Output
+ *
+ * File: @ref test_sequence_001.c
+ *
+ * <h2>Description</h2>
+ * This sequence checks the output of @p chprintf() against reference
+ * strings and measures its cost on a memory stream and on a stream
+ * counting the calls to its methods. The float tests are performed when
+ * @p CHPRINTF_USE_FLOAT is enabled, as in the default build, the output
+ * is compared with the C library.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_001_001
+ * - @subpage test_001_002
+ * - @subpage test_001_003
+ * - @subpage test_001_004
+ * - @subpage test_001_005
+ * - @subpage test_001_006
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define LINE_FORMAT         "ch%d: adc=%5u temp=%d.%02u status=%s\r\n"
+#define LINE_ARGS(i)        (int)((i) & 7U), (unsigned)((i) & 1023U),     \
+                            25, (unsigned)((i) % 100U), "OK"
+
+/*
+ * Stream counting the calls to its methods, the data is discarded.
+ */
+typedef struct {
+  const struct BaseSequentialStreamVMT *vmt;
+  uint32_t puts;
+  uint32_t writes;
+  uint32_t bytes;
+} CountingStream;
+
+static size_t cs_write(void *ip, const uint8_t *bp, size_t n) {
+  CountingStream *csp = ip;
+
+  (void)bp;
+
+  csp->writes++;
+  csp->bytes += n;
+  return n;
+}
+
+static size_t cs_read(void *ip, uint8_t *bp, size_t n) {
+
+  (void)ip;
+  (void)bp;
+  (void)n;
+
+  return 0;
+}
+
+static msg_t cs_put(void *ip, uint8_t b) {
+  CountingStream *csp = ip;
+
+  (void)b;
+
+  csp->puts++;
+  csp->bytes++;
+  return MSG_OK;
+}
+
+static msg_t cs_get(void *ip) {
+
+  (void)ip;
+
+  return MSG_RESET;
+}
+
+static const struct BaseSequentialStreamVMT cs_vmt = {
+  cs_write, cs_read, cs_put, cs_get
+};
+
+static char line[128];
+
+/*
+ * Converts an amount in a rate per second.
+ */
+static uint32_t per_second(uint32_t n, systime_t elapsed) {
+
+  if (elapsed == (systime_t)0)
+    elapsed = (systime_t)1;
+  return (uint32_t)(((uint64_t)n * CH_CFG_ST_FREQUENCY) / elapsed);
+}
+
+/*
+ * Compares a formatted string and its length with the reference.
+ */
+static bool check(const char *s, int n, const char *ref) {
+
+  return (strcmp(s, ref) == 0) && (n == (int)strlen(ref));
+}
+
+#if CHPRINTF_USE_FLOAT || defined(__DOXYGEN__)
+static char ref[128];
+
+static const char * const float_formats[] = {
+  "%f", "%.0f", "%.3f", "%.9f", "%012.3f",
+#if !CHPRINTF_FLOAT_COMPACT
+  "%e", "%.0e", "%.3e", "%.9e", "%g", "%.1g", "%.4g", "%.9g", "%-12g|"
+#endif
+};
+
+/*
+ * C library formats matching the above, the default and zero precisions
+ * are 9 digits in chprintf().
+ */
+static const char * const float_refs[] = {
+  "%.9f", "%.9f", "%.3f", "%.9f", "%012.3f",
+#if !CHPRINTF_FLOAT_COMPACT
+  "%.9e", "%.9e", "%.3e", "%.9e", "%.9g", "%.1g", "%.4g", "%.9g", "%-12.9g|"
+#endif
+};
+
+/*
+ * Returns a random float with a random exponent, not inf or nan.
+ */
+static float random_float(uint32_t *seedp) {
+  union {
+    float       f;
+    uint32_t    w;
+  } u;
+
+  do {
+    *seedp = *seedp * 1664525U + 1013904223U;
+    u.w = *seedp;
+  } while ((u.w & 0x7F800000U) == 0x7F800000U);
+#if CHPRINTF_FLOAT_COMPACT
+  /* Values below 2^64 only.*/
+  if ((u.w & 0x7F800000U) >= 0x5F800000U)
+    u.w &= 0xBFFFFFFFU;
+#endif
+  return u.f;
+}
+#endif /* CHPRINTF_USE_FLOAT */
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page test_001_001 Formatted output
+ *
+ * <h2>Description</h2>
+ * The strings produced by @p chsnprintf() are compared with reference
+ * strings, covering the field width, padding, precision and truncation
+ * cases and literal runs and strings longer than the @p chprintf()
+ * output buffer.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Integers with field width and padding.
+ * - Strings with precision and field width.
+ * - Radixes, long integers and null strings.
+ * - A literal run longer than the output buffer.
+ * - A string argument longer than the output buffer.
+ * - Output truncated by the buffer size.
+ * .
+ */
+
+static void test_001_001_execute(void) {
+  static const char longrun[] =
+      "a literal run longer than the output buffer of chprintf()";
+  int n;
+
+  /* Integers with field width and padding.*/
+  test_set_step(1);
+  {
+    n = chsnprintf(line, sizeof line, "[%5d][%-5d][%05d][%05d]",
+                   42, 42, 42, -42);
+    test_assert(check(line, n, "[   42][42   ][00042][-0042]"),
+                "wrong integers");
+  }
+
+  /* Strings with precision and field width.*/
+  test_set_step(2);
+  {
+    n = chsnprintf(line, sizeof line, "[%s][%.3s][%-6s][%c]",
+                   "abc", "abcdef", "ab", 'z');
+    test_assert(check(line, n, "[abc][abc][ab    ][z]"), "wrong strings");
+  }
+
+  /* Radixes, long integers and null strings.*/
+  test_set_step(3);
+  {
+    n = chsnprintf(line, sizeof line, "%x %X %o %u %ld %s",
+                   0xBEEFU, 0xCAFEBABEUL, 8U, 678U, -99999L, (char *)NULL);
+    test_assert(check(line, n, "BEEF CAFEBABE 10 678 -99999 (null)"),
+                "wrong radixes");
+  }
+
+  /* A literal run longer than the output buffer.*/
+  test_set_step(4);
+  {
+    n = chsnprintf(line, sizeof line, longrun);
+    test_assert(check(line, n, longrun), "wrong literal run");
+  }
+
+  /* A string argument longer than the output buffer.*/
+  test_set_step(5);
+  {
+    n = chsnprintf(line, sizeof line, "<%s>%d", longrun, 7);
+    test_assert((n == (int)sizeof longrun + 2) && (line[0] == '<') &&
+                (strncmp(line + 1, longrun, sizeof longrun - 1U) == 0) &&
+                (strcmp(line + sizeof longrun, ">7") == 0),
+                "wrong long string");
+  }
+
+  /* Output truncated by the buffer size.*/
+  test_set_step(6);
+  {
+    n = chsnprintf(line, 8, "%s-%d", "abcdef", 12345);
+    test_assert((strcmp(line, "abcdef-") == 0) && (n == 12),
+                "wrong truncation");
+  }
+}
+
+static const testcase_t test_001_001 = {
+  "Formatted output",
+  NULL,
+  NULL,
+  test_001_001_execute
+};
+
+/**
+ * @page test_001_002 Stream calls
+ *
+ * <h2>Description</h2>
+ * A typical diagnostic line is formatted on a stream counting the calls
+ * to its methods, the line must be written using @p streamWrite() runs
+ * only.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The line is formatted, the numbers of bytes, writes and puts are
+ *   printed.
+ * - All the bytes must have been written using @p streamWrite().
+ * .
+ */
+
+static void test_001_002_execute(void) {
+  CountingStream cs = {&cs_vmt, 0U, 0U, 0U};
+  int n;
+
+  /* The line is formatted, the numbers of bytes, writes and puts are
+     printed.*/
+  test_set_step(1);
+  {
+    n = chprintf((BaseSequentialStream *)&cs, LINE_FORMAT, LINE_ARGS(3U));
+    test_print("--- Calls : ");
+    test_printn(cs.bytes);
+    test_print(" bytes, ");
+    test_printn(cs.writes);
+    test_print(" writes, ");
+    test_printn(cs.puts);
+    test_println(" puts");
+  }
+
+  /* All the bytes must have been written using streamWrite().*/
+  test_set_step(2);
+  {
+    test_assert((cs.bytes == (uint32_t)n) &&
+                (n == chsnprintf(line, sizeof line, LINE_FORMAT,
+                                 LINE_ARGS(3U))),
+                "wrong byte count");
+    test_assert(cs.puts == 0U, "single bytes written");
+  }
+}
+
+static const testcase_t test_001_002 = {
+  "Stream calls",
+  NULL,
+  NULL,
+  test_001_002_execute
+};
+
+#if CHPRINTF_USE_FLOAT || defined(__DOXYGEN__)
+/**
+ * @page test_001_003 Float output
+ *
+ * <h2>Description</h2>
+ * @p PRINTFTEST_FLOAT_VALUES random values are formatted using all the
+ * float formats, the output must match the C library @p snprintf().
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CHPRINTF_USE_FLOAT
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - The random values are formatted and compared, the first mismatch is
+ *   printed.
+ * - No mismatches must have been found.
+ * .
+ */
+
+static void test_001_003_execute(void) {
+  uint32_t seed = 1U, i, n, bad = 0U;
+  float f;
+  int a, b;
+
+  /* The random values are formatted and compared, the first mismatch is
+     printed.*/
+  test_set_step(1);
+  {
+    for (i = 0; i < PRINTFTEST_FLOAT_VALUES; i++) {
+      f = random_float(&seed);
+      for (n = 0; n < sizeof float_formats / sizeof float_formats[0]; n++) {
+        a = chsnprintf(line, sizeof line, float_formats[n], f);
+        b = snprintf(ref, sizeof ref, float_refs[n], (double)f);
+        if ((a != b) || (strcmp(line, ref) != 0)) {
+          if (bad++ == 0U) {
+            test_print("--- First mismatch, ");
+            test_print(float_formats[n]);
+            test_print(": ");
+            test_print(line);
+            test_print(" ");
+            test_println(ref);
+          }
+        }
+      }
+    }
+  }
+
+  /* No mismatches must have been found.*/
+  test_set_step(2);
+  {
+    test_assert(bad == 0U, "mismatches");
+  }
+}
+
+static const testcase_t test_001_003 = {
+  "Float output",
+  NULL,
+  NULL,
+  test_001_003_execute
+};
+#endif /* CHPRINTF_USE_FLOAT */
+
+/**
+ * @page test_001_004 Throughput, memory stream
+ *
+ * <h2>Description</h2>
+ * @p PRINTFTEST_RATE_LINES lines are formatted into a memory buffer, the
+ * best time of a line is measured in realtime counter cycles.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The lines are formatted.
+ * - The score is printed.
+ * .
+ */
+
+static void test_001_004_execute(void) {
+  time_measurement_t tm;
+  systime_t start, elapsed;
+  uint32_t i;
+
+  /* The lines are formatted.*/
+  test_set_step(1);
+  {
+    chTMObjectInit(&tm);
+    start = chVTGetSystemTimeX();
+    for (i = 0; i < PRINTFTEST_RATE_LINES; i++) {
+      chTMStartMeasurementX(&tm);
+      (void)chsnprintf(line, sizeof line, LINE_FORMAT, LINE_ARGS(i));
+      chTMStopMeasurementX(&tm);
+    }
+    elapsed = chVTTimeElapsedSinceX(start);
+  }
+
+  /* The score is printed.*/
+  test_set_step(2);
+  {
+    test_print("--- Score : ");
+    test_printn(tm.best);
+    test_print(" cycles/line best, ");
+    test_printn(per_second(PRINTFTEST_RATE_LINES, elapsed));
+    test_println(" lines/S");
+  }
+}
+
+static const testcase_t test_001_004 = {
+  "Throughput, memory stream",
+  NULL,
+  NULL,
+  test_001_004_execute
+};
+
+/**
+ * @page test_001_005 Throughput, counting stream
+ *
+ * <h2>Description</h2>
+ * @p PRINTFTEST_RATE_LINES lines are formatted into the counting stream,
+ * the best time of a line is measured in realtime counter cycles and the
+ * stream calls per line are reported.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The lines are formatted.
+ * - The score is printed.
+ * .
+ */
+
+static void test_001_005_execute(void) {
+  CountingStream cs = {&cs_vmt, 0U, 0U, 0U};
+  time_measurement_t tm;
+  systime_t start, elapsed;
+  uint32_t i;
+
+  /* The lines are formatted.*/
+  test_set_step(1);
+  {
+    chTMObjectInit(&tm);
+    start = chVTGetSystemTimeX();
+    for (i = 0; i < PRINTFTEST_RATE_LINES; i++) {
+      chTMStartMeasurementX(&tm);
+      (void)chprintf((BaseSequentialStream *)&cs, LINE_FORMAT, LINE_ARGS(i));
+      chTMStopMeasurementX(&tm);
+    }
+    elapsed = chVTTimeElapsedSinceX(start);
+  }
+
+  /* The score is printed.*/
+  test_set_step(2);
+  {
+    test_print("--- Score : ");
+    test_printn(tm.best);
+    test_print(" cycles/line best, ");
+    test_printn(per_second(PRINTFTEST_RATE_LINES, elapsed));
+    test_print(" lines/S, ");
+    test_printn((cs.writes + cs.puts) / PRINTFTEST_RATE_LINES);
+    test_println(" calls/line");
+  }
+}
+
+static const testcase_t test_001_005 = {
+  "Throughput, counting stream",
+  NULL,
+  NULL,
+  test_001_005_execute
+};
+
+#if CHPRINTF_USE_FLOAT || defined(__DOXYGEN__)
+/**
+ * @page test_001_006 Float conversions cost
+ *
+ * <h2>Description</h2>
+ * @p PRINTFTEST_FLOAT_VALUES random values are formatted using each
+ * float format, the average cost of a conversion is measured in realtime
+ * counter cycles and compared with the C library.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CHPRINTF_USE_FLOAT
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - The values are formatted using each format, the scores are printed.
+ * .
+ */
+
+static void test_001_006_execute(void) {
+  time_measurement_t tmch, tmlib;
+  uint32_t seed, i, n;
+  float f;
+
+  /* The values are formatted using each format, the scores are
+     printed.*/
+  test_set_step(1);
+  {
+    for (n = 0; n < sizeof float_formats / sizeof float_formats[0]; n++) {
+      chTMObjectInit(&tmch);
+      chTMObjectInit(&tmlib);
+      seed = 1U;
+      for (i = 0; i < PRINTFTEST_FLOAT_VALUES; i++) {
+        f = random_float(&seed);
+        chTMStartMeasurementX(&tmch);
+        (void)chsnprintf(line, sizeof line, float_formats[n], f);
+        chTMStopMeasurementX(&tmch);
+        chTMStartMeasurementX(&tmlib);
+        (void)snprintf(ref, sizeof ref, float_refs[n], (double)f);
+        chTMStopMeasurementX(&tmlib);
+      }
+      test_print("--- Score : ");
+      test_print(float_formats[n]);
+      test_print(" ");
+      test_printn(tmch.cumulative / tmch.n);
+      test_print(" cycles/conversion average, C library ");
+      test_printn(tmlib.cumulative / tmlib.n);
+      test_println("");
+    }
+  }
+}
+
+static const testcase_t test_001_006 = {
+  "Float conversions cost",
+  NULL,
+  NULL,
+  test_001_006_execute
+};
+#endif /* CHPRINTF_USE_FLOAT */
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Formatted Output.
+ */
+const testcase_t * const test_sequence_001[] = {
+  &test_001_001,
+  &test_001_002,
+#if CHPRINTF_USE_FLOAT || defined(__DOXYGEN__)
+  &test_001_003,
+#endif
+  &test_001_004,
+  &test_001_005,
+#if CHPRINTF_USE_FLOAT || defined(__DOXYGEN__)
+  &test_001_006,
+#endif
+  NULL
+};
@@ -308,6 +308,26 @@ static void print_line(void) {
   chSequentialStreamWrite(chp, (const uint8_t *)"\r\n", 2);
 }
 
+/**
+ * @brief   Executes a single test case.
+ * @details The test case is executed without the surrounding report, it
+ *          is used to run the benchmarks outside the test suite.
+ *
+ * @param[in] stream    pointer to a @p BaseSequentialStream object for
+ *                      the test case output
+ * @param[in] tcp       pointer to the test case
+ * @return              The test case outcome.
+ * @retval false        if the test case succeeded.
+ * @retval true         if the test case failed.
+ */
+bool test_execute_case(BaseSequentialStream *stream,
+                       const struct testcase *tcp) {
+
+  chp = stream;
+  execute_test(tcp);
+  return local_fail;
+}
+
 /**
  * @brief   Test execution thread function.
  *
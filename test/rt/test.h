@@ -82,6 +82,8 @@ extern bool test_global_fail;
 extern "C" {
 #endif
   void TestThread(void *p);
+  bool test_execute_case(BaseSequentialStream *stream,
+                         const struct testcase *tcp);
   void test_printn(uint32_t n);
   void test_print(const char *msgp);
   void test_println(const char *msgp);
@@ -49,6 +49,9 @@
  * - @subpage test_benchmarks_011
  * - @subpage test_benchmarks_012
  * - @subpage test_benchmarks_013
+ * - @subpage test_benchmarks_014
+ * - @subpage test_benchmarks_015
+ * - @subpage test_benchmarks_016
  * .
  * @file testbmk.c Kernel Benchmarks
  * @brief Kernel Benchmarks source file
@@ -57,7 +60,7 @@
  */
 
 #if CH_CFG_USE_SEMAPHORES || defined(__DOXYGEN__)
-static semaphore_t sem1;
+static semaphore_t sem1, sem2;
 #endif
 #if CH_CFG_USE_MUTEXES || defined(__DOXYGEN__)
 static mutex_t mtx1;
@@ -690,6 +693,155 @@ ROMCONST struct testcase testbmk13 = {
   bmk13_execute
 };
 
+#if CH_CFG_USE_SEMAPHORES || defined(__DOXYGEN__)
+/**
+ * @page test_benchmarks_014 Semaphores ping-pong performance
+ *
+ * <h2>Description</h2>
+ * The tester signals a semaphore and waits on a second one, an higher
+ * priority thread answers each request signaling back. This is the RT
+ * counterpart of the NIL semaphores ping-pong benchmark.<br>
+ * The performance is calculated by measuring the number of iterations after
+ * a second of continuous operations.
+ */
+
+static THD_FUNCTION(thread14, p) {
+
+  (void)p;
+  while (chSemWait(&sem1) == MSG_OK)
+    chSemSignal(&sem2);
+}
+
+static void bmk14_setup(void) {
+
+  chSemObjectInit(&sem1, 0);
+  chSemObjectInit(&sem2, 0);
+}
+
+static void bmk14_execute(void) {
+  uint32_t n = 0;
+
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()+1,
+                                 thread14, NULL);
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    chSemSignal(&sem1);
+    chSemWait(&sem2);
+    n++;
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  } while (!test_timer_done);
+  chSemReset(&sem1, 0);
+  test_wait_threads();
+  test_print("--- Score : ");
+  test_printn(n);
+  test_print(" msgs/S, ");
+  test_printn(n << 1);
+  test_println(" ctxswc/S");
+}
+
+ROMCONST struct testcase testbmk14 = {
+  "Benchmark, semaphores ping-pong",
+  bmk14_setup,
+  NULL,
+  bmk14_execute
+};
+#endif
+
+#if CH_CFG_USE_EVENTS || defined(__DOXYGEN__)
+/**
+ * @page test_benchmarks_015 ISR to thread wakeup performance
+ *
+ * <h2>Description</h2>
+ * An higher priority thread waits for events, the tester wakes it up using
+ * @p chEvtSignalI() from a critical zone followed by a reschedule, this is
+ * the path followed by an ISR waking up a thread, the IRQ entry and exit
+ * overhead is not included. The NIL benchmark with the same name follows
+ * the same path.<br>
+ * The performance is calculated by measuring the number of iterations after
+ * a second of continuous operations.
+ */
+
+static THD_FUNCTION(thread15, p) {
+
+  (void)p;
+  while ((chEvtWaitAny(ALL_EVENTS) & EVENT_MASK(1)) == 0)
+    ;
+}
+
+static void bmk15_execute(void) {
+  thread_t *tp;
+  uint32_t n = 0;
+
+  tp = threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()+1,
+                                      thread15, NULL);
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    chSysLock();
+    chEvtSignalI(tp, EVENT_MASK(0));
+    chSchRescheduleS();
+    chSysUnlock();
+    n++;
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  } while (!test_timer_done);
+  chEvtSignal(tp, EVENT_MASK(1));
+  test_wait_threads();
+  test_print("--- Score : ");
+  test_printn(n);
+  test_print(" wakeups/S, ");
+  test_printn(n << 1);
+  test_println(" ctxswc/S");
+}
+
+ROMCONST struct testcase testbmk15 = {
+  "Benchmark, ISR to thread wakeup",
+  NULL,
+  NULL,
+  bmk15_execute
+};
+#endif
+
+/**
+ * @page test_benchmarks_016 Sleep accuracy
+ *
+ * <h2>Description</h2>
+ * The tester sleeps for 10mS intervals for one second, after each wakeup
+ * the delay from the expected wakeup time is measured. The score is the
+ * maximum delay, it is expected to be zero ticks when the system is not
+ * loaded.
+ */
+
+static void bmk16_execute(void) {
+  systime_t time, late, max = 0;
+
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    chSysLock();
+    time = chVTGetSystemTimeX();
+    chThdSleepS(MS2ST(10));
+    chSysUnlock();
+    late = chVTTimeElapsedSinceX(time) - MS2ST(10);
+    if (late > max)
+      max = late;
+  } while (!test_timer_done);
+  test_print("--- Score : ");
+  test_printn(max);
+  test_println(" ticks max delay");
+}
+
+ROMCONST struct testcase testbmk16 = {
+  "Benchmark, sleep accuracy",
+  NULL,
+  NULL,
+  bmk16_execute
+};
+
 /**
  * @brief   Test sequence for benchmarks.
  */
@@ -717,6 +869,13 @@ ROMCONST struct testcase * ROMCONST patternbmk[] = {
 #if CH_CFG_USE_MUTEXES || defined(__DOXYGEN__)
   &testbmk12,
 #endif
+#if CH_CFG_USE_SEMAPHORES || defined(__DOXYGEN__)
+  &testbmk14,
+#endif
+#if CH_CFG_USE_EVENTS || defined(__DOXYGEN__)
+  &testbmk15,
+#endif
+  &testbmk16,
   &testbmk13,
 #endif
   NULL
@@ -84,7 +84,7 @@ static void dyn1_execute(void) {
   void *p1;
   tprio_t prio = chThdGetPriorityX();
 
-  (void)chHeapStatus(&heap1, &sz);
+  (void)chHeapStatus(&heap1, &sz, NULL);
   /* Starting threads from the heap. */
   threads[0] = chThdCreateFromHeap(&heap1,
                                    THD_WORKING_AREA_SIZE(THREADS_STACK_SIZE),
@@ -93,7 +93,7 @@ static void dyn1_execute(void) {
                                    THD_WORKING_AREA_SIZE(THREADS_STACK_SIZE),
                                    prio-2, thread, "B");
   /* Allocating the whole heap in order to make the thread creation fail.*/
-  (void)chHeapStatus(&heap1, &n);
+  (void)chHeapStatus(&heap1, &n, NULL);
   p1 = chHeapAlloc(&heap1, n);
   threads[2] = chThdCreateFromHeap(&heap1,
                                    THD_WORKING_AREA_SIZE(THREADS_STACK_SIZE),
@@ -112,7 +112,7 @@ static void dyn1_execute(void) {
   test_assert_sequence(2, "AB");
 
   /* Heap status checked again.*/
-  test_assert(3, chHeapStatus(&heap1, &n) == 1, "heap fragmented");
+  test_assert(3, chHeapStatus(&heap1, &n, NULL) == 1, "heap fragmented");
   test_assert(4, n == sz, "heap size changed");
 }
 
@@ -0,0 +1,14 @@
+# List of all the SDC driver test files.
+TESTSRC = ${CHIBIOS}/test/lib/ch_test.c \
+          ${CHIBIOS}/test/sdc/test_root.c \
+          ${CHIBIOS}/test/sdc/test_sequence_001.c \
+          ${CHIBIOS}/os/hal/lib/blocks/blkio.c
+
+# Required include directories
+TESTINC = ${CHIBIOS}/test/lib \
+          ${CHIBIOS}/test/sdc \
+          ${CHIBIOS}/os/hal/lib/blocks
+
+# Required settings
+TESTDEFS = -DHAL_USE_SDC=TRUE -DSDC_UNALIGNED_BOUNCE_BLOCKS=4 \
+           -DSDC_USE_ASYNC=TRUE
@@ -0,0 +1,84 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    test_root.h
+ * @brief   Test Suite root structures header.
+ *
+ * @addtogroup CH_TEST_ROOT
+ * @{
+ */
+
+#ifndef _TEST_ROOT_H_
+#define _TEST_ROOT_H_
+
+#include "ch.h"
+#include "hal.h"
+
+#include "test_sequence_001.h"
+
+/*===========================================================================*/
+/* Default definitions.                                                      */
+/*===========================================================================*/
+
+/* Global test suite name, it is printed on top of the test
+   report header.*/
+#define TEST_SUITE_NAME                     "SDC Driver Test Suite"
+
+/**
+ * @brief   Blocks transferred by each operation.
+ * @note    It should not be a multiple of @p SDC_UNALIGNED_BOUNCE_BLOCKS
+ *          so that the last chunk is a partial one.
+ */
+#if !defined(SDCTEST_BLOCKS) || defined(__DOXYGEN__)
+#define SDCTEST_BLOCKS                      10U
+#endif
+
+/**
+ * @brief   First block used by the test.
+ */
+#if !defined(SDCTEST_START_BLOCK) || defined(__DOXYGEN__)
+#define SDCTEST_START_BLOCK                 100U
+#endif
+
+/**
+ * @brief   Stack size of the serving thread.
+ */
+#if !defined(SDCTEST_STACK_SIZE) || defined(__DOXYGEN__)
+#if defined(CH_ARCHITECTURE_SIMIA32)
+#define SDCTEST_STACK_SIZE                  2048
+#else
+#define SDCTEST_STACK_SIZE                  256
+#endif
+#endif
+
+#if (SDC_UNALIGNED_BOUNCE_BLOCKS == 0) || !SDC_USE_ASYNC
+#error "the SDC test requires SDC_UNALIGNED_BOUNCE_BLOCKS and SDC_USE_ASYNC"
+#endif
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+extern const testcase_t * const *test_suite[];
+
+/*===========================================================================*/
+/* Shared definitions.                                                       */
+/*===========================================================================*/
+
+#endif /* _TEST_ROOT_H_ */
+
+/** @} */
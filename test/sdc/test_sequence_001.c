@@ -0,0 +1,448 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string.h>
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+/**
+ * @page test_sequence_001 SDC Driver
+ *
+ * File: @ref test_sequence_001.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the SDC driver using the simulator driver, it
+ * emulates an high capacity SD card backed by a RAM array and counts the
+ * read and write operations and the transfers attempted on buffers not
+ * aligned to 4 bytes.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_001_001
+ * - @subpage test_001_002
+ * - @subpage test_001_003
+ * - @subpage test_001_004
+ * - @subpage test_001_005
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define TEST_BYTES          (SDCTEST_BLOCKS * MMCSD_BLOCK_SIZE)
+
+/* Requests queued at once by the ordering test.*/
+#define NUM_REQUESTS        4U
+
+/* Operations required for a bounced transfer.*/
+#define BOUNCED_OPS         ((SDCTEST_BLOCKS + SDC_UNALIGNED_BOUNCE_BLOCKS -   \
+                              1U) / SDC_UNALIGNED_BOUNCE_BLOCKS)
+
+static const SDCConfig sdccfg = {NULL, SDC_MODE_1BIT};
+
+/*
+ * Buffers, the extra space allows to offset the transfers.
+ */
+static union {
+  uint32_t  alignment;
+  uint8_t   buf[TEST_BYTES + 4U];
+} wrbuf, rdbuf, rdbuf2;
+
+static THD_WORKING_AREA(wa_server, SDCTEST_STACK_SIZE);
+static blkio_request_t requests[NUM_REQUESTS];
+static uint32_t cblog[NUM_REQUESTS];
+static uint32_t cbn, cbearly;
+
+/*
+ * Fills a buffer with a pattern depending on a seed.
+ */
+static void fill(uint8_t *p, size_t n, uint8_t seed) {
+  size_t i;
+
+  for (i = 0; i < n; i++)
+    p[i] = (uint8_t)(seed + (i * 7U));
+}
+
+/*
+ * Thread serving the driver requests queue.
+ */
+static THD_FUNCTION(server, p) {
+
+  chRegSetThreadName("sdcserver");
+  sdcServe((SDCDriver *)p);
+}
+
+/*
+ * Completion callback, it logs the request index and checks that the
+ * request is not yet marked as completed.
+ */
+static void logcb(blkio_request_t *reqp) {
+
+  chSysLock();
+  if (bioIsCompletedI(reqp))
+    cbearly++;
+  if (cbn < NUM_REQUESTS)
+    cblog[cbn] = (uint32_t)(uintptr_t)reqp->arg;
+  cbn++;
+  chSysUnlock();
+}
+
+/*
+ * Executes a write and a read back, checks the number of operations seen
+ * by the low level driver and the data read. Returns the failure message
+ * or NULL.
+ */
+static const char *transfer(size_t wroff, size_t rdoff, uint8_t seed,
+                            uint32_t wrops, uint32_t rdops) {
+  uint32_t writes, reads;
+
+  fill(&wrbuf.buf[wroff], TEST_BYTES, seed);
+  memset(rdbuf.buf, 0, sizeof rdbuf.buf);
+
+  writes = SDCD1.writes;
+  if (sdcWrite(&SDCD1, SDCTEST_START_BLOCK, &wrbuf.buf[wroff],
+               SDCTEST_BLOCKS))
+    return "write error";
+  reads = SDCD1.reads;
+  if (sdcRead(&SDCD1, SDCTEST_START_BLOCK, &rdbuf.buf[rdoff],
+              SDCTEST_BLOCKS))
+    return "read error";
+  if (SDCD1.writes - writes != wrops)
+    return "wrong number of write operations";
+  if (SDCD1.reads - reads != rdops)
+    return "wrong number of read operations";
+  if (memcmp(&wrbuf.buf[wroff], &rdbuf.buf[rdoff], TEST_BYTES) != 0)
+    return "data mismatch";
+  if (SDCD1.unaligned != 0U)
+    return "unaligned buffer passed to the driver";
+  return NULL;
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page test_001_001 Card connection
+ *
+ * <h2>Description</h2>
+ * The driver is started and connected to the simulated card, the
+ * capacity read from the card is verified.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The thread serving the driver requests is started, the blocking
+ *   transfers are executed by the serving thread too.
+ * - The driver is started and connected.
+ * - The card capacity is verified.
+ * .
+ */
+
+static void test_001_001_execute(void) {
+
+  /* The thread serving the driver requests is started, the blocking
+     transfers are executed by the serving thread too.*/
+  test_set_step(1);
+  {
+    chThdCreateStatic(wa_server, sizeof wa_server, NORMALPRIO + 1,
+                      server, &SDCD1);
+  }
+
+  /* The driver is started and connected.*/
+  test_set_step(2);
+  {
+    sdcStart(&SDCD1, &sdccfg);
+    test_assert(!sdcConnect(&SDCD1), "connection error");
+  }
+
+  /* The card capacity is verified.*/
+  test_set_step(3);
+  {
+    test_assert(SDCD1.capacity == (uint32_t)SIM_SDC_CARD_BLOCKS,
+                "wrong capacity");
+  }
+}
+
+static const testcase_t test_001_001 = {
+  "Card connection",
+  NULL,
+  NULL,
+  test_001_001_execute
+};
+
+/**
+ * @page test_001_002 Aligned transfers
+ *
+ * <h2>Description</h2>
+ * Blocks are written and read back using aligned buffers, each transfer
+ * must be a single operation.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - @p SDCTEST_BLOCKS blocks are written and read back.
+ * .
+ */
+
+static void test_001_002_execute(void) {
+
+  /* SDCTEST_BLOCKS blocks are written and read back.*/
+  test_set_step(1);
+  {
+    const char *err = transfer(0U, 0U, 0x11U, 1U, 1U);
+
+    test_assert(err == NULL, err);
+  }
+}
+
+static const testcase_t test_001_002 = {
+  "Aligned transfers",
+  NULL,
+  NULL,
+  test_001_002_execute
+};
+
+/**
+ * @page test_001_003 Unaligned transfers
+ *
+ * <h2>Description</h2>
+ * Blocks are written and read back using unaligned buffers, the
+ * transfers must go through the bounce buffer using a multi-block
+ * operation for each chunk of @p SDC_UNALIGNED_BOUNCE_BLOCKS blocks.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Write from an unaligned buffer.
+ * - Read into an unaligned buffer.
+ * - Write and read using unaligned buffers.
+ * .
+ */
+
+static void test_001_003_execute(void) {
+
+  /* Write from an unaligned buffer.*/
+  test_set_step(1);
+  {
+    const char *err = transfer(1U, 0U, 0x22U, BOUNCED_OPS, 1U);
+
+    test_assert(err == NULL, err);
+  }
+
+  /* Read into an unaligned buffer.*/
+  test_set_step(2);
+  {
+    const char *err = transfer(0U, 3U, 0x33U, 1U, BOUNCED_OPS);
+
+    test_assert(err == NULL, err);
+  }
+
+  /* Write and read using unaligned buffers.*/
+  test_set_step(3);
+  {
+    const char *err = transfer(2U, 1U, 0x44U, BOUNCED_OPS, BOUNCED_OPS);
+
+    test_assert(err == NULL, err);
+  }
+}
+
+static const testcase_t test_001_003 = {
+  "Unaligned transfers",
+  NULL,
+  NULL,
+  test_001_003_execute
+};
+
+/**
+ * @page test_001_004 Asynchronous requests ordering
+ *
+ * <h2>Description</h2>
+ * Writes and reads of the same blocks are queued at once and must be
+ * executed in order, the callbacks must be invoked in order and before
+ * the requests are marked as completed.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The requests are queued from a critical zone so that the serving
+ *   thread cannot run until all of them are queued.
+ * - The requests are waited for.
+ * - The callbacks are verified.
+ * - The data read is verified.
+ * .
+ */
+
+static void test_001_004_setup(void) {
+  uint32_t i;
+
+  fill(wrbuf.buf, TEST_BYTES / 2U, 0x55U);
+  fill(&wrbuf.buf[TEST_BYTES / 2U], TEST_BYTES / 2U, 0x66U);
+  cbn = 0U;
+  cbearly = 0U;
+  for (i = 0; i < NUM_REQUESTS; i++)
+    bioRequestObjectInit(&requests[i], (void *)(uintptr_t)i);
+}
+
+static void test_001_004_execute(void) {
+  uint32_t i;
+
+  /* The requests are queued from a critical zone so that the serving
+     thread cannot run until all of them are queued.*/
+  test_set_step(1);
+  {
+    chSysLock();
+    bioStartWriteI(&SDCD1.queue, &requests[0], SDCTEST_START_BLOCK,
+                   wrbuf.buf, SDCTEST_BLOCKS / 2U, logcb);
+    bioStartReadI(&SDCD1.queue, &requests[1], SDCTEST_START_BLOCK,
+                  rdbuf.buf, SDCTEST_BLOCKS / 2U, logcb);
+    bioStartWriteI(&SDCD1.queue, &requests[2], SDCTEST_START_BLOCK,
+                   &wrbuf.buf[TEST_BYTES / 2U], SDCTEST_BLOCKS / 2U, logcb);
+    bioStartReadI(&SDCD1.queue, &requests[3], SDCTEST_START_BLOCK,
+                  rdbuf2.buf, SDCTEST_BLOCKS / 2U, logcb);
+    chSysUnlock();
+  }
+
+  /* The requests are waited for.*/
+  test_set_step(2);
+  {
+    for (i = 0; i < NUM_REQUESTS; i++)
+      test_assert(!bioWait(&requests[i]), "request error");
+  }
+
+  /* The callbacks are verified.*/
+  test_set_step(3);
+  {
+    test_assert(cbn == NUM_REQUESTS, "wrong number of callbacks");
+    test_assert(cbearly == 0U, "request completed before its callback");
+    for (i = 0; i < NUM_REQUESTS; i++)
+      test_assert(cblog[i] == i, "request completed out of order");
+  }
+
+  /* The data read is verified.*/
+  test_set_step(4);
+  {
+    test_assert(memcmp(rdbuf.buf, wrbuf.buf, TEST_BYTES / 2U) == 0,
+                "data mismatch");
+    test_assert(memcmp(rdbuf2.buf, &wrbuf.buf[TEST_BYTES / 2U],
+                       TEST_BYTES / 2U) == 0,
+                "data mismatch");
+  }
+}
+
+static const testcase_t test_001_004 = {
+  "Asynchronous requests ordering",
+  test_001_004_setup,
+  NULL,
+  test_001_004_execute
+};
+
+/**
+ * @page test_001_005 Asynchronous requests overlap
+ *
+ * <h2>Description</h2>
+ * The serving thread has higher priority, the submitting thread must
+ * regain control while the transfer is in progress and prepares the next
+ * buffer meanwhile.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - A write is started, it must be still pending when the submitting
+ *   thread regains control.
+ * - The next buffer is prepared and written while the previous one is
+ *   being written.
+ * - A blocking read is queued after the pending writes, the data read is
+ *   verified.
+ * - The writes are waited for.
+ * .
+ */
+
+static void test_001_005_execute(void) {
+  blkio_request_t req1, req2;
+  bool pending;
+
+  bioRequestObjectInit(&req1, NULL);
+  bioRequestObjectInit(&req2, NULL);
+
+  /* A write is started, it must be still pending when the submitting
+     thread regains control.*/
+  test_set_step(1);
+  {
+    fill(wrbuf.buf, TEST_BYTES, 0x77U);
+    sdcStartWrite(&SDCD1, &req1, SDCTEST_START_BLOCK, wrbuf.buf,
+                  SDCTEST_BLOCKS, NULL);
+    chSysLock();
+    pending = !bioIsCompletedI(&req1);
+    chSysUnlock();
+  }
+
+  /* The next buffer is prepared and written while the previous one is
+     being written.*/
+  test_set_step(2);
+  {
+    fill(rdbuf2.buf, TEST_BYTES, 0x88U);
+    sdcStartWrite(&SDCD1, &req2, SDCTEST_START_BLOCK + SDCTEST_BLOCKS,
+                  rdbuf2.buf, SDCTEST_BLOCKS, NULL);
+  }
+
+  /* A blocking read is queued after the pending writes, the data read is
+     verified.*/
+  test_set_step(3);
+  {
+    test_assert(!sdcRead(&SDCD1, SDCTEST_START_BLOCK + SDCTEST_BLOCKS,
+                         rdbuf.buf, SDCTEST_BLOCKS), "read error");
+    test_assert(memcmp(rdbuf.buf, rdbuf2.buf, TEST_BYTES) == 0,
+                "data mismatch");
+  }
+
+  /* The writes are waited for.*/
+  test_set_step(4);
+  {
+    test_assert(!bioWait(&req1) && !bioWait(&req2), "write error");
+    test_assert(pending, "no overlap");
+  }
+}
+
+static const testcase_t test_001_005 = {
+  "Asynchronous requests overlap",
+  NULL,
+  NULL,
+  test_001_005_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   SDC Driver.
+ */
+const testcase_t * const test_sequence_001[] = {
+  &test_001_001,
+  &test_001_002,
+  &test_001_003,
+  &test_001_004,
+  &test_001_005,
+  NULL
+};
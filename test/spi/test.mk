@@ -0,0 +1,11 @@
+# List of all the SPI transactions queue test files.
+TESTSRC = ${CHIBIOS}/test/lib/ch_test.c \
+          ${CHIBIOS}/test/spi/test_root.c \
+          ${CHIBIOS}/test/spi/test_sequence_001.c
+
+# Required include directories
+TESTINC = ${CHIBIOS}/test/lib \
+          ${CHIBIOS}/test/spi
+
+# Required settings
+TESTDEFS = -DHAL_USE_SPI=TRUE -DSPI_USE_QUEUE=TRUE
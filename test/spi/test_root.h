@@ -0,0 +1,90 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    test_root.h
+ * @brief   Test Suite root structures header.
+ *
+ * @addtogroup CH_TEST_ROOT
+ * @{
+ */
+
+#ifndef _TEST_ROOT_H_
+#define _TEST_ROOT_H_
+
+#include "ch.h"
+#include "hal.h"
+
+#include "test_sequence_001.h"
+
+/*===========================================================================*/
+/* Default definitions.                                                      */
+/*===========================================================================*/
+
+/* Global test suite name, it is printed on top of the test
+   report header.*/
+#define TEST_SUITE_NAME                     "SPI Transactions Test Suite"
+
+/**
+ * @brief   Transactions executed by each client thread.
+ */
+#if !defined(SPITEST_CLIENT_LOOPS) || defined(__DOXYGEN__)
+#define SPITEST_CLIENT_LOOPS                1000U
+#endif
+
+/**
+ * @brief   Transactions kept in the queue by the throughput test.
+ */
+#if !defined(SPITEST_QUEUE_DEPTH) || defined(__DOXYGEN__)
+#define SPITEST_QUEUE_DEPTH                 6U
+#endif
+
+/**
+ * @brief   Transactions executed by the throughput test.
+ */
+#if !defined(SPITEST_RATE_TRANSACTIONS) || defined(__DOXYGEN__)
+#define SPITEST_RATE_TRANSACTIONS           20000U
+#endif
+
+/**
+ * @brief   Stack size of the client threads.
+ */
+#if !defined(SPITEST_STACK_SIZE) || defined(__DOXYGEN__)
+#if defined(CH_ARCHITECTURE_SIMIA32)
+#define SPITEST_STACK_SIZE                  2048
+#else
+#define SPITEST_STACK_SIZE                  256
+#endif
+#endif
+
+#if !SPI_USE_QUEUE || !SPI_USE_WAIT || !SPI_USE_MUTUAL_EXCLUSION
+#error "the SPI test requires SPI_USE_QUEUE, SPI_USE_WAIT and "             \
+       "SPI_USE_MUTUAL_EXCLUSION"
+#endif
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+extern const testcase_t * const *test_suite[];
+
+/*===========================================================================*/
+/* Shared definitions.                                                       */
+/*===========================================================================*/
+
+#endif /* _TEST_ROOT_H_ */
+
+/** @} */
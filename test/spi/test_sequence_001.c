@@ -0,0 +1,443 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+/**
+ * @page test_sequence_001 SPI Transactions
+ *
+ * File: @ref test_sequence_001.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the SPI transactions queue using the simulator SPI
+ * driver. The driver completes one transfer at each simulated interrupt,
+ * the simulated slaves answer each word with the word received xored
+ * with a slave specific pattern. The driver logs the bus events and
+ * counts the protocol violations, like transfers without a selected slave
+ * or overlapping selections.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_001_001
+ * - @subpage test_001_002
+ * - @subpage test_001_003
+ * - @subpage test_001_004
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define NUM_CLIENTS         3U
+#define CLIENT_WORDS        8U
+
+#define SETUP(cs)           SIM_SPI_EVENT(SIM_SPI_EV_SETUP, cs, 0U)
+#define SELECT(cs)          SIM_SPI_EVENT(SIM_SPI_EV_SELECT, cs, 0U)
+#define UNSELECT(cs)        SIM_SPI_EVENT(SIM_SPI_EV_UNSELECT, cs, 0U)
+#define TRANSFER(cs, n)     SIM_SPI_EVENT(SIM_SPI_EV_TRANSFER, cs, n)
+
+/*
+ * Slaves A and C share the same peripheral setup, slave B does not.
+ */
+static const SPIConfig cfg_a = {NULL, 1U, 0x10U};
+static const SPIConfig cfg_b = {NULL, 2U, 0x20U};
+static const SPIConfig cfg_c = {NULL, 3U, 0x10U};
+static const SPIConfig * const configs[NUM_CLIENTS] = {
+  &cfg_a, &cfg_b, &cfg_c
+};
+
+static const uint8_t cmd[1] = {0x5AU};
+static const uint8_t data[4] = {0x01U, 0x02U, 0x03U, 0x04U};
+static uint8_t rx_a[4], rx_a2[4], rx_b[4], rx_rate[4];
+
+static const SPITransfer xfers_a[] = {
+  {1U, cmd, NULL},
+  {4U, NULL, rx_a}
+};
+static const SPITransfer xfers_a2[] = {
+  {1U, cmd, NULL},
+  {4U, NULL, rx_a2}
+};
+static const SPITransfer xfers_b[] = {
+  {4U, data, rx_b}
+};
+static const SPITransfer xfers_c[] = {
+  {2U, NULL, NULL},
+  {2U, data, NULL}
+};
+static const SPITransfer xfers_rate[] = {
+  {1U, cmd, NULL},
+  {4U, NULL, rx_rate}
+};
+
+/*
+ * Expected bus events of the ordering test.
+ */
+static const uint32_t expected[] = {
+  SELECT(1U), TRANSFER(1U, 1U), TRANSFER(1U, 4U), UNSELECT(1U),
+  SETUP(2U), SELECT(2U), TRANSFER(2U, 4U), UNSELECT(2U),
+  SETUP(3U), SELECT(3U), TRANSFER(3U, 2U), TRANSFER(3U, 2U), UNSELECT(3U),
+  SELECT(1U), TRANSFER(1U, 1U), TRANSFER(1U, 4U), UNSELECT(1U)
+};
+
+static SPITransaction queue[SPITEST_QUEUE_DEPTH];
+static THD_WORKING_AREA(wa_client1, SPITEST_STACK_SIZE);
+static THD_WORKING_AREA(wa_client2, SPITEST_STACK_SIZE);
+static THD_WORKING_AREA(wa_client3, SPITEST_STACK_SIZE);
+static void * const wa_clients[NUM_CLIENTS] = {
+  wa_client1, wa_client2, wa_client3
+};
+static binary_semaphore_t done;
+static uint32_t submitted, completed;
+
+/*
+ * Client thread, it exchanges data with its own slave using a private
+ * transaction, returns the number of wrong words received.
+ */
+static THD_FUNCTION(client, p) {
+  const SPIConfig *config = p;
+  uint8_t tx[CLIENT_WORDS], rx[CLIENT_WORDS];
+  SPITransfer xfer = {CLIENT_WORDS, tx, rx};
+  SPITransaction t;
+  uint32_t i, j, errors = 0;
+
+  chRegSetThreadName("spiclient");
+  spiTransactionObjectInit(&t, config, &xfer, 1U, NULL);
+
+  for (i = 0; i < SPITEST_CLIENT_LOOPS; i++) {
+    for (j = 0; j < CLIENT_WORDS; j++)
+      tx[j] = (uint8_t)(i + j);
+    spiTransact(&SPID1, &t);
+    for (j = 0; j < CLIENT_WORDS; j++) {
+      if (rx[j] != SIM_SPI_RESPONSE(config->cs, tx[j]))
+        errors++;
+    }
+  }
+  chThdExit((msg_t)errors);
+}
+
+/*
+ * Completion callback of the throughput test, the transaction is queued
+ * again until the required number of transactions has been submitted.
+ */
+static void requeue(SPIDriver *spip, SPITransaction *stp) {
+
+  chSysLockFromISR();
+  completed++;
+  if (submitted < SPITEST_RATE_TRANSACTIONS) {
+    submitted++;
+    spiSubmitI(spip, stp);
+  }
+  else if (completed == SPITEST_RATE_TRANSACTIONS)
+    chBSemSignalI(&done);
+  chSysUnlockFromISR();
+}
+
+/*
+ * Converts an amount in a rate per second.
+ */
+static uint32_t per_second(uint32_t n, systime_t elapsed) {
+
+  if (elapsed == (systime_t)0)
+    elapsed = (systime_t)1;
+  return (uint32_t)(((uint64_t)n * CH_CFG_ST_FREQUENCY) / elapsed);
+}
+
+/*
+ * Prints a throughput score.
+ */
+static void print_score(systime_t elapsed, uint32_t setups,
+                        const char *mode) {
+
+  test_print("--- Score : ");
+  test_printn(per_second(SPITEST_RATE_TRANSACTIONS, elapsed));
+  test_print(" transactions/S ");
+  test_print(mode);
+  test_print(", ");
+  test_printn(setups);
+  test_println(" setups");
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page test_001_001 Transactions ordering
+ *
+ * <h2>Description</h2>
+ * Transactions for three slaves are queued at once and must be executed
+ * in order, each one within its own selection. The peripheral must be
+ * reprogrammed only when the setup changes, slaves A and C share the
+ * same setup.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Transactions for slaves A, B and C are queued from a critical zone,
+ *   then a transaction for slave A is executed using the blocking API.
+ * - All the transactions must be completed without bus errors.
+ * - The bus events log is verified.
+ * - The data received is verified.
+ * .
+ */
+
+static void test_001_001_execute(void) {
+  SPITransaction ta, ta2, tb, tc;
+  size_t i;
+
+  /* Transactions for slaves A, B and C are queued from a critical zone,
+     then a transaction for slave A is executed using the blocking API.*/
+  test_set_step(1);
+  {
+    spiTransactionObjectInit(&ta, &cfg_a, xfers_a, 2U, NULL);
+    spiTransactionObjectInit(&tb, &cfg_b, xfers_b, 1U, NULL);
+    spiTransactionObjectInit(&tc, &cfg_c, xfers_c, 2U, NULL);
+    spiTransactionObjectInit(&ta2, &cfg_a, xfers_a2, 2U, NULL);
+    spiStart(&SPID1, &cfg_a);
+    simSpiClearLog(&SPID1);
+
+    chSysLock();
+    spiSubmitI(&SPID1, &ta);
+    spiSubmitI(&SPID1, &tb);
+    spiSubmitI(&SPID1, &tc);
+    chSysUnlock();
+    spiTransact(&SPID1, &ta2);
+  }
+
+  /* All the transactions must be completed without bus errors.*/
+  test_set_step(2);
+  {
+    test_assert(!spiIsTransactionPendingX(&ta) &&
+                !spiIsTransactionPendingX(&tb) &&
+                !spiIsTransactionPendingX(&tc),
+                "transactions not completed");
+    test_assert(SPID1.errors == 0U, "bus errors");
+  }
+
+  /* The bus events log is verified.*/
+  test_set_step(3);
+  {
+    test_assert(SPID1.logn == sizeof expected / sizeof expected[0],
+                "wrong number of bus events");
+    for (i = 0; i < SPID1.logn; i++)
+      test_assert(SPID1.log[i] == expected[i], "wrong bus event");
+  }
+
+  /* The data received is verified.*/
+  test_set_step(4);
+  {
+    for (i = 0; i < 4U; i++) {
+      test_assert((rx_a[i] == SIM_SPI_RESPONSE(1U, 0xFFU)) &&
+                  (rx_a2[i] == rx_a[i]) &&
+                  (rx_b[i] == SIM_SPI_RESPONSE(2U, data[i])),
+                  "wrong data received");
+    }
+  }
+}
+
+static const testcase_t test_001_001 = {
+  "Transactions ordering",
+  NULL,
+  NULL,
+  test_001_001_execute
+};
+
+/**
+ * @page test_001_002 Concurrent clients
+ *
+ * <h2>Description</h2>
+ * Three threads use the bus at the same time without any mutual
+ * exclusion, each one with its own slave, the transactions must never
+ * overlap.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The client threads are started and waited for.
+ * - The data errors and the bus errors are verified.
+ * .
+ */
+
+static void test_001_002_execute(void) {
+  thread_t *tps[NUM_CLIENTS];
+  uint32_t i, errors = 0;
+
+  /* The client threads are started and waited for.*/
+  test_set_step(1);
+  {
+    for (i = 0; i < NUM_CLIENTS; i++)
+      tps[i] = chThdCreateStatic(wa_clients[i], sizeof wa_client1,
+                                 chThdGetPriorityX() + 1, client,
+                                 (void *)configs[i]);
+    for (i = 0; i < NUM_CLIENTS; i++)
+      errors += (uint32_t)chThdWait(tps[i]);
+  }
+
+  /* The data errors and the bus errors are verified.*/
+  test_set_step(2);
+  {
+    test_assert(errors == 0U, "data errors");
+    test_assert(SPID1.errors == 0U, "bus errors");
+  }
+}
+
+static const testcase_t test_001_002 = {
+  "Concurrent clients",
+  NULL,
+  NULL,
+  test_001_002_execute
+};
+
+/**
+ * @page test_001_003 Throughput, blocking API
+ *
+ * <h2>Description</h2>
+ * @p SPITEST_RATE_TRANSACTIONS transactions are executed using the
+ * blocking API, the bus is acquired by the thread for each transaction
+ * and the slaves are used in turn.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The transactions are executed.
+ * - The score is printed.
+ * .
+ */
+
+static void test_001_003_execute(void) {
+  systime_t start, elapsed;
+  uint32_t i, setups;
+
+  /* The transactions are executed.*/
+  test_set_step(1);
+  {
+    setups = SPID1.setups;
+    start = chVTGetSystemTimeX();
+    for (i = 0; i < SPITEST_RATE_TRANSACTIONS; i++) {
+      spiAcquireBus(&SPID1);
+      spiStart(&SPID1, configs[i % NUM_CLIENTS]);
+      spiSelect(&SPID1);
+      spiSend(&SPID1, 1U, cmd);
+      spiReceive(&SPID1, 4U, rx_rate);
+      spiUnselect(&SPID1);
+      spiReleaseBus(&SPID1);
+    }
+    elapsed = chVTTimeElapsedSinceX(start);
+  }
+
+  /* The score is printed.*/
+  test_set_step(2);
+  {
+    print_score(elapsed, SPID1.setups - setups, "blocking");
+  }
+}
+
+static const testcase_t test_001_003 = {
+  "Throughput, blocking API",
+  NULL,
+  NULL,
+  test_001_003_execute
+};
+
+/**
+ * @page test_001_004 Throughput, queue
+ *
+ * <h2>Description</h2>
+ * @p SPITEST_RATE_TRANSACTIONS transactions are executed using the queue,
+ * @p SPITEST_QUEUE_DEPTH transactions are queued at once and each one is
+ * queued again by its completion callback, the slaves are used in turn.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The transactions are queued and their completion is waited for.
+ * - The bus errors are verified.
+ * - The score is printed.
+ * .
+ */
+
+static void test_001_004_setup(void) {
+  uint32_t i;
+
+  chBSemObjectInit(&done, true);
+  for (i = 0; i < SPITEST_QUEUE_DEPTH; i++)
+    spiTransactionObjectInit(&queue[i], configs[i % NUM_CLIENTS],
+                             xfers_rate, 2U, requeue);
+  submitted = 0;
+  completed = 0;
+}
+
+static void test_001_004_execute(void) {
+  systime_t start, elapsed;
+  uint32_t i, setups;
+
+  /* The transactions are queued and their completion is waited for.*/
+  test_set_step(1);
+  {
+    setups = SPID1.setups;
+    start = chVTGetSystemTimeX();
+    chSysLock();
+    for (i = 0; i < SPITEST_QUEUE_DEPTH; i++) {
+      submitted++;
+      spiSubmitI(&SPID1, &queue[i]);
+    }
+    chSysUnlock();
+    test_assert(chBSemWaitTimeout(&done, S2ST(10)) == MSG_OK,
+                "transactions not completed");
+    elapsed = chVTTimeElapsedSinceX(start);
+  }
+
+  /* The bus errors are verified.*/
+  test_set_step(2);
+  {
+    test_assert(SPID1.errors == 0U, "bus errors");
+  }
+
+  /* The score is printed.*/
+  test_set_step(3);
+  {
+    print_score(elapsed, SPID1.setups - setups, "queued");
+  }
+}
+
+static const testcase_t test_001_004 = {
+  "Throughput, queue",
+  test_001_004_setup,
+  NULL,
+  test_001_004_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   SPI Transactions.
+ */
+const testcase_t * const test_sequence_001[] = {
+  &test_001_001,
+  &test_001_002,
+  &test_001_003,
+  &test_001_004,
+  NULL
+};
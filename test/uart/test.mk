@@ -0,0 +1,11 @@
+# List of all the UART framed receive test files.
+TESTSRC = ${CHIBIOS}/test/lib/ch_test.c \
+          ${CHIBIOS}/test/uart/test_root.c \
+          ${CHIBIOS}/test/uart/test_sequence_001.c
+
+# Required include directories
+TESTINC = ${CHIBIOS}/test/lib \
+          ${CHIBIOS}/test/uart
+
+# Required settings
+TESTDEFS = -DHAL_USE_UART=TRUE -DUART_USE_FRAMES=TRUE
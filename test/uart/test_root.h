@@ -0,0 +1,89 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    test_root.h
+ * @brief   Test Suite root structures header.
+ *
+ * @addtogroup CH_TEST_ROOT
+ * @{
+ */
+
+#ifndef _TEST_ROOT_H_
+#define _TEST_ROOT_H_
+
+#include "ch.h"
+#include "hal.h"
+
+#include "test_sequence_001.h"
+
+/*===========================================================================*/
+/* Default definitions.                                                      */
+/*===========================================================================*/
+
+/* Global test suite name, it is printed on top of the test
+   report header.*/
+#define TEST_SUITE_NAME                     "UART Framed Receive Test Suite"
+
+/**
+ * @brief   Size of the circular receive buffer.
+ */
+#if !defined(UARTTEST_RING_SIZE) || defined(__DOXYGEN__)
+#define UARTTEST_RING_SIZE                  64U
+#endif
+
+/**
+ * @brief   Number of frame buffers.
+ */
+#if !defined(UARTTEST_BUFFERS) || defined(__DOXYGEN__)
+#define UARTTEST_BUFFERS                    4U
+#endif
+
+/**
+ * @brief   Size of the frame buffers.
+ */
+#if !defined(UARTTEST_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define UARTTEST_BUFFER_SIZE                32U
+#endif
+
+/**
+ * @brief   Frames received by the throughput test.
+ */
+#if !defined(UARTTEST_RATE_FRAMES) || defined(__DOXYGEN__)
+#define UARTTEST_RATE_FRAMES                2000U
+#endif
+
+#if (UARTTEST_BUFFERS < 4U) || (UARTTEST_BUFFER_SIZE < 24U)
+#error "the UART test requires at least four buffers of 24 bytes"
+#endif
+
+#if !UART_USE_FRAMES
+#error "the UART test requires UART_USE_FRAMES"
+#endif
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+extern const testcase_t * const *test_suite[];
+
+/*===========================================================================*/
+/* Shared definitions.                                                       */
+/*===========================================================================*/
+
+#endif /* _TEST_ROOT_H_ */
+
+/** @} */
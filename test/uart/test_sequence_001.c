@@ -0,0 +1,565 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string.h>
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+/**
+ * @page test_sequence_001 UART Framed Receive
+ *
+ * File: @ref test_sequence_001.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the UART framed receive mode using the simulator
+ * UART driver. The driver receives the characters put on the simulated
+ * line by the test, 16 characters at each simulated interrupt. In framed
+ * mode the characters are written in the circular buffer and the half and
+ * full buffer marks are reported as a DMA would do, the idle line
+ * condition is reported after the last character of a burst marked as
+ * idle.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_001_001
+ * - @subpage test_001_002
+ * - @subpage test_001_003
+ * - @subpage test_001_004
+ * - @subpage test_001_005
+ * - @subpage test_001_006
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define RATE_FRAME_SIZE     24U
+#define CHAR_QUEUE_SIZE     128U
+
+static uint8_t ring[UARTTEST_RING_SIZE];
+static uint8_t buffers[BQ_BUFFER_SIZE(UARTTEST_BUFFERS, UARTTEST_BUFFER_SIZE)];
+static input_buffers_queue_t ibq;
+static UARTFrameConfig framecfg;
+static uint8_t charbuf[CHAR_QUEUE_SIZE];
+static input_queue_t iq;
+static uint32_t callbacks;
+static char line[RATE_FRAME_SIZE + 1U];
+
+/*
+ * Counts the frame notifications.
+ */
+static void frames_posted(UARTDriver *uartp) {
+
+  (void)uartp;
+
+  chSysLockFromISR();
+  callbacks++;
+  chSysUnlockFromISR();
+}
+
+/*
+ * Queues each received character, as the serial driver would do.
+ */
+static void char_received(UARTDriver *uartp, uint16_t c) {
+
+  (void)uartp;
+
+  chSysLockFromISR();
+  callbacks++;
+  (void)iqPutI(&iq, (uint8_t)c);
+  chSysUnlockFromISR();
+}
+
+static const UARTConfig framedcfg = {NULL, NULL, NULL, NULL, NULL};
+
+static const UARTConfig charcfg = {NULL, NULL, NULL, char_received, NULL};
+
+/*
+ * Converts an amount in a rate per second.
+ */
+static uint32_t per_second(uint32_t n, systime_t elapsed) {
+
+  if (elapsed == (systime_t)0)
+    elapsed = (systime_t)1;
+  return (uint32_t)(((uint64_t)n * CH_CFG_ST_FREQUENCY) / elapsed);
+}
+
+/*
+ * Starts a framed receive operation with empty buffers.
+ */
+static void start_frames(uint32_t mode) {
+
+  chSysLock();
+  ibqResetI(&ibq);
+  chSysUnlock();
+
+  framecfg.ring      = ring;
+  framecfg.size      = sizeof ring;
+  framecfg.ibqp      = &ibq;
+  framecfg.mode      = mode;
+  framecfg.delimiter = '\n';
+  framecfg.frame_cb  = frames_posted;
+  callbacks = 0;
+  uartStartFrameReceive(&UARTD1, &framecfg);
+}
+
+/*
+ * Puts a string on the simulated line, waiting for room if required.
+ */
+static void feed(const char *s, bool idle) {
+  size_t n = strlen(s);
+  size_t i = 0;
+
+  while (true) {
+    i += simUartReceive(&UARTD1, (const uint8_t *)s + i, n - i, idle);
+    if (i >= n)
+      break;
+    chThdSleep(1);
+  }
+}
+
+/*
+ * Gets a frame and compares it with the expected string.
+ */
+static bool expect(const char *s, systime_t timeout) {
+  size_t n = strlen(s);
+  bool match;
+
+  if (uartGetFrameTimeout(&UARTD1, timeout) != MSG_OK)
+    return false;
+  match = ((size_t)(ibq.top - ibq.ptr) == n) &&
+          (memcmp(ibq.ptr, s, n) == 0);
+  uartReleaseFrame(&UARTD1);
+  return match;
+}
+
+/*
+ * Prints a throughput score.
+ */
+static void print_score(uint32_t n, systime_t elapsed, uint32_t cbs,
+                        const char *unit) {
+
+  test_print("--- Score : ");
+  test_printn(per_second(n, elapsed));
+  test_print(" frames/S, ");
+  test_printn(cbs);
+  test_println(unit);
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page test_001_001 Delimiter framing
+ *
+ * <h2>Description</h2>
+ * Lines of various lengths are received in delimiter mode, some of them
+ * crossing the circular buffer wrap and the half buffer mark.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Three short lines are sent and received.
+ * - Three long lines crossing the wrap are sent and received.
+ * - No frames must have been dropped.
+ * .
+ */
+
+static void test_001_001_setup(void) {
+
+  ibqObjectInit(&ibq, buffers, UARTTEST_BUFFER_SIZE, UARTTEST_BUFFERS,
+                NULL, NULL);
+  uartStart(&UARTD1, &framedcfg);
+  start_frames(UART_FRAME_ON_DELIMITER);
+}
+
+static void test_001_001_teardown(void) {
+
+  uartStopFrameReceive(&UARTD1);
+}
+
+static void test_001_001_execute(void) {
+  static const char *frames[] = {
+    "one\n", "two\n", "three\n",
+    "0123456789abcdefghi\n", "jklmnopqrstuvwxyzAB\n", "CDEFGHIJKLMNOPQRST\n"
+  };
+  uint32_t i;
+
+  /* Three short lines are sent and received.*/
+  test_set_step(1);
+  {
+    for (i = 0; i < 3U; i++)
+      feed(frames[i], true);
+    for (i = 0; i < 3U; i++)
+      test_assert(expect(frames[i], TIME_INFINITE), "wrong frame");
+  }
+
+  /* Three long lines crossing the wrap are sent and received.*/
+  test_set_step(2);
+  {
+    for (i = 3U; i < 6U; i++)
+      feed(frames[i], true);
+    for (i = 3U; i < 6U; i++)
+      test_assert(expect(frames[i], TIME_INFINITE),
+                  "wrong frame across the wrap");
+  }
+
+  /* No frames must have been dropped.*/
+  test_set_step(3);
+  {
+    test_assert(UARTD1.frdropped == 0U, "frames dropped");
+  }
+}
+
+static const testcase_t test_001_001 = {
+  "Delimiter framing",
+  test_001_001_setup,
+  test_001_001_teardown,
+  test_001_001_execute
+};
+
+/**
+ * @page test_001_002 Idle line framing
+ *
+ * <h2>Description</h2>
+ * Bursts are received in idle line mode, a frame is closed only when the
+ * line goes idle.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - A single burst containing a delimiter is received as one frame.
+ * - A burst split by a pause without idle line is received as one frame.
+ * - Only one notification must have been posted for each frame.
+ * .
+ */
+
+static void test_001_002_setup(void) {
+
+  start_frames(UART_FRAME_ON_IDLE);
+}
+
+static void test_001_002_teardown(void) {
+
+  uartStopFrameReceive(&UARTD1);
+}
+
+static void test_001_002_execute(void) {
+
+  /* A single burst containing a delimiter is received as one frame.*/
+  test_set_step(1);
+  {
+    feed("hello\nworld", true);
+    test_assert(expect("hello\nworld", TIME_INFINITE), "wrong frame");
+  }
+
+  /* A burst split by a pause without idle line is received as one
+     frame.*/
+  test_set_step(2);
+  {
+    feed("abc", false);
+    chThdSleepMilliseconds(10);
+    feed("def", true);
+    test_assert(expect("abcdef", TIME_INFINITE), "wrong split frame");
+  }
+
+  /* Only one notification must have been posted for each frame.*/
+  test_set_step(3);
+  {
+    test_assert(callbacks == 2U, "wrong number of notifications");
+  }
+}
+
+static const testcase_t test_001_002 = {
+  "Idle line framing",
+  test_001_002_setup,
+  test_001_002_teardown,
+  test_001_002_execute
+};
+
+/**
+ * @page test_001_003 Timeout framing
+ *
+ * <h2>Description</h2>
+ * The data received so far is returned as a frame when the line is
+ * silent for the specified time.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - A partial frame is sent, it must be returned after the timeout.
+ * - No frame must be returned while the line is silent.
+ * .
+ */
+
+static void test_001_003_setup(void) {
+
+  start_frames(UART_FRAME_ON_TIMEOUT);
+}
+
+static void test_001_003_teardown(void) {
+
+  uartStopFrameReceive(&UARTD1);
+}
+
+static void test_001_003_execute(void) {
+
+  /* A partial frame is sent, it must be returned after the timeout.*/
+  test_set_step(1);
+  {
+    feed("partial", false);
+    test_assert(expect("partial", MS2ST(20)), "partial frame not returned");
+  }
+
+  /* No frame must be returned while the line is silent.*/
+  test_set_step(2);
+  {
+    test_assert(uartGetFrameTimeout(&UARTD1, MS2ST(20)) == MSG_TIMEOUT,
+                "frame from a silent line");
+  }
+}
+
+static const testcase_t test_001_003 = {
+  "Timeout framing",
+  test_001_003_setup,
+  test_001_003_teardown,
+  test_001_003_execute
+};
+
+/**
+ * @page test_001_004 Dropped frames
+ *
+ * <h2>Description</h2>
+ * Frames longer than the buffers and frames arriving with all the
+ * buffers full are dropped as a whole, the reception continues normally
+ * after a drop.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - A frame longer than the buffers is dropped, the following frame is
+ *   received.
+ * - More frames than the free buffers are sent, the frames in excess
+ *   are dropped.
+ * - A frame sent after the overflow is received.
+ * .
+ */
+
+static void test_001_004_setup(void) {
+
+  start_frames(UART_FRAME_ON_DELIMITER);
+}
+
+static void test_001_004_teardown(void) {
+
+  uartStopFrameReceive(&UARTD1);
+}
+
+static void test_001_004_execute(void) {
+  uint32_t i;
+
+  /* A frame longer than the buffers is dropped, the following frame is
+     received.*/
+  test_set_step(1);
+  {
+    feed("this frame is longer than any buffer\nok\n", true);
+    test_assert(expect("ok\n", TIME_INFINITE) && (UARTD1.frdropped == 1U),
+                "long frame not dropped");
+  }
+
+  /* More frames than the free buffers are sent, the frames in excess
+     are dropped.*/
+  test_set_step(2);
+  {
+    for (i = 0; i < UARTTEST_BUFFERS + 2U; i++)
+      feed("q\n", true);
+    chThdSleepMilliseconds(10);
+    for (i = 0; i < UARTTEST_BUFFERS; i++)
+      test_assert(expect("q\n", TIME_IMMEDIATE), "queued frame lost");
+    test_assert((uartGetFrameTimeout(&UARTD1, TIME_IMMEDIATE) == MSG_TIMEOUT) &&
+                (UARTD1.frdropped == 3U), "queue overflow not detected");
+  }
+
+  /* A frame sent after the overflow is received.*/
+  test_set_step(3);
+  {
+    feed("again\n", true);
+    test_assert(expect("again\n", TIME_INFINITE), "no recovery");
+  }
+}
+
+static const testcase_t test_001_004 = {
+  "Dropped frames",
+  test_001_004_setup,
+  test_001_004_teardown,
+  test_001_004_execute
+};
+
+/**
+ * @page test_001_005 Throughput, per-character callback
+ *
+ * <h2>Description</h2>
+ * @p UARTTEST_RATE_FRAMES lines are received using a per-character
+ * callback feeding an input queue, as the serial driver does, the line
+ * is assembled by the thread.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The lines are sent and received.
+ * - The score is printed.
+ * .
+ */
+
+static void test_001_005_setup(void) {
+  uint32_t i;
+
+  for (i = 0; i < RATE_FRAME_SIZE - 1U; i++)
+    line[i] = (char)('a' + i);
+  line[RATE_FRAME_SIZE - 1U] = '\n';
+  iqObjectInit(&iq, charbuf, sizeof charbuf, NULL, NULL);
+  uartStart(&UARTD1, &charcfg);
+  callbacks = 0;
+}
+
+static void test_001_005_execute(void) {
+  char rx[RATE_FRAME_SIZE];
+  systime_t start, elapsed;
+  uint32_t i, j, n;
+
+  /* The lines are sent and received.*/
+  test_set_step(1);
+  {
+    start = chVTGetSystemTimeX();
+    for (n = 0; n < UARTTEST_RATE_FRAMES; n += UARTTEST_BUFFERS) {
+      for (i = 0; i < UARTTEST_BUFFERS; i++)
+        feed(line, true);
+      for (i = 0; i < UARTTEST_BUFFERS; i++) {
+        j = 0;
+        do {
+          rx[j] = (char)iqGetTimeout(&iq, TIME_INFINITE);
+        } while ((rx[j++] != '\n') && (j < RATE_FRAME_SIZE));
+        test_assert((j == RATE_FRAME_SIZE) &&
+                    (memcmp(rx, line, RATE_FRAME_SIZE) == 0),
+                    "wrong line");
+      }
+    }
+    elapsed = chVTTimeElapsedSinceX(start);
+  }
+
+  /* The score is printed.*/
+  test_set_step(2);
+  {
+    print_score(n, elapsed, callbacks / n, " callbacks/frame");
+  }
+}
+
+static const testcase_t test_001_005 = {
+  "Throughput, per-character callback",
+  test_001_005_setup,
+  NULL,
+  test_001_005_execute
+};
+
+/**
+ * @page test_001_006 Throughput, framed mode
+ *
+ * <h2>Description</h2>
+ * @p UARTTEST_RATE_FRAMES lines are received in delimiter mode, each
+ * line is delivered as a whole.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The lines are sent and received.
+ * - The score is printed.
+ * - No frames must have been dropped.
+ * .
+ */
+
+static void test_001_006_setup(void) {
+
+  uartStart(&UARTD1, &framedcfg);
+  start_frames(UART_FRAME_ON_DELIMITER);
+}
+
+static void test_001_006_teardown(void) {
+
+  uartStopFrameReceive(&UARTD1);
+}
+
+static void test_001_006_execute(void) {
+  systime_t start, elapsed;
+  uint32_t i, n;
+
+  /* The lines are sent and received.*/
+  test_set_step(1);
+  {
+    start = chVTGetSystemTimeX();
+    for (n = 0; n < UARTTEST_RATE_FRAMES; n += UARTTEST_BUFFERS) {
+      for (i = 0; i < UARTTEST_BUFFERS; i++)
+        feed(line, true);
+      for (i = 0; i < UARTTEST_BUFFERS; i++)
+        test_assert(expect(line, TIME_INFINITE), "wrong frame");
+    }
+    elapsed = chVTTimeElapsedSinceX(start);
+  }
+
+  /* The score is printed.*/
+  test_set_step(2);
+  {
+    print_score(n, elapsed, callbacks * 100U / n, " callbacks/100 frames");
+  }
+
+  /* No frames must have been dropped.*/
+  test_set_step(3);
+  {
+    test_assert(UARTD1.frdropped == 0U, "frames dropped");
+  }
+}
+
+static const testcase_t test_001_006 = {
+  "Throughput, framed mode",
+  test_001_006_setup,
+  test_001_006_teardown,
+  test_001_006_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   UART Framed Receive.
+ */
+const testcase_t * const test_sequence_001[] = {
+  &test_001_001,
+  &test_001_002,
+  &test_001_003,
+  &test_001_004,
+  &test_001_005,
+  &test_001_006,
+  NULL
+};